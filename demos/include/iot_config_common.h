@@ -114,6 +114,10 @@
     #define IotTaskPool_FreeJob                  vPortFree
     #define IotTaskPool_MallocTimerEvent         pvPortMalloc
     #define IotTaskPool_FreeTimerEvent           vPortFree
+    #define IotTaskPool_MallocTimerWheel         pvPortMalloc
+    #define IotTaskPool_FreeTimerWheel           vPortFree
+    #define IotTaskPool_MallocWorkQueues         pvPortMalloc
+    #define IotTaskPool_FreeWorkQueues           vPortFree
 
     #define IotMqtt_MallocConnection             pvPortMalloc
     #define IotMqtt_FreeConnection               vPortFree
@@ -60,9 +60,40 @@
 #include "iot_logging_setup.h"
 
 /* Provide a default value for the number of milliseconds for a socket poll.
- * This is a temporary workaround to deal with the lack of poll(). */
+ * Sockets that do not support SOCKETS_SO_WAKEUP_CALLBACK are polled by their
+ * receive task with this timeout. */
 #ifndef IOT_NETWORK_SOCKET_POLL_MS
-    #define IOT_NETWORK_SOCKET_POLL_MS    ( 1000 )
+    #define IOT_NETWORK_SOCKET_POLL_MS         ( 1000 )
+#endif
+
+/* Provide a default size for the per-connection receive buffer. The receive
+ * task reads up to this many bytes from the socket at once. */
+#ifndef IOT_NETWORK_RECEIVE_BUFFER_SIZE
+    #define IOT_NETWORK_RECEIVE_BUFFER_SIZE    ( 512 )
+#endif
+
+/* Provide a default for whether connections woken by SOCKETS_SO_WAKEUP_CALLBACK
+ * share one receive task, which runs their receive callbacks on the system task
+ * pool, instead of each having its own receive task. */
+#ifndef IOT_NETWORK_SHARED_RECEIVE_TASK
+    #define IOT_NETWORK_SHARED_RECEIVE_TASK    ( 0 )
+#endif
+
+/* Provide a default value for the number of connections whose receive task may
+ * be woken by SOCKETS_SO_WAKEUP_CALLBACK. Further connections are polled by a
+ * receive task of their own. Each entry is one pointer; with the shared receive
+ * task this is the number of connections that share it. */
+#ifndef IOT_NETWORK_WAKEUP_CONNECTIONS
+    #if IOT_NETWORK_SHARED_RECEIVE_TASK == 1
+        #define IOT_NETWORK_WAKEUP_CONNECTIONS    ( 64 )
+    #else
+        #define IOT_NETWORK_WAKEUP_CONNECTIONS    ( 4 )
+    #endif
+#endif
+
+/* Task pool include, for running receive callbacks of the shared receive task. */
+#if IOT_NETWORK_SHARED_RECEIVE_TASK == 1
+    #include "iot_taskpool.h"
 #endif
 
 /**
@@ -81,6 +112,11 @@
  */
 #define _FLAG_CONNECTION_DESTROYED    ( 4 )
 
+/**
+ * @brief The event group bit to set when a connection's socket has data to read.
+ */
+#define _FLAG_DATA_AVAILABLE          ( 8 )
+
 /*-----------------------------------------------------------*/
 
 typedef struct _networkConnection
@@ -91,12 +127,49 @@ typedef struct _networkConnection
     TaskHandle_t receiveTask;                    /**< @brief Handle of the receive task, if any. */
     IotNetworkReceiveCallback_t receiveCallback; /**< @brief Network receive callback, if any. */
     void * pReceiveContext;                      /**< @brief The context for the receive callback. */
-    bool bufferedByteValid;                      /**< @brief Used to determine if the buffered byte is valid. */
-    uint8_t bufferedByte;                        /**< @brief A single byte buffered from a receive, since AFR Secure Sockets does not have poll(). */
+    bool wakeupCallbackSet;                      /**< @brief Whether the socket wakes the receive task when it has data, instead of being polled. */
+    size_t receiveBufferHead;                    /**< @brief Offset of the first unread byte in `receiveBuffer`. */
+    size_t receiveBufferCount;                   /**< @brief Number of unread bytes in `receiveBuffer`. */
+    uint8_t receiveBuffer[ IOT_NETWORK_RECEIVE_BUFFER_SIZE ]; /**< @brief Data read from the socket by the receive task, since AFR Secure Sockets does not have poll(). */
+
+    #if IOT_NETWORK_SHARED_RECEIVE_TASK == 1
+        bool receiveJobScheduled;                /**< @brief Whether `receiveJob` is scheduled or running. Protected by the wakeup connections mutex. */
+        IotTaskPoolJob_t receiveJob;             /**< @brief Task pool job that reads the socket and invokes the receive callback. */
+        IotTaskPoolJobStorage_t receiveJobStorage; /**< @brief Storage for `receiveJob`. */
+    #endif
 } _networkConnection_t;
 
 /*-----------------------------------------------------------*/
 
+/**
+ * @brief Connections whose sockets wake their receive task through
+ * #_socketWakeupCallback, which is only given the socket.
+ */
+static _networkConnection_t * _pWakeupConnections[ IOT_NETWORK_WAKEUP_CONNECTIONS ] = { NULL };
+
+/**
+ * @brief Protects #_pWakeupConnections, so that a connection is not destroyed
+ * while its socket's wakeup callback runs.
+ */
+static StaticSemaphore_t _wakeupConnectionsMutex;
+
+/**
+ * @brief Handle of #_wakeupConnectionsMutex; `NULL` until the first connection
+ * sets a receive callback.
+ */
+static SemaphoreHandle_t _wakeupConnectionsMutexHandle = NULL;
+
+#if IOT_NETWORK_SHARED_RECEIVE_TASK == 1
+
+/**
+ * @brief Handle of the receive task shared by the connections in
+ * #_pWakeupConnections; `NULL` until the first of them is registered.
+ */
+    static TaskHandle_t _sharedReceiveTask = NULL;
+#endif
+
+/*-----------------------------------------------------------*/
+
 /**
  * @brief An #IotNetworkInterface_t that uses the functions in this file.
  */
@@ -113,6 +186,133 @@ const IotNetworkInterface_t IotNetworkAfr =
 
 /*-----------------------------------------------------------*/
 
+/**
+ * @brief Wakeup callback set on sockets with SOCKETS_SO_WAKEUP_CALLBACK. Wakes
+ * the receive task of the socket's connection.
+ *
+ * @param[in] socket The socket that has data to read.
+ */
+static void _socketWakeupCallback( Socket_t socket )
+{
+    bool connectionFound = false;
+    size_t i = 0;
+
+    if( xSemaphoreTake( _wakeupConnectionsMutexHandle, portMAX_DELAY ) == pdTRUE )
+    {
+        for( i = 0; i < IOT_NETWORK_WAKEUP_CONNECTIONS; i++ )
+        {
+            if( ( _pWakeupConnections[ i ] != NULL ) &&
+                ( _pWakeupConnections[ i ]->socket == socket ) )
+            {
+                ( void ) xEventGroupSetBits( ( EventGroupHandle_t ) &( _pWakeupConnections[ i ]->connectionFlags ),
+                                             _FLAG_DATA_AVAILABLE );
+                connectionFound = true;
+                break;
+            }
+        }
+
+        xSemaphoreGive( _wakeupConnectionsMutexHandle );
+    }
+
+    #if IOT_NETWORK_SHARED_RECEIVE_TASK == 1
+        /* The shared receive task schedules a receive job for every connection
+         * with data available. */
+        if( connectionFound == true )
+        {
+            ( void ) xTaskNotifyGive( _sharedReceiveTask );
+        }
+    #else
+        ( void ) connectionFound;
+    #endif
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Remove a connection from #_pWakeupConnections.
+ *
+ * The wakeup connections mutex must be locked by the caller.
+ *
+ * @param[in] pNetworkConnection The connection to remove.
+ */
+static void _removeWakeupConnection( const _networkConnection_t * pNetworkConnection )
+{
+    size_t i = 0;
+
+    for( i = 0; i < IOT_NETWORK_WAKEUP_CONNECTIONS; i++ )
+    {
+        if( _pWakeupConnections[ i ] == pNetworkConnection )
+        {
+            _pWakeupConnections[ i ] = NULL;
+            break;
+        }
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Stop a connection's socket from waking its receive task.
+ *
+ * @param[in] pNetworkConnection The connection with a wakeup callback set.
+ */
+static void _clearWakeupCallback( _networkConnection_t * pNetworkConnection )
+{
+    /* Once removed from the wakeup connections, the connection is never
+     * referenced by the wakeup callback. */
+    if( xSemaphoreTake( _wakeupConnectionsMutexHandle, portMAX_DELAY ) == pdTRUE )
+    {
+        _removeWakeupConnection( pNetworkConnection );
+
+        xSemaphoreGive( _wakeupConnectionsMutexHandle );
+    }
+
+    ( void ) SOCKETS_SetSockOpt( pNetworkConnection->socket,
+                                 0,
+                                 SOCKETS_SO_WAKEUP_CALLBACK,
+                                 NULL,
+                                 0 );
+
+    pNetworkConnection->wakeupCallbackSet = false;
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Copy data buffered by the receive task.
+ *
+ * @param[in] pNetworkConnection The connection whose buffered data to copy.
+ * @param[out] pBuffer Where to copy the data.
+ * @param[in] bufferSize Maximum number of bytes to copy.
+ *
+ * @return The number of bytes copied.
+ */
+static size_t _copyBufferedData( _networkConnection_t * pNetworkConnection,
+                                 uint8_t * pBuffer,
+                                 size_t bufferSize )
+{
+    size_t bytesCopied = pNetworkConnection->receiveBufferCount;
+
+    if( bytesCopied > bufferSize )
+    {
+        bytesCopied = bufferSize;
+    }
+
+    if( bytesCopied > 0U )
+    {
+        ( void ) memcpy( pBuffer,
+                         &( pNetworkConnection->receiveBuffer[ pNetworkConnection->receiveBufferHead ] ),
+                         bytesCopied );
+
+        pNetworkConnection->receiveBufferHead += bytesCopied;
+        pNetworkConnection->receiveBufferCount -= bytesCopied;
+    }
+
+    return bytesCopied;
+}
+
+/*-----------------------------------------------------------*/
+
 /**
  * @brief Destroys a network connection.
  *
@@ -120,8 +320,16 @@ const IotNetworkInterface_t IotNetworkAfr =
  */
 static void _destroyConnection( _networkConnection_t * pNetworkConnection )
 {
+    int32_t socketStatus = SOCKETS_ERROR_NONE;
+
+    /* Make sure the socket's wakeup callback no longer references the connection. */
+    if( pNetworkConnection->wakeupCallbackSet == true )
+    {
+        _clearWakeupCallback( pNetworkConnection );
+    }
+
     /* Call Secure Sockets close function to free resources. */
-    int32_t socketStatus = SOCKETS_Close( pNetworkConnection->socket );
+    socketStatus = SOCKETS_Close( pNetworkConnection->socket );
 
     if( socketStatus != SOCKETS_ERROR_NONE )
     {
@@ -134,6 +342,63 @@ static void _destroyConnection( _networkConnection_t * pNetworkConnection )
 
 /*-----------------------------------------------------------*/
 
+/**
+ * @brief Invoke the receive callback until it consumes the data that was read
+ * into the receive buffer.
+ *
+ * @param[in] pNetworkConnection The connection that received data.
+ * @param[in] bytesReceived The number of bytes read into the receive buffer.
+ *
+ * @return `true` if the receive callback destroyed the connection; `false`
+ * otherwise.
+ */
+static bool _dispatchReceivedData( _networkConnection_t * pNetworkConnection,
+                                   size_t bytesReceived )
+{
+    bool destroyConnection = false;
+    size_t bytesBuffered = 0;
+    EventBits_t connectionFlags = 0;
+    EventGroupHandle_t pConnectionFlags = ( EventGroupHandle_t ) &( pNetworkConnection->connectionFlags );
+
+    pNetworkConnection->receiveBufferHead = 0;
+    pNetworkConnection->receiveBufferCount = bytesReceived;
+
+    /* Invoke the network callback until it has consumed the buffered data. */
+    while( pNetworkConnection->receiveBufferCount > 0U )
+    {
+        bytesBuffered = pNetworkConnection->receiveBufferCount;
+
+        pNetworkConnection->receiveCallback( pNetworkConnection,
+                                             pNetworkConnection->pReceiveContext );
+
+        /* Check if the connection was destroyed by the receive callback. This
+         * does not need to be thread-safe because the destroy connection function
+         * may only be called once (per its API doc). */
+        connectionFlags = xEventGroupGetBits( pConnectionFlags );
+
+        if( ( connectionFlags & _FLAG_CONNECTION_DESTROYED ) == _FLAG_CONNECTION_DESTROYED )
+        {
+            destroyConnection = true;
+            break;
+        }
+
+        /* Drop data that the receive callback will not consume, such as after
+         * it closed the connection. */
+        if( ( ( connectionFlags & _FLAG_SHUTDOWN ) == _FLAG_SHUTDOWN ) ||
+            ( pNetworkConnection->receiveBufferCount == bytesBuffered ) )
+        {
+            IotLogDebug( "Discarding %lu bytes not consumed by the receive callback.",
+                         ( unsigned long ) pNetworkConnection->receiveBufferCount );
+
+            pNetworkConnection->receiveBufferCount = 0;
+        }
+    }
+
+    return destroyConnection;
+}
+
+/*-----------------------------------------------------------*/
+
 /**
  * @brief Task routine that waits on incoming network data.
  *
@@ -141,34 +406,61 @@ static void _destroyConnection( _networkConnection_t * pNetworkConnection )
  */
 static void _networkReceiveTask( void * pArgument )
 {
-    bool destroyConnection = false;
+    /* The socket is read once before waiting for a wakeup, since data may have
+     * arrived before the wakeup callback was set. */
+    bool destroyConnection = false, socketDrained = false;
     int32_t socketStatus = 0;
     EventBits_t connectionFlags = 0;
 
     /* Cast network connection to the correct type. */
     _networkConnection_t * pNetworkConnection = pArgument;
+    EventGroupHandle_t pConnectionFlags = ( EventGroupHandle_t ) &( pNetworkConnection->connectionFlags );
 
     while( true )
     {
-        /* No buffered byte should be in the connection. */
-        configASSERT( pNetworkConnection->bufferedByteValid == false );
+        /* No buffered data should be in the connection. */
+        configASSERT( pNetworkConnection->receiveBufferCount == 0 );
 
-        /* Block and wait for 1 byte of data. This simulates the behavior of poll().
-         * THIS IS A TEMPORARY WORKAROUND AND DOES NOT PROVIDE THREAD-SAFETY AGAINST
-         * MULTIPLE CALLS OF RECEIVE. */
+        /* Fill the receive buffer with as much data as the socket has.
+         * THIS DOES NOT PROVIDE THREAD-SAFETY AGAINST MULTIPLE CALLS OF RECEIVE. */
         do
         {
-            socketStatus = SOCKETS_Recv( pNetworkConnection->socket,
-                                         &( pNetworkConnection->bufferedByte ),
-                                         1,
-                                         0 );
-
-            connectionFlags = xEventGroupGetBits( ( EventGroupHandle_t ) &( pNetworkConnection->connectionFlags ) );
+            /* Sleep until the socket's wakeup callback reports data, unless the
+             * last receive returned data and more may be waiting. Polled sockets
+             * block in receive instead. */
+            if( ( pNetworkConnection->wakeupCallbackSet == true ) && ( socketDrained == true ) )
+            {
+                connectionFlags = xEventGroupWaitBits( pConnectionFlags,
+                                                       _FLAG_DATA_AVAILABLE | _FLAG_SHUTDOWN,
+                                                       pdFALSE,
+                                                       pdFALSE,
+                                                       portMAX_DELAY );
+
+                /* Clear the wakeup before receiving, so data that arrives after
+                 * the receive wakes this task again. */
+                ( void ) xEventGroupClearBits( pConnectionFlags, _FLAG_DATA_AVAILABLE );
+            }
+            else
+            {
+                connectionFlags = xEventGroupGetBits( pConnectionFlags );
+            }
 
             if( ( connectionFlags & _FLAG_SHUTDOWN ) == _FLAG_SHUTDOWN )
             {
                 socketStatus = SOCKETS_ECLOSED;
             }
+            else
+            {
+                socketStatus = SOCKETS_Recv( pNetworkConnection->socket,
+                                             pNetworkConnection->receiveBuffer,
+                                             IOT_NETWORK_RECEIVE_BUFFER_SIZE,
+                                             0 );
+            }
+
+            /* A receive may return less data than the socket has, such as one TLS
+             * record at a time, so the socket is only drained once it returns no
+             * data. */
+            socketDrained = ( socketStatus <= 0 );
 
             /* Check for timeout. Some ports return 0, some return EWOULDBLOCK. */
         } while( ( socketStatus == 0 ) || ( socketStatus == SOCKETS_EWOULDBLOCK ) );
@@ -178,20 +470,11 @@ static void _networkReceiveTask( void * pArgument )
             break;
         }
 
-        pNetworkConnection->bufferedByteValid = true;
+        destroyConnection = _dispatchReceivedData( pNetworkConnection,
+                                                   ( size_t ) socketStatus );
 
-        /* Invoke the network callback. */
-        pNetworkConnection->receiveCallback( pNetworkConnection,
-                                             pNetworkConnection->pReceiveContext );
-
-        /* Check if the connection was destroyed by the receive callback. This
-         * does not need to be thread-safe because the destroy connection function
-         * may only be called once (per its API doc). */
-        connectionFlags = xEventGroupGetBits( ( EventGroupHandle_t ) &( pNetworkConnection->connectionFlags ) );
-
-        if( ( connectionFlags & _FLAG_CONNECTION_DESTROYED ) == _FLAG_CONNECTION_DESTROYED )
+        if( destroyConnection == true )
         {
-            destroyConnection = true;
             break;
         }
     }
@@ -215,6 +498,440 @@ static void _networkReceiveTask( void * pArgument )
 
 /*-----------------------------------------------------------*/
 
+#if IOT_NETWORK_SHARED_RECEIVE_TASK == 1
+
+/**
+ * @brief Read the socket of a connection served by the shared receive task.
+ *
+ * Such a socket waits at most one tick for data, so a read never holds a task
+ * pool worker. Instead, this waits up to `wakeupTimeout` for the socket's wakeup
+ * callback to report data before reading.
+ *
+ * @param[in] pNetworkConnection The connection to read.
+ * @param[out] pBuffer Where to place the data.
+ * @param[in] bufferSize Maximum number of bytes to read.
+ * @param[in] wakeupTimeout Ticks to wait for a wakeup; 0 to read at once.
+ *
+ * @return The return value of SOCKETS_Recv.
+ */
+    static int32_t _sharedReceive( _networkConnection_t * pNetworkConnection,
+                                   uint8_t * pBuffer,
+                                   size_t bufferSize,
+                                   TickType_t wakeupTimeout )
+    {
+        int32_t socketStatus = 0;
+        EventGroupHandle_t pConnectionFlags = ( EventGroupHandle_t ) &( pNetworkConnection->connectionFlags );
+
+        if( wakeupTimeout > 0U )
+        {
+            ( void ) xEventGroupWaitBits( pConnectionFlags,
+                                          _FLAG_DATA_AVAILABLE | _FLAG_SHUTDOWN,
+                                          pdFALSE,
+                                          pdFALSE,
+                                          wakeupTimeout );
+        }
+
+        /* Clear the wakeup before receiving, so data that arrives after the
+         * receive is reported again. */
+        ( void ) xEventGroupClearBits( pConnectionFlags, _FLAG_DATA_AVAILABLE );
+
+        socketStatus = SOCKETS_Recv( pNetworkConnection->socket,
+                                     pBuffer,
+                                     bufferSize,
+                                     0 );
+
+        /* A receive that fills the buffer may leave data behind, such as the
+         * rest of a TLS record, which does not wake the socket again. */
+        if( socketStatus == ( int32_t ) bufferSize )
+        {
+            ( void ) xEventGroupSetBits( pConnectionFlags, _FLAG_DATA_AVAILABLE );
+        }
+
+        return socketStatus;
+    }
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Task pool job that reads a connection's socket and invokes its receive
+ * callback. Scheduled by the shared receive task.
+ *
+ * @param[in] pTaskPool The system task pool.
+ * @param[in] pJob This job.
+ * @param[in] pContext The network connection.
+ */
+    static void _networkReceiveJob( IotTaskPool_t pTaskPool,
+                                    IotTaskPoolJob_t pJob,
+                                    void * pContext )
+    {
+        bool destroyConnection = false, notifyReceiveTask = false;
+        int32_t socketStatus = 0;
+        EventBits_t connectionFlags = 0;
+
+        /* Cast network connection to the correct type. */
+        _networkConnection_t * pNetworkConnection = pContext;
+        EventGroupHandle_t pConnectionFlags = ( EventGroupHandle_t ) &( pNetworkConnection->connectionFlags );
+
+        /* Unused parameters. */
+        ( void ) pTaskPool;
+        ( void ) pJob;
+
+        /* While this job runs, its worker is the connection's receive task. This
+         * lets the receive callback destroy the connection. */
+        pNetworkConnection->receiveTask = xTaskGetCurrentTaskHandle();
+
+        /* Keep receiving while data is reported. The socket wakes the connection
+         * for as long as it has data, and a receive that fills the buffer
+         * reports the rest itself. So once no wakeup arrived since the last
+         * receive, the socket is drained and this job returns instead of
+         * waiting for more data. */
+        do
+        {
+            connectionFlags = xEventGroupGetBits( pConnectionFlags );
+
+            if( ( connectionFlags & _FLAG_SHUTDOWN ) == _FLAG_SHUTDOWN )
+            {
+                socketStatus = SOCKETS_ECLOSED;
+            }
+            else
+            {
+                socketStatus = _sharedReceive( pNetworkConnection,
+                                               pNetworkConnection->receiveBuffer,
+                                               IOT_NETWORK_RECEIVE_BUFFER_SIZE,
+                                               0 );
+            }
+
+            if( socketStatus > 0 )
+            {
+                destroyConnection = _dispatchReceivedData( pNetworkConnection,
+                                                           ( size_t ) socketStatus );
+            }
+
+            connectionFlags = xEventGroupGetBits( pConnectionFlags );
+        } while( ( destroyConnection == false ) && ( socketStatus > 0 ) &&
+                 ( ( connectionFlags & _FLAG_DATA_AVAILABLE ) == _FLAG_DATA_AVAILABLE ) );
+
+        if( destroyConnection == true )
+        {
+            /* Destroying the connection removes it from the wakeup connections,
+             * so this job is never scheduled again. */
+            _destroyConnection( pNetworkConnection );
+        }
+        else if( xSemaphoreTake( _wakeupConnectionsMutexHandle, portMAX_DELAY ) == pdTRUE )
+        {
+            pNetworkConnection->receiveTask = NULL;
+            pNetworkConnection->receiveJobScheduled = false;
+            connectionFlags = xEventGroupGetBits( pConnectionFlags );
+
+            /* Some ports return 0 or EWOULDBLOCK for a wakeup without data. Stop
+             * scheduling this job after any other error or a shutdown. */
+            if( ( ( connectionFlags & _FLAG_SHUTDOWN ) == _FLAG_SHUTDOWN ) ||
+                ( ( socketStatus < 0 ) && ( socketStatus != SOCKETS_EWOULDBLOCK ) ) )
+            {
+                IotLogDebug( "Network receive job for %p stopping.", pNetworkConnection );
+
+                _removeWakeupConnection( pNetworkConnection );
+
+                ( void ) xEventGroupSetBits( pConnectionFlags,
+                                             _FLAG_RECEIVE_TASK_EXITED );
+            }
+            else
+            {
+                /* Data that arrived while this job ran must be received by the
+                 * next job. */
+                notifyReceiveTask = ( ( connectionFlags & _FLAG_DATA_AVAILABLE ) == _FLAG_DATA_AVAILABLE );
+            }
+
+            xSemaphoreGive( _wakeupConnectionsMutexHandle );
+
+            if( notifyReceiveTask == true )
+            {
+                ( void ) xTaskNotifyGive( _sharedReceiveTask );
+            }
+        }
+        else
+        {
+            /* Waiting forever on the mutex should never fail. */
+            configASSERT( false );
+        }
+    }
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Task routine of the receive task shared by the connections in
+ * #_pWakeupConnections.
+ *
+ * Instead of reading sockets itself, this task schedules a receive job on the
+ * system task pool for each connection with data available, so that one slow
+ * receive callback does not delay the other connections.
+ *
+ * @param[in] pArgument Ignored.
+ */
+    static void _sharedReceiveTaskRoutine( void * pArgument )
+    {
+        size_t i = 0;
+        IotTaskPoolError_t taskPoolStatus = IOT_TASKPOOL_SUCCESS;
+        EventBits_t connectionFlags = 0;
+        _networkConnection_t * pNetworkConnection = NULL;
+
+        /* Unused parameter. */
+        ( void ) pArgument;
+
+        while( true )
+        {
+            /* Sleep until a socket's wakeup callback or a finishing receive job
+             * reports data. */
+            ( void ) ulTaskNotifyTake( pdTRUE, portMAX_DELAY );
+
+            if( xSemaphoreTake( _wakeupConnectionsMutexHandle, portMAX_DELAY ) == pdTRUE )
+            {
+                for( i = 0; i < IOT_NETWORK_WAKEUP_CONNECTIONS; i++ )
+                {
+                    pNetworkConnection = _pWakeupConnections[ i ];
+
+                    /* A connection has at most one receive job at a time. */
+                    if( ( pNetworkConnection == NULL ) ||
+                        ( pNetworkConnection->receiveJobScheduled == true ) )
+                    {
+                        continue;
+                    }
+
+                    connectionFlags = xEventGroupGetBits( ( EventGroupHandle_t ) &( pNetworkConnection->connectionFlags ) );
+
+                    if( ( connectionFlags & ( _FLAG_DATA_AVAILABLE | _FLAG_SHUTDOWN ) ) != _FLAG_DATA_AVAILABLE )
+                    {
+                        continue;
+                    }
+
+                    /* Re-create the receive job for scheduling. This should never fail. */
+                    taskPoolStatus = IotTaskPool_CreateJob( _networkReceiveJob,
+                                                            pNetworkConnection,
+                                                            &( pNetworkConnection->receiveJobStorage ),
+                                                            &( pNetworkConnection->receiveJob ) );
+                    configASSERT( taskPoolStatus == IOT_TASKPOOL_SUCCESS );
+
+                    taskPoolStatus = IotTaskPool_Schedule( IOT_SYSTEM_TASKPOOL,
+                                                           pNetworkConnection->receiveJob,
+                                                           0 );
+
+                    if( taskPoolStatus == IOT_TASKPOOL_SUCCESS )
+                    {
+                        pNetworkConnection->receiveJobScheduled = true;
+                    }
+                    else
+                    {
+                        /* The data stays available, and is received after the
+                         * next wakeup. */
+                        IotLogError( "Failed to schedule network receive job, error %s.",
+                                     IotTaskPool_strerror( taskPoolStatus ) );
+                    }
+                }
+
+                xSemaphoreGive( _wakeupConnectionsMutexHandle );
+            }
+        }
+    }
+#endif /* if IOT_NETWORK_SHARED_RECEIVE_TASK == 1 */
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Read a connection's socket from its receive callback.
+ *
+ * @param[in] pNetworkConnection The connection to read.
+ * @param[out] pBuffer Where to place the data.
+ * @param[in] bufferSize Maximum number of bytes to read.
+ *
+ * @return The return value of SOCKETS_Recv.
+ */
+static int32_t _socketReceive( _networkConnection_t * pNetworkConnection,
+                               uint8_t * pBuffer,
+                               size_t bufferSize )
+{
+    int32_t socketStatus = 0;
+
+    #if IOT_NETWORK_SHARED_RECEIVE_TASK == 1
+        /* Sockets of the shared receive task do not wait in a receive, so wait
+         * for their wakeup instead. */
+        if( pNetworkConnection->wakeupCallbackSet == true )
+        {
+            socketStatus = _sharedReceive( pNetworkConnection,
+                                           pBuffer,
+                                           bufferSize,
+                                           pdMS_TO_TICKS( IOT_NETWORK_SOCKET_POLL_MS ) );
+        }
+        else
+        {
+            socketStatus = SOCKETS_Recv( pNetworkConnection->socket,
+                                         pBuffer,
+                                         bufferSize,
+                                         0 );
+        }
+    #else
+        socketStatus = SOCKETS_Recv( pNetworkConnection->socket,
+                                     pBuffer,
+                                     bufferSize,
+                                     0 );
+    #endif
+
+    return socketStatus;
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Have a connection's socket wake its receive task when it has data.
+ *
+ * With #IOT_NETWORK_SHARED_RECEIVE_TASK, the connection is also served by the
+ * shared receive task, which is created on first use.
+ *
+ * @param[in] pNetworkConnection The connection whose receive task will wait for
+ * wakeups.
+ *
+ * @return `true` if the socket will wake the receive task; `false` if the socket
+ * must be polled.
+ */
+static bool _setWakeupCallback( _networkConnection_t * pNetworkConnection )
+{
+    bool registered = false, wakeupCallbackSet = false;
+    size_t i = 0;
+    void * pWakeupCallback = ( void * ) _socketWakeupCallback;
+
+    #if IOT_NETWORK_SHARED_RECEIVE_TASK == 1
+        const TickType_t sharedReceiveTimeout = 1;
+    #endif
+
+    /* Create the mutex of the wakeup connections on first use. */
+    taskENTER_CRITICAL();
+
+    if( _wakeupConnectionsMutexHandle == NULL )
+    {
+        _wakeupConnectionsMutexHandle = xSemaphoreCreateMutexStatic( &_wakeupConnectionsMutex );
+    }
+
+    taskEXIT_CRITICAL();
+
+    if( xSemaphoreTake( _wakeupConnectionsMutexHandle, portMAX_DELAY ) == pdTRUE )
+    {
+        for( i = 0; i < IOT_NETWORK_WAKEUP_CONNECTIONS; i++ )
+        {
+            if( _pWakeupConnections[ i ] == NULL )
+            {
+                #if IOT_NETWORK_SHARED_RECEIVE_TASK == 1
+                    if( ( _sharedReceiveTask == NULL ) &&
+                        ( xTaskCreate( _sharedReceiveTaskRoutine,
+                                       "NetRecv",
+                                       IOT_NETWORK_RECEIVE_TASK_STACK_SIZE,
+                                       NULL,
+                                       IOT_NETWORK_RECEIVE_TASK_PRIORITY,
+                                       &_sharedReceiveTask ) != pdPASS ) )
+                    {
+                        IotLogError( "Failed to create shared network receive task." );
+
+                        _sharedReceiveTask = NULL;
+                        break;
+                    }
+                #endif
+
+                _pWakeupConnections[ i ] = pNetworkConnection;
+                registered = true;
+                break;
+            }
+        }
+
+        xSemaphoreGive( _wakeupConnectionsMutexHandle );
+    }
+
+    if( registered == true )
+    {
+        /* Ports without the wakeup callback reject this option. */
+        if( SOCKETS_SetSockOpt( pNetworkConnection->socket,
+                                0,
+                                SOCKETS_SO_WAKEUP_CALLBACK,
+                                pWakeupCallback,
+                                sizeof( void * ) ) == SOCKETS_ERROR_NONE )
+        {
+            pNetworkConnection->wakeupCallbackSet = true;
+            wakeupCallbackSet = true;
+
+            #if IOT_NETWORK_SHARED_RECEIVE_TASK == 1
+                /* Receive jobs must not wait in a receive once the socket is
+                 * drained. A zero receive timeout means no timeout to some ports,
+                 * so use the shortest one. This is set once per connection. */
+                if( SOCKETS_SetSockOpt( pNetworkConnection->socket,
+                                        0,
+                                        SOCKETS_SO_RCVTIMEO,
+                                        &sharedReceiveTimeout,
+                                        sizeof( TickType_t ) ) != SOCKETS_ERROR_NONE )
+                {
+                    IotLogWarn( "Failed to shorten receive timeout for the shared receive task." );
+                }
+
+                /* Data may have arrived before the wakeup callback was set, so
+                 * schedule one receive job. The job may destroy the connection,
+                 * which must not be used afterwards. */
+                _socketWakeupCallback( pNetworkConnection->socket );
+            #endif
+        }
+        else
+        {
+            IotLogDebug( "Socket wakeup callback not supported; receive task will poll." );
+
+            ( void ) xSemaphoreTake( _wakeupConnectionsMutexHandle, portMAX_DELAY );
+            _pWakeupConnections[ i ] = NULL;
+            xSemaphoreGive( _wakeupConnectionsMutexHandle );
+        }
+    }
+    else
+    {
+        IotLogDebug( "Too many connections for socket wakeup callbacks; receive task will poll." );
+    }
+
+    return wakeupCallbackSet;
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Wait for a connection's receive task to exit.
+ *
+ * With #IOT_NETWORK_SHARED_RECEIVE_TASK, this also stops the shared receive task
+ * from scheduling receive jobs for the connection, and waits only for a receive
+ * job that is already scheduled.
+ *
+ * @param[in] pNetworkConnection The connection whose receive task to wait for.
+ */
+static void _waitForReceiveTask( _networkConnection_t * pNetworkConnection )
+{
+    bool receiveTaskRunning = ( pNetworkConnection->receiveTask != NULL );
+
+    #if IOT_NETWORK_SHARED_RECEIVE_TASK == 1
+        if( ( pNetworkConnection->wakeupCallbackSet == true ) &&
+            ( xSemaphoreTake( _wakeupConnectionsMutexHandle, portMAX_DELAY ) == pdTRUE ) )
+        {
+            _removeWakeupConnection( pNetworkConnection );
+
+            /* A receive job that closes its own connection does not wait for itself. */
+            receiveTaskRunning = ( pNetworkConnection->receiveJobScheduled == true ) &&
+                                 ( pNetworkConnection->receiveTask != xTaskGetCurrentTaskHandle() );
+
+            xSemaphoreGive( _wakeupConnectionsMutexHandle );
+        }
+    #endif
+
+    if( receiveTaskRunning == true )
+    {
+        ( void ) xEventGroupWaitBits( ( EventGroupHandle_t ) &( pNetworkConnection->connectionFlags ),
+                                      _FLAG_RECEIVE_TASK_EXITED,
+                                      pdTRUE,
+                                      pdTRUE,
+                                      portMAX_DELAY );
+    }
+}
+
+/*-----------------------------------------------------------*/
+
 /**
  * @brief Set up a secured TLS connection.
  *
@@ -454,17 +1171,27 @@ IotNetworkError_t IotNetworkAfr_SetReceiveCallback( void * pConnection,
     /* No flags should be set. */
     configASSERT( xEventGroupGetBits( ( EventGroupHandle_t ) &( pNetworkConnection->connectionFlags ) ) == 0 );
 
-    /* Create task that waits for incoming data. */
-    if( xTaskCreate( _networkReceiveTask,
-                     "NetRecv",
-                     IOT_NETWORK_RECEIVE_TASK_STACK_SIZE,
-                     pNetworkConnection,
-                     IOT_NETWORK_RECEIVE_TASK_PRIORITY,
-                     &( pNetworkConnection->receiveTask ) ) != pdPASS )
+    /* Have the socket wake the receive task when it has data. Sockets that do not
+     * support this are polled by their own receive task. */
+    if( ( _setWakeupCallback( pNetworkConnection ) == true ) &&
+        ( IOT_NETWORK_SHARED_RECEIVE_TASK == 1 ) )
     {
-        IotLogError( "Failed to create network receive task." );
+        IotLogDebug( "Connection %p will use the shared receive task.", pNetworkConnection );
+    }
+    else
+    {
+        /* Create task that waits for incoming data. */
+        if( xTaskCreate( _networkReceiveTask,
+                         "NetRecv",
+                         IOT_NETWORK_RECEIVE_TASK_STACK_SIZE,
+                         pNetworkConnection,
+                         IOT_NETWORK_RECEIVE_TASK_PRIORITY,
+                         &( pNetworkConnection->receiveTask ) ) != pdPASS )
+        {
+            IotLogError( "Failed to create network receive task." );
 
-        status = IOT_NETWORK_SYSTEM_ERROR;
+            status = IOT_NETWORK_SYSTEM_ERROR;
+        }
     }
 
     return status;
@@ -529,23 +1256,18 @@ size_t IotNetworkAfr_Receive( void * pConnection,
     /* Caller should never request zero bytes. */
     configASSERT( bytesRequested > 0 );
 
-    /* Write the buffered byte. THIS IS A TEMPORARY WORKAROUND AND ASSUMES THIS
-     * FUNCTION IS ALWAYS CALLED FROM THE RECEIVE CALLBACK. */
-    if( pNetworkConnection->bufferedByteValid == true )
-    {
-        *pBuffer = pNetworkConnection->bufferedByte;
-        bytesReceived = 1;
-        bytesRemaining--;
-        pNetworkConnection->bufferedByteValid = false;
-    }
+    /* Copy the data buffered by the receive task first, then read the rest
+     * directly into the caller's buffer. THIS ASSUMES THIS FUNCTION IS ALWAYS
+     * CALLED FROM THE RECEIVE CALLBACK. */
+    bytesReceived = _copyBufferedData( pNetworkConnection, pBuffer, bytesRequested );
+    bytesRemaining -= bytesReceived;
 
     /* Block and wait for incoming data. */
     while( bytesRemaining > 0 )
     {
-        socketStatus = SOCKETS_Recv( pNetworkConnection->socket,
-                                     pBuffer + bytesReceived,
-                                     bytesRemaining,
-                                     0 );
+        socketStatus = _socketReceive( pNetworkConnection,
+                                       pBuffer + bytesReceived,
+                                       bytesRemaining );
 
         if( socketStatus == SOCKETS_EWOULDBLOCK )
         {
@@ -597,22 +1319,16 @@ size_t IotNetworkAfr_ReceiveUpto( void * pConnection,
     /* Caller should never pass a zero-length buffer. */
     configASSERT( bufferSize > 0 );
 
-    /* Write the buffered byte. THIS IS A TEMPORARY WORKAROUND AND ASSUMES THIS
-     * FUNCTION IS ALWAYS CALLED FROM THE RECEIVE CALLBACK. */
-    if( pNetworkConnection->bufferedByteValid == true )
-    {
-        *pBuffer = pNetworkConnection->bufferedByte;
-        bytesReceived = 1;
-        pNetworkConnection->bufferedByteValid = false;
-    }
+    /* Return data buffered by the receive task without reading the socket.
+     * THIS ASSUMES THIS FUNCTION IS ALWAYS CALLED FROM THE RECEIVE CALLBACK. */
+    bytesReceived = _copyBufferedData( pNetworkConnection, pBuffer, bufferSize );
 
-    if( bufferSize - bytesReceived > 0 )
+    if( bytesReceived == 0 )
     {
         /* Block and wait for incoming data. */
-        socketStatus = SOCKETS_Recv( pNetworkConnection->socket,
-                                     pBuffer + bytesReceived,
-                                     bufferSize - bytesReceived,
-                                     0 );
+        socketStatus = _socketReceive( pNetworkConnection,
+                                       pBuffer,
+                                       bufferSize );
 
         if( socketStatus <= 0 )
         {
@@ -620,7 +1336,7 @@ size_t IotNetworkAfr_ReceiveUpto( void * pConnection,
         }
         else
         {
-            bytesReceived += ( size_t ) socketStatus;
+            bytesReceived = ( size_t ) socketStatus;
         }
     }
 
@@ -643,17 +1359,10 @@ IotNetworkError_t IotNetworkAfr_Close( void * pConnection )
     ( void ) xEventGroupSetBits( ( EventGroupHandle_t ) &( pNetworkConnection->connectionFlags ),
                                  _FLAG_SHUTDOWN );
 
-    if( pNetworkConnection->receiveTask != NULL )
-    {
-        /* Wait for the network receive task to exit so that the socket can be shutdown safely
-         * without causing the socket to block forever if there are pending reads or writes
-         * from other tasks. */
-        ( void ) xEventGroupWaitBits( ( EventGroupHandle_t ) &( pNetworkConnection->connectionFlags ),
-                                      _FLAG_RECEIVE_TASK_EXITED,
-                                      pdTRUE,
-                                      pdTRUE,
-                                      portMAX_DELAY );
-    }
+    /* Wait for the network receive task to exit so that the socket can be shutdown safely
+     * without causing the socket to block forever if there are pending reads or writes
+     * from other tasks. */
+    _waitForReceiveTask( pNetworkConnection );
 
     /* Call Secure Sockets shutdown function to close connection. */
     socketStatus = SOCKETS_Shutdown( pNetworkConnection->socket,
@@ -684,14 +1393,7 @@ IotNetworkError_t IotNetworkAfr_Destroy( void * pConnection )
     else
     {
         /* If a receive task was created, wait for it to exit. */
-        if( pNetworkConnection->receiveTask != NULL )
-        {
-            ( void ) xEventGroupWaitBits( ( EventGroupHandle_t ) &( pNetworkConnection->connectionFlags ),
-                                          _FLAG_RECEIVE_TASK_EXITED,
-                                          pdTRUE,
-                                          pdTRUE,
-                                          portMAX_DELAY );
-        }
+        _waitForReceiveTask( pNetworkConnection );
 
         _destroyConnection( pNetworkConnection );
     }
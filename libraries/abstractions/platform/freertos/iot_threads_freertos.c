@@ -133,6 +133,13 @@ bool Iot_CreateDetachedThread( IotThreadRoutine_t threadRoutine,
 
 /*-----------------------------------------------------------*/
 
+void * Iot_GetCurrentThread( void )
+{
+    return ( void * ) xTaskGetCurrentTaskHandle();
+}
+
+/*-----------------------------------------------------------*/
+
 bool IotMutex_Create( IotMutex_t * pNewMutex,
                       bool recursive )
 {
@@ -46,6 +46,8 @@
  * @functions_brief{platform thread management}
  * - @function_name{platform_threads_function_createdetachedthread}
  * @function_brief{platform_threads_function_createdetachedthread}
+ * - @function_name{platform_threads_function_getcurrentthread}
+ * @function_brief{platform_threads_function_getcurrentthread}
  * - @function_name{platform_threads_function_mutexcreate}
  * @function_brief{platform_threads_function_mutexcreate}
  * - @function_name{platform_threads_function_mutexdestroy}
@@ -76,6 +78,9 @@
  * @function_page{Iot_CreateDetachedThread,platform_threads,createdetachedthread}
  * @function_snippet{platform_threads,createdetachedthread,this}
  * @copydoc Iot_CreateDetachedThread
+ * @function_page{Iot_GetCurrentThread,platform_threads,getcurrentthread}
+ * @function_snippet{platform_threads,getcurrentthread,this}
+ * @copydoc Iot_GetCurrentThread
  * @function_page{IotMutex_Create,platform_threads,mutexcreate}
  * @function_snippet{platform_threads,mutexcreate,this}
  * @copydoc IotMutex_Create
@@ -157,6 +162,19 @@ bool Iot_CreateDetachedThread( IotThreadRoutine_t threadRoutine,
                                size_t stackSize );
 /* @[declare_platform_threads_createdetachedthread] */
 
+/**
+ * @brief Identify the calling thread.
+ *
+ * This function returns an opaque value that uniquely identifies the calling
+ * thread among all running threads. The value is only meant to be compared with
+ * the values returned to other threads, and must not be dereferenced.
+ *
+ * @return A value identifying the calling thread; never `NULL`.
+ */
+/* @[declare_platform_threads_getcurrentthread] */
+void * Iot_GetCurrentThread( void );
+/* @[declare_platform_threads_getcurrentthread] */
+
 /**
  * @brief Create a new mutex.
  *
@@ -278,6 +278,68 @@ int32_t SOCKETS_Send( Socket_t xSocket,
 }
 /*-----------------------------------------------------------*/
 
+int32_t SOCKETS_SendV( Socket_t xSocket,
+                       const SocketsIoVector_t * pxVectors,
+                       size_t xVectorCount,
+                       uint32_t ulFlags )
+{
+    int32_t lStatus = SOCKETS_SOCKET_ERROR;
+    int32_t lSent = 0;
+    size_t xVector;
+    SSOCKETContextPtr_t pxContext = ( SSOCKETContextPtr_t ) xSocket; /*lint !e9087 cast used for portability. */
+
+    if( ( xSocket != SOCKETS_INVALID_SOCKET ) &&
+        ( pxVectors != NULL ) )
+    {
+        pxContext->xSendFlags = ( BaseType_t ) ulFlags;
+
+        if( pdTRUE == pxContext->xRequireTLS )
+        {
+            /* Send through TLS pipe, if negotiated. The vector layouts match. */
+            lStatus = TLS_SendV( pxContext->pvTLSContext, ( const TLSSendVector_t * ) pxVectors, xVectorCount ); /*lint !e9087 !e740 Identical structure layouts. */
+        }
+        else
+        {
+            /* Send unencrypted; the TCP stack merges the fragments into
+             * segments itself. */
+            lStatus = 0;
+
+            for( xVector = 0; xVector < xVectorCount; xVector++ )
+            {
+                if( pxVectors[ xVector ].xLength > 0U )
+                {
+                    lSent = prvNetworkSend( pxContext, pxVectors[ xVector ].pvData, pxVectors[ xVector ].xLength );
+
+                    if( lSent < 0 )
+                    {
+                        /* Report the error only if nothing was sent yet. */
+                        if( lStatus == 0 )
+                        {
+                            lStatus = lSent;
+                        }
+
+                        break;
+                    }
+
+                    lStatus += lSent;
+
+                    if( ( size_t ) lSent < pxVectors[ xVector ].xLength )
+                    {
+                        break;
+                    }
+                }
+            }
+        }
+    }
+    else
+    {
+        lStatus = SOCKETS_EINVAL;
+    }
+
+    return lStatus;
+}
+/*-----------------------------------------------------------*/
+
 int32_t SOCKETS_SetSockOpt( Socket_t xSocket,
                             int32_t lLevel,
                             int32_t lOptionName,
@@ -206,6 +206,16 @@ typedef struct SocketsSockaddr
     uint32_t ulAddress;     /**< IP Address. Convention is to call this sin_addr. */
 } SocketsSockaddr_t;
 
+/**
+ * @ingroup SecureSockets_datatypes_paramstructs
+ * @brief One fragment of the data passed to SOCKETS_SendV().
+ */
+typedef struct SocketsIoVector
+{
+    const void * pvData; /**< Start of the fragment. */
+    size_t xLength;      /**< Length of the fragment in bytes. */
+} SocketsIoVector_t;
+
 /**
  * @brief Well-known port numbers.
  */
@@ -386,6 +396,31 @@ int32_t SOCKETS_Send( Socket_t xSocket,
                       uint32_t ulFlags );
 /* @[declare_secure_sockets_send] */
 
+/**
+ * @brief Transmit a sequence of fragments to the remote socket as one stream.
+ *
+ * Behaves like SOCKETS_Send() on the concatenation of the fragments, without
+ * the caller having to build that concatenation. On a TLS socket, small
+ * fragments share TLS records instead of each taking one.
+ *
+ * Only available when the port sets socketsconfigSEND_VECTOR_SUPPORTED to 1.
+ *
+ * @param[in] xSocket The handle of the sending socket.
+ * @param[in] pxVectors The fragments to send, in order.
+ * @param[in] xVectorCount The number of fragments.
+ * @param[in] ulFlags Not currently used. Should be set to 0.
+ *
+ * @return
+ * * On success, the number of bytes actually sent, counted across all fragments.
+ * * If an error occurred, a negative value is returned. @ref SocketsErrors
+ */
+/* @[declare_secure_sockets_sendv] */
+int32_t SOCKETS_SendV( Socket_t xSocket,
+                       const SocketsIoVector_t * pxVectors,
+                       size_t xVectorCount,
+                       uint32_t ulFlags );
+/* @[declare_secure_sockets_sendv] */
+
 /**
  * @brief Closes all or part of a full-duplex connection on the socket.
  *
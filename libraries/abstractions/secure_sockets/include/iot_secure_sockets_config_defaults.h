@@ -61,6 +61,18 @@
     #define socketsconfigDEFAULT_RECV_TIMEOUT    ( 10000 )
 #endif
 
+/**
+ * @brief Whether the port implements SOCKETS_SendV().
+ *
+ * The FreeRTOS+TCP and lwIP ports do, and the boards built on them enable this
+ * option in their iot_secure_sockets_config.h. When disabled, users of vectored
+ * sends such as the Secure Sockets transport interface fall back to one
+ * SOCKETS_Send() per fragment.
+ */
+#ifndef socketsconfigSEND_VECTOR_SUPPORTED
+    #define socketsconfigSEND_VECTOR_SUPPORTED    ( 0 )
+#endif
+
 /**
  * @brief By default, metrics of secure socket is disabled.
  *
@@ -626,6 +626,71 @@ int32_t SOCKETS_Send( Socket_t xSocket,
 
 /*-----------------------------------------------------------*/
 
+int32_t SOCKETS_SendV( Socket_t xSocket,
+                       const SocketsIoVector_t * pxVectors,
+                       size_t xVectorCount,
+                       uint32_t ulFlags )
+{
+    ss_ctx_t * ctx;
+    int32_t sent = 0;
+    int32_t ret;
+    size_t i;
+
+    if( SOCKETS_INVALID_SOCKET == xSocket )
+    {
+        return SOCKETS_SOCKET_ERROR;
+    }
+
+    if( NULL == pxVectors )
+    {
+        return SOCKETS_EINVAL;
+    }
+
+    ctx = ( ss_ctx_t * ) xSocket;
+
+    if( ( ctx->status & SS_STATUS_CONNECTED ) != SS_STATUS_CONNECTED )
+    {
+        return SOCKETS_ENOTCONN;
+    }
+
+    configASSERT( ctx->ip_socket >= 0 );
+    ctx->send_flag = ulFlags;
+
+    if( ctx->enforce_tls )
+    {
+        /* Send through TLS pipe, if negotiated. The vector layouts match. */
+        return TLS_SendV( ctx->tls_ctx, ( const TLSSendVector_t * ) pxVectors, xVectorCount );
+    }
+
+    /* Send unencrypted; lwIP merges the fragments into segments itself. */
+    for( i = 0; i < xVectorCount; i++ )
+    {
+        if( 0 == pxVectors[ i ].xLength )
+        {
+            continue;
+        }
+
+        ret = prvNetworkSend( ( void * ) ctx, pxVectors[ i ].pvData, pxVectors[ i ].xLength );
+
+        if( ret < 0 )
+        {
+            /* Report the error only if nothing was sent yet. */
+            return ( 0 == sent ) ? ret : sent;
+        }
+
+        sent += ret;
+
+        if( ( size_t ) ret < pxVectors[ i ].xLength )
+        {
+            break;
+        }
+    }
+
+    return sent;
+}
+
+/*-----------------------------------------------------------*/
+
 int32_t SOCKETS_Shutdown( Socket_t xSocket,
                           uint32_t ulHow )
 {
@@ -257,6 +257,62 @@ void test_SecureSockets_send_successful_tls( void )
     deinitSocket( so );
 }
 
+/*!
+ * @brief A happy vectored send case with non-tls sockets
+ *
+ * @details The purpose of this testcase is to make sure every non-empty
+ *          fragment is sent, and the bytes are counted across fragments
+ */
+void test_SecureSockets_sendv_successful( void )
+{
+    int32_t ret;
+    const char buffer[ BUFFER_LEN ];
+    SocketsIoVector_t vectors[ 3 ] =
+    {
+        { buffer,      10              },
+        { buffer,      0               },
+        { buffer + 10, BUFFER_LEN - 10 }
+    };
+
+    Socket_t so = create_normal_connection();
+
+    lwip_send_ExpectAnyArgsAndReturn( 10 );
+    lwip_send_ExpectAnyArgsAndReturn( BUFFER_LEN - 10 );
+    ret = SOCKETS_SendV( so, vectors, 3, 0 );
+    TEST_ASSERT_EQUAL_INT( BUFFER_LEN, ret );
+
+    /* A short send stops at the fragment it happened in. */
+    lwip_send_ExpectAnyArgsAndReturn( 5 );
+    ret = SOCKETS_SendV( so, vectors, 3, 0 );
+    TEST_ASSERT_EQUAL_INT( 5, ret );
+    deinitSocket( so );
+}
+
+/*!
+ * @brief A happy vectored send case with tls sockets
+ *
+ * @details The purpose of this testcase is to make sure the fragments are
+ *          handed to TLS_SendV and its result is returned
+ */
+void test_SecureSockets_sendv_successful_tls( void )
+{
+    int32_t ret;
+    const char buffer[ BUFFER_LEN ];
+    SocketsIoVector_t vectors[ 2 ] =
+    {
+        { buffer,      10              },
+        { buffer + 10, BUFFER_LEN - 10 }
+    };
+
+    Socket_t so = create_TLS_connection();
+
+    TLS_SendV_ExpectAnyArgsAndReturn( BUFFER_LEN );
+    ret = SOCKETS_SendV( so, vectors, 2, 0 );
+    TEST_ASSERT_EQUAL_INT( BUFFER_LEN, ret );
+    TLS_Cleanup_ExpectAnyArgs();
+    deinitSocket( so );
+}
+
 /*!
  * @brief Test various bad parameters
  *
@@ -164,6 +164,101 @@ int32_t SecureSocketsTransport_Send( NetworkContext_t * pNetworkContext,
 
 /*-----------------------------------------------------------*/
 
+int32_t SecureSocketsTransport_Writev( NetworkContext_t * pNetworkContext,
+                                       const SocketsIoVector_t * pIoVec,
+                                       size_t ioVecCount )
+{
+    int32_t bytesSent = 0;
+    size_t bytesToSend = 0U;
+    size_t i = 0U;
+    SecureSocketsTransportParams_t * pSecureSocketsTransportParams = NULL;
+
+    #if ( socketsconfigSEND_VECTOR_SUPPORTED == 0 )
+        int32_t fragmentSent = 0;
+    #endif
+
+    if( ( pIoVec == NULL ) ||
+        ( ioVecCount == 0UL ) ||
+        ( pNetworkContext == NULL ) ||
+        ( pNetworkContext->pParams == NULL ) )
+    {
+        LogError( ( "Invalid parameter: pIoVec=%p, ioVecCount=%lu, pNetworkContext=%p",
+                    ( const void * ) pIoVec, ioVecCount, ( void * ) pNetworkContext ) );
+        bytesSent = SOCKETS_EINVAL;
+    }
+    else if( pNetworkContext->pParams->tcpSocket == SOCKETS_INVALID_SOCKET )
+    {
+        LogError( ( "Invalid parameter: pNetworkContext->pParams->tcpSocket cannot be SOCKETS_INVALID_SOCKET." ) );
+        bytesSent = SOCKETS_EINVAL;
+    }
+    else
+    {
+        pSecureSocketsTransportParams = pNetworkContext->pParams;
+
+        for( i = 0U; i < ioVecCount; i++ )
+        {
+            bytesToSend += pIoVec[ i ].xLength;
+        }
+
+        #if ( socketsconfigSEND_VECTOR_SUPPORTED == 1 )
+            bytesSent = SOCKETS_SendV( pSecureSocketsTransportParams->tcpSocket,
+                                       pIoVec,
+                                       ioVecCount,
+                                       0 );
+        #else
+            for( i = 0U; i < ioVecCount; i++ )
+            {
+                if( pIoVec[ i ].xLength > 0U )
+                {
+                    fragmentSent = SOCKETS_Send( pSecureSocketsTransportParams->tcpSocket,
+                                                 pIoVec[ i ].pvData,
+                                                 pIoVec[ i ].xLength,
+                                                 0 );
+
+                    if( fragmentSent < 0 )
+                    {
+                        /* Report the error only if nothing was sent yet. */
+                        if( bytesSent == 0 )
+                        {
+                            bytesSent = fragmentSent;
+                        }
+
+                        break;
+                    }
+
+                    bytesSent += fragmentSent;
+
+                    if( fragmentSent < ( int32_t ) pIoVec[ i ].xLength )
+                    {
+                        break;
+                    }
+                }
+            }
+        #endif /* if ( socketsconfigSEND_VECTOR_SUPPORTED == 1 ) */
+
+        /* If an error occurred, a negative value is returned. @ref SocketsErrors. */
+        if( bytesSent >= 0 )
+        {
+            if( bytesSent < ( int32_t ) bytesToSend )
+            {
+                LogWarn( ( "bytesSent %d < bytesToSend %lu.", bytesSent, bytesToSend ) );
+            }
+            else
+            {
+                LogInfo( ( "Successfully sent %d bytes from %lu fragments over network.", bytesSent, ioVecCount ) );
+            }
+        }
+        else
+        {
+            LogError( ( "Failed to send data over network. bytesSent=%d.", bytesSent ) );
+        }
+    }
+
+    return bytesSent;
+}
+
+/*-----------------------------------------------------------*/
+
 /* MISRA Rule 8.13 flags the following line for not using the const qualifier
  * on `pNetworkContext`. Indeed, the object pointed by it is not modified
  * by Secure Sockets, but other implementations of `TransportRecv_t` may do so. */
@@ -206,4 +206,24 @@ int32_t SecureSocketsTransport_Send( NetworkContext_t * pNetworkContext,
                                      const void * pMessage,
                                      size_t bytesToSend );
 
+/**
+ * @brief Sends a sequence of fragments over an established TLS session as one
+ * stream, using the Secure Sockets API.
+ *
+ * This lets callers send a packet header and its payload from separate
+ * buffers. When the port supports SOCKETS_SendV(), small fragments share TLS
+ * records and large ones are encrypted straight from the caller's memory;
+ * otherwise each fragment is sent with its own SOCKETS_Send() call.
+ *
+ * @param[in] pNetworkContext The network context created using Secure Sockets API.
+ * @param[in] pIoVec Fragments to send, in order.
+ * @param[in] ioVecCount Number of fragments.
+ *
+ * @return Number of bytes sent if successful, counted across all fragments;
+ *         negative value on error.
+ */
+int32_t SecureSocketsTransport_Writev( NetworkContext_t * pNetworkContext,
+                                       const SocketsIoVector_t * pIoVec,
+                                       size_t ioVecCount );
+
 #endif /* TRANSPORT_SECURE_SOCKETS_H */
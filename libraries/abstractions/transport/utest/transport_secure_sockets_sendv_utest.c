@@ -0,0 +1,159 @@
+/*
+ * FreeRTOS Transport Secure Sockets V1.0.0
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include "unity.h"
+
+#include "mock_iot_secure_sockets.h"
+
+/* Transport interface include. */
+#include "transport_secure_sockets.h"
+
+/* This suite covers the build where the secure sockets port provides
+ * SOCKETS_SendV. */
+#if ( socketsconfigSEND_VECTOR_SUPPORTED != 1 )
+    #error "Build this test with socketsconfigSEND_VECTOR_SUPPORTED set to 1."
+#endif
+
+#define MOCT_TCP_SOCKET                    ( 100 )
+
+/* Parameters to pass to #SecureSocketsTransport_Writev. */
+#define BYTES_TO_SEND                      ( 4U )
+#define SECURE_SOCKETS_READ_WRITE_ERROR    ( -1 )
+
+/* The size of the buffer passed to #SecureSocketsTransport_Writev. */
+#define BUFFER_LEN                         ( 4U )
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Each compilation unit that consumes the NetworkContext must define it.
+ * It should contain a single pointer to the type of your desired transport.
+ * When using multiple transports in the same compilation unit, define this pointer as void *.
+ *
+ * @note Transport stacks are defined in amazon-freertos/libraries/abstractions/transport/secure_sockets/transport_secure_sockets.h.
+ */
+struct NetworkContext
+{
+    SecureSocketsTransportParams_t * pParams;
+};
+
+/*-----------------------------------------------------------*/
+
+static uint8_t networkBuffer[ BUFFER_LEN ] = { 0 };
+static Socket_t mockTcpSocket = ( Socket_t ) MOCT_TCP_SOCKET;
+static NetworkContext_t networkContext = { 0 };
+static SecureSocketsTransportParams_t secureSocketsTransportParams = { 0 };
+
+/* ============================   UNITY FIXTURES ============================ */
+
+/* Called before each test method. */
+void setUp()
+{
+    networkContext.pParams = &secureSocketsTransportParams;
+    secureSocketsTransportParams.tcpSocket = mockTcpSocket;
+}
+
+/* Called after each test method. */
+void tearDown()
+{
+}
+
+/* Called at the beginning of the whole suite. */
+void suiteSetUp()
+{
+}
+
+/* Called at the end of the whole suite. */
+int suiteTearDown( int numFailures )
+{
+    return numFailures;
+}
+
+/* ========================================================================== */
+
+/**
+ * @brief Test that #SecureSocketsTransport_Writev hands every fragment, empty
+ * ones included, to a single #SOCKETS_SendV call.
+ */
+void test_SecureSocketsTransport_Writev_All_Bytes_Sent_Successfully( void )
+{
+    int32_t bytesSent = 0;
+    SocketsIoVector_t ioVec[ 3 ] =
+    {
+        { networkBuffer,     1U                 },
+        { networkBuffer,     0U                 },
+        { networkBuffer + 1, BYTES_TO_SEND - 1U }
+    };
+
+    SOCKETS_SendV_ExpectWithArrayAndReturn( mockTcpSocket, ioVec, 3, 3U, 0, BYTES_TO_SEND );
+    bytesSent = SecureSocketsTransport_Writev( &networkContext, ioVec, 3 );
+    TEST_ASSERT_EQUAL( BYTES_TO_SEND, bytesSent );
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test that #SecureSocketsTransport_Writev returns the byte count of a
+ * partial #SOCKETS_SendV as is, and its error when nothing was sent.
+ */
+void test_SecureSocketsTransport_Writev_Bytes_Sent_Partially( void )
+{
+    int32_t bytesSent = 0;
+    SocketsIoVector_t ioVec[ 2 ] =
+    {
+        { networkBuffer,     2U                 },
+        { networkBuffer + 2, BYTES_TO_SEND - 2U }
+    };
+
+    SOCKETS_SendV_ExpectWithArrayAndReturn( mockTcpSocket, ioVec, 2, 2U, 0, 3 );
+    bytesSent = SecureSocketsTransport_Writev( &networkContext, ioVec, 2 );
+    TEST_ASSERT_EQUAL( 3, bytesSent );
+
+    SOCKETS_SendV_ExpectWithArrayAndReturn( mockTcpSocket, ioVec, 2, 2U, 0, SECURE_SOCKETS_READ_WRITE_ERROR );
+    bytesSent = SecureSocketsTransport_Writev( &networkContext, ioVec, 2 );
+    TEST_ASSERT_EQUAL( SECURE_SOCKETS_READ_WRITE_ERROR, bytesSent );
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test that #SecureSocketsTransport_Writev rejects invalid parameters
+ * before reaching #SOCKETS_SendV.
+ */
+void test_SecureSocketsTransport_Writev_Invalid_Params( void )
+{
+    int32_t bytesSent;
+    SocketsIoVector_t ioVec = { networkBuffer, BYTES_TO_SEND };
+
+    bytesSent = SecureSocketsTransport_Writev( &networkContext, &ioVec, 0 );
+    TEST_ASSERT_EQUAL( SOCKETS_EINVAL, bytesSent );
+
+    secureSocketsTransportParams.tcpSocket = SOCKETS_INVALID_SOCKET;
+    bytesSent = SecureSocketsTransport_Writev( &networkContext, &ioVec, 1 );
+    TEST_ASSERT_EQUAL( SOCKETS_EINVAL, bytesSent );
+}
@@ -976,6 +976,94 @@ void test_SecureSocketsTransport_Send_Bytes_Sent_Partially( void )
     TEST_ASSERT_EQUAL( BYTES_TO_SEND - 1, bytesSent );
 }
 
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test that #SecureSocketsTransport_Writev returns an error when passing
+ * any invalid parameters.
+ */
+void test_SecureSocketsTransport_Writev_Invalid_Params( void )
+{
+    int32_t bytesSent;
+    NetworkContext_t invalidNetworkContext = { 0 };
+    SocketsIoVector_t ioVec = { networkBuffer, BYTES_TO_SEND };
+
+    secureSocketsTransportParams.tcpSocket = SOCKETS_INVALID_SOCKET;
+    invalidNetworkContext.pParams = &secureSocketsTransportParams;
+
+    bytesSent = SecureSocketsTransport_Writev( NULL, &ioVec, 1 );
+    TEST_ASSERT_EQUAL( SOCKETS_EINVAL, bytesSent );
+
+    bytesSent = SecureSocketsTransport_Writev( &invalidNetworkContext, NULL, 1 );
+    TEST_ASSERT_EQUAL( SOCKETS_EINVAL, bytesSent );
+
+    bytesSent = SecureSocketsTransport_Writev( &invalidNetworkContext, &ioVec, 0 );
+    TEST_ASSERT_EQUAL( SOCKETS_EINVAL, bytesSent );
+
+    bytesSent = SecureSocketsTransport_Writev( &invalidNetworkContext, &ioVec, 1 );
+    TEST_ASSERT_EQUAL( SOCKETS_EINVAL, bytesSent );
+
+    invalidNetworkContext.pParams = NULL;
+    bytesSent = SecureSocketsTransport_Writev( &invalidNetworkContext, &ioVec, 1 );
+    TEST_ASSERT_EQUAL( SOCKETS_EINVAL, bytesSent );
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test the happy path case when #SecureSocketsTransport_Writev sends every
+ * fragment, skipping empty ones.
+ */
+void test_SecureSocketsTransport_Writev_All_Bytes_Sent_Successfully( void )
+{
+    int32_t bytesSent = 0;
+    SocketsIoVector_t ioVec[ 3 ] =
+    {
+        { networkBuffer,     1U                 },
+        { networkBuffer,     0U                 },
+        { networkBuffer + 1, BYTES_TO_SEND - 1U }
+    };
+
+    secureSocketsTransportParams.tcpSocket = mockTcpSocket;
+    networkContext.pParams = &secureSocketsTransportParams;
+    SOCKETS_Send_ExpectAndReturn( secureSocketsTransportParams.tcpSocket, networkBuffer, 1U, 0, 1 );
+    SOCKETS_Send_ExpectAndReturn( secureSocketsTransportParams.tcpSocket, networkBuffer + 1, BYTES_TO_SEND - 1U, 0, BYTES_TO_SEND - 1U );
+    bytesSent = SecureSocketsTransport_Writev( &networkContext, ioVec, 3 );
+    TEST_ASSERT_EQUAL( BYTES_TO_SEND, bytesSent );
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test that #SecureSocketsTransport_Writev stops at a fragment that is sent
+ * partially, and reports the bytes sent so far when a later fragment fails.
+ */
+void test_SecureSocketsTransport_Writev_Bytes_Sent_Partially( void )
+{
+    int32_t bytesSent = 0;
+    SocketsIoVector_t ioVec[ 2 ] =
+    {
+        { networkBuffer,     2U                 },
+        { networkBuffer + 2, BYTES_TO_SEND - 2U }
+    };
+
+    secureSocketsTransportParams.tcpSocket = mockTcpSocket;
+    networkContext.pParams = &secureSocketsTransportParams;
+
+    SOCKETS_Send_ExpectAndReturn( secureSocketsTransportParams.tcpSocket, networkBuffer, 2U, 0, 1 );
+    bytesSent = SecureSocketsTransport_Writev( &networkContext, ioVec, 2 );
+    TEST_ASSERT_EQUAL( 1, bytesSent );
+
+    SOCKETS_Send_ExpectAndReturn( secureSocketsTransportParams.tcpSocket, networkBuffer, 2U, 0, 2 );
+    SOCKETS_Send_ExpectAndReturn( secureSocketsTransportParams.tcpSocket, networkBuffer + 2, BYTES_TO_SEND - 2U, 0, SECURE_SOCKETS_READ_WRITE_ERROR );
+    bytesSent = SecureSocketsTransport_Writev( &networkContext, ioVec, 2 );
+    TEST_ASSERT_EQUAL( 2, bytesSent );
+
+    SOCKETS_Send_ExpectAndReturn( secureSocketsTransportParams.tcpSocket, networkBuffer, 2U, 0, SECURE_SOCKETS_READ_WRITE_ERROR );
+    bytesSent = SecureSocketsTransport_Writev( &networkContext, ioVec, 2 );
+    TEST_ASSERT_EQUAL( SECURE_SOCKETS_READ_WRITE_ERROR, bytesSent );
+}
+
 
 /*-----------------------------------------------------------*/
 
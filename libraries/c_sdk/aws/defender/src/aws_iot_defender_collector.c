@@ -56,16 +56,23 @@ typedef struct _metricsReport
     IotSerializerEncoderObject_t object; /* Encoder object handle. */
     uint8_t * pDataBuffer;               /* Raw data buffer to be published with MQTT. */
     size_t size;                         /* Raw data size. */
+    size_t capacity;                     /* Allocated size of the raw data buffer. */
+    bool allocationFailed;               /* The raw data buffer could not grow; the report is dropped. */
 } _metricsReport_t;
 
 /* Initialize metrics report. */
 static _metricsReport_t _report =
 {
     .object      = IOT_SERIALIZER_ENCODER_CONTAINER_INITIALIZER_STREAM,
-    .pDataBuffer = NULL,
-    .size        = 0
+    .pDataBuffer      = NULL,
+    .size             = 0,
+    .capacity         = 0,
+    .allocationFailed = false
 };
 
+/* Size of the previous report, used as the initial buffer size of the next one. */
+static size_t _reportSizeHint = 0;
+
 /* Define a "snapshot" global array of metrics flag. */
 static uint32_t _metricsFlagSnapshot[ DEFENDER_METRICS_GROUP_COUNT ];
 
@@ -79,7 +86,11 @@ const IotSerializerDecodeInterface_t * _pAwsIotDefenderDecoder = NULL;
 
 static void _assertSuccess( IotSerializerError_t error );
 
-static void _assertSuccessOrBufferToSmall( IotSerializerError_t error );
+static void _assertSuccessOrReportDropped( IotSerializerError_t error );
+
+static bool _appendToReport( void * pFlushContext,
+                             const uint8_t * pData,
+                             size_t dataLength );
 
 static void _copyMetricsFlag( void );
 
@@ -102,10 +113,66 @@ void _assertSuccess( IotSerializerError_t error )
 
 /*-----------------------------------------------------------*/
 
-void _assertSuccessOrBufferToSmall( IotSerializerError_t error )
+void _assertSuccessOrReportDropped( IotSerializerError_t error )
 {
     ( void ) error;
-    AwsIotDefender_Assert( error == IOT_SERIALIZER_SUCCESS || error == IOT_SERIALIZER_BUFFER_TOO_SMALL );
+
+    /* Once the report buffer cannot grow, every flush is refused and the report
+     * is dropped. The encoder then also refuses the containers that could not be
+     * opened; serializing carries on so that the opened ones are still closed. */
+    AwsIotDefender_Assert( error == IOT_SERIALIZER_SUCCESS || _report.allocationFailed == true );
+}
+
+/*-----------------------------------------------------------*/
+
+static bool _appendToReport( void * pFlushContext,
+                             const uint8_t * pData,
+                             size_t dataLength )
+{
+    _metricsReport_t * pReport = ( _metricsReport_t * ) pFlushContext;
+    uint8_t * pNewBuffer = NULL;
+    size_t newCapacity = 0;
+
+    if( ( pReport->allocationFailed == false ) && ( pReport->size + dataLength > pReport->capacity ) )
+    {
+        #if IOT_STATIC_MEMORY_ONLY == 1
+            /* Message buffers have a fixed size; a report never needs more than one. */
+            newCapacity = Iot_MessageBufferSize();
+        #else
+            newCapacity = pReport->capacity > 0 ? 2 * pReport->capacity : _reportSizeHint;
+        #endif
+
+        if( newCapacity < pReport->size + dataLength )
+        {
+            newCapacity = pReport->size + dataLength;
+        }
+
+        pNewBuffer = AwsIotDefender_MallocReport( newCapacity * sizeof( uint8_t ) );
+
+        if( pNewBuffer != NULL )
+        {
+            if( pReport->pDataBuffer != NULL )
+            {
+                memcpy( pNewBuffer, pReport->pDataBuffer, pReport->size );
+                AwsIotDefender_FreeReport( pReport->pDataBuffer );
+            }
+
+            pReport->pDataBuffer = pNewBuffer;
+            pReport->capacity = newCapacity;
+        }
+        else
+        {
+            pReport->allocationFailed = true;
+        }
+    }
+
+    if( pReport->allocationFailed == false )
+    {
+        memcpy( pReport->pDataBuffer + pReport->size, pData, dataLength );
+        pReport->size += dataLength;
+    }
+
+    return !pReport->allocationFailed;
 }
 
 /*-----------------------------------------------------------*/
@@ -119,9 +186,8 @@ uint8_t * AwsIotDefenderInternal_GetReportBuffer( void )
 
 size_t AwsIotDefenderInternal_GetReportBufferSize( void )
 {
-    /* Encoder might over-calculate the needed size. Therefor encoded size might be smaller than buffer size: _report.size. */
-    return _report.pDataBuffer == NULL ? 0
-           : _pAwsIotDefenderEncoder->getEncodedSize( &_report.object, _report.pDataBuffer );
+    /* All of the encoded report has been flushed to the buffer. */
+    return _report.size;
 }
 
 /*-----------------------------------------------------------*/
@@ -133,10 +199,12 @@ bool AwsIotDefenderInternal_CreateReport( void )
 
     bool result = true;
 
+    IotSerializerError_t serializerError = IOT_SERIALIZER_SUCCESS;
+
     IotSerializerEncoderObject_t * pEncoderObject = &( _report.object );
 
-    size_t dataSize = 0;
-    uint8_t * pReportBuffer = NULL;
+    /* The report is encoded into this window, which is appended to the report buffer whenever it fills up. */
+    uint8_t window[ AWS_IOT_DEFENDER_REPORT_WINDOW_SIZE ];
 
     /* Copy the metrics flag user specified. */
     _copyMetricsFlag();
@@ -144,25 +212,26 @@ bool AwsIotDefenderInternal_CreateReport( void )
     /* Generate report id based on current time. */
     _AwsIotDefenderReportId = IotClock_GetTimeMs();
 
-    /* Dry-run serialization to calculate the required size. */
+    serializerError = _pAwsIotDefenderEncoder->initStream( pEncoderObject,
+                                                           window,
+                                                           sizeof( window ),
+                                                           _appendToReport,
+                                                           &_report );
+    _assertSuccess( serializerError );
+
+    /* Serialize once; the report buffer grows as the window is flushed. */
     serializeReport();
 
-    /* Get the calculated required size. */
-    dataSize = _pAwsIotDefenderEncoder->getExtraBufferSizeNeeded( pEncoderObject );
+    /* Append the rest of the report. */
+    serializerError = _pAwsIotDefenderEncoder->flush( pEncoderObject );
+    _assertSuccessOrReportDropped( serializerError );
 
     /* Clean the encoder object handle. */
     _pAwsIotDefenderEncoder->destroy( pEncoderObject );
 
-    /* Allocate memory once. */
-    pReportBuffer = AwsIotDefender_MallocReport( dataSize * sizeof( uint8_t ) );
-
-    if( pReportBuffer != NULL )
+    if( _report.allocationFailed == false )
     {
-        _report.pDataBuffer = pReportBuffer;
-        _report.size = dataSize;
-
-        /* Actual serialization. */
-        serializeReport();
+        _reportSizeHint = _report.size;
 
         /* Ouput the report to stdout if debugging mode is enabled. */
         #if DEBUG_CBOR_PRINT == 1
@@ -171,6 +240,8 @@ bool AwsIotDefenderInternal_CreateReport( void )
     }
     else
     {
+        AwsIotDefenderInternal_DeleteReport();
+
         result = false;
     }
 
@@ -181,15 +252,17 @@ bool AwsIotDefenderInternal_CreateReport( void )
 
 void AwsIotDefenderInternal_DeleteReport( void )
 {
-    /* Destroy the encoder object. */
-    _pAwsIotDefenderEncoder->destroy( &( _report.object ) );
-
-    /* Free the memory of data buffer. */
-    AwsIotDefender_FreeReport( _report.pDataBuffer );
+    /* Free the memory of data buffer. The encoder object was destroyed when the report was created. */
+    if( _report.pDataBuffer != NULL )
+    {
+        AwsIotDefender_FreeReport( _report.pDataBuffer );
+    }
 
     /* Reset report members. */
     _report.pDataBuffer = NULL;
     _report.size = 0;
+    _report.capacity = 0;
+    _report.allocationFailed = false;
     _report.object = ( IotSerializerEncoderObject_t ) IOT_SERIALIZER_ENCODER_CONTAINER_INITIALIZER_STREAM;
 }
 
@@ -215,42 +288,35 @@ static void serializeReport( void )
     IotSerializerEncoderObject_t headerMap = IOT_SERIALIZER_ENCODER_CONTAINER_INITIALIZER_MAP;
     IotSerializerEncoderObject_t metricsMap = IOT_SERIALIZER_ENCODER_CONTAINER_INITIALIZER_MAP;
 
-    /* Define an assert function for serialization returned error. */
-    void (* assertNoError)( IotSerializerError_t ) = _report.pDataBuffer == NULL ? _assertSuccessOrBufferToSmall
-                                                     : _assertSuccess;
-
     uint8_t metricsGroupCount = 0;
     uint32_t i = 0;
 
-    serializerError = _pAwsIotDefenderEncoder->init( pEncoderObject, _report.pDataBuffer, _report.size );
-    assertNoError( serializerError );
-
     /* Create the outermost map with 2 keys: "header", "metrics". */
     serializerError = _pAwsIotDefenderEncoder->openContainer( pEncoderObject, &reportMap, 2 );
-    assertNoError( serializerError );
+    _assertSuccessOrReportDropped( serializerError );
 
     /* Create the "header" map with 2 keys: "report_id", "version". */
     serializerError = _pAwsIotDefenderEncoder->openContainerWithKey( &reportMap,
                                                                      HEADER_TAG,
                                                                      &headerMap,
                                                                      2 );
-    assertNoError( serializerError );
+    _assertSuccessOrReportDropped( serializerError );
 
     /* Append key-value pair of "report_Id" which uses clock time. */
     serializerError = _pAwsIotDefenderEncoder->appendKeyValue( &headerMap,
                                                                REPORTID_TAG,
                                                                IotSerializer_ScalarSignedInt( ( int64_t ) _AwsIotDefenderReportId ) );
-    assertNoError( serializerError );
+    _assertSuccessOrReportDropped( serializerError );
 
     /* Append key-value pair of "version". */
     serializerError = _pAwsIotDefenderEncoder->appendKeyValue( &headerMap,
                                                                VERSION_TAG,
                                                                IotSerializer_ScalarTextString( VERSION_1_0 ) );
-    assertNoError( serializerError );
+    _assertSuccessOrReportDropped( serializerError );
 
     /* Close the "header" map. */
     serializerError = _pAwsIotDefenderEncoder->closeContainer( &reportMap, &headerMap );
-    assertNoError( serializerError );
+    _assertSuccessOrReportDropped( serializerError );
 
     /* Count how many metrics groups user specified. */
     for( i = 0; i < DEFENDER_METRICS_GROUP_COUNT; i++ )
@@ -263,7 +329,7 @@ static void serializeReport( void )
                                                                      METRICS_TAG,
                                                                      &metricsMap,
                                                                      metricsGroupCount );
-    assertNoError( serializerError );
+    _assertSuccessOrReportDropped( serializerError );
 
     for( i = 0; i < DEFENDER_METRICS_GROUP_COUNT; i++ )
     {
@@ -285,11 +351,11 @@ static void serializeReport( void )
 
     /* Close the "metrics" map. */
     serializerError = _pAwsIotDefenderEncoder->closeContainer( &reportMap, &metricsMap );
-    assertNoError( serializerError );
+    _assertSuccessOrReportDropped( serializerError );
 
     /* Close the "report" map. */
     serializerError = _pAwsIotDefenderEncoder->closeContainer( pEncoderObject, &reportMap );
-    assertNoError( serializerError );
+    _assertSuccessOrReportDropped( serializerError );
 }
 
 /*-----------------------------------------------------------*/
@@ -334,15 +400,12 @@ static void _serializeTcpConnections( void * param1,
     uint8_t hasTotal = ( tcpConnFlag & AWS_IOT_DEFENDER_METRICS_TCP_CONNECTIONS_ESTABLISHED_TOTAL ) > 0;
     uint8_t hasRemoteAddr = ( tcpConnFlag & AWS_IOT_DEFENDER_METRICS_TCP_CONNECTIONS_ESTABLISHED_REMOTE_ADDR ) > 0;
 
-    void (* assertNoError)( IotSerializerError_t ) = _report.pDataBuffer == NULL ? _assertSuccessOrBufferToSmall
-                                                     : _assertSuccess;
-
     /* Create the "tcp_connections" map with 1 key "established_connections" */
     serializerError = _pAwsIotDefenderEncoder->openContainerWithKey( pMetricsObject,
                                                                      TCP_CONN_TAG,
                                                                      &tcpConnectionMap,
                                                                      1 );
-    assertNoError( serializerError );
+    _assertSuccessOrReportDropped( serializerError );
 
     /* if user specify any metrics under "established_connections" */
     if( hasEstablishedConnections )
@@ -352,7 +415,7 @@ static void _serializeTcpConnections( void * param1,
                                                                          EST_CONN_TAG,
                                                                          &establishedMap,
                                                                          hasConnections + hasTotal );
-        assertNoError( serializerError );
+        _assertSuccessOrReportDropped( serializerError );
 
         /* if user specify any metrics under "connections" and there are at least one connection */
         if( hasConnections )
@@ -362,7 +425,7 @@ static void _serializeTcpConnections( void * param1,
                                                                              CONN_TAG,
                                                                              &connectionsArray,
                                                                              total );
-            assertNoError( serializerError );
+            _assertSuccessOrReportDropped( serializerError );
 
             IotContainers_ForEach( pTcpConnectionsMetricsList, pListIterator )
             {
@@ -372,7 +435,7 @@ static void _serializeTcpConnections( void * param1,
                 serializerError = _pAwsIotDefenderEncoder->openContainer( &connectionsArray,
                                                                           &connectionMap,
                                                                           hasRemoteAddr );
-                assertNoError( serializerError );
+                _assertSuccessOrReportDropped( serializerError );
 
                 /* add remote address */
                 if( hasRemoteAddr )
@@ -381,15 +444,15 @@ static void _serializeTcpConnections( void * param1,
 
                     serializerError = _pAwsIotDefenderEncoder->appendKeyValue( &connectionMap, REMOTE_ADDR_TAG,
                                                                                IotSerializer_ScalarTextString( pMetricsTcpConnection->pRemoteAddress ) );
-                    assertNoError( serializerError );
+                    _assertSuccessOrReportDropped( serializerError );
                 }
 
                 serializerError = _pAwsIotDefenderEncoder->closeContainer( &connectionsArray, &connectionMap );
-                assertNoError( serializerError );
+                _assertSuccessOrReportDropped( serializerError );
             }
 
             serializerError = _pAwsIotDefenderEncoder->closeContainer( &establishedMap, &connectionsArray );
-            assertNoError( serializerError );
+            _assertSuccessOrReportDropped( serializerError );
         }
 
         if( hasTotal )
@@ -397,15 +460,15 @@ static void _serializeTcpConnections( void * param1,
             serializerError = _pAwsIotDefenderEncoder->appendKeyValue( &establishedMap,
                                                                        TOTAL_TAG,
                                                                        IotSerializer_ScalarSignedInt( total ) );
-            assertNoError( serializerError );
+            _assertSuccessOrReportDropped( serializerError );
         }
 
         serializerError = _pAwsIotDefenderEncoder->closeContainer( &tcpConnectionMap, &establishedMap );
-        assertNoError( serializerError );
+        _assertSuccessOrReportDropped( serializerError );
     }
 
     serializerError = _pAwsIotDefenderEncoder->closeContainer( pMetricsObject, &tcpConnectionMap );
-    assertNoError( serializerError );
+    _assertSuccessOrReportDropped( serializerError );
 }
 
 #if DEBUG_CBOR_PRINT == 1
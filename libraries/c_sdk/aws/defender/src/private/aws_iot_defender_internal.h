@@ -181,6 +181,15 @@
  * <b>Recommended values:</b> 0 to use short tag to reduce network transmit cost. <br>
  * <b>Default value (if undefined):</b> `0` <br>
  *
+ * @section AWS_IOT_DEFENDER_REPORT_WINDOW_SIZE
+ * @brief Size of the window a metrics report is encoded into.
+ *
+ * The report is serialized once; each time the window fills up, its contents are
+ * appended to the report buffer. The window is on the stack of the metrics task.
+ *
+ * <b>Possible values:</b>  large enough for the longest key and value, e.g. a remote address <br>
+ * <b>Default value (if undefined):</b>  `64` <br>
+ *
  * @section AWS_IOT_DEFENDER_DEFAULT_PERIOD_SECONDS
  * @brief Default period constants if users don't provide their own.
  *
@@ -243,6 +252,10 @@
     #define AWS_IOT_DEFENDER_USE_LONG_TAG    ( 0 )
 #endif
 
+#ifndef AWS_IOT_DEFENDER_REPORT_WINDOW_SIZE
+    #define AWS_IOT_DEFENDER_REPORT_WINDOW_SIZE    ( 64 )
+#endif
+
 /*----------------- Below this line is INTERNAL used only --------------------*/
 
 /* This MUST be consistent with enum AwsIotDefenderMetricsGroup_t. */
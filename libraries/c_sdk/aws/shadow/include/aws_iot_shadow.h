@@ -66,6 +66,16 @@
  * @function_brief{shadow_function_setupdatedcallback}
  * - @function_name{shadow_function_removepersistentsubscriptions}
  * @function_brief{shadow_function_removepersistentsubscriptions}
+ * - @function_name{shadow_function_createcache}
+ * @function_brief{shadow_function_createcache}
+ * - @function_name{shadow_function_destroycache}
+ * @function_brief{shadow_function_destroycache}
+ * - @function_name{shadow_function_cacheread}
+ * @function_brief{shadow_function_cacheread}
+ * - @function_name{shadow_function_cachereport}
+ * @function_brief{shadow_function_cachereport}
+ * - @function_name{shadow_function_flushcache}
+ * @function_brief{shadow_function_flushcache}
  * - @function_name{shadow_function_strerror}
  * @function_brief{shadow_function_strerror}
  */
@@ -107,6 +117,21 @@
  * @function_page{AwsIotShadow_RemovePersistentSubscriptions,shadow,removepersistentsubscriptions}
  * @function_snippet{shadow,removepersistentsubscriptions,this}
  * @copydoc AwsIotShadow_RemovePersistentSubscriptions
+ * @function_page{AwsIotShadow_CreateCache,shadow,createcache}
+ * @function_snippet{shadow,createcache,this}
+ * @copydoc AwsIotShadow_CreateCache
+ * @function_page{AwsIotShadow_DestroyCache,shadow,destroycache}
+ * @function_snippet{shadow,destroycache,this}
+ * @copydoc AwsIotShadow_DestroyCache
+ * @function_page{AwsIotShadow_CacheRead,shadow,cacheread}
+ * @function_snippet{shadow,cacheread,this}
+ * @copydoc AwsIotShadow_CacheRead
+ * @function_page{AwsIotShadow_CacheReport,shadow,cachereport}
+ * @function_snippet{shadow,cachereport,this}
+ * @copydoc AwsIotShadow_CacheReport
+ * @function_page{AwsIotShadow_FlushCache,shadow,flushcache}
+ * @function_snippet{shadow,flushcache,this}
+ * @copydoc AwsIotShadow_FlushCache
  * @function_page{AwsIotShadow_strerror,shadow,strerror}
  * @function_snippet{shadow,strerror,this}
  * @copydoc AwsIotShadow_strerror
@@ -900,6 +925,185 @@ AwsIotShadowError_t AwsIotShadow_RemovePersistentSubscriptions( IotMqttConnectio
                                                                 uint32_t flags );
 /* @[declare_shadow_removepersistentsubscriptions] */
 
+/*-------------------------- Shadow cache functions -------------------------*/
+
+/**
+ * @brief Keep a local copy of a Thing Shadow's state, so it can be read without
+ * a Shadow get.
+ *
+ * The cache subscribes to the Shadow [delta](@ref shadow_function_setdeltacallback)
+ * and [updated](@ref shadow_function_setupdatedcallback) topics of the Thing, and
+ * also applies the documents of accepted Shadow gets, updates, and deletes of the
+ * Thing. Incoming documents change only the keys they hold. Nested objects are
+ * kept as dotted key paths, such as `light.color` for `{"light":{"color":"red"}}`.
+ *
+ * Every key remembers the Shadow version that last set it, and is not changed by
+ * documents older than that. A document older than the cache does not add keys.
+ * Keys reported with @ref shadow_function_cachereport but not yet sent with @ref
+ * shadow_function_flushcache are never changed by the Shadow service.
+ *
+ * The cache is empty when created; call @ref shadow_function_get to fill it.
+ * Callbacks set with @ref shadow_function_setdeltacallback and @ref
+ * shadow_function_setupdatedcallback may be used alongside the cache, and are
+ * invoked after the cache has applied the document.
+ *
+ * @param[in] mqttConnection The MQTT connection to use for the subscriptions.
+ * @param[in] pCacheInfo The Thing Name and memory of the cache.
+ * @param[out] pCache Set to a handle of the new cache.
+ *
+ * @return One of the following:
+ * - #AWS_IOT_SHADOW_SUCCESS
+ * - #AWS_IOT_SHADOW_BAD_PARAMETER, also if the Thing already has a cache or the
+ * buffer cannot hold the cache
+ * - #AWS_IOT_SHADOW_NO_MEMORY
+ * - #AWS_IOT_SHADOW_MQTT_ERROR
+ *
+ * @note Keys whose path is longer than `AWS_IOT_SHADOW_CACHE_MAX_PATH_LENGTH`
+ * (64 by default) are not cached. Keys containing a `.` cannot be told apart
+ * from nested keys.
+ *
+ * @warning Destroy every cache with @ref shadow_function_destroycache before
+ * calling @ref shadow_function_cleanup.
+ *
+ * <b>Example</b>
+ * @code{c}
+ * #define CACHE_SIZE ( 2048 )
+ *
+ * static uint64_t pCacheBuffer[ CACHE_SIZE / sizeof( uint64_t ) ];
+ * AwsIotShadowCacheInfo_t cacheInfo = AWS_IOT_SHADOW_CACHE_INFO_INITIALIZER;
+ * AwsIotShadowCache_t cache = AWS_IOT_SHADOW_CACHE_INITIALIZER;
+ *
+ * cacheInfo.pThingName = "ThingName";
+ * cacheInfo.thingNameLength = strlen( cacheInfo.pThingName );
+ * cacheInfo.pBuffer = pCacheBuffer;
+ * cacheInfo.bufferSize = sizeof( pCacheBuffer );
+ * cacheInfo.qos = IOT_MQTT_QOS_1;
+ *
+ * if( AwsIotShadow_CreateCache( mqttConnection, &cacheInfo, &cache ) == AWS_IOT_SHADOW_SUCCESS )
+ * {
+ *     // Fill the cache with the current Shadow. The document returned does not
+ *     // need to be kept.
+ *     AwsIotShadow_TimedGet( mqttConnection, &getInfo, 0, 5000, &pDocument, &documentLength );
+ * }
+ * @endcode
+ */
+/* @[declare_shadow_createcache] */
+AwsIotShadowError_t AwsIotShadow_CreateCache( IotMqttConnection_t mqttConnection,
+                                              const AwsIotShadowCacheInfo_t * pCacheInfo,
+                                              AwsIotShadowCache_t * pCache );
+/* @[declare_shadow_createcache] */
+
+/**
+ * @brief Stop keeping a local copy of a Thing Shadow.
+ *
+ * Removes the subscriptions of the cache that no delta or updated callback uses.
+ * The buffer of the cache may be reused once this function returns. Keys reported
+ * but not flushed are lost.
+ *
+ * @param[in] mqttConnection The MQTT connection used for the subscriptions.
+ * @param[in] cache The cache to destroy.
+ *
+ * @return #AWS_IOT_SHADOW_SUCCESS or #AWS_IOT_SHADOW_BAD_PARAMETER.
+ */
+/* @[declare_shadow_destroycache] */
+AwsIotShadowError_t AwsIotShadow_DestroyCache( IotMqttConnection_t mqttConnection,
+                                               AwsIotShadowCache_t cache );
+/* @[declare_shadow_destroycache] */
+
+/**
+ * @brief Read the value of a key from a local copy of a Thing Shadow.
+ *
+ * @param[in] cache The cache to read.
+ * @param[in] section Whether to read the `desired` or `reported` state. The
+ * `reported` state includes the keys reported with @ref shadow_function_cachereport.
+ * @param[in] pKeyPath The dotted path of the key, such as `light.color`. Only keys
+ * whose value is not an object are kept.
+ * @param[in] keyPathLength The length of `pKeyPath`.
+ * @param[out] pValueBuffer Where to copy the value, as JSON text: strings keep
+ * their quotes and arrays their brackets. The value is not NULL-terminated.
+ * @param[in,out] pValueLength The size of `pValueBuffer`; set to the length of the
+ * value.
+ * @param[out] pVersion Set to the Shadow version of the document that last set
+ * the value, or 0 for a key that the Shadow service has not sent. Optional; may
+ * be `NULL`.
+ *
+ * @return One of the following:
+ * - #AWS_IOT_SHADOW_SUCCESS
+ * - #AWS_IOT_SHADOW_BAD_PARAMETER
+ * - #AWS_IOT_SHADOW_NO_MEMORY if `pValueBuffer` is `NULL` or too small; `pValueLength`
+ * is set to the size needed
+ * - #AWS_IOT_SHADOW_NOT_FOUND if the cache has no value for the key
+ */
+/* @[declare_shadow_cacheread] */
+AwsIotShadowError_t AwsIotShadow_CacheRead( AwsIotShadowCache_t cache,
+                                            AwsIotShadowCacheSection_t section,
+                                            const char * pKeyPath,
+                                            size_t keyPathLength,
+                                            char * pValueBuffer,
+                                            size_t * pValueLength,
+                                            uint32_t * pVersion );
+/* @[declare_shadow_cacheread] */
+
+/**
+ * @brief Change the `reported` value of a key in a local copy of a Thing Shadow.
+ *
+ * Nothing is sent until @ref shadow_function_flushcache, which sends every key
+ * changed since the last flush in one Shadow update. Reporting a key many times
+ * between flushes sends only its last value, and reporting the value the cache
+ * already holds sends nothing.
+ *
+ * @param[in] cache The cache to change.
+ * @param[in] pKeyPath The dotted path of the key, such as `light.color`. It may be
+ * nested at most 8 deep and be at most `AWS_IOT_SHADOW_CACHE_MAX_PATH_LENGTH` (64 by
+ * default) long. The value replaces any keys nested in this path and any value
+ * at a path containing it.
+ * @param[in] keyPathLength The length of `pKeyPath`.
+ * @param[in] pValue The new value as JSON text, e.g. `""red""`, `42`, or `[1,2]`.
+ * It is not checked. `NULL` deletes the key from the Shadow.
+ * @param[in] valueLength The length of `pValue`.
+ *
+ * @return One of the following:
+ * - #AWS_IOT_SHADOW_SUCCESS
+ * - #AWS_IOT_SHADOW_BAD_PARAMETER
+ * - #AWS_IOT_SHADOW_NO_MEMORY if the buffer of the cache is full
+ */
+/* @[declare_shadow_cachereport] */
+AwsIotShadowError_t AwsIotShadow_CacheReport( AwsIotShadowCache_t cache,
+                                              const char * pKeyPath,
+                                              size_t keyPathLength,
+                                              const char * pValue,
+                                              size_t valueLength );
+/* @[declare_shadow_cachereport] */
+
+/**
+ * @brief Send the keys reported to a local copy of a Thing Shadow in one Shadow
+ * update.
+ *
+ * The update holds only the keys changed since the last flush, nested as objects
+ * under `state.reported`, and a client token of its own. It is sent with @ref
+ * shadow_function_update and the QoS and retry settings of the cache.
+ *
+ * @param[in] mqttConnection The MQTT connection to use for the Shadow update.
+ * @param[in] cache The cache to flush.
+ * @param[in] flags Flags which modify the behavior of this function. See @ref shadow_constants_flags.
+ * @param[in] pCallbackInfo Asynchronous notification of the update's completion.
+ * @param[out] pUpdateOperation Set to a handle by which the update may be referenced
+ * after this function returns.
+ *
+ * @return #AWS_IOT_SHADOW_SUCCESS if no key was changed, in which case nothing is
+ * sent and `pUpdateOperation` is not set. Otherwise, the result of @ref
+ * shadow_function_update. If the update cannot be queued, its keys are sent by
+ * the next flush. If the Shadow service rejects it, the cache keeps the values
+ * reported until the service publishes the Shadow again.
+ */
+/* @[declare_shadow_flushcache] */
+AwsIotShadowError_t AwsIotShadow_FlushCache( IotMqttConnection_t mqttConnection,
+                                             AwsIotShadowCache_t cache,
+                                             uint32_t flags,
+                                             const AwsIotShadowCallbackInfo_t * pCallbackInfo,
+                                             AwsIotShadowOperation_t * pUpdateOperation );
+/* @[declare_shadow_flushcache] */
+
 /*------------------------- Shadow helper functions -------------------------*/
 
 /**
@@ -67,6 +67,19 @@
  */
 typedef struct _shadowOperation * AwsIotShadowOperation_t;
 
+/**
+ * @ingroup shadow_datatypes_handles
+ * @brief Opaque handle that references a local cache of a Thing Shadow.
+ *
+ * Set as an output parameter of @ref shadow_function_createcache. The cache keeps
+ * the `desired` and `reported` state of a Thing up to date from the documents the
+ * Shadow service publishes, so the application can read them without a Shadow get.
+ * It remains valid until it is passed to @ref shadow_function_destroycache.
+ *
+ * @initializer{AwsIotShadowCache_t,AWS_IOT_SHADOW_CACHE_INITIALIZER}
+ */
+typedef struct _shadowCache * AwsIotShadowCache_t;
+
 /*------------------------- Shadow enumerated types -------------------------*/
 
 /**
@@ -101,6 +114,10 @@ typedef enum AwsIotShadowError
      * - @ref shadow_function_setdeltacallback
      * - @ref shadow_function_setupdatedcallback
      * - @ref shadow_function_removepersistentsubscriptions
+     * - @ref shadow_function_createcache
+     * - @ref shadow_function_cacheread
+     * - @ref shadow_function_cachereport
+     * - @ref shadow_function_flushcache
      *
      * Will also be the value of a Shadow operation completion callback's<br>
      * [AwsIotShadowCallbackParam_t.operation.result](@ref AwsIotShadowCallbackParam_t.result)
@@ -115,6 +132,7 @@ typedef enum AwsIotShadowError
      * - @ref shadow_function_delete
      * - @ref shadow_function_get
      * - @ref shadow_function_update
+     * - @ref shadow_function_flushcache
      */
     AWS_IOT_SHADOW_STATUS_PENDING,
 
@@ -136,6 +154,9 @@ typedef enum AwsIotShadowError
      * - @ref shadow_function_wait
      * - @ref shadow_function_setdeltacallback
      * - @ref shadow_function_setupdatedcallback
+     * - @ref shadow_function_createcache
+     * - @ref shadow_function_cacheread and @ref shadow_function_cachereport
+     * - @ref shadow_function_flushcache
      */
     AWS_IOT_SHADOW_BAD_PARAMETER,
 
@@ -148,6 +169,9 @@ typedef enum AwsIotShadowError
      * - @ref shadow_function_update and @ref shadow_function_timedupdate
      * - @ref shadow_function_setdeltacallback
      * - @ref shadow_function_setupdatedcallback
+     * - @ref shadow_function_createcache
+     * - @ref shadow_function_cacheread and @ref shadow_function_cachereport
+     * - @ref shadow_function_flushcache
      */
     AWS_IOT_SHADOW_NO_MEMORY,
 
@@ -164,6 +188,8 @@ typedef enum AwsIotShadowError
      * - @ref shadow_function_setdeltacallback
      * - @ref shadow_function_setupdatedcallback
      * - @ref shadow_function_removepersistentsubscriptions
+     * - @ref shadow_function_createcache
+     * - @ref shadow_function_flushcache
      */
     AWS_IOT_SHADOW_MQTT_ERROR,
 
@@ -244,6 +270,7 @@ typedef enum AwsIotShadowError
      * - @ref shadow_function_timedget
      * - @ref shadow_function_timedupdate
      * - @ref shadow_function_wait
+     * - @ref shadow_function_cacheread, when the cache has no value for a key
      *
      * May also be the value of a Shadow operation completion callback's<br>
      * [AwsIotShadowCallbackParam_t.operation.result](@ref AwsIotShadowCallbackParam_t.result)
@@ -340,6 +367,16 @@ typedef enum AwsIotShadowCallbackType
     AWS_IOT_SHADOW_UPDATED_CALLBACK /**< Callback invoked for an incoming message on a [Shadow updated](@ref shadow_function_setupdatedcallback) topic. */
 } AwsIotShadowCallbackType_t;
 
+/**
+ * @ingroup shadow_datatypes_enums
+ * @brief The parts of a Thing Shadow's state kept by a [Shadow cache](@ref AwsIotShadowCache_t).
+ */
+typedef enum AwsIotShadowCacheSection
+{
+    AWS_IOT_SHADOW_CACHE_DESIRED = 0, /**< The `desired` state, set by applications and the Shadow service. */
+    AWS_IOT_SHADOW_CACHE_REPORTED = 1 /**< The `reported` state, set by the device. */
+} AwsIotShadowCacheSection_t;
+
 /*------------------------- Shadow parameter structs ------------------------*/
 
 /**
@@ -483,6 +520,33 @@ typedef struct AwsIotShadowDocumentInfo
     } u;                                  /**< @brief Valid member depends on operation type. */
 } AwsIotShadowDocumentInfo_t;
 
+/**
+ * @ingroup shadow_datatypes_paramstructs
+ * @brief Information on a local Shadow cache for @ref shadow_function_createcache.
+ *
+ * @paramfor @ref shadow_function_createcache
+ *
+ * The cache is kept in memory provided by the application, which must remain
+ * valid until @ref shadow_function_destroycache returns. Besides a fixed part
+ * of a few hundred bytes that holds the Thing Name, the cache uses 16 bytes per
+ * key of the state on a 32-bit target, plus the text of the key's dotted path and
+ * value.
+ *
+ * @initializer{AwsIotShadowCacheInfo_t,AWS_IOT_SHADOW_CACHE_INFO_INITIALIZER}
+ */
+typedef struct AwsIotShadowCacheInfo
+{
+    const char * pThingName; /**< @brief The Thing Name whose Shadow is cached. */
+    size_t thingNameLength;  /**< @brief Length of #AwsIotShadowCacheInfo_t.pThingName. */
+
+    void * pBuffer;          /**< @brief Memory for the cache. */
+    size_t bufferSize;       /**< @brief Size of #AwsIotShadowCacheInfo_t.pBuffer. */
+
+    IotMqttQos_t qos;        /**< @brief QoS of the updates sent by @ref shadow_function_flushcache. */
+    uint32_t retryLimit;     /**< @brief Maximum number of retries of an update sent by @ref shadow_function_flushcache. */
+    uint32_t retryMs;        /**< @brief First retry time of an update sent by @ref shadow_function_flushcache. */
+} AwsIotShadowCacheInfo_t;
+
 /*------------------------ Shadow defined constants -------------------------*/
 
 /**
@@ -507,6 +571,8 @@ typedef struct AwsIotShadowDocumentInfo
  * AwsIotShadowCallbackInfo_t callbackInfo = AWS_IOT_SHADOW_CALLBACK_INFO_INITIALIZER;
  * AwsIotShadowDocumentInfo_t documentInfo = AWS_IOT_SHADOW_DOCUMENT_INFO_INITIALIZER;
  * AwsIotShadowOperation_t operation = AWS_IOT_SHADOW_OPERATION_INITIALIZER;
+ * AwsIotShadowCacheInfo_t cacheInfo = AWS_IOT_SHADOW_CACHE_INFO_INITIALIZER;
+ * AwsIotShadowCache_t cache = AWS_IOT_SHADOW_CACHE_INITIALIZER;
  * @endcode
  *
  * @section shadow_constants_flags Shadow Function Flags
@@ -541,6 +607,8 @@ typedef struct AwsIotShadowDocumentInfo
 #define AWS_IOT_SHADOW_CALLBACK_INFO_INITIALIZER    { 0 }        /**< @brief Initializer for #AwsIotShadowCallbackInfo_t. */
 #define AWS_IOT_SHADOW_DOCUMENT_INFO_INITIALIZER    { 0 }        /**< @brief Initializer for #AwsIotShadowDocumentInfo_t. */
 #define AWS_IOT_SHADOW_OPERATION_INITIALIZER        NULL         /**< @brief Initializer for #AwsIotShadowOperation_t. */
+#define AWS_IOT_SHADOW_CACHE_INFO_INITIALIZER       { 0 }        /**< @brief Initializer for #AwsIotShadowCacheInfo_t. */
+#define AWS_IOT_SHADOW_CACHE_INITIALIZER            NULL         /**< @brief Initializer for #AwsIotShadowCache_t. */
 /* @[define_shadow_initializers] */
 
 /**
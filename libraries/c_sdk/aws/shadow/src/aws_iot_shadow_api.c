@@ -373,11 +373,16 @@ static AwsIotShadowError_t _setCallbackCommon( IotMqttConnection_t mqttConnectio
                             pThingName,
                             _pAwsIotShadowCallbackNames[ type ] );
 
-                /* Unsubscribe, then clear the callback information. */
-                ( void ) _modifyCallbackSubscriptions( mqttConnection,
-                                                       type,
-                                                       pSubscription,
-                                                       IotMqtt_TimedUnsubscribe );
+                /* Unsubscribe, then clear the callback information. A Shadow
+                 * cache keeps the topic subscribed. */
+                if( pSubscription->pCache == NULL )
+                {
+                    ( void ) _modifyCallbackSubscriptions( mqttConnection,
+                                                           type,
+                                                           pSubscription,
+                                                           IotMqtt_TimedUnsubscribe );
+                }
+
                 ( void ) memset( &( pSubscription->callbacks[ type ] ),
                                  0x00,
                                  sizeof( AwsIotShadowCallbackInfo_t ) );
@@ -398,10 +403,15 @@ static AwsIotShadowError_t _setCallbackCommon( IotMqttConnection_t mqttConnectio
                             _pAwsIotShadowCallbackNames[ type ] );
 
                 pSubscription->callbacks[ type ] = *pCallbackInfo;
-                status = _modifyCallbackSubscriptions( mqttConnection,
-                                                       type,
-                                                       pSubscription,
-                                                       IotMqtt_TimedSubscribe );
+
+                /* A Shadow cache has already subscribed to the topic. */
+                if( pSubscription->pCache == NULL )
+                {
+                    status = _modifyCallbackSubscriptions( mqttConnection,
+                                                           type,
+                                                           pSubscription,
+                                                           IotMqtt_TimedSubscribe );
+                }
             }
             /* Do nothing; set return value to success. */
             else
@@ -552,8 +562,25 @@ static void _callbackWrapperCommon( _shadowCallbackType_t type,
 {
     AwsIotShadowCallbackParam_t callbackParam = { .callbackType = ( AwsIotShadowCallbackType_t ) 0 };
 
-    /* Ensure that a callback function is set. */
-    AwsIotShadow_Assert( pSubscription->callbacks[ type ].function != NULL );
+    /* Lookup table for the Shadow cache documents of each callback. */
+    const _shadowCacheDocument_t pCacheDocument[ SHADOW_CALLBACK_COUNT ] =
+    {
+        _CACHE_DELTA,    /* Delta callback. */
+        _CACHE_DOCUMENTS /* Updated callback. */
+    };
+
+    /* Keep the Shadow cache of this Thing up to date before notifying the
+     * application, so the callback reads the new state. */
+    _AwsIotShadow_CacheDocument( pSubscription,
+                                 pCacheDocument[ type ],
+                                 pMessage->u.message.info.pPayload,
+                                 pMessage->u.message.info.payloadLength );
+
+    /* The topic may be subscribed only for the Shadow cache. */
+    if( pSubscription->callbacks[ type ].function == NULL )
+    {
+        return;
+    }
 
     /* Set the callback type. Shadow callbacks are enumerated after the operations. */
     callbackParam.callbackType = ( AwsIotShadowCallbackType_t ) ( type + SHADOW_OPERATION_COUNT );
@@ -1121,6 +1148,180 @@ AwsIotShadowError_t AwsIotShadow_SetUpdatedCallback( IotMqttConnection_t mqttCon
 
 /*-----------------------------------------------------------*/
 
+AwsIotShadowError_t AwsIotShadow_CreateCache( IotMqttConnection_t mqttConnection,
+                                              const AwsIotShadowCacheInfo_t * pCacheInfo,
+                                              AwsIotShadowCache_t * pCache )
+{
+    AwsIotShadowError_t status = AWS_IOT_SHADOW_SUCCESS;
+    _shadowSubscription_t * pSubscription = NULL;
+    _shadowCache_t * pNewCache = NULL;
+    int i = 0;
+
+    /* Check parameters. */
+    if( ( pCacheInfo == NULL ) || ( pCache == NULL ) )
+    {
+        IotLogError( "Shadow cache info and cache pointer cannot be NULL." );
+
+        return AWS_IOT_SHADOW_BAD_PARAMETER;
+    }
+
+    /* Set up the cache in the buffer given. This also checks the Thing Name. */
+    status = _AwsIotShadow_InitCache( pCacheInfo, &pNewCache );
+
+    if( status != AWS_IOT_SHADOW_SUCCESS )
+    {
+        return status;
+    }
+
+    IotLogInfo( "(%.*s) Creating Shadow cache.",
+                pCacheInfo->thingNameLength,
+                pCacheInfo->pThingName );
+
+    /* Lock the subscription list mutex to check for an existing subscription
+     * object. */
+    IotMutex_Lock( &( _AwsIotShadowSubscriptionsMutex ) );
+
+    /* Check for an existing subscription. This function will attempt to allocate
+     * a new subscription if not found. */
+    pSubscription = _AwsIotShadow_FindSubscription( pCacheInfo->pThingName,
+                                                    pCacheInfo->thingNameLength );
+
+    if( pSubscription == NULL )
+    {
+        /* No existing subscription was found, and no new subscription could be
+         * allocated. */
+        status = AWS_IOT_SHADOW_NO_MEMORY;
+    }
+    else if( pSubscription->pCache != NULL )
+    {
+        IotLogError( "(%.*s) Thing already has a Shadow cache.",
+                     pCacheInfo->thingNameLength,
+                     pCacheInfo->pThingName );
+
+        status = AWS_IOT_SHADOW_BAD_PARAMETER;
+    }
+    else
+    {
+        /* Subscribe to the delta and updated topics, unless a callback already
+         * has. */
+        for( i = 0; ( status == AWS_IOT_SHADOW_SUCCESS ) && ( i < SHADOW_CALLBACK_COUNT ); i++ )
+        {
+            if( pSubscription->callbacks[ i ].function == NULL )
+            {
+                status = _modifyCallbackSubscriptions( mqttConnection,
+                                                       ( _shadowCallbackType_t ) i,
+                                                       pSubscription,
+                                                       IotMqtt_TimedSubscribe );
+            }
+        }
+
+        if( status == AWS_IOT_SHADOW_SUCCESS )
+        {
+            pSubscription->pCache = pNewCache;
+        }
+        else
+        {
+            /* Remove the subscriptions added before the one that failed. */
+            for( i = i - 2; i >= 0; i-- )
+            {
+                if( pSubscription->callbacks[ i ].function == NULL )
+                {
+                    ( void ) _modifyCallbackSubscriptions( mqttConnection,
+                                                           ( _shadowCallbackType_t ) i,
+                                                           pSubscription,
+                                                           IotMqtt_TimedUnsubscribe );
+                }
+            }
+
+            /* Check if this subscription object can be removed. */
+            _AwsIotShadow_RemoveSubscription( pSubscription, NULL );
+        }
+    }
+
+    IotMutex_Unlock( &( _AwsIotShadowSubscriptionsMutex ) );
+
+    if( status == AWS_IOT_SHADOW_SUCCESS )
+    {
+        *pCache = pNewCache;
+    }
+    else
+    {
+        _AwsIotShadow_CleanupCache( pNewCache );
+    }
+
+    IotLogInfo( "(%.*s) Shadow cache creation complete with result %s.",
+                pCacheInfo->thingNameLength,
+                pCacheInfo->pThingName,
+                AwsIotShadow_strerror( status ) );
+
+    return status;
+}
+
+/*-----------------------------------------------------------*/
+
+AwsIotShadowError_t AwsIotShadow_DestroyCache( IotMqttConnection_t mqttConnection,
+                                               AwsIotShadowCache_t cache )
+{
+    AwsIotShadowError_t status = AWS_IOT_SHADOW_SUCCESS;
+    _shadowSubscription_t * pSubscription = NULL;
+    int i = 0;
+
+    if( cache == NULL )
+    {
+        IotLogError( "Shadow cache to destroy cannot be NULL." );
+
+        return AWS_IOT_SHADOW_BAD_PARAMETER;
+    }
+
+    IotMutex_Lock( &( _AwsIotShadowSubscriptionsMutex ) );
+
+    pSubscription = _AwsIotShadow_FindSubscription( cache->pThingName,
+                                                    cache->thingNameLength );
+
+    if( ( pSubscription == NULL ) || ( pSubscription->pCache != cache ) )
+    {
+        IotLogError( "(%.*s) Shadow cache to destroy was not found.",
+                     cache->thingNameLength,
+                     cache->pThingName );
+
+        status = AWS_IOT_SHADOW_BAD_PARAMETER;
+    }
+    else
+    {
+        /* Detach the cache, so that no more documents are applied to it. */
+        pSubscription->pCache = NULL;
+
+        /* Unsubscribe from the topics that no callback uses. */
+        for( i = 0; i < SHADOW_CALLBACK_COUNT; i++ )
+        {
+            if( pSubscription->callbacks[ i ].function == NULL )
+            {
+                ( void ) _modifyCallbackSubscriptions( mqttConnection,
+                                                       ( _shadowCallbackType_t ) i,
+                                                       pSubscription,
+                                                       IotMqtt_TimedUnsubscribe );
+            }
+        }
+    }
+
+    /* Check if this subscription object can be removed. */
+    if( pSubscription != NULL )
+    {
+        _AwsIotShadow_RemoveSubscription( pSubscription, NULL );
+    }
+
+    IotMutex_Unlock( &( _AwsIotShadowSubscriptionsMutex ) );
+
+    if( status == AWS_IOT_SHADOW_SUCCESS )
+    {
+        _AwsIotShadow_CleanupCache( cache );
+    }
+
+    return status;
+}
+
+/*-----------------------------------------------------------*/
+
 const char * AwsIotShadow_strerror( AwsIotShadowError_t status )
 {
     switch( status )
@@ -0,0 +1,1478 @@
+/*
+ * FreeRTOS Shadow V2.2.3
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+/**
+ * @file aws_iot_shadow_cache.c
+ * @brief Implements the local Shadow cache, which keeps the state of a Thing
+ * Shadow up to date from the documents published by the Shadow service.
+ */
+
+/* The config header is always included first. */
+#include "iot_config.h"
+
+/* Standard includes. */
+#include <string.h>
+
+/* Shadow internal include. */
+#include "private/aws_iot_shadow_internal.h"
+
+/* Platform layer includes. */
+#include "platform/iot_threads.h"
+
+/* JSON utilities include. */
+#include "iot_json_utils.h"
+
+/* Validate Shadow cache configuration settings. */
+#if AWS_IOT_SHADOW_CACHE_MAX_PATH_LENGTH <= 0 || AWS_IOT_SHADOW_CACHE_MAX_PATH_LENGTH > UINT16_MAX
+    #error "AWS_IOT_SHADOW_CACHE_MAX_PATH_LENGTH must be between 1 and 65535."
+#endif
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Alignment of a Shadow cache in the buffer given by the application.
+ */
+#define CACHE_ALIGNMENT                ( 8U )
+
+/**
+ * @brief The document written by #_AwsIotShadow_GenerateCacheUpdate starts with
+ * this prefix, followed by the changed keys.
+ */
+#define CACHE_UPDATE_PREFIX            "{\"state\":{\"reported\":{"
+
+/**
+ * @brief Follows the changed keys in the document written by
+ * #_AwsIotShadow_GenerateCacheUpdate, then the number of the update and a closing
+ * `"}`.
+ */
+#define CACHE_UPDATE_SUFFIX            "}},\"" CLIENT_TOKEN_KEY "\":\"shadowcache-"
+
+/**
+ * @brief Relations between two key paths, used by #_removeRelated.
+ */
+#define CACHE_RELATION_EXACT           ( 0x01U ) /**< @brief The same path. */
+#define CACHE_RELATION_ANCESTOR        ( 0x02U ) /**< @brief An object containing the path. */
+#define CACHE_RELATION_DESCENDANT      ( 0x04U ) /**< @brief A key nested in the path. */
+
+/**
+ * @brief Indexes of the keys of #_cacheQuery.
+ */
+#define QUERY_VERSION                  ( 0 ) /**< @brief `version`. */
+#define QUERY_STATE                    ( 1 ) /**< @brief `state`. */
+#define QUERY_STATE_DESIRED            ( 2 ) /**< @brief `state.desired`. */
+#define QUERY_STATE_REPORTED           ( 3 ) /**< @brief `state.reported`. */
+#define QUERY_CURRENT_VERSION          ( 5 ) /**< @brief `current.version`. */
+#define QUERY_CURRENT_DESIRED          ( 7 ) /**< @brief `current.state.desired`. */
+#define QUERY_CURRENT_REPORTED         ( 8 ) /**< @brief `current.state.reported`. */
+#define CACHE_QUERY_LENGTH             ( 9 ) /**< @brief Number of keys in #_cacheQuery. */
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Parameters of a document being merged into a Shadow cache.
+ */
+typedef struct _mergeContext
+{
+    _shadowCache_t * pCache;                          /**< @brief The cache. */
+    uint8_t section;                                  /**< @brief The #AwsIotShadowCacheSection_t being merged. */
+    uint32_t version;                                 /**< @brief Shadow version of the document. */
+    bool addKeys;                                     /**< @brief Whether keys not in the cache may be added. */
+    bool markSeen;                                    /**< @brief Whether to set #SHADOW_CACHE_ENTRY_SEEN. */
+    char pPath[ AWS_IOT_SHADOW_CACHE_MAX_PATH_LENGTH ]; /**< @brief Path of the key being merged. */
+} _mergeContext_t;
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Check whether a document of a given version may change a key.
+ *
+ * Keys reported by the application are only changed by the application, and no
+ * key is changed by a document older than the one that last set it.
+ *
+ * @param[in] pEntry The key.
+ * @param[in] version Shadow version of the document.
+ *
+ * @return `true` if the document may change the key; `false` otherwise.
+ */
+static bool _isApplicable( const _shadowCacheEntry_t * pEntry,
+                           uint32_t version );
+
+/**
+ * @brief Find the relation of a key path to another.
+ *
+ * @param[in] pEntryPath The key path to classify.
+ * @param[in] entryPathLength Length of `pEntryPath`.
+ * @param[in] pPath The key path to compare with.
+ * @param[in] pathLength Length of `pPath`.
+ *
+ * @return One of the `CACHE_RELATION_` flags, or `0` for unrelated paths.
+ */
+static uint8_t _relation( const char * pEntryPath,
+                          size_t entryPathLength,
+                          const char * pPath,
+                          size_t pathLength );
+
+/**
+ * @brief Find a key in a Shadow cache.
+ *
+ * @param[in] pCache The cache.
+ * @param[in] section The #AwsIotShadowCacheSection_t of the key.
+ * @param[in] pPath The dotted key path.
+ * @param[in] pathLength Length of `pPath`.
+ *
+ * @return The key, or `NULL` if it is not in the cache.
+ */
+static _shadowCacheEntry_t * _findEntry( _shadowCache_t * pCache,
+                                         uint8_t section,
+                                         const char * pPath,
+                                         size_t pathLength );
+
+/**
+ * @brief Remove a key from a Shadow cache.
+ *
+ * The last key of the cache takes the place of the removed key.
+ *
+ * @param[in] pCache The cache.
+ * @param[in] pEntry The key to remove.
+ */
+static void _removeEntry( _shadowCache_t * pCache,
+                          _shadowCacheEntry_t * pEntry );
+
+/**
+ * @brief Remove the keys of a section that have a relation to a key path.
+ *
+ * @param[in] pCache The cache.
+ * @param[in] section The #AwsIotShadowCacheSection_t of the keys.
+ * @param[in] pPath The key path.
+ * @param[in] pathLength Length of `pPath`.
+ * @param[in] relations Bitwise OR of the `CACHE_RELATION_` flags to remove.
+ * @param[in] pVersion Shadow version of the document causing the removal; `NULL`
+ * for a change made by the application, which removes keys unconditionally.
+ */
+static void _removeRelated( _shadowCache_t * pCache,
+                            uint8_t section,
+                            const char * pPath,
+                            size_t pathLength,
+                            uint8_t relations,
+                            const uint32_t * pVersion );
+
+/**
+ * @brief Move the text of all keys to the end of the buffer, reclaiming the
+ * space of text no longer used.
+ *
+ * @param[in] pCache The cache.
+ */
+static void _compactText( _shadowCache_t * pCache );
+
+/**
+ * @brief Allocate the text of a key.
+ *
+ * @param[in] pCache The cache.
+ * @param[in] pEntry The key whose text will be replaced; `NULL` for a new key,
+ * in which case space for its entry is also reserved.
+ * @param[in] textLength Length of the new text.
+ *
+ * @return The new text, or `NULL` if the cache is full. The current text of `pEntry`
+ * is released only on success.
+ */
+static char * _allocateText( _shadowCache_t * pCache,
+                             _shadowCacheEntry_t * pEntry,
+                             size_t textLength );
+
+/**
+ * @brief Set the value of a key, adding the key if needed.
+ *
+ * @param[in] pCache The cache.
+ * @param[in] pEntry The key to change, or `NULL` to add a new key.
+ * @param[in] section The #AwsIotShadowCacheSection_t of the key.
+ * @param[in] pPath The dotted key path.
+ * @param[in] pathLength Length of `pPath`.
+ * @param[in] pValue The new value.
+ * @param[in] valueLength Length of `pValue`.
+ *
+ * @return The key, or `NULL` if the cache is full.
+ */
+static _shadowCacheEntry_t * _storeValue( _shadowCache_t * pCache,
+                                          _shadowCacheEntry_t * pEntry,
+                                          uint8_t section,
+                                          const char * pPath,
+                                          size_t pathLength,
+                                          const char * pValue,
+                                          size_t valueLength );
+
+/**
+ * @brief Remove the keys of a section not found in a document that replaces it.
+ *
+ * Also clears #SHADOW_CACHE_ENTRY_SEEN from the keys that remain.
+ *
+ * @param[in] pCache The cache.
+ * @param[in] section The #AwsIotShadowCacheSection_t to sweep.
+ * @param[in] version Shadow version of the document.
+ */
+static void _sweepSection( _shadowCache_t * pCache,
+                           uint8_t section,
+                           uint32_t version );
+
+/**
+ * @brief Merge a key of a document whose value is not an object.
+ *
+ * @param[in] pContext The document being merged; its path holds the key path.
+ * @param[in] pathLength Length of the key path.
+ * @param[in] pValue The value of the key.
+ * @param[in] valueLength Length of `pValue`.
+ */
+static void _mergeValue( _mergeContext_t * pContext,
+                         size_t pathLength,
+                         const char * pValue,
+                         size_t valueLength );
+
+/**
+ * @brief Merge the keys of an object of a document.
+ *
+ * @param[in] pContext The document being merged; its path holds the path of the
+ * object.
+ * @param[in] pObject The object.
+ * @param[in] objectLength Length of `pObject`.
+ * @param[in] pathLength Length of the path of `pObject`; `0` for a section.
+ * @param[in] depth Depth of `pObject` below the section.
+ */
+static void _mergeObject( _mergeContext_t * pContext,
+                          const char * pObject,
+                          size_t objectLength,
+                          size_t pathLength,
+                          uint32_t depth );
+
+/**
+ * @brief Apply the `desired` or `reported` state of a document to a Shadow cache.
+ *
+ * @param[in] pContext The document being merged.
+ * @param[in] section The #AwsIotShadowCacheSection_t of the state.
+ * @param[in] pState The state found in the document.
+ * @param[in] replace Whether the state is complete and replaces the section, or
+ * only holds the keys that changed.
+ */
+static void _applyState( _mergeContext_t * pContext,
+                         uint8_t section,
+                         const IotJsonQueryResult_t * pState,
+                         bool replace );
+
+/**
+ * @brief Read a Shadow version from a document.
+ *
+ * @param[in] pVersion The value of a `version` key.
+ * @param[in] defaultVersion The version to use if `pVersion` is not a valid version.
+ *
+ * @return The Shadow version.
+ */
+static uint32_t _parseVersion( const IotJsonQueryResult_t * pVersion,
+                               uint32_t defaultVersion );
+
+/**
+ * @brief Append text to a document if it fits.
+ *
+ * @param[out] pBuffer The document; may be `NULL`.
+ * @param[in] bufferSize The size of `pBuffer`.
+ * @param[in,out] pLength The length of the document, which is always updated.
+ * @param[in] pText The text to append.
+ * @param[in] textLength Length of `pText`.
+ */
+static void _appendText( char * pBuffer,
+                         size_t bufferSize,
+                         size_t * pLength,
+                         const char * pText,
+                         size_t textLength );
+
+/**
+ * @brief Find the changed key that comes next in the order of key paths.
+ *
+ * @param[in] pCache The cache.
+ * @param[in] pPrevious The last key written; `NULL` for the first key.
+ *
+ * @return The next changed key, or `NULL` if there are no more.
+ */
+static const _shadowCacheEntry_t * _nextChangedEntry( const _shadowCache_t * pCache,
+                                                      const _shadowCacheEntry_t * pPrevious );
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief The keys looked up in every document applied to a Shadow cache.
+ *
+ * Delta and accepted documents keep the state at the root; `update/documents`
+ * keeps the new state under `current`.
+ */
+static const IotJsonQueryKey_t _cacheQuery[ CACHE_QUERY_LENGTH ] =
+{
+    IOT_JSON_QUERY_KEY( IOT_JSON_QUERY_ROOT, "version" ),  /* QUERY_VERSION */
+    IOT_JSON_QUERY_KEY( IOT_JSON_QUERY_ROOT, "state" ),    /* QUERY_STATE */
+    IOT_JSON_QUERY_KEY( QUERY_STATE, "desired" ),          /* QUERY_STATE_DESIRED */
+    IOT_JSON_QUERY_KEY( QUERY_STATE, "reported" ),         /* QUERY_STATE_REPORTED */
+    IOT_JSON_QUERY_KEY( IOT_JSON_QUERY_ROOT, "current" ),
+    IOT_JSON_QUERY_KEY( 4, "version" ),                    /* QUERY_CURRENT_VERSION */
+    IOT_JSON_QUERY_KEY( 4, "state" ),
+    IOT_JSON_QUERY_KEY( 6, "desired" ),                    /* QUERY_CURRENT_DESIRED */
+    IOT_JSON_QUERY_KEY( 6, "reported" )                    /* QUERY_CURRENT_REPORTED */
+};
+
+/*-----------------------------------------------------------*/
+
+static bool _isApplicable( const _shadowCacheEntry_t * pEntry,
+                           uint32_t version )
+{
+    return ( ( pEntry->flags & ( SHADOW_CACHE_ENTRY_DIRTY | SHADOW_CACHE_ENTRY_SENDING ) ) == 0U ) &&
+           ( pEntry->version <= version );
+}
+
+/*-----------------------------------------------------------*/
+
+static uint8_t _relation( const char * pEntryPath,
+                          size_t entryPathLength,
+                          const char * pPath,
+                          size_t pathLength )
+{
+    uint8_t relation = 0;
+
+    if( entryPathLength == pathLength )
+    {
+        if( memcmp( pEntryPath, pPath, pathLength ) == 0 )
+        {
+            relation = CACHE_RELATION_EXACT;
+        }
+    }
+    else if( entryPathLength > pathLength )
+    {
+        if( ( pEntryPath[ pathLength ] == '.' ) &&
+            ( memcmp( pEntryPath, pPath, pathLength ) == 0 ) )
+        {
+            relation = CACHE_RELATION_DESCENDANT;
+        }
+    }
+    else
+    {
+        if( ( pPath[ entryPathLength ] == '.' ) &&
+            ( memcmp( pEntryPath, pPath, entryPathLength ) == 0 ) )
+        {
+            relation = CACHE_RELATION_ANCESTOR;
+        }
+    }
+
+    return relation;
+}
+
+/*-----------------------------------------------------------*/
+
+static _shadowCacheEntry_t * _findEntry( _shadowCache_t * pCache,
+                                         uint8_t section,
+                                         const char * pPath,
+                                         size_t pathLength )
+{
+    size_t i = 0;
+    _shadowCacheEntry_t * pEntry = NULL;
+
+    for( i = 0; i < pCache->entryCount; i++ )
+    {
+        if( ( pCache->pEntries[ i ].section == section ) &&
+            ( pCache->pEntries[ i ].pathLength == pathLength ) &&
+            ( memcmp( pCache->pEntries[ i ].pText, pPath, pathLength ) == 0 ) )
+        {
+            pEntry = &( pCache->pEntries[ i ] );
+            break;
+        }
+    }
+
+    return pEntry;
+}
+
+/*-----------------------------------------------------------*/
+
+static void _removeEntry( _shadowCache_t * pCache,
+                          _shadowCacheEntry_t * pEntry )
+{
+    pCache->unusedText += pEntry->pathLength + pEntry->valueLength;
+    pCache->entryCount--;
+    *pEntry = pCache->pEntries[ pCache->entryCount ];
+}
+
+/*-----------------------------------------------------------*/
+
+static void _removeRelated( _shadowCache_t * pCache,
+                            uint8_t section,
+                            const char * pPath,
+                            size_t pathLength,
+                            uint8_t relations,
+                            const uint32_t * pVersion )
+{
+    size_t i = 0;
+    _shadowCacheEntry_t * pEntry = NULL;
+
+    while( i < pCache->entryCount )
+    {
+        pEntry = &( pCache->pEntries[ i ] );
+
+        if( ( pEntry->section == section ) &&
+            ( ( pVersion == NULL ) || ( _isApplicable( pEntry, *pVersion ) == true ) ) &&
+            ( ( _relation( pEntry->pText, pEntry->pathLength, pPath, pathLength ) & relations ) != 0U ) )
+        {
+            /* The last key now takes this place; check it next. */
+            _removeEntry( pCache, pEntry );
+        }
+        else
+        {
+            i++;
+        }
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+static void _compactText( _shadowCache_t * pCache )
+{
+    size_t i = 0, textLength = 0;
+    char * pTop = pCache->pEnd, * pLimit = pCache->pEnd;
+    _shadowCacheEntry_t * pNext = NULL;
+
+    /* Move the texts one at a time, from the highest address down, so that each
+     * is only moved up over text that is no longer used. */
+    do
+    {
+        pNext = NULL;
+
+        for( i = 0; i < pCache->entryCount; i++ )
+        {
+            if( ( pCache->pEntries[ i ].pText != NULL ) &&
+                ( pCache->pEntries[ i ].pText < pLimit ) &&
+                ( ( pNext == NULL ) || ( pCache->pEntries[ i ].pText > pNext->pText ) ) )
+            {
+                pNext = &( pCache->pEntries[ i ] );
+            }
+        }
+
+        if( pNext != NULL )
+        {
+            textLength = pNext->pathLength + pNext->valueLength;
+            pLimit = pNext->pText;
+            pTop -= textLength;
+
+            ( void ) memmove( pTop, pNext->pText, textLength );
+            pNext->pText = pTop;
+        }
+    } while( pNext != NULL );
+
+    pCache->pTextStart = pTop;
+    pCache->unusedText = 0;
+}
+
+/*-----------------------------------------------------------*/
+
+static char * _allocateText( _shadowCache_t * pCache,
+                             _shadowCacheEntry_t * pEntry,
+                             size_t textLength )
+{
+    char * pText = NULL;
+    size_t freeSpace = ( size_t ) ( pCache->pTextStart -
+                                    ( char * ) &( pCache->pEntries[ pCache->entryCount ] ) );
+    size_t reclaimable = pCache->unusedText;
+    size_t required = textLength;
+
+    if( pEntry == NULL )
+    {
+        required += sizeof( _shadowCacheEntry_t );
+    }
+    else
+    {
+        reclaimable += pEntry->pathLength + pEntry->valueLength;
+    }
+
+    if( freeSpace + reclaimable >= required )
+    {
+        /* Release the current text of the key. */
+        if( pEntry != NULL )
+        {
+            pCache->unusedText += pEntry->pathLength + pEntry->valueLength;
+            pEntry->pText = NULL;
+        }
+
+        if( freeSpace < required )
+        {
+            _compactText( pCache );
+        }
+
+        pCache->pTextStart -= textLength;
+        pText = pCache->pTextStart;
+    }
+
+    return pText;
+}
+
+/*-----------------------------------------------------------*/
+
+static _shadowCacheEntry_t * _storeValue( _shadowCache_t * pCache,
+                                          _shadowCacheEntry_t * pEntry,
+                                          uint8_t section,
+                                          const char * pPath,
+                                          size_t pathLength,
+                                          const char * pValue,
+                                          size_t valueLength )
+{
+    char * pText = NULL;
+
+    if( ( pEntry != NULL ) && ( valueLength <= pEntry->valueLength ) )
+    {
+        /* A value no longer than the current one is replaced in place. */
+        pCache->unusedText += pEntry->valueLength - valueLength;
+        ( void ) memcpy( pEntry->pText + pEntry->pathLength, pValue, valueLength );
+        pEntry->valueLength = valueLength;
+    }
+    else
+    {
+        pText = _allocateText( pCache, pEntry, pathLength + valueLength );
+
+        if( pText == NULL )
+        {
+            pEntry = NULL;
+        }
+        else
+        {
+            if( pEntry == NULL )
+            {
+                pEntry = &( pCache->pEntries[ pCache->entryCount ] );
+                pCache->entryCount++;
+
+                ( void ) memset( pEntry, 0x00, sizeof( _shadowCacheEntry_t ) );
+                pEntry->section = section;
+                pEntry->pathLength = ( uint16_t ) pathLength;
+            }
+
+            ( void ) memcpy( pText, pPath, pathLength );
+            ( void ) memcpy( pText + pathLength, pValue, valueLength );
+            pEntry->pText = pText;
+            pEntry->valueLength = valueLength;
+        }
+    }
+
+    return pEntry;
+}
+
+/*-----------------------------------------------------------*/
+
+static void _sweepSection( _shadowCache_t * pCache,
+                           uint8_t section,
+                           uint32_t version )
+{
+    size_t i = 0;
+    _shadowCacheEntry_t * pEntry = NULL;
+
+    while( i < pCache->entryCount )
+    {
+        pEntry = &( pCache->pEntries[ i ] );
+
+        if( ( pEntry->section == section ) &&
+            ( ( pEntry->flags & SHADOW_CACHE_ENTRY_SEEN ) == 0U ) &&
+            ( _isApplicable( pEntry, version ) == true ) )
+        {
+            _removeEntry( pCache, pEntry );
+        }
+        else
+        {
+            pEntry->flags &= ( uint8_t ) ~SHADOW_CACHE_ENTRY_SEEN;
+            i++;
+        }
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+static void _mergeValue( _mergeContext_t * pContext,
+                         size_t pathLength,
+                         const char * pValue,
+                         size_t valueLength )
+{
+    _shadowCache_t * pCache = pContext->pCache;
+    _shadowCacheEntry_t * pEntry = NULL;
+
+    /* A value replaces any object that was at its path. */
+    _removeRelated( pCache,
+                    pContext->section,
+                    pContext->pPath,
+                    pathLength,
+                    CACHE_RELATION_DESCENDANT,
+                    &( pContext->version ) );
+
+    pEntry = _findEntry( pCache, pContext->section, pContext->pPath, pathLength );
+
+    if( pEntry == NULL )
+    {
+        if( pContext->addKeys == true )
+        {
+            pEntry = _storeValue( pCache,
+                                  NULL,
+                                  pContext->section,
+                                  pContext->pPath,
+                                  pathLength,
+                                  pValue,
+                                  valueLength );
+
+            if( pEntry == NULL )
+            {
+                IotLogWarn( "Shadow cache of %.*s is full. Key %.*s was not cached.",
+                            pCache->thingNameLength,
+                            pCache->pThingName,
+                            pathLength,
+                            pContext->pPath );
+            }
+        }
+    }
+    else if( _isApplicable( pEntry, pContext->version ) == true )
+    {
+        if( ( pEntry->valueLength != valueLength ) ||
+            ( memcmp( pEntry->pText + pEntry->pathLength, pValue, valueLength ) != 0 ) )
+        {
+            if( _storeValue( pCache,
+                             pEntry,
+                             pContext->section,
+                             pContext->pPath,
+                             pathLength,
+                             pValue,
+                             valueLength ) == NULL )
+            {
+                IotLogWarn( "Shadow cache of %.*s is full. Key %.*s was removed.",
+                            pCache->thingNameLength,
+                            pCache->pThingName,
+                            pathLength,
+                            pContext->pPath );
+
+                /* The old value is out of date and must not be kept. */
+                _removeEntry( pCache, pEntry );
+                pEntry = NULL;
+            }
+        }
+    }
+    else
+    {
+        /* The key was set by a newer document or by the application. */
+        pEntry = NULL;
+    }
+
+    if( pEntry != NULL )
+    {
+        pEntry->version = pContext->version;
+
+        if( pContext->markSeen == true )
+        {
+            pEntry->flags |= SHADOW_CACHE_ENTRY_SEEN;
+        }
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+static void _mergeObject( _mergeContext_t * pContext,
+                          const char * pObject,
+                          size_t objectLength,
+                          size_t pathLength,
+                          uint32_t depth )
+{
+    size_t offset = 0, keyLength = 0, valueLength = 0, childPathLength = 0;
+    const char * pKey = NULL, * pValue = NULL;
+
+    while( IotJsonUtils_NextObjectMember( pObject,
+                                          objectLength,
+                                          &offset,
+                                          &pKey,
+                                          &keyLength,
+                                          &pValue,
+                                          &valueLength ) == true )
+    {
+        /* Keys of nested objects are joined with dots. */
+        childPathLength = ( pathLength > 0U ) ? ( pathLength + 1U + keyLength ) : keyLength;
+
+        if( ( keyLength == 0U ) || ( childPathLength > AWS_IOT_SHADOW_CACHE_MAX_PATH_LENGTH ) )
+        {
+            IotLogWarn( "Shadow cache of %.*s ignored key %.*s, whose path is empty "
+                        "or longer than %d.",
+                        pContext->pCache->thingNameLength,
+                        pContext->pCache->pThingName,
+                        keyLength,
+                        pKey,
+                        AWS_IOT_SHADOW_CACHE_MAX_PATH_LENGTH );
+
+            continue;
+        }
+
+        if( pathLength > 0U )
+        {
+            pContext->pPath[ pathLength ] = '.';
+        }
+
+        ( void ) memcpy( pContext->pPath + childPathLength - keyLength, pKey, keyLength );
+
+        if( pValue[ 0 ] == '{' )
+        {
+            /* The keys of this object are one level deeper than the object. */
+            if( ( depth + 1U ) < MAX_STATE_DEPTH )
+            {
+                /* An object replaces any value that was at its path. */
+                _removeRelated( pContext->pCache,
+                                pContext->section,
+                                pContext->pPath,
+                                childPathLength,
+                                CACHE_RELATION_EXACT,
+                                &( pContext->version ) );
+
+                _mergeObject( pContext, pValue, valueLength, childPathLength, depth + 1U );
+            }
+            else
+            {
+                IotLogWarn( "Shadow cache of %.*s ignored key %.*s, whose keys are "
+                            "nested deeper than %d.",
+                            pContext->pCache->thingNameLength,
+                            pContext->pCache->pThingName,
+                            childPathLength,
+                            pContext->pPath,
+                            MAX_STATE_DEPTH );
+            }
+        }
+        else if( ( valueLength == 4U ) && ( strncmp( pValue, "null", 4 ) == 0 ) )
+        {
+            /* A null value deletes the key and everything nested in it. */
+            _removeRelated( pContext->pCache,
+                            pContext->section,
+                            pContext->pPath,
+                            childPathLength,
+                            CACHE_RELATION_EXACT | CACHE_RELATION_DESCENDANT,
+                            &( pContext->version ) );
+        }
+        else
+        {
+            _mergeValue( pContext, childPathLength, pValue, valueLength );
+        }
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+static void _applyState( _mergeContext_t * pContext,
+                         uint8_t section,
+                         const IotJsonQueryResult_t * pState,
+                         bool replace )
+{
+    pContext->section = section;
+    pContext->markSeen = replace;
+
+    if( pState->count == 0U )
+    {
+        /* A complete state without this section has no keys in it. */
+        if( replace == true )
+        {
+            _sweepSection( pContext->pCache, section, pContext->version );
+        }
+    }
+    else if( pState->pValue[ 0 ] == '{' )
+    {
+        _mergeObject( pContext, pState->pValue, pState->valueLength, 0, 0 );
+
+        if( replace == true )
+        {
+            _sweepSection( pContext->pCache, section, pContext->version );
+        }
+    }
+    else if( ( pState->valueLength == 4U ) && ( strncmp( pState->pValue, "null", 4 ) == 0 ) )
+    {
+        /* A null section deletes all of its keys. No key is marked seen. */
+        _sweepSection( pContext->pCache, section, pContext->version );
+    }
+    else
+    {
+        IotLogWarn( "Shadow cache of %.*s ignored a state that is not an object.",
+                    pContext->pCache->thingNameLength,
+                    pContext->pCache->pThingName );
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+static uint32_t _parseVersion( const IotJsonQueryResult_t * pVersion,
+                               uint32_t defaultVersion )
+{
+    uint32_t version = 0;
+    size_t i = 0;
+    bool valid = ( pVersion->count > 0U ) && ( pVersion->valueLength > 0U ) &&
+                 ( pVersion->valueLength <= 10U );
+
+    for( i = 0; ( valid == true ) && ( i < pVersion->valueLength ); i++ )
+    {
+        if( ( pVersion->pValue[ i ] >= '0' ) && ( pVersion->pValue[ i ] <= '9' ) &&
+            ( version <= ( ( UINT32_MAX - 9U ) / 10U ) ) )
+        {
+            version = ( version * 10U ) + ( uint32_t ) ( pVersion->pValue[ i ] - '0' );
+        }
+        else
+        {
+            valid = false;
+        }
+    }
+
+    return ( valid == true ) ? version : defaultVersion;
+}
+
+/*-----------------------------------------------------------*/
+
+static void _appendText( char * pBuffer,
+                         size_t bufferSize,
+                         size_t * pLength,
+                         const char * pText,
+                         size_t textLength )
+{
+    if( ( pBuffer != NULL ) && ( textLength <= bufferSize ) &&
+        ( *pLength <= bufferSize - textLength ) )
+    {
+        ( void ) memcpy( pBuffer + *pLength, pText, textLength );
+    }
+
+    *pLength += textLength;
+}
+
+/*-----------------------------------------------------------*/
+
+static const _shadowCacheEntry_t * _nextChangedEntry( const _shadowCache_t * pCache,
+                                                      const _shadowCacheEntry_t * pPrevious )
+{
+    size_t i = 0, length = 0;
+    int order = 0;
+    const _shadowCacheEntry_t * pEntry = NULL, * pNext = NULL;
+
+    for( i = 0; i < pCache->entryCount; i++ )
+    {
+        pEntry = &( pCache->pEntries[ i ] );
+
+        if( ( ( pEntry->flags & SHADOW_CACHE_ENTRY_DIRTY ) == 0U ) ||
+            ( pEntry->section != ( uint8_t ) AWS_IOT_SHADOW_CACHE_REPORTED ) )
+        {
+            continue;
+        }
+
+        /* Skip the keys up to and including the previous one. */
+        if( pPrevious != NULL )
+        {
+            length = ( pEntry->pathLength < pPrevious->pathLength ) ? pEntry->pathLength : pPrevious->pathLength;
+            order = memcmp( pEntry->pText, pPrevious->pText, length );
+
+            if( ( order < 0 ) || ( ( order == 0 ) && ( pEntry->pathLength <= pPrevious->pathLength ) ) )
+            {
+                continue;
+            }
+        }
+
+        /* Keep the lowest of the remaining keys. */
+        if( pNext != NULL )
+        {
+            length = ( pEntry->pathLength < pNext->pathLength ) ? pEntry->pathLength : pNext->pathLength;
+            order = memcmp( pEntry->pText, pNext->pText, length );
+
+            if( ( order > 0 ) || ( ( order == 0 ) && ( pEntry->pathLength > pNext->pathLength ) ) )
+            {
+                continue;
+            }
+        }
+
+        pNext = pEntry;
+    }
+
+    return pNext;
+}
+
+/*-----------------------------------------------------------*/
+
+AwsIotShadowError_t _AwsIotShadow_InitCache( const AwsIotShadowCacheInfo_t * pCacheInfo,
+                                             _shadowCache_t ** pNewCache )
+{
+    _shadowCache_t * pCache = NULL;
+    uintptr_t start = 0, end = 0;
+
+    /* Check the Thing Name. */
+    if( ( pCacheInfo->pThingName == NULL ) || ( pCacheInfo->thingNameLength == 0U ) ||
+        ( pCacheInfo->thingNameLength > MAX_THING_NAME_LENGTH ) )
+    {
+        IotLogError( "Thing Name of a Shadow cache must be between 1 and %d characters.",
+                     MAX_THING_NAME_LENGTH );
+
+        return AWS_IOT_SHADOW_BAD_PARAMETER;
+    }
+
+    /* Check that the buffer holds at least the cache itself. */
+    if( pCacheInfo->pBuffer != NULL )
+    {
+        start = ( ( uintptr_t ) pCacheInfo->pBuffer + ( CACHE_ALIGNMENT - 1U ) ) &
+                ~( ( uintptr_t ) CACHE_ALIGNMENT - 1U );
+        end = ( uintptr_t ) pCacheInfo->pBuffer + pCacheInfo->bufferSize;
+    }
+
+    if( ( start == 0U ) || ( end < start ) || ( end - start < sizeof( _shadowCache_t ) ) )
+    {
+        IotLogError( "Buffer of Shadow cache of %.*s must be at least %lu bytes.",
+                     pCacheInfo->thingNameLength,
+                     pCacheInfo->pThingName,
+                     ( unsigned long ) ( sizeof( _shadowCache_t ) + CACHE_ALIGNMENT - 1U ) );
+
+        return AWS_IOT_SHADOW_BAD_PARAMETER;
+    }
+
+    pCache = ( _shadowCache_t * ) start;
+    ( void ) memset( pCache, 0x00, sizeof( _shadowCache_t ) );
+
+    if( IotMutex_Create( &( pCache->mutex ), false ) == false )
+    {
+        IotLogError( "Failed to create mutex for Shadow cache of %.*s.",
+                     pCacheInfo->thingNameLength,
+                     pCacheInfo->pThingName );
+
+        return AWS_IOT_SHADOW_NO_MEMORY;
+    }
+
+    pCache->qos = pCacheInfo->qos;
+    pCache->retryLimit = pCacheInfo->retryLimit;
+    pCache->retryMs = pCacheInfo->retryMs;
+    pCache->pEnd = ( char * ) end;
+    pCache->pTextStart = pCache->pEnd;
+    pCache->thingNameLength = pCacheInfo->thingNameLength;
+    ( void ) memcpy( pCache->pThingName, pCacheInfo->pThingName, pCacheInfo->thingNameLength );
+
+    *pNewCache = pCache;
+
+    return AWS_IOT_SHADOW_SUCCESS;
+}
+
+/*-----------------------------------------------------------*/
+
+void _AwsIotShadow_CleanupCache( _shadowCache_t * pCache )
+{
+    IotMutex_Destroy( &( pCache->mutex ) );
+}
+
+/*-----------------------------------------------------------*/
+
+void _AwsIotShadow_ApplyCacheDocument( _shadowCache_t * pCache,
+                                       _shadowCacheDocument_t type,
+                                       const char * pDocument,
+                                       size_t documentLength )
+{
+    size_t i = 0;
+    IotJsonQueryResult_t pResults[ CACHE_QUERY_LENGTH ];
+    _mergeContext_t context = { .pCache = pCache };
+
+    /* Find all the keys needed from the document before locking the cache. */
+    if( IotJsonUtils_Query( pDocument,
+                            documentLength,
+                            _cacheQuery,
+                            CACHE_QUERY_LENGTH,
+                            pResults ) == false )
+    {
+        IotLogWarn( "Shadow cache of %.*s ignored a document that is not valid JSON.",
+                    pCache->thingNameLength,
+                    pCache->pThingName );
+
+        return;
+    }
+
+    IotMutex_Lock( &( pCache->mutex ) );
+
+    /* A document without a version is taken to be current. */
+    context.version = _parseVersion( &( pResults[ ( type == _CACHE_DOCUMENTS ) ?
+                                                  QUERY_CURRENT_VERSION : QUERY_VERSION ] ),
+                                     pCache->version );
+
+    /* Keys are updated by any document newer than the one that set them, but a
+     * document older than the cache cannot bring back keys it no longer has. */
+    context.addKeys = ( context.version >= pCache->version );
+
+    switch( type )
+    {
+        case _CACHE_DELTA:
+            _applyState( &context,
+                         ( uint8_t ) AWS_IOT_SHADOW_CACHE_DESIRED,
+                         &( pResults[ QUERY_STATE ] ),
+                         false );
+            break;
+
+        case _CACHE_DOCUMENTS:
+            _applyState( &context,
+                         ( uint8_t ) AWS_IOT_SHADOW_CACHE_DESIRED,
+                         &( pResults[ QUERY_CURRENT_DESIRED ] ),
+                         true );
+            _applyState( &context,
+                         ( uint8_t ) AWS_IOT_SHADOW_CACHE_REPORTED,
+                         &( pResults[ QUERY_CURRENT_REPORTED ] ),
+                         true );
+            break;
+
+        case _CACHE_GET_ACCEPTED:
+            _applyState( &context,
+                         ( uint8_t ) AWS_IOT_SHADOW_CACHE_DESIRED,
+                         &( pResults[ QUERY_STATE_DESIRED ] ),
+                         true );
+            _applyState( &context,
+                         ( uint8_t ) AWS_IOT_SHADOW_CACHE_REPORTED,
+                         &( pResults[ QUERY_STATE_REPORTED ] ),
+                         true );
+            break;
+
+        case _CACHE_UPDATE_ACCEPTED:
+            _applyState( &context,
+                         ( uint8_t ) AWS_IOT_SHADOW_CACHE_DESIRED,
+                         &( pResults[ QUERY_STATE_DESIRED ] ),
+                         false );
+            _applyState( &context,
+                         ( uint8_t ) AWS_IOT_SHADOW_CACHE_REPORTED,
+                         &( pResults[ QUERY_STATE_REPORTED ] ),
+                         false );
+            break;
+
+        default:
+
+            /* A deleted Shadow starts again from version 0; only the keys not yet
+             * sent by the application remain. */
+            AwsIotShadow_Assert( type == _CACHE_DELETE_ACCEPTED );
+
+            while( i < pCache->entryCount )
+            {
+                if( ( pCache->pEntries[ i ].flags &
+                      ( SHADOW_CACHE_ENTRY_DIRTY | SHADOW_CACHE_ENTRY_SENDING ) ) == 0U )
+                {
+                    _removeEntry( pCache, &( pCache->pEntries[ i ] ) );
+                }
+                else
+                {
+                    pCache->pEntries[ i ].version = 0;
+                    i++;
+                }
+            }
+
+            context.version = 0;
+            pCache->version = 0;
+            break;
+    }
+
+    if( context.version > pCache->version )
+    {
+        pCache->version = context.version;
+    }
+
+    IotMutex_Unlock( &( pCache->mutex ) );
+}
+
+/*-----------------------------------------------------------*/
+
+void _AwsIotShadow_CacheDocument( const _shadowSubscription_t * pSubscription,
+                                  _shadowCacheDocument_t type,
+                                  const char * pDocument,
+                                  size_t documentLength )
+{
+    /* The subscription list mutex keeps the cache from being destroyed while the
+     * document is applied. */
+    IotMutex_Lock( &( _AwsIotShadowSubscriptionsMutex ) );
+
+    if( pSubscription->pCache != NULL )
+    {
+        _AwsIotShadow_ApplyCacheDocument( pSubscription->pCache,
+                                          type,
+                                          pDocument,
+                                          documentLength );
+    }
+
+    IotMutex_Unlock( &( _AwsIotShadowSubscriptionsMutex ) );
+}
+
+/*-----------------------------------------------------------*/
+
+size_t _AwsIotShadow_GenerateCacheUpdate( _shadowCache_t * pCache,
+                                          char * pBuffer,
+                                          size_t bufferSize )
+{
+    size_t length = 0, openObjects = 0, sharedObjects = 0, objectIndex = 0;
+    size_t i = 0, keyStart = 0, counterLength = 0;
+    const _shadowCacheEntry_t * pPrevious = NULL, * pEntry = NULL;
+    char pCounter[ 10 ] = { 0 };
+    uint32_t counter = pCache->updateCount;
+
+    /* Write the changed keys in the order of their paths, so that keys nested in
+     * the same object are next to each other. */
+    while( ( pEntry = _nextChangedEntry( pCache, pPrevious ) ) != NULL )
+    {
+        if( pPrevious == NULL )
+        {
+            _appendText( pBuffer, bufferSize, &length, CACHE_UPDATE_PREFIX, sizeof( CACHE_UPDATE_PREFIX ) - 1U );
+        }
+        else
+        {
+            /* Count the objects that both keys are in. Every dot in the common
+             * prefix of the paths ends an object shared by both. */
+            sharedObjects = 0;
+
+            for( i = 0; ( i < pEntry->pathLength ) && ( i < pPrevious->pathLength ) &&
+                 ( pEntry->pText[ i ] == pPrevious->pText[ i ] ); i++ )
+            {
+                if( pEntry->pText[ i ] == '.' )
+                {
+                    sharedObjects++;
+                }
+            }
+
+            /* Close the objects of the previous key that this key is not in. */
+            for( ; openObjects > sharedObjects; openObjects-- )
+            {
+                _appendText( pBuffer, bufferSize, &length, "}", 1 );
+            }
+
+            _appendText( pBuffer, bufferSize, &length, ",", 1 );
+        }
+
+        /* Open the objects of this key that are not open yet, then write the
+         * key and its value. */
+        keyStart = 0;
+        objectIndex = 0;
+
+        for( i = 0; i <= pEntry->pathLength; i++ )
+        {
+            if( i == pEntry->pathLength )
+            {
+                _appendText( pBuffer, bufferSize, &length, "\"", 1 );
+                _appendText( pBuffer, bufferSize, &length, pEntry->pText + keyStart, i - keyStart );
+                _appendText( pBuffer, bufferSize, &length, "\":", 2 );
+                _appendText( pBuffer, bufferSize, &length, pEntry->pText + i, pEntry->valueLength );
+            }
+            else if( pEntry->pText[ i ] == '.' )
+            {
+                if( objectIndex >= openObjects )
+                {
+                    _appendText( pBuffer, bufferSize, &length, "\"", 1 );
+                    _appendText( pBuffer, bufferSize, &length, pEntry->pText + keyStart, i - keyStart );
+                    _appendText( pBuffer, bufferSize, &length, "\":{", 3 );
+                }
+
+                objectIndex++;
+                keyStart = i + 1U;
+            }
+        }
+
+        openObjects = objectIndex;
+        pPrevious = pEntry;
+    }
+
+    if( pPrevious != NULL )
+    {
+        for( ; openObjects > 0U; openObjects-- )
+        {
+            _appendText( pBuffer, bufferSize, &length, "}", 1 );
+        }
+
+        /* Write the client token, whose digits are generated in reverse. */
+        do
+        {
+            pCounter[ sizeof( pCounter ) - 1U - counterLength ] = ( char ) ( '0' + ( counter % 10U ) );
+            counter /= 10U;
+            counterLength++;
+        } while( counter > 0U );
+
+        _appendText( pBuffer, bufferSize, &length, CACHE_UPDATE_SUFFIX, sizeof( CACHE_UPDATE_SUFFIX ) - 1U );
+        _appendText( pBuffer, bufferSize, &length, pCounter + sizeof( pCounter ) - counterLength, counterLength );
+        _appendText( pBuffer, bufferSize, &length, "\"}", 2 );
+    }
+
+    return length;
+}
+
+/*-----------------------------------------------------------*/
+
+AwsIotShadowError_t AwsIotShadow_CacheRead( AwsIotShadowCache_t cache,
+                                            AwsIotShadowCacheSection_t section,
+                                            const char * pKeyPath,
+                                            size_t keyPathLength,
+                                            char * pValueBuffer,
+                                            size_t * pValueLength,
+                                            uint32_t * pVersion )
+{
+    AwsIotShadowError_t status = AWS_IOT_SHADOW_SUCCESS;
+    const _shadowCacheEntry_t * pEntry = NULL;
+
+    /* Check parameters. */
+    if( ( cache == NULL ) || ( pKeyPath == NULL ) || ( keyPathLength == 0U ) ||
+        ( pValueLength == NULL ) ||
+        ( ( section != AWS_IOT_SHADOW_CACHE_DESIRED ) && ( section != AWS_IOT_SHADOW_CACHE_REPORTED ) ) )
+    {
+        IotLogError( "Shadow cache read needs a cache, a section, a key path and "
+                     "a value length." );
+
+        return AWS_IOT_SHADOW_BAD_PARAMETER;
+    }
+
+    IotMutex_Lock( &( cache->mutex ) );
+
+    pEntry = _findEntry( cache, ( uint8_t ) section, pKeyPath, keyPathLength );
+
+    /* A key that the application reported as null is deleted. */
+    if( ( pEntry == NULL ) ||
+        ( ( pEntry->valueLength == 4U ) &&
+          ( strncmp( pEntry->pText + pEntry->pathLength, "null", 4 ) == 0 ) ) )
+    {
+        status = AWS_IOT_SHADOW_NOT_FOUND;
+    }
+    else if( ( pValueBuffer == NULL ) || ( *pValueLength < pEntry->valueLength ) )
+    {
+        status = AWS_IOT_SHADOW_NO_MEMORY;
+        *pValueLength = pEntry->valueLength;
+    }
+    else
+    {
+        ( void ) memcpy( pValueBuffer, pEntry->pText + pEntry->pathLength, pEntry->valueLength );
+        *pValueLength = pEntry->valueLength;
+
+        if( pVersion != NULL )
+        {
+            *pVersion = pEntry->version;
+        }
+    }
+
+    IotMutex_Unlock( &( cache->mutex ) );
+
+    return status;
+}
+
+/*-----------------------------------------------------------*/
+
+AwsIotShadowError_t AwsIotShadow_CacheReport( AwsIotShadowCache_t cache,
+                                              const char * pKeyPath,
+                                              size_t keyPathLength,
+                                              const char * pValue,
+                                              size_t valueLength )
+{
+    AwsIotShadowError_t status = AWS_IOT_SHADOW_SUCCESS;
+    _shadowCacheEntry_t * pEntry = NULL;
+    size_t i = 0, depth = 1;
+    bool validPath = ( pKeyPath != NULL ) && ( keyPathLength > 0U ) &&
+                     ( keyPathLength <= AWS_IOT_SHADOW_CACHE_MAX_PATH_LENGTH );
+
+    /* The key path must be dotted keys that are not empty, nested no deeper
+     * than the Shadow service allows. */
+    for( i = 0; ( validPath == true ) && ( i < keyPathLength ); i++ )
+    {
+        if( pKeyPath[ i ] == '.' )
+        {
+            depth++;
+            validPath = ( i > 0U ) && ( i < keyPathLength - 1U ) &&
+                        ( pKeyPath[ i - 1U ] != '.' ) && ( depth <= MAX_STATE_DEPTH );
+        }
+    }
+
+    if( ( cache == NULL ) || ( validPath == false ) )
+    {
+        IotLogError( "Shadow cache report needs a cache and a key path of at most "
+                     "%d characters.", AWS_IOT_SHADOW_CACHE_MAX_PATH_LENGTH );
+
+        return AWS_IOT_SHADOW_BAD_PARAMETER;
+    }
+
+    /* No value reports the key as deleted. */
+    if( pValue == NULL )
+    {
+        pValue = "null";
+        valueLength = 4;
+    }
+    else if( valueLength == 0U )
+    {
+        IotLogError( "Value reported to a Shadow cache cannot be empty." );
+
+        return AWS_IOT_SHADOW_BAD_PARAMETER;
+    }
+
+    IotMutex_Lock( &( cache->mutex ) );
+
+    pEntry = _findEntry( cache, ( uint8_t ) AWS_IOT_SHADOW_CACHE_REPORTED, pKeyPath, keyPathLength );
+
+    /* Reporting a value the Shadow already has changes nothing. */
+    if( ( pEntry == NULL ) ||
+        ( ( pEntry->flags & SHADOW_CACHE_ENTRY_DIRTY ) != 0U ) ||
+        ( pEntry->valueLength != valueLength ) ||
+        ( memcmp( pEntry->pText + pEntry->pathLength, pValue, valueLength ) != 0 ) )
+    {
+        /* The new value replaces any object that was at its path, or that its
+         * path goes through. */
+        _removeRelated( cache,
+                        ( uint8_t ) AWS_IOT_SHADOW_CACHE_REPORTED,
+                        pKeyPath,
+                        keyPathLength,
+                        CACHE_RELATION_ANCESTOR | CACHE_RELATION_DESCENDANT,
+                        NULL );
+
+        pEntry = _storeValue( cache,
+                              _findEntry( cache, ( uint8_t ) AWS_IOT_SHADOW_CACHE_REPORTED, pKeyPath, keyPathLength ),
+                              ( uint8_t ) AWS_IOT_SHADOW_CACHE_REPORTED,
+                              pKeyPath,
+                              keyPathLength,
+                              pValue,
+                              valueLength );
+
+        if( pEntry == NULL )
+        {
+            IotLogError( "Shadow cache of %.*s is full. Key %.*s was not reported.",
+                         cache->thingNameLength,
+                         cache->pThingName,
+                         keyPathLength,
+                         pKeyPath );
+
+            status = AWS_IOT_SHADOW_NO_MEMORY;
+        }
+        else
+        {
+            pEntry->flags |= SHADOW_CACHE_ENTRY_DIRTY;
+        }
+    }
+
+    IotMutex_Unlock( &( cache->mutex ) );
+
+    return status;
+}
+
+/*-----------------------------------------------------------*/
+
+AwsIotShadowError_t AwsIotShadow_FlushCache( IotMqttConnection_t mqttConnection,
+                                             AwsIotShadowCache_t cache,
+                                             uint32_t flags,
+                                             const AwsIotShadowCallbackInfo_t * pCallbackInfo,
+                                             AwsIotShadowOperation_t * pUpdateOperation )
+{
+    AwsIotShadowError_t status = AWS_IOT_SHADOW_SUCCESS;
+    AwsIotShadowDocumentInfo_t updateInfo = AWS_IOT_SHADOW_DOCUMENT_INFO_INITIALIZER;
+    char * pDocument = NULL;
+    size_t documentLength = 0, i = 0;
+    _shadowCacheEntry_t * pEntry = NULL;
+
+    if( cache == NULL )
+    {
+        IotLogError( "Shadow cache to flush cannot be NULL." );
+
+        return AWS_IOT_SHADOW_BAD_PARAMETER;
+    }
+
+    /* Write one update with every key changed since the last flush. */
+    IotMutex_Lock( &( cache->mutex ) );
+
+    documentLength = _AwsIotShadow_GenerateCacheUpdate( cache, NULL, 0 );
+
+    if( documentLength > 0U )
+    {
+        pDocument = AwsIotShadow_MallocString( documentLength );
+
+        if( pDocument == NULL )
+        {
+            IotLogError( "Failed to allocate memory for update of Shadow cache of %.*s.",
+                         cache->thingNameLength,
+                         cache->pThingName );
+
+            status = AWS_IOT_SHADOW_NO_MEMORY;
+        }
+        else
+        {
+            ( void ) _AwsIotShadow_GenerateCacheUpdate( cache, pDocument, documentLength );
+            cache->updateCount++;
+
+            /* Keys reported again while the update is sent will be sent by the
+             * next flush. */
+            for( i = 0; i < cache->entryCount; i++ )
+            {
+                pEntry = &( cache->pEntries[ i ] );
+
+                if( ( pEntry->flags & SHADOW_CACHE_ENTRY_DIRTY ) != 0U )
+                {
+                    pEntry->flags = ( uint8_t ) ( ( pEntry->flags & ~SHADOW_CACHE_ENTRY_DIRTY ) |
+                                                  SHADOW_CACHE_ENTRY_SENDING );
+                }
+            }
+        }
+    }
+
+    IotMutex_Unlock( &( cache->mutex ) );
+
+    if( pDocument != NULL )
+    {
+        IotLogDebug( "Flushing Shadow cache of %.*s: %.*s",
+                     cache->thingNameLength,
+                     cache->pThingName,
+                     documentLength,
+                     pDocument );
+
+        updateInfo.pThingName = cache->pThingName;
+        updateInfo.thingNameLength = cache->thingNameLength;
+        updateInfo.qos = cache->qos;
+        updateInfo.retryLimit = cache->retryLimit;
+        updateInfo.retryMs = cache->retryMs;
+        updateInfo.u.update.pUpdateDocument = pDocument;
+        updateInfo.u.update.updateDocumentLength = documentLength;
+
+        status = AwsIotShadow_Update( mqttConnection,
+                                      &updateInfo,
+                                      flags,
+                                      pCallbackInfo,
+                                      pUpdateOperation );
+
+        /* The MQTT library has copied the document into its PUBLISH packet. */
+        AwsIotShadow_FreeString( pDocument );
+
+        IotMutex_Lock( &( cache->mutex ) );
+
+        i = 0;
+
+        while( i < cache->entryCount )
+        {
+            pEntry = &( cache->pEntries[ i ] );
+
+            if( ( pEntry->flags & SHADOW_CACHE_ENTRY_SENDING ) != 0U )
+            {
+                pEntry->flags &= ( uint8_t ) ~SHADOW_CACHE_ENTRY_SENDING;
+
+                if( status != AWS_IOT_SHADOW_STATUS_PENDING )
+                {
+                    /* Keep the keys that could not be sent for the next flush. */
+                    pEntry->flags |= SHADOW_CACHE_ENTRY_DIRTY;
+                }
+                else if( ( ( pEntry->flags & SHADOW_CACHE_ENTRY_DIRTY ) == 0U ) &&
+                         ( pEntry->valueLength == 4U ) &&
+                         ( strncmp( pEntry->pText + pEntry->pathLength, "null", 4 ) == 0 ) )
+                {
+                    /* A key sent as null is now deleted. */
+                    _removeEntry( cache, pEntry );
+                    continue;
+                }
+            }
+
+            i++;
+        }
+
+        IotMutex_Unlock( &( cache->mutex ) );
+    }
+
+    return status;
+}
+
+/*-----------------------------------------------------------*/
@@ -229,6 +229,14 @@ static void _commonOperationCallback( _shadowOperationType_t type,
     _operationMatchParams_t param = { .type = ( _shadowOperationType_t ) 0 };
     uint32_t flags = 0;
 
+    /* Lookup table for the Shadow cache documents of each operation. */
+    const _shadowCacheDocument_t pCacheDocument[ SHADOW_OPERATION_COUNT ] =
+    {
+        _CACHE_DELETE_ACCEPTED, /* Shadow DELETE. */
+        _CACHE_GET_ACCEPTED,    /* Shadow GET. */
+        _CACHE_UPDATE_ACCEPTED  /* Shadow UPDATE. */
+    };
+
     /* Set operation type to search. */
     param.type = type;
 
@@ -301,6 +309,12 @@ static void _commonOperationCallback( _shadowOperationType_t type,
                         pOperation->pSubscription->thingNameLength,
                         pOperation->pSubscription->pThingName );
 
+            /* Apply the accepted document to the Shadow cache of this Thing. */
+            _AwsIotShadow_CacheDocument( pOperation->pSubscription,
+                                         pCacheDocument[ type ],
+                                         pMessage->u.message.info.pPayload,
+                                         pMessage->u.message.info.payloadLength );
+
             /* Process the retrieved document for a Shadow GET. Otherwise, set
              * status to success. */
             if( type == _SHADOW_GET )
@@ -303,8 +303,19 @@ void _AwsIotShadow_RemoveSubscription( _shadowSubscription_t * pSubscription,
         }
     }
 
-    /* No Shadow operation subscription references or active Shadow callbacks.
-     * Remove the subscription object. */
+    /* A Shadow cache keeps the subscription object until it is destroyed. */
+    if( pSubscription->pCache != NULL )
+    {
+        IotLogDebug( "Found Shadow cache for %.*s subscription object. "
+                     "Subscription cannot be removed yet.",
+                     pSubscription->thingNameLength,
+                     pSubscription->pThingName );
+
+        return;
+    }
+
+    /* No Shadow operation subscription references, active Shadow callbacks, or
+     * Shadow cache. Remove the subscription object. */
     IotListDouble_Remove( &( pSubscription->link ) );
 
     IotLogDebug( "Removed subscription object for %.*s.",
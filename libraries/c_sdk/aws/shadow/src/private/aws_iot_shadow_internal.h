@@ -161,6 +161,9 @@
 #ifndef AWS_IOT_SHADOW_DEFAULT_MQTT_TIMEOUT_MS
     #define AWS_IOT_SHADOW_DEFAULT_MQTT_TIMEOUT_MS    ( 5000 )
 #endif
+#ifndef AWS_IOT_SHADOW_CACHE_MAX_PATH_LENGTH
+    #define AWS_IOT_SHADOW_CACHE_MAX_PATH_LENGTH      ( 64 )
+#endif
 /** @endcond */
 
 /**
@@ -286,6 +289,19 @@
  */
 #define MAX_CLIENT_TOKEN_LENGTH                  ( 64 )
 
+/**
+ * @brief The deepest nesting of objects in a Shadow state document, per AWS IoT
+ * service limits.
+ */
+#define MAX_STATE_DEPTH                          ( 8 )
+
+/**
+ * @brief Flags of a key kept by a Shadow cache.
+ */
+#define SHADOW_CACHE_ENTRY_DIRTY                 ( 0x01U ) /**< @brief Reported by the application and not yet sent. */
+#define SHADOW_CACHE_ENTRY_SENDING               ( 0x02U ) /**< @brief Being sent by @ref shadow_function_flushcache. */
+#define SHADOW_CACHE_ENTRY_SEEN                  ( 0x04U ) /**< @brief Found in the document being applied. */
+
 /**
  * @brief A flag to represent persistent subscriptions in a Shadow subscriptions
  * object.
@@ -305,6 +321,7 @@
  */
 struct _shadowOperation;
 struct _shadowSubscription;
+struct _shadowCache;
 /** @endcond */
 
 /**
@@ -360,6 +377,19 @@ typedef enum _shadowOperationStatus
     _UNKNOWN_STATUS = 2   /**< Parsed value matched neither accepted nor rejected. */
 } _shadowOperationStatus_t;
 
+/**
+ * @brief Enumerations representing each of the Shadow documents applied to a
+ * Shadow cache.
+ */
+typedef enum _shadowCacheDocument
+{
+    _CACHE_DELTA = 0,           /**< A document from `update/delta`. */
+    _CACHE_DOCUMENTS = 1,       /**< A document from `update/documents`. */
+    _CACHE_GET_ACCEPTED = 2,    /**< A document from `get/accepted`. */
+    _CACHE_UPDATE_ACCEPTED = 3, /**< A document from `update/accepted`. */
+    _CACHE_DELETE_ACCEPTED = 4  /**< A document from `delete/accepted`. */
+} _shadowCacheDocument_t;
+
 /**
  * @brief Internal structure representing a single Shadow operation (DELETE,
  * GET, or UPDATE).
@@ -430,10 +460,57 @@ typedef struct _shadowSubscription
      */
     char * pTopicBuffer;
 
+    struct _shadowCache * pCache; /**< @brief Cache of this Thing's Shadow, if any. */
+
     size_t thingNameLength; /**< @brief Length of Thing Name. */
     char pThingName[];      /**< @brief Thing Name associated with this subscriptions object. */
 } _shadowSubscription_t;
 
+/**
+ * @brief One key of the state kept by a Shadow cache.
+ *
+ * The key path and the value are stored one after the other in the text area
+ * of the cache.
+ */
+typedef struct _shadowCacheEntry
+{
+    char * pText;        /**< @brief The key path, followed by the value. */
+    size_t valueLength;  /**< @brief Length of the value. */
+    uint32_t version;    /**< @brief Shadow version that last set the value. */
+    uint16_t pathLength; /**< @brief Length of the dotted key path, e.g. `light.color`. */
+    uint8_t section;     /**< @brief An #AwsIotShadowCacheSection_t. */
+    uint8_t flags;       /**< @brief Bitwise OR of `SHADOW_CACHE_ENTRY_` flags. */
+} _shadowCacheEntry_t;
+
+/**
+ * @brief A Shadow cache, placed at the start of the buffer given by the application.
+ *
+ * Entries are added after this structure, and their text is added downwards
+ * from the end of the buffer. Text that is no longer used is reclaimed when the
+ * two meet.
+ */
+typedef struct _shadowCache
+{
+    IotMutex_t mutex;                         /**< @brief Protects the contents of the cache. */
+
+    uint32_t version;                         /**< @brief The highest Shadow version applied. */
+    uint32_t updateCount;                     /**< @brief Used for the client tokens of cache updates. */
+
+    IotMqttQos_t qos;                         /**< @brief QoS of cache updates. */
+    uint32_t retryLimit;                      /**< @brief Retry limit of cache updates. */
+    uint32_t retryMs;                         /**< @brief Retry time of cache updates. */
+
+    char * pEnd;                              /**< @brief End of the buffer. */
+    char * pTextStart;                        /**< @brief Start of the text area, which ends at pEnd. */
+    size_t unusedText;                        /**< @brief Bytes of the text area no longer referenced. */
+
+    size_t thingNameLength;                   /**< @brief Length of the Thing Name. */
+    char pThingName[ MAX_THING_NAME_LENGTH ]; /**< @brief Thing Name of the cached Shadow. */
+
+    size_t entryCount;                        /**< @brief Number of entries. */
+    _shadowCacheEntry_t pEntries[];           /**< @brief Keys of the state. */
+} _shadowCache_t;
+
 /* Declarations of names printed in logs. */
 #if LIBRARY_LOG_LEVEL > IOT_LOG_NONE
     extern const char * const _pAwsIotShadowOperationNames[];
@@ -620,6 +697,72 @@ void _AwsIotShadow_DecrementReferences( _shadowOperation_t * pOperation,
                                         char * pTopicBuffer,
                                         _shadowSubscription_t ** pRemovedSubscription );
 
+/*-------------------------- Shadow cache functions -------------------------*/
+
+/**
+ * @brief Set up a Shadow cache in the buffer given by the application.
+ *
+ * @param[in] pCacheInfo The Thing Name and memory of the cache.
+ * @param[out] pNewCache Set to point to the new cache on success.
+ *
+ * @return #AWS_IOT_SHADOW_SUCCESS, #AWS_IOT_SHADOW_BAD_PARAMETER if the buffer
+ * is too small, or #AWS_IOT_SHADOW_NO_MEMORY if its mutex cannot be created.
+ */
+AwsIotShadowError_t _AwsIotShadow_InitCache( const AwsIotShadowCacheInfo_t * pCacheInfo,
+                                             _shadowCache_t ** pNewCache );
+
+/**
+ * @brief Free the resources used by a Shadow cache. Its buffer is not touched.
+ *
+ * @param[in] pCache The cache, which must no longer be attached to a subscription.
+ */
+void _AwsIotShadow_CleanupCache( _shadowCache_t * pCache );
+
+/**
+ * @brief Apply a document published by the Shadow service to a Shadow cache.
+ *
+ * @param[in] pCache The cache to update.
+ * @param[in] type Where the document came from.
+ * @param[in] pDocument The document.
+ * @param[in] documentLength The length of `pDocument`.
+ */
+void _AwsIotShadow_ApplyCacheDocument( _shadowCache_t * pCache,
+                                       _shadowCacheDocument_t type,
+                                       const char * pDocument,
+                                       size_t documentLength );
+
+/**
+ * @brief Apply a document published by the Shadow service to the cache of a
+ * Thing, if it has one.
+ *
+ * @param[in] pSubscription The subscriptions object of the Thing.
+ * @param[in] type Where the document came from.
+ * @param[in] pDocument The document.
+ * @param[in] documentLength The length of `pDocument`.
+ *
+ * @note This function locks the subscription list mutex.
+ */
+void _AwsIotShadow_CacheDocument( const _shadowSubscription_t * pSubscription,
+                                  _shadowCacheDocument_t type,
+                                  const char * pDocument,
+                                  size_t documentLength );
+
+/**
+ * @brief Write the update document that reports the changed keys of a Shadow cache.
+ *
+ * @param[in] pCache The cache.
+ * @param[out] pBuffer Where to write the document; may be `NULL` to only get its length.
+ * @param[in] bufferSize The size of `pBuffer`.
+ *
+ * @return The length of the document, which is only written if it fits in
+ * `pBuffer`. 0 if no key changed.
+ *
+ * @note This function should be called with the cache mutex locked.
+ */
+size_t _AwsIotShadow_GenerateCacheUpdate( _shadowCache_t * pCache,
+                                          char * pBuffer,
+                                          size_t bufferSize );
+
 /*------------------------- Shadow parser functions -------------------------*/
 
 /**
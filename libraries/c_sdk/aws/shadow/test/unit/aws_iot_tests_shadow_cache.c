@@ -0,0 +1,614 @@
+/*
+ * FreeRTOS Shadow V2.2.3
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+/**
+ * @file aws_iot_tests_shadow_cache.c
+ * @brief Tests for the local Shadow cache.
+ */
+
+/* The config header is always included first. */
+#include "iot_config.h"
+
+/* Standard includes. */
+#include <stdio.h>
+#include <string.h>
+
+/* Shadow internal include. */
+#include "private/aws_iot_shadow_internal.h"
+
+/* Test framework includes. */
+#include "unity_fixture.h"
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief The Thing Name of the cache used in these tests.
+ */
+#define TEST_THING_NAME           "TestThingName"
+
+/**
+ * @brief The size of the buffer of the cache used in these tests.
+ */
+#define CACHE_BUFFER_SIZE         ( 2048 )
+
+/**
+ * @brief The size of the buffer holding values read from the cache.
+ */
+#define VALUE_BUFFER_SIZE         ( 64 )
+
+/**
+ * @brief The size of the buffer holding update documents.
+ */
+#define UPDATE_BUFFER_SIZE        ( 256 )
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Memory of the cache used in these tests.
+ */
+static uint64_t _pCacheBuffer[ CACHE_BUFFER_SIZE / sizeof( uint64_t ) ];
+
+/**
+ * @brief The cache used in these tests.
+ */
+static _shadowCache_t * _pCache = NULL;
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Apply a document to the cache used in these tests.
+ */
+static void _applyDocument( _shadowCacheDocument_t type,
+                            const char * pDocument )
+{
+    _AwsIotShadow_ApplyCacheDocument( _pCache, type, pDocument, strlen( pDocument ) );
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Read a key from the cache used in these tests and check its value.
+ *
+ * @param[in] section The section of the key.
+ * @param[in] pKeyPath The key path.
+ * @param[in] pExpectedValue The expected value; `NULL` if the key should not be found.
+ * @param[in] expectedVersion The expected version of the key.
+ */
+static void _checkValue( AwsIotShadowCacheSection_t section,
+                         const char * pKeyPath,
+                         const char * pExpectedValue,
+                         uint32_t expectedVersion )
+{
+    char pValue[ VALUE_BUFFER_SIZE ] = { 0 };
+    size_t valueLength = sizeof( pValue );
+    uint32_t version = UINT32_MAX;
+    AwsIotShadowError_t status = AwsIotShadow_CacheRead( _pCache,
+                                                         section,
+                                                         pKeyPath,
+                                                         strlen( pKeyPath ),
+                                                         pValue,
+                                                         &valueLength,
+                                                         &version );
+
+    if( pExpectedValue == NULL )
+    {
+        TEST_ASSERT_EQUAL( AWS_IOT_SHADOW_NOT_FOUND, status );
+    }
+    else
+    {
+        TEST_ASSERT_EQUAL( AWS_IOT_SHADOW_SUCCESS, status );
+        TEST_ASSERT_EQUAL( strlen( pExpectedValue ), valueLength );
+        TEST_ASSERT_EQUAL_STRING_LEN( pExpectedValue, pValue, valueLength );
+        TEST_ASSERT_EQUAL_UINT32( expectedVersion, version );
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Report a key to the cache used in these tests.
+ */
+static AwsIotShadowError_t _report( const char * pKeyPath,
+                                    const char * pValue )
+{
+    return AwsIotShadow_CacheReport( _pCache,
+                                     pKeyPath,
+                                     strlen( pKeyPath ),
+                                     pValue,
+                                     ( pValue == NULL ) ? 0 : strlen( pValue ) );
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Generate the update document of the cache used in these tests and
+ * check it.
+ *
+ * @param[in] pExpectedDocument The expected document; `NULL` if no key changed.
+ */
+static void _checkUpdate( const char * pExpectedDocument )
+{
+    char pDocument[ UPDATE_BUFFER_SIZE ] = { 0 };
+    size_t documentLength = 0;
+
+    /* Generating without a buffer gives the same length. */
+    documentLength = _AwsIotShadow_GenerateCacheUpdate( _pCache, NULL, 0 );
+    TEST_ASSERT_EQUAL( documentLength,
+                       _AwsIotShadow_GenerateCacheUpdate( _pCache, pDocument, sizeof( pDocument ) ) );
+
+    if( pExpectedDocument == NULL )
+    {
+        TEST_ASSERT_EQUAL( 0, documentLength );
+    }
+    else
+    {
+        TEST_ASSERT_EQUAL( strlen( pExpectedDocument ), documentLength );
+        TEST_ASSERT_EQUAL_STRING_LEN( pExpectedDocument, pDocument, documentLength );
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test group for Shadow cache tests.
+ */
+TEST_GROUP( Shadow_Unit_Cache );
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test setup for Shadow cache tests.
+ */
+TEST_SETUP( Shadow_Unit_Cache )
+{
+    AwsIotShadowCacheInfo_t cacheInfo = AWS_IOT_SHADOW_CACHE_INFO_INITIALIZER;
+
+    /* Initialize the Shadow library. */
+    TEST_ASSERT_EQUAL( AWS_IOT_SHADOW_SUCCESS, AwsIotShadow_Init( 0 ) );
+
+    /* Create a cache that is not attached to an MQTT connection. */
+    cacheInfo.pThingName = TEST_THING_NAME;
+    cacheInfo.thingNameLength = sizeof( TEST_THING_NAME ) - 1;
+    cacheInfo.pBuffer = _pCacheBuffer;
+    cacheInfo.bufferSize = sizeof( _pCacheBuffer );
+
+    TEST_ASSERT_EQUAL( AWS_IOT_SHADOW_SUCCESS, _AwsIotShadow_InitCache( &cacheInfo, &_pCache ) );
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test tear down for Shadow cache tests.
+ */
+TEST_TEAR_DOWN( Shadow_Unit_Cache )
+{
+    _AwsIotShadow_CleanupCache( _pCache );
+    _pCache = NULL;
+
+    /* Clean up the Shadow library. */
+    AwsIotShadow_Cleanup();
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test group runner for Shadow cache tests.
+ */
+TEST_GROUP_RUNNER( Shadow_Unit_Cache )
+{
+    RUN_TEST_CASE( Shadow_Unit_Cache, InitInvalid );
+    RUN_TEST_CASE( Shadow_Unit_Cache, ReadInvalid );
+    RUN_TEST_CASE( Shadow_Unit_Cache, ReportInvalid );
+    RUN_TEST_CASE( Shadow_Unit_Cache, MergeDelta );
+    RUN_TEST_CASE( Shadow_Unit_Cache, MergeVersions );
+    RUN_TEST_CASE( Shadow_Unit_Cache, ReplaceState );
+    RUN_TEST_CASE( Shadow_Unit_Cache, NullAndNestedValues );
+    RUN_TEST_CASE( Shadow_Unit_Cache, DeleteAccepted );
+    RUN_TEST_CASE( Shadow_Unit_Cache, ReportCoalesced );
+    RUN_TEST_CASE( Shadow_Unit_Cache, ReportNotOverwritten );
+    RUN_TEST_CASE( Shadow_Unit_Cache, Full );
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Tests creating a cache with invalid parameters.
+ */
+TEST( Shadow_Unit_Cache, InitInvalid )
+{
+    _shadowCache_t * pCache = NULL;
+    AwsIotShadowCacheInfo_t cacheInfo = AWS_IOT_SHADOW_CACHE_INFO_INITIALIZER;
+    uint64_t pSmallBuffer[ 2 ] = { 0 };
+
+    cacheInfo.pThingName = TEST_THING_NAME;
+    cacheInfo.thingNameLength = sizeof( TEST_THING_NAME ) - 1;
+
+    /* No buffer. */
+    TEST_ASSERT_EQUAL( AWS_IOT_SHADOW_BAD_PARAMETER, _AwsIotShadow_InitCache( &cacheInfo, &pCache ) );
+
+    /* Buffer too small for the cache. */
+    cacheInfo.pBuffer = pSmallBuffer;
+    cacheInfo.bufferSize = sizeof( pSmallBuffer );
+    TEST_ASSERT_EQUAL( AWS_IOT_SHADOW_BAD_PARAMETER, _AwsIotShadow_InitCache( &cacheInfo, &pCache ) );
+
+    /* Thing Name too long. */
+    cacheInfo.pBuffer = _pCacheBuffer;
+    cacheInfo.bufferSize = sizeof( _pCacheBuffer );
+    cacheInfo.thingNameLength = MAX_THING_NAME_LENGTH + 1;
+    TEST_ASSERT_EQUAL( AWS_IOT_SHADOW_BAD_PARAMETER, _AwsIotShadow_InitCache( &cacheInfo, &pCache ) );
+
+    TEST_ASSERT_NULL( pCache );
+
+    /* NULL parameters of the public functions. */
+    TEST_ASSERT_EQUAL( AWS_IOT_SHADOW_BAD_PARAMETER,
+                       AwsIotShadow_CreateCache( IOT_MQTT_CONNECTION_INITIALIZER, NULL, NULL ) );
+    TEST_ASSERT_EQUAL( AWS_IOT_SHADOW_BAD_PARAMETER,
+                       AwsIotShadow_DestroyCache( IOT_MQTT_CONNECTION_INITIALIZER, NULL ) );
+    TEST_ASSERT_EQUAL( AWS_IOT_SHADOW_BAD_PARAMETER,
+                       AwsIotShadow_FlushCache( IOT_MQTT_CONNECTION_INITIALIZER, NULL, 0, NULL, NULL ) );
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Tests reading a cache with invalid parameters.
+ */
+TEST( Shadow_Unit_Cache, ReadInvalid )
+{
+    char pValue[ 2 ] = { 0 };
+    size_t valueLength = sizeof( pValue );
+
+    _applyDocument( _CACHE_DELTA, "{\"version\":1,\"state\":{\"color\":\"red\"}}" );
+
+    TEST_ASSERT_EQUAL( AWS_IOT_SHADOW_BAD_PARAMETER,
+                       AwsIotShadow_CacheRead( NULL, AWS_IOT_SHADOW_CACHE_DESIRED, "color", 5,
+                                               pValue, &valueLength, NULL ) );
+    TEST_ASSERT_EQUAL( AWS_IOT_SHADOW_BAD_PARAMETER,
+                       AwsIotShadow_CacheRead( _pCache, AWS_IOT_SHADOW_CACHE_DESIRED, "color", 0,
+                                               pValue, &valueLength, NULL ) );
+    TEST_ASSERT_EQUAL( AWS_IOT_SHADOW_BAD_PARAMETER,
+                       AwsIotShadow_CacheRead( _pCache, AWS_IOT_SHADOW_CACHE_DESIRED, "color", 5,
+                                               pValue, NULL, NULL ) );
+    TEST_ASSERT_EQUAL( AWS_IOT_SHADOW_BAD_PARAMETER,
+                       AwsIotShadow_CacheRead( _pCache, ( AwsIotShadowCacheSection_t ) 2, "color", 5,
+                                               pValue, &valueLength, NULL ) );
+
+    /* A buffer too small gets the length needed. */
+    TEST_ASSERT_EQUAL( AWS_IOT_SHADOW_NO_MEMORY,
+                       AwsIotShadow_CacheRead( _pCache, AWS_IOT_SHADOW_CACHE_DESIRED, "color", 5,
+                                               pValue, &valueLength, NULL ) );
+    TEST_ASSERT_EQUAL( 5, valueLength );
+
+    valueLength = 0;
+    TEST_ASSERT_EQUAL( AWS_IOT_SHADOW_NO_MEMORY,
+                       AwsIotShadow_CacheRead( _pCache, AWS_IOT_SHADOW_CACHE_DESIRED, "color", 5,
+                                               NULL, &valueLength, NULL ) );
+    TEST_ASSERT_EQUAL( 5, valueLength );
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Tests reporting keys with invalid parameters.
+ */
+TEST( Shadow_Unit_Cache, ReportInvalid )
+{
+    char pLongPath[ AWS_IOT_SHADOW_CACHE_MAX_PATH_LENGTH + 2 ] = { 0 };
+
+    ( void ) memset( pLongPath, 'a', AWS_IOT_SHADOW_CACHE_MAX_PATH_LENGTH + 1 );
+
+    TEST_ASSERT_EQUAL( AWS_IOT_SHADOW_BAD_PARAMETER, AwsIotShadow_CacheReport( NULL, "a", 1, "1", 1 ) );
+    TEST_ASSERT_EQUAL( AWS_IOT_SHADOW_BAD_PARAMETER, AwsIotShadow_CacheReport( _pCache, "a", 1, "1", 0 ) );
+    TEST_ASSERT_EQUAL( AWS_IOT_SHADOW_BAD_PARAMETER, _report( "", "1" ) );
+    TEST_ASSERT_EQUAL( AWS_IOT_SHADOW_BAD_PARAMETER, _report( ".a", "1" ) );
+    TEST_ASSERT_EQUAL( AWS_IOT_SHADOW_BAD_PARAMETER, _report( "a.", "1" ) );
+    TEST_ASSERT_EQUAL( AWS_IOT_SHADOW_BAD_PARAMETER, _report( "a..b", "1" ) );
+    TEST_ASSERT_EQUAL( AWS_IOT_SHADOW_BAD_PARAMETER, _report( "a.b.c.d.e.f.g.h.i", "1" ) );
+    TEST_ASSERT_EQUAL( AWS_IOT_SHADOW_BAD_PARAMETER, _report( pLongPath, "1" ) );
+
+    /* The longest and deepest key paths allowed. */
+    pLongPath[ AWS_IOT_SHADOW_CACHE_MAX_PATH_LENGTH ] = '\0';
+    TEST_ASSERT_EQUAL( AWS_IOT_SHADOW_SUCCESS, _report( pLongPath, "1" ) );
+    TEST_ASSERT_EQUAL( AWS_IOT_SHADOW_SUCCESS, _report( "a.b.c.d.e.f.g.h", "1" ) );
+
+    /* Nothing was reported by the invalid calls. */
+    _checkValue( AWS_IOT_SHADOW_CACHE_REPORTED, "a", NULL, 0 );
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Tests applying delta documents.
+ */
+TEST( Shadow_Unit_Cache, MergeDelta )
+{
+    _applyDocument( _CACHE_DELTA,
+                    "{\"version\":3,\"timestamp\":1,\"state\":{\"color\":\"red\","
+                    "\"light\":{\"on\":true,\"level\":5},\"list\":[1,{\"a\":2}]},"
+                    "\"metadata\":{\"color\":{\"timestamp\":1}}}" );
+
+    _checkValue( AWS_IOT_SHADOW_CACHE_DESIRED, "color", "\"red\"", 3 );
+    _checkValue( AWS_IOT_SHADOW_CACHE_DESIRED, "light.on", "true", 3 );
+    _checkValue( AWS_IOT_SHADOW_CACHE_DESIRED, "light.level", "5", 3 );
+    _checkValue( AWS_IOT_SHADOW_CACHE_DESIRED, "list", "[1,{\"a\":2}]", 3 );
+
+    /* Objects are not kept as values, and delta only changes desired keys. */
+    _checkValue( AWS_IOT_SHADOW_CACHE_DESIRED, "light", NULL, 0 );
+    _checkValue( AWS_IOT_SHADOW_CACHE_DESIRED, "timestamp", NULL, 0 );
+    _checkValue( AWS_IOT_SHADOW_CACHE_REPORTED, "color", NULL, 0 );
+
+    /* A delta only changes the keys in it. */
+    _applyDocument( _CACHE_DELTA, "{\"version\":4,\"state\":{\"light\":{\"level\":7}}}" );
+
+    _checkValue( AWS_IOT_SHADOW_CACHE_DESIRED, "color", "\"red\"", 3 );
+    _checkValue( AWS_IOT_SHADOW_CACHE_DESIRED, "light.on", "true", 3 );
+    _checkValue( AWS_IOT_SHADOW_CACHE_DESIRED, "light.level", "7", 4 );
+
+    /* Invalid documents are ignored. */
+    _applyDocument( _CACHE_DELTA, "{\"version\":5,\"state\":{\"color\":\"blue\"}" );
+    _applyDocument( _CACHE_DELTA, "{\"version\":5,\"state\":[\"color\"]}" );
+
+    _checkValue( AWS_IOT_SHADOW_CACHE_DESIRED, "color", "\"red\"", 3 );
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Tests that documents older than a key do not change it.
+ */
+TEST( Shadow_Unit_Cache, MergeVersions )
+{
+    _applyDocument( _CACHE_DELTA, "{\"version\":5,\"state\":{\"color\":\"blue\"}}" );
+
+    /* An older document neither changes the key nor adds keys. */
+    _applyDocument( _CACHE_DELTA, "{\"version\":4,\"state\":{\"color\":\"green\",\"fan\":1}}" );
+
+    _checkValue( AWS_IOT_SHADOW_CACHE_DESIRED, "color", "\"blue\"", 5 );
+    _checkValue( AWS_IOT_SHADOW_CACHE_DESIRED, "fan", NULL, 0 );
+
+    /* An older document still changes keys set by even older documents. */
+    _applyDocument( _CACHE_DELTA, "{\"version\":6,\"state\":{\"fan\":1}}" );
+    _applyDocument( _CACHE_DELTA, "{\"version\":2,\"state\":{\"fan\":2}}" );
+    _applyDocument( _CACHE_DELTA, "{\"version\":8,\"state\":{\"color\":\"white\"}}" );
+    _applyDocument( _CACHE_DELTA, "{\"version\":7,\"state\":{\"color\":\"black\",\"fan\":3}}" );
+
+    _checkValue( AWS_IOT_SHADOW_CACHE_DESIRED, "color", "\"white\"", 8 );
+    _checkValue( AWS_IOT_SHADOW_CACHE_DESIRED, "fan", "3", 7 );
+
+    /* A document without a version is taken to be current. */
+    _applyDocument( _CACHE_DELTA, "{\"state\":{\"color\":\"pink\"}}" );
+
+    _checkValue( AWS_IOT_SHADOW_CACHE_DESIRED, "color", "\"pink\"", 8 );
+    TEST_ASSERT_EQUAL_UINT32( 8, _pCache->version );
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Tests that complete documents replace the state.
+ */
+TEST( Shadow_Unit_Cache, ReplaceState )
+{
+    _applyDocument( _CACHE_GET_ACCEPTED,
+                    "{\"state\":{\"desired\":{\"a\":1,\"b\":{\"c\":2}},\"reported\":{\"a\":0},"
+                    "\"delta\":{\"a\":1}},\"metadata\":{},\"version\":10,\"timestamp\":1}" );
+
+    _checkValue( AWS_IOT_SHADOW_CACHE_DESIRED, "a", "1", 10 );
+    _checkValue( AWS_IOT_SHADOW_CACHE_DESIRED, "b.c", "2", 10 );
+    _checkValue( AWS_IOT_SHADOW_CACHE_REPORTED, "a", "0", 10 );
+
+    /* A key set by a newer delta is kept when an older complete document does
+     * not have it. */
+    _applyDocument( _CACHE_DELTA, "{\"version\":12,\"state\":{\"d\":4}}" );
+
+    /* The new state has no reported section. */
+    _applyDocument( _CACHE_DOCUMENTS,
+                    "{\"previous\":{\"state\":{\"desired\":{\"x\":9}},\"version\":10},"
+                    "\"current\":{\"state\":{\"desired\":{\"a\":1}},\"version\":11},\"timestamp\":2}" );
+
+    _checkValue( AWS_IOT_SHADOW_CACHE_DESIRED, "a", "1", 11 );
+    _checkValue( AWS_IOT_SHADOW_CACHE_DESIRED, "b.c", NULL, 0 );
+    _checkValue( AWS_IOT_SHADOW_CACHE_DESIRED, "d", "4", 12 );
+    _checkValue( AWS_IOT_SHADOW_CACHE_DESIRED, "x", NULL, 0 );
+    _checkValue( AWS_IOT_SHADOW_CACHE_REPORTED, "a", NULL, 0 );
+    TEST_ASSERT_EQUAL_UINT32( 12, _pCache->version );
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Tests values that delete keys or change between values and objects.
+ */
+TEST( Shadow_Unit_Cache, NullAndNestedValues )
+{
+    _applyDocument( _CACHE_GET_ACCEPTED,
+                    "{\"state\":{\"desired\":{\"a\":1,\"b\":{\"c\":2,\"d\":3},\"e\":{\"f\":4}}},\"version\":1}" );
+
+    /* A null deletes the key and everything nested in it. An object replaces a
+     * value and the other way round. */
+    _applyDocument( _CACHE_UPDATE_ACCEPTED,
+                    "{\"state\":{\"desired\":{\"a\":{\"x\":5},\"b\":null,\"e\":6}},\"version\":2}" );
+
+    _checkValue( AWS_IOT_SHADOW_CACHE_DESIRED, "a", NULL, 0 );
+    _checkValue( AWS_IOT_SHADOW_CACHE_DESIRED, "a.x", "5", 2 );
+    _checkValue( AWS_IOT_SHADOW_CACHE_DESIRED, "b.c", NULL, 0 );
+    _checkValue( AWS_IOT_SHADOW_CACHE_DESIRED, "b.d", NULL, 0 );
+    _checkValue( AWS_IOT_SHADOW_CACHE_DESIRED, "e", "6", 2 );
+    _checkValue( AWS_IOT_SHADOW_CACHE_DESIRED, "e.f", NULL, 0 );
+
+    /* A null section deletes all of its keys. */
+    _applyDocument( _CACHE_UPDATE_ACCEPTED, "{\"state\":{\"desired\":null},\"version\":3}" );
+
+    _checkValue( AWS_IOT_SHADOW_CACHE_DESIRED, "a.x", NULL, 0 );
+    _checkValue( AWS_IOT_SHADOW_CACHE_DESIRED, "e", NULL, 0 );
+    TEST_ASSERT_EQUAL( 0, _pCache->entryCount );
+
+    /* Objects nested deeper than the Shadow service allows are skipped. */
+    _applyDocument( _CACHE_DELTA,
+                    "{\"version\":4,\"state\":{\"a\":{\"b\":{\"c\":{\"d\":{\"e\":{\"f\":{\"g\":{\"h\":1,"
+                    "\"i\":{\"j\":2}}}}}}}},\"k\":3}}" );
+
+    _checkValue( AWS_IOT_SHADOW_CACHE_DESIRED, "a.b.c.d.e.f.g.h", "1", 4 );
+    _checkValue( AWS_IOT_SHADOW_CACHE_DESIRED, "a.b.c.d.e.f.g.i.j", NULL, 0 );
+    _checkValue( AWS_IOT_SHADOW_CACHE_DESIRED, "k", "3", 4 );
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Tests that a deleted Shadow keeps only the keys not yet sent.
+ */
+TEST( Shadow_Unit_Cache, DeleteAccepted )
+{
+    _applyDocument( _CACHE_GET_ACCEPTED,
+                    "{\"state\":{\"desired\":{\"a\":1},\"reported\":{\"a\":1,\"b\":2}},\"version\":20}" );
+    TEST_ASSERT_EQUAL( AWS_IOT_SHADOW_SUCCESS, _report( "b", "3" ) );
+
+    _applyDocument( _CACHE_DELETE_ACCEPTED, "{\"version\":20,\"timestamp\":3}" );
+
+    _checkValue( AWS_IOT_SHADOW_CACHE_DESIRED, "a", NULL, 0 );
+    _checkValue( AWS_IOT_SHADOW_CACHE_REPORTED, "a", NULL, 0 );
+    _checkValue( AWS_IOT_SHADOW_CACHE_REPORTED, "b", "3", 0 );
+
+    /* The new Shadow starts again from version 1. */
+    _applyDocument( _CACHE_DELTA, "{\"version\":1,\"state\":{\"a\":5}}" );
+
+    _checkValue( AWS_IOT_SHADOW_CACHE_DESIRED, "a", "5", 1 );
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Tests that reported keys are sent in one update with their last values.
+ */
+TEST( Shadow_Unit_Cache, ReportCoalesced )
+{
+    _applyDocument( _CACHE_GET_ACCEPTED,
+                    "{\"state\":{\"reported\":{\"temp\":19,\"mode\":\"eco\",\"fan\":{\"speed\":1}}},\"version\":2}" );
+
+    /* Nothing changed yet. */
+    _checkUpdate( NULL );
+
+    /* Reporting a value the Shadow already has changes nothing. */
+    TEST_ASSERT_EQUAL( AWS_IOT_SHADOW_SUCCESS, _report( "mode", "\"eco\"" ) );
+    _checkUpdate( NULL );
+
+    TEST_ASSERT_EQUAL( AWS_IOT_SHADOW_SUCCESS, _report( "temp", "20" ) );
+    TEST_ASSERT_EQUAL( AWS_IOT_SHADOW_SUCCESS, _report( "light.on", "true" ) );
+    TEST_ASSERT_EQUAL( AWS_IOT_SHADOW_SUCCESS, _report( "temp", "21" ) );
+    TEST_ASSERT_EQUAL( AWS_IOT_SHADOW_SUCCESS, _report( "light.level", "3" ) );
+    TEST_ASSERT_EQUAL( AWS_IOT_SHADOW_SUCCESS, _report( "fan", NULL ) );
+    TEST_ASSERT_EQUAL( AWS_IOT_SHADOW_SUCCESS, _report( "light.color.rgb", "[1,2,3]" ) );
+    TEST_ASSERT_EQUAL( AWS_IOT_SHADOW_SUCCESS, _report( "lightning", "0" ) );
+
+    _checkUpdate( "{\"state\":{\"reported\":{\"fan\":null,\"light\":{\"color\":{\"rgb\":[1,2,3]},"
+                  "\"level\":3,\"on\":true},\"lightning\":0,\"temp\":21}},"
+                  "\"clientToken\":\"shadowcache-0\"}" );
+
+    /* The reported values are read back, except deleted keys. */
+    _checkValue( AWS_IOT_SHADOW_CACHE_REPORTED, "temp", "21", 2 );
+    _checkValue( AWS_IOT_SHADOW_CACHE_REPORTED, "light.on", "true", 0 );
+    _checkValue( AWS_IOT_SHADOW_CACHE_REPORTED, "fan", NULL, 0 );
+    _checkValue( AWS_IOT_SHADOW_CACHE_REPORTED, "fan.speed", NULL, 0 );
+
+    /* A value replaces the keys nested in its path. */
+    TEST_ASSERT_EQUAL( AWS_IOT_SHADOW_SUCCESS, _report( "light", "\"off\"" ) );
+    _pCache->updateCount = 12;
+
+    _checkUpdate( "{\"state\":{\"reported\":{\"fan\":null,\"light\":\"off\",\"lightning\":0,\"temp\":21}},"
+                  "\"clientToken\":\"shadowcache-12\"}" );
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Tests that the Shadow service does not overwrite keys not yet sent.
+ */
+TEST( Shadow_Unit_Cache, ReportNotOverwritten )
+{
+    TEST_ASSERT_EQUAL( AWS_IOT_SHADOW_SUCCESS, _report( "temp", "25" ) );
+
+    _applyDocument( _CACHE_DOCUMENTS,
+                    "{\"current\":{\"state\":{\"reported\":{\"temp\":30,\"mode\":\"eco\"}},\"version\":40}}" );
+
+    _checkValue( AWS_IOT_SHADOW_CACHE_REPORTED, "temp", "25", 0 );
+    _checkValue( AWS_IOT_SHADOW_CACHE_REPORTED, "mode", "\"eco\"", 40 );
+    _checkUpdate( "{\"state\":{\"reported\":{\"temp\":25}},\"clientToken\":\"shadowcache-0\"}" );
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Tests a cache whose buffer is full.
+ */
+TEST( Shadow_Unit_Cache, Full )
+{
+    char pKey[ 8 ] = { 0 };
+    char pValue[ 48 ] = { 0 };
+    char pDocument[ 96 ] = { 0 };
+    size_t i = 0, count = 0;
+    AwsIotShadowError_t status = AWS_IOT_SHADOW_SUCCESS;
+
+    ( void ) memset( pValue, '1', sizeof( pValue ) - 1 );
+
+    /* Fill the cache. */
+    while( status == AWS_IOT_SHADOW_SUCCESS )
+    {
+        ( void ) snprintf( pKey, sizeof( pKey ), "k%u", ( unsigned ) count );
+        status = _report( pKey, pValue );
+
+        if( status == AWS_IOT_SHADOW_SUCCESS )
+        {
+            count++;
+        }
+    }
+
+    TEST_ASSERT_EQUAL( AWS_IOT_SHADOW_NO_MEMORY, status );
+    TEST_ASSERT_GREATER_THAN( 10, count );
+    TEST_ASSERT_EQUAL( count, _pCache->entryCount );
+
+    /* Values that change length many times reuse the space of old values. */
+    for( i = 0; i < 100; i++ )
+    {
+        ( void ) snprintf( pKey, sizeof( pKey ), "k%u", ( unsigned ) ( i % count ) );
+        pValue[ ( i % 2 ) + 1 ] = '\0';
+        TEST_ASSERT_EQUAL( AWS_IOT_SHADOW_SUCCESS, _report( pKey, pValue ) );
+        pValue[ ( i % 2 ) + 1 ] = '1';
+        TEST_ASSERT_EQUAL( AWS_IOT_SHADOW_SUCCESS, _report( pKey, pValue ) );
+    }
+
+    for( i = 0; i < count; i++ )
+    {
+        ( void ) snprintf( pKey, sizeof( pKey ), "k%u", ( unsigned ) i );
+        _checkValue( AWS_IOT_SHADOW_CACHE_REPORTED, pKey, pValue, 0 );
+    }
+
+    /* Keys that do not fit are not cached; the rest of the cache is unchanged. */
+    ( void ) snprintf( pDocument, sizeof( pDocument ), "{\"version\":1,\"state\":{\"new\":%s}}", pValue );
+    _applyDocument( _CACHE_DELTA, pDocument );
+
+    _checkValue( AWS_IOT_SHADOW_CACHE_DESIRED, "new", NULL, 0 );
+    _checkValue( AWS_IOT_SHADOW_CACHE_REPORTED, "k0", pValue, 0 );
+}
@@ -67,10 +67,16 @@
  * @function_brief{taskpool_function_recyclejob}
  * - @function_name{taskpool_function_schedule}
  * @function_brief{taskpool_function_schedule}
+ * - @function_name{taskpool_function_schedulewithpriority}
+ * @function_brief{taskpool_function_schedulewithpriority}
  * - @function_name{taskpool_function_scheduledeferred}
  * @function_brief{taskpool_function_scheduledeferred}
  * - @function_name{taskpool_function_getstatus}
  * @function_brief{taskpool_function_getstatus}
+ * - @function_name{taskpool_function_getcachestatus}
+ * @function_brief{taskpool_function_getcachestatus}
+ * - @function_name{taskpool_function_getlanestatus}
+ * @function_brief{taskpool_function_getlanestatus}
  * - @function_name{taskpool_function_trycancel}
  * @function_brief{taskpool_function_trycancel}
  * - @function_name{taskpool_function_getjobstoragefromhandle}
@@ -110,12 +116,21 @@
  * @function_page{IotTaskPool_Schedule,taskpool,schedule}
  * @function_snippet{taskpool,schedule,this}
  * @copydoc IotTaskPool_Schedule
+ * @function_page{IotTaskPool_ScheduleWithPriority,taskpool,schedulewithpriority}
+ * @function_snippet{taskpool,schedulewithpriority,this}
+ * @copydoc IotTaskPool_ScheduleWithPriority
  * @function_page{IotTaskPool_ScheduleDeferred,taskpool,scheduledeferred}
  * @function_snippet{taskpool,scheduledeferred,this}
  * @copydoc IotTaskPool_ScheduleDeferred
  * @function_page{IotTaskPool_GetStatus,taskpool,getstatus}
  * @function_snippet{taskpool,getstatus,this}
  * @copydoc IotTaskPool_GetStatus
+ * @function_page{IotTaskPool_GetCacheStatus,taskpool,getcachestatus}
+ * @function_snippet{taskpool,getcachestatus,this}
+ * @copydoc IotTaskPool_GetCacheStatus
+ * @function_page{IotTaskPool_GetLaneStatus,taskpool,getlanestatus}
+ * @function_snippet{taskpool,getlanestatus,this}
+ * @copydoc IotTaskPool_GetLaneStatus
  * @function_page{IotTaskPool_TryCancel,taskpool,trycancel}
  * @function_snippet{taskpool,trycancel,this}
  * @copydoc IotTaskPool_TryCancel
@@ -237,6 +252,7 @@ IotTaskPoolError_t IotTaskPool_Destroy( IotTaskPool_t taskPool );
  * @return One of the following:
  * - #IOT_TASKPOOL_SUCCESS
  * - #IOT_TASKPOOL_BAD_PARAMETER
+ * - #IOT_TASKPOOL_ILLEGAL_OPERATION, if the task pool was created with #IOT_TASKPOOL_WORK_STEALING
  * - #IOT_TASKPOOL_SHUTDOWN_IN_PROGRESS
  *
  */
@@ -342,6 +358,9 @@ IotTaskPoolError_t IotTaskPool_DestroyRecyclableJob( IotTaskPool_t taskPool,
  * that was previously scheduled but not completed or canceled cannot be safely recycled. An attempt to do so will result
  * in an @ref IOT_TASKPOOL_ILLEGAL_OPERATION error.
  *
+ * The job cache is lock-free: recycling a job that is not scheduled, and creating a job with
+ * @ref IotTaskPool_CreateRecyclableJob, do not take the task pool lock.
+ *
  * @param[in] taskPool A handle to the task pool, e.g. as returned by a call to @ref IotTaskPool_Create.
  * @param[out] job A pointer to a job that was create with a call to @ref IotTaskPool_CreateJob.
  *
@@ -459,6 +478,40 @@ IotTaskPoolError_t IotTaskPool_Schedule( IotTaskPool_t taskPool,
                                          uint32_t flags );
 /* @[declare_taskpool_schedule] */
 
+/**
+ * @brief This function schedules a job in one of the priority lanes of the task pool pointed to by `taskPool`,
+ * optionally with a deadline.
+ *
+ * Jobs in the #IOT_TASKPOOL_PRIORITY_URGENT lane run ahead of all other jobs that are waiting for a worker,
+ * and jobs in the #IOT_TASKPOOL_PRIORITY_BACKGROUND lane run after them. A less urgent lane that was passed
+ * over #IOT_TASKPOOL_LANE_STARVATION_LIMIT times in a row gets the next worker, so that a steady flow of
+ * urgent jobs cannot starve it. Within a lane, jobs with a deadline run in earliest-deadline-first order.
+ *
+ * @param[in] taskPool A handle to the task pool that must have been previously initialized with.
+ * a call to @ref IotTaskPool_Create.
+ * @param[in] job A job to schedule for execution. This must be first initialized with a call to @ref IotTaskPool_CreateJob.
+ * @param[in] priority The lane to place the job in.
+ * @param[in] deadlineMs The time in milliseconds, from now, by which the job should start. Pass 0 for no deadline.
+ *
+ * @return One of the following:
+ * - #IOT_TASKPOOL_SUCCESS
+ * - #IOT_TASKPOOL_BAD_PARAMETER
+ * - #IOT_TASKPOOL_ILLEGAL_OPERATION
+ * - #IOT_TASKPOOL_SHUTDOWN_IN_PROGRESS
+ *
+ * @note A deadline only orders jobs within a lane. A job that misses its deadline still runs, and is counted in
+ * #IotTaskPoolLaneStatus_t.deadlineMisses.
+ *
+ * @warning The `taskPool` used in this function should be the same used to create the job pointed to by `job`, or the
+ * results will be undefined.
+ */
+/* @[declare_taskpool_schedulewithpriority] */
+IotTaskPoolError_t IotTaskPool_ScheduleWithPriority( IotTaskPool_t taskPool,
+                                                     IotTaskPoolJob_t job,
+                                                     IotTaskPoolJobPriority_t priority,
+                                                     uint32_t deadlineMs );
+/* @[declare_taskpool_schedulewithpriority] */
+
 /**
  * @brief This function schedules a job created with @ref IotTaskPool_CreateJob against the task pool
  * pointed to by `taskPool` to be executed after a user-defined time interval.
@@ -512,6 +565,45 @@ IotTaskPoolError_t IotTaskPool_GetStatus( IotTaskPool_t taskPool,
                                           IotTaskPoolJobStatus_t * const pStatus );
 /* @[declare_taskpool_getstatus] */
 
+/**
+ * @brief This function retrieves the statistics of the cache of recyclable jobs of a task pool.
+ *
+ * @param[in] taskPool A handle to the task pool that must have been previously initialized with
+ * a call to @ref IotTaskPool_Create or @ref IotTaskPool_CreateSystemTaskPool.
+ * @param[out] pStatus The statistics of the jobs cache.
+ *
+ * @return One of the following:
+ * - #IOT_TASKPOOL_SUCCESS
+ * - #IOT_TASKPOOL_BAD_PARAMETER
+ * - #IOT_TASKPOOL_SHUTDOWN_IN_PROGRESS
+ *
+ * @note The jobs cache is updated without locks, so the counters are read one at a time and may be
+ * mutually inconsistent if jobs are created or recycled concurrently.
+ */
+/* @[declare_taskpool_getcachestatus] */
+IotTaskPoolError_t IotTaskPool_GetCacheStatus( IotTaskPool_t taskPool,
+                                               IotTaskPoolCacheStatus_t * const pStatus );
+/* @[declare_taskpool_getcachestatus] */
+
+/**
+ * @brief This function retrieves the queue depth and latency statistics of one priority lane of a task pool.
+ *
+ * @param[in] taskPool A handle to the task pool that must have been previously initialized with
+ * a call to @ref IotTaskPool_Create or @ref IotTaskPool_CreateSystemTaskPool.
+ * @param[in] priority The lane to retrieve the statistics of.
+ * @param[out] pStatus The statistics of the lane.
+ *
+ * @return One of the following:
+ * - #IOT_TASKPOOL_SUCCESS
+ * - #IOT_TASKPOOL_BAD_PARAMETER
+ * - #IOT_TASKPOOL_SHUTDOWN_IN_PROGRESS
+ */
+/* @[declare_taskpool_getlanestatus] */
+IotTaskPoolError_t IotTaskPool_GetLaneStatus( IotTaskPool_t taskPool,
+                                              IotTaskPoolJobPriority_t priority,
+                                              IotTaskPoolLaneStatus_t * const pStatus );
+/* @[declare_taskpool_getlanestatus] */
+
 /**
  * @brief This function tries to cancel a job that was previously scheduled with @ref IotTaskPool_Schedule.
  *
@@ -587,11 +679,21 @@ const char * IotTaskPool_strerror( IotTaskPoolError_t status );
 
 /**
  * @brief The maximum number of jobs to cache.
+ *
+ * Must be less than 65535, because cache slots are addressed by 16-bit indexes.
  */
 #ifndef IOT_TASKPOOL_JOBS_RECYCLE_LIMIT
     #define IOT_TASKPOOL_JOBS_RECYCLE_LIMIT    ( 8UL )
 #endif
 
+/**
+ * @brief The number of jobs in a row that workers may take from more urgent lanes while a less urgent
+ * lane is waiting, before the less urgent lane gets the next worker.
+ */
+#ifndef IOT_TASKPOOL_LANE_STARVATION_LIMIT
+    #define IOT_TASKPOOL_LANE_STARVATION_LIMIT    ( 8UL )
+#endif
+
 /**
  * @brief The maximum timeout in milliseconds to wait for a job to be scheduled before waking up a worker thread.
  * A worker thread that wakes up as a result of a timeout may exit to allow the task pool to fold back to its
@@ -601,4 +703,74 @@ const char * IotTaskPool_strerror( IotTaskPoolError_t status );
     #define IOT_TASKPOOL_JOB_WAIT_TIMEOUT_MS    ( 60 * 1000UL )
 #endif
 
+/**
+ * @brief The resolution in milliseconds of the timing wheel used by task pools created with
+ * #IOT_TASKPOOL_TIMER_WHEEL. Deferred jobs expire on tick boundaries.
+ */
+#ifndef IOT_TASKPOOL_TIMER_WHEEL_TICK_MS
+    #define IOT_TASKPOOL_TIMER_WHEEL_TICK_MS    ( 10UL )
+#endif
+
+/**
+ * @brief The number of levels of the timing wheel used by task pools created with
+ * #IOT_TASKPOOL_TIMER_WHEEL.
+ *
+ * Together with #IOT_TASKPOOL_TIMER_WHEEL_SLOT_BITS this sets the span of the wheel: with the default
+ * values, 4 levels of 64 slots at a 10 ms tick cover about 46 hours. Longer timeouts are supported, but
+ * the corresponding jobs are re-inserted in the wheel every time its span elapses.
+ */
+#ifndef IOT_TASKPOOL_TIMER_WHEEL_LEVELS
+    #define IOT_TASKPOOL_TIMER_WHEEL_LEVELS    ( 4UL )
+#endif
+
+/**
+ * @brief The base-2 logarithm of the number of slots in each level of the timing wheel
+ * used by task pools created with #IOT_TASKPOOL_TIMER_WHEEL.
+ */
+#ifndef IOT_TASKPOOL_TIMER_WHEEL_SLOT_BITS
+    #define IOT_TASKPOOL_TIMER_WHEEL_SLOT_BITS    ( 6UL )
+#endif
+
+/**
+ * @brief The maximum number of timing wheels to be created when using a memory pool.
+ *
+ * Each timing wheel is reserved at compile time when #IOT_STATIC_MEMORY_ONLY is 1. A wheel
+ * holds `IOT_TASKPOOL_TIMER_WHEEL_LEVELS << IOT_TASKPOOL_TIMER_WHEEL_SLOT_BITS` lists of two
+ * pointers, so with the default levels and slots it takes about 2 KB of RAM on a 32-bit target.
+ * No wheel is reserved by default, and creating a task pool with #IOT_TASKPOOL_TIMER_WHEEL then
+ * fails with #IOT_TASKPOOL_NO_MEMORY in static memory mode.
+ */
+#ifndef IOT_TASKPOOL_TIMER_WHEELS
+    #define IOT_TASKPOOL_TIMER_WHEELS    ( 0 )
+#endif
+
+/**
+ * @brief The maximum number of workers of a task pool created with #IOT_TASKPOOL_WORK_STEALING.
+ */
+#ifndef IOT_TASKPOOL_WORK_STEALING_MAX_WORKERS
+    #define IOT_TASKPOOL_WORK_STEALING_MAX_WORKERS    ( 8UL )
+#endif
+
+/**
+ * @brief The number of jobs each worker deque can hold in a task pool created with
+ * #IOT_TASKPOOL_WORK_STEALING. Jobs scheduled on a full deque go through the shared dispatch queue.
+ */
+#ifndef IOT_TASKPOOL_WORK_QUEUE_SIZE
+    #define IOT_TASKPOOL_WORK_QUEUE_SIZE    ( 32UL )
+#endif
+
+/**
+ * @brief The maximum number of worker deque sets to be created when using a memory pool.
+ *
+ * Each set is reserved at compile time when #IOT_STATIC_MEMORY_ONLY is 1. A set holds
+ * #IOT_TASKPOOL_WORK_STEALING_MAX_WORKERS deques, each with a mutex and
+ * #IOT_TASKPOOL_WORK_QUEUE_SIZE job pointers. With the defaults, that is 1 KB of job slots
+ * plus 8 mutexes on a 32-bit target, or about 1.8 KB with FreeRTOS static mutexes. No set is
+ * reserved by default, so work stealing is opt-in: creating a task pool with
+ * #IOT_TASKPOOL_WORK_STEALING fails with #IOT_TASKPOOL_NO_MEMORY in static memory mode.
+ */
+#ifndef IOT_TASKPOOL_WORK_QUEUES
+    #define IOT_TASKPOOL_WORK_QUEUES    ( 0 )
+#endif
+
 #endif /* ifndef IOT_TASKPOOL_H_ */
@@ -179,6 +179,30 @@
  */
     void IotTaskPool_FreeTimerEvent( void * ptr );
 
+/**
+ * @brief Allocate an #_taskPoolTimerWheel_t. This function should have the
+ * same signature as [malloc].
+ */
+    void * IotTaskPool_MallocTimerWheel( size_t size );
+
+/**
+ * @brief Free an #_taskPoolTimerWheel_t. This function should have the
+ * same signature as[ free ].
+ */
+    void IotTaskPool_FreeTimerWheel( void * ptr );
+
+/**
+ * @brief Allocate an #_taskPoolWorkStealing_t. This function should have the
+ * same signature as [malloc].
+ */
+    void * IotTaskPool_MallocWorkQueues( size_t size );
+
+/**
+ * @brief Free an #_taskPoolWorkStealing_t. This function should have the
+ * same signature as[ free ].
+ */
+    void IotTaskPool_FreeWorkQueues( void * ptr );
+
 #else /* if IOT_STATIC_MEMORY_ONLY == 1 */
     #include <stdlib.h>
 
@@ -206,6 +230,22 @@
         #define IotTaskPool_FreeTimerEvent    free
     #endif
 
+    #ifndef IotTaskPool_MallocTimerWheel
+        #define IotTaskPool_MallocTimerWheel    malloc
+    #endif
+
+    #ifndef IotTaskPool_FreeTimerWheel
+        #define IotTaskPool_FreeTimerWheel    free
+    #endif
+
+    #ifndef IotTaskPool_MallocWorkQueues
+        #define IotTaskPool_MallocWorkQueues    malloc
+    #endif
+
+    #ifndef IotTaskPool_FreeWorkQueues
+        #define IotTaskPool_FreeWorkQueues    free
+    #endif
+
 #endif /* if IOT_STATIC_MEMORY_ONLY == 1 */
 
 /* ---------------------------------------------------------------------------------------------- */
@@ -217,22 +257,139 @@
  * A macros to manage task pool memory allocation.
  */
 #define IOT_TASK_POOL_INTERNAL_STATIC    ( ( uint32_t ) 0x00000001 )      /* Flag to mark a job as user-allocated. */
+
+/*
+ * Macros to size and index the timing wheel.
+ */
+#define TASKPOOL_TIMER_WHEEL_SLOTS        ( 1UL << IOT_TASKPOOL_TIMER_WHEEL_SLOT_BITS )                                 /* Slots in each level of the wheel. */
+#define TASKPOOL_TIMER_WHEEL_SLOT_MASK    ( ( uint64_t ) TASKPOOL_TIMER_WHEEL_SLOTS - 1ULL )                           /* Mask to extract a slot index from a tick. */
+#define TASKPOOL_TIMER_WHEEL_SPAN         ( 1ULL << ( IOT_TASKPOOL_TIMER_WHEEL_LEVELS * IOT_TASKPOOL_TIMER_WHEEL_SLOT_BITS ) ) /* Ticks covered by all levels of the wheel. */
+
+/*
+ * Macros to encode the tagged indexes of the jobs cache.
+ */
+#define TASKPOOL_CACHE_INDEX_MASK       ( 0x0000FFFFUL )             /* Mask to extract a slot index from a tagged index. */
+#define TASKPOOL_CACHE_TAG_INCREMENT    ( 0x00010000UL )             /* Amount added to the tag of a tagged index on every update. */
+#define TASKPOOL_CACHE_EMPTY            ( TASKPOOL_CACHE_INDEX_MASK ) /* Slot index of an empty stack. */
+
+#if IOT_TASKPOOL_JOBS_RECYCLE_LIMIT >= TASKPOOL_CACHE_EMPTY
+    #error "IOT_TASKPOOL_JOBS_RECYCLE_LIMIT must be less than 65535."
+#endif
+
+/*
+ * Macros for the priority lanes of the dispatch queue.
+ */
+#define TASKPOOL_PRIORITY_LANES    ( ( uint32_t ) IOT_TASKPOOL_PRIORITY_BACKGROUND + 1UL ) /* Number of priority lanes. */
+#define TASKPOOL_NO_DEADLINE       ( UINT64_MAX )                                          /* Deadline of a job scheduled without one. */
 /** @endcond */
 
+/**
+ * @brief One slot of the task pool jobs cache.
+ *
+ * @warning This is a system-level data type that should not be modified or used directly in any application.
+ * @warning This is a system-level data type that can and will change across different versions of the platform, with no regards for backward compatibility.
+ *
+ */
+typedef struct _taskPoolCacheEntry
+{
+    struct _taskPoolJob * pJob; /**< @brief The cached job, valid only while the slot is on the free stack. */
+    uint32_t next;              /**< @brief Index of the next slot on the same stack. */
+} _taskPoolCacheEntry_t;
+
 /**
  * @brief Task pool jobs cache.
  *
+ * The cache is a fixed array of slots threaded onto two lock-free stacks: one for the slots
+ * holding a cached job and one for the empty slots. Each stack head is a tagged index, where the
+ * low bits are a slot index and the high bits are a counter bumped by every update, so that a
+ * compare-and-swap cannot succeed on a head that was popped and pushed back in the meantime (ABA).
+ * All fields are updated atomically, and none requires the task pool lock.
+ *
  * @warning This is a system-level data type that should not be modified or used directly in any application.
  * @warning This is a system-level data type that can and will change across different versions of the platform, with no regards for backward compatibility.
  *
  */
 typedef struct _taskPoolCache
 {
-    IotListDouble_t freeList; /**< @brief A list ot hold cached jobs. */
-
-    uint32_t freeCount;       /**< @brief A counter to track the number of jobs in the cache. */
+    _taskPoolCacheEntry_t entries[ IOT_TASKPOOL_JOBS_RECYCLE_LIMIT ]; /**< @brief The slots of the cache. */
+    uint32_t freeHead;                                                /**< @brief Tagged index of the first slot holding a cached job. */
+    uint32_t unusedHead;                                              /**< @brief Tagged index of the first empty slot. */
+    uint32_t freeCount;                                               /**< @brief A counter to track the number of jobs in the cache. */
+    uint32_t hits;                                                    /**< @brief Number of jobs served from the cache. */
+    uint32_t misses;                                                  /**< @brief Number of jobs allocated because the cache was empty. */
+    uint32_t closed;                                                  /**< @brief Non-zero once the task pool started shutting down. */
 } _taskPoolCache_t;
 
+/**
+ * @brief Hierarchical timing wheel for the deferred jobs of a task pool.
+ *
+ * Level 0 holds the timer events expiring within the next #TASKPOOL_TIMER_WHEEL_SLOTS ticks, one slot
+ * per tick. Each higher level holds the timer events expiring within a span #TASKPOOL_TIMER_WHEEL_SLOTS
+ * times larger, and each of its slots is cascaded into the lower levels when the wheel reaches it.
+ *
+ * @warning This is a system-level data type that should not be modified or used directly in any application.
+ * @warning This is a system-level data type that can and will change across different versions of the platform, with no regards for backward compatibility.
+ *
+ */
+typedef struct _taskPoolTimerWheel
+{
+    IotListDouble_t slots[ IOT_TASKPOOL_TIMER_WHEEL_LEVELS ][ TASKPOOL_TIMER_WHEEL_SLOTS ]; /**< @brief The timer events, bucketed by level and slot. */
+    uint64_t currentTick;                                                                   /**< @brief The last tick processed by the wheel. */
+    uint64_t armedTick;                                                                     /**< @brief The tick the task pool timer is armed for, or UINT64_MAX if not armed. */
+    uint32_t eventCount;                                                                    /**< @brief The number of timer events in the wheel. */
+} _taskPoolTimerWheel_t;
+
+/**
+ * @brief A bounded deque of jobs owned by one worker of a task pool in work stealing mode.
+ *
+ * The owner takes jobs from the head of the deque, so that the jobs it schedules run in FIFO order,
+ * and thieves take jobs from the tail.
+ *
+ * @warning This is a system-level data type that should not be modified or used directly in any application.
+ * @warning This is a system-level data type that can and will change across different versions of the platform, with no regards for backward compatibility.
+ *
+ */
+typedef struct _taskPoolWorkQueue
+{
+    IotMutex_t lock;                                             /**< @brief The lock to protect this deque. */
+    void * pOwner;                                               /**< @brief The thread of the worker owning this deque, or NULL if the deque is not claimed. */
+    uint32_t head;                                               /**< @brief The index of the first job in the deque. */
+    uint32_t count;                                              /**< @brief The number of jobs in the deque. */
+    struct _taskPoolJob * pJobs[ IOT_TASKPOOL_WORK_QUEUE_SIZE ]; /**< @brief The ring buffer holding the jobs. */
+} _taskPoolWorkQueue_t;
+
+/**
+ * @brief The worker deques of a task pool in work stealing mode.
+ *
+ * @warning This is a system-level data type that should not be modified or used directly in any application.
+ * @warning This is a system-level data type that can and will change across different versions of the platform, with no regards for backward compatibility.
+ *
+ */
+typedef struct _taskPoolWorkStealing
+{
+    _taskPoolWorkQueue_t queues[ IOT_TASKPOOL_WORK_STEALING_MAX_WORKERS ]; /**< @brief One deque per worker. */
+    uint32_t nextQueue;                                                    /**< @brief The next deque for jobs scheduled from outside the task pool. Protected by the task pool lock. */
+    uint32_t sharedJobs;                                                   /**< @brief The number of jobs in the shared dispatch queue. Updated atomically. */
+    uint32_t idleWorkers;                                                  /**< @brief The number of workers waiting on the dispatch signal. Updated atomically. */
+} _taskPoolWorkStealing_t;
+
+/**
+ * @brief One priority lane of the dispatch queue of a task pool.
+ *
+ * Jobs are kept in deadline order, and jobs without a deadline are appended at the tail.
+ * All fields are protected by the task pool lock.
+ *
+ * @warning This is a system-level data type that should not be modified or used directly in any application.
+ * @warning This is a system-level data type that can and will change across different versions of the platform, with no regards for backward compatibility.
+ *
+ */
+typedef struct _taskPoolLane
+{
+    IotDeQueue_t queue;             /**< @brief The jobs waiting in the lane, in deadline order. */
+    uint32_t skipped;               /**< @brief Number of jobs taken from more urgent lanes in a row while this lane was waiting. */
+    IotTaskPoolLaneStatus_t status; /**< @brief The statistics of the lane. */
+} _taskPoolLane_t;
+
 /**
  * @brief The task pool data structure keeps track of the internal state and the signals for the dispatcher threads.
  * The task pool is a thread safe data structure.
@@ -243,19 +400,21 @@ typedef struct _taskPoolCache
  */
 typedef struct _taskPool
 {
-    IotDeQueue_t dispatchQueue;      /**< @brief The queue for the jobs waiting to be executed. */
-    IotListDouble_t timerEventsList; /**< @brief The timeouts queue for all deferred jobs waiting to be executed. */
-    _taskPoolCache_t jobsCache;      /**< @brief A cache to re-use jobs in order to limit memory allocations. */
-    uint32_t minThreads;             /**< @brief The minimum number of threads for the task pool. */
-    uint32_t maxThreads;             /**< @brief The maximum number of threads for the task pool. */
-    uint32_t activeThreads;          /**< @brief The number of threads in the task pool at any given time. */
-    uint32_t activeJobs;             /**< @brief The number of active jobs in the task pool at any given time. */
-    uint32_t stackSize;              /**< @brief The stack size for all task pool threads. */
-    int32_t priority;                /**< @brief The priority for all task pool threads. */
-    IotSemaphore_t dispatchSignal;   /**< @brief The synchronization object on which threads are waiting for incoming jobs. */
-    IotSemaphore_t startStopSignal;  /**< @brief The synchronization object for threads to signal start and stop condition. */
-    IotTimer_t timer;                /**< @brief The timer for deferred jobs. */
-    IotMutex_t lock;                 /**< @brief The lock to protect the task pool data structure access. */
+    _taskPoolLane_t lanes[ TASKPOOL_PRIORITY_LANES ]; /**< @brief The priority lanes for the jobs waiting to be executed. */
+    IotListDouble_t timerEventsList;                  /**< @brief The timeouts queue for all deferred jobs waiting to be executed. */
+    _taskPoolTimerWheel_t * pTimerWheel;              /**< @brief The timing wheel for deferred jobs, or NULL if deferred jobs are kept in timerEventsList. */
+    _taskPoolWorkStealing_t * pWorkStealing;          /**< @brief The worker deques, or NULL if all jobs go through the lanes. */
+    _taskPoolCache_t jobsCache;                       /**< @brief A cache to re-use jobs in order to limit memory allocations. */
+    uint32_t minThreads;                              /**< @brief The minimum number of threads for the task pool. */
+    uint32_t maxThreads;                              /**< @brief The maximum number of threads for the task pool. */
+    uint32_t activeThreads;                           /**< @brief The number of threads in the task pool at any given time. */
+    uint32_t activeJobs;                              /**< @brief The number of active jobs in the task pool at any given time. */
+    uint32_t stackSize;                               /**< @brief The stack size for all task pool threads. */
+    int32_t priority;                                 /**< @brief The priority for all task pool threads. */
+    IotSemaphore_t dispatchSignal;                    /**< @brief The synchronization object on which threads are waiting for incoming jobs. */
+    IotSemaphore_t startStopSignal;                   /**< @brief The synchronization object for threads to signal start and stop condition. */
+    IotTimer_t timer;                                 /**< @brief The timer for deferred jobs. */
+    IotMutex_t lock;                                  /**< @brief The lock to protect the task pool data structure access. */
 } _taskPool_t;
 
 /**
@@ -267,11 +426,15 @@ typedef struct _taskPool
  */
 typedef struct _taskPoolJob
 {
-    IotLink_t link;                    /**< @brief The link to insert the job in the dispatch queue. */
-    IotTaskPoolRoutine_t userCallback; /**< @brief The user provided callback. */
-    void * pUserContext;               /**< @brief The user provided context. */
-    uint32_t flags;                    /**< @brief Internal flags. */
-    IotTaskPoolJobStatus_t status;     /**< @brief The status for the job. */
+    IotLink_t link;                           /**< @brief The link to insert the job in the dispatch queue. */
+    IotTaskPoolRoutine_t userCallback;        /**< @brief The user provided callback. */
+    void * pUserContext;                      /**< @brief The user provided context. */
+    uint32_t flags;                           /**< @brief Internal flags. */
+    IotTaskPoolJobStatus_t status;            /**< @brief The status for the job. */
+    struct _taskPoolTimerEvent * pTimerEvent; /**< @brief The timer event of a deferred job, or NULL. */
+    uint32_t lane;                            /**< @brief The priority lane of the job. */
+    uint64_t deadline;                        /**< @brief The time by which the job should start, or #TASKPOOL_NO_DEADLINE. */
+    uint64_t scheduleTime;                    /**< @brief The time at which the job entered its lane. */
 } _taskPoolJob_t;
 
 /**
@@ -196,6 +196,36 @@ typedef enum IotTaskPoolJobStatus
     IOT_TASKPOOL_STATUS_UNDEFINED,
 } IotTaskPoolJobStatus_t;
 
+/**
+ * @ingroup taskpool_datatypes_enums
+ * @brief Priority lanes of the dispatch queue of a task pool.
+ *
+ * Workers always take the next job from the most urgent lane that is not empty, unless a less urgent
+ * lane was passed over #IOT_TASKPOOL_LANE_STARVATION_LIMIT times in a row. Within a lane, jobs with a
+ * deadline run in earliest-deadline-first order, ahead of the jobs without a deadline, which run in
+ * FIFO order.
+ */
+typedef enum IotTaskPoolJobPriority
+{
+    /**
+     * @brief Latency-critical jobs, e.g. protocol acknowledgements and keep-alive.
+     *
+     */
+    IOT_TASKPOOL_PRIORITY_URGENT = 0,
+
+    /**
+     * @brief Regular jobs. This is the lane of the jobs scheduled with @ref IotTaskPool_Schedule.
+     *
+     */
+    IOT_TASKPOOL_PRIORITY_NORMAL,
+
+    /**
+     * @brief Jobs that can wait behind all other jobs, e.g. bulk uploads and metrics reports.
+     *
+     */
+    IOT_TASKPOOL_PRIORITY_BACKGROUND,
+} IotTaskPoolJobPriority_t;
+
 /*------------------------- Task pool types and handles --------------------------*/
 
 /**
@@ -231,6 +261,10 @@ typedef struct IotTaskPoolJobStorage
     void * dummy3;                 /**< @brief Placeholder. */
     uint32_t dummy4;               /**< @brief Placeholder. */
     IotTaskPoolJobStatus_t status; /**< @brief Placeholder. */
+    void * dummy6;                 /**< @brief Placeholder. */
+    uint32_t dummy7;               /**< @brief Placeholder. */
+    uint64_t dummy8;               /**< @brief Placeholder. */
+    uint64_t dummy9;               /**< @brief Placeholder. */
 } IotTaskPoolJobStorage_t;
 
 /**
@@ -289,8 +323,44 @@ typedef struct IotTaskPoolInfo
     uint32_t maxThreads; /**< @brief Maximum number of threads in a task pool. A task pool may try and grow the number of active threads up to #IotTaskPoolInfo_t.maxThreads. */
     uint32_t stackSize;  /**< @brief Stack size for every task pool thread. The stack size for each thread is fixed after the task pool is created and cannot be changed. */
     int32_t priority;    /**< @brief priority for every task pool thread. The priority for each thread is fixed after the task pool is created and cannot be changed. */
+    uint32_t flags;      /**< @brief Creation flags for the task pool, e.g. #IOT_TASKPOOL_TIMER_WHEEL. Set to 0 for the default behavior. */
 } IotTaskPoolInfo_t;
 
+/**
+ * @ingroup taskpool_datatypes_paramstructs
+ * @brief Statistics of the cache of recyclable jobs of a task pool.
+ *
+ * @paramfor @ref taskpool_function_getcachestatus
+ *
+ * Returned by @ref taskpool_function_getcachestatus.
+ */
+typedef struct IotTaskPoolCacheStatus
+{
+    uint32_t hits;      /**< @brief Number of recyclable jobs served from the cache. */
+    uint32_t misses;    /**< @brief Number of recyclable jobs allocated because the cache was empty. */
+    uint32_t freeCount; /**< @brief Number of jobs currently in the cache. */
+} IotTaskPoolCacheStatus_t;
+
+/**
+ * @ingroup taskpool_datatypes_paramstructs
+ * @brief Statistics of one priority lane of a task pool.
+ *
+ * @paramfor @ref taskpool_function_getlanestatus
+ *
+ * Returned by @ref taskpool_function_getlanestatus. The latency of a job is the time between scheduling
+ * the job and a worker taking it from the lane; the average latency is `totalLatencyMs / dispatched`.
+ */
+typedef struct IotTaskPoolLaneStatus
+{
+    uint32_t depth;          /**< @brief Number of jobs currently waiting in the lane. */
+    uint32_t maxDepth;       /**< @brief Largest number of jobs that waited in the lane at the same time. */
+    uint32_t dispatched;     /**< @brief Number of jobs taken from the lane by a worker. */
+    uint32_t promoted;       /**< @brief Number of jobs taken ahead of a more urgent lane to prevent starvation. */
+    uint32_t deadlineMisses; /**< @brief Number of jobs taken after their deadline. */
+    uint32_t maxLatencyMs;   /**< @brief Largest latency of a job, in milliseconds. */
+    uint64_t totalLatencyMs; /**< @brief Sum of the latencies of all jobs, in milliseconds. */
+} IotTaskPoolLaneStatus_t;
+
 /*------------------------- TASKPOOL defined constants --------------------------*/
 
 /**
@@ -339,7 +409,7 @@ typedef struct IotTaskPoolInfo
 /** @brief Initializer for a #IotTaskPool_t. */
 #define IOT_TASKPOOL_INITIALIZER                NULL
 /** @brief Initializer for a #IotTaskPoolJobStorage_t. */
-#define IOT_TASKPOOL_JOB_STORAGE_INITIALIZER    { { NULL, NULL }, NULL, NULL, 0, IOT_TASKPOOL_STATUS_UNDEFINED }
+#define IOT_TASKPOOL_JOB_STORAGE_INITIALIZER    { { NULL, NULL }, NULL, NULL, 0, IOT_TASKPOOL_STATUS_UNDEFINED, NULL, 0, 0, 0 }
 /** @brief Initializer for a #IotTaskPoolJob_t. */
 #define IOT_TASKPOOL_JOB_INITIALIZER            NULL
 /* @[define_taskpool_initializers] */
@@ -353,6 +423,39 @@ typedef struct IotTaskPoolInfo
  */
 #define IOT_TASKPOOL_JOB_HIGH_PRIORITY    ( ( uint32_t ) 0x00000001 )
 
+/**
+ * @brief Flag for creating a task pool that keeps its deferred jobs in a hierarchical timing wheel
+ * rather than in a list sorted by expiration time.
+ *
+ * With this flag set in #IotTaskPoolInfo_t.flags, @ref IotTaskPool_ScheduleDeferred and
+ * @ref IotTaskPool_TryCancel run in constant time regardless of the number of outstanding deferred
+ * jobs, and all jobs expiring in the same tick are dispatched in one pass of the timer routine.
+ * Expiration times are rounded up to #IOT_TASKPOOL_TIMER_WHEEL_TICK_MS, so deferred jobs may run
+ * up to one tick late.
+ *
+ * @note The timing wheel is allocated when the task pool is created, and its size is fixed by
+ * #IOT_TASKPOOL_TIMER_WHEEL_LEVELS and #IOT_TASKPOOL_TIMER_WHEEL_SLOT_BITS.
+ */
+#define IOT_TASKPOOL_TIMER_WHEEL          ( ( uint32_t ) 0x00000001 )
+
+/**
+ * @brief Flag for creating a task pool where each worker owns a bounded deque of jobs, and idle workers
+ * steal jobs from their peers.
+ *
+ * With this flag set in #IotTaskPoolInfo_t.flags, a job scheduled from within a worker callback is
+ * pushed to the deque of that worker, and a job scheduled from any other thread is distributed to the
+ * workers in round-robin order. Workers take jobs from their own deque without acquiring the task pool
+ * lock, and the dispatch semaphore is only signaled when some worker is idle. Jobs that do not fit in
+ * a deque, and jobs scheduled with #IOT_TASKPOOL_JOB_HIGH_PRIORITY or #IOT_TASKPOOL_PRIORITY_URGENT, go
+ * through the priority lanes of the shared dispatch queue. The jobs pushed to a deque run in FIFO order,
+ * regardless of their deadline or lane.
+ *
+ * @note A task pool in work stealing mode starts #IotTaskPoolInfo_t.maxThreads workers upon creation
+ * and never grows or shrinks, so #IotTaskPoolInfo_t.maxThreads must not exceed
+ * #IOT_TASKPOOL_WORK_STEALING_MAX_WORKERS, and @ref taskpool_function_setmaxthreads is not supported.
+ */
+#define IOT_TASKPOOL_WORK_STEALING        ( ( uint32_t ) 0x00000002 )
+
 /**
  * @brief Allows the use of the handle to the system task pool.
  *
@@ -41,6 +41,9 @@
 #include "platform/iot_threads.h"
 #include "platform/iot_clock.h"
 
+/* Atomics include. */
+#include "iot_atomic.h"
+
 /* Task pool internal include. */
 #include "private/iot_taskpool_internal.h"
 
@@ -76,7 +79,15 @@
  * the system libraries as well. The system task pool needs to be initialized before any library is used or
  * before any code that posts jobs to the task pool runs.
  */
-_taskPool_t _IotSystemTaskPool = { .dispatchQueue = IOT_DEQUEUE_INITIALIZER };
+_taskPool_t _IotSystemTaskPool =
+{
+    .lanes =
+    {
+        { .queue = IOT_DEQUEUE_INITIALIZER }, /* IOT_TASKPOOL_PRIORITY_URGENT */
+        { .queue = IOT_DEQUEUE_INITIALIZER }, /* IOT_TASKPOOL_PRIORITY_NORMAL */
+        { .queue = IOT_DEQUEUE_INITIALIZER }  /* IOT_TASKPOOL_PRIORITY_BACKGROUND */
+    }
+};
 
 /* -------------- Convenience functions to create/recycle/destroy jobs -------------- */
 
@@ -87,6 +98,44 @@ _taskPool_t _IotSystemTaskPool = { .dispatchQueue = IOT_DEQUEUE_INITIALIZER };
  */
 static void _initJobsCache( _taskPoolCache_t * const pCache );
 
+/**
+ * @brief Destroys all the jobs held in a Task pool cache.
+ *
+ * @param[in] pCache The cache to drain.
+ */
+static void _drainJobsCache( _taskPoolCache_t * const pCache );
+
+/**
+ * @brief Checks whether a Task pool cache stopped accepting and serving jobs, without taking the task pool lock.
+ *
+ * @param[in] pCache The cache to check.
+ *
+ * @return `true` if the task pool owning the cache started shutting down; `false` otherwise.
+ */
+static bool _isJobsCacheClosed( _taskPoolCache_t * const pCache );
+
+/**
+ * @brief Pops one slot from one of the lock-free stacks of a Task pool cache.
+ *
+ * @param[in] pCache The cache that owns the slots.
+ * @param[in] pHead The tagged head of the stack to pop from.
+ *
+ * @return The index of the popped slot, or #TASKPOOL_CACHE_EMPTY if the stack is empty.
+ */
+static uint32_t _cachePop( _taskPoolCache_t * const pCache,
+                           uint32_t * const pHead );
+
+/**
+ * @brief Pushes one slot onto one of the lock-free stacks of a Task pool cache.
+ *
+ * @param[in] pCache The cache that owns the slots.
+ * @param[in] pHead The tagged head of the stack to push onto.
+ * @param[in] index The index of the slot to push, which must be owned by the caller.
+ */
+static void _cachePush( _taskPoolCache_t * const pCache,
+                        uint32_t * const pHead,
+                        uint32_t index );
+
 /**
  * @brief Initialize a job.
  *
@@ -135,6 +184,104 @@ static void _destroyJob( _taskPoolJob_t * const pJob );
  */
 static void _taskPoolWorker( void * pUserContext );
 
+/**
+ * The procedure for a worker thread of a task pool in work stealing mode.
+ *
+ * @param[in] pUserContext The user context.
+ *
+ */
+static void _taskPoolStealingWorker( void * pUserContext );
+
+/* -------------- Convenience functions to handle worker deques -------------- */
+
+/**
+ * Initializes the worker deques of a task pool in work stealing mode.
+ *
+ * @param[in] pWorkStealing The pre-allocated worker deques to initialize.
+ *
+ * @return `true` if all deques were initialized; `false` otherwise.
+ */
+static bool _workStealingInit( _taskPoolWorkStealing_t * const pWorkStealing );
+
+/**
+ * Destroys the locks of the worker deques of a task pool in work stealing mode.
+ *
+ * @param[in] pWorkStealing The worker deques to destroy.
+ *
+ */
+static void _workStealingDestroy( _taskPoolWorkStealing_t * const pWorkStealing );
+
+/**
+ * Places a job in the deque of the calling worker, in the deque of the next worker in
+ * round-robin order, or in the shared dispatch queue. Must be called with the task pool lock held.
+ *
+ * @param[in] pTaskPool The task pool to dispatch the job to.
+ * @param[in] pJob The job to dispatch.
+ * @param[in] flags Flags to be passed by the user, e.g. to mark high priority jobs.
+ *
+ */
+static void _workStealingDispatch( _taskPool_t * const pTaskPool,
+                                   _taskPoolJob_t * const pJob,
+                                   uint32_t flags );
+
+/**
+ * Takes the next job for a worker: from the shared dispatch queue first, then from the worker
+ * own deque, and finally from the deques of its peers.
+ *
+ * @param[in] pTaskPool The task pool the worker belongs to.
+ * @param[in] queueIndex The index of the deque owned by the worker.
+ * @param[out] pUserCallback The callback of the job, read while the job is still owned by the task pool.
+ *
+ * @return The job marked as 'completed', or NULL if there is no job to execute.
+ */
+static _taskPoolJob_t * _workStealingFetch( _taskPool_t * const pTaskPool,
+                                            uint32_t queueIndex,
+                                            IotTaskPoolRoutine_t * const pUserCallback );
+
+/**
+ * Removes a job from whatever worker deque holds it.
+ *
+ * @param[in] pWorkStealing The worker deques.
+ * @param[in] pJob The job to remove.
+ *
+ * @return `true` if the job was removed; `false` if no deque holds the job anymore.
+ */
+static bool _workStealingRemove( _taskPoolWorkStealing_t * const pWorkStealing,
+                                 const _taskPoolJob_t * const pJob );
+
+/* -------------- Convenience functions to handle priority lanes -------------- */
+
+/**
+ * Places a job in its priority lane, after all the jobs with an earlier or equal deadline.
+ * Must be called with the task pool lock held.
+ *
+ * @param[in] pTaskPool The task pool that owns the lanes.
+ * @param[in] pJob The job to place.
+ *
+ */
+static void _laneEnqueue( _taskPool_t * const pTaskPool,
+                          _taskPoolJob_t * const pJob );
+
+/**
+ * Takes the next job to execute from the priority lanes, and updates the statistics of its lane.
+ * Must be called with the task pool lock held.
+ *
+ * @param[in] pTaskPool The task pool that owns the lanes.
+ *
+ * @return The job, or NULL if all lanes are empty.
+ */
+static _taskPoolJob_t * _laneDequeue( _taskPool_t * const pTaskPool );
+
+/**
+ * Removes a job from its priority lane, e.g. upon cancellation. Must be called with the task pool lock held.
+ *
+ * @param[in] pTaskPool The task pool that owns the lanes.
+ * @param[in] pJob The job to remove.
+ *
+ */
+static void _laneRemove( _taskPool_t * const pTaskPool,
+                         _taskPoolJob_t * const pJob );
+
 /* -------------- Convenience functions to handle timer events  -------------- */
 
 /**
@@ -150,10 +297,76 @@ static int32_t _timerEventCompare( const IotLink_t * const pTimerEventLink1,
  * Reschedules the timer for handling deferred jobs to the next timeout.
  *
  * param[in] pTimer The timer to reschedule.
- * param[in] pFirstTimerEvent The timer event that carries the timeout and job information.
+ * param[in] expirationTime The time in milliseconds at which the timer should fire.
  */
 static void _rescheduleDeferredJobsTimer( IotTimer_t * const pTimer,
-                                          _taskPoolTimerEvent_t * const pFirstTimerEvent );
+                                          uint64_t expirationTime );
+
+/**
+ * Inserts a timer event in the timer queue or timing wheel of a task pool, and re-arms the
+ * timer if the event is the first one to expire.
+ *
+ * param[in] pTaskPool The task pool that owns the timer event.
+ * param[in] pTimerEvent The timer event to insert.
+ * param[in] now The current time in milliseconds.
+ */
+static void _insertTimerEvent( _taskPool_t * const pTaskPool,
+                               _taskPoolTimerEvent_t * const pTimerEvent,
+                               uint64_t now );
+
+/**
+ * Removes a timer event from the timer queue or timing wheel of a task pool.
+ *
+ * param[in] pTaskPool The task pool that owns the timer event.
+ * param[in] pTimerEvent The timer event to remove.
+ */
+static void _removeTimerEvent( _taskPool_t * const pTaskPool,
+                               _taskPoolTimerEvent_t * const pTimerEvent );
+
+/**
+ * Initializes a timing wheel.
+ *
+ * param[in] pTimerWheel The timing wheel to initialize.
+ * param[in] now The current time in milliseconds.
+ */
+static void _timerWheelInit( _taskPoolTimerWheel_t * const pTimerWheel,
+                             uint64_t now );
+
+/**
+ * Places a timer event in the slot of the timing wheel that will be processed at, or cascaded
+ * just before, its expiration tick.
+ *
+ * param[in] pTimerWheel The timing wheel.
+ * param[in] pTimerEvent The timer event to place.
+ */
+static void _timerWheelInsert( _taskPoolTimerWheel_t * const pTimerWheel,
+                               _taskPoolTimerEvent_t * const pTimerEvent );
+
+/**
+ * Computes the next tick at which a slot of the timing wheel has to be processed or cascaded.
+ *
+ * param[in] pTimerWheel The timing wheel.
+ *
+ * @return The next tick with work to do, or UINT64_MAX if the wheel is empty.
+ */
+static uint64_t _timerWheelNextTick( const _taskPoolTimerWheel_t * const pTimerWheel );
+
+/**
+ * Advances the timing wheel up to the current time, and schedules all the deferred jobs
+ * that expired along the way.
+ *
+ * param[in] pTaskPool The task pool that owns the timing wheel.
+ * param[in] nowTick The current time in ticks.
+ */
+static void _timerWheelAdvance( _taskPool_t * const pTaskPool,
+                                uint64_t nowTick );
+
+/**
+ * Arms the task pool timer for the next tick with work to do in the timing wheel.
+ *
+ * param[in] pTaskPool The task pool that owns the timing wheel.
+ */
+static void _timerWheelRearm( _taskPool_t * const pTaskPool );
 
 /**
  * The task pool timer procedure for scheduling deferred jobs.
@@ -230,16 +443,6 @@ static IotTaskPoolError_t _scheduleInternal( _taskPool_t * const pTaskPool,
                                              _taskPoolJob_t * const pJob,
                                              uint32_t flags );
 
-/**
- * Matches a deferred job in the timer queue with its timer event wrapper.
- *
- * @param[in] pLink A pointer to the timer event link in the timer queue.
- * @param[in] pMatch A pointer to the job to match.
- *
- */
-static bool _matchJobByPointer( const IotLink_t * const pLink,
-                                void * pMatch );
-
 /**
  * Tries to cancel a job.
  *
@@ -253,7 +456,7 @@ static IotTaskPoolError_t _tryCancelInternal( _taskPool_t * const pTaskPool,
                                               IotTaskPoolJobStatus_t * const pStatus );
 
 /**
- * Try to safely cancel and/or remove a job from the cache when the user calls API out of order.
+ * Try to safely cancel a job, or reject a job that was recycled already, when the user calls API out of order.
  *
  * @param[in] pTaskPool The task pool to safely extract a job from.
  * @param[in] pJob The job to extract.
@@ -365,21 +568,91 @@ IotTaskPoolError_t IotTaskPool_Destroy( IotTaskPool_t taskPoolHandle )
          */
 
         /* (1) Clear the job queue. */
-        do
+        for( count = 0; count < TASKPOOL_PRIORITY_LANES; ++count )
         {
-            pItemLink = NULL;
+            do
+            {
+                pItemLink = NULL;
 
-            pItemLink = IotDeQueue_DequeueHead( &pTaskPool->dispatchQueue );
+                pItemLink = IotDeQueue_DequeueHead( &pTaskPool->lanes[ count ].queue );
 
-            if( pItemLink != NULL )
+                if( pItemLink != NULL )
+                {
+                    _taskPoolJob_t * pJob = IotLink_Container( _taskPoolJob_t, pItemLink, link );
+
+                    _destroyJob( pJob );
+                }
+            } while( pItemLink );
+        }
+
+        /* In work stealing mode, also clear the deques of all workers. */
+        if( pTaskPool->pWorkStealing != NULL )
+        {
+            _taskPoolWorkStealing_t * pWorkStealing = pTaskPool->pWorkStealing;
+
+            for( count = 0; count < IOT_TASKPOOL_WORK_STEALING_MAX_WORKERS; ++count )
             {
-                _taskPoolJob_t * pJob = IotLink_Container( _taskPoolJob_t, pItemLink, link );
+                _taskPoolWorkQueue_t * pQueue = &pWorkStealing->queues[ count ];
+
+                IotMutex_Lock( &pQueue->lock );
+                {
+                    while( pQueue->count > 0UL )
+                    {
+                        _destroyJob( pQueue->pJobs[ pQueue->head ] );
 
-                _destroyJob( pJob );
+                        pQueue->head = ( pQueue->head + 1UL ) % IOT_TASKPOOL_WORK_QUEUE_SIZE;
+                        pQueue->count--;
+                    }
+                }
+                IotMutex_Unlock( &pQueue->lock );
             }
-        } while( pItemLink );
+
+            /* The shared dispatch queue is empty now. Workers read the counter without the task pool lock. */
+            ( void ) Atomic_AND_u32( &pWorkStealing->sharedJobs, 0 );
+        }
 
         /* (2) Clear the timer queue. */
+        if( pTaskPool->pTimerWheel != NULL )
+        {
+            _taskPoolTimerWheel_t * pTimerWheel = pTaskPool->pTimerWheel;
+            uint32_t level, slot;
+
+            /* As for the timer queue below, let the timer thread complete the shutdown if
+             * the timer may have fired already. */
+            if( ( pTimerWheel->armedTick != UINT64_MAX ) &&
+                ( ( pTimerWheel->armedTick * IOT_TASKPOOL_TIMER_WHEEL_TICK_MS ) <= IotClock_GetTimeMs() ) )
+            {
+                IotLogDebug( "Shutdown will be deferred to the timer thread" );
+
+                completeShutdown = false;
+            }
+
+            /* Remove all timers from the timing wheel. */
+            for( level = 0; level < IOT_TASKPOOL_TIMER_WHEEL_LEVELS; ++level )
+            {
+                for( slot = 0; slot < TASKPOOL_TIMER_WHEEL_SLOTS; ++slot )
+                {
+                    for( ; ; )
+                    {
+                        pItemLink = IotListDouble_RemoveHead( &pTimerWheel->slots[ level ][ slot ] );
+
+                        if( pItemLink == NULL )
+                        {
+                            break;
+                        }
+
+                        _taskPoolTimerEvent_t * pTimerEvent = IotLink_Container( _taskPoolTimerEvent_t, pItemLink, link );
+
+                        _destroyJob( pTimerEvent->pJob );
+
+                        IotTaskPool_FreeTimerEvent( pTimerEvent );
+                    }
+                }
+            }
+
+            pTimerWheel->eventCount = 0;
+        }
+        else
         {
             _taskPoolTimerEvent_t * pTimerEvent;
 
@@ -423,20 +696,8 @@ IotTaskPoolError_t IotTaskPool_Destroy( IotTaskPool_t taskPoolHandle )
             }
         }
 
-        /* (3) Clear the job cache. */
-        do
-        {
-            pItemLink = NULL;
-
-            pItemLink = IotListDouble_RemoveHead( &pTaskPool->jobsCache.freeList );
-
-            if( pItemLink != NULL )
-            {
-                _taskPoolJob_t * pJob = IotLink_Container( _taskPoolJob_t, pItemLink, link );
-
-                _destroyJob( pJob );
-            }
-        } while( pItemLink );
+        /* (3) The job cache is not cleared here, because worker threads can still recycle jobs
+         * into it until they exit. It is drained when the task pool is destroyed. */
 
         /* (4) Set the exit condition. */
         _signalShutdown( pTaskPool, activeThreads );
@@ -483,6 +744,12 @@ IotTaskPoolError_t IotTaskPool_SetMaxThreads( IotTaskPool_t taskPoolHandle,
     TASKPOOL_ON_ARG_ERROR_GOTO_CLEANUP( pTaskPool->minThreads > maxThreads );
     TASKPOOL_ON_ARG_ERROR_GOTO_CLEANUP( maxThreads < 1UL );
 
+    /* A task pool in work stealing mode has a fixed set of workers. */
+    if( pTaskPool->pWorkStealing != NULL )
+    {
+        TASKPOOL_SET_AND_GOTO_CLEANUP( IOT_TASKPOOL_ILLEGAL_OPERATION );
+    }
+
     TASKPOOL_ENTER_CRITICAL();
     {
         /* Bail out early if this task pool is shutting down. */
@@ -565,19 +832,14 @@ IotTaskPoolError_t IotTaskPool_CreateRecyclableJob( IotTaskPool_t taskPoolHandle
     {
         _taskPoolJob_t * pTempJob = NULL;
 
-        TASKPOOL_ENTER_CRITICAL();
+        /* Bail out early if this task pool is shutting down. */
+        if( _isJobsCacheClosed( &pTaskPool->jobsCache ) )
         {
-            /* Bail out early if this task pool is shutting down. */
-            if( _IsShutdownStarted( pTaskPool ) )
-            {
-                TASKPOOL_EXIT_CRITICAL();
-
-                TASKPOOL_SET_AND_GOTO_CLEANUP( IOT_TASKPOOL_SHUTDOWN_IN_PROGRESS );
-            }
-
-            pTempJob = _fetchOrAllocateJob( &pTaskPool->jobsCache );
+            TASKPOOL_SET_AND_GOTO_CLEANUP( IOT_TASKPOOL_SHUTDOWN_IN_PROGRESS );
         }
-        TASKPOOL_EXIT_CRITICAL();
+
+        /* The jobs cache is lock-free, so there is no need to take the task pool lock. */
+        pTempJob = _fetchOrAllocateJob( &pTaskPool->jobsCache );
 
         if( pTempJob == NULL )
         {
@@ -656,32 +918,100 @@ IotTaskPoolError_t IotTaskPool_RecycleJob( IotTaskPool_t taskPoolHandle,
 
     pTaskPool = ( _taskPool_t * ) taskPoolHandle;
 
+    /* Bail out early if this task pool is shutting down. */
+    if( _isJobsCacheClosed( &pTaskPool->jobsCache ) )
+    {
+        TASKPOOL_SET_AND_GOTO_CLEANUP( IOT_TASKPOOL_SHUTDOWN_IN_PROGRESS );
+    }
+
+    /* Do not recycle statically allocated jobs. */
+    if( ( pJob->flags & IOT_TASK_POOL_INTERNAL_STATIC ) == IOT_TASK_POOL_INTERNAL_STATIC )
+    {
+        IotLogWarn( "Attempt to recycle a statically allocated job." );
+
+        TASKPOOL_SET_AND_GOTO_CLEANUP( IOT_TASKPOOL_ILLEGAL_OPERATION );
+    }
+
+    /* The dispatch queue and the timer change the status of the job under the task
+     * pool lock, so check it under the lock too. A job in a work-stealing deque is
+     * checked again under the lock of the deque when it is extracted. */
     TASKPOOL_ENTER_CRITICAL();
     {
-        /* Bail out early if this task pool is shutting down. */
-        if( _IsShutdownStarted( pTaskPool ) )
+        /* A job that is still in the dispatch queue or the timer queue is canceled
+         * before it is recycled. */
+        if( ( pJob->status == IOT_TASKPOOL_STATUS_SCHEDULED ) || ( pJob->status == IOT_TASKPOOL_STATUS_DEFERRED ) )
         {
-            status = IOT_TASKPOOL_SHUTDOWN_IN_PROGRESS;
+            if( _IsShutdownStarted( pTaskPool ) )
+            {
+                status = IOT_TASKPOOL_SHUTDOWN_IN_PROGRESS;
+            }
+            else
+            {
+                status = _trySafeExtraction( pTaskPool, pJob, true );
+            }
         }
-        /* Do not recycle statically allocated jobs. */
-        else if( ( pJob->flags & IOT_TASK_POOL_INTERNAL_STATIC ) == 0UL )
+        /* A job that is already in the cache cannot be recycled twice. */
+        else if( pJob->status == IOT_TASKPOOL_STATUS_UNDEFINED )
         {
-            status = _trySafeExtraction( pTaskPool, pJob, true );
+            IotLogWarn( "Attempt to recycle a job that was recycled already." );
+
+            status = IOT_TASKPOOL_ILLEGAL_OPERATION;
         }
         else
         {
-            IotLogWarn( "Attempt to recycle a statically allocated job." );
+            /* Nothing to do. */
+        }
+    }
+    TASKPOOL_EXIT_CRITICAL();
 
-            status = IOT_TASKPOOL_ILLEGAL_OPERATION;
+    /* If all safety checks completed, proceed. */
+    if( TASKPOOL_SUCCEEDED( status ) )
+    {
+        /* At this point, the job must not be in any queue or list. */
+        IotTaskPool_Assert( IotLink_IsLinked( &pJob->link ) == false );
+
+        _recycleJob( &pTaskPool->jobsCache, pJob );
+    }
+
+    TASKPOOL_NO_FUNCTION_CLEANUP();
+}
+
+/*-----------------------------------------------------------*/
+
+IotTaskPoolError_t IotTaskPool_Schedule( IotTaskPool_t taskPoolHandle,
+                                         IotTaskPoolJob_t pJob,
+                                         uint32_t flags )
+{
+    TASKPOOL_FUNCTION_ENTRY( IOT_TASKPOOL_SUCCESS );
+    _taskPool_t * pTaskPool = NULL;
+
+    /* Parameter checking. */
+    TASKPOOL_ON_NULL_ARG_GOTO_CLEANUP( taskPoolHandle );
+    TASKPOOL_ON_NULL_ARG_GOTO_CLEANUP( pJob );
+    TASKPOOL_ON_ARG_ERROR_GOTO_CLEANUP( ( flags != 0UL ) && ( flags != IOT_TASKPOOL_JOB_HIGH_PRIORITY ) );
+
+    pTaskPool = ( _taskPool_t * ) taskPoolHandle;
+
+    TASKPOOL_ENTER_CRITICAL();
+    {
+        /* Bail out early if this task pool is shutting down. */
+        if( _IsShutdownStarted( pTaskPool ) )
+        {
+            status = IOT_TASKPOOL_SHUTDOWN_IN_PROGRESS;
+        }
+        else
+        {
+            status = _trySafeExtraction( pTaskPool, pJob, false );
         }
 
         /* If all safety checks completed, proceed. */
         if( TASKPOOL_SUCCEEDED( status ) )
         {
-            /* At this point, the job must not be in any queue or list. */
-            IotTaskPool_Assert( IotLink_IsLinked( &pJob->link ) == false );
+            /* High priority jobs go ahead of all other jobs of the normal lane. */
+            pJob->lane = ( uint32_t ) IOT_TASKPOOL_PRIORITY_NORMAL;
+            pJob->deadline = ( ( flags & IOT_TASKPOOL_JOB_HIGH_PRIORITY ) == IOT_TASKPOOL_JOB_HIGH_PRIORITY ) ? 0ULL : TASKPOOL_NO_DEADLINE;
 
-            _recycleJob( &pTaskPool->jobsCache, pJob );
+            status = _scheduleInternal( pTaskPool, pJob, flags );
         }
     }
     TASKPOOL_EXIT_CRITICAL();
@@ -691,9 +1021,10 @@ IotTaskPoolError_t IotTaskPool_RecycleJob( IotTaskPool_t taskPoolHandle,
 
 /*-----------------------------------------------------------*/
 
-IotTaskPoolError_t IotTaskPool_Schedule( IotTaskPool_t taskPoolHandle,
-                                         IotTaskPoolJob_t pJob,
-                                         uint32_t flags )
+IotTaskPoolError_t IotTaskPool_ScheduleWithPriority( IotTaskPool_t taskPoolHandle,
+                                                     IotTaskPoolJob_t pJob,
+                                                     IotTaskPoolJobPriority_t priority,
+                                                     uint32_t deadlineMs )
 {
     TASKPOOL_FUNCTION_ENTRY( IOT_TASKPOOL_SUCCESS );
     _taskPool_t * pTaskPool = NULL;
@@ -701,7 +1032,7 @@ IotTaskPoolError_t IotTaskPool_Schedule( IotTaskPool_t taskPoolHandle,
     /* Parameter checking. */
     TASKPOOL_ON_NULL_ARG_GOTO_CLEANUP( taskPoolHandle );
     TASKPOOL_ON_NULL_ARG_GOTO_CLEANUP( pJob );
-    TASKPOOL_ON_ARG_ERROR_GOTO_CLEANUP( ( flags != 0UL ) && ( flags != IOT_TASKPOOL_JOB_HIGH_PRIORITY ) );
+    TASKPOOL_ON_ARG_ERROR_GOTO_CLEANUP( ( uint32_t ) priority >= TASKPOOL_PRIORITY_LANES );
 
     pTaskPool = ( _taskPool_t * ) taskPoolHandle;
 
@@ -720,7 +1051,10 @@ IotTaskPoolError_t IotTaskPool_Schedule( IotTaskPool_t taskPoolHandle,
         /* If all safety checks completed, proceed. */
         if( TASKPOOL_SUCCEEDED( status ) )
         {
-            status = _scheduleInternal( pTaskPool, pJob, flags );
+            pJob->lane = ( uint32_t ) priority;
+            pJob->deadline = ( deadlineMs == 0UL ) ? TASKPOOL_NO_DEADLINE : ( IotClock_GetTimeMs() + deadlineMs );
+
+            status = _scheduleInternal( pTaskPool, pJob, 0 );
         }
     }
     TASKPOOL_EXIT_CRITICAL();
@@ -761,7 +1095,6 @@ IotTaskPoolError_t IotTaskPool_ScheduleDeferred( IotTaskPool_t taskPoolHandle,
         /* If all safety checks completed, proceed. */
         if( TASKPOOL_SUCCEEDED( _trySafeExtraction( pTaskPool, pJob, false ) ) )
         {
-            IotLink_t * pTimerEventLink;
             uint64_t now;
 
             _taskPoolTimerEvent_t * pTimerEvent = ( _taskPoolTimerEvent_t * ) IotTaskPool_MallocTimerEvent( sizeof( _taskPoolTimerEvent_t ) );
@@ -782,25 +1115,18 @@ IotTaskPoolError_t IotTaskPool_ScheduleDeferred( IotTaskPool_t taskPoolHandle,
             pTimerEvent->expirationTime = now + timeMs;
             pTimerEvent->pJob = ( _taskPoolJob_t * ) pJob;
 
-            /* Append the timer event to the timer list. */
-            IotListDouble_InsertSorted( &pTaskPool->timerEventsList, &pTimerEvent->link, _timerEventCompare );
-
-            /* Update the job status to 'scheduled'. */
-            pJob->status = IOT_TASKPOOL_STATUS_DEFERRED;
+            /* Append the timer event to the timer list or wheel, and re-arm the timer if needed. */
+            _insertTimerEvent( pTaskPool, pTimerEvent, now );
 
-            /* Peek the first event in the timer event list. There must be at least one,
-             * since we just inserted it. */
-            pTimerEventLink = IotListDouble_PeekHead( &pTaskPool->timerEventsList );
-            IotTaskPool_Assert( pTimerEventLink != NULL );
+            /* Keep track of the timer event, so that the job can be canceled in constant time. */
+            pJob->pTimerEvent = pTimerEvent;
 
-            /* If the event we inserted is at the front of the queue, then
-             * we need to reschedule the underlying timer. */
-            if( pTimerEventLink == &pTimerEvent->link )
-            {
-                pTimerEvent = IotLink_Container( _taskPoolTimerEvent_t, pTimerEventLink, link );
+            /* Deferred jobs go to the normal lane when they expire. */
+            pJob->lane = ( uint32_t ) IOT_TASKPOOL_PRIORITY_NORMAL;
+            pJob->deadline = TASKPOOL_NO_DEADLINE;
 
-                _rescheduleDeferredJobsTimer( &pTaskPool->timer, pTimerEvent );
-            }
+            /* Update the job status to 'scheduled'. */
+            pJob->status = IOT_TASKPOOL_STATUS_DEFERRED;
         }
         else
         {
@@ -851,33 +1177,94 @@ IotTaskPoolError_t IotTaskPool_GetStatus( IotTaskPool_t taskPoolHandle,
 
 /*-----------------------------------------------------------*/
 
-IotTaskPoolError_t IotTaskPool_TryCancel( IotTaskPool_t taskPoolHandle,
-                                          IotTaskPoolJob_t pJob,
-                                          IotTaskPoolJobStatus_t * const pStatus )
+IotTaskPoolError_t IotTaskPool_GetCacheStatus( IotTaskPool_t taskPoolHandle,
+                                               IotTaskPoolCacheStatus_t * const pStatus )
 {
     TASKPOOL_FUNCTION_ENTRY( IOT_TASKPOOL_SUCCESS );
-    _taskPool_t * pTaskPool = NULL;
+    _taskPoolCache_t * pCache = NULL;
 
     /* Parameter checking. */
     TASKPOOL_ON_NULL_ARG_GOTO_CLEANUP( taskPoolHandle );
-    TASKPOOL_ON_NULL_ARG_GOTO_CLEANUP( pJob );
+    TASKPOOL_ON_NULL_ARG_GOTO_CLEANUP( pStatus );
 
-    pTaskPool = ( _taskPool_t * ) taskPoolHandle;
+    pCache = &( ( _taskPool_t * ) taskPoolHandle )->jobsCache;
 
-    if( pStatus != NULL )
+    /* Bail out early if this task pool is shutting down. */
+    if( _isJobsCacheClosed( pCache ) )
     {
-        *pStatus = IOT_TASKPOOL_STATUS_UNDEFINED;
+        TASKPOOL_SET_AND_GOTO_CLEANUP( IOT_TASKPOOL_SHUTDOWN_IN_PROGRESS );
     }
 
-    TASKPOOL_ENTER_CRITICAL();
-    {
-        /* Check again if this task pool is shutting down. */
-        if( _IsShutdownStarted( pTaskPool ) )
-        {
-            TASKPOOL_EXIT_CRITICAL();
-
-            TASKPOOL_SET_AND_GOTO_CLEANUP( IOT_TASKPOOL_SHUTDOWN_IN_PROGRESS );
-        }
+    /* Adding zero is an atomic read. */
+    pStatus->hits = Atomic_Add_u32( &pCache->hits, 0 );
+    pStatus->misses = Atomic_Add_u32( &pCache->misses, 0 );
+    pStatus->freeCount = Atomic_Add_u32( &pCache->freeCount, 0 );
+
+    TASKPOOL_NO_FUNCTION_CLEANUP();
+}
+
+/*-----------------------------------------------------------*/
+
+IotTaskPoolError_t IotTaskPool_GetLaneStatus( IotTaskPool_t taskPoolHandle,
+                                              IotTaskPoolJobPriority_t priority,
+                                              IotTaskPoolLaneStatus_t * const pStatus )
+{
+    TASKPOOL_FUNCTION_ENTRY( IOT_TASKPOOL_SUCCESS );
+    _taskPool_t * pTaskPool = NULL;
+
+    /* Parameter checking. */
+    TASKPOOL_ON_NULL_ARG_GOTO_CLEANUP( taskPoolHandle );
+    TASKPOOL_ON_NULL_ARG_GOTO_CLEANUP( pStatus );
+    TASKPOOL_ON_ARG_ERROR_GOTO_CLEANUP( ( uint32_t ) priority >= TASKPOOL_PRIORITY_LANES );
+
+    pTaskPool = ( _taskPool_t * ) taskPoolHandle;
+
+    TASKPOOL_ENTER_CRITICAL();
+    {
+        /* Bail out early if this task pool is shutting down. */
+        if( _IsShutdownStarted( pTaskPool ) )
+        {
+            TASKPOOL_EXIT_CRITICAL();
+
+            TASKPOOL_SET_AND_GOTO_CLEANUP( IOT_TASKPOOL_SHUTDOWN_IN_PROGRESS );
+        }
+
+        *pStatus = pTaskPool->lanes[ priority ].status;
+    }
+    TASKPOOL_EXIT_CRITICAL();
+
+    TASKPOOL_NO_FUNCTION_CLEANUP();
+}
+
+/*-----------------------------------------------------------*/
+
+IotTaskPoolError_t IotTaskPool_TryCancel( IotTaskPool_t taskPoolHandle,
+                                          IotTaskPoolJob_t pJob,
+                                          IotTaskPoolJobStatus_t * const pStatus )
+{
+    TASKPOOL_FUNCTION_ENTRY( IOT_TASKPOOL_SUCCESS );
+    _taskPool_t * pTaskPool = NULL;
+
+    /* Parameter checking. */
+    TASKPOOL_ON_NULL_ARG_GOTO_CLEANUP( taskPoolHandle );
+    TASKPOOL_ON_NULL_ARG_GOTO_CLEANUP( pJob );
+
+    pTaskPool = ( _taskPool_t * ) taskPoolHandle;
+
+    if( pStatus != NULL )
+    {
+        *pStatus = IOT_TASKPOOL_STATUS_UNDEFINED;
+    }
+
+    TASKPOOL_ENTER_CRITICAL();
+    {
+        /* Check again if this task pool is shutting down. */
+        if( _IsShutdownStarted( pTaskPool ) )
+        {
+            TASKPOOL_EXIT_CRITICAL();
+
+            TASKPOOL_SET_AND_GOTO_CLEANUP( IOT_TASKPOOL_SHUTDOWN_IN_PROGRESS );
+        }
 
         status = _tryCancelInternal( pTaskPool, pJob, pStatus );
     }
@@ -942,6 +1329,9 @@ IotTaskPoolError_t _performTaskPoolParameterValidation( const IotTaskPoolInfo_t
     TASKPOOL_ON_ARG_ERROR_GOTO_CLEANUP( pInfo->minThreads > pInfo->maxThreads );
     TASKPOOL_ON_ARG_ERROR_GOTO_CLEANUP( pInfo->minThreads < 1UL );
     TASKPOOL_ON_ARG_ERROR_GOTO_CLEANUP( pInfo->maxThreads < 1UL );
+    TASKPOOL_ON_ARG_ERROR_GOTO_CLEANUP( ( pInfo->flags & ~( IOT_TASKPOOL_TIMER_WHEEL | IOT_TASKPOOL_WORK_STEALING ) ) != 0UL );
+    TASKPOOL_ON_ARG_ERROR_GOTO_CLEANUP( ( ( pInfo->flags & IOT_TASKPOOL_WORK_STEALING ) == IOT_TASKPOOL_WORK_STEALING ) &&
+                                        ( pInfo->maxThreads > IOT_TASKPOOL_WORK_STEALING_MAX_WORKERS ) );
 
     TASKPOOL_NO_FUNCTION_CLEANUP();
 }
@@ -951,6 +1341,7 @@ static IotTaskPoolError_t _initTaskPoolControlStructures( const IotTaskPoolInfo_
 {
     TASKPOOL_FUNCTION_ENTRY( IOT_TASKPOOL_SUCCESS );
 
+    uint32_t count;
     bool semStartStopInit = false;
     bool lockInit = false;
     bool semDispatchInit = false;
@@ -962,7 +1353,11 @@ static IotTaskPoolError_t _initTaskPoolControlStructures( const IotTaskPoolInfo_
     /* Initialize a job data structures that require no de-initialization.
      * All other data structures carry a value of 'NULL' before initialization.
      */
-    IotDeQueue_Create( &pTaskPool->dispatchQueue );
+    for( count = 0; count < TASKPOOL_PRIORITY_LANES; ++count )
+    {
+        IotDeQueue_Create( &pTaskPool->lanes[ count ].queue );
+    }
+
     IotListDouble_Create( &pTaskPool->timerEventsList );
 
     pTaskPool->minThreads = pInfo->minThreads;
@@ -972,6 +1367,39 @@ static IotTaskPoolError_t _initTaskPoolControlStructures( const IotTaskPoolInfo_
 
     _initJobsCache( &pTaskPool->jobsCache );
 
+    /* Allocate the timing wheel, if the user asked for one. */
+    if( ( pInfo->flags & IOT_TASKPOOL_TIMER_WHEEL ) == IOT_TASKPOOL_TIMER_WHEEL )
+    {
+        pTaskPool->pTimerWheel = ( _taskPoolTimerWheel_t * ) IotTaskPool_MallocTimerWheel( sizeof( _taskPoolTimerWheel_t ) );
+
+        if( pTaskPool->pTimerWheel == NULL )
+        {
+            TASKPOOL_SET_AND_GOTO_CLEANUP( IOT_TASKPOOL_NO_MEMORY );
+        }
+
+        _timerWheelInit( pTaskPool->pTimerWheel, IotClock_GetTimeMs() );
+    }
+
+    /* Allocate the worker deques, if the user asked for work stealing. */
+    if( ( pInfo->flags & IOT_TASKPOOL_WORK_STEALING ) == IOT_TASKPOOL_WORK_STEALING )
+    {
+        _taskPoolWorkStealing_t * pWorkStealing = ( _taskPoolWorkStealing_t * ) IotTaskPool_MallocWorkQueues( sizeof( _taskPoolWorkStealing_t ) );
+
+        if( pWorkStealing == NULL )
+        {
+            TASKPOOL_SET_AND_GOTO_CLEANUP( IOT_TASKPOOL_NO_MEMORY );
+        }
+
+        if( _workStealingInit( pWorkStealing ) == false )
+        {
+            IotTaskPool_FreeWorkQueues( pWorkStealing );
+
+            TASKPOOL_SET_AND_GOTO_CLEANUP( IOT_TASKPOOL_NO_MEMORY );
+        }
+
+        pTaskPool->pWorkStealing = pWorkStealing;
+    }
+
     /* Initialize the semaphore to ensure all threads have started. */
     if( IotSemaphore_Create( &pTaskPool->startStopSignal, 0, TASKPOOL_MAX_SEM_VALUE ) == true )
     {
@@ -1034,6 +1462,19 @@ static IotTaskPoolError_t _initTaskPoolControlStructures( const IotTaskPoolInfo_
         {
             IotClock_TimerDestroy( &pTaskPool->timer );
         }
+
+        if( pTaskPool->pTimerWheel != NULL )
+        {
+            IotTaskPool_FreeTimerWheel( pTaskPool->pTimerWheel );
+            pTaskPool->pTimerWheel = NULL;
+        }
+
+        if( pTaskPool->pWorkStealing != NULL )
+        {
+            _workStealingDestroy( pTaskPool->pWorkStealing );
+            IotTaskPool_FreeWorkQueues( pTaskPool->pWorkStealing );
+            pTaskPool->pWorkStealing = NULL;
+        }
     }
 
     TASKPOOL_FUNCTION_CLEANUP_END();
@@ -1046,6 +1487,8 @@ static IotTaskPoolError_t _createTaskPool( const IotTaskPoolInfo_t * const pInfo
 
     uint32_t count;
     uint32_t threadsCreated = 0;
+    uint32_t threadsToCreate;
+    IotThreadRoutine_t workerRoutine = _taskPoolWorker;
     bool controlInit = false;
 
     /* Initialize all internal data structure prior to creating all threads. */
@@ -1061,11 +1504,20 @@ static IotTaskPoolError_t _createTaskPool( const IotTaskPoolInfo_t * const pInfo
     /* jobs. A thread can be woken up for exit or for new jobs only at that point in time.  */
     /* The exit condition is setting the maximum number of threads to 0. */
 
+    /* A task pool in work stealing mode never grows, and creates the maximum number of threads right away. */
+    threadsToCreate = pTaskPool->minThreads;
+
+    if( pTaskPool->pWorkStealing != NULL )
+    {
+        threadsToCreate = pTaskPool->maxThreads;
+        workerRoutine = _taskPoolStealingWorker;
+    }
+
     /* Create the minimum number of threads specified by the user, and if one fails shutdown and return error. */
-    for( ; threadsCreated < pTaskPool->minThreads; )
+    for( ; threadsCreated < threadsToCreate; )
     {
         /* Create one thread. */
-        if( Iot_CreateDetachedThread( _taskPoolWorker,
+        if( Iot_CreateDetachedThread( workerRoutine,
                                       pTaskPool,
                                       pTaskPool->priority,
                                       pTaskPool->stackSize ) == false )
@@ -1115,10 +1567,25 @@ static IotTaskPoolError_t _createTaskPool( const IotTaskPoolInfo_t * const pInfo
 
 static void _destroyTaskPool( _taskPool_t * const pTaskPool )
 {
+    _drainJobsCache( &pTaskPool->jobsCache );
+
     IotClock_TimerDestroy( &pTaskPool->timer );
     IotSemaphore_Destroy( &pTaskPool->dispatchSignal );
     IotSemaphore_Destroy( &pTaskPool->startStopSignal );
     IotMutex_Destroy( &pTaskPool->lock );
+
+    if( pTaskPool->pTimerWheel != NULL )
+    {
+        IotTaskPool_FreeTimerWheel( pTaskPool->pTimerWheel );
+        pTaskPool->pTimerWheel = NULL;
+    }
+
+    if( pTaskPool->pWorkStealing != NULL )
+    {
+        _workStealingDestroy( pTaskPool->pWorkStealing );
+        IotTaskPool_FreeWorkQueues( pTaskPool->pWorkStealing );
+        pTaskPool->pWorkStealing = NULL;
+    }
 }
 
 /* ---------------------------------------------------------------------------------------------- */
@@ -1143,7 +1610,6 @@ static void _taskPoolWorker( void * pUserContext )
     do
     {
         bool jobAvailable;
-        IotLink_t * pFirst;
         _taskPoolJob_t * pJob = NULL;
 
         /* Wait on incoming notifications. If waiting on the semaphore return with timeout, then
@@ -1209,15 +1675,12 @@ static void _taskPoolWorker( void * pUserContext )
             /* Only look for a job if waiting did not timed out. */
             if( jobAvailable == true )
             {
-                /* Dequeue the first job in FIFO order. */
-                pFirst = IotDeQueue_DequeueHead( &pTaskPool->dispatchQueue );
+                /* Dequeue the next job in priority order. */
+                pJob = _laneDequeue( pTaskPool );
 
                 /* If there is indeed a job, then update status under lock, and release the lock before processing the job. */
-                if( pFirst != NULL )
+                if( pJob != NULL )
                 {
-                    /* Extract the job from its link. */
-                    pJob = IotLink_Container( _taskPoolJob_t, pFirst, link );
-
                     /* Update status to 'executing'. */
                     pJob->status = IOT_TASKPOOL_STATUS_COMPLETED;
                     userCallback = pJob->userCallback;
@@ -1256,14 +1719,11 @@ static void _taskPoolWorker( void * pUserContext )
                 /* Update the number of busy threads, so new requests can be served by creating new threads, up to maxThreads. */
                 pTaskPool->activeJobs--;
 
-                /* Try and dequeue the next job in the dispatch queue. */
-                IotLink_t * pItem = NULL;
-
-                /* Dequeue the next job from the dispatch queue. */
-                pItem = IotDeQueue_DequeueHead( &pTaskPool->dispatchQueue );
+                /* Dequeue the next job in priority order. */
+                pJob = _laneDequeue( pTaskPool );
 
                 /* If there is no job left in the dispatch queue, update the worker status and leave. */
-                if( pItem == NULL )
+                if( pJob == NULL )
                 {
                     TASKPOOL_EXIT_CRITICAL();
 
@@ -1272,25 +1732,565 @@ static void _taskPoolWorker( void * pUserContext )
                 }
                 else
                 {
-                    pJob = IotLink_Container( _taskPoolJob_t, pItem, link );
+                    userCallback = pJob->userCallback;
+                }
+
+                pJob->status = IOT_TASKPOOL_STATUS_COMPLETED;
+            }
+            TASKPOOL_EXIT_CRITICAL();
+        }
+    } while( running == true );
+}
+
+/*-----------------------------------------------------------*/
+
+static void _taskPoolStealingWorker( void * pUserContext )
+{
+    IotTaskPool_Assert( pUserContext != NULL );
+
+    IotTaskPoolRoutine_t userCallback = NULL;
+    _taskPoolJob_t * pJob = NULL;
+    uint32_t queueIndex;
+
+    /* Extract pTaskPool pointer from context. */
+    _taskPool_t * pTaskPool = ( _taskPool_t * ) pUserContext;
+    _taskPoolWorkStealing_t * pWorkStealing = pTaskPool->pWorkStealing;
+
+    /* Claim a deque, so that the jobs this worker schedules are pushed to it. */
+    TASKPOOL_ENTER_CRITICAL();
+    {
+        for( queueIndex = 0; queueIndex < IOT_TASKPOOL_WORK_STEALING_MAX_WORKERS; ++queueIndex )
+        {
+            if( pWorkStealing->queues[ queueIndex ].pOwner == NULL )
+            {
+                pWorkStealing->queues[ queueIndex ].pOwner = Iot_GetCurrentThread();
+                break;
+            }
+        }
+    }
+    TASKPOOL_EXIT_CRITICAL();
+
+    /* The task pool never starts more workers than deques. */
+    IotTaskPool_Assert( queueIndex < IOT_TASKPOOL_WORK_STEALING_MAX_WORKERS );
+
+    /* Signal that this worker completed initialization and it is ready to receive notifications. */
+    IotSemaphore_Post( &pTaskPool->startStopSignal );
+
+    /* A worker in work stealing mode only exits when the task pool shuts down. */
+    for( ; ; )
+    {
+        pJob = _workStealingFetch( pTaskPool, queueIndex, &userCallback );
+
+        if( pJob == NULL )
+        {
+            /* Advertise this worker as idle before looking for jobs one last time. Schedulers check
+             * for idle workers after queuing a job, so either the job is found here, or the
+             * dispatch signal is posted. */
+            ( void ) Atomic_Increment_u32( &pWorkStealing->idleWorkers );
+
+            pJob = _workStealingFetch( pTaskPool, queueIndex, &userCallback );
+
+            if( pJob == NULL )
+            {
+                ( void ) IotSemaphore_TimedWait( &pTaskPool->dispatchSignal, IOT_TASKPOOL_JOB_WAIT_TIMEOUT_MS );
+            }
+
+            ( void ) Atomic_Decrement_u32( &pWorkStealing->idleWorkers );
+        }
+
+        if( pJob == NULL )
+        {
+            bool exiting = false;
+
+            /* Check the exit condition only when there is no job to execute. */
+            TASKPOOL_ENTER_CRITICAL();
+            {
+                if( _IsShutdownStarted( pTaskPool ) )
+                {
+                    IotLogDebug( "Worker thread exiting because shutdown condition was set." );
+
+                    /* Release the deque and decrease the number of active threads. */
+                    pWorkStealing->queues[ queueIndex ].pOwner = NULL;
+                    pTaskPool->activeThreads--;
+
+                    exiting = true;
+                }
+            }
+            TASKPOOL_EXIT_CRITICAL();
+
+            if( exiting == true )
+            {
+                /* Signal that this worker is exiting. */
+                IotSemaphore_Post( &pTaskPool->startStopSignal );
+
+                break;
+            }
+        }
+        else
+        {
+            /* Process the job by invoking the associated callback with the user context.
+             * This task pool thread will not be available until the user callback returns.
+             */
+            IotTaskPool_Assert( IotLink_IsLinked( &pJob->link ) == false );
+            IotTaskPool_Assert( userCallback != NULL );
+
+            userCallback( pTaskPool, pJob, pJob->pUserContext );
+
+            /* This job is finished, clear its pointer. */
+            pJob = NULL;
+            userCallback = NULL;
+        }
+    }
+}
+
+/* ---------------------------------------------------------------------------------------------- */
+
+static bool _workStealingInit( _taskPoolWorkStealing_t * const pWorkStealing )
+{
+    uint32_t index;
+    bool status = true;
+
+    memset( pWorkStealing, 0x00, sizeof( _taskPoolWorkStealing_t ) );
+
+    for( index = 0; index < IOT_TASKPOOL_WORK_STEALING_MAX_WORKERS; ++index )
+    {
+        if( IotMutex_Create( &pWorkStealing->queues[ index ].lock, false ) == false )
+        {
+            status = false;
+            break;
+        }
+    }
+
+    /* Roll back the locks created so far. */
+    if( status == false )
+    {
+        while( index > 0UL )
+        {
+            --index;
+            IotMutex_Destroy( &pWorkStealing->queues[ index ].lock );
+        }
+    }
+
+    return status;
+}
+
+/*-----------------------------------------------------------*/
+
+static void _workStealingDestroy( _taskPoolWorkStealing_t * const pWorkStealing )
+{
+    uint32_t index;
+
+    for( index = 0; index < IOT_TASKPOOL_WORK_STEALING_MAX_WORKERS; ++index )
+    {
+        IotTaskPool_Assert( pWorkStealing->queues[ index ].count == 0UL );
+
+        IotMutex_Destroy( &pWorkStealing->queues[ index ].lock );
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+static void _workStealingDispatch( _taskPool_t * const pTaskPool,
+                                   _taskPoolJob_t * const pJob,
+                                   uint32_t flags )
+{
+    _taskPoolWorkStealing_t * const pWorkStealing = pTaskPool->pWorkStealing;
+    _taskPoolWorkQueue_t * pQueue = NULL;
+    bool queued = false;
+    uint32_t index;
+
+    /* High priority and urgent jobs skip the deques, since workers look at the shared dispatch queue first. */
+    if( ( ( flags & IOT_TASKPOOL_JOB_HIGH_PRIORITY ) == 0UL ) && ( pJob->lane != ( uint32_t ) IOT_TASKPOOL_PRIORITY_URGENT ) )
+    {
+        void * pCurrentThread = Iot_GetCurrentThread();
+
+        /* A job scheduled from a worker goes to the deque of that worker... */
+        for( index = 0; index < IOT_TASKPOOL_WORK_STEALING_MAX_WORKERS; ++index )
+        {
+            if( pWorkStealing->queues[ index ].pOwner == pCurrentThread )
+            {
+                pQueue = &pWorkStealing->queues[ index ];
+                break;
+            }
+        }
+
+        /* ...any other job goes to the workers in round-robin order. */
+        if( ( pQueue == NULL ) && ( pTaskPool->activeThreads > 0UL ) )
+        {
+            pQueue = &pWorkStealing->queues[ pWorkStealing->nextQueue % pTaskPool->activeThreads ];
+
+            pWorkStealing->nextQueue++;
+        }
+
+        if( pQueue != NULL )
+        {
+            IotMutex_Lock( &pQueue->lock );
+            {
+                if( pQueue->count < IOT_TASKPOOL_WORK_QUEUE_SIZE )
+                {
+                    pQueue->pJobs[ ( pQueue->head + pQueue->count ) % IOT_TASKPOOL_WORK_QUEUE_SIZE ] = pJob;
+                    pQueue->count++;
+
+                    queued = true;
+                }
+            }
+            IotMutex_Unlock( &pQueue->lock );
+        }
+    }
+
+    /* Fall back to the shared dispatch queue if the deque is full. */
+    if( queued == false )
+    {
+        _laneEnqueue( pTaskPool, pJob );
+
+        ( void ) Atomic_Increment_u32( &pWorkStealing->sharedJobs );
+    }
+
+    /* Busy workers look at all deques before going idle, so only wake up a worker if there is an idle one. */
+    if( Atomic_Add_u32( &pWorkStealing->idleWorkers, 0 ) > 0UL )
+    {
+        IotSemaphore_Post( &pTaskPool->dispatchSignal );
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+static _taskPoolJob_t * _workStealingFetch( _taskPool_t * const pTaskPool,
+                                            uint32_t queueIndex,
+                                            IotTaskPoolRoutine_t * const pUserCallback )
+{
+    _taskPoolWorkStealing_t * const pWorkStealing = pTaskPool->pWorkStealing;
+    _taskPoolJob_t * pJob = NULL;
+    uint32_t count;
+
+    /* Only take the task pool lock if there is some job in the shared dispatch queue. */
+    if( Atomic_Add_u32( &pWorkStealing->sharedJobs, 0 ) > 0UL )
+    {
+        TASKPOOL_ENTER_CRITICAL();
+        {
+            pJob = _laneDequeue( pTaskPool );
+
+            if( pJob != NULL )
+            {
+                ( void ) Atomic_Decrement_u32( &pWorkStealing->sharedJobs );
+
+                /* Update status to 'executing'. */
+                pJob->status = IOT_TASKPOOL_STATUS_COMPLETED;
+                *pUserCallback = pJob->userCallback;
+            }
+        }
+        TASKPOOL_EXIT_CRITICAL();
+    }
+
+    /* Look at the own deque first, then steal from the peers, starting from the next one. */
+    for( count = 0; ( pJob == NULL ) && ( count < IOT_TASKPOOL_WORK_STEALING_MAX_WORKERS ); ++count )
+    {
+        _taskPoolWorkQueue_t * pQueue = &pWorkStealing->queues[ ( queueIndex + count ) % IOT_TASKPOOL_WORK_STEALING_MAX_WORKERS ];
+
+        IotMutex_Lock( &pQueue->lock );
+        {
+            if( pQueue->count > 0UL )
+            {
+                if( count == 0UL )
+                {
+                    /* The owner takes the oldest job. */
+                    pJob = pQueue->pJobs[ pQueue->head ];
+                    pQueue->head = ( pQueue->head + 1UL ) % IOT_TASKPOOL_WORK_QUEUE_SIZE;
+                }
+                else
+                {
+                    /* A thief takes the newest job. */
+                    pJob = pQueue->pJobs[ ( pQueue->head + pQueue->count - 1UL ) % IOT_TASKPOOL_WORK_QUEUE_SIZE ];
+                }
+
+                pQueue->count--;
+
+                /* Update status to 'executing' while the job is still protected by the deque lock,
+                 * so that cancellation cannot see the job in a deque and in execution. */
+                pJob->status = IOT_TASKPOOL_STATUS_COMPLETED;
+                *pUserCallback = pJob->userCallback;
+            }
+        }
+        IotMutex_Unlock( &pQueue->lock );
+    }
+
+    return pJob;
+}
+
+/*-----------------------------------------------------------*/
+
+static bool _workStealingRemove( _taskPoolWorkStealing_t * const pWorkStealing,
+                                 const _taskPoolJob_t * const pJob )
+{
+    uint32_t index, position;
+    bool found = false;
+
+    for( index = 0; ( found == false ) && ( index < IOT_TASKPOOL_WORK_STEALING_MAX_WORKERS ); ++index )
+    {
+        _taskPoolWorkQueue_t * pQueue = &pWorkStealing->queues[ index ];
+
+        IotMutex_Lock( &pQueue->lock );
+        {
+            for( position = 0; position < pQueue->count; ++position )
+            {
+                if( pQueue->pJobs[ ( pQueue->head + position ) % IOT_TASKPOOL_WORK_QUEUE_SIZE ] == pJob )
+                {
+                    found = true;
+                    break;
+                }
+            }
+
+            if( found == true )
+            {
+                /* Close the gap by moving the newer jobs one position towards the head. */
+                for( ; position + 1UL < pQueue->count; ++position )
+                {
+                    pQueue->pJobs[ ( pQueue->head + position ) % IOT_TASKPOOL_WORK_QUEUE_SIZE ] =
+                        pQueue->pJobs[ ( pQueue->head + position + 1UL ) % IOT_TASKPOOL_WORK_QUEUE_SIZE ];
+                }
+
+                pQueue->count--;
+            }
+        }
+        IotMutex_Unlock( &pQueue->lock );
+    }
+
+    return found;
+}
+
+/* ---------------------------------------------------------------------------------------------- */
+
+static void _laneEnqueue( _taskPool_t * const pTaskPool,
+                          _taskPoolJob_t * const pJob )
+{
+    _taskPoolLane_t * const pLane = &pTaskPool->lanes[ pJob->lane ];
+    IotLink_t * pItem = IotDeQueue_PeekTail( &pLane->queue );
+
+    pJob->scheduleTime = IotClock_GetTimeMs();
+
+    /* Most jobs have no deadline, or a later one than the tail, and are simply appended. */
+    if( ( pItem == NULL ) || ( IotLink_Container( _taskPoolJob_t, pItem, link )->deadline <= pJob->deadline ) )
+    {
+        IotDeQueue_EnqueueTail( &pLane->queue, &pJob->link );
+    }
+    else
+    {
+        /* Walk back to the last job with an earlier or equal deadline, so that jobs with the same
+         * deadline stay in FIFO order. Reaching the head of the lane places the job first. */
+        pItem = &pLane->queue;
+
+        do
+        {
+            pItem = pItem->pPrevious;
+        } while( ( pItem != &pLane->queue ) &&
+                 ( IotLink_Container( _taskPoolJob_t, pItem, link )->deadline > pJob->deadline ) );
+
+        IotListDouble_InsertAfter( pItem, &pJob->link );
+    }
+
+    pLane->status.depth++;
+
+    if( pLane->status.depth > pLane->status.maxDepth )
+    {
+        pLane->status.maxDepth = pLane->status.depth;
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+static _taskPoolJob_t * _laneDequeue( _taskPool_t * const pTaskPool )
+{
+    _taskPoolJob_t * pJob = NULL;
+    _taskPoolLane_t * pLane = NULL;
+    uint32_t index;
+    uint32_t selected = TASKPOOL_PRIORITY_LANES;
+    uint64_t now;
+    uint64_t latency;
+
+    /* Find the most urgent lane with a job. */
+    for( index = 0; index < TASKPOOL_PRIORITY_LANES; ++index )
+    {
+        if( IotDeQueue_IsEmpty( &pTaskPool->lanes[ index ].queue ) == false )
+        {
+            selected = index;
+            break;
+        }
+    }
+
+    /* A less urgent lane that was passed over too many times in a row takes precedence. */
+    for( index = selected + 1UL; index < TASKPOOL_PRIORITY_LANES; ++index )
+    {
+        if( pTaskPool->lanes[ index ].skipped >= IOT_TASKPOOL_LANE_STARVATION_LIMIT )
+        {
+            selected = index;
+            pTaskPool->lanes[ index ].status.promoted++;
+            break;
+        }
+    }
+
+    if( selected < TASKPOOL_PRIORITY_LANES )
+    {
+        /* Count one more pass for the less urgent lanes that are waiting. */
+        for( index = selected + 1UL; index < TASKPOOL_PRIORITY_LANES; ++index )
+        {
+            if( IotDeQueue_IsEmpty( &pTaskPool->lanes[ index ].queue ) == false )
+            {
+                pTaskPool->lanes[ index ].skipped++;
+            }
+        }
+
+        pLane = &pTaskPool->lanes[ selected ];
+        pLane->skipped = 0;
+
+        pJob = IotLink_Container( _taskPoolJob_t, IotDeQueue_DequeueHead( &pLane->queue ), link );
+
+        /* Update the statistics of the lane. */
+        now = IotClock_GetTimeMs();
+        latency = ( now > pJob->scheduleTime ) ? ( now - pJob->scheduleTime ) : 0ULL;
+
+        pLane->status.depth--;
+        pLane->status.dispatched++;
+        pLane->status.totalLatencyMs += latency;
+
+        if( latency > pLane->status.maxLatencyMs )
+        {
+            pLane->status.maxLatencyMs = ( latency > UINT32_MAX ) ? UINT32_MAX : ( uint32_t ) latency;
+        }
+
+        if( ( pJob->deadline != TASKPOOL_NO_DEADLINE ) && ( now > pJob->deadline ) )
+        {
+            pLane->status.deadlineMisses++;
+        }
+    }
+
+    return pJob;
+}
+
+/*-----------------------------------------------------------*/
+
+static void _laneRemove( _taskPool_t * const pTaskPool,
+                         _taskPoolJob_t * const pJob )
+{
+    _taskPoolLane_t * const pLane = &pTaskPool->lanes[ pJob->lane ];
+
+    IotDeQueue_Remove( &pJob->link );
+
+    pLane->status.depth--;
+
+    /* An empty lane is not waiting anymore. */
+    if( IotDeQueue_IsEmpty( &pLane->queue ) == true )
+    {
+        pLane->skipped = 0;
+    }
+}
+
+/* ---------------------------------------------------------------------------------------------- */
+
+static void _initJobsCache( _taskPoolCache_t * const pCache )
+{
+    uint32_t index;
+
+    /* All slots start on the stack of the empty slots. */
+    for( index = 0; index < IOT_TASKPOOL_JOBS_RECYCLE_LIMIT; ++index )
+    {
+        pCache->entries[ index ].pJob = NULL;
+        pCache->entries[ index ].next = index + 1UL;
+    }
+
+    pCache->entries[ IOT_TASKPOOL_JOBS_RECYCLE_LIMIT - 1UL ].next = TASKPOOL_CACHE_EMPTY;
+
+    pCache->freeHead = TASKPOOL_CACHE_EMPTY;
+    pCache->unusedHead = 0;
+    pCache->freeCount = 0;
+    pCache->hits = 0;
+    pCache->misses = 0;
+    pCache->closed = 0;
+}
+
+/*-----------------------------------------------------------*/
+
+static void _drainJobsCache( _taskPoolCache_t * const pCache )
+{
+    uint32_t index = _cachePop( pCache, &pCache->freeHead );
+
+    while( index != TASKPOOL_CACHE_EMPTY )
+    {
+        _destroyJob( pCache->entries[ index ].pJob );
+
+        pCache->entries[ index ].pJob = NULL;
+
+        _cachePush( pCache, &pCache->unusedHead, index );
+
+        ( void ) Atomic_Decrement_u32( &pCache->freeCount );
+
+        index = _cachePop( pCache, &pCache->freeHead );
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+static bool _isJobsCacheClosed( _taskPoolCache_t * const pCache )
+{
+    /* Adding zero is an atomic read. */
+    return( Atomic_Add_u32( &pCache->closed, 0 ) != 0UL );
+}
+
+/*-----------------------------------------------------------*/
+
+static uint32_t _cachePop( _taskPoolCache_t * const pCache,
+                           uint32_t * const pHead )
+{
+    uint32_t head;
+    uint32_t index;
+    uint32_t next;
 
-                    userCallback = pJob->userCallback;
-                }
+    for( ; ; )
+    {
+        head = Atomic_Add_u32( pHead, 0 );
+        index = head & TASKPOOL_CACHE_INDEX_MASK;
 
-                pJob->status = IOT_TASKPOOL_STATUS_COMPLETED;
-            }
-            TASKPOOL_EXIT_CRITICAL();
+        if( index == TASKPOOL_CACHE_EMPTY )
+        {
+            break;
         }
-    } while( running == true );
+
+        /* The slot may be popped and pushed back by another thread before the swap below, in which
+         * case 'next' is stale, but the tag of the head changed as well and the swap fails. */
+        next = Atomic_Add_u32( &pCache->entries[ index ].next, 0 );
+
+        if( Atomic_CompareAndSwap_u32( pHead,
+                                       ( ( head + TASKPOOL_CACHE_TAG_INCREMENT ) & ~TASKPOOL_CACHE_INDEX_MASK ) | next,
+                                       head ) == ATOMIC_COMPARE_AND_SWAP_SUCCESS )
+        {
+            break;
+        }
+    }
+
+    return index;
 }
 
-/* ---------------------------------------------------------------------------------------------- */
+/*-----------------------------------------------------------*/
 
-static void _initJobsCache( _taskPoolCache_t * const pCache )
+static void _cachePush( _taskPoolCache_t * const pCache,
+                        uint32_t * const pHead,
+                        uint32_t index )
 {
-    IotDeQueue_Create( &pCache->freeList );
+    uint32_t head;
+    uint32_t next;
 
-    pCache->freeCount = 0;
+    IotTaskPool_Assert( index < IOT_TASKPOOL_JOBS_RECYCLE_LIMIT );
+
+    do
+    {
+        head = Atomic_Add_u32( pHead, 0 );
+
+        /* The caller owns the slot, so nobody else writes 'next' and this swap cannot fail. It is
+         * only atomic because a stale pop may be reading 'next' concurrently. */
+        next = Atomic_Add_u32( &pCache->entries[ index ].next, 0 );
+        ( void ) Atomic_CompareAndSwap_u32( &pCache->entries[ index ].next, head & TASKPOOL_CACHE_INDEX_MASK, next );
+    } while( Atomic_CompareAndSwap_u32( pHead,
+                                        ( ( head + TASKPOOL_CACHE_TAG_INCREMENT ) & ~TASKPOOL_CACHE_INDEX_MASK ) | index,
+                                        head ) != ATOMIC_COMPARE_AND_SWAP_SUCCESS );
 }
 
 /*-----------------------------------------------------------*/
@@ -1304,6 +2304,10 @@ static void _initializeJob( _taskPoolJob_t * const pJob,
     pJob->link.pPrevious = NULL;
     pJob->userCallback = userCallback;
     pJob->pUserContext = pUserContext;
+    pJob->pTimerEvent = NULL;
+    pJob->lane = ( uint32_t ) IOT_TASKPOOL_PRIORITY_NORMAL;
+    pJob->deadline = TASKPOOL_NO_DEADLINE;
+    pJob->scheduleTime = 0;
 
     if( isStatic )
     {
@@ -1319,16 +2323,22 @@ static void _initializeJob( _taskPoolJob_t * const pJob,
 static _taskPoolJob_t * _fetchOrAllocateJob( _taskPoolCache_t * const pCache )
 {
     _taskPoolJob_t * pJob = NULL;
-    IotLink_t * pLink = IotListDouble_RemoveHead( &( pCache->freeList ) );
+    uint32_t index = _cachePop( pCache, &pCache->freeHead );
 
-    if( pLink != NULL )
+    /* Take the job out of the slot, and return the slot to the stack of the empty slots. */
+    if( index != TASKPOOL_CACHE_EMPTY )
     {
-        pJob = IotLink_Container( _taskPoolJob_t, pLink, link );
+        pJob = pCache->entries[ index ].pJob;
+        pCache->entries[ index ].pJob = NULL;
+
+        _cachePush( pCache, &pCache->unusedHead, index );
     }
 
     /* If there is no available job in the cache, then allocate one. */
     if( pJob == NULL )
     {
+        ( void ) Atomic_Increment_u32( &pCache->misses );
+
         pJob = ( _taskPoolJob_t * ) IotTaskPool_MallocJob( sizeof( _taskPoolJob_t ) );
 
         if( pJob != NULL )
@@ -1344,9 +2354,13 @@ static _taskPoolJob_t * _fetchOrAllocateJob( _taskPoolCache_t * const pCache )
     /* If there was a job in the cache, then make sure we keep the counters up-to-date. */
     else
     {
-        IotTaskPool_Assert( pCache->freeCount > 0 );
+        /* The counter is incremented before a job is pushed, so it cannot underflow here. */
+        uint32_t freeCount = Atomic_Decrement_u32( &pCache->freeCount );
+
+        IotTaskPool_Assert( freeCount > 0UL );
+        ( void ) freeCount;
 
-        pCache->freeCount--;
+        ( void ) Atomic_Increment_u32( &pCache->hits );
     }
 
     return pJob;
@@ -1357,11 +2371,15 @@ static _taskPoolJob_t * _fetchOrAllocateJob( _taskPoolCache_t * const pCache )
 static void _recycleJob( _taskPoolCache_t * const pCache,
                          _taskPoolJob_t * const pJob )
 {
+    uint32_t index;
+
     /* We should never try and recycling a job that is linked into some queue. */
     IotTaskPool_Assert( IotLink_IsLinked( &pJob->link ) == false );
 
-    /* We will recycle the job if there is space in the cache. */
-    if( pCache->freeCount < IOT_TASKPOOL_JOBS_RECYCLE_LIMIT )
+    /* We will recycle the job if there is an empty slot in the cache. */
+    index = _cachePop( pCache, &pCache->unusedHead );
+
+    if( index != TASKPOOL_CACHE_EMPTY )
     {
         /* Destroy user data, for added safety & security. */
         pJob->userCallback = NULL;
@@ -1370,11 +2388,11 @@ static void _recycleJob( _taskPoolCache_t * const pCache,
         /* Reset the status for added debugability. */
         pJob->status = IOT_TASKPOOL_STATUS_UNDEFINED;
 
-        IotListDouble_InsertTail( &pCache->freeList, &pJob->link );
+        pCache->entries[ index ].pJob = pJob;
 
-        pCache->freeCount++;
+        ( void ) Atomic_Increment_u32( &pCache->freeCount );
 
-        IotTaskPool_Assert( pCache->freeCount >= 1 );
+        _cachePush( pCache, &pCache->freeHead, index );
     }
     else
     {
@@ -1417,6 +2435,9 @@ static void _signalShutdown( _taskPool_t * const pTaskPool,
     /* Set the exit condition. */
     pTaskPool->maxThreads = 0;
 
+    /* Stop the lock-free paths from using the jobs cache. */
+    ( void ) Atomic_OR_u32( &pTaskPool->jobsCache.closed, 1UL );
+
     /* Broadcast to all active threads to wake-up. Active threads do check the exit condition right after waking up. */
     for( count = 0; count < threads; ++count )
     {
@@ -1438,6 +2459,12 @@ static IotTaskPoolError_t _scheduleInternal( _taskPool_t * const pTaskPool,
     /* Update the job status to 'scheduled'. */
     pJob->status = IOT_TASKPOOL_STATUS_SCHEDULED;
 
+    /* A task pool in work stealing mode has a fixed set of workers, and never grows. */
+    if( pTaskPool->pWorkStealing != NULL )
+    {
+        TASKPOOL_GOTO_CLEANUP();
+    }
+
     /* Update the number of active jobs optimistically, so new requests can be served by creating new threads. */
     pTaskPool->activeJobs++;
 
@@ -1498,21 +2525,20 @@ static IotTaskPoolError_t _scheduleInternal( _taskPool_t * const pTaskPool,
 
     if( TASKPOOL_SUCCEEDED( status ) )
     {
-        /* Append the job to the dispatch queue.
-         * Put the job at the front, if it is a high priority job. */
-        if( mustGrow == true )
+        if( pTaskPool->pWorkStealing != NULL )
         {
-            IotLogDebug( "High priority job: placing job at the head of the queue." );
-
-            IotDeQueue_EnqueueHead( &pTaskPool->dispatchQueue, &pJob->link );
+            /* Push the job to a worker deque. */
+            _workStealingDispatch( pTaskPool, pJob, flags );
         }
         else
         {
-            IotDeQueue_EnqueueTail( &pTaskPool->dispatchQueue, &pJob->link );
-        }
+            /* Place the job in its lane. High priority jobs have the earliest possible deadline,
+             * so they go to the front of the normal lane. */
+            _laneEnqueue( pTaskPool, pJob );
 
-        /* Signal a worker to pick up the job. */
-        IotSemaphore_Post( &pTaskPool->dispatchSignal );
+            /* Signal a worker to pick up the job. */
+            IotSemaphore_Post( &pTaskPool->dispatchSignal );
+        }
     }
     else
     {
@@ -1529,23 +2555,6 @@ static IotTaskPoolError_t _scheduleInternal( _taskPool_t * const pTaskPool,
 
 /*-----------------------------------------------------------*/
 
-static bool _matchJobByPointer( const IotLink_t * const pLink,
-                                void * pMatch )
-{
-    const _taskPoolJob_t * const pJob = ( _taskPoolJob_t * ) pMatch;
-
-    const _taskPoolTimerEvent_t * const pTimerEvent = IotLink_Container( _taskPoolTimerEvent_t, pLink, link );
-
-    if( pJob == pTimerEvent->pJob )
-    {
-        return true;
-    }
-
-    return false;
-}
-
-/*-----------------------------------------------------------*/
-
 static IotTaskPoolError_t _tryCancelInternal( _taskPool_t * const pTaskPool,
                                               _taskPoolJob_t * const pJob,
                                               IotTaskPoolJobStatus_t * const pStatus )
@@ -1590,53 +2599,56 @@ static IotTaskPoolError_t _tryCancelInternal( _taskPool_t * const pTaskPool,
     }
     else
     {
-        /* Update the status of the job. */
-        pJob->status = IOT_TASKPOOL_STATUS_CANCELED;
-
         /* If the job is cancelable and its current status is 'scheduled' then unlink it from the dispatch
          * queue and signal any waiting threads. */
         if( currentStatus == IOT_TASKPOOL_STATUS_SCHEDULED )
         {
-            /* A scheduled work items must be in the dispatch queue. */
-            IotTaskPool_Assert( IotLink_IsLinked( &pJob->link ) );
+            if( IotLink_IsLinked( &pJob->link ) )
+            {
+                _laneRemove( pTaskPool, pJob );
+
+                if( pTaskPool->pWorkStealing != NULL )
+                {
+                    ( void ) Atomic_Decrement_u32( &pTaskPool->pWorkStealing->sharedJobs );
+                }
+            }
+            else
+            {
+                /* A scheduled work item not in the dispatch queue must be in a worker deque. */
+                IotTaskPool_Assert( pTaskPool->pWorkStealing != NULL );
 
-            IotDeQueue_Remove( &pJob->link );
+                /* Workers take jobs from their deques without the task pool lock, so the job
+                 * may have started executing in the meantime. */
+                if( _workStealingRemove( pTaskPool->pWorkStealing, pJob ) == false )
+                {
+                    IotLogWarn( "Attempt to cancel a job that is already executing." );
+
+                    if( pStatus != NULL )
+                    {
+                        *pStatus = IOT_TASKPOOL_STATUS_COMPLETED;
+                    }
+
+                    TASKPOOL_SET_AND_GOTO_CLEANUP( IOT_TASKPOOL_CANCEL_FAILED );
+                }
+            }
         }
 
         /* If the job current status is 'deferred' then the job has to be pending
          * in the timeouts queue. */
         else if( currentStatus == IOT_TASKPOOL_STATUS_DEFERRED )
         {
-            /* Find the timer event associated with the current job. There MUST be one, hence assert if not. */
-            IotLink_t * pTimerEventLink = IotListDouble_FindFirstMatch( &pTaskPool->timerEventsList, NULL, _matchJobByPointer, pJob );
-            IotTaskPool_Assert( pTimerEventLink != NULL );
+            /* The timer event associated with the current job. There MUST be one, hence assert if not. */
+            _taskPoolTimerEvent_t * pTimerEvent = pJob->pTimerEvent;
+            IotTaskPool_Assert( pTimerEvent != NULL );
 
-            if( pTimerEventLink != NULL )
+            if( pTimerEvent != NULL )
             {
-                bool shouldReschedule = false;
-
-                /* If the job being cancelled was at the head of the timeouts queue, then we need to reschedule the timer
-                 * with the next job timeout */
-                IotLink_t * pHeadLink = IotListDouble_PeekHead( &pTaskPool->timerEventsList );
-
-                if( pHeadLink == pTimerEventLink )
-                {
-                    shouldReschedule = true;
-                }
-
                 /* Remove the timer event associated with the canceled job and free the associated memory. */
-                IotListDouble_Remove( pTimerEventLink );
-                IotTaskPool_FreeTimerEvent( IotLink_Container( _taskPoolTimerEvent_t, pTimerEventLink, link ) );
+                _removeTimerEvent( pTaskPool, pTimerEvent );
 
-                if( shouldReschedule )
-                {
-                    IotLink_t * pNextTimerEventLink = IotListDouble_PeekHead( &pTaskPool->timerEventsList );
+                pJob->pTimerEvent = NULL;
 
-                    if( pNextTimerEventLink != NULL )
-                    {
-                        _rescheduleDeferredJobsTimer( &pTaskPool->timer, IotLink_Container( _taskPoolTimerEvent_t, pNextTimerEventLink, link ) );
-                    }
-                }
+                IotTaskPool_FreeTimerEvent( pTimerEvent );
             }
         }
         else
@@ -1644,6 +2656,9 @@ static IotTaskPoolError_t _tryCancelInternal( _taskPool_t * const pTaskPool,
             /* A cancelable job status should be either 'scheduled' or 'deferrred'. */
             IotTaskPool_Assert( ( currentStatus == IOT_TASKPOOL_STATUS_READY ) || ( currentStatus == IOT_TASKPOOL_STATUS_CANCELED ) );
         }
+
+        /* Update the status of the job. */
+        pJob->status = IOT_TASKPOOL_STATUS_CANCELED;
     }
 
     TASKPOOL_NO_FUNCTION_CLEANUP();
@@ -1689,12 +2704,12 @@ static IotTaskPoolError_t _trySafeExtraction( _taskPool_t * const pTaskPool,
                 break;
         }
     }
-    else if( IotLink_IsLinked( &pJob->link ) )
+    /* A job in the cache is owned by the cache until it is handed out again. */
+    else if( ( currentStatus == IOT_TASKPOOL_STATUS_UNDEFINED ) && ( ( pJob->flags & IOT_TASK_POOL_INTERNAL_STATIC ) == 0UL ) )
     {
-        /* If the job is not in the dispatch or timer queue, it must be in the cache. */
-        IotTaskPool_Assert( ( pJob->flags & IOT_TASK_POOL_INTERNAL_STATIC ) == 0 );
+        IotLogWarn( "Attempt to use a job that was recycled already." );
 
-        IotListDouble_Remove( &pJob->link );
+        TASKPOOL_SET_AND_GOTO_CLEANUP( IOT_TASKPOOL_ILLEGAL_OPERATION );
     }
     else
     {
@@ -1732,14 +2747,14 @@ static int32_t _timerEventCompare( const IotLink_t * const pTimerEventLink1,
 /*-----------------------------------------------------------*/
 
 static void _rescheduleDeferredJobsTimer( IotTimer_t * const pTimer,
-                                          _taskPoolTimerEvent_t * const pFirstTimerEvent )
+                                          uint64_t expirationTime )
 {
     uint64_t delta = 0;
     uint64_t now = IotClock_GetTimeMs();
 
-    if( pFirstTimerEvent->expirationTime > now )
+    if( expirationTime > now )
     {
-        delta = pFirstTimerEvent->expirationTime - now;
+        delta = expirationTime - now;
     }
 
     if( delta < TASKPOOL_JOB_RESCHEDULE_DELAY_MS )
@@ -1757,6 +2772,296 @@ static void _rescheduleDeferredJobsTimer( IotTimer_t * const pTimer,
 
 /*-----------------------------------------------------------*/
 
+static void _insertTimerEvent( _taskPool_t * const pTaskPool,
+                               _taskPoolTimerEvent_t * const pTimerEvent,
+                               uint64_t now )
+{
+    _taskPoolTimerWheel_t * const pTimerWheel = pTaskPool->pTimerWheel;
+
+    if( pTimerWheel != NULL )
+    {
+        /* Round the expiration up to the next tick, so that the job never runs early. */
+        uint64_t expirationTick = ( pTimerEvent->expirationTime + IOT_TASKPOOL_TIMER_WHEEL_TICK_MS - 1ULL ) /
+                                  IOT_TASKPOOL_TIMER_WHEEL_TICK_MS;
+
+        /* An empty wheel does not need to catch up with the ticks elapsed since it was last
+         * processed, so move it to the current tick straight away. */
+        if( pTimerWheel->eventCount == 0UL )
+        {
+            pTimerWheel->currentTick = now / IOT_TASKPOOL_TIMER_WHEEL_TICK_MS;
+        }
+
+        _timerWheelInsert( pTimerWheel, pTimerEvent );
+
+        /* Re-arm the timer only if the new event expires before the timer would fire. */
+        if( expirationTick < pTimerWheel->armedTick )
+        {
+            pTimerWheel->armedTick = expirationTick;
+
+            _rescheduleDeferredJobsTimer( &pTaskPool->timer, expirationTick * IOT_TASKPOOL_TIMER_WHEEL_TICK_MS );
+        }
+    }
+    else
+    {
+        IotLink_t * pTimerEventLink;
+
+        /* Append the timer event to the timer list. */
+        IotListDouble_InsertSorted( &pTaskPool->timerEventsList, &pTimerEvent->link, _timerEventCompare );
+
+        /* Peek the first event in the timer event list. There must be at least one,
+         * since we just inserted it. */
+        pTimerEventLink = IotListDouble_PeekHead( &pTaskPool->timerEventsList );
+        IotTaskPool_Assert( pTimerEventLink != NULL );
+
+        /* If the event we inserted is at the front of the queue, then
+         * we need to reschedule the underlying timer. */
+        if( pTimerEventLink == &pTimerEvent->link )
+        {
+            _rescheduleDeferredJobsTimer( &pTaskPool->timer, pTimerEvent->expirationTime );
+        }
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+static void _removeTimerEvent( _taskPool_t * const pTaskPool,
+                               _taskPoolTimerEvent_t * const pTimerEvent )
+{
+    if( pTaskPool->pTimerWheel != NULL )
+    {
+        /* The timer is left armed: if it fires for an empty slot, the timer thread will
+         * simply re-arm it for the next slot with work to do. */
+        IotListDouble_Remove( &pTimerEvent->link );
+
+        IotTaskPool_Assert( pTaskPool->pTimerWheel->eventCount > 0UL );
+
+        pTaskPool->pTimerWheel->eventCount--;
+    }
+    else
+    {
+        bool shouldReschedule = false;
+
+        /* If the job being cancelled was at the head of the timeouts queue, then we need to reschedule the timer
+         * with the next job timeout */
+        if( IotListDouble_PeekHead( &pTaskPool->timerEventsList ) == &pTimerEvent->link )
+        {
+            shouldReschedule = true;
+        }
+
+        IotListDouble_Remove( &pTimerEvent->link );
+
+        if( shouldReschedule )
+        {
+            IotLink_t * pNextTimerEventLink = IotListDouble_PeekHead( &pTaskPool->timerEventsList );
+
+            if( pNextTimerEventLink != NULL )
+            {
+                _rescheduleDeferredJobsTimer( &pTaskPool->timer,
+                                              IotLink_Container( _taskPoolTimerEvent_t, pNextTimerEventLink, link )->expirationTime );
+            }
+        }
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+static void _timerWheelInit( _taskPoolTimerWheel_t * const pTimerWheel,
+                             uint64_t now )
+{
+    uint32_t level, slot;
+
+    for( level = 0; level < IOT_TASKPOOL_TIMER_WHEEL_LEVELS; ++level )
+    {
+        for( slot = 0; slot < TASKPOOL_TIMER_WHEEL_SLOTS; ++slot )
+        {
+            IotListDouble_Create( &pTimerWheel->slots[ level ][ slot ] );
+        }
+    }
+
+    pTimerWheel->currentTick = now / IOT_TASKPOOL_TIMER_WHEEL_TICK_MS;
+    pTimerWheel->armedTick = UINT64_MAX;
+    pTimerWheel->eventCount = 0;
+}
+
+/*-----------------------------------------------------------*/
+
+static void _timerWheelInsert( _taskPoolTimerWheel_t * const pTimerWheel,
+                               _taskPoolTimerEvent_t * const pTimerEvent )
+{
+    uint32_t level = 0;
+    uint64_t slot;
+    uint64_t delta;
+    uint64_t expirationTick = ( pTimerEvent->expirationTime + IOT_TASKPOOL_TIMER_WHEEL_TICK_MS - 1ULL ) /
+                              IOT_TASKPOOL_TIMER_WHEEL_TICK_MS;
+
+    /* Events cascaded for the tick being processed are due now. */
+    if( expirationTick < pTimerWheel->currentTick )
+    {
+        expirationTick = pTimerWheel->currentTick;
+    }
+
+    delta = expirationTick - pTimerWheel->currentTick;
+
+    /* Events beyond the span of the wheel are parked in the farthest slot, and will be
+     * placed again when that slot is cascaded. */
+    if( delta >= TASKPOOL_TIMER_WHEEL_SPAN )
+    {
+        delta = TASKPOOL_TIMER_WHEEL_SPAN - 1ULL;
+        expirationTick = pTimerWheel->currentTick + delta;
+    }
+
+    /* Pick the lowest level whose span covers the delay. */
+    while( delta >= ( 1ULL << ( ( level + 1UL ) * IOT_TASKPOOL_TIMER_WHEEL_SLOT_BITS ) ) )
+    {
+        ++level;
+    }
+
+    slot = ( expirationTick >> ( level * IOT_TASKPOOL_TIMER_WHEEL_SLOT_BITS ) ) & TASKPOOL_TIMER_WHEEL_SLOT_MASK;
+
+    IotListDouble_InsertTail( &pTimerWheel->slots[ level ][ slot ], &pTimerEvent->link );
+
+    pTimerWheel->eventCount++;
+}
+
+/*-----------------------------------------------------------*/
+
+static uint64_t _timerWheelNextTick( const _taskPoolTimerWheel_t * const pTimerWheel )
+{
+    uint64_t nextTick = UINT64_MAX;
+    uint32_t level;
+
+    if( pTimerWheel->eventCount > 0UL )
+    {
+        for( level = 0; level < IOT_TASKPOOL_TIMER_WHEEL_LEVELS; ++level )
+        {
+            uint32_t shift = level * IOT_TASKPOOL_TIMER_WHEEL_SLOT_BITS;
+            uint64_t base = pTimerWheel->currentTick >> shift;
+            uint64_t offset;
+
+            /* Slots of higher levels can only be reached later than the nearest slot found so far. */
+            if( ( ( base + 1ULL ) << shift ) >= nextTick )
+            {
+                break;
+            }
+
+            /* A slot of level 0 is processed at its tick, while a slot of a higher level is cascaded
+             * at the first tick of the span it covers. Walk one full rotation of this level. */
+            for( offset = 1; offset <= TASKPOOL_TIMER_WHEEL_SLOTS; ++offset )
+            {
+                if( IotListDouble_IsEmpty( &pTimerWheel->slots[ level ][ ( base + offset ) & TASKPOOL_TIMER_WHEEL_SLOT_MASK ] ) == false )
+                {
+                    if( ( ( base + offset ) << shift ) < nextTick )
+                    {
+                        nextTick = ( base + offset ) << shift;
+                    }
+
+                    break;
+                }
+            }
+        }
+    }
+
+    return nextTick;
+}
+
+/*-----------------------------------------------------------*/
+
+static void _timerWheelAdvance( _taskPool_t * const pTaskPool,
+                                uint64_t nowTick )
+{
+    _taskPoolTimerWheel_t * const pTimerWheel = pTaskPool->pTimerWheel;
+
+    while( pTimerWheel->currentTick < nowTick )
+    {
+        IotLink_t * pLink;
+        uint32_t level;
+        uint64_t nextTick = _timerWheelNextTick( pTimerWheel );
+
+        /* Skip the ticks for which there is nothing to cascade or expire. */
+        if( nextTick > nowTick )
+        {
+            pTimerWheel->currentTick = nowTick;
+
+            break;
+        }
+
+        pTimerWheel->currentTick = nextTick;
+
+        /* When a level wraps around, cascade the next slot of the level above into the lower levels. */
+        for( level = 1; level < IOT_TASKPOOL_TIMER_WHEEL_LEVELS; ++level )
+        {
+            uint32_t shift = level * IOT_TASKPOOL_TIMER_WHEEL_SLOT_BITS;
+            IotListDouble_t * pSlot;
+            size_t count;
+
+            if( ( pTimerWheel->currentTick & ( ( 1ULL << shift ) - 1ULL ) ) != 0ULL )
+            {
+                break;
+            }
+
+            pSlot = &pTimerWheel->slots[ level ][ ( pTimerWheel->currentTick >> shift ) & TASKPOOL_TIMER_WHEEL_SLOT_MASK ];
+
+            /* Re-place the events of the slot in the lower levels, or park them again if they are still out of reach. */
+            for( count = IotListDouble_Count( pSlot ); count > 0U; --count )
+            {
+                pLink = IotListDouble_RemoveHead( pSlot );
+
+                pTimerWheel->eventCount--;
+
+                _timerWheelInsert( pTimerWheel, IotLink_Container( _taskPoolTimerEvent_t, pLink, link ) );
+            }
+        }
+
+        /* Dispatch all the jobs expiring at the current tick. */
+        for( ; ; )
+        {
+            _taskPoolTimerEvent_t * pTimerEvent;
+
+            pLink = IotListDouble_RemoveHead( &pTimerWheel->slots[ 0 ][ pTimerWheel->currentTick & TASKPOOL_TIMER_WHEEL_SLOT_MASK ] );
+
+            if( pLink == NULL )
+            {
+                break;
+            }
+
+            pTimerWheel->eventCount--;
+
+            pTimerEvent = IotLink_Container( _taskPoolTimerEvent_t, pLink, link );
+
+            IotLogDebug( "Scheduling job from timing wheel." );
+
+            /* The job is no longer deferred. */
+            pTimerEvent->pJob->pTimerEvent = NULL;
+
+            /* Queue the job associated with the expired timer event. */
+            ( void ) _scheduleInternal( pTaskPool, pTimerEvent->pJob, 0 );
+
+            /* Free the timer event. */
+            IotTaskPool_FreeTimerEvent( pTimerEvent );
+        }
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+static void _timerWheelRearm( _taskPool_t * const pTaskPool )
+{
+    _taskPoolTimerWheel_t * const pTimerWheel = pTaskPool->pTimerWheel;
+
+    pTimerWheel->armedTick = _timerWheelNextTick( pTimerWheel );
+
+    if( pTimerWheel->armedTick != UINT64_MAX )
+    {
+        _rescheduleDeferredJobsTimer( &pTaskPool->timer, pTimerWheel->armedTick * IOT_TASKPOOL_TIMER_WHEEL_TICK_MS );
+    }
+    else
+    {
+        IotLogDebug( "No further timer events to process. Exiting timer thread." );
+    }
+}
+
+/*-----------------------------------------------------------*/
+
 static void _timerThread( void * pArgument )
 {
     _taskPool_t * pTaskPool = ( _taskPool_t * ) pArgument;
@@ -1783,52 +3088,66 @@ static void _timerThread( void * pArgument )
             return;
         }
 
-        /* Dispatch all deferred job whose timer expired, then reset the timer for the next
-         * job down the line. */
-        for( ; ; )
+        /* With a timing wheel, dispatch all the jobs of the elapsed ticks in one pass, then
+         * re-arm the timer for the next slot that needs processing. */
+        if( pTaskPool->pTimerWheel != NULL )
         {
-            /* Peek the first event in the timer event list. */
-            IotLink_t * pLink = IotListDouble_PeekHead( &pTaskPool->timerEventsList );
+            _timerWheelAdvance( pTaskPool, IotClock_GetTimeMs() / IOT_TASKPOOL_TIMER_WHEEL_TICK_MS );
 
-            /* Check if the timer misfired for any reason.  */
-            if( pLink != NULL )
+            _timerWheelRearm( pTaskPool );
+        }
+        else
+        {
+            /* Dispatch all deferred job whose timer expired, then reset the timer for the next
+             * job down the line. */
+            for( ; ; )
             {
-                /* Record the current time. */
-                uint64_t now = IotClock_GetTimeMs();
-
-                /* Extract the job from its envelope. */
-                pTimerEvent = IotLink_Container( _taskPoolTimerEvent_t, pLink, link );
+                /* Peek the first event in the timer event list. */
+                IotLink_t * pLink = IotListDouble_PeekHead( &pTaskPool->timerEventsList );
 
-                /* Check if the first event should be processed now. */
-                if( pTimerEvent->expirationTime <= now )
+                /* Check if the timer misfired for any reason.  */
+                if( pLink != NULL )
                 {
-                    /*  Remove the timer event for immediate processing. */
-                    IotListDouble_Remove( &( pTimerEvent->link ) );
+                    /* Record the current time. */
+                    uint64_t now = IotClock_GetTimeMs();
+
+                    /* Extract the job from its envelope. */
+                    pTimerEvent = IotLink_Container( _taskPoolTimerEvent_t, pLink, link );
+
+                    /* Check if the first event should be processed now. */
+                    if( pTimerEvent->expirationTime <= now )
+                    {
+                        /*  Remove the timer event for immediate processing. */
+                        IotListDouble_Remove( &( pTimerEvent->link ) );
+                    }
+                    else
+                    {
+                        /* The first element in the timer queue shouldn't be processed yet.
+                         * Arm the timer for when it should be processed and leave altogether. */
+                        _rescheduleDeferredJobsTimer( &pTaskPool->timer, pTimerEvent->expirationTime );
+
+                        break;
+                    }
                 }
+                /* If there are no timer events to process, terminate this thread. */
                 else
                 {
-                    /* The first element in the timer queue shouldn't be processed yet.
-                     * Arm the timer for when it should be processed and leave altogether. */
-                    _rescheduleDeferredJobsTimer( &pTaskPool->timer, pTimerEvent );
+                    IotLogDebug( "No further timer events to process. Exiting timer thread." );
 
                     break;
                 }
-            }
-            /* If there are no timer events to process, terminate this thread. */
-            else
-            {
-                IotLogDebug( "No further timer events to process. Exiting timer thread." );
 
-                break;
-            }
+                IotLogDebug( "Scheduling job from timer event." );
 
-            IotLogDebug( "Scheduling job from timer event." );
+                /* The job is no longer deferred. */
+                pTimerEvent->pJob->pTimerEvent = NULL;
 
-            /* Queue the job associated with the received timer event. */
-            ( void ) _scheduleInternal( pTaskPool, pTimerEvent->pJob, 0 );
+                /* Queue the job associated with the received timer event. */
+                ( void ) _scheduleInternal( pTaskPool, pTimerEvent->pJob, 0 );
 
-            /* Free the timer event. */
-            IotTaskPool_FreeTimerEvent( pTimerEvent );
+                /* Free the timer event. */
+                IotTaskPool_FreeTimerEvent( pTimerEvent );
+            }
         }
     }
     TASKPOOL_EXIT_CRITICAL();
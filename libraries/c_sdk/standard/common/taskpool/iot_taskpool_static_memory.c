@@ -58,7 +58,7 @@
  * Static memory buffers and flags, allocated and zeroed at compile-time.
  */
     static bool _pInUseTaskPools[ IOT_TASKPOOLS ] = { 0 };                                                          /**< @brief Task pools in-use flags. */
-    static _taskPool_t _pTaskPools[ IOT_TASKPOOLS ] = { { .dispatchQueue = IOT_DEQUEUE_INITIALIZER } };             /**< @brief Task pools. */
+    static _taskPool_t _pTaskPools[ IOT_TASKPOOLS ] = { { .lanes = { { .queue = IOT_DEQUEUE_INITIALIZER } } } };    /**< @brief Task pools. */
 
     static bool _pInUseTaskPoolJobs[ IOT_TASKPOOL_JOBS_RECYCLE_LIMIT ] = { 0 };                                     /**< @brief Task pool jobs in-use flags. */
     static _taskPoolJob_t _pTaskPoolJobs[ IOT_TASKPOOL_JOBS_RECYCLE_LIMIT ] = { { .link = IOT_LINK_INITIALIZER } }; /**< @brief Task pool jobs. */
@@ -66,6 +66,16 @@
     static bool _pInUseTaskPoolTimerEvents[ IOT_TASKPOOL_JOBS_RECYCLE_LIMIT ] = { 0 };                              /**< @brief Task pool timer event in-use flags. */
     static _taskPoolTimerEvent_t _pTaskPoolTimerEvents[ IOT_TASKPOOL_JOBS_RECYCLE_LIMIT ] = { { .link = { 0 } } };  /**< @brief Task pool timer events. */
 
+    #if IOT_TASKPOOL_TIMER_WHEELS > 0
+        static bool _pInUseTaskPoolTimerWheels[ IOT_TASKPOOL_TIMER_WHEELS ] = { 0 };                                /**< @brief Task pool timing wheel in-use flags. */
+        static _taskPoolTimerWheel_t _pTaskPoolTimerWheels[ IOT_TASKPOOL_TIMER_WHEELS ] = { { .currentTick = 0 } }; /**< @brief Task pool timing wheels. */
+    #endif
+
+    #if IOT_TASKPOOL_WORK_QUEUES > 0
+        static bool _pInUseTaskPoolWorkQueues[ IOT_TASKPOOL_WORK_QUEUES ] = { 0 };                                  /**< @brief Task pool worker deques in-use flags. */
+        static _taskPoolWorkStealing_t _pTaskPoolWorkQueues[ IOT_TASKPOOL_WORK_QUEUES ] = { { .nextQueue = 0 } };   /**< @brief Task pool worker deques. */
+    #endif
+
 /*-----------------------------------------------------------*/
 
     void * IotTaskPool_MallocTaskPool( size_t size )
@@ -170,6 +180,98 @@
                                      sizeof( _taskPoolTimerEvent_t ) );
     }
 
+/*-----------------------------------------------------------*/
+
+    void * IotTaskPool_MallocTimerWheel( size_t size )
+    {
+        void * pNewTimerWheel = NULL;
+
+        #if IOT_TASKPOOL_TIMER_WHEELS > 0
+            int32_t freeIndex = -1;
+
+            /* Check size argument. */
+            if( size == sizeof( _taskPoolTimerWheel_t ) )
+            {
+                /* Find a free task pool timing wheel. */
+                freeIndex = IotStaticMemory_FindFree( _pInUseTaskPoolTimerWheels,
+                                                      IOT_TASKPOOL_TIMER_WHEELS );
+
+                if( freeIndex != -1 )
+                {
+                    pNewTimerWheel = &( _pTaskPoolTimerWheels[ freeIndex ] );
+                }
+            }
+        #else
+            /* No timing wheel is reserved. */
+            ( void ) size;
+        #endif
+
+        return pNewTimerWheel;
+    }
+
+/*-----------------------------------------------------------*/
+
+    void IotTaskPool_FreeTimerWheel( void * ptr )
+    {
+        #if IOT_TASKPOOL_TIMER_WHEELS > 0
+            /* Return the in-use task pool timing wheel. */
+            IotStaticMemory_ReturnInUse( ptr,
+                                         _pTaskPoolTimerWheels,
+                                         _pInUseTaskPoolTimerWheels,
+                                         IOT_TASKPOOL_TIMER_WHEELS,
+                                         sizeof( _taskPoolTimerWheel_t ) );
+        #else
+            /* No timing wheel is ever allocated, so there is nothing to return. */
+            ( void ) ptr;
+        #endif
+    }
+
+/*-----------------------------------------------------------*/
+
+    void * IotTaskPool_MallocWorkQueues( size_t size )
+    {
+        void * pNewWorkQueues = NULL;
+
+        #if IOT_TASKPOOL_WORK_QUEUES > 0
+            int32_t freeIndex = -1;
+
+            /* Check size argument. */
+            if( size == sizeof( _taskPoolWorkStealing_t ) )
+            {
+                /* Find a free set of task pool worker deques. */
+                freeIndex = IotStaticMemory_FindFree( _pInUseTaskPoolWorkQueues,
+                                                      IOT_TASKPOOL_WORK_QUEUES );
+
+                if( freeIndex != -1 )
+                {
+                    pNewWorkQueues = &( _pTaskPoolWorkQueues[ freeIndex ] );
+                }
+            }
+        #else
+            /* No set of worker deques is reserved. */
+            ( void ) size;
+        #endif
+
+        return pNewWorkQueues;
+    }
+
+/*-----------------------------------------------------------*/
+
+    void IotTaskPool_FreeWorkQueues( void * ptr )
+    {
+        #if IOT_TASKPOOL_WORK_QUEUES > 0
+            /* Return the in-use set of task pool worker deques. */
+            IotStaticMemory_ReturnInUse( ptr,
+                                         _pTaskPoolWorkQueues,
+                                         _pInUseTaskPoolWorkQueues,
+                                         IOT_TASKPOOL_WORK_QUEUES,
+                                         sizeof( _taskPoolWorkStealing_t ) );
+        #else
+            /* No set of worker deques is ever allocated, so there is nothing to return. */
+            ( void ) ptr;
+        #endif
+    }
+
 /*-----------------------------------------------------------*/
 
 #endif /* if IOT_STATIC_MEMORY_ONLY == 1 */
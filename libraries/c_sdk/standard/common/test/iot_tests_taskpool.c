@@ -73,6 +73,23 @@ typedef struct JobBlockingUserContext
     IotSemaphore_t block;  /**< @brief A synch object to wait on. */
 } JobBlockingUserContext_t;
 
+/**
+ * @brief Number of jobs in the priority lanes test: the urgent jobs outnumber the starvation limit.
+ */
+#define TEST_TASKPOOL_URGENT_JOBS    ( IOT_TASKPOOL_LANE_STARVATION_LIMIT + 3 )
+#define TEST_TASKPOOL_LANE_JOBS      ( TEST_TASKPOOL_URGENT_JOBS + 3 )
+
+/**
+ * @brief A user context to record the order in which jobs are executed.
+ */
+typedef struct JobOrderUserContext
+{
+    IotMutex_t lock;                           /**< @brief Protection from concurrent updates. */
+    IotTaskPoolJobStorage_t * pJobsStorage;    /**< @brief The storage of the jobs, to identify them. */
+    uint32_t counter;                          /**< @brief A counter to keep track of callback invocations. */
+    uint32_t order[ TEST_TASKPOOL_LANE_JOBS ]; /**< @brief The index of the jobs, in execution order. */
+} JobOrderUserContext_t;
+
 /*-----------------------------------------------------------*/
 
 /**
@@ -112,6 +129,7 @@ TEST_GROUP_RUNNER( Common_Unit_Task_Pool )
     RUN_TEST_CASE( Common_Unit_Task_Pool, CreateDestroyJobError );
     RUN_TEST_CASE( Common_Unit_Task_Pool, CreateDestroyRecycleRecyclableJobError );
     RUN_TEST_CASE( Common_Unit_Task_Pool, CreateRecyclableJob );
+    RUN_TEST_CASE( Common_Unit_Task_Pool, CreateRecyclableJobCacheStatus );
     RUN_TEST_CASE( Common_Unit_Task_Pool, ScheduleTasksError );
     RUN_TEST_CASE( Common_Unit_Task_Pool, ScheduleTasks_LongRunningAndCachedJobsAndDestroy );
     RUN_TEST_CASE( Common_Unit_Task_Pool, ScheduleTasks_Grow );
@@ -124,6 +142,9 @@ TEST_GROUP_RUNNER( Common_Unit_Task_Pool )
     RUN_TEST_CASE( Common_Unit_Task_Pool, ScheduleTasks_ReSchedule );
     RUN_TEST_CASE( Common_Unit_Task_Pool, ScheduleTasks_ReScheduleDeferred );
     RUN_TEST_CASE( Common_Unit_Task_Pool, ScheduleTasks_CancelTasks );
+    RUN_TEST_CASE( Common_Unit_Task_Pool, ScheduleTasks_TimerWheelScheduleDeferredThenWait );
+    RUN_TEST_CASE( Common_Unit_Task_Pool, ScheduleTasks_WorkStealingScheduleAllThenWait );
+    RUN_TEST_CASE( Common_Unit_Task_Pool, ScheduleTasks_PriorityLanes );
 }
 
 /*-----------------------------------------------------------*/
@@ -203,6 +224,13 @@ TEST_GROUP_RUNNER( Common_Unit_Task_Pool )
  */
 #define ONE_HOUR_FROM_NOW_MS    ( 3600 * 1000 )
 
+/**
+ * @brief Define the largest number of outstanding deferred jobs for the timer benchmark.
+ */
+#ifndef TEST_TASKPOOL_TIMER_BENCHMARK_MAX_JOBS
+    #define TEST_TASKPOOL_TIMER_BENCHMARK_MAX_JOBS    ( 10000 )
+#endif
+
 /* ---------------------------------------------------------- */
 
 /**
@@ -349,6 +377,23 @@ static void BlankExecution( IotTaskPool_t pTaskPool,
     TEST_ASSERT( ( error == IOT_TASKPOOL_SUCCESS ) || ( error == IOT_TASKPOOL_SHUTDOWN_IN_PROGRESS ) );
 }
 
+/**
+ * @brief A callback that records the order of execution of its job.
+ */
+static void ExecutionRecordOrderCb( IotTaskPool_t pTaskPool,
+                                    IotTaskPoolJob_t pJob,
+                                    void * pContext )
+{
+    JobOrderUserContext_t * pUserContext = ( JobOrderUserContext_t * ) pContext;
+
+    ( void ) pTaskPool;
+
+    IotMutex_Lock( &pUserContext->lock );
+    pUserContext->order[ pUserContext->counter ] = ( uint32_t ) ( IotTaskPool_GetJobStorageFromHandle( pJob ) - pUserContext->pJobsStorage );
+    pUserContext->counter++;
+    IotMutex_Unlock( &pUserContext->lock );
+}
+
 /* ---------------------------------------------------------------------------------------------- */
 /* ---------------------------------------------------------------------------------------------- */
 /* ---------------------------------------------------------------------------------------------- */
@@ -671,6 +716,73 @@ TEST( Common_Unit_Task_Pool, CreateRecyclableJob )
 
 /*-----------------------------------------------------------*/
 
+/**
+ * @brief Test that the jobs cache serves recycled jobs and keeps its statistics up-to-date.
+ */
+TEST( Common_Unit_Task_Pool, CreateRecyclableJobCacheStatus )
+{
+    IotTaskPool_t taskPool = IOT_TASKPOOL_INITIALIZER;
+    const IotTaskPoolInfo_t tpInfo = { .minThreads = 2, .maxThreads = 3, .stackSize = IOT_THREAD_DEFAULT_STACK_SIZE, .priority = IOT_THREAD_DEFAULT_PRIORITY };
+    IotTaskPoolCacheStatus_t cacheStatus;
+
+    TEST_ASSERT( IotTaskPool_Create( &tpInfo, &taskPool ) == IOT_TASKPOOL_SUCCESS );
+
+    if( TEST_PROTECT() )
+    {
+        uint32_t count;
+        IotTaskPoolJob_t pJobs[ IOT_TASKPOOL_JOBS_RECYCLE_LIMIT ];
+
+        /* Trivial parameter validation. */
+        TEST_ASSERT( IotTaskPool_GetCacheStatus( NULL, &cacheStatus ) == IOT_TASKPOOL_BAD_PARAMETER );
+        TEST_ASSERT( IotTaskPool_GetCacheStatus( taskPool, NULL ) == IOT_TASKPOOL_BAD_PARAMETER );
+
+        /* A new task pool has an empty cache. */
+        TEST_ASSERT( IotTaskPool_GetCacheStatus( taskPool, &cacheStatus ) == IOT_TASKPOOL_SUCCESS );
+        TEST_ASSERT_EQUAL_UINT32( 0, cacheStatus.hits );
+        TEST_ASSERT_EQUAL_UINT32( 0, cacheStatus.misses );
+        TEST_ASSERT_EQUAL_UINT32( 0, cacheStatus.freeCount );
+
+        /* All jobs are allocated the first time around. */
+        for( count = 0; count < IOT_TASKPOOL_JOBS_RECYCLE_LIMIT; ++count )
+        {
+            TEST_ASSERT( IotTaskPool_CreateRecyclableJob( taskPool, &BlankExecution, NULL, &pJobs[ count ] ) == IOT_TASKPOOL_SUCCESS );
+        }
+
+        for( count = 0; count < IOT_TASKPOOL_JOBS_RECYCLE_LIMIT; ++count )
+        {
+            TEST_ASSERT( IotTaskPool_RecycleJob( taskPool, pJobs[ count ] ) == IOT_TASKPOOL_SUCCESS );
+        }
+
+        /* A job in the cache cannot be recycled again. */
+        TEST_ASSERT( IotTaskPool_RecycleJob( taskPool, pJobs[ 0 ] ) == IOT_TASKPOOL_ILLEGAL_OPERATION );
+
+        TEST_ASSERT( IotTaskPool_GetCacheStatus( taskPool, &cacheStatus ) == IOT_TASKPOOL_SUCCESS );
+        TEST_ASSERT_EQUAL_UINT32( 0, cacheStatus.hits );
+        TEST_ASSERT_EQUAL_UINT32( IOT_TASKPOOL_JOBS_RECYCLE_LIMIT, cacheStatus.misses );
+        TEST_ASSERT_EQUAL_UINT32( IOT_TASKPOOL_JOBS_RECYCLE_LIMIT, cacheStatus.freeCount );
+
+        /* All jobs come from the cache the second time around. */
+        for( count = 0; count < IOT_TASKPOOL_JOBS_RECYCLE_LIMIT; ++count )
+        {
+            TEST_ASSERT( IotTaskPool_CreateRecyclableJob( taskPool, &BlankExecution, NULL, &pJobs[ count ] ) == IOT_TASKPOOL_SUCCESS );
+        }
+
+        TEST_ASSERT( IotTaskPool_GetCacheStatus( taskPool, &cacheStatus ) == IOT_TASKPOOL_SUCCESS );
+        TEST_ASSERT_EQUAL_UINT32( IOT_TASKPOOL_JOBS_RECYCLE_LIMIT, cacheStatus.hits );
+        TEST_ASSERT_EQUAL_UINT32( IOT_TASKPOOL_JOBS_RECYCLE_LIMIT, cacheStatus.misses );
+        TEST_ASSERT_EQUAL_UINT32( 0, cacheStatus.freeCount );
+
+        for( count = 0; count < IOT_TASKPOOL_JOBS_RECYCLE_LIMIT; ++count )
+        {
+            TEST_ASSERT( IotTaskPool_RecycleJob( taskPool, pJobs[ count ] ) == IOT_TASKPOOL_SUCCESS );
+        }
+    }
+
+    TEST_ASSERT( IotTaskPool_Destroy( taskPool ) == IOT_TASKPOOL_SUCCESS );
+}
+
+/*-----------------------------------------------------------*/
+
 /**
  * @brief Test scheduling a job with bad parameters.
  */
@@ -1853,3 +1965,443 @@ TEST( Common_Unit_Task_Pool, ScheduleTasks_CancelTasks )
 }
 
 /*-----------------------------------------------------------*/
+
+/**
+ * @brief Test scheduling and canceling deferred jobs in a task pool that uses a timing wheel,
+ * with delays that span several levels of the wheel.
+ */
+TEST( Common_Unit_Task_Pool, ScheduleTasks_TimerWheelScheduleDeferredThenWait )
+{
+    uint32_t count, maxJobs;
+    IotTaskPool_t taskPool = IOT_TASKPOOL_INITIALIZER;
+    const IotTaskPoolInfo_t tpInfo = { .minThreads = 2, .maxThreads = 3, .stackSize = IOT_THREAD_DEFAULT_STACK_SIZE, .priority = IOT_THREAD_DEFAULT_PRIORITY, .flags = IOT_TASKPOOL_TIMER_WHEEL };
+    uint32_t canceled = 0;
+    uint32_t scheduled = 0;
+
+    JobUserContext_t userContext;
+
+    memset( &userContext, 0, sizeof( JobUserContext_t ) );
+
+    /* In static memory mode, only the recyclable job limit may be allocated. */
+    #if IOT_STATIC_MEMORY_ONLY == 1
+        maxJobs = IOT_TASKPOOL_JOBS_RECYCLE_LIMIT;
+        IotTaskPoolJobStorage_t jobsStorage[ IOT_TASKPOOL_JOBS_RECYCLE_LIMIT ];
+        IotTaskPoolJob_t jobs[ IOT_TASKPOOL_JOBS_RECYCLE_LIMIT ];
+    #else
+        maxJobs = TEST_TASKPOOL_ITERATIONS;
+        IotTaskPoolJobStorage_t jobsStorage[ TEST_TASKPOOL_ITERATIONS ];
+        IotTaskPoolJob_t jobs[ TEST_TASKPOOL_ITERATIONS ];
+    #endif
+
+    /* Initialize user context. */
+    TEST_ASSERT( IotMutex_Create( &userContext.lock, false ) );
+
+    TEST_ASSERT( IotTaskPool_Create( &tpInfo, &taskPool ) == IOT_TASKPOOL_SUCCESS );
+
+    if( TEST_PROTECT() )
+    {
+        /* Create and schedule loop. Delays up to 2 seconds go past the first level of the wheel. */
+        for( count = 0; count < maxJobs; ++count )
+        {
+            TEST_ASSERT( IotTaskPool_CreateJob( &ExecutionWithoutDestroyCb, &userContext, &jobsStorage[ count ], &jobs[ count ] ) == IOT_TASKPOOL_SUCCESS );
+
+            TEST_ASSERT( IotTaskPool_ScheduleDeferred( taskPool, jobs[ count ], 10 + ( rand() % 2000 ) ) == IOT_TASKPOOL_SUCCESS );
+
+            ++scheduled;
+        }
+
+        /* Cancel every other job. */
+        for( count = 0; count < maxJobs; count += 2 )
+        {
+            IotTaskPoolJobStatus_t statusAtCancellation = IOT_TASKPOOL_STATUS_READY;
+
+            if( IotTaskPool_TryCancel( taskPool, jobs[ count ], &statusAtCancellation ) == IOT_TASKPOOL_SUCCESS )
+            {
+                TEST_ASSERT( ( statusAtCancellation == IOT_TASKPOOL_STATUS_DEFERRED ) ||
+                             ( statusAtCancellation == IOT_TASKPOOL_STATUS_SCHEDULED ) );
+
+                canceled++;
+            }
+            else
+            {
+                TEST_ASSERT( statusAtCancellation == IOT_TASKPOOL_STATUS_COMPLETED );
+            }
+        }
+
+        /* Wait until callback is executed. */
+        while( true )
+        {
+            IotClock_SleepMs( 50 );
+
+            IotMutex_Lock( &userContext.lock );
+
+            if( userContext.counter == ( scheduled - canceled ) )
+            {
+                IotMutex_Unlock( &userContext.lock );
+
+                break;
+            }
+
+            IotMutex_Unlock( &userContext.lock );
+        }
+
+        TEST_ASSERT( ( scheduled - canceled ) == userContext.counter );
+    }
+
+    TEST_ASSERT( IotTaskPool_Destroy( taskPool ) == IOT_TASKPOOL_SUCCESS );
+
+    /* Destroy user context. */
+    IotMutex_Destroy( &userContext.lock );
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test scheduling and canceling jobs in a task pool in work stealing mode.
+ */
+TEST( Common_Unit_Task_Pool, ScheduleTasks_WorkStealingScheduleAllThenWait )
+{
+    uint32_t count, maxJobs;
+    IotTaskPool_t taskPool = IOT_TASKPOOL_INITIALIZER;
+    const IotTaskPoolInfo_t tpInfo = { .minThreads = 2, .maxThreads = 4, .stackSize = IOT_THREAD_DEFAULT_STACK_SIZE, .priority = IOT_THREAD_DEFAULT_PRIORITY, .flags = IOT_TASKPOOL_WORK_STEALING };
+    const IotTaskPoolInfo_t tpInfoIllegalWorkers = { .minThreads = 1, .maxThreads = IOT_TASKPOOL_WORK_STEALING_MAX_WORKERS + 1, .stackSize = IOT_THREAD_DEFAULT_STACK_SIZE, .priority = IOT_THREAD_DEFAULT_PRIORITY, .flags = IOT_TASKPOOL_WORK_STEALING };
+    uint32_t canceled = 0;
+    uint32_t scheduled = 0;
+
+    JobUserContext_t userContext;
+
+    memset( &userContext, 0, sizeof( JobUserContext_t ) );
+
+    /* In static memory mode, only the recyclable job limit may be allocated. */
+    #if IOT_STATIC_MEMORY_ONLY == 1
+        maxJobs = IOT_TASKPOOL_JOBS_RECYCLE_LIMIT;
+        IotTaskPoolJobStorage_t jobsStorage[ IOT_TASKPOOL_JOBS_RECYCLE_LIMIT ];
+        IotTaskPoolJob_t jobs[ IOT_TASKPOOL_JOBS_RECYCLE_LIMIT ];
+    #else
+        maxJobs = TEST_TASKPOOL_ITERATIONS;
+        IotTaskPoolJobStorage_t jobsStorage[ TEST_TASKPOOL_ITERATIONS ];
+        IotTaskPoolJob_t jobs[ TEST_TASKPOOL_ITERATIONS ];
+    #endif
+
+    /* A work stealing task pool cannot have more workers than deques. */
+    TEST_ASSERT( IotTaskPool_Create( &tpInfoIllegalWorkers, &taskPool ) == IOT_TASKPOOL_BAD_PARAMETER );
+
+    /* Initialize user context. */
+    TEST_ASSERT( IotMutex_Create( &userContext.lock, false ) );
+
+    TEST_ASSERT( IotTaskPool_Create( &tpInfo, &taskPool ) == IOT_TASKPOOL_SUCCESS );
+
+    if( TEST_PROTECT() )
+    {
+        /* A work stealing task pool has a fixed number of workers. */
+        TEST_ASSERT( IotTaskPool_SetMaxThreads( taskPool, 2 ) == IOT_TASKPOOL_ILLEGAL_OPERATION );
+
+        /* Create and schedule loop. Since more jobs than the deques can hold are scheduled,
+         * some of them go through the shared dispatch queue. */
+        for( count = 0; count < maxJobs; ++count )
+        {
+            TEST_ASSERT( IotTaskPool_CreateJob( &ExecutionWithoutDestroyCb, &userContext, &jobsStorage[ count ], &jobs[ count ] ) == IOT_TASKPOOL_SUCCESS );
+
+            TEST_ASSERT( IotTaskPool_Schedule( taskPool, jobs[ count ], ( count % 16 == 0 ) ? IOT_TASKPOOL_JOB_HIGH_PRIORITY : 0 ) == IOT_TASKPOOL_SUCCESS );
+
+            ++scheduled;
+        }
+
+        /* Cancel every other job. */
+        for( count = 0; count < maxJobs; count += 2 )
+        {
+            IotTaskPoolJobStatus_t statusAtCancellation = IOT_TASKPOOL_STATUS_READY;
+
+            if( IotTaskPool_TryCancel( taskPool, jobs[ count ], &statusAtCancellation ) == IOT_TASKPOOL_SUCCESS )
+            {
+                TEST_ASSERT( statusAtCancellation == IOT_TASKPOOL_STATUS_SCHEDULED );
+
+                canceled++;
+            }
+            else
+            {
+                TEST_ASSERT( statusAtCancellation == IOT_TASKPOOL_STATUS_COMPLETED );
+            }
+        }
+
+        /* Wait until callback is executed. */
+        while( true )
+        {
+            IotClock_SleepMs( 50 );
+
+            IotMutex_Lock( &userContext.lock );
+
+            if( userContext.counter == ( scheduled - canceled ) )
+            {
+                IotMutex_Unlock( &userContext.lock );
+
+                break;
+            }
+
+            IotMutex_Unlock( &userContext.lock );
+        }
+
+        TEST_ASSERT( ( scheduled - canceled ) == userContext.counter );
+    }
+
+    TEST_ASSERT( IotTaskPool_Destroy( taskPool ) == IOT_TASKPOOL_SUCCESS );
+
+    /* Destroy user context. */
+    IotMutex_Destroy( &userContext.lock );
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test that workers take jobs in lane and deadline order, and that less urgent lanes are not starved.
+ */
+TEST( Common_Unit_Task_Pool, ScheduleTasks_PriorityLanes )
+{
+    uint32_t count;
+    IotTaskPool_t taskPool = IOT_TASKPOOL_INITIALIZER;
+    const IotTaskPoolInfo_t tpInfo = { .minThreads = 1, .maxThreads = 1, .stackSize = IOT_THREAD_DEFAULT_STACK_SIZE, .priority = IOT_THREAD_DEFAULT_PRIORITY };
+    IotTaskPoolJobStorage_t blockingJobStorage;
+    IotTaskPoolJob_t blockingJob;
+    IotTaskPoolJobStorage_t jobsStorage[ TEST_TASKPOOL_LANE_JOBS ];
+    IotTaskPoolJob_t jobs[ TEST_TASKPOOL_LANE_JOBS ];
+    IotTaskPoolLaneStatus_t laneStatus;
+    JobBlockingUserContext_t blockingUserContext;
+    JobOrderUserContext_t userContext;
+
+    /* Job indexes: the urgent jobs come first, and the last of them has a deadline. */
+    const uint32_t deadlineJob = TEST_TASKPOOL_URGENT_JOBS - 1;
+    const uint32_t firstNormalJob = TEST_TASKPOOL_URGENT_JOBS;
+    const uint32_t secondNormalJob = TEST_TASKPOOL_URGENT_JOBS + 1;
+    const uint32_t backgroundJob = TEST_TASKPOOL_URGENT_JOBS + 2;
+
+    memset( &userContext, 0, sizeof( JobOrderUserContext_t ) );
+    userContext.pJobsStorage = jobsStorage;
+
+    TEST_ASSERT( IotMutex_Create( &userContext.lock, false ) );
+    TEST_ASSERT( IotSemaphore_Create( &blockingUserContext.signal, 0, 1 ) );
+    TEST_ASSERT( IotSemaphore_Create( &blockingUserContext.block, 0, 1 ) );
+
+    TEST_ASSERT( IotTaskPool_Create( &tpInfo, &taskPool ) == IOT_TASKPOOL_SUCCESS );
+
+    if( TEST_PROTECT() )
+    {
+        /* Trivial parameter validation. */
+        TEST_ASSERT( IotTaskPool_CreateJob( &ExecutionRecordOrderCb, &userContext, &jobsStorage[ 0 ], &jobs[ 0 ] ) == IOT_TASKPOOL_SUCCESS );
+        TEST_ASSERT( IotTaskPool_ScheduleWithPriority( NULL, jobs[ 0 ], IOT_TASKPOOL_PRIORITY_URGENT, 0 ) == IOT_TASKPOOL_BAD_PARAMETER );
+        TEST_ASSERT( IotTaskPool_ScheduleWithPriority( taskPool, NULL, IOT_TASKPOOL_PRIORITY_URGENT, 0 ) == IOT_TASKPOOL_BAD_PARAMETER );
+        TEST_ASSERT( IotTaskPool_ScheduleWithPriority( taskPool, jobs[ 0 ], ( IotTaskPoolJobPriority_t ) 3, 0 ) == IOT_TASKPOOL_BAD_PARAMETER );
+        TEST_ASSERT( IotTaskPool_GetLaneStatus( taskPool, IOT_TASKPOOL_PRIORITY_URGENT, NULL ) == IOT_TASKPOOL_BAD_PARAMETER );
+        TEST_ASSERT( IotTaskPool_GetLaneStatus( taskPool, ( IotTaskPoolJobPriority_t ) 3, &laneStatus ) == IOT_TASKPOOL_BAD_PARAMETER );
+
+        /* Keep the only worker busy, so that all jobs wait in their lanes. */
+        TEST_ASSERT( IotTaskPool_CreateJob( &ExecutionBlockingWithoutDestroyCb, &blockingUserContext, &blockingJobStorage, &blockingJob ) == IOT_TASKPOOL_SUCCESS );
+        TEST_ASSERT( IotTaskPool_Schedule( taskPool, blockingJob, 0 ) == IOT_TASKPOOL_SUCCESS );
+        IotSemaphore_Wait( &blockingUserContext.signal );
+
+        /* Schedule the less urgent jobs first. */
+        TEST_ASSERT( IotTaskPool_CreateJob( &ExecutionRecordOrderCb, &userContext, &jobsStorage[ backgroundJob ], &jobs[ backgroundJob ] ) == IOT_TASKPOOL_SUCCESS );
+        TEST_ASSERT( IotTaskPool_ScheduleWithPriority( taskPool, jobs[ backgroundJob ], IOT_TASKPOOL_PRIORITY_BACKGROUND, 0 ) == IOT_TASKPOOL_SUCCESS );
+        TEST_ASSERT( IotTaskPool_CreateJob( &ExecutionRecordOrderCb, &userContext, &jobsStorage[ firstNormalJob ], &jobs[ firstNormalJob ] ) == IOT_TASKPOOL_SUCCESS );
+        TEST_ASSERT( IotTaskPool_Schedule( taskPool, jobs[ firstNormalJob ], 0 ) == IOT_TASKPOOL_SUCCESS );
+        TEST_ASSERT( IotTaskPool_CreateJob( &ExecutionRecordOrderCb, &userContext, &jobsStorage[ secondNormalJob ], &jobs[ secondNormalJob ] ) == IOT_TASKPOOL_SUCCESS );
+        TEST_ASSERT( IotTaskPool_ScheduleWithPriority( taskPool, jobs[ secondNormalJob ], IOT_TASKPOOL_PRIORITY_NORMAL, 0 ) == IOT_TASKPOOL_SUCCESS );
+
+        /* Then the urgent jobs, the last one with a deadline. */
+        for( count = 0; count < TEST_TASKPOOL_URGENT_JOBS; ++count )
+        {
+            TEST_ASSERT( IotTaskPool_CreateJob( &ExecutionRecordOrderCb, &userContext, &jobsStorage[ count ], &jobs[ count ] ) == IOT_TASKPOOL_SUCCESS );
+            TEST_ASSERT( IotTaskPool_ScheduleWithPriority( taskPool,
+                                                           jobs[ count ],
+                                                           IOT_TASKPOOL_PRIORITY_URGENT,
+                                                           ( count == deadlineJob ) ? ONE_HOUR_FROM_NOW_MS : 0 ) == IOT_TASKPOOL_SUCCESS );
+        }
+
+        TEST_ASSERT( IotTaskPool_GetLaneStatus( taskPool, IOT_TASKPOOL_PRIORITY_URGENT, &laneStatus ) == IOT_TASKPOOL_SUCCESS );
+        TEST_ASSERT_EQUAL_UINT32( TEST_TASKPOOL_URGENT_JOBS, laneStatus.depth );
+
+        /* Release the worker and wait for all jobs to execute. */
+        IotSemaphore_Post( &blockingUserContext.block );
+
+        while( true )
+        {
+            IotClock_SleepMs( 50 );
+
+            IotMutex_Lock( &userContext.lock );
+
+            if( userContext.counter == TEST_TASKPOOL_LANE_JOBS )
+            {
+                IotMutex_Unlock( &userContext.lock );
+
+                break;
+            }
+
+            IotMutex_Unlock( &userContext.lock );
+        }
+
+        /* The urgent job with a deadline goes first, followed by the other urgent jobs in FIFO order,
+         * until the other lanes were passed over too many times in a row. */
+        TEST_ASSERT_EQUAL_UINT32( deadlineJob, userContext.order[ 0 ] );
+
+        for( count = 1; count < IOT_TASKPOOL_LANE_STARVATION_LIMIT; ++count )
+        {
+            TEST_ASSERT_EQUAL_UINT32( count - 1, userContext.order[ count ] );
+        }
+
+        TEST_ASSERT_EQUAL_UINT32( firstNormalJob, userContext.order[ IOT_TASKPOOL_LANE_STARVATION_LIMIT ] );
+        TEST_ASSERT_EQUAL_UINT32( backgroundJob, userContext.order[ IOT_TASKPOOL_LANE_STARVATION_LIMIT + 1 ] );
+        TEST_ASSERT_EQUAL_UINT32( secondNormalJob, userContext.order[ TEST_TASKPOOL_LANE_JOBS - 1 ] );
+
+        /* Check the statistics of the lanes. */
+        TEST_ASSERT( IotTaskPool_GetLaneStatus( taskPool, IOT_TASKPOOL_PRIORITY_URGENT, &laneStatus ) == IOT_TASKPOOL_SUCCESS );
+        TEST_ASSERT_EQUAL_UINT32( 0, laneStatus.depth );
+        TEST_ASSERT_EQUAL_UINT32( TEST_TASKPOOL_URGENT_JOBS, laneStatus.maxDepth );
+        TEST_ASSERT_EQUAL_UINT32( TEST_TASKPOOL_URGENT_JOBS, laneStatus.dispatched );
+        TEST_ASSERT_EQUAL_UINT32( 0, laneStatus.promoted );
+        TEST_ASSERT_EQUAL_UINT32( 0, laneStatus.deadlineMisses );
+
+        TEST_ASSERT( IotTaskPool_GetLaneStatus( taskPool, IOT_TASKPOOL_PRIORITY_NORMAL, &laneStatus ) == IOT_TASKPOOL_SUCCESS );
+        TEST_ASSERT_EQUAL_UINT32( 3, laneStatus.dispatched );
+        TEST_ASSERT_EQUAL_UINT32( 1, laneStatus.promoted );
+
+        TEST_ASSERT( IotTaskPool_GetLaneStatus( taskPool, IOT_TASKPOOL_PRIORITY_BACKGROUND, &laneStatus ) == IOT_TASKPOOL_SUCCESS );
+        TEST_ASSERT_EQUAL_UINT32( 1, laneStatus.dispatched );
+        TEST_ASSERT_EQUAL_UINT32( 1, laneStatus.promoted );
+        TEST_ASSERT( laneStatus.maxLatencyMs <= laneStatus.totalLatencyMs );
+    }
+
+    TEST_ASSERT( IotTaskPool_Destroy( taskPool ) == IOT_TASKPOOL_SUCCESS );
+
+    IotSemaphore_Destroy( &blockingUserContext.signal );
+    IotSemaphore_Destroy( &blockingUserContext.block );
+    IotMutex_Destroy( &userContext.lock );
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test group for task pool benchmarks.
+ *
+ * These tests log timings instead of checking behavior. The test runner only
+ * runs them when testrunnerFULL_TASKPOOL_BENCHMARK_ENABLED is 1.
+ */
+TEST_GROUP( Common_Benchmark_Task_Pool );
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test setup for task pool benchmarks.
+ */
+TEST_SETUP( Common_Benchmark_Task_Pool )
+{
+    TEST_ASSERT_EQUAL_INT( true, IotSdk_Init() );
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test tear down for task pool benchmarks.
+ */
+TEST_TEAR_DOWN( Common_Benchmark_Task_Pool )
+{
+    IotSdk_Cleanup();
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test group runner for task pool benchmarks.
+ */
+TEST_GROUP_RUNNER( Common_Benchmark_Task_Pool )
+{
+    #if IOT_STATIC_MEMORY_ONLY == 0
+        RUN_TEST_CASE( Common_Benchmark_Task_Pool, ScheduleTasks_TimerWheelBenchmark );
+    #endif
+}
+
+/*-----------------------------------------------------------*/
+
+#if IOT_STATIC_MEMORY_ONLY == 0
+
+/**
+ * @brief Measure the time to schedule and cancel a given number of deferred jobs.
+ */
+    static void _benchmarkDeferredJobs( uint32_t flags,
+                                        uint32_t jobCount,
+                                        IotTaskPoolJobStorage_t * pJobsStorage,
+                                        IotTaskPoolJob_t * pJobs )
+    {
+        uint32_t count;
+        uint64_t startTime, scheduleTime, cancelTime;
+        IotTaskPool_t taskPool = IOT_TASKPOOL_INITIALIZER;
+        const IotTaskPoolInfo_t tpInfo = { .minThreads = 1, .maxThreads = 1, .stackSize = IOT_THREAD_DEFAULT_STACK_SIZE, .priority = IOT_THREAD_DEFAULT_PRIORITY, .flags = flags };
+
+        TEST_ASSERT( IotTaskPool_Create( &tpInfo, &taskPool ) == IOT_TASKPOOL_SUCCESS );
+
+        if( TEST_PROTECT() )
+        {
+            for( count = 0; count < jobCount; ++count )
+            {
+                TEST_ASSERT( IotTaskPool_CreateJob( &BlankExecution, NULL, &pJobsStorage[ count ], &pJobs[ count ] ) == IOT_TASKPOOL_SUCCESS );
+            }
+
+            /* None of the jobs expires during the benchmark, so all of them stay outstanding. */
+            startTime = IotClock_GetTimeMs();
+
+            for( count = 0; count < jobCount; ++count )
+            {
+                TEST_ASSERT( IotTaskPool_ScheduleDeferred( taskPool, pJobs[ count ], ONE_HOUR_FROM_NOW_MS + ( rand() % ONE_HOUR_FROM_NOW_MS ) ) == IOT_TASKPOOL_SUCCESS );
+            }
+
+            scheduleTime = IotClock_GetTimeMs() - startTime;
+
+            startTime = IotClock_GetTimeMs();
+
+            for( count = 0; count < jobCount; ++count )
+            {
+                TEST_ASSERT( IotTaskPool_TryCancel( taskPool, pJobs[ count ], NULL ) == IOT_TASKPOOL_SUCCESS );
+            }
+
+            cancelTime = IotClock_GetTimeMs() - startTime;
+
+            IotLogInfo( "%s: %lu deferred jobs scheduled in %lu ms, canceled in %lu ms.",
+                        ( flags == IOT_TASKPOOL_TIMER_WHEEL ) ? "Timing wheel" : "Sorted list",
+                        ( unsigned long ) jobCount,
+                        ( unsigned long ) scheduleTime,
+                        ( unsigned long ) cancelTime );
+        }
+
+        TEST_ASSERT( IotTaskPool_Destroy( taskPool ) == IOT_TASKPOOL_SUCCESS );
+    }
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Compare the cost of deferred jobs with a timing wheel and with a sorted list
+ * at 10, 1000 and #TEST_TASKPOOL_TIMER_BENCHMARK_MAX_JOBS outstanding timers.
+ */
+    TEST( Common_Benchmark_Task_Pool, ScheduleTasks_TimerWheelBenchmark )
+    {
+        uint32_t i;
+        const uint32_t jobCounts[] = { 10, 1000, TEST_TASKPOOL_TIMER_BENCHMARK_MAX_JOBS };
+        IotTaskPoolJobStorage_t * pJobsStorage = IotTest_Malloc( TEST_TASKPOOL_TIMER_BENCHMARK_MAX_JOBS * sizeof( IotTaskPoolJobStorage_t ) );
+        IotTaskPoolJob_t * pJobs = IotTest_Malloc( TEST_TASKPOOL_TIMER_BENCHMARK_MAX_JOBS * sizeof( IotTaskPoolJob_t ) );
+
+        TEST_ASSERT_NOT_NULL( pJobsStorage );
+        TEST_ASSERT_NOT_NULL( pJobs );
+
+        if( TEST_PROTECT() )
+        {
+            for( i = 0; i < ( sizeof( jobCounts ) / sizeof( jobCounts[ 0 ] ) ); ++i )
+            {
+                _benchmarkDeferredJobs( 0, jobCounts[ i ], pJobsStorage, pJobs );
+                _benchmarkDeferredJobs( IOT_TASKPOOL_TIMER_WHEEL, jobCounts[ i ], pJobsStorage, pJobs );
+            }
+        }
+
+        IotTest_Free( pJobsStorage );
+        IotTest_Free( pJobs );
+    }
+
+#endif /* if IOT_STATIC_MEMORY_ONLY == 0 */
+
+/*-----------------------------------------------------------*/
@@ -0,0 +1,469 @@
+/*
+ * FreeRTOS Common V1.2.0
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+/**
+ * @file iot_tests_taskpool_stress.c
+ * @brief Stress tests for task pool, comparing the shared dispatch queue with work stealing.
+ */
+
+/* The config header is always included first. */
+#include "iot_config.h"
+
+/* Standard includes. */
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+/* SDK initialization include. */
+#include "iot_init.h"
+
+/* Platform layer includes. */
+#include "platform/iot_threads.h"
+#include "platform/iot_clock.h"
+
+/* Atomics include. */
+#include "iot_atomic.h"
+
+/* Task pool internal include. */
+#include "private/iot_taskpool_internal.h"
+
+/* Task pool include. */
+#include "iot_taskpool.h"
+
+/* Test framework includes. */
+#include "unity_fixture.h"
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Number of workers of the task pools under test.
+ */
+#ifndef TEST_TASKPOOL_STRESS_WORKERS
+    #define TEST_TASKPOOL_STRESS_WORKERS    ( IOT_TASKPOOL_WORK_STEALING_MAX_WORKERS )
+#endif
+
+/**
+ * @brief Number of jobs scheduled from outside the task pool, each of which schedules
+ * #TEST_TASKPOOL_STRESS_FAN_OUT more jobs from within the task pool.
+ */
+#ifndef TEST_TASKPOOL_STRESS_ROOT_JOBS
+    #define TEST_TASKPOOL_STRESS_ROOT_JOBS    ( 200 )
+#endif
+
+/**
+ * @brief Number of jobs scheduled by each root job.
+ */
+#ifndef TEST_TASKPOOL_STRESS_FAN_OUT
+    #define TEST_TASKPOOL_STRESS_FAN_OUT    ( 24 )
+#endif
+
+/**
+ * @brief Number of threads scheduling jobs concurrently from outside the task pool.
+ */
+#ifndef TEST_TASKPOOL_STRESS_PRODUCERS
+    #define TEST_TASKPOOL_STRESS_PRODUCERS    ( 4 )
+#endif
+
+/**
+ * @brief Number of jobs scheduled by each producer thread.
+ */
+#ifndef TEST_TASKPOOL_STRESS_JOBS_PER_PRODUCER
+    #define TEST_TASKPOOL_STRESS_JOBS_PER_PRODUCER    ( 1250 )
+#endif
+
+/**
+ * @brief Number of iterations of the busy loop emulating the work of a job.
+ */
+#ifndef TEST_TASKPOOL_STRESS_WORK_ITERATIONS
+    #define TEST_TASKPOOL_STRESS_WORK_ITERATIONS    ( 200 )
+#endif
+
+/**
+ * @brief Time to wait for all jobs of one run to complete.
+ */
+#define TEST_TASKPOOL_STRESS_TIMEOUT_MS    ( 60000 )
+
+/**
+ * @brief Total number of jobs in the fan-out scenario.
+ */
+#define TEST_TASKPOOL_STRESS_FAN_OUT_JOBS      ( TEST_TASKPOOL_STRESS_ROOT_JOBS * ( 1 + TEST_TASKPOOL_STRESS_FAN_OUT ) )
+
+/**
+ * @brief Total number of jobs in the producers scenario.
+ */
+#define TEST_TASKPOOL_STRESS_PRODUCERS_JOBS    ( TEST_TASKPOOL_STRESS_PRODUCERS * TEST_TASKPOOL_STRESS_JOBS_PER_PRODUCER )
+
+/*-----------------------------------------------------------*/
+
+struct StressContext;
+
+/**
+ * @brief One job of a stress run, and the time it was scheduled at.
+ */
+typedef struct StressJob
+{
+    IotTaskPoolJobStorage_t jobStorage; /**< @brief The storage for the job. */
+    IotTaskPoolJob_t job;               /**< @brief The job handle. */
+    uint64_t scheduleTime;              /**< @brief When the job was scheduled. */
+    uint32_t index;                     /**< @brief The position of this job in #StressContext_t.pJobs. */
+    struct StressContext * pContext;    /**< @brief The stress run this job belongs to. */
+} StressJob_t;
+
+/**
+ * @brief The shared state of a stress run.
+ */
+typedef struct StressContext
+{
+    IotTaskPool_t taskPool;     /**< @brief The task pool under test. */
+    StressJob_t * pJobs;        /**< @brief All jobs of the run. */
+    uint32_t totalJobs;         /**< @brief The number of jobs expected to run. */
+    uint32_t completedJobs;     /**< @brief The number of jobs that ran. Updated atomically. */
+    uint32_t latencySumMs;      /**< @brief The sum of all scheduling latencies. Updated atomically. */
+    uint32_t latencyMaxMs;      /**< @brief The largest scheduling latency. Updated atomically. */
+    uint32_t nextProducerJob;   /**< @brief The next job for a producer thread. Updated atomically. */
+    uint32_t scheduleFailures;  /**< @brief The number of jobs that failed to schedule. Updated atomically. */
+    IotSemaphore_t done;        /**< @brief Posted when all jobs ran, and by each producer thread when done. */
+} StressContext_t;
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test group for task pool stress tests.
+ */
+TEST_GROUP( Common_Unit_Task_Pool_Stress );
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test setup for task pool stress tests.
+ */
+TEST_SETUP( Common_Unit_Task_Pool_Stress )
+{
+    TEST_ASSERT_EQUAL_INT( true, IotSdk_Init() );
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test tear down for task pool stress tests.
+ */
+TEST_TEAR_DOWN( Common_Unit_Task_Pool_Stress )
+{
+    IotSdk_Cleanup();
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test group runner for task pool stress tests.
+ */
+TEST_GROUP_RUNNER( Common_Unit_Task_Pool_Stress )
+{
+    #if IOT_STATIC_MEMORY_ONLY == 0
+        RUN_TEST_CASE( Common_Unit_Task_Pool_Stress, ScheduleFromWorkers );
+        RUN_TEST_CASE( Common_Unit_Task_Pool_Stress, ScheduleFromProducers );
+    #endif
+}
+
+/*-----------------------------------------------------------*/
+
+#if IOT_STATIC_MEMORY_ONLY == 0
+
+/**
+ * @brief Emulate a short amount of work, without yielding the CPU.
+ */
+    static void _emulateWork( uint32_t seed )
+    {
+        volatile uint32_t value = seed;
+        uint32_t i;
+
+        for( i = 0; i < TEST_TASKPOOL_STRESS_WORK_ITERATIONS; ++i )
+        {
+            value = ( value * 1103515245UL ) + 12345UL;
+        }
+    }
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Count a job as finished, and signal the end of the run after the last job.
+ */
+    static void _completeJob( StressContext_t * pContext )
+    {
+        if( ( Atomic_Increment_u32( &pContext->completedJobs ) + 1UL ) == pContext->totalJobs )
+        {
+            IotSemaphore_Post( &pContext->done );
+        }
+    }
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Schedule a job of a stress run.
+ *
+ * Unity assertions may only be used in the test thread, so a failure is recorded
+ * in the stress context and checked once the run ends. A job that failed to
+ * schedule is counted as finished so the run does not wait for it.
+ */
+    static void _scheduleJob( StressJob_t * pStressJob )
+    {
+        StressContext_t * pContext = pStressJob->pContext;
+
+        pStressJob->scheduleTime = IotClock_GetTimeMs();
+
+        if( IotTaskPool_Schedule( pContext->taskPool, pStressJob->job, 0 ) != IOT_TASKPOOL_SUCCESS )
+        {
+            ( void ) Atomic_Increment_u32( &pContext->scheduleFailures );
+
+            _completeJob( pContext );
+        }
+    }
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Record the scheduling latency of a job, and signal the end of the run after the last job.
+ */
+    static void _recordJob( StressJob_t * pStressJob )
+    {
+        StressContext_t * pContext = pStressJob->pContext;
+        uint32_t latency = ( uint32_t ) ( IotClock_GetTimeMs() - pStressJob->scheduleTime );
+        uint32_t maxLatency = Atomic_Add_u32( &pContext->latencyMaxMs, 0 );
+
+        ( void ) Atomic_Add_u32( &pContext->latencySumMs, latency );
+
+        while( ( latency > maxLatency ) &&
+               ( Atomic_CompareAndSwap_u32( &pContext->latencyMaxMs, latency, maxLatency ) != ATOMIC_COMPARE_AND_SWAP_SUCCESS ) )
+        {
+            maxLatency = Atomic_Add_u32( &pContext->latencyMaxMs, 0 );
+        }
+
+        _completeJob( pContext );
+    }
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief A job that does some work.
+ */
+    static void _leafJobCallback( IotTaskPool_t pTaskPool,
+                                  IotTaskPoolJob_t pJob,
+                                  void * pUserContext )
+    {
+        StressJob_t * pStressJob = ( StressJob_t * ) pUserContext;
+
+        ( void ) pTaskPool;
+        ( void ) pJob;
+
+        _emulateWork( pStressJob->index );
+
+        _recordJob( pStressJob );
+    }
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief A job that schedules #TEST_TASKPOOL_STRESS_FAN_OUT jobs from within the task pool.
+ */
+    static void _rootJobCallback( IotTaskPool_t pTaskPool,
+                                  IotTaskPoolJob_t pJob,
+                                  void * pUserContext )
+    {
+        StressJob_t * pStressJob = ( StressJob_t * ) pUserContext;
+        StressContext_t * pContext = pStressJob->pContext;
+        uint32_t count;
+
+        ( void ) pTaskPool;
+        ( void ) pJob;
+
+        for( count = 0; count < TEST_TASKPOOL_STRESS_FAN_OUT; ++count )
+        {
+            _scheduleJob( &pContext->pJobs[ TEST_TASKPOOL_STRESS_ROOT_JOBS +
+                                            ( pStressJob->index * TEST_TASKPOOL_STRESS_FAN_OUT ) + count ] );
+        }
+
+        _recordJob( pStressJob );
+    }
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief A thread that schedules jobs from outside the task pool.
+ */
+    static void _producerThread( void * pArgument )
+    {
+        StressContext_t * pContext = ( StressContext_t * ) pArgument;
+        uint32_t count;
+
+        for( count = 0; count < TEST_TASKPOOL_STRESS_JOBS_PER_PRODUCER; ++count )
+        {
+            _scheduleJob( &pContext->pJobs[ Atomic_Increment_u32( &pContext->nextProducerJob ) ] );
+        }
+
+        IotSemaphore_Post( &pContext->done );
+    }
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Run one stress scenario on a new task pool, and log its throughput and scheduling latency.
+ *
+ * @param[in] flags The creation flags of the task pool.
+ * @param[in] fromWorkers `true` to schedule most jobs from within the task pool;
+ * `false` to schedule all jobs from #TEST_TASKPOOL_STRESS_PRODUCERS threads.
+ * @param[in] pJobs Storage for the jobs of the run.
+ */
+    static void _stressTaskPool( uint32_t flags,
+                                 bool fromWorkers,
+                                 StressJob_t * pJobs )
+    {
+        uint32_t count;
+        uint64_t startTime, elapsedTime;
+        bool finished;
+        StressContext_t context;
+        const IotTaskPoolInfo_t tpInfo = { .minThreads = TEST_TASKPOOL_STRESS_WORKERS, .maxThreads = TEST_TASKPOOL_STRESS_WORKERS, .stackSize = IOT_THREAD_DEFAULT_STACK_SIZE, .priority = IOT_THREAD_DEFAULT_PRIORITY, .flags = flags };
+
+        memset( &context, 0x00, sizeof( StressContext_t ) );
+        context.pJobs = pJobs;
+        context.totalJobs = fromWorkers ? TEST_TASKPOOL_STRESS_FAN_OUT_JOBS : TEST_TASKPOOL_STRESS_PRODUCERS_JOBS;
+
+        TEST_ASSERT( IotSemaphore_Create( &context.done, 0, TEST_TASKPOOL_STRESS_PRODUCERS + 1 ) );
+        TEST_ASSERT( IotTaskPool_Create( &tpInfo, &context.taskPool ) == IOT_TASKPOOL_SUCCESS );
+
+        if( TEST_PROTECT() )
+        {
+            for( count = 0; count < context.totalJobs; ++count )
+            {
+                pJobs[ count ].index = count;
+                pJobs[ count ].pContext = &context;
+
+                TEST_ASSERT( IotTaskPool_CreateJob( ( fromWorkers && ( count < TEST_TASKPOOL_STRESS_ROOT_JOBS ) ) ? _rootJobCallback : _leafJobCallback,
+                                                    &pJobs[ count ],
+                                                    &pJobs[ count ].jobStorage,
+                                                    &pJobs[ count ].job ) == IOT_TASKPOOL_SUCCESS );
+            }
+
+            startTime = IotClock_GetTimeMs();
+
+            if( fromWorkers == true )
+            {
+                for( count = 0; count < TEST_TASKPOOL_STRESS_ROOT_JOBS; ++count )
+                {
+                    _scheduleJob( &pJobs[ count ] );
+                }
+            }
+            else
+            {
+                for( count = 0; count < TEST_TASKPOOL_STRESS_PRODUCERS; ++count )
+                {
+                    TEST_ASSERT( Iot_CreateDetachedThread( _producerThread,
+                                                           &context,
+                                                           IOT_THREAD_DEFAULT_PRIORITY,
+                                                           IOT_THREAD_DEFAULT_STACK_SIZE ) );
+                }
+
+                for( count = 0; count < TEST_TASKPOOL_STRESS_PRODUCERS; ++count )
+                {
+                    IotSemaphore_Wait( &context.done );
+                }
+            }
+
+            /* Wait for the last job. A root job that failed to schedule never schedules
+             * its children, so check for scheduling failures before the timeout. */
+            finished = IotSemaphore_TimedWait( &context.done, TEST_TASKPOOL_STRESS_TIMEOUT_MS );
+
+            elapsedTime = IotClock_GetTimeMs() - startTime;
+
+            TEST_ASSERT_EQUAL_UINT32( 0, context.scheduleFailures );
+            TEST_ASSERT( finished );
+            TEST_ASSERT_EQUAL_UINT32( context.totalJobs, context.completedJobs );
+
+            /* Avoid dividing by zero on fast hosts. */
+            if( elapsedTime == 0ULL )
+            {
+                elapsedTime = 1ULL;
+            }
+
+            IotLogInfo( "%s, %s: %lu jobs in %lu ms (%lu jobs/s), latency avg %lu us, max %lu ms.",
+                        ( flags == IOT_TASKPOOL_WORK_STEALING ) ? "Work stealing" : "Shared queue",
+                        fromWorkers ? "scheduled from workers" : "scheduled from producers",
+                        ( unsigned long ) context.totalJobs,
+                        ( unsigned long ) elapsedTime,
+                        ( unsigned long ) ( ( context.totalJobs * 1000ULL ) / elapsedTime ),
+                        ( unsigned long ) ( ( context.latencySumMs * 1000ULL ) / context.totalJobs ),
+                        ( unsigned long ) context.latencyMaxMs );
+        }
+
+        TEST_ASSERT( IotTaskPool_Destroy( context.taskPool ) == IOT_TASKPOOL_SUCCESS );
+
+        IotSemaphore_Destroy( &context.done );
+    }
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Compare the shared dispatch queue and work stealing when jobs are scheduled from
+ * within task pool callbacks.
+ */
+    TEST( Common_Unit_Task_Pool_Stress, ScheduleFromWorkers )
+    {
+        StressJob_t * pJobs = IotTest_Malloc( TEST_TASKPOOL_STRESS_FAN_OUT_JOBS * sizeof( StressJob_t ) );
+
+        TEST_ASSERT_NOT_NULL( pJobs );
+
+        if( TEST_PROTECT() )
+        {
+            _stressTaskPool( 0, true, pJobs );
+            _stressTaskPool( IOT_TASKPOOL_WORK_STEALING, true, pJobs );
+        }
+
+        IotTest_Free( pJobs );
+    }
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Compare the shared dispatch queue and work stealing when jobs are scheduled from
+ * several threads outside the task pool.
+ */
+    TEST( Common_Unit_Task_Pool_Stress, ScheduleFromProducers )
+    {
+        StressJob_t * pJobs = IotTest_Malloc( TEST_TASKPOOL_STRESS_PRODUCERS_JOBS * sizeof( StressJob_t ) );
+
+        TEST_ASSERT_NOT_NULL( pJobs );
+
+        if( TEST_PROTECT() )
+        {
+            _stressTaskPool( 0, false, pJobs );
+            _stressTaskPool( IOT_TASKPOOL_WORK_STEALING, false, pJobs );
+        }
+
+        IotTest_Free( pJobs );
+    }
+
+#endif /* if IOT_STATIC_MEMORY_ONLY == 0 */
+
+/*-----------------------------------------------------------*/
@@ -154,7 +154,9 @@ extern const uint32_t responseUserBufferMinimumSize;
  * This helps to calculate the size of the buffer needed for #IotHttpsConnectionInfo_t.userBuffer.
  *
  * The buffer size is calculated to fit the HTTP connection context only. The buffer assigned by the application must be
- * at least this size.
+ * at least this size. A connection with #IotHttpsConnectionInfo_t.pipelineDepth greater than one uses the rest of the
+ * buffer to hold response data that was received ahead of the response currently being processed, so it needs a larger
+ * buffer.
  *
  * A typical value for sizing the request user buffer for the connection context is 512 bytes. See the example below.
  * @code{c}
@@ -779,6 +781,19 @@ typedef struct IotHttpsConnectionInfo
      * In FreeRTOS this should be of the type @ref IotNetworkInterface_t.
      */
     IOT_HTTPS_NETWORK_INTERFACE_TYPE pNetworkInterface;
+
+    /**
+     * @brief The maximum number of requests on this connection that may be waiting for their response.
+     *
+     * If this is set to zero or one, a request is sent only after the response to the previous request on the
+     * connection was received. A greater value pipelines requests: up to this many requests are sent before their
+     * responses arrive, and the responses are matched to the requests in the order they were sent.
+     *
+     * Pipelining requires #IotHttpsConnectionInfo_t.userBuffer to be larger than @ref connectionUserBufferMinimumSize.
+     * The space beyond the minimum size holds the start of the next responses when it is received together with the
+     * end of the current response, and limits the size of each network read.
+     */
+    uint32_t pipelineDepth;
 } IotHttpsConnectionInfo_t;
 
 /**
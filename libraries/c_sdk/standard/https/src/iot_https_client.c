@@ -289,6 +289,16 @@ static int _httpParserOnMessageCompleteCallback( http_parser * pHttpParser );
 static void _networkReceiveCallback( void * pNetworkConnection,
                                      void * pReceiveContext );
 
+/**
+ * @brief Receive the response at the head of the connection's response queue.
+ *
+ * @param[in] pHttpsConnection - The HTTPS connection the response is received on.
+ *
+ * @return `true` if the start of the next response in the queue was already read from the network, so it must be
+ * received without waiting for the network receive callback; `false` otherwise.
+ */
+static bool _receiveHttpsResponse( _httpsConnection_t * pHttpsConnection );
+
 /**
  * @brief Connects to HTTPS server and initializes the connection context.
  *
@@ -319,6 +329,8 @@ static void _networkDestroy( _httpsConnection_t * pHttpsConnection );
 /**
  * @brief Receive data on the network.
  *
+ * Response data that was received ahead with a previous response on a pipelined connection is returned first.
+ *
  * @param[in] pHttpsConnection - HTTP connection context.
  * @param[in] pBuf - The buffer to receive the data into.
  * @param[in] bufLen - The length of the data to receive.
@@ -338,13 +350,31 @@ static IotHttpsReturnCode_t _networkRecv( _httpsConnection_t * pHttpsConnection,
  * @param[in] pHttpParserInfo - Pointer to the information containing the instance of the http-parser and the execution function.
  * @param[in] pBuf - The buffer containing the data to parse.
  * @param[in] len - The length of data to parse.
+ * @param[out] pParsedBytes - The number of bytes parsed. This is less than len when the end of the message is reached
+ * before the end of pBuf.
  *
  * @return #IOT_HTTPS_OK if the data was parsed successfully.
  *         #IOT_HTTPS_PARSING_ERROR if there was an error with parsing the data.
  */
 static IotHttpsReturnCode_t _parseHttpsMessage( _httpParserInfo_t * pHttpParserInfo,
                                                 char * pBuf,
-                                                size_t len );
+                                                size_t len,
+                                                size_t * pParsedBytes );
+
+/**
+ * @brief Keep the response data that was received beyond the end of the current response.
+ *
+ * On a pipelined connection, a network read may return the end of one response together with the start of the next
+ * one. The data following the end of the current response is placed in front of the read-ahead data of the
+ * connection, so that _networkRecv() returns it first. Without pipelining, this data is ignored.
+ *
+ * @param[in] pHttpsConnection - HTTP connection context.
+ * @param[in] pData - The data following the end of the current response.
+ * @param[in] dataLen - The length of the data following the end of the current response.
+ */
+static void _saveReadAheadData( _httpsConnection_t * pHttpsConnection,
+                                const uint8_t * pData,
+                                size_t dataLen );
 
 /**
  * @brief Receive any part of an HTTP response.
@@ -434,6 +464,35 @@ static IotHttpsReturnCode_t _receiveHttpsBody( _httpsConnection_t * pHttpsConnec
 static IotHttpsReturnCode_t _flushHttpsNetworkData( _httpsConnection_t * pHttpsConnection,
                                                     _httpsResponse_t * pHttpsResponse );
 
+/**
+ * @brief Check if another request may be sent on the connection now.
+ *
+ * A request may be sent if fewer than #_httpsConnection_t.pipelineDepth responses are pending on the connection, and
+ * if none of the pending responses is for a non-persistent request. Without pipelining, a request is therefore sent
+ * only after all responses on the connection are received.
+ *
+ * The connection mutex must be held when calling this function.
+ *
+ * @param[in] pHttpsConnection - HTTP connection context.
+ * @param[in] pFinishedResponse - A response still in the response queue that is not pending anymore. May be NULL.
+ *
+ * @return `true` if a request may be sent now; `false` otherwise.
+ */
+static bool _canSendNextRequest( _httpsConnection_t * pHttpsConnection,
+                                 _httpsResponse_t * pFinishedResponse );
+
+/**
+ * @brief Schedule the request at the head of the connection's request queue if it may be sent now.
+ *
+ * The request is scheduled if it is not scheduled already and _canSendNextRequest() allows it. Errors scheduling the
+ * request are reported to the application.
+ *
+ * @param[in] pHttpsConnection - HTTP connection context.
+ * @param[in] pFinishedResponse - A response still in the response queue that is not pending anymore. May be NULL.
+ */
+static void _scheduleNextHttpsRequest( _httpsConnection_t * pHttpsConnection,
+                                       _httpsResponse_t * pFinishedResponse );
+
 /**
  * @brief Send an HTTP request from the dispatch queue.
  *
@@ -1086,20 +1145,34 @@ static int32_t transportSend( NetworkContext_t * pNetworkContext,
 
 static void _networkReceiveCallback( void * pNetworkConnection,
                                      void * pReceiveContext )
+{
+    _httpsConnection_t * pHttpsConnection = ( _httpsConnection_t * ) pReceiveContext;
+    bool receiveNextResponse = true;
+
+    /* The network connection is already in the connection context. */
+    ( void ) pNetworkConnection;
+
+    /* On a pipelined connection, the start of the next responses may have been received together with the end of
+     * a response. That data was already taken from the network, so the network will not invoke this callback for it.
+     * Each iteration receives one response. */
+    while( receiveNextResponse == true )
+    {
+        receiveNextResponse = _receiveHttpsResponse( pHttpsConnection );
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+static bool _receiveHttpsResponse( _httpsConnection_t * pHttpsConnection )
 {
     HTTPS_FUNCTION_ENTRY( IOT_HTTPS_OK );
 
     IotHttpsReturnCode_t flushStatus = IOT_HTTPS_OK;
     IotHttpsReturnCode_t disconnectStatus = IOT_HTTPS_OK;
-    IotHttpsReturnCode_t scheduleStatus = IOT_HTTPS_OK;
-    _httpsConnection_t * pHttpsConnection = ( _httpsConnection_t * ) pReceiveContext;
     _httpsResponse_t * pCurrentHttpsResponse = NULL;
-    _httpsRequest_t * pNextHttpsRequest = NULL;
     IotLink_t * pQItem = NULL;
     bool fatalDisconnect = false;
-
-    /* The network connection is already in the connection context. */
-    ( void ) pNetworkConnection;
+    bool receiveNextResponse = false;
 
     /* Get the response from the response queue. */
     IotMutex_Lock( &( pHttpsConnection->connectionMutex ) );
@@ -1160,7 +1233,7 @@ static void _networkReceiveCallback( void * pNetworkConnection,
              * we ask for the full size of the receive buffer. Therefore, the only error that can be returned from receiving
              * the headers or body is a timeout. We always disconnect from the network when there is a timeout because the
              * server may be slow to respond. If the server happens to send the response later at the same time another response
-             * is waiting in the queue, then the workflow is corrupted. Pipelining is not current supported in this library. */
+             * is waiting in the queue, then the workflow is corrupted. */
             IotLogError( "Network error receiving the HTTPS headers for response %p. Error code: %d",
                          pCurrentHttpsResponse,
                          status );
@@ -1245,7 +1318,7 @@ static void _networkReceiveCallback( void * pNetworkConnection,
         }
 
         /* In this case this routine returns immediately after to avoid further uses of pCurrentHttpsResponse. */
-        return;
+        return false;
     }
 
     /* Report errors back to the application. */
@@ -1305,42 +1378,8 @@ static void _networkReceiveCallback( void * pNetworkConnection,
             IotLogDebug( "Network error when flushing the https network data: %d", flushStatus );
         }
 
-        IotMutex_Lock( &( pHttpsConnection->connectionMutex ) );
-        /* Get the next request to process. */
-        pQItem = IotDeQueue_PeekHead( &( pHttpsConnection->reqQ ) );
-        IotMutex_Unlock( &( pHttpsConnection->connectionMutex ) );
-
         /* If there is a next request to process, then add a dispatch task to the queue. */
-        if( pQItem != NULL )
-        {
-            /* Set this next request to send. */
-            pNextHttpsRequest = IotLink_Container( _httpsRequest_t, pQItem, link );
-
-            if( pNextHttpsRequest->scheduled == false )
-            {
-                IotLogDebug( "Request %p is next in the queue. Now scheduling a task to send the request.", pNextHttpsRequest );
-                scheduleStatus = _scheduleHttpsRequestSend( pNextHttpsRequest );
-
-                /* If there was an error with scheduling the new task, then report it. */
-                if( HTTPS_FAILED( scheduleStatus ) )
-                {
-                    IotLogError( "Error scheduling HTTPS request %p. Error code: %d", pNextHttpsRequest, scheduleStatus );
-
-                    if( pNextHttpsRequest->isAsync && pNextHttpsRequest->pCallbacks->errorCallback )
-                    {
-                        pNextHttpsRequest->pCallbacks->errorCallback( pNextHttpsRequest->pUserPrivData, pNextHttpsRequest, NULL, scheduleStatus );
-                    }
-                    else
-                    {
-                        pNextHttpsRequest->pHttpsResponse->syncStatus = scheduleStatus;
-                    }
-                }
-            }
-        }
-        else
-        {
-            IotLogDebug( "Network receive callback found the request queue empty. A network send task was not scheduled." );
-        }
+        _scheduleNextHttpsRequest( pHttpsConnection, pCurrentHttpsResponse );
     }
 
     /* Dequeue response from the response queue now that it is finished. */
@@ -1355,6 +1394,10 @@ static void _networkReceiveCallback( void * pNetworkConnection,
         IotDeQueue_Remove( &( pCurrentHttpsResponse->link ) );
     }
 
+    /* Check if the start of the next response was received together with the end of this response. */
+    receiveNextResponse = ( pHttpsConnection->readAheadCount > 0 ) &&
+                          ( IotDeQueue_IsEmpty( &( pHttpsConnection->respQ ) ) == false );
+
     IotMutex_Unlock( &( pHttpsConnection->connectionMutex ) );
 
     /* The first if-case below notifies IotHttpsClient_SendSync() that the response is finished receiving. When
@@ -1372,6 +1415,8 @@ static void _networkReceiveCallback( void * pNetworkConnection,
         /* Signal to a synchronous response that the response is complete. */
         pCurrentHttpsResponse->pCallbacks->responseCompleteCallback( pCurrentHttpsResponse->pUserPrivData, pCurrentHttpsResponse, status, pCurrentHttpsResponse->status );
     }
+
+    return receiveNextResponse;
 }
 
 /*-----------------------------------------------------------*/
@@ -1408,6 +1453,14 @@ static IotHttpsReturnCode_t _createHttpsConnection( IotHttpsConnectionHandle_t *
                                          ( *pConnInfo ).userBuffer.bufferLen,
                                          connectionUserBufferMinimumSize );
 
+    /* A pipelined connection keeps response data that was received ahead in the rest of the user buffer. */
+    HTTPS_ON_ARG_ERROR_MSG_GOTO_CLEANUP( ( pConnInfo->pipelineDepth <= 1 ) ||
+                                         ( pConnInfo->userBuffer.bufferLen > connectionUserBufferMinimumSize ),
+                                         IOT_HTTPS_INSUFFICIENT_MEMORY,
+                                         "Buffer size is too small to pipeline requests. User buffer size: %d, must be larger than %d.",
+                                         ( *pConnInfo ).userBuffer.bufferLen,
+                                         connectionUserBufferMinimumSize );
+
     /* Make sure that the server address does not exceed the maximum permitted length. */
     HTTPS_ON_ARG_ERROR_MSG_GOTO_CLEANUP( pConnInfo->addressLen <= IOT_HTTPS_MAX_HOST_NAME_LENGTH,
                                          IOT_HTTPS_INVALID_PARAMETER,
@@ -1445,6 +1498,22 @@ static IotHttpsReturnCode_t _createHttpsConnection( IotHttpsConnectionHandle_t *
         pHttpsConnection->timeout = pConnInfo->timeout;
     }
 
+    /* Without pipelining, a request is sent only when no other response is pending on the connection. */
+    pHttpsConnection->readAheadCount = 0;
+
+    if( pConnInfo->pipelineDepth > 1 )
+    {
+        pHttpsConnection->pipelineDepth = pConnInfo->pipelineDepth;
+        pHttpsConnection->pReadAheadBuf = pConnInfo->userBuffer.pBuffer + connectionUserBufferMinimumSize;
+        pHttpsConnection->readAheadBufLen = pConnInfo->userBuffer.bufferLen - connectionUserBufferMinimumSize;
+    }
+    else
+    {
+        pHttpsConnection->pipelineDepth = 1;
+        pHttpsConnection->pReadAheadBuf = NULL;
+        pHttpsConnection->readAheadBufLen = 0;
+    }
+
     /* pNetworkInterface contains all the routines to be able to send/receive data on the network. */
     pHttpsConnection->pNetworkInterface = pConnInfo->pNetworkInterface;
 
@@ -1609,12 +1678,32 @@ static IotHttpsReturnCode_t _networkRecv( _httpsConnection_t * pHttpsConnection,
 {
     HTTPS_FUNCTION_ENTRY( IOT_HTTPS_OK );
 
-    /* The HTTP server could send the header and the body in two separate TCP packets. If that is the case, then
-     * receiveUpTo will return return the full headers first. Then on a second call, the body will be returned.
-     * If the http parser receives just the headers despite the content length being greater than  */
-    *numBytesRecv = pHttpsConnection->pNetworkInterface->receiveUpto( pHttpsConnection->pNetworkConnection,
-                                                                      pBuf,
-                                                                      bufLen );
+    if( pHttpsConnection->readAheadCount > 0 )
+    {
+        /* Return the data that was received ahead with the previous response first. */
+        *numBytesRecv = ( bufLen < pHttpsConnection->readAheadCount ) ? bufLen : pHttpsConnection->readAheadCount;
+        memcpy( pBuf, pHttpsConnection->pReadAheadBuf, *numBytesRecv );
+        pHttpsConnection->readAheadCount -= *numBytesRecv;
+        memmove( pHttpsConnection->pReadAheadBuf,
+                 pHttpsConnection->pReadAheadBuf + *numBytesRecv,
+                 pHttpsConnection->readAheadCount );
+    }
+    else
+    {
+        /* On a pipelined connection, the data read may include the start of the next response. Limit the read so that
+         * this data always fits into the read-ahead buffer. */
+        if( ( pHttpsConnection->pReadAheadBuf != NULL ) && ( bufLen > pHttpsConnection->readAheadBufLen ) )
+        {
+            bufLen = pHttpsConnection->readAheadBufLen;
+        }
+
+        /* The HTTP server could send the header and the body in two separate TCP packets. If that is the case, then
+         * receiveUpTo will return return the full headers first. Then on a second call, the body will be returned.
+         * If the http parser receives just the headers despite the content length being greater than  */
+        *numBytesRecv = pHttpsConnection->pNetworkInterface->receiveUpto( pHttpsConnection->pNetworkConnection,
+                                                                          pBuf,
+                                                                          bufLen );
+    }
 
     IotLogDebug( "The network interface receive returned %d.", *numBytesRecv );
 
@@ -1641,21 +1730,20 @@ static IotHttpsReturnCode_t _networkRecv( _httpsConnection_t * pHttpsConnection,
 
 static IotHttpsReturnCode_t _parseHttpsMessage( _httpParserInfo_t * pHttpParserInfo,
                                                 char * pBuf,
-                                                size_t len )
+                                                size_t len,
+                                                size_t * pParsedBytes )
 {
     HTTPS_FUNCTION_ENTRY( IOT_HTTPS_OK );
 
-    size_t parsedBytes = 0;
     const char * pHttpParserErrorDescription = NULL;
     http_parser * pHttpParser = &( pHttpParserInfo->responseParser );
 
     /* Disable -Wunused-but-set-variable for local variables used for logging. */
-    ( void ) parsedBytes;
     ( void ) pHttpParserErrorDescription;
 
     IotLogDebug( "Now parsing HTTP message buffer to process a response." );
-    parsedBytes = pHttpParserInfo->parseFunc( pHttpParser, &_httpParserSettings, pBuf, len );
-    IotLogDebug( "http-parser parsed %d bytes out of %d specified.", parsedBytes, len );
+    *pParsedBytes = pHttpParserInfo->parseFunc( pHttpParser, &_httpParserSettings, pBuf, len );
+    IotLogDebug( "http-parser parsed %d bytes out of %d specified.", *pParsedBytes, len );
 
     /* If the parser fails with HPE_CLOSED_CONNECTION or HPE_INVALID_CONSTANT that simply means there
      * was data beyond the end of the message. We do not fail in this case because we give the whole
@@ -1679,6 +1767,30 @@ static IotHttpsReturnCode_t _parseHttpsMessage( _httpParserInfo_t * pHttpParserI
 
 /*-----------------------------------------------------------*/
 
+static void _saveReadAheadData( _httpsConnection_t * pHttpsConnection,
+                                const uint8_t * pData,
+                                size_t dataLen )
+{
+    if( pHttpsConnection->pReadAheadBuf == NULL )
+    {
+        IotLogDebug( "Ignoring %d bytes received beyond the end of the response.", dataLen );
+    }
+    else
+    {
+        /* This data was either returned from the read-ahead buffer, or read from the network with a read limited to
+         * the size of the read-ahead buffer in _networkRecv(), so it always fits back in. */
+        memmove( pHttpsConnection->pReadAheadBuf + dataLen,
+                 pHttpsConnection->pReadAheadBuf,
+                 pHttpsConnection->readAheadCount );
+        memcpy( pHttpsConnection->pReadAheadBuf, pData, dataLen );
+        pHttpsConnection->readAheadCount += dataLen;
+
+        IotLogDebug( "Keeping %d bytes of the next pipelined response.", dataLen );
+    }
+}
+
+/*-----------------------------------------------------------*/
+
 static void _incrementNextLocationToWriteBeyondParsed( uint8_t ** pBufCur,
                                                        uint8_t ** pBufEnd )
 {
@@ -1763,11 +1875,16 @@ static IotHttpsReturnCode_t _receiveHttpsMessage( _httpsConnection_t * pHttpsCon
     HTTPS_FUNCTION_ENTRY( IOT_HTTPS_OK );
 
     size_t numBytesRecv = 0;
+    size_t parsedBytes = 0;
+    uint8_t * pBufStart = NULL;
 
     /* The final parser state is either the end of the header lines or the end of the entity body. This state is set in
      * the http-parser callbacks. */
     while( ( *pCurrentParserState < finalParserState ) && ( *pBufEnd - *pBufCur > 0 ) )
     {
+        /* The http-parser callbacks move *pBufCur, so remember where this data starts. */
+        pBufStart = *pBufCur;
+
         status = _networkRecv( pHttpsConnection,
                                *pBufCur,
                                *pBufEnd - *pBufCur,
@@ -1781,7 +1898,7 @@ static IotHttpsReturnCode_t _receiveHttpsMessage( _httpsConnection_t * pHttpsCon
             break;
         }
 
-        status = _parseHttpsMessage( pHttpParserInfo, ( char * ) ( *pBufCur ), numBytesRecv );
+        status = _parseHttpsMessage( pHttpParserInfo, ( char * ) ( *pBufCur ), numBytesRecv, &parsedBytes );
 
         if( HTTPS_FAILED( status ) )
         {
@@ -1789,6 +1906,12 @@ static IotHttpsReturnCode_t _receiveHttpsMessage( _httpsConnection_t * pHttpsCon
             break;
         }
 
+        /* The parser stops at the end of the message. Anything received after it belongs to the next response. */
+        if( ( *pCurrentParserState == PARSER_STATE_BODY_COMPLETE ) && ( parsedBytes < numBytesRecv ) )
+        {
+            _saveReadAheadData( pHttpsConnection, pBufStart + parsedBytes, numBytesRecv - parsedBytes );
+        }
+
         /* If the current buffer being filled is the header buffer, then \r\n header line separators should not get
          * overwritten on the next network read. See _incrementNextLocationToWriteBeyondParsed() for more
          * information. */
@@ -1889,6 +2012,7 @@ static IotHttpsReturnCode_t _flushHttpsNetworkData( _httpsConnection_t * pHttpsC
     IotHttpsReturnCode_t parserStatus = IOT_HTTPS_OK;
     IotHttpsReturnCode_t networkStatus = IOT_HTTPS_OK;
     size_t numBytesRecv = 0;
+    size_t parsedBytes = 0;
 
     /* Disable -Wunused-but-set-variable for local variables used for logging. */
     ( void ) pHttpParserErrorDescription;
@@ -1901,7 +2025,7 @@ static IotHttpsReturnCode_t _flushHttpsNetworkData( _httpsConnection_t * pHttpsC
 
         /* Run this through the parser so that we can get the end of the HTTP message, instead of simply timing out the socket to stop.
          * If we relied on the socket timeout to stop reading the network socket, then the server may close the connection. */
-        parserStatus = _parseHttpsMessage( &( pHttpsResponse->httpParserInfo ), ( char * ) flushBuffer, numBytesRecv );
+        parserStatus = _parseHttpsMessage( &( pHttpsResponse->httpParserInfo ), ( char * ) flushBuffer, numBytesRecv, &parsedBytes );
 
         if( HTTPS_FAILED( parserStatus ) )
         {
@@ -1912,6 +2036,12 @@ static IotHttpsReturnCode_t _flushHttpsNetworkData( _httpsConnection_t * pHttpsC
             break;
         }
 
+        /* Do not flush away the start of the next pipelined response. */
+        if( ( pHttpsResponse->parserState == PARSER_STATE_BODY_COMPLETE ) && ( parsedBytes < numBytesRecv ) )
+        {
+            _saveReadAheadData( pHttpsConnection, flushBuffer + parsedBytes, numBytesRecv - parsedBytes );
+        }
+
         /* If there is a network error then we want to stop clearing out the buffer. */
         if( HTTPS_FAILED( networkStatus ) )
         {
@@ -2177,11 +2307,106 @@ static void _sendHttpsRequest( _httpsRequest_t * pHttpsRequest )
     IotDeQueue_DequeueHead( &( pHttpsConnection->reqQ ) );
     IotMutex_Unlock( &( pHttpsConnection->connectionMutex ) );
 
+    /* On a pipelined connection, the next request can be sent before the response to this request is received. This
+     * also schedules the next request if the response was already received before this request was dequeued. */
+    if( HTTPS_SUCCEEDED( status ) )
+    {
+        _scheduleNextHttpsRequest( pHttpsConnection, NULL );
+    }
+
     /* This routine returns a void so there is no HTTPS_FUNCTION_CLEANUP_END();. */
 }
 
 /*-----------------------------------------------------------*/
 
+static bool _canSendNextRequest( _httpsConnection_t * pHttpsConnection,
+                                 _httpsResponse_t * pFinishedResponse )
+{
+    _httpsResponse_t * pPendingHttpsResponse = NULL;
+    IotLink_t * pQItem = NULL;
+    uint32_t pendingResponses = 0;
+    bool nonPersistentPending = false;
+
+    /* Count the responses still expected on the connection. The server closes the connection after the response to a
+     * non-persistent request, so no request is sent after it. */
+    IotContainers_ForEach( &( pHttpsConnection->respQ ), pQItem )
+    {
+        pPendingHttpsResponse = IotLink_Container( _httpsResponse_t, pQItem, link );
+
+        if( pPendingHttpsResponse != pFinishedResponse )
+        {
+            pendingResponses++;
+
+            if( pPendingHttpsResponse->isNonPersistent )
+            {
+                nonPersistentPending = true;
+            }
+        }
+    }
+
+    return ( pendingResponses < pHttpsConnection->pipelineDepth ) && ( nonPersistentPending == false );
+}
+
+/*-----------------------------------------------------------*/
+
+static void _scheduleNextHttpsRequest( _httpsConnection_t * pHttpsConnection,
+                                       _httpsResponse_t * pFinishedResponse )
+{
+    IotHttpsReturnCode_t scheduleStatus = IOT_HTTPS_OK;
+    _httpsRequest_t * pNextHttpsRequest = NULL;
+    IotLink_t * pQItem = NULL;
+
+    IotMutex_Lock( &( pHttpsConnection->connectionMutex ) );
+
+    /* Get the next request to process. */
+    pQItem = IotDeQueue_PeekHead( &( pHttpsConnection->reqQ ) );
+
+    if( pQItem != NULL )
+    {
+        pNextHttpsRequest = IotLink_Container( _httpsRequest_t, pQItem, link );
+
+        /* Mark the request as scheduled while holding the mutex, so that it is not sent twice by concurrent callers. */
+        if( ( pNextHttpsRequest->scheduled == false ) &&
+            ( _canSendNextRequest( pHttpsConnection, pFinishedResponse ) ) )
+        {
+            pNextHttpsRequest->scheduled = true;
+        }
+        else
+        {
+            pNextHttpsRequest = NULL;
+        }
+    }
+
+    IotMutex_Unlock( &( pHttpsConnection->connectionMutex ) );
+
+    if( pNextHttpsRequest != NULL )
+    {
+        IotLogDebug( "Request %p is next in the queue. Now scheduling a task to send the request.", pNextHttpsRequest );
+        scheduleStatus = _scheduleHttpsRequestSend( pNextHttpsRequest );
+
+        /* If there was an error with scheduling the new task, then report it. */
+        if( HTTPS_FAILED( scheduleStatus ) )
+        {
+            IotLogError( "Error scheduling HTTPS request %p. Error code: %d", pNextHttpsRequest, scheduleStatus );
+
+            if( pNextHttpsRequest->isAsync && pNextHttpsRequest->pCallbacks->errorCallback )
+            {
+                pNextHttpsRequest->pCallbacks->errorCallback( pNextHttpsRequest->pUserPrivData, pNextHttpsRequest, NULL, scheduleStatus );
+            }
+            else
+            {
+                pNextHttpsRequest->pHttpsResponse->syncStatus = scheduleStatus;
+            }
+        }
+    }
+    else
+    {
+        IotLogDebug( "No request in the queue can be sent now. A network send task was not scheduled." );
+    }
+}
+
+/*-----------------------------------------------------------*/
+
 static void _dispatchTaskRoutine( void * pParameters )
 {
     ( void ) pParameters;
@@ -2264,17 +2489,21 @@ IotHttpsReturnCode_t _addRequestToConnectionReqQ( _httpsRequest_t * pHttpsReques
     /* Place the request into the queue. */
     IotMutex_Lock( &( pHttpsConnection->connectionMutex ) );
 
-    /* If there is an active response, scheduling the next request at the same time may corrupt the workflow. Part of
-     * the next response for the next request may be present in the currently receiving response's buffers. To avoid
-     * this, check if there are pending responses to determine if this request should be scheduled right away or not.
+    /* If this is the only request in the queue, it is scheduled right away unless it would exceed the pipeline depth
+     * of the connection. Without pipelining, this means that it is scheduled only if there are no pending responses:
+     * part of the next response could otherwise spill into the currently receiving response's buffers.
      *
-     * If there are other requests in the queue, and there are responses in the queue, then the network receive callback
-     * will handle scheduling the next requests (or is already scheduled and currently sending). */
+     * If there are other requests in the queue, then the network receive callback or the dispatch task sending the
+     * previous request will handle scheduling the next requests (or is already scheduled and currently sending). */
     if( ( IotDeQueue_IsEmpty( &( pHttpsConnection->reqQ ) ) ) &&
-        ( IotDeQueue_IsEmpty( &( pHttpsConnection->respQ ) ) ) )
+        ( _canSendNextRequest( pHttpsConnection, NULL ) ) )
     {
-        IotLogDebug( "Both the request and response queue are empty, so schedule the request to run in the dispatch queue." );
+        IotLogDebug( "The request queue is empty and the pipeline has room, so schedule the request to run in the dispatch queue." );
         scheduleRequest = true;
+
+        /* Mark the request as scheduled while holding the mutex, so that it is not scheduled again by a dispatch task
+         * that finishes sending the previous request. */
+        pHttpsRequest->scheduled = true;
     }
 
     /* Place into the connection's request to have a dispatch task serve it later. */
@@ -2684,8 +2913,9 @@ IotHttpsReturnCode_t IotHttpsClient_Disconnect( IotHttpsConnectionHandle_t connH
     }
 
     /* If there is a response in the connection's response queue and the associated request has not finished sending,
-     * then we cannot destroy the connection until it finishes. */
-    pRespItem = IotDeQueue_DequeueHead( &( connHandle->respQ ) );
+     * then we cannot destroy the connection until it finishes. Only the last response in the queue can belong to a
+     * request that is still sending, because requests on a pipelined connection are sent one after another. */
+    pRespItem = IotDeQueue_DequeueTail( &( connHandle->respQ ) );
 
     if( pRespItem != NULL )
     {
@@ -2720,7 +2950,7 @@ IotHttpsReturnCode_t IotHttpsClient_Disconnect( IotHttpsConnectionHandle_t connH
          * call to this routine, the disconnect will succeed. */
         if( pHttpsResponse->reqFinishedSending == false )
         {
-            IotDeQueue_EnqueueHead( &( connHandle->respQ ), pRespItem );
+            IotDeQueue_EnqueueTail( &( connHandle->respQ ), pRespItem );
         }
     }
 
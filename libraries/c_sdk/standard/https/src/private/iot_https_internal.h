@@ -437,6 +437,10 @@ typedef struct _httpsConnection
     IotMutex_t connectionMutex; /**< @brief Mutex protecting operations on this entire connection context. */
     IotDeQueue_t reqQ;          /**< @brief The queue for the requests that are not finished yet. */
     IotDeQueue_t respQ;         /**< @brief The queue for the responses that are waiting to be processed. */
+    uint32_t pipelineDepth;     /**< @brief The maximum number of responses in respQ before the next request is sent. */
+    uint8_t * pReadAheadBuf;    /**< @brief Response data received beyond the end of the previous response. NULL without pipelining. */
+    size_t readAheadBufLen;     /**< @brief The size of pReadAheadBuf. */
+    size_t readAheadCount;      /**< @brief The number of bytes at the start of pReadAheadBuf that are not processed yet. */
 } _httpsConnection_t;
 
 /**
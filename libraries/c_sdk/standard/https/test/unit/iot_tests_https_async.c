@@ -110,6 +110,20 @@ static IotHttpsResponseInfo_t _pAsyncRespInfos[ HTTPS_TEST_MAX_ASYNC_REQUESTS ]
 static IotHttpsRequestHandle_t _pAsyncRequestHandles[ HTTPS_TEST_MAX_ASYNC_REQUESTS ];   /**< @brief Request handles for scheduling multiple requests. */
 static IotHttpsResponseHandle_t _pAsyncResponseHandles[ HTTPS_TEST_MAX_ASYNC_REQUESTS ]; /**< @brief Response handles for scheduling multiple requests. */
 
+/**
+ * @brief Connection user buffer for the pipelined connection tests.
+ *
+ * The space after the connection context is used by the library to hold read-ahead response data.
+ */
+static uint8_t _pPipelinedConnUserBuffer[ HTTPS_TEST_CONN_USER_BUFFER_SIZE + HTTPS_TEST_RESPONSE_MESSAGE_LENGTH ] = { 0 };
+
+/**
+ * @brief The number of request bodies sent on a pipelined connection.
+ *
+ * This is reset during TEST_SETUP.
+ */
+static int _pipelinedBodySendCount = 0;
+
 /**
  * @brief A base IotHttpsAsyncInfo_t to copy to each of the request information configurations for each request.
  *
@@ -219,6 +233,64 @@ static size_t _networkSendSuccess( void * pConnection,
 
 /*-----------------------------------------------------------*/
 
+/**
+ * @brief thread that invokes the _networkReceiveCallback internal to the library for a pipelined connection.
+ *
+ * The network abstraction keeps invoking the receive callback while there is unread data on the socket. The library
+ * itself continues with data it has already read ahead into the connection user buffer.
+ */
+static void _invokePipelinedNetworkReceiveCallback( void * pArgument )
+{
+    void * pNetworkConnection = pArgument;
+    _httpsRequest_t * pHttpsRequest = ( _httpsRequest_t * ) pNetworkConnection;
+    int invokeCount = 0;
+
+    _nextRespMessageBufferByteToReceive = 0;
+
+    /* Sleep for a bit to wait for the last request to finish sending and simulate the network responses. */
+    IotClock_SleepMs( HTTPS_TEST_NETWORK_RECEIVE_CALLBACK_WAIT_MS );
+
+    /* A response can be processed at most once per callback, so bound the invocations by the number of requests. */
+    while( ( _nextRespMessageBufferByteToReceive < strlen( ( char * ) _pRespMessageBuffer ) ) &&
+           ( invokeCount < HTTPS_TEST_MAX_ASYNC_REQUESTS ) )
+    {
+        IotTestHttps_networkReceiveCallback( pNetworkConnection, pHttpsRequest->pHttpsConnection );
+        invokeCount++;
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Network abstraction send function for a pipelined connection.
+ *
+ * The responses are not made available until all of the requests have been sent, so this only succeeds when the
+ * library keeps multiple requests in flight on the connection.
+ */
+static size_t _networkSendPipelined( void * pConnection,
+                                     const uint8_t * pMessage,
+                                     size_t messageLength )
+{
+    _httpsRequest_t * pHttpsRequest = ( _httpsRequest_t * ) pConnection;
+
+    if( pHttpsRequest->pBody == pMessage )
+    {
+        _pipelinedBodySendCount++;
+
+        if( _pipelinedBodySendCount == HTTPS_TEST_MAX_ASYNC_REQUESTS )
+        {
+            Iot_CreateDetachedThread( _invokePipelinedNetworkReceiveCallback,
+                                      pConnection,
+                                      IOT_THREAD_DEFAULT_PRIORITY,
+                                      IOT_THREAD_DEFAULT_STACK_SIZE );
+        }
+    }
+
+    return messageLength;
+}
+
+/*-----------------------------------------------------------*/
+
 /**
  * @brief Network abstraction send function that fails sending the HTTP headers.
  */
@@ -704,6 +776,7 @@ TEST_SETUP( HTTPS_Client_Unit_Async )
     ( void ) memset( &_networkInterface, 0x00, sizeof( IotNetworkInterface_t ) );
     ( void ) memset( _pRespMessageBuffer, 0x00, sizeof( _pRespMessageBuffer ) );
     _nextRespMessageBufferByteToReceive = 0;
+    _pipelinedBodySendCount = 0;
 }
 
 /*-----------------------------------------------------------*/
@@ -742,6 +815,7 @@ TEST_GROUP_RUNNER( HTTPS_Client_Unit_Async )
     RUN_TEST_CASE( HTTPS_Client_Unit_Async, SendAsyncCancelDuringWriteCallback );
     RUN_TEST_CASE( HTTPS_Client_Unit_Async, SendAsyncCancelDuringReadReadyCallback );
     RUN_TEST_CASE( HTTPS_Client_Unit_Async, SendAsyncMultipleRequestsSuccess );
+    RUN_TEST_CASE( HTTPS_Client_Unit_Async, SendAsyncPipelinedRequestsSuccess );
     RUN_TEST_CASE( HTTPS_Client_Unit_Async, SendAsyncMultipleRequestsSecondHasNetworkSendFailure );
     RUN_TEST_CASE( HTTPS_Client_Unit_Async, SendAsyncMultipleRequestsFirstHasNetworkReceiveFailure );
     RUN_TEST_CASE( HTTPS_Client_Unit_Async, SendAsyncMultipleRequestsFirstHasParsingFailure );
@@ -1616,6 +1690,81 @@ TEST( HTTPS_Client_Unit_Async, SendAsyncMultipleRequestsSuccess )
 
 /*-----------------------------------------------------------*/
 
+/**
+ * @brief Verify that all requests are sent before any response is received on a pipelined connection, and that the
+ * responses read back-to-back from the network are matched to their requests in order.
+ */
+TEST( HTTPS_Client_Unit_Async, SendAsyncPipelinedRequestsSuccess )
+{
+    IotHttpsReturnCode_t returnCode = IOT_HTTPS_OK;
+    IotHttpsConnectionHandle_t connHandle = IOT_HTTPS_CONNECTION_HANDLE_INITIALIZER;
+    IotHttpsConnectionInfo_t pipelinedConnInfo = _connInfo;
+    size_t responseLength = 0;
+    int reqIndex = 0;
+
+    _networkInterface.create = _networkCreateSuccess;
+    _networkInterface.setReceiveCallback = _setReceiveCallbackSuccess;
+    _networkInterface.send = _networkSendPipelined;
+    _networkInterface.receiveUpto = _networkReceiveSuccess;
+    _networkInterface.close = _networkCloseSuccess;
+    _networkInterface.destroy = _networkDestroySuccess;
+
+    pipelinedConnInfo.userBuffer.pBuffer = _pPipelinedConnUserBuffer;
+    pipelinedConnInfo.userBuffer.bufferLen = sizeof( _pPipelinedConnUserBuffer );
+    pipelinedConnInfo.pipelineDepth = HTTPS_TEST_MAX_ASYNC_REQUESTS;
+
+    returnCode = IotHttpsClient_Connect( &connHandle, &pipelinedConnInfo );
+    TEST_ASSERT_EQUAL( IOT_HTTPS_OK, returnCode );
+    TEST_ASSERT_NOT_NULL( connHandle );
+
+    for( reqIndex = 0; reqIndex < HTTPS_TEST_MAX_ASYNC_REQUESTS; reqIndex++ )
+    {
+        _pAsyncRequestHandles[ reqIndex ] = _getReqHandle( &( _pAsyncReqInfos[ reqIndex ] ) );
+        TEST_ASSERT_NOT_NULL( _pAsyncRequestHandles[ reqIndex ] );
+    }
+
+    _verifParams.numRequestsTotal = HTTPS_TEST_MAX_ASYNC_REQUESTS;
+    _verifParams.numRequestsLeft = HTTPS_TEST_MAX_ASYNC_REQUESTS;
+
+    /* Generate one response per request, back-to-back in the same network stream. The body fits in a single
+     * readReadyCallback so that the responses are not split by the test. */
+    _generateHttpResponseMessage( HTTPS_TEST_RESP_HEADER_BUFFER_LENGTH, HTTPS_TEST_RESP_BODY_BUFFER_SIZE / 4 );
+    responseLength = strlen( ( char * ) _pRespMessageBuffer );
+    TEST_ASSERT_LESS_THAN( HTTPS_TEST_RESPONSE_MESSAGE_LENGTH, responseLength * HTTPS_TEST_MAX_ASYNC_REQUESTS );
+
+    for( reqIndex = 1; reqIndex < HTTPS_TEST_MAX_ASYNC_REQUESTS; reqIndex++ )
+    {
+        memcpy( &( _pRespMessageBuffer[ responseLength * reqIndex ] ), _pRespMessageBuffer, responseLength );
+    }
+
+    /* Schedule all of the requests. */
+    for( reqIndex = 0; reqIndex < HTTPS_TEST_MAX_ASYNC_REQUESTS; reqIndex++ )
+    {
+        returnCode = IotHttpsClient_SendAsync( connHandle,
+                                               _pAsyncRequestHandles[ reqIndex ],
+                                               &( _pAsyncResponseHandles[ reqIndex ] ),
+                                               &( _pAsyncRespInfos[ reqIndex ] ) );
+        TEST_ASSERT_EQUAL( IOT_HTTPS_OK, returnCode );
+    }
+
+    /* Wait on the async requests to finish. */
+    TEST_ASSERT_TRUE( IotSemaphore_TimedWait( &( _verifParams.completeSem ), HTTPS_TEST_ASYNC_TIMEOUT_MS ) );
+
+    for( reqIndex = 0; reqIndex < HTTPS_TEST_MAX_ASYNC_REQUESTS; reqIndex++ )
+    {
+        TEST_ASSERT_EQUAL( IOT_HTTPS_OK, _verifParams.returnCode[ reqIndex ] );
+    }
+
+    TEST_ASSERT_EQUAL( HTTPS_TEST_MAX_ASYNC_REQUESTS, _pipelinedBodySendCount );
+    TEST_ASSERT_EQUAL( HTTPS_TEST_MAX_ASYNC_REQUESTS, _verifParams.readReadyCallbackCount );
+    TEST_ASSERT_EQUAL( HTTPS_TEST_MAX_ASYNC_REQUESTS, _verifParams.responseCompleteCallbackCount );
+    TEST_ASSERT_EQUAL( 0, _verifParams.errorCallbackCount );
+    TEST_ASSERT_EQUAL( responseLength * HTTPS_TEST_MAX_ASYNC_REQUESTS, _nextRespMessageBufferByteToReceive );
+    TEST_ASSERT_EQUAL( 0, connHandle->readAheadCount );
+}
+
+/*-----------------------------------------------------------*/
+
 /**
  * @brief Verify that all pending requests after are not sent when the first request on the connection has a network
  * send failure.
@@ -396,6 +396,16 @@ TEST( HTTPS_Client_Unit_API, ConnectInvalidParameters )
     /* Restore the testConnInfo for the next test. */
     testConnInfo.userBuffer.bufferLen = pOriginalConnInfo->userBuffer.bufferLen;
 
+    /* IotHttpsConnectionInfo_t.pipelineDepth > 1 without space for read-ahead data in the user buffer. */
+    testConnInfo.userBuffer.bufferLen = connectionUserBufferMinimumSize;
+    testConnInfo.pipelineDepth = 2;
+    returnCode = IotHttpsClient_Connect( &connHandle, &testConnInfo );
+    TEST_ASSERT_NULL( connHandle );
+    TEST_ASSERT_EQUAL( IOT_HTTPS_INSUFFICIENT_MEMORY, returnCode );
+    /* Restore the testConnInfo for the next test. */
+    testConnInfo.userBuffer.bufferLen = pOriginalConnInfo->userBuffer.bufferLen;
+    testConnInfo.pipelineDepth = pOriginalConnInfo->pipelineDepth;
+
     /* NULL IotHttpsConnectionInfo_t.pAddress in pConnConfig.  */
     testConnInfo.pAddress = NULL;
     returnCode = IotHttpsClient_Connect( &connHandle, &testConnInfo );
@@ -64,6 +64,8 @@
  * @function_brief{mqtt_function_publish}
  * - @function_name{mqtt_function_timedpublish}
  * @function_brief{mqtt_function_timedpublish}
+ * - @function_name{mqtt_function_publishbatch}
+ * @function_brief{mqtt_function_publishbatch}
  * - @function_name{mqtt_function_wait}
  * @function_brief{mqtt_function_wait}
  * - @function_name{mqtt_function_strerror}
@@ -72,6 +74,12 @@
  * @function_brief{mqtt_function_operationtype}
  * - @function_name{mqtt_function_issubscribed}
  * @function_brief{mqtt_function_issubscribed}
+ * - @function_name{mqtt_function_retainmessage}
+ * @function_brief{mqtt_function_retainmessage}
+ * - @function_name{mqtt_function_releasemessage}
+ * @function_brief{mqtt_function_releasemessage}
+ * - @function_name{mqtt_function_getreceivepoolstatus}
+ * @function_brief{mqtt_function_getreceivepoolstatus}
  */
 
 /**
@@ -108,6 +116,9 @@
  * @page mqtt_function_timedpublish IotMqtt_TimedPublish
  * @snippet this declare_mqtt_timedpublish
  * @copydoc IotMqtt_TimedPublish
+ * @page mqtt_function_publishbatch IotMqtt_PublishBatch
+ * @snippet this declare_mqtt_publishbatch
+ * @copydoc IotMqtt_PublishBatch
  * @page mqtt_function_wait IotMqtt_Wait
  * @snippet this declare_mqtt_wait
  * @copydoc IotMqtt_Wait
@@ -120,6 +131,15 @@
  * @page mqtt_function_issubscribed IotMqtt_IsSubscribed
  * @snippet this declare_mqtt_issubscribed
  * @copydoc IotMqtt_IsSubscribed
+ * @page mqtt_function_retainmessage IotMqtt_RetainMessage
+ * @snippet this declare_mqtt_retainmessage
+ * @copydoc IotMqtt_RetainMessage
+ * @page mqtt_function_releasemessage IotMqtt_ReleaseMessage
+ * @snippet this declare_mqtt_releasemessage
+ * @copydoc IotMqtt_ReleaseMessage
+ * @page mqtt_function_getreceivepoolstatus IotMqtt_GetReceivePoolStatus
+ * @snippet this declare_mqtt_getreceivepoolstatus
+ * @copydoc IotMqtt_GetReceivePoolStatus
  */
 
 /**
@@ -728,6 +748,74 @@ IotMqttError_t IotMqtt_TimedPublish( IotMqttConnection_t mqttConnection,
                                      uint32_t timeoutMs );
 /* @[declare_mqtt_timedpublish] */
 
+/**
+ * @brief Publish a list of messages, coalescing their PUBLISH packets into as
+ * few network sends as possible.
+ *
+ * This function behaves like calling @ref mqtt_function_publish for every entry
+ * of `pPublishInfoList`, but the messages are serialized back-to-back into the
+ * connection's network buffer under a single acquisition of the connection lock,
+ * and the buffer is sent whenever it fills. Messages are sent in rounds of
+ * `IOT_MQTT_PUBLISH_BATCH_ROUND_SIZE` and in the order given. A message too
+ * large for the network buffer is sent on its own.
+ *
+ * All PUBLISH information is validated before any message is sent. If sending
+ * fails part way, the messages before the failure remain queued and the rest
+ * are not sent.
+ *
+ * @attention QoS 2 messages are currently unsupported. Only 0 or 1 are valid
+ * for message QoS.
+ *
+ * @param[in] mqttConnection The MQTT connection to use for the publishes.
+ * @param[in] pPublishInfoList Array of MQTT publish parameters.
+ * @param[in] publishCount Number of entries in `pPublishInfoList`.
+ * @param[in] flags Flags which modify the behavior of this function. See @ref mqtt_constants_flags.
+ * #IOT_MQTT_FLAG_WAITABLE only applies to QoS 1 messages.
+ * @param[out] pPublishOperations Optional array of `publishCount` handles. Each
+ * QoS 1 entry is set to a handle by which its operation may be referenced; QoS 0
+ * entries and entries that were not sent are set to #IOT_MQTT_OPERATION_INITIALIZER.
+ * Required if #IOT_MQTT_FLAG_WAITABLE is set.
+ *
+ * @return #IOT_MQTT_STATUS_PENDING if at least one QoS 1 message was queued;
+ * #IOT_MQTT_SUCCESS if all messages were QoS 0 and sent. Otherwise, one of:
+ * - #IOT_MQTT_BAD_PARAMETER
+ * - #IOT_MQTT_NO_MEMORY
+ * - #IOT_MQTT_NETWORK_ERROR
+ *
+ * <b>Example</b>
+ * @code{c}
+ * // An initialized and connected MQTT connection.
+ * IotMqttConnection_t mqttConnection;
+ *
+ * // Several QoS 0 telemetry samples on the same topic.
+ * IotMqttPublishInfo_t publishInfo[ 4 ] = { IOT_MQTT_PUBLISH_INFO_INITIALIZER };
+ * size_t i = 0;
+ *
+ * for( i = 0; i < 4; i++ )
+ * {
+ *     publishInfo[ i ].qos = IOT_MQTT_QOS_0;
+ *     publishInfo[ i ].pTopicName = "some/topic/name";
+ *     publishInfo[ i ].topicNameLength = 15;
+ *     publishInfo[ i ].pPayload = pSamples[ i ];
+ *     publishInfo[ i ].payloadLength = sampleLength;
+ * }
+ *
+ * // A batch of QoS 0 publishes returns IOT_MQTT_SUCCESS upon success.
+ * IotMqttError_t result = IotMqtt_PublishBatch( mqttConnection,
+ *                                               publishInfo,
+ *                                               4,
+ *                                               0,
+ *                                               NULL );
+ * @endcode
+ */
+/* @[declare_mqtt_publishbatch] */
+IotMqttError_t IotMqtt_PublishBatch( IotMqttConnection_t mqttConnection,
+                                     const IotMqttPublishInfo_t * pPublishInfoList,
+                                     size_t publishCount,
+                                     uint32_t flags,
+                                     IotMqttOperation_t * pPublishOperations );
+/* @[declare_mqtt_publishbatch] */
+
 /**
  * @brief Waits for an operation to complete.
  *
@@ -866,4 +954,79 @@ bool IotMqtt_IsSubscribed( IotMqttConnection_t mqttConnection,
                            IotMqttSubscription_t * pCurrentSubscription );
 /* @[declare_mqtt_issubscribed] */
 
+/**
+ * @brief Keep the buffer of an incoming PUBLISH message after its subscription
+ * callback returns.
+ *
+ * Incoming PUBLISH messages are received into a buffer borrowed from the receive
+ * buffer pool, and the topic name and payload of `pCallbackParam->u.message.info`
+ * point into this buffer. Normally, the buffer is given back to the pool as soon as
+ * all subscription callbacks return. This function adds a reference to the buffer
+ * so that the topic name and payload remain valid, without being copied, until
+ * @ref mqtt_function_releasemessage is called.
+ *
+ * This function may only be called from a subscription callback.
+ *
+ * @param[in] pCallbackParam The parameter of the subscription callback.
+ *
+ * @return A handle to pass to @ref mqtt_function_releasemessage; `NULL` if the
+ * message has no buffer to retain.
+ *
+ * @warning Every successful call to this function must be matched by a call to
+ * @ref mqtt_function_releasemessage. A retained buffer is not available for other
+ * incoming packets.
+ *
+ * <b>Example</b>
+ * @code{c}
+ * // A subscription callback that hands the message to another task.
+ * void subscriptionCallback( void * pCallbackContext,
+ *                            IotMqttCallbackParam_t * pCallbackParam )
+ * {
+ *     IotMqttMessageBuffer_t buffer = IotMqtt_RetainMessage( pCallbackParam );
+ *
+ *     if( buffer != NULL )
+ *     {
+ *         // The other task calls IotMqtt_ReleaseMessage( buffer ) when it is done
+ *         // with pCallbackParam->u.message.info.pPayload.
+ *         queueMessage( pCallbackContext, &( pCallbackParam->u.message.info ), buffer );
+ *     }
+ * }
+ * @endcode
+ */
+/* @[declare_mqtt_retainmessage] */
+IotMqttMessageBuffer_t IotMqtt_RetainMessage( const IotMqttCallbackParam_t * pCallbackParam );
+/* @[declare_mqtt_retainmessage] */
+
+/**
+ * @brief Give back the buffer of an incoming PUBLISH message kept with
+ * @ref mqtt_function_retainmessage.
+ *
+ * The topic name and payload of the message must not be used after this function
+ * is called.
+ *
+ * @param[in] messageBuffer The handle returned by @ref mqtt_function_retainmessage.
+ * `NULL` is ignored.
+ */
+/* @[declare_mqtt_releasemessage] */
+void IotMqtt_ReleaseMessage( IotMqttMessageBuffer_t messageBuffer );
+/* @[declare_mqtt_releasemessage] */
+
+/**
+ * @brief Report the occupancy of the receive buffer pool.
+ *
+ * The receive buffer pool is shared by all MQTT connections. The sizes and
+ * counts of its buffers are set with the `IOT_MQTT_RECEIVE_POOL_*` configuration
+ * settings. The pool is empty unless these settings give it buffers, in which
+ * case every packet counts as a heap allocation.
+ *
+ * @param[out] pStatus Set to the current occupancy of the pool.
+ *
+ * @return One of the following:
+ * - #IOT_MQTT_SUCCESS
+ * - #IOT_MQTT_BAD_PARAMETER
+ */
+/* @[declare_mqtt_getreceivepoolstatus] */
+IotMqttError_t IotMqtt_GetReceivePoolStatus( IotMqttReceivePoolStatus_t * pStatus );
+/* @[declare_mqtt_getreceivepoolstatus] */
+
 #endif /* ifndef IOT_MQTT_H_ */
@@ -68,7 +68,7 @@
  *
  * @initializer{IotMqttConnection_t,IOT_MQTT_CONNECTION_INITIALIZER}
  */
-typedef struct _mqttConnection   * IotMqttConnection_t;
+typedef struct _mqttConnection      * IotMqttConnection_t;
 
 /**
  * @ingroup mqtt_datatypes_handles
@@ -90,7 +90,22 @@ typedef struct _mqttConnection   * IotMqttConnection_t;
  * #IotMqttCallbackInfo_t and #IotMqttCallbackParam_t for an asynchronous notification
  * of completion.
  */
-typedef struct _mqttOperation    * IotMqttOperation_t;
+typedef struct _mqttOperation       * IotMqttOperation_t;
+
+/**
+ * @ingroup mqtt_datatypes_handles
+ * @brief Opaque handle that references the buffer of an incoming PUBLISH message.
+ *
+ * Incoming PUBLISH messages are received into buffers borrowed from a pool, and
+ * the [message parameters](@ref IotMqttCallbackParam_t) given to a subscription
+ * callback point into this buffer. A subscription callback may keep the buffer
+ * after returning by calling @ref mqtt_function_retainmessage. The topic name and
+ * payload of the message remain valid until the buffer is given back with
+ * @ref mqtt_function_releasemessage.
+ *
+ * @initializer{IotMqttMessageBuffer_t,IOT_MQTT_MESSAGE_BUFFER_INITIALIZER}
+ */
+typedef struct _mqttReceiveBuffer * IotMqttMessageBuffer_t;
 
 /*-------------------------- MQTT enumerated types --------------------------*/
 
@@ -428,6 +443,8 @@ typedef struct IotMqttPublishInfo
  * the [callback function](@ref IotMqttCallbackInfo_t.function) returns.
  * Therefore, data must be copied if it is needed after the callback function
  * returns.
+ * The exception are the topic name and payload of an incoming PUBLISH, which
+ * may be kept without copying by calling @ref mqtt_function_retainmessage.
  * @attention The MQTT library may set strings that are not NULL-terminated.
  *
  * @see #IotMqttCallbackInfo_t for the signature of a callback function.
@@ -459,9 +476,10 @@ typedef struct IotMqttCallbackParam
         /* Valid for incoming PUBLISH messages. */
         struct
         {
-            const char * pTopicFilter;  /**< @brief Topic filter that matched the message. */
-            uint16_t topicFilterLength; /**< @brief Length of `pTopicFilter`. */
-            IotMqttPublishInfo_t info;  /**< @brief PUBLISH message received from the server. */
+            const char * pTopicFilter;     /**< @brief Topic filter that matched the message. */
+            uint16_t topicFilterLength;    /**< @brief Length of `pTopicFilter`. */
+            IotMqttPublishInfo_t info;     /**< @brief PUBLISH message received from the server. */
+            IotMqttMessageBuffer_t buffer; /**< @brief The buffer holding `info`; see @ref mqtt_function_retainmessage. */
         } message;
 
         /* Valid when a connection is disconnected. */
@@ -997,6 +1015,53 @@ typedef struct IotMqttNetworkInfo
     #endif
 } IotMqttNetworkInfo_t;
 
+/**
+ * @brief Number of size classes of the receive buffer pool.
+ */
+#define IOT_MQTT_RECEIVE_POOL_CLASSES    ( 3 )
+
+/**
+ * @ingroup mqtt_datatypes_paramstructs
+ * @brief Occupancy of one size class of the receive buffer pool.
+ *
+ * @paramfor @ref mqtt_function_getreceivepoolstatus
+ */
+typedef struct IotMqttReceivePoolClassStatus
+{
+    size_t bufferSize;    /**< @brief Size of each buffer of this size class. */
+    uint32_t bufferCount; /**< @brief Number of buffers of this size class. */
+    uint32_t inUse;       /**< @brief Number of buffers currently borrowed. */
+    uint32_t maxInUse;    /**< @brief Largest number of buffers borrowed at once. */
+    uint32_t allocations; /**< @brief Number of times a buffer was borrowed. */
+
+    /**
+     * @brief Number of packets that fit this size class but found no free buffer
+     * in it, and were received into a larger size class or the heap instead.
+     */
+    uint32_t exhausted;
+} IotMqttReceivePoolClassStatus_t;
+
+/**
+ * @ingroup mqtt_datatypes_paramstructs
+ * @brief Occupancy of the receive buffer pool shared by all MQTT connections.
+ *
+ * @paramfor @ref mqtt_function_getreceivepoolstatus
+ *
+ * A high #IotMqttReceivePoolClassStatus_t.exhausted count or a high
+ * #IotMqttReceivePoolStatus_t.heapAllocations count means that the pool should be
+ * made larger with the `IOT_MQTT_RECEIVE_POOL_*` configuration settings.
+ */
+typedef struct IotMqttReceivePoolStatus
+{
+    /**
+     * @brief The size classes of the pool, smallest first. Size classes with no
+     * buffers have a #IotMqttReceivePoolClassStatus_t.bufferCount of 0.
+     */
+    IotMqttReceivePoolClassStatus_t sizeClass[ IOT_MQTT_RECEIVE_POOL_CLASSES ];
+    uint32_t heapAllocations; /**< @brief Number of packets that did not fit any free buffer of the pool. */
+    uint32_t heapInUse;       /**< @brief Number of buffers allocated outside the pool that are currently in use. */
+} IotMqttReceivePoolStatus_t;
+
 /*------------------------- MQTT defined constants --------------------------*/
 
 /**
@@ -1026,6 +1091,7 @@ typedef struct IotMqttNetworkInfo
  * IotMqttCallbackInfo_t callbackInfo = IOT_MQTT_CALLBACK_INFO_INITIALIZER;
  * IotMqttConnection_t connection = IOT_MQTT_CONNECTION_INITIALIZER;
  * IotMqttOperation_t operation = IOT_MQTT_OPERATION_INITIALIZER;
+ * IotMqttMessageBuffer_t buffer = IOT_MQTT_MESSAGE_BUFFER_INITIALIZER;
  * @endcode
  *
  * @section mqtt_constants_flags MQTT Function Flags
@@ -1061,6 +1127,8 @@ typedef struct IotMqttNetworkInfo
 #define IOT_MQTT_CONNECTION_INITIALIZER       NULL
 /** @brief Initializer for #IotMqttOperation_t. */
 #define IOT_MQTT_OPERATION_INITIALIZER        NULL
+/** @brief Initializer for #IotMqttMessageBuffer_t. */
+#define IOT_MQTT_MESSAGE_BUFFER_INITIALIZER   NULL
 /* @[define_mqtt_initializers] */
 
 /**
@@ -719,9 +719,7 @@ static IotMqttError_t _subscriptionCommon( IotMqttOperationType_t operation,
 
         /* Transfer to pending response list. */
         IotListDouble_Remove( &( pSubscriptionOperation->link ) );
-        IotListDouble_InsertHead( &( mqttConnection->pendingResponse ),
-                                  &( pSubscriptionOperation->link ) );
-
+        _IotMqtt_InsertPendingResponse( pSubscriptionOperation );
 
         /* Processing operation after sending it on the network. */
         _IotMqtt_ProcessOperation( pSubscriptionOperation );
@@ -1495,6 +1493,7 @@ void IotMqtt_Disconnect( IotMqttConnection_t mqttConnection,
     IotListDouble_RemoveAll( &( mqttConnection->pendingResponse ),
                              _mqttOperation_tryDestroy,
                              offsetof( _mqttOperation_t, link ) );
+    _IotMqtt_ClearPendingResponseIndex( mqttConnection );
 
     IotMutex_Unlock( &( mqttConnection->referencesMutex ) );
 
@@ -1868,6 +1867,207 @@ IotMqttError_t IotMqtt_TimedPublish( IotMqttConnection_t mqttConnection,
 
 /*-----------------------------------------------------------*/
 
+IotMqttError_t IotMqtt_PublishBatch( IotMqttConnection_t mqttConnection,
+                                     const IotMqttPublishInfo_t * pPublishInfoList,
+                                     size_t publishCount,
+                                     uint32_t flags,
+                                     IotMqttOperation_t * pPublishOperations )
+{
+    IOT_FUNCTION_ENTRY( IotMqttError_t, IOT_MQTT_SUCCESS );
+    _mqttOperation_t * pOperations[ IOT_MQTT_PUBLISH_BATCH_ROUND_SIZE ] = { NULL };
+    const IotMqttPublishInfo_t * pRoundInfo = NULL;
+    size_t roundStart = 0, roundCount = 0, createdCount = 0, sentCount = 0, totalSent = 0, i = 0;
+    bool qos1Sent = false;
+
+    if( ( mqttConnection == NULL ) || ( pPublishInfoList == NULL ) || ( publishCount == 0U ) )
+    {
+        IotLogError( "MQTT connection and a non-empty PUBLISH list must be provided for a PUBLISH batch." );
+
+        IOT_SET_AND_GOTO_CLEANUP( IOT_MQTT_BAD_PARAMETER );
+    }
+    else
+    {
+        EMPTY_ELSE_MARKER;
+    }
+
+    /* Check that a reference array is provided for waitable operations. */
+    if( ( ( flags & IOT_MQTT_FLAG_WAITABLE ) == IOT_MQTT_FLAG_WAITABLE ) &&
+        ( pPublishOperations == NULL ) )
+    {
+        IotLogError( "References must be provided for a waitable PUBLISH batch." );
+
+        IOT_SET_AND_GOTO_CLEANUP( IOT_MQTT_BAD_PARAMETER );
+    }
+    else
+    {
+        EMPTY_ELSE_MARKER;
+    }
+
+    /* Check all PUBLISH information before sending anything. */
+    for( i = 0; i < publishCount; i++ )
+    {
+        if( _IotMqtt_ValidatePublish( mqttConnection->awsIotMqttMode,
+                                      &( pPublishInfoList[ i ] ) ) == false )
+        {
+            IotLogError( "(MQTT connection %p) PUBLISH %lu of batch is invalid.",
+                         mqttConnection,
+                         ( unsigned long ) i );
+
+            IOT_SET_AND_GOTO_CLEANUP( IOT_MQTT_BAD_PARAMETER );
+        }
+        else
+        {
+            EMPTY_ELSE_MARKER;
+        }
+
+        if( pPublishOperations != NULL )
+        {
+            pPublishOperations[ i ] = IOT_MQTT_OPERATION_INITIALIZER;
+        }
+        else
+        {
+            EMPTY_ELSE_MARKER;
+        }
+    }
+
+    /* Send the batch in rounds, each of which takes the MQTT context mutex once. */
+    for( roundStart = 0; ( roundStart < publishCount ) && ( status == IOT_MQTT_SUCCESS ); roundStart += roundCount )
+    {
+        pRoundInfo = &( pPublishInfoList[ roundStart ] );
+        roundCount = publishCount - roundStart;
+
+        if( roundCount > IOT_MQTT_PUBLISH_BATCH_ROUND_SIZE )
+        {
+            roundCount = IOT_MQTT_PUBLISH_BATCH_ROUND_SIZE;
+        }
+        else
+        {
+            EMPTY_ELSE_MARKER;
+        }
+
+        /* Create the PUBLISH operations of this round. The waitable flag only
+         * applies to QoS 1 PUBLISH operations. */
+        for( createdCount = 0; createdCount < roundCount; createdCount++ )
+        {
+            status = _IotMqtt_CreateOperation( mqttConnection,
+                                               ( pRoundInfo[ createdCount ].qos != IOT_MQTT_QOS_0 ) ? flags : 0U,
+                                               NULL,
+                                               &( pOperations[ createdCount ] ) );
+
+            if( status != IOT_MQTT_SUCCESS )
+            {
+                break;
+            }
+            else
+            {
+                EMPTY_ELSE_MARKER;
+            }
+
+            IotMqtt_Assert( pOperations[ createdCount ]->u.operation.status == IOT_MQTT_STATUS_PENDING );
+            pOperations[ createdCount ]->u.operation.type = IOT_MQTT_PUBLISH_TO_SERVER;
+
+            /* Initialize PUBLISH retry if retryLimit is set. A QoS 0 PUBLISH may not be retried. */
+            if( ( pRoundInfo[ createdCount ].retryLimit > 0U ) &&
+                ( pRoundInfo[ createdCount ].qos != IOT_MQTT_QOS_0 ) )
+            {
+                pOperations[ createdCount ]->u.operation.retry.limit = pRoundInfo[ createdCount ].retryLimit;
+                pOperations[ createdCount ]->u.operation.retry.nextPeriod = pRoundInfo[ createdCount ].retryMs;
+            }
+            else
+            {
+                EMPTY_ELSE_MARKER;
+            }
+        }
+
+        sentCount = 0;
+
+        if( status == IOT_MQTT_SUCCESS )
+        {
+            /* Set the references before the operations may complete. */
+            for( i = 0; ( i < roundCount ) && ( pPublishOperations != NULL ); i++ )
+            {
+                if( pRoundInfo[ i ].qos != IOT_MQTT_QOS_0 )
+                {
+                    pPublishOperations[ roundStart + i ] = pOperations[ i ];
+                }
+                else
+                {
+                    EMPTY_ELSE_MARKER;
+                }
+            }
+
+            IotMutex_Lock( &( mqttConnection->referencesMutex ) );
+
+            /* Calling PUBLISH batch wrapper to send the PUBLISH packets on the network. */
+            status = _IotMqtt_managedPublishBatch( mqttConnection,
+                                                   pOperations,
+                                                   pRoundInfo,
+                                                   roundCount,
+                                                   &sentCount );
+
+            /* Processing the operations of the packets sent on the network. */
+            for( i = 0; i < sentCount; i++ )
+            {
+                qos1Sent = qos1Sent || ( pRoundInfo[ i ].qos != IOT_MQTT_QOS_0 );
+
+                _IotMqtt_ProcessOperation( pOperations[ i ] );
+            }
+
+            IotMutex_Unlock( &( mqttConnection->referencesMutex ) );
+
+            /* Count the packets sent before the loop advances roundStart. */
+            totalSent += sentCount;
+        }
+        else
+        {
+            EMPTY_ELSE_MARKER;
+        }
+
+        /* Clean up the operations of the packets not sent, and clear their
+         * (now invalid) references. */
+        for( i = sentCount; i < createdCount; i++ )
+        {
+            if( pPublishOperations != NULL )
+            {
+                pPublishOperations[ roundStart + i ] = IOT_MQTT_OPERATION_INITIALIZER;
+            }
+            else
+            {
+                EMPTY_ELSE_MARKER;
+            }
+
+            _IotMqtt_DestroyOperation( pOperations[ i ] );
+        }
+    }
+
+    if( status != IOT_MQTT_SUCCESS )
+    {
+        IotLogError( "(MQTT connection %p) Failed to send PUBLISH batch; %lu of %lu PUBLISH packets sent.",
+                     mqttConnection,
+                     ( unsigned long ) totalSent,
+                     ( unsigned long ) publishCount );
+    }
+    else
+    {
+        IotLogInfo( "(MQTT connection %p) MQTT PUBLISH batch of %lu operations queued.",
+                    mqttConnection,
+                    ( unsigned long ) publishCount );
+
+        if( qos1Sent == true )
+        {
+            status = IOT_MQTT_STATUS_PENDING;
+        }
+        else
+        {
+            EMPTY_ELSE_MARKER;
+        }
+    }
+
+    IOT_FUNCTION_EXIT_NO_CLEANUP();
+}
+
+/*-----------------------------------------------------------*/
+
 IotMqttError_t IotMqtt_Wait( IotMqttOperation_t operation,
                              uint32_t timeoutMs )
 {
@@ -48,6 +48,175 @@ extern _connContext_t connToContext[ MAX_NO_OF_MQTT_CONNECTIONS ];
 
 /*-----------------------------------------------------------*/
 
+/**
+ * @brief Convert the PUBLISH information of the MQTT 201906.00 library to the
+ * PUBLISH information of the MQTT LTS library.
+ *
+ * @param[in] pPublishInfo The PUBLISH information to convert.
+ * @param[out] pManagedPublishInfo Set to the converted PUBLISH information.
+ */
+static void _convertPublishInfo( const IotMqttPublishInfo_t * pPublishInfo,
+                                 MQTTPublishInfo_t * pManagedPublishInfo );
+
+/**
+ * @brief Record a QoS 1 PUBLISH in the state of an MQTT context before it is
+ * serialized into the network buffer.
+ *
+ * A PUBLISH batch is serialized into the network buffer of the MQTT context and
+ * sent with a single transport send, so it cannot go through MQTT_Publish, which
+ * sends one packet per call. It keeps the state of its QoS 1 packets with the same
+ * core_mqtt_state.h functions that MQTT_Publish calls. That header is part of the
+ * interface of the MQTT LTS library; iot_mqtt_network.c already uses it to process
+ * PUBACKs. This function and #_markPublishSent are the only places the batch API
+ * uses it, so a change of that interface only needs to be handled here.
+ *
+ * @param[in] pContext The MQTT context of the connection.
+ * @param[in] packetId The packet identifier of the PUBLISH.
+ * @param[in] qos The QoS of the PUBLISH.
+ *
+ * @return #MQTTSuccess, or #MQTTNoMemory if the context already tracks its
+ * maximum number of outgoing QoS 1 packets.
+ */
+static MQTTStatus_t _reservePublishState( MQTTContext_t * pContext,
+                                          uint16_t packetId,
+                                          MQTTQoS_t qos );
+
+/**
+ * @brief Record that a QoS 1 PUBLISH reserved with #_reservePublishState was
+ * sent and is now awaiting PUBACK, as MQTT_Publish does after sending it.
+ *
+ * @param[in] pContext The MQTT context of the connection.
+ * @param[in] packetId The packet identifier of the PUBLISH.
+ * @param[in] qos The QoS of the PUBLISH.
+ */
+static void _markPublishSent( MQTTContext_t * pContext,
+                              uint16_t packetId,
+                              MQTTQoS_t qos );
+
+/**
+ * @brief Send the PUBLISH packets coalesced in the network buffer of an MQTT
+ * context, and record that the QoS 1 packets among them are awaiting PUBACK.
+ *
+ * @param[in] pContext The MQTT context whose network buffer holds the packets.
+ * @param[in] pOperations The PUBLISH operations of the packets.
+ * @param[in] pPublishInfoList The information of the packets.
+ * @param[in] publishCount The number of packets in the network buffer.
+ * @param[in] bytesToSend The number of bytes in the network buffer.
+ *
+ * @return #MQTTSuccess or #MQTTSendFailed.
+ */
+static MQTTStatus_t _sendPublishBatch( MQTTContext_t * pContext,
+                                       _mqttOperation_t * const * pOperations,
+                                       const IotMqttPublishInfo_t * pPublishInfoList,
+                                       size_t publishCount,
+                                       size_t bytesToSend );
+
+/*-----------------------------------------------------------*/
+
+static void _convertPublishInfo( const IotMqttPublishInfo_t * pPublishInfo,
+                                 MQTTPublishInfo_t * pManagedPublishInfo )
+{
+    pManagedPublishInfo->retain = pPublishInfo->retain;
+    pManagedPublishInfo->pTopicName = pPublishInfo->pTopicName;
+    pManagedPublishInfo->topicNameLength = pPublishInfo->topicNameLength;
+    pManagedPublishInfo->pPayload = pPublishInfo->pPayload;
+    pManagedPublishInfo->payloadLength = pPublishInfo->payloadLength;
+    pManagedPublishInfo->qos = ( MQTTQoS_t ) pPublishInfo->qos;
+    /* Existing MQTT 201906.00 library not support this parameter in publishInfo struct, so setting it to false. */
+    pManagedPublishInfo->dup = false;
+}
+
+/*-----------------------------------------------------------*/
+
+static MQTTStatus_t _reservePublishState( MQTTContext_t * pContext,
+                                          uint16_t packetId,
+                                          MQTTQoS_t qos )
+{
+    return MQTT_ReserveState( pContext, packetId, qos );
+}
+
+/*-----------------------------------------------------------*/
+
+static void _markPublishSent( MQTTContext_t * pContext,
+                              uint16_t packetId,
+                              MQTTQoS_t qos )
+{
+    MQTTPublishState_t publishState = MQTTStateNull;
+
+    if( MQTT_UpdateStatePublish( pContext,
+                                 packetId,
+                                 MQTT_SEND,
+                                 qos,
+                                 &publishState ) != MQTTSuccess )
+    {
+        /* The packet is sent; only its state could not be updated. */
+        IotLogWarn( "Failed to update the state of sent PUBLISH %hu.", packetId );
+    }
+    else
+    {
+        EMPTY_ELSE_MARKER;
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+static MQTTStatus_t _sendPublishBatch( MQTTContext_t * pContext,
+                                       _mqttOperation_t * const * pOperations,
+                                       const IotMqttPublishInfo_t * pPublishInfoList,
+                                       size_t publishCount,
+                                       size_t bytesToSend )
+{
+    MQTTStatus_t managedMqttStatus = MQTTSuccess;
+    size_t bytesSent = 0, i = 0;
+    int32_t sendResult = 0;
+
+    /* Send the whole network buffer, in as few transport sends as the transport allows. */
+    while( ( bytesSent < bytesToSend ) && ( managedMqttStatus == MQTTSuccess ) )
+    {
+        sendResult = pContext->transportInterface.send( pContext->transportInterface.pNetworkContext,
+                                                        &( pContext->networkBuffer.pBuffer[ bytesSent ] ),
+                                                        bytesToSend - bytesSent );
+
+        if( sendResult > 0 )
+        {
+            bytesSent += ( size_t ) sendResult;
+        }
+        else
+        {
+            managedMqttStatus = MQTTSendFailed;
+        }
+    }
+
+    if( managedMqttStatus == MQTTSuccess )
+    {
+        /* Keep the keep-alive timer of the MQTT context in step with the MQTT LTS PUBLISH API. */
+        pContext->lastPacketTime = pContext->getTime();
+
+        /* The QoS 1 packets are now awaiting PUBACK. */
+        for( i = 0; i < publishCount; i++ )
+        {
+            if( pPublishInfoList[ i ].qos != IOT_MQTT_QOS_0 )
+            {
+                _markPublishSent( pContext,
+                                  pOperations[ i ]->u.operation.packetIdentifier,
+                                  ( MQTTQoS_t ) pPublishInfoList[ i ].qos );
+            }
+            else
+            {
+                EMPTY_ELSE_MARKER;
+            }
+        }
+    }
+    else
+    {
+        EMPTY_ELSE_MARKER;
+    }
+
+    return managedMqttStatus;
+}
+
+/*-----------------------------------------------------------*/
+
 IotMqttError_t _IotMqtt_managedDisconnect( IotMqttConnection_t mqttConnection )
 {
     IOT_FUNCTION_ENTRY( IotMqttError_t, IOT_MQTT_BAD_PARAMETER );
@@ -265,14 +434,7 @@ IotMqttError_t _IotMqtt_managedPublish( IotMqttConnection_t mqttConnection,
         pOperation->u.operation.packetIdentifier = packetId;
 
         /* Populating the publish info to be used by MQTT LTS PUBLISH API. */
-        publishInfo.retain = pPublishInfo->retain;
-        publishInfo.pTopicName = pPublishInfo->pTopicName;
-        publishInfo.topicNameLength = pPublishInfo->topicNameLength;
-        publishInfo.pPayload = pPublishInfo->pPayload;
-        publishInfo.payloadLength = pPublishInfo->payloadLength;
-        publishInfo.qos = ( MQTTQoS_t ) pPublishInfo->qos;
-        /* Existing MQTT 201906.00 library not support this parameter in publishInfo struct, so setting it to false. */
-        publishInfo.dup = false;
+        _convertPublishInfo( pPublishInfo, &publishInfo );
 
         if( IotMutex_TakeRecursive( &( connToContext[ contextIndex ].contextMutex ) ) == false )
         {
@@ -301,6 +463,211 @@ IotMqttError_t _IotMqtt_managedPublish( IotMqttConnection_t mqttConnection,
     IOT_FUNCTION_EXIT_NO_CLEANUP();
 }
 
+/*-----------------------------------------------------------*/
+
+IotMqttError_t _IotMqtt_managedPublishBatch( IotMqttConnection_t mqttConnection,
+                                             _mqttOperation_t * const * pOperations,
+                                             const IotMqttPublishInfo_t * pPublishInfoList,
+                                             size_t publishCount,
+                                             size_t * pSentCount )
+{
+    IOT_FUNCTION_ENTRY( IotMqttError_t, IOT_MQTT_BAD_PARAMETER );
+    int8_t contextIndex = -1;
+    /* Initializing MQTT Status. */
+    MQTTStatus_t managedMqttStatus = MQTTSuccess;
+    MQTTContext_t * pContext = NULL;
+    MQTTFixedBuffer_t packetBuffer = { 0 };
+    MQTTPublishInfo_t publishInfo;
+    uint16_t packetId = 0;
+    size_t remainingLength = 0, packetSize = 0, bufferedBytes = 0, firstBuffered = 0, i = 0;
+
+    IotMqtt_Assert( mqttConnection != NULL );
+    IotMqtt_Assert( pOperations != NULL );
+    IotMqtt_Assert( pPublishInfoList != NULL );
+    IotMqtt_Assert( pSentCount != NULL );
+
+    *pSentCount = 0;
+
+    /* Getting MQTT Context for the specified MQTT Connection. */
+    contextIndex = _IotMqtt_getContextIndexFromConnection( mqttConnection );
+
+    if( contextIndex < 0 )
+    {
+        IotLogError( "(MQTT connection %p) MQTT Context is not set for this MQTT Connection.",
+                     mqttConnection );
+
+        IOT_GOTO_CLEANUP();
+    }
+    else
+    {
+        pContext = &( connToContext[ contextIndex ].context );
+    }
+
+    if( IotMutex_TakeRecursive( &( connToContext[ contextIndex ].contextMutex ) ) == false )
+    {
+        /* Fail to take context mutex due to timeout. */
+        IOT_SET_AND_GOTO_CLEANUP( IOT_MQTT_TIMEOUT );
+    }
+
+    for( i = 0; ( i < publishCount ) && ( managedMqttStatus == MQTTSuccess ); i++ )
+    {
+        _convertPublishInfo( &( pPublishInfoList[ i ] ), &publishInfo );
+
+        /* Only QoS 1 PUBLISH packets carry a packet identifier. */
+        packetId = 0;
+
+        if( publishInfo.qos != MQTTQoS0 )
+        {
+            packetId = MQTT_GetPacketId( pContext );
+        }
+        else
+        {
+            EMPTY_ELSE_MARKER;
+        }
+
+        pOperations[ i ]->u.operation.packetIdentifier = packetId;
+
+        managedMqttStatus = MQTT_GetPublishPacketSize( &publishInfo,
+                                                       &remainingLength,
+                                                       &packetSize );
+
+        /* Send the packets buffered so far if this packet does not fit after them. */
+        if( ( managedMqttStatus == MQTTSuccess ) &&
+            ( packetSize > ( pContext->networkBuffer.size - bufferedBytes ) ) &&
+            ( bufferedBytes > 0U ) )
+        {
+            managedMqttStatus = _sendPublishBatch( pContext,
+                                                   &( pOperations[ firstBuffered ] ),
+                                                   &( pPublishInfoList[ firstBuffered ] ),
+                                                   i - firstBuffered,
+                                                   bufferedBytes );
+
+            if( managedMqttStatus == MQTTSuccess )
+            {
+                *pSentCount = i;
+                firstBuffered = i;
+            }
+            else
+            {
+                EMPTY_ELSE_MARKER;
+            }
+
+            /* The network buffer is free again, even if the send failed. */
+            bufferedBytes = 0;
+        }
+        else
+        {
+            EMPTY_ELSE_MARKER;
+        }
+
+        if( managedMqttStatus == MQTTSuccess )
+        {
+            if( packetSize > pContext->networkBuffer.size )
+            {
+                /* A packet larger than the network buffer is sent on its own; the
+                 * MQTT LTS PUBLISH API sends its payload without copying it. */
+                managedMqttStatus = MQTT_Publish( pContext, &publishInfo, packetId );
+
+                if( managedMqttStatus == MQTTSuccess )
+                {
+                    *pSentCount = i + 1U;
+                    firstBuffered = i + 1U;
+                }
+                else
+                {
+                    EMPTY_ELSE_MARKER;
+                }
+            }
+            else
+            {
+                /* Track the QoS 1 packet before it may be sent, as the MQTT LTS
+                 * PUBLISH API does. */
+                if( publishInfo.qos != MQTTQoS0 )
+                {
+                    managedMqttStatus = _reservePublishState( pContext, packetId, publishInfo.qos );
+                }
+                else
+                {
+                    EMPTY_ELSE_MARKER;
+                }
+
+                if( managedMqttStatus == MQTTSuccess )
+                {
+                    packetBuffer.pBuffer = &( pContext->networkBuffer.pBuffer[ bufferedBytes ] );
+                    packetBuffer.size = pContext->networkBuffer.size - bufferedBytes;
+
+                    managedMqttStatus = MQTT_SerializePublish( &publishInfo,
+                                                               packetId,
+                                                               remainingLength,
+                                                               &packetBuffer );
+                }
+                else
+                {
+                    EMPTY_ELSE_MARKER;
+                }
+
+                if( managedMqttStatus == MQTTSuccess )
+                {
+                    bufferedBytes += packetSize;
+                }
+                else
+                {
+                    EMPTY_ELSE_MARKER;
+                }
+            }
+        }
+        else
+        {
+            EMPTY_ELSE_MARKER;
+        }
+    }
+
+    /* The loop stops after the PUBLISH that failed, which is not buffered. */
+    if( managedMqttStatus != MQTTSuccess )
+    {
+        i--;
+    }
+    else
+    {
+        EMPTY_ELSE_MARKER;
+    }
+
+    /* Send the packets still buffered. After a failure, this sends the packets
+     * buffered before the failed one, so that the ones already tracked are not lost. */
+    if( bufferedBytes > 0U )
+    {
+        if( _sendPublishBatch( pContext,
+                               &( pOperations[ firstBuffered ] ),
+                               &( pPublishInfoList[ firstBuffered ] ),
+                               i - firstBuffered,
+                               bufferedBytes ) == MQTTSuccess )
+        {
+            *pSentCount = i;
+        }
+        else
+        {
+            managedMqttStatus = MQTTSendFailed;
+        }
+    }
+    else
+    {
+        EMPTY_ELSE_MARKER;
+    }
+
+    if( IotMutex_GiveRecursive( &( connToContext[ contextIndex ].contextMutex ) ) == false )
+    {
+        /* Fail to give context mutex as no space is available on queue. */
+        IOT_SET_AND_GOTO_CLEANUP( IOT_MQTT_NO_MEMORY );
+    }
+
+    /* Converting the status code. */
+    status = convertReturnCode( managedMqttStatus );
+
+    IOT_FUNCTION_EXIT_NO_CLEANUP();
+}
+
+/*-----------------------------------------------------------*/
+
 IotMqttError_t _IotMqtt_managedPing( IotMqttConnection_t mqttConnection )
 {
     int8_t contextIndex = -1;
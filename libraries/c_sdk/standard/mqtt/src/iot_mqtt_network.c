@@ -43,12 +43,86 @@
 /* Platform layer includes. */
 #include "platform/iot_threads.h"
 
+/* Atomic operations. */
+#include "iot_atomic.h"
 
 /* Using initialized connToContext variable. */
 extern _connContext_t connToContext[ MAX_NO_OF_MQTT_CONNECTIONS ];
 
 /*-----------------------------------------------------------*/
 
+/**
+ * @brief Total number of buffers in the receive buffer pool.
+ */
+#define RECEIVE_POOL_BUFFER_COUNT                                                 \
+    ( IOT_MQTT_RECEIVE_POOL_SMALL_COUNT + IOT_MQTT_RECEIVE_POOL_MEDIUM_COUNT + \
+      IOT_MQTT_RECEIVE_POOL_LARGE_COUNT )
+
+/**
+ * @brief Offset of the data of the medium size class in #_receivePoolData.
+ */
+#define RECEIVE_POOL_MEDIUM_OFFSET    ( IOT_MQTT_RECEIVE_POOL_SMALL_SIZE * IOT_MQTT_RECEIVE_POOL_SMALL_COUNT )
+
+/**
+ * @brief Offset of the data of the large size class in #_receivePoolData.
+ */
+#define RECEIVE_POOL_LARGE_OFFSET                                                       \
+    ( RECEIVE_POOL_MEDIUM_OFFSET +                                                      \
+      ( IOT_MQTT_RECEIVE_POOL_MEDIUM_SIZE * IOT_MQTT_RECEIVE_POOL_MEDIUM_COUNT ) )
+
+/**
+ * @brief Total number of data bytes in the receive buffer pool.
+ */
+#define RECEIVE_POOL_DATA_SIZE                                                          \
+    ( RECEIVE_POOL_LARGE_OFFSET +                                                       \
+      ( IOT_MQTT_RECEIVE_POOL_LARGE_SIZE * IOT_MQTT_RECEIVE_POOL_LARGE_COUNT ) )
+
+/**
+ * @brief Size of a pool array, which may not be 0 when a pool is empty.
+ */
+#define RECEIVE_POOL_ARRAY_SIZE( size )    ( ( ( size ) > 0U ) ? ( size ) : 1U )
+
+/**
+ * @brief Describes the slab of buffers of one size class in the receive buffer pool.
+ */
+typedef struct _receivePoolClass
+{
+    size_t bufferSize;    /**< @brief Size of each buffer of this size class. */
+    uint32_t firstBuffer; /**< @brief Index of the first buffer of this size class in #_receiveBuffers. */
+    uint32_t bufferCount; /**< @brief Number of buffers of this size class. */
+    size_t dataOffset;    /**< @brief Offset of the data of this size class in #_receivePoolData. */
+} _receivePoolClass_t;
+
+/**
+ * @brief The size classes of the receive buffer pool, smallest first.
+ */
+static const _receivePoolClass_t _receivePoolClasses[ IOT_MQTT_RECEIVE_POOL_CLASSES ] =
+{
+    { IOT_MQTT_RECEIVE_POOL_SMALL_SIZE,  0U,
+      IOT_MQTT_RECEIVE_POOL_SMALL_COUNT, 0U },
+    { IOT_MQTT_RECEIVE_POOL_MEDIUM_SIZE, IOT_MQTT_RECEIVE_POOL_SMALL_COUNT,
+      IOT_MQTT_RECEIVE_POOL_MEDIUM_COUNT, RECEIVE_POOL_MEDIUM_OFFSET },
+    { IOT_MQTT_RECEIVE_POOL_LARGE_SIZE,  IOT_MQTT_RECEIVE_POOL_SMALL_COUNT + IOT_MQTT_RECEIVE_POOL_MEDIUM_COUNT,
+      IOT_MQTT_RECEIVE_POOL_LARGE_COUNT, RECEIVE_POOL_LARGE_OFFSET }
+};
+
+/**
+ * @brief Receive buffers of the pool. A buffer is free when its reference count is 0.
+ */
+static _mqttReceiveBuffer_t _receiveBuffers[ RECEIVE_POOL_ARRAY_SIZE( RECEIVE_POOL_BUFFER_COUNT ) ] = { { 0 } };
+
+/**
+ * @brief Data of the receive buffers of the pool.
+ */
+static uint8_t _receivePoolData[ RECEIVE_POOL_ARRAY_SIZE( RECEIVE_POOL_DATA_SIZE ) ] = { 0 };
+
+/**
+ * @brief Occupancy counters of the receive buffer pool. Updated atomically.
+ */
+static IotMqttReceivePoolStatus_t _receivePoolStatus = { 0 };
+
+/*-----------------------------------------------------------*/
+
 /**
  * @brief Check if an incoming packet type is valid.
  *
@@ -109,6 +183,16 @@ static void _flushPacket( void * pNetworkConnection,
                           const _mqttConnection_t * pMqttConnection,
                           size_t length );
 
+/**
+ * @brief Borrow a free buffer of one size class of the receive buffer pool.
+ *
+ * @param[in] sizeClass The size class to search.
+ *
+ * @return A receive buffer with a reference count of 1; `NULL` if all buffers of
+ * the size class are in use.
+ */
+static _mqttReceiveBuffer_t * _claimPoolBuffer( uint32_t sizeClass );
+
 /*-----------------------------------------------------------*/
 
 static bool _incomingPacketValid( uint8_t packetType )
@@ -153,6 +237,7 @@ static IotMqttError_t _getIncomingPacket( void * pNetworkConnection,
 
     /* No buffer for remaining data should be allocated. */
     IotMqtt_Assert( pIncomingPacket->pRemainingData == NULL );
+    IotMqtt_Assert( pIncomingPacket->pBuffer == NULL );
     IotMqtt_Assert( pIncomingPacket->remainingLength == 0 );
 
     /* Choose packet type and length functions. */
@@ -214,12 +299,12 @@ static IotMqttError_t _getIncomingPacket( void * pNetworkConnection,
         EMPTY_ELSE_MARKER;
     }
 
-    /* Allocate a buffer for the remaining data and read the data. */
+    /* Borrow a buffer for the remaining data and read the data. */
     if( pIncomingPacket->remainingLength > 0 )
     {
-        pIncomingPacket->pRemainingData = IotMqtt_MallocMessage( pIncomingPacket->remainingLength );
+        pIncomingPacket->pBuffer = _IotMqtt_GetReceiveBuffer( pIncomingPacket->remainingLength );
 
-        if( pIncomingPacket->pRemainingData == NULL )
+        if( pIncomingPacket->pBuffer == NULL )
         {
             IotLogError( "(MQTT connection %p) Failed to allocate buffer of length "
                          "%lu for incoming packet type %lu.",
@@ -233,7 +318,7 @@ static IotMqttError_t _getIncomingPacket( void * pNetworkConnection,
         }
         else
         {
-            EMPTY_ELSE_MARKER;
+            pIncomingPacket->pRemainingData = pIncomingPacket->pBuffer->pData;
         }
 
         dataBytesRead = pMqttConnection->pNetworkInterface->receive( pNetworkConnection,
@@ -259,9 +344,11 @@ static IotMqttError_t _getIncomingPacket( void * pNetworkConnection,
 
     if( status != IOT_MQTT_SUCCESS )
     {
-        if( pIncomingPacket->pRemainingData != NULL )
+        if( pIncomingPacket->pBuffer != NULL )
         {
-            IotMqtt_FreeMessage( pIncomingPacket->pRemainingData );
+            _IotMqtt_ReleaseReceiveBuffer( pIncomingPacket->pBuffer );
+            pIncomingPacket->pBuffer = NULL;
+            pIncomingPacket->pRemainingData = NULL;
         }
         else
         {
@@ -401,8 +488,8 @@ static IotMqttError_t _deserializeIncomingPacket( _mqttConnection_t * pMqttConne
                 }
 
                 /* Transfer ownership of the received MQTT packet to the PUBLISH operation. */
-                pOperation->u.publish.pReceivedData = pIncomingPacket->pRemainingData;
-                pIncomingPacket->pRemainingData = NULL;
+                pOperation->u.publish.pReceivedData = pIncomingPacket->pBuffer;
+                pIncomingPacket->pBuffer = NULL;
 
                 /* Add the PUBLISH to the list of operations pending processing. */
                 IotMutex_Lock( &( pMqttConnection->referencesMutex ) );
@@ -433,9 +520,9 @@ static IotMqttError_t _deserializeIncomingPacket( _mqttConnection_t * pMqttConne
                 /* Check ownership of the received MQTT packet. */
                 if( pOperation->u.publish.pReceivedData != NULL )
                 {
-                    /* Retrieve the pointer MQTT packet pointer so it may be freed later. */
-                    IotMqtt_Assert( pIncomingPacket->pRemainingData == NULL );
-                    pIncomingPacket->pRemainingData = ( uint8_t * ) pOperation->u.publish.pReceivedData;
+                    /* Retrieve the MQTT packet buffer so it may be released later. */
+                    IotMqtt_Assert( pIncomingPacket->pBuffer == NULL );
+                    pIncomingPacket->pBuffer = pOperation->u.publish.pReceivedData;
                 }
                 else
                 {
@@ -809,6 +896,157 @@ static void _flushPacket( void * pNetworkConnection,
 
 /*-----------------------------------------------------------*/
 
+static _mqttReceiveBuffer_t * _claimPoolBuffer( uint32_t sizeClass )
+{
+    const _receivePoolClass_t * pClass = &( _receivePoolClasses[ sizeClass ] );
+    IotMqttReceivePoolClassStatus_t * pClassStatus = &( _receivePoolStatus.sizeClass[ sizeClass ] );
+    _mqttReceiveBuffer_t * pBuffer = NULL;
+    uint32_t i = 0, inUse = 0, maxInUse = 0;
+
+    for( i = 0; i < pClass->bufferCount; i++ )
+    {
+        /* A buffer belongs to the thread that changes its reference count from 0. */
+        if( Atomic_CompareAndSwap_u32( &( _receiveBuffers[ pClass->firstBuffer + i ].references ),
+                                       1U,
+                                       0U ) == ATOMIC_COMPARE_AND_SWAP_SUCCESS )
+        {
+            pBuffer = &( _receiveBuffers[ pClass->firstBuffer + i ] );
+            pBuffer->sizeClass = ( int32_t ) sizeClass;
+            pBuffer->pData = &( _receivePoolData[ pClass->dataOffset + ( i * pClass->bufferSize ) ] );
+
+            break;
+        }
+        else
+        {
+            EMPTY_ELSE_MARKER;
+        }
+    }
+
+    if( pBuffer != NULL )
+    {
+        ( void ) Atomic_Increment_u32( &( pClassStatus->allocations ) );
+        inUse = Atomic_Increment_u32( &( pClassStatus->inUse ) ) + 1U;
+
+        /* A buffer is free before its release is counted, so the count may
+         * briefly exceed the number of buffers. */
+        if( inUse > pClass->bufferCount )
+        {
+            inUse = pClass->bufferCount;
+        }
+        else
+        {
+            EMPTY_ELSE_MARKER;
+        }
+
+        maxInUse = Atomic_Add_u32( &( pClassStatus->maxInUse ), 0U );
+
+        while( ( inUse > maxInUse ) &&
+               ( Atomic_CompareAndSwap_u32( &( pClassStatus->maxInUse ),
+                                            inUse,
+                                            maxInUse ) != ATOMIC_COMPARE_AND_SWAP_SUCCESS ) )
+        {
+            maxInUse = Atomic_Add_u32( &( pClassStatus->maxInUse ), 0U );
+        }
+    }
+    else
+    {
+        EMPTY_ELSE_MARKER;
+    }
+
+    return pBuffer;
+}
+
+/*-----------------------------------------------------------*/
+
+_mqttReceiveBuffer_t * _IotMqtt_GetReceiveBuffer( size_t length )
+{
+    _mqttReceiveBuffer_t * pBuffer = NULL;
+    uint32_t sizeClass = 0;
+
+    /* Use the smallest free buffer that fits. */
+    for( sizeClass = 0; ( sizeClass < IOT_MQTT_RECEIVE_POOL_CLASSES ) && ( pBuffer == NULL ); sizeClass++ )
+    {
+        if( ( length <= _receivePoolClasses[ sizeClass ].bufferSize ) &&
+            ( _receivePoolClasses[ sizeClass ].bufferCount > 0U ) )
+        {
+            pBuffer = _claimPoolBuffer( sizeClass );
+
+            if( pBuffer == NULL )
+            {
+                ( void ) Atomic_Increment_u32( &( _receivePoolStatus.sizeClass[ sizeClass ].exhausted ) );
+            }
+            else
+            {
+                EMPTY_ELSE_MARKER;
+            }
+        }
+        else
+        {
+            EMPTY_ELSE_MARKER;
+        }
+    }
+
+    /* Fall back to allocating the buffer together with its data if no buffer
+     * of the pool is available. */
+    if( pBuffer == NULL )
+    {
+        pBuffer = IotMqtt_MallocMessage( sizeof( _mqttReceiveBuffer_t ) + length );
+
+        if( pBuffer != NULL )
+        {
+            pBuffer->references = 1U;
+            pBuffer->sizeClass = -1;
+            pBuffer->pData = ( uint8_t * ) ( pBuffer + 1 );
+
+            ( void ) Atomic_Increment_u32( &( _receivePoolStatus.heapAllocations ) );
+            ( void ) Atomic_Increment_u32( &( _receivePoolStatus.heapInUse ) );
+
+            IotLogDebug( "No receive pool buffer available for %lu bytes; allocated a buffer.",
+                         ( unsigned long ) length );
+        }
+        else
+        {
+            EMPTY_ELSE_MARKER;
+        }
+    }
+    else
+    {
+        EMPTY_ELSE_MARKER;
+    }
+
+    return pBuffer;
+}
+
+/*-----------------------------------------------------------*/
+
+void _IotMqtt_ReleaseReceiveBuffer( _mqttReceiveBuffer_t * pBuffer )
+{
+    /* Read the size class before releasing the reference; a pool buffer may be
+     * claimed again as soon as its reference count reaches 0. */
+    int32_t sizeClass = pBuffer->sizeClass;
+
+    IotMqtt_Assert( Atomic_Add_u32( &( pBuffer->references ), 0U ) > 0U );
+
+    if( Atomic_Decrement_u32( &( pBuffer->references ) ) == 1U )
+    {
+        if( sizeClass < 0 )
+        {
+            ( void ) Atomic_Decrement_u32( &( _receivePoolStatus.heapInUse ) );
+            IotMqtt_FreeMessage( pBuffer );
+        }
+        else
+        {
+            ( void ) Atomic_Decrement_u32( &( _receivePoolStatus.sizeClass[ sizeClass ].inUse ) );
+        }
+    }
+    else
+    {
+        EMPTY_ELSE_MARKER;
+    }
+}
+
+/*-----------------------------------------------------------*/
+
 bool _IotMqtt_GetNextByte( void * pNetworkConnection,
                            const IotNetworkInterface_t * pNetworkInterface,
                            uint8_t * pIncomingByte )
@@ -963,10 +1201,10 @@ void IotMqtt_ReceiveCallback( void * pNetworkConnection,
         status = _deserializeIncomingPacket( pMqttConnection,
                                              &incomingPacket );
 
-        /* Free any buffers allocated for the MQTT packet. */
-        if( incomingPacket.pRemainingData != NULL )
+        /* Release any buffers borrowed for the MQTT packet. */
+        if( incomingPacket.pBuffer != NULL )
         {
-            IotMqtt_FreeMessage( incomingPacket.pRemainingData );
+            _IotMqtt_ReleaseReceiveBuffer( incomingPacket.pBuffer );
         }
         else
         {
@@ -994,3 +1232,80 @@ void IotMqtt_ReceiveCallback( void * pNetworkConnection,
 }
 
 /*-----------------------------------------------------------*/
+
+IotMqttMessageBuffer_t IotMqtt_RetainMessage( const IotMqttCallbackParam_t * pCallbackParam )
+{
+    IotMqttMessageBuffer_t messageBuffer = IOT_MQTT_MESSAGE_BUFFER_INITIALIZER;
+
+    if( pCallbackParam != NULL )
+    {
+        messageBuffer = pCallbackParam->u.message.buffer;
+    }
+    else
+    {
+        IotLogError( "Callback parameter must be set to retain a message." );
+    }
+
+    /* The subscription callback holds a reference to the buffer, so it cannot
+     * be released while adding another reference. */
+    if( messageBuffer != NULL )
+    {
+        ( void ) Atomic_Increment_u32( &( messageBuffer->references ) );
+    }
+    else
+    {
+        EMPTY_ELSE_MARKER;
+    }
+
+    return messageBuffer;
+}
+
+/*-----------------------------------------------------------*/
+
+void IotMqtt_ReleaseMessage( IotMqttMessageBuffer_t messageBuffer )
+{
+    if( messageBuffer != NULL )
+    {
+        _IotMqtt_ReleaseReceiveBuffer( messageBuffer );
+    }
+    else
+    {
+        EMPTY_ELSE_MARKER;
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+IotMqttError_t IotMqtt_GetReceivePoolStatus( IotMqttReceivePoolStatus_t * pStatus )
+{
+    IotMqttError_t status = IOT_MQTT_SUCCESS;
+    uint32_t sizeClass = 0;
+
+    if( pStatus == NULL )
+    {
+        IotLogError( "Receive pool status must be set." );
+
+        status = IOT_MQTT_BAD_PARAMETER;
+    }
+    else
+    {
+        for( sizeClass = 0; sizeClass < IOT_MQTT_RECEIVE_POOL_CLASSES; sizeClass++ )
+        {
+            IotMqttReceivePoolClassStatus_t * pClassStatus = &( _receivePoolStatus.sizeClass[ sizeClass ] );
+
+            pStatus->sizeClass[ sizeClass ].bufferSize = _receivePoolClasses[ sizeClass ].bufferSize;
+            pStatus->sizeClass[ sizeClass ].bufferCount = _receivePoolClasses[ sizeClass ].bufferCount;
+            pStatus->sizeClass[ sizeClass ].inUse = Atomic_Add_u32( &( pClassStatus->inUse ), 0U );
+            pStatus->sizeClass[ sizeClass ].maxInUse = Atomic_Add_u32( &( pClassStatus->maxInUse ), 0U );
+            pStatus->sizeClass[ sizeClass ].allocations = Atomic_Add_u32( &( pClassStatus->allocations ), 0U );
+            pStatus->sizeClass[ sizeClass ].exhausted = Atomic_Add_u32( &( pClassStatus->exhausted ), 0U );
+        }
+
+        pStatus->heapAllocations = Atomic_Add_u32( &( _receivePoolStatus.heapAllocations ), 0U );
+        pStatus->heapInUse = Atomic_Add_u32( &( _receivePoolStatus.heapInUse ), 0U );
+    }
+
+    return status;
+}
+
+/*-----------------------------------------------------------*/
@@ -73,6 +73,48 @@ typedef struct _operationMatchParam
 static bool _mqttOperation_match( const IotLink_t * pOperationLink,
                                   void * pMatch );
 
+/**
+ * @brief Find the slot of the index of pending responses that holds an operation
+ * with the given type and packet identifier.
+ *
+ * @param[in] pMqttConnection The MQTT connection whose index to search.
+ * @param[in] type The operation type to look for.
+ * @param[in] packetIdentifier The packet identifier to look for.
+ *
+ * @return The slot of the matching operation; #IOT_MQTT_PENDING_RESPONSE_INDEX_SIZE
+ * if the index has no matching operation.
+ */
+static size_t _indexFind( const _mqttConnection_t * pMqttConnection,
+                          IotMqttOperationType_t type,
+                          uint16_t packetIdentifier );
+
+/**
+ * @brief Add an operation to the index of pending responses, unless it is
+ * already present.
+ *
+ * @param[in] pOperation The operation to add. Its packet identifier must not be 0.
+ *
+ * @return `true` if the operation is in the index; `false` if the index is full.
+ */
+static bool _indexInsert( _mqttOperation_t * pOperation );
+
+/**
+ * @brief Remove an operation from the index of pending responses, if present.
+ *
+ * @param[in] pOperation The operation to remove.
+ *
+ * @return `true` if the operation was removed; `false` if it was not in the index.
+ */
+static bool _indexRemove( _mqttOperation_t * pOperation );
+
+/**
+ * @brief Clear the flag of an operation that was missing from the index of
+ * pending responses, if set.
+ *
+ * @param[in] pOperation The operation that is indexed or no longer pending a response.
+ */
+static void _clearUnindexed( _mqttOperation_t * pOperation );
+
 /**
  * @brief Check if an operation with retry has exceeded its retry limit.
  *
@@ -133,10 +175,177 @@ static bool _mqttOperation_match( const IotLink_t * pOperationLink,
 
 /*-----------------------------------------------------------*/
 
+static size_t _indexFind( const _mqttConnection_t * pMqttConnection,
+                          IotMqttOperationType_t type,
+                          uint16_t packetIdentifier )
+{
+    /* Packet identifiers are assigned sequentially, so their low bits spread
+     * in-flight operations evenly over the index. */
+    size_t slot = ( size_t ) packetIdentifier & ( IOT_MQTT_PENDING_RESPONSE_INDEX_SIZE - 1U );
+    const _mqttOperation_t * pIndexed = pMqttConnection->pPendingResponseIndex[ slot ];
+
+    /* The index always has an empty slot, which ends every probe sequence. */
+    while( pIndexed != NULL )
+    {
+        if( ( pIndexed->u.operation.packetIdentifier == packetIdentifier ) &&
+            ( pIndexed->u.operation.type == type ) )
+        {
+            break;
+        }
+        else
+        {
+            EMPTY_ELSE_MARKER;
+        }
+
+        slot = ( slot + 1U ) & ( IOT_MQTT_PENDING_RESPONSE_INDEX_SIZE - 1U );
+        pIndexed = pMqttConnection->pPendingResponseIndex[ slot ];
+    }
+
+    if( pIndexed == NULL )
+    {
+        slot = IOT_MQTT_PENDING_RESPONSE_INDEX_SIZE;
+    }
+    else
+    {
+        EMPTY_ELSE_MARKER;
+    }
+
+    return slot;
+}
+
+/*-----------------------------------------------------------*/
+
+static bool _indexInsert( _mqttOperation_t * pOperation )
+{
+    bool status = true;
+    _mqttConnection_t * pMqttConnection = pOperation->pMqttConnection;
+    size_t slot = _indexFind( pMqttConnection,
+                              pOperation->u.operation.type,
+                              pOperation->u.operation.packetIdentifier );
+
+    IotMqtt_Assert( pOperation->u.operation.packetIdentifier != 0U );
+
+    /* An operation moved between the lists may already be indexed. */
+    if( ( slot < IOT_MQTT_PENDING_RESPONSE_INDEX_SIZE ) &&
+        ( pMqttConnection->pPendingResponseIndex[ slot ] == pOperation ) )
+    {
+        EMPTY_ELSE_MARKER;
+    }
+    else if( pMqttConnection->pendingResponseIndexed >= ( ( IOT_MQTT_PENDING_RESPONSE_INDEX_SIZE / 4U ) * 3U ) )
+    {
+        status = false;
+    }
+    else
+    {
+        /* Linear probing: take the first empty slot after the home slot. */
+        slot = ( size_t ) pOperation->u.operation.packetIdentifier & ( IOT_MQTT_PENDING_RESPONSE_INDEX_SIZE - 1U );
+
+        while( pMqttConnection->pPendingResponseIndex[ slot ] != NULL )
+        {
+            slot = ( slot + 1U ) & ( IOT_MQTT_PENDING_RESPONSE_INDEX_SIZE - 1U );
+        }
+
+        pMqttConnection->pPendingResponseIndex[ slot ] = pOperation;
+        ( pMqttConnection->pendingResponseIndexed )++;
+    }
+
+    return status;
+}
+
+/*-----------------------------------------------------------*/
+
+static bool _indexRemove( _mqttOperation_t * pOperation )
+{
+    bool status = false;
+    _mqttConnection_t * pMqttConnection = pOperation->pMqttConnection;
+    _mqttOperation_t ** pIndex = pMqttConnection->pPendingResponseIndex;
+    size_t emptySlot = 0, slot = 0, homeSlot = 0;
+
+    emptySlot = _indexFind( pMqttConnection,
+                            pOperation->u.operation.type,
+                            pOperation->u.operation.packetIdentifier );
+
+    if( ( emptySlot < IOT_MQTT_PENDING_RESPONSE_INDEX_SIZE ) &&
+        ( pIndex[ emptySlot ] == pOperation ) )
+    {
+        status = true;
+        ( pMqttConnection->pendingResponseIndexed )--;
+
+        /* Shift later members of the probe sequence back into the emptied slot,
+         * so that no search stops early at it. */
+        slot = emptySlot;
+
+        while( true )
+        {
+            slot = ( slot + 1U ) & ( IOT_MQTT_PENDING_RESPONSE_INDEX_SIZE - 1U );
+
+            if( pIndex[ slot ] == NULL )
+            {
+                break;
+            }
+            else
+            {
+                EMPTY_ELSE_MARKER;
+            }
+
+            homeSlot = ( size_t ) pIndex[ slot ]->u.operation.packetIdentifier & ( IOT_MQTT_PENDING_RESPONSE_INDEX_SIZE - 1U );
+
+            /* The operation may move if the emptied slot is no further from its
+             * home slot than its current slot. */
+            if( ( ( slot - homeSlot ) & ( IOT_MQTT_PENDING_RESPONSE_INDEX_SIZE - 1U ) ) >=
+                ( ( slot - emptySlot ) & ( IOT_MQTT_PENDING_RESPONSE_INDEX_SIZE - 1U ) ) )
+            {
+                pIndex[ emptySlot ] = pIndex[ slot ];
+                emptySlot = slot;
+            }
+            else
+            {
+                EMPTY_ELSE_MARKER;
+            }
+        }
+
+        pIndex[ emptySlot ] = NULL;
+    }
+    else
+    {
+        EMPTY_ELSE_MARKER;
+    }
+
+    return status;
+}
+
+/*-----------------------------------------------------------*/
+
+static void _clearUnindexed( _mqttOperation_t * pOperation )
+{
+    _mqttConnection_t * pMqttConnection = pOperation->pMqttConnection;
+
+    if( pOperation->u.operation.unindexed == true )
+    {
+        pOperation->u.operation.unindexed = false;
+
+        /* The count is reset when the connection's lists are emptied. */
+        if( pMqttConnection->pendingResponseUnindexed > 0U )
+        {
+            ( pMqttConnection->pendingResponseUnindexed )--;
+        }
+        else
+        {
+            EMPTY_ELSE_MARKER;
+        }
+    }
+    else
+    {
+        EMPTY_ELSE_MARKER;
+    }
+}
+
+/*-----------------------------------------------------------*/
+
 static bool _checkRetryLimit( _mqttOperation_t * pOperation )
 {
     _mqttConnection_t * pMqttConnection = pOperation->pMqttConnection;
-    bool status = true;
+    bool status = true, setDup = false, indexed = false;
 
     /* Choose a set DUP function. */
     void ( * publishSetDup )( uint8_t *,
@@ -182,24 +391,40 @@ static bool _checkRetryLimit( _mqttOperation_t * pOperation )
     else if( pOperation->u.operation.retry.count == 1 )
     {
         /* Always set the DUP flag on the first retry. */
-        publishSetDup( pOperation->u.operation.pMqttPacket,
-                       pOperation->u.operation.pPacketIdentifierHigh,
-                       &( pOperation->u.operation.packetIdentifier ) );
+        setDup = true;
     }
     else
     {
         /* In AWS IoT MQTT mode, the DUP flag (really a change to the packet
          * identifier) must be reset on every retry. */
-        if( pMqttConnection->awsIotMqttMode == true )
+        setDup = pMqttConnection->awsIotMqttMode;
+    }
+
+    if( setDup == true )
+    {
+        /* Setting the DUP flag may change the packet identifier, which is the
+         * key of an operation in the index of pending responses. */
+        IotMutex_Lock( &( pMqttConnection->referencesMutex ) );
+        indexed = _indexRemove( pOperation );
+
+        publishSetDup( pOperation->u.operation.pMqttPacket,
+                       pOperation->u.operation.pPacketIdentifierHigh,
+                       &( pOperation->u.operation.packetIdentifier ) );
+
+        if( indexed == true )
         {
-            publishSetDup( pOperation->u.operation.pMqttPacket,
-                           pOperation->u.operation.pPacketIdentifierHigh,
-                           &( pOperation->u.operation.packetIdentifier ) );
+            ( void ) _indexInsert( pOperation );
         }
         else
         {
             EMPTY_ELSE_MARKER;
         }
+
+        IotMutex_Unlock( &( pMqttConnection->referencesMutex ) );
+    }
+    else
+    {
+        EMPTY_ELSE_MARKER;
     }
 
     return status;
@@ -289,8 +514,7 @@ static bool _scheduleNextRetry( _mqttOperation_t * pOperation )
 
             /* Transfer to pending response list. */
             IotListDouble_Remove( &( pOperation->link ) );
-            IotListDouble_InsertHead( &( pMqttConnection->pendingResponse ),
-                                      &( pOperation->link ) );
+            _IotMqtt_InsertPendingResponse( pOperation );
         }
         else
         {
@@ -586,6 +810,10 @@ void _IotMqtt_DestroyOperation( _mqttOperation_t * pOperation )
                      pOperation );
     }
 
+    /* Remove the operation from the index of pending responses. */
+    ( void ) _indexRemove( pOperation );
+    _clearUnindexed( pOperation );
+
     IotMutex_Unlock( &( pMqttConnection->referencesMutex ) );
 
     /* Free any allocated MQTT packet. */
@@ -893,14 +1121,17 @@ void _IotMqtt_ProcessIncomingPublish( IotTaskPool_t pTaskPool,
 
     /* Process the current PUBLISH. */
     callbackParam.u.message.info = pOperation->u.publish.publishInfo;
+    callbackParam.u.message.buffer = pOperation->u.publish.pReceivedData;
 
     _IotMqtt_InvokeSubscriptionCallback( pOperation->pMqttConnection,
                                          &callbackParam );
 
-    /* Free any buffers associated with the current PUBLISH message. */
+    /* Release the buffer of the current PUBLISH message. The buffer is only
+     * returned to the receive pool once every callback that retained it has
+     * released it as well. */
     if( pOperation->u.publish.pReceivedData != NULL )
     {
-        IotMqtt_FreeMessage( ( void * ) pOperation->u.publish.pReceivedData );
+        _IotMqtt_ReleaseReceiveBuffer( pOperation->u.publish.pReceivedData );
     }
     else
     {
@@ -1052,8 +1283,7 @@ void _IotMqtt_ProcessSend( IotTaskPool_t pTaskPool,
 
                 /* Transfer to pending response list. */
                 IotListDouble_Remove( &( pOperation->link ) );
-                IotListDouble_InsertHead( &( pMqttConnection->pendingResponse ),
-                                          &( pOperation->link ) );
+                _IotMqtt_InsertPendingResponse( pOperation );
 
                 IotMutex_Unlock( &( pMqttConnection->referencesMutex ) );
 
@@ -1169,8 +1399,7 @@ void _IotMqtt_ProcessOperation( _mqttOperation_t * pOperation )
 
             /* Transfer to pending response list. */
             IotListDouble_Remove( &( pOperation->link ) );
-            IotListDouble_InsertHead( &( pMqttConnection->pendingResponse ),
-                                      &( pOperation->link ) );
+            _IotMqtt_InsertPendingResponse( pOperation );
 
             /* This operation is now awaiting a response from the network. */
             networkPending = true;
@@ -1303,6 +1532,55 @@ IotMqttError_t _IotMqtt_ScheduleOperation( _mqttOperation_t * pOperation,
 
 /*-----------------------------------------------------------*/
 
+void _IotMqtt_InsertPendingResponse( _mqttOperation_t * pOperation )
+{
+    _mqttConnection_t * pMqttConnection = pOperation->pMqttConnection;
+
+    IotListDouble_InsertHead( &( pMqttConnection->pendingResponse ),
+                              &( pOperation->link ) );
+
+    /* Only operations with a packet identifier are matched by it. */
+    if( pOperation->u.operation.packetIdentifier != 0U )
+    {
+        if( _indexInsert( pOperation ) == true )
+        {
+            _clearUnindexed( pOperation );
+        }
+        else if( pOperation->u.operation.unindexed == false )
+        {
+            IotLogDebug( "(MQTT connection %p, %s operation %p) Index of pending responses "
+                         "is full; operation will be found by list search.",
+                         pMqttConnection,
+                         IotMqtt_OperationType( pOperation->u.operation.type ),
+                         pOperation );
+
+            pOperation->u.operation.unindexed = true;
+            ( pMqttConnection->pendingResponseUnindexed )++;
+        }
+        else
+        {
+            EMPTY_ELSE_MARKER;
+        }
+    }
+    else
+    {
+        EMPTY_ELSE_MARKER;
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+void _IotMqtt_ClearPendingResponseIndex( _mqttConnection_t * pMqttConnection )
+{
+    ( void ) memset( pMqttConnection->pPendingResponseIndex,
+                     0x00,
+                     sizeof( pMqttConnection->pPendingResponseIndex ) );
+    pMqttConnection->pendingResponseIndexed = 0;
+    pMqttConnection->pendingResponseUnindexed = 0;
+}
+
+/*-----------------------------------------------------------*/
+
 _mqttOperation_t * _IotMqtt_FindOperation( _mqttConnection_t * pMqttConnection,
                                            IotMqttOperationType_t type,
                                            const uint16_t * pPacketIdentifier )
@@ -1311,6 +1589,7 @@ _mqttOperation_t * _IotMqtt_FindOperation( _mqttConnection_t * pMqttConnection,
     _mqttOperation_t * pResult = NULL;
     IotLink_t * pResultLink = NULL;
     _operationMatchParam_t param = { .type = type, .pPacketIdentifier = pPacketIdentifier };
+    size_t slot = IOT_MQTT_PENDING_RESPONSE_INDEX_SIZE;
 
     if( pPacketIdentifier != NULL )
     {
@@ -1327,18 +1606,48 @@ _mqttOperation_t * _IotMqtt_FindOperation( _mqttConnection_t * pMqttConnection,
                      IotMqtt_OperationType( type ) );
     }
 
-    /* Find and remove the first matching element in the list. */
     IotMutex_Lock( &( pMqttConnection->referencesMutex ) );
-    pResultLink = IotListDouble_FindFirstMatch( &( pMqttConnection->pendingResponse ),
-                                                NULL,
-                                                _mqttOperation_match,
-                                                &param );
+
+    /* Look up an operation with a packet identifier in the index. */
+    if( pPacketIdentifier != NULL )
+    {
+        slot = _indexFind( pMqttConnection, type, *pPacketIdentifier );
+    }
+    else
+    {
+        EMPTY_ELSE_MARKER;
+    }
+
+    if( slot < IOT_MQTT_PENDING_RESPONSE_INDEX_SIZE )
+    {
+        pResult = pMqttConnection->pPendingResponseIndex[ slot ];
+    }
+    else if( ( pPacketIdentifier == NULL ) || ( pMqttConnection->pendingResponseUnindexed > 0U ) )
+    {
+        /* Find the first matching element in the list. */
+        pResultLink = IotListDouble_FindFirstMatch( &( pMqttConnection->pendingResponse ),
+                                                    NULL,
+                                                    _mqttOperation_match,
+                                                    &param );
+
+        if( pResultLink != NULL )
+        {
+            pResult = IotLink_Container( _mqttOperation_t, pResultLink, link );
+        }
+        else
+        {
+            EMPTY_ELSE_MARKER;
+        }
+    }
+    else
+    {
+        EMPTY_ELSE_MARKER;
+    }
 
     /* Check if a match was found. */
-    if( pResultLink != NULL )
+    if( pResult != NULL )
     {
-        /* Get operation pointer and check if it is waitable. */
-        pResult = IotLink_Container( _mqttOperation_t, pResultLink, link );
+        /* Check if the operation is waitable. */
         waitable = ( pResult->u.operation.flags & IOT_MQTT_FLAG_WAITABLE ) == IOT_MQTT_FLAG_WAITABLE;
 
         /* An operation with no retry in the pending responses list should
@@ -1370,8 +1679,10 @@ _mqttOperation_t * _IotMqtt_FindOperation( _mqttConnection_t * pMqttConnection,
                      pMqttConnection,
                      IotMqtt_OperationType( type ) );
 
-        /* Remove the matched operation from the list. */
+        /* Remove the matched operation from the list and the index. */
         IotListDouble_Remove( &( pResult->link ) );
+        ( void ) _indexRemove( pResult );
+        _clearUnindexed( pResult );
     }
     else
     {
@@ -117,6 +117,11 @@ IotMqttError_t _IotMqtt_AddSubscriptions( _mqttConnection_t * pMqttConnection,
                         ( void ) memcpy( connToContext[ contextIndex ].subscriptionArray[ index ].pTopicFilter,
                                          pSubscriptionList[ i ].pTopicFilter,
                                          ( size_t ) ( pSubscriptionList[ i ].topicFilterLength ) );
+
+                        /* Index the new subscription for incoming PUBLISH messages. */
+                        IotMqtt_InsertIntoTopicTrie( &( connToContext[ contextIndex ].subscriptionTrie ),
+                                                     connToContext[ contextIndex ].subscriptionArray,
+                                                     index );
                     }
                     else
                     {
@@ -186,15 +191,17 @@ void _IotMqtt_InvokeSubscriptionCallback( _mqttConnection_t * pMqttConnection,
     IotMqtt_Assert( mutexStatus == true );
 
     /* Search the subscription list for all matching subscriptions starting at
-     * the array head. */
+     * the array head. The topic trie finds them in array order, without checking
+     * every subscription. */
 
     while( index < MAX_NO_OF_MQTT_SUBSCRIPTIONS )
     {
         if( contextIndex >= 0 )
         {
-            index = IotMqtt_FindFirstMatch( &( connToContext[ contextIndex ].subscriptionArray[ 0 ] ),
-                                            index,
-                                            &topicMatchParams );
+            index = IotMqtt_FindFirstMatchInTrie( &( connToContext[ contextIndex ].subscriptionTrie ),
+                                                  &( connToContext[ contextIndex ].subscriptionArray[ 0 ] ),
+                                                  index,
+                                                  &topicMatchParams );
 
             /* No subscription found. Exit loop. */
             if( index == -1 )
@@ -66,6 +66,57 @@ static bool _packetMatch( _mqttSubscription_t * pSubscription,
 static bool _topicMatch( _mqttSubscription_t * pSubscription,
                          void * pMatch );
 
+/**
+ * @brief Hash a topic level for the topic trie.
+ *
+ * @param[in] pLevel The topic level, not including any `/`.
+ * @param[in] levelLength Length of `pLevel`.
+ *
+ * @return The 32-bit FNV-1a hash of the topic level.
+ */
+static uint32_t _hashTopicLevel( const char * pLevel,
+                                 uint16_t levelLength );
+
+/**
+ * @brief Allocate a node of the topic trie.
+ *
+ * @param[in] pTrie The topic trie.
+ * @param[in] levelHash Hash of the topic level of the new node.
+ * @param[in] levelLength Length of the topic level of the new node.
+ *
+ * @return The index of the new node; 0 if the trie is full.
+ */
+static uint16_t _allocateTopicNode( _mqttTopicTrie_t * pTrie,
+                                    uint32_t levelHash,
+                                    uint16_t levelLength );
+
+/**
+ * @brief Add the topic filter of a subscription to the topic trie.
+ *
+ * @param[in] pTrie The topic trie.
+ * @param[in] pSubscriptionArray Subscription array holding the subscription.
+ * @param[in] subscriptionIndex Index of the subscription to add.
+ *
+ * @return `true` if the subscription was added; `false` if the trie is full, the
+ * topic filter has too many levels, or a different topic filter with the same
+ * hashes is already in the trie.
+ */
+static bool _insertTopicFilter( _mqttTopicTrie_t * pTrie,
+                                const _mqttSubscription_t * pSubscriptionArray,
+                                int8_t subscriptionIndex );
+
+/**
+ * @brief Rebuild the topic trie from the subscriptions in use in a subscription
+ * array.
+ *
+ * @param[in] pTrie The topic trie.
+ * @param[in] pSubscriptionArray The subscription array.
+ *
+ * @return `true` if all subscriptions were added; `false` otherwise.
+ */
+static bool _rebuildTopicTrie( _mqttTopicTrie_t * pTrie,
+                               const _mqttSubscription_t * pSubscriptionArray );
+
 /*-----------------------------------------------------------*/
 
 static bool _packetMatch( _mqttSubscription_t * pSubscription,
@@ -137,10 +188,15 @@ static bool _topicMatch( _mqttSubscription_t * pSubscription,
     {
         status = ( strncmp( pTopicName, pTopicFilter, topicNameLength ) == 0 );
 
-        IOT_GOTO_CLEANUP();
+        /* A topic filter with wildcards may still match a topic name of the
+         * same length, e.g. "aws/+" and "aws/a". */
+        if( ( status == true ) || ( pParam->exactMatchOnly == true ) )
+        {
+            IOT_GOTO_CLEANUP();
+        }
     }
 
-    /* If the topic lengths are different but an exact match is required, return
+    /* If the topic is not an exact match but an exact match is required, return
      * false. */
     if( pParam->exactMatchOnly == true )
     {
@@ -228,6 +284,200 @@ static bool _topicMatch( _mqttSubscription_t * pSubscription,
 
 /*-----------------------------------------------------------*/
 
+static uint32_t _hashTopicLevel( const char * pLevel,
+                                 uint16_t levelLength )
+{
+    uint32_t hash = 2166136261UL;
+    uint16_t i = 0;
+
+    for( i = 0; i < levelLength; i++ )
+    {
+        hash ^= ( uint32_t ) ( uint8_t ) pLevel[ i ];
+        hash *= 16777619UL;
+    }
+
+    return hash;
+}
+
+/*-----------------------------------------------------------*/
+
+static uint16_t _allocateTopicNode( _mqttTopicTrie_t * pTrie,
+                                    uint32_t levelHash,
+                                    uint16_t levelLength )
+{
+    uint16_t nodeIndex = 0;
+    _mqttTopicNode_t * pNode = NULL;
+
+    /* Node 0 is the root, so 0 can report that the trie is full. */
+    if( pTrie->nodeCount < MAX_NO_OF_MQTT_TOPIC_TRIE_NODES )
+    {
+        nodeIndex = pTrie->nodeCount;
+        pTrie->nodeCount++;
+
+        pNode = &( pTrie->nodes[ nodeIndex ] );
+        ( void ) memset( pNode, 0x00, sizeof( _mqttTopicNode_t ) );
+        pNode->levelHash = levelHash;
+        pNode->levelLength = levelLength;
+        pNode->subscription = -1;
+        pNode->multiLevelSubscription = -1;
+    }
+
+    return nodeIndex;
+}
+
+/*-----------------------------------------------------------*/
+
+static bool _insertTopicFilter( _mqttTopicTrie_t * pTrie,
+                                const _mqttSubscription_t * pSubscriptionArray,
+                                int8_t subscriptionIndex )
+{
+    bool status = true;
+    uint16_t nodeIndex = 0, childIndex = 0;
+    uint16_t levelStart = 0, levelEnd = 0, levelLength = 0;
+    uint32_t levelHash = 0, depth = 0;
+    int8_t * pTerminal = NULL;
+    const _mqttSubscription_t * pSubscription = &( pSubscriptionArray[ subscriptionIndex ] );
+    const _mqttSubscription_t * pPrevious = NULL;
+    const char * pTopicFilter = pSubscription->pTopicFilter;
+    const uint16_t topicFilterLength = pSubscription->topicFilterLength;
+
+    /* Create the root of an empty trie. */
+    if( pTrie->nodeCount == 0 )
+    {
+        ( void ) _allocateTopicNode( pTrie, 0, 0 );
+    }
+
+    /* Walk down the trie one topic level at a time, adding the missing nodes.
+     * The topic filter was validated, so a '#' is always its last level. */
+    while( pTerminal == NULL )
+    {
+        levelEnd = levelStart;
+
+        while( ( levelEnd < topicFilterLength ) && ( pTopicFilter[ levelEnd ] != '/' ) )
+        {
+            levelEnd++;
+        }
+
+        levelLength = ( uint16_t ) ( levelEnd - levelStart );
+
+        if( ( levelLength == 1U ) && ( pTopicFilter[ levelStart ] == '#' ) )
+        {
+            pTerminal = &( pTrie->nodes[ nodeIndex ].multiLevelSubscription );
+            break;
+        }
+
+        depth++;
+
+        if( depth > MAX_NO_OF_MQTT_TOPIC_TRIE_LEVELS )
+        {
+            status = false;
+            break;
+        }
+
+        if( ( levelLength == 1U ) && ( pTopicFilter[ levelStart ] == '+' ) )
+        {
+            childIndex = pTrie->nodes[ nodeIndex ].singleLevelChild;
+
+            if( childIndex == 0U )
+            {
+                childIndex = _allocateTopicNode( pTrie, 0, 0 );
+                pTrie->nodes[ nodeIndex ].singleLevelChild = childIndex;
+            }
+        }
+        else
+        {
+            levelHash = _hashTopicLevel( &( pTopicFilter[ levelStart ] ), levelLength );
+            childIndex = pTrie->nodes[ nodeIndex ].firstChild;
+
+            while( ( childIndex != 0U ) &&
+                   ( ( pTrie->nodes[ childIndex ].levelHash != levelHash ) ||
+                     ( pTrie->nodes[ childIndex ].levelLength != levelLength ) ) )
+            {
+                childIndex = pTrie->nodes[ childIndex ].nextSibling;
+            }
+
+            if( childIndex == 0U )
+            {
+                childIndex = _allocateTopicNode( pTrie, levelHash, levelLength );
+
+                if( childIndex != 0U )
+                {
+                    pTrie->nodes[ childIndex ].nextSibling = pTrie->nodes[ nodeIndex ].firstChild;
+                    pTrie->nodes[ nodeIndex ].firstChild = childIndex;
+                }
+            }
+        }
+
+        if( childIndex == 0U )
+        {
+            /* The trie is full. */
+            status = false;
+            break;
+        }
+
+        nodeIndex = childIndex;
+
+        if( levelEnd == topicFilterLength )
+        {
+            pTerminal = &( pTrie->nodes[ nodeIndex ].subscription );
+        }
+        else
+        {
+            levelStart = ( uint16_t ) ( levelEnd + 1U );
+        }
+    }
+
+    if( status == true )
+    {
+        /* The node may still reference a removed subscription, or this one. It
+         * may only reference another subscription in use if that subscription has
+         * a different topic filter with the same hashes. */
+        if( ( *pTerminal != -1 ) && ( *pTerminal != subscriptionIndex ) )
+        {
+            pPrevious = &( pSubscriptionArray[ *pTerminal ] );
+
+            if( ( pPrevious->topicFilterLength != 0U ) &&
+                ( pPrevious->pTopicFilter != NULL ) &&
+                ( ( pPrevious->topicFilterLength != topicFilterLength ) ||
+                  ( strncmp( pPrevious->pTopicFilter, pTopicFilter, topicFilterLength ) != 0 ) ) )
+            {
+                status = false;
+            }
+        }
+
+        if( status == true )
+        {
+            *pTerminal = subscriptionIndex;
+        }
+    }
+
+    return status;
+}
+
+/*-----------------------------------------------------------*/
+
+static bool _rebuildTopicTrie( _mqttTopicTrie_t * pTrie,
+                               const _mqttSubscription_t * pSubscriptionArray )
+{
+    bool status = true;
+    int8_t index = 0;
+
+    pTrie->nodeCount = 0;
+
+    for( index = 0; ( status == true ) && ( index < MAX_NO_OF_MQTT_SUBSCRIPTIONS ); index++ )
+    {
+        if( ( pSubscriptionArray[ index ].topicFilterLength != 0U ) &&
+            ( pSubscriptionArray[ index ].pTopicFilter != NULL ) )
+        {
+            status = _insertTopicFilter( pTrie, pSubscriptionArray, index );
+        }
+    }
+
+    return status;
+}
+
+/*-----------------------------------------------------------*/
+
 int8_t IotMqtt_GetFreeIndexInSubscriptionArray( _mqttSubscription_t * pSubscriptionArray )
 {
     /* The shim supports only upto 128 subscriptions as the implementation uses 8 bit index. */
@@ -344,6 +594,144 @@ int8_t IotMqtt_FindFirstMatch( _mqttSubscription_t * pSubscriptionArray,
 
 /*-----------------------------------------------------------*/
 
+void IotMqtt_InsertIntoTopicTrie( _mqttTopicTrie_t * pTrie,
+                                  const _mqttSubscription_t * pSubscriptionArray,
+                                  int8_t subscriptionIndex )
+{
+    IotMqtt_Assert( pTrie != NULL );
+    IotMqtt_Assert( pSubscriptionArray != NULL );
+    IotMqtt_Assert( subscriptionIndex > -1 && subscriptionIndex < MAX_NO_OF_MQTT_SUBSCRIPTIONS );
+
+    if( ( pTrie->incomplete == true ) ||
+        ( _insertTopicFilter( pTrie, pSubscriptionArray, subscriptionIndex ) == false ) )
+    {
+        /* Drop the nodes of removed subscriptions by rebuilding the trie, which
+         * also adds this subscription. */
+        pTrie->incomplete = ( _rebuildTopicTrie( pTrie, pSubscriptionArray ) == false );
+
+        if( pTrie->incomplete == true )
+        {
+            IotLogWarn( "Topic trie is full, incoming PUBLISH messages will be matched by scanning all subscriptions. "
+                        "Consider updating the MAX_NO_OF_MQTT_TOPIC_TRIE_NODES config to resolve the issue." );
+        }
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+int8_t IotMqtt_FindFirstMatchInTrie( const _mqttTopicTrie_t * pTrie,
+                                     _mqttSubscription_t * pSubscriptionArray,
+                                     int8_t startIndex,
+                                     _topicMatchParams_t * pMatch )
+{
+    int8_t matchedIndex = -1;
+    int8_t candidates[ 2 ] = { -1, -1 };
+    uint16_t nodeStack[ MAX_NO_OF_MQTT_TOPIC_TRIE_LEVELS + 1 ] = { 0 };
+    uint32_t levelStack[ MAX_NO_OF_MQTT_TOPIC_TRIE_LEVELS + 1 ] = { 0 };
+    uint32_t stackDepth = 0, levelStart = 0, levelEnd = 0, i = 0;
+    uint32_t levelHash = 0;
+    uint16_t childIndex = 0;
+    const _mqttTopicNode_t * pNode = NULL;
+
+    IotMqtt_Assert( pTrie != NULL );
+    IotMqtt_Assert( pSubscriptionArray != NULL );
+    IotMqtt_Assert( startIndex >= 0 );
+
+    const char * pTopicName = pMatch->pTopicName;
+    const uint32_t topicNameLength = pMatch->topicNameLength;
+
+    /* Topic filters are matched exactly when subscribing and unsubscribing, which
+     * does not need the trie. */
+    if( ( pTrie->incomplete == true ) || ( pMatch->exactMatchOnly == true ) )
+    {
+        matchedIndex = IotMqtt_FindFirstMatch( pSubscriptionArray, startIndex, pMatch );
+    }
+    else if( pTrie->nodeCount > 0U )
+    {
+        /* Depth-first search of the trie, starting at the root and the first topic
+         * level. At most two children of a node match the next topic level, and
+         * nodes are at most MAX_NO_OF_MQTT_TOPIC_TRIE_LEVELS deep, which bounds
+         * the stack. A level start past the end of the topic name means that all
+         * levels were matched. */
+        nodeStack[ 0 ] = 0;
+        levelStack[ 0 ] = 0;
+        stackDepth = 1;
+
+        while( stackDepth > 0U )
+        {
+            stackDepth--;
+            pNode = &( pTrie->nodes[ nodeStack[ stackDepth ] ] );
+            levelStart = levelStack[ stackDepth ];
+
+            /* A '#' after this node matches all remaining levels, including none. */
+            candidates[ 0 ] = pNode->multiLevelSubscription;
+            candidates[ 1 ] = -1;
+
+            if( levelStart > topicNameLength )
+            {
+                candidates[ 1 ] = pNode->subscription;
+            }
+            else
+            {
+                levelEnd = levelStart;
+
+                while( ( levelEnd < topicNameLength ) && ( pTopicName[ levelEnd ] != '/' ) )
+                {
+                    levelEnd++;
+                }
+
+                levelHash = _hashTopicLevel( &( pTopicName[ levelStart ] ), ( uint16_t ) ( levelEnd - levelStart ) );
+                childIndex = pNode->firstChild;
+
+                while( ( childIndex != 0U ) &&
+                       ( ( pTrie->nodes[ childIndex ].levelHash != levelHash ) ||
+                         ( pTrie->nodes[ childIndex ].levelLength != ( levelEnd - levelStart ) ) ) )
+                {
+                    childIndex = pTrie->nodes[ childIndex ].nextSibling;
+                }
+
+                if( childIndex != 0U )
+                {
+                    IotMqtt_Assert( stackDepth < ( MAX_NO_OF_MQTT_TOPIC_TRIE_LEVELS + 1 ) );
+                    nodeStack[ stackDepth ] = childIndex;
+                    levelStack[ stackDepth ] = levelEnd + 1U;
+                    stackDepth++;
+                }
+
+                if( pNode->singleLevelChild != 0U )
+                {
+                    IotMqtt_Assert( stackDepth < ( MAX_NO_OF_MQTT_TOPIC_TRIE_LEVELS + 1 ) );
+                    nodeStack[ stackDepth ] = pNode->singleLevelChild;
+                    levelStack[ stackDepth ] = levelEnd + 1U;
+                    stackDepth++;
+                }
+            }
+
+            /* Keep the first subscription in the array that still matches. The
+             * trie may reference removed subscriptions, and topic levels with the
+             * same hash, so candidates are checked against their topic filter. */
+            for( i = 0; i < 2U; i++ )
+            {
+                if( ( candidates[ i ] >= startIndex ) &&
+                    ( ( matchedIndex == -1 ) || ( candidates[ i ] < matchedIndex ) ) &&
+                    ( pSubscriptionArray[ candidates[ i ] ].pTopicFilter != NULL ) &&
+                    ( _topicMatch( &( pSubscriptionArray[ candidates[ i ] ] ), pMatch ) == true ) )
+                {
+                    matchedIndex = candidates[ i ];
+                }
+            }
+        }
+    }
+    else
+    {
+        EMPTY_ELSE_MARKER;
+    }
+
+    return matchedIndex;
+}
+
+/*-----------------------------------------------------------*/
+
 /* Provide access to internal functions and variables if testing. */
 #if IOT_BUILD_TESTS == 1
     #include "iot_test_access_mqtt_subscription.c"
@@ -271,6 +271,28 @@
     #define MAX_NO_OF_MQTT_SUBSCRIPTIONS    ( 10 )
 #endif
 
+/**
+ * @brief Default config for Maximum Number of nodes in the topic trie of an MQTT
+ * connection.
+ * The topic trie indexes the subscriptions of a connection by topic level. Each
+ * level of a topic filter that is not shared with another topic filter takes one
+ * node. If the trie runs out of nodes, incoming PUBLISH messages are matched by
+ * scanning the subscription array instead.
+ */
+#ifndef MAX_NO_OF_MQTT_TOPIC_TRIE_NODES
+    #define MAX_NO_OF_MQTT_TOPIC_TRIE_NODES    ( MAX_NO_OF_MQTT_SUBSCRIPTIONS * 4 )
+#endif
+
+/**
+ * @brief Default config for Maximum Number of levels of a topic filter kept in the
+ * topic trie.
+ * AWS IoT allows at most 7 forward slashes in a topic. Subscriptions with deeper
+ * topic filters are still supported, but disable the topic trie.
+ */
+#ifndef MAX_NO_OF_MQTT_TOPIC_TRIE_LEVELS
+    #define MAX_NO_OF_MQTT_TOPIC_TRIE_LEVELS    ( 8 )
+#endif
+
 /**
  * @brief Static buffer size provided to MQTT LTS API.
  * This buffer will be used to send the packets on the network.
@@ -279,6 +301,64 @@
 #ifndef NETWORK_BUFFER_SIZE
     #define NETWORK_BUFFER_SIZE    ( 1024U )
 #endif
+
+/**
+ * @brief Default config for the receive buffer pool.
+ *
+ * Incoming packets are received into buffers borrowed from a pool with one slab
+ * of fixed-size buffers per size class. A packet uses the smallest free buffer
+ * that fits its remaining length, and is allocated with #IotMqtt_MallocMessage
+ * only if no such buffer is free. Setting the count of a size class to 0 removes
+ * that size class from the pool. The buffer sizes must be in increasing order.
+ *
+ * The pool is statically allocated, so it costs the sum of size * count bytes of
+ * RAM plus one small descriptor per buffer, whether or not it is used. It is
+ * therefore empty by default, and every packet is allocated with
+ * #IotMqtt_MallocMessage. For example, 4 small buffers of 64 bytes, 2 medium
+ * buffers of 256 bytes, and 1 large buffer of 1024 bytes take 1792 bytes of data.
+ */
+#ifndef IOT_MQTT_RECEIVE_POOL_SMALL_SIZE
+    #define IOT_MQTT_RECEIVE_POOL_SMALL_SIZE     ( 64U )
+#endif
+#ifndef IOT_MQTT_RECEIVE_POOL_SMALL_COUNT
+    #define IOT_MQTT_RECEIVE_POOL_SMALL_COUNT    ( 0U )
+#endif
+#ifndef IOT_MQTT_RECEIVE_POOL_MEDIUM_SIZE
+    #define IOT_MQTT_RECEIVE_POOL_MEDIUM_SIZE    ( 256U )
+#endif
+#ifndef IOT_MQTT_RECEIVE_POOL_MEDIUM_COUNT
+    #define IOT_MQTT_RECEIVE_POOL_MEDIUM_COUNT   ( 0U )
+#endif
+#ifndef IOT_MQTT_RECEIVE_POOL_LARGE_SIZE
+    #define IOT_MQTT_RECEIVE_POOL_LARGE_SIZE     ( 1024U )
+#endif
+#ifndef IOT_MQTT_RECEIVE_POOL_LARGE_COUNT
+    #define IOT_MQTT_RECEIVE_POOL_LARGE_COUNT    ( 0U )
+#endif
+
+/**
+ * @brief Default config for the number of PUBLISH operations that
+ * @ref mqtt_function_publishbatch creates and sends at once.
+ *
+ * Longer batches are sent in several rounds. Each round takes the MQTT context
+ * mutex once and keeps one pointer per PUBLISH on the stack.
+ */
+#ifndef IOT_MQTT_PUBLISH_BATCH_ROUND_SIZE
+    #define IOT_MQTT_PUBLISH_BATCH_ROUND_SIZE    ( 16U )
+#endif
+
+/**
+ * @brief Default config for the number of slots in the index of operations
+ * awaiting a server response. Must be a power of 2.
+ *
+ * Operations with a packet identifier are indexed so that acknowledgements are
+ * matched in constant time. The index is filled to at most 3/4 of its slots;
+ * operations beyond that are still found, but by searching the list of pending
+ * responses.
+ */
+#ifndef IOT_MQTT_PENDING_RESPONSE_INDEX_SIZE
+    #define IOT_MQTT_PENDING_RESPONSE_INDEX_SIZE    ( 64U )
+#endif
 /*---------------------- MQTT internal data structures ----------------------*/
 
 /**
@@ -291,6 +371,19 @@ typedef struct MqttTransportParams
     const IotNetworkInterface_t * pNetworkInterface; /**< @brief The network interface used to send packets on the network using the above network connection. */
 } MqttTransportParams_t;
 
+/**
+ * @brief A buffer holding the remaining data of an incoming packet.
+ *
+ * Receive buffers are reference counted so that PUBLISH callbacks may keep the
+ * buffer of a message after returning; see @ref mqtt_function_retainmessage.
+ */
+typedef struct _mqttReceiveBuffer
+{
+    uint32_t references; /**< @brief Number of owners of this buffer. A pool buffer is free when this is 0. Updated atomically. */
+    int32_t sizeClass;   /**< @brief The size class of the pool this buffer belongs to; -1 for a buffer allocated with #IotMqtt_MallocMessage. */
+    uint8_t * pData;     /**< @brief The data of this buffer. */
+} _mqttReceiveBuffer_t;
+
 /**
  * @brief Represents an MQTT connection.
  */
@@ -312,6 +405,14 @@ typedef struct _mqttConnection
     IotListDouble_t pendingProcessing;           /**< @brief List of operations waiting to be processed by a task pool routine. */
     IotListDouble_t pendingResponse;             /**< @brief List of processed operations awaiting a server response. */
 
+    /**
+     * @brief Open-addressing index of the operations in pendingResponse, keyed
+     * by packet identifier.
+     */
+    struct _mqttOperation * pPendingResponseIndex[ IOT_MQTT_PENDING_RESPONSE_INDEX_SIZE ];
+    size_t pendingResponseIndexed;               /**< @brief Number of operations in pPendingResponseIndex. */
+    size_t pendingResponseUnindexed;             /**< @brief Number of operations in pendingResponse missing from the index because it was full. */
+
     uint64_t lastMessageTime;                    /**< @brief When the most recent message was transmitted. */
     bool keepAliveFailure;                       /**< @brief Failure flag for keep-alive operation. */
     uint32_t keepAliveMs;                        /**< @brief Keep-alive interval in milliseconds. Its max value (per spec) is 65,535,000. */
@@ -381,6 +482,7 @@ typedef struct _mqttOperation
             IotMqttOperationType_t type; /**< @brief What operation this structure represents. */
             uint32_t flags;              /**< @brief Flags passed to the function that created this operation. */
             uint16_t packetIdentifier;   /**< @brief The packet identifier used with this operation. */
+            bool unindexed;              /**< @brief Set while this operation awaits a response but is missing from the connection's index of pending responses. */
 
             /* Serialized packet and size. */
             uint8_t * pMqttPacket;           /**< @brief The MQTT packet to send over the network. */
@@ -406,10 +508,10 @@ typedef struct _mqttOperation
         /* If incomingPublish is true, this struct is valid. */
         struct
         {
-            IotMqttPublishInfo_t publishInfo; /**< @brief Deserialized PUBLISH. */
-            const void * pReceivedData;       /**< @brief Any buffer associated with this PUBLISH that should be freed. */
+            IotMqttPublishInfo_t publishInfo;     /**< @brief Deserialized PUBLISH. */
+            _mqttReceiveBuffer_t * pReceivedData; /**< @brief Any buffer associated with this PUBLISH that should be released. */
         } publish;
-    } u;                                      /**< @brief Valid member depends on _mqttOperation_t.incomingPublish. */
+    } u;                                          /**< @brief Valid member depends on _mqttOperation_t.incomingPublish. */
 } _mqttOperation_t;
 
 /**
@@ -433,14 +535,50 @@ typedef struct _mqttPacket
          * when deserializing PUBLISHes.
          */
         _mqttOperation_t * pIncomingPublish;
-    } u;                       /**< @brief Valid member depends on packet being decoded. */
+    } u;                            /**< @brief Valid member depends on packet being decoded. */
 
-    uint8_t * pRemainingData;  /**< @brief (Input) The remaining data in MQTT packet. */
-    size_t remainingLength;    /**< @brief (Input) Length of the remaining data in the MQTT packet. */
-    uint16_t packetIdentifier; /**< @brief (Output) MQTT packet identifier. */
-    uint8_t type;              /**< @brief (Input) A value identifying the packet type. */
+    uint8_t * pRemainingData;       /**< @brief (Input) The remaining data in MQTT packet. */
+    _mqttReceiveBuffer_t * pBuffer; /**< @brief (Input) The receive buffer holding `pRemainingData`, if any. */
+    size_t remainingLength;         /**< @brief (Input) Length of the remaining data in the MQTT packet. */
+    uint16_t packetIdentifier;      /**< @brief (Output) MQTT packet identifier. */
+    uint8_t type;                   /**< @brief (Input) A value identifying the packet type. */
 } _mqttPacket_t;
 
+/**
+ * @brief A node of the topic trie, representing one level of one or more topic
+ * filters.
+ *
+ * Nodes do not keep the text of their topic level, only its hash and length.
+ * Topic levels with the same hash share a node, so every subscription found in
+ * the trie is checked against its topic filter before it is used.
+ */
+typedef struct _mqttTopicNode
+{
+    uint32_t levelHash;             /**< @brief Hash of the topic level matched by this node. */
+    uint16_t levelLength;           /**< @brief Length of the topic level matched by this node. */
+    uint16_t firstChild;            /**< @brief First child of this node for a literal topic level, 0 if none. */
+    uint16_t nextSibling;           /**< @brief Next child of the parent of this node, 0 if none. */
+    uint16_t singleLevelChild;      /**< @brief Child of this node for the `+` wildcard, 0 if none. */
+    int8_t subscription;            /**< @brief Subscription whose topic filter ends at this node, -1 if none. */
+    int8_t multiLevelSubscription;  /**< @brief Subscription whose topic filter ends with `#` after this node, -1 if none. */
+} _mqttTopicNode_t;
+
+/**
+ * @brief Indexes the subscriptions of an MQTT connection by topic level, so that
+ * an incoming PUBLISH is matched in time proportional to the number of levels in
+ * its topic name.
+ *
+ * The trie is an index of the subscription array: it is only added to, and it is
+ * rebuilt from the subscription array when it runs out of nodes. Removed
+ * subscriptions are skipped when matching. A zeroed trie is empty.
+ */
+typedef struct _mqttTopicTrie
+{
+    _mqttTopicNode_t nodes[ MAX_NO_OF_MQTT_TOPIC_TRIE_NODES ]; /**< @brief Node storage. The root is the first node. */
+    uint16_t nodeCount;                                        /**< @brief Number of nodes in use. */
+    bool incomplete;                                           /**< @brief Set if a subscription could not be added; the subscription array is then scanned. */
+} _mqttTopicTrie_t;
+
 /**
  * @brief Represents a mapping of MQTT Connection in MQTT 201906.00 library to the corresponding MQTT context
  * used in MQTT LTS library. MQTT Context is used to call the MQTT LTS API from the shim to serialize
@@ -456,6 +594,7 @@ typedef struct connContextMapping
     _mqttSubscription_t subscriptionArray[ MAX_NO_OF_MQTT_SUBSCRIPTIONS ]; /**< @brief Holds subscriptions associated with this connection. */
     StaticSemaphore_t subscriptionMutexStorage;                            /**< @brief Static storage for Mutex for synchronization of subscription list. */
     SemaphoreHandle_t subscriptionMutex;                                   /**< @brief Grants exclusive access to the subscription list. */
+    _mqttTopicTrie_t subscriptionTrie;                                     /**< @brief Indexes #_connContext_t.subscriptionArray by topic level. Protected by the subscription mutex. */
     MqttTransportParams_t mqttTransportParams;                             /**< @brief MQTT Transport Params holds the network interface and network connection. */
 } _connContext_t;
 
@@ -683,10 +822,35 @@ IotMqttError_t _IotMqtt_ScheduleOperation( _mqttOperation_t * pOperation,
                                            IotTaskPoolRoutine_t jobRoutine,
                                            uint32_t delay );
 
+/**
+ * @brief Add an MQTT operation to the list of operations pending responses,
+ * indexing it by packet identifier.
+ *
+ * The operation must not be linked in any list. The caller must hold the
+ * connection's references mutex.
+ *
+ * @param[in] pOperation The operation now awaiting a server response.
+ */
+void _IotMqtt_InsertPendingResponse( _mqttOperation_t * pOperation );
+
+/**
+ * @brief Remove all operations from the index of operations pending responses.
+ *
+ * Called when the list of operations pending responses is emptied without
+ * @ref _IotMqtt_FindOperation. The caller must hold the connection's references
+ * mutex.
+ *
+ * @param[in] pMqttConnection The connection whose index to clear.
+ */
+void _IotMqtt_ClearPendingResponseIndex( _mqttConnection_t * pMqttConnection );
+
 /**
  * @brief Search a list of MQTT operations pending responses using an operation
  * name and packet identifier. Removes a matching operation from the list if found.
  *
+ * Searches with a packet identifier use the index of pending responses, so they
+ * take constant time while the index has room.
+ *
  * @param[in] pMqttConnection The connection associated with the operation.
  * @param[in] type The operation type to look for.
  * @param[in] pPacketIdentifier A packet identifier to match. Pass `NULL` to ignore.
@@ -813,6 +977,24 @@ bool _IotMqtt_GetNextByte( void * pNetworkConnection,
 void _IotMqtt_CloseNetworkConnection( IotMqttDisconnectReason_t disconnectReason,
                                       _mqttConnection_t * pMqttConnection );
 
+/**
+ * @brief Borrow a receive buffer for the remaining data of an incoming packet.
+ *
+ * @param[in] length The number of bytes needed.
+ *
+ * @return A receive buffer with a reference count of 1; `NULL` if no memory is
+ * available.
+ */
+_mqttReceiveBuffer_t * _IotMqtt_GetReceiveBuffer( size_t length );
+
+/**
+ * @brief Release one reference to a receive buffer, returning the buffer to its
+ * pool or freeing it when it has no more references.
+ *
+ * @param[in] pBuffer The receive buffer to release.
+ */
+void _IotMqtt_ReleaseReceiveBuffer( _mqttReceiveBuffer_t * pBuffer );
+
 /*----------------- MQTT Serialization /Deserialization Wrapper functions for Shim------------------*/
 
 /**
@@ -1043,6 +1225,34 @@ void _IotMqtt_removeContext( IotMqttConnection_t mqttConnection );
  */
 IotMqttError_t _IotMqtt_managedDisconnect( IotMqttConnection_t mqttConnection );
 
+/**
+ * @brief Send several PUBLISH packets, coalescing them into the network buffer
+ * of the MQTT context.
+ *
+ * The MQTT context mutex is taken once for all packets. Packets are serialized
+ * back to back into the network buffer, which is sent with a single transport
+ * send whenever the next packet does not fit. A packet larger than the network
+ * buffer is sent on its own with the MQTT LTS PUBLISH API.
+ *
+ * @param[in] mqttConnection The MQTT connection to be used.
+ * @param[in] pOperations The PUBLISH operations, one for each PUBLISH. Their packet
+ * identifiers are set by this function.
+ * @param[in] pPublishInfoList The information to be published.
+ * @param[in] publishCount The number of entries in `pOperations` and `pPublishInfoList`.
+ * @param[out] pSentCount Set to the number of PUBLISH packets sent, which are
+ * always the first ones of `pPublishInfoList`.
+ *
+ * @return #IOT_MQTT_NO_MEMORY if no more QoS 1 PUBLISH packets can be tracked;
+ * #IOT_MQTT_BAD_PARAMETER if invalid parameters are passed;
+ * #IOT_MQTT_NETWORK_ERROR if transport send failed;
+ * #IOT_MQTT_SUCCESS otherwise.
+ */
+IotMqttError_t _IotMqtt_managedPublishBatch( IotMqttConnection_t mqttConnection,
+                                             _mqttOperation_t * const * pOperations,
+                                             const IotMqttPublishInfo_t * pPublishInfoList,
+                                             size_t publishCount,
+                                             size_t * pSentCount );
+
 /**
  * @brief Send the PUBLISH packet using MQTT LTS PUBLISH API.
  *
@@ -1171,6 +1381,40 @@ int8_t IotMqtt_FindFirstMatch( _mqttSubscription_t * pSubscriptionArray,
                                int8_t startIndex,
                                _topicMatchParams_t * pMatch );
 
+/**
+ * @brief Add a subscription of the given subscription array to its topic trie.
+ *
+ * If the trie is full, it is rebuilt from the subscriptions in the array. If the
+ * subscription still cannot be added, the trie is marked incomplete and
+ * #IotMqtt_FindFirstMatchInTrie scans the subscription array until a later
+ * rebuild succeeds.
+ *
+ * @param[in] pTrie The topic trie of `pSubscriptionArray`.
+ * @param[in] pSubscriptionArray Subscription array holding the subscription.
+ * @param[in] subscriptionIndex Index of the subscription to add.
+ */
+void IotMqtt_InsertIntoTopicTrie( _mqttTopicTrie_t * pTrie,
+                                  const _mqttSubscription_t * pSubscriptionArray,
+                                  int8_t subscriptionIndex );
+
+/**
+ * @brief Find the first subscription matching a topic name using the topic trie.
+ *
+ * This function returns the same subscription as #IotMqtt_FindFirstMatch for
+ * the same arguments.
+ *
+ * @param[in] pTrie The topic trie of `pSubscriptionArray`.
+ * @param[in] pSubscriptionArray Subscription array from which the subscription needs to be matched.
+ * @param[in] startIndex Only subscriptions from this index to the end of the array are matched.
+ * @param[in] pMatch Contains the parameters used for matching the subscription.
+ *
+ * @return The index of the first matching subscription, -1 if none.
+ */
+int8_t IotMqtt_FindFirstMatchInTrie( const _mqttTopicTrie_t * pTrie,
+                                     _mqttSubscription_t * pSubscriptionArray,
+                                     int8_t startIndex,
+                                     _topicMatchParams_t * pMatch );
+
 /*-----------------------------------Mutexes Wrappers--------------------------------------------*/
 
 /**
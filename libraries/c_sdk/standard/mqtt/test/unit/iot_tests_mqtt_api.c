@@ -130,6 +130,11 @@
  */
 #define DISCONNECT_MALLOC_LIMIT    ( 20 )
 
+/**
+ * @brief Number of messages sent by the PUBLISH batch tests.
+ */
+#define PUBLISH_BATCH_COUNT        ( 200 )
+
 /*
  * Constants that affect the behavior of #TEST_MQTT_Unit_API_PublishDuplicates.
  */
@@ -174,6 +179,11 @@ static bool _publishSetDupCalled = false;
  */
 static int32_t _pingreqSendCount = 0;
 
+/**
+ * @brief Counts the number of network sends made by #_sendCounting.
+ */
+static uint32_t _networkSendCount = 0;
+
 /**
  * @brief Counts how many times #_close has been called.
  */
@@ -326,6 +336,25 @@ static size_t _sendSuccess( void * pSendContext,
 
 /*-----------------------------------------------------------*/
 
+/**
+ * @brief A send function that always "succeeds" and counts how many times it
+ * was invoked.
+ */
+static size_t _sendCounting( void * pSendContext,
+                             const uint8_t * pMessage,
+                             size_t messageLength )
+{
+    /* Silence warnings about unused parameters. */
+    ( void ) pSendContext;
+    ( void ) pMessage;
+
+    _networkSendCount++;
+
+    return messageLength;
+}
+
+/*-----------------------------------------------------------*/
+
 /**
  * @brief A send function for PINGREQ that responds with a PINGRESP.
  */
@@ -812,16 +841,9 @@ static bool _isEmpty( _mqttSubscription_t * pSubscriptionArray )
 /*-----------------------------------------------------------*/
 
 /**
- * @brief Test group for MQTT API tests.
+ * @brief Reset the test network interface and counters, and initialize the libraries.
  */
-TEST_GROUP( MQTT_Unit_API );
-
-/*-----------------------------------------------------------*/
-
-/**
- * @brief Test setup for MQTT API tests.
- */
-TEST_SETUP( MQTT_Unit_API )
+static void _setUpTest( void )
 {
     _publishSetDupCalled = false;
     _pingreqSendCount = 0;
@@ -845,9 +867,9 @@ TEST_SETUP( MQTT_Unit_API )
 /*-----------------------------------------------------------*/
 
 /**
- * @brief Test tear down for MQTT API tests.
+ * @brief Clean up the libraries initialized by #_setUpTest.
  */
-TEST_TEAR_DOWN( MQTT_Unit_API )
+static void _tearDownTest( void )
 {
     IotMqtt_Cleanup();
     IotSdk_Cleanup();
@@ -855,6 +877,33 @@ TEST_TEAR_DOWN( MQTT_Unit_API )
 
 /*-----------------------------------------------------------*/
 
+/**
+ * @brief Test group for MQTT API tests.
+ */
+TEST_GROUP( MQTT_Unit_API );
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test setup for MQTT API tests.
+ */
+TEST_SETUP( MQTT_Unit_API )
+{
+    _setUpTest();
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test tear down for MQTT API tests.
+ */
+TEST_TEAR_DOWN( MQTT_Unit_API )
+{
+    _tearDownTest();
+}
+
+/*-----------------------------------------------------------*/
+
 /**
  * @brief Test group runner for MQTT API tests.
  */
@@ -869,6 +918,8 @@ TEST_GROUP_RUNNER( MQTT_Unit_API )
     RUN_TEST_CASE( MQTT_Unit_API, PublishQoS0Parameters );
     RUN_TEST_CASE( MQTT_Unit_API, PublishQoS0MallocFail );
     RUN_TEST_CASE( MQTT_Unit_API, PublishQoS1 );
+    RUN_TEST_CASE( MQTT_Unit_API, PublishBatch );
+    RUN_TEST_CASE( MQTT_Unit_API, PublishBatchCoalesce );
     RUN_TEST_CASE( MQTT_Unit_API, SubscribeUnsubscribeParameters );
     RUN_TEST_CASE( MQTT_Unit_API, SubscribeMallocFail );
     RUN_TEST_CASE( MQTT_Unit_API, UnsubscribeMallocFail );
@@ -1423,6 +1474,156 @@ TEST( MQTT_Unit_API, PublishQoS1 )
 
 /*-----------------------------------------------------------*/
 
+/**
+ * @brief Tests the behavior of @ref mqtt_function_publishbatch with invalid
+ * parameters and with a mix of QoS 0 and QoS 1 messages.
+ */
+TEST( MQTT_Unit_API, PublishBatch )
+{
+    size_t i = 0;
+    IotMqttError_t status = IOT_MQTT_STATUS_PENDING;
+    IotMqttPublishInfo_t publishInfo[ 3 ] =
+    {
+        IOT_MQTT_PUBLISH_INFO_INITIALIZER,
+        IOT_MQTT_PUBLISH_INFO_INITIALIZER,
+        IOT_MQTT_PUBLISH_INFO_INITIALIZER
+    };
+    IotMqttOperation_t publishOperations[ 3 ] =
+    {
+        IOT_MQTT_OPERATION_INITIALIZER,
+        IOT_MQTT_OPERATION_INITIALIZER,
+        IOT_MQTT_OPERATION_INITIALIZER
+    };
+
+    /* Initialize parameters. */
+    _networkInterface.send = _sendSuccess;
+
+    /* Create a new MQTT connection. */
+    _pMqttConnection = IotTestMqtt_createMqttConnection( AWS_IOT_MQTT_SERVER,
+                                                         &_networkInfo,
+                                                         0 );
+    TEST_ASSERT_NOT_NULL( _pMqttConnection );
+
+    /* Set the MQTT Context for the new MQTT Connection*/
+    TEST_ASSERT_EQUAL( IOT_MQTT_SUCCESS, _setContext( _pMqttConnection, transportSend ) );
+
+    /* Set the publish info. The middle message is QoS 1. */
+    for( i = 0; i < 3; i++ )
+    {
+        publishInfo[ i ].qos = ( i == 1 ) ? IOT_MQTT_QOS_1 : IOT_MQTT_QOS_0;
+        publishInfo[ i ].pTopicName = TEST_TOPIC_NAME;
+        publishInfo[ i ].topicNameLength = TEST_TOPIC_NAME_LENGTH;
+    }
+
+    if( TEST_PROTECT() )
+    {
+        /* An empty batch is not allowed. */
+        status = IotMqtt_PublishBatch( _pMqttConnection, publishInfo, 0, 0, NULL );
+        TEST_ASSERT_EQUAL( IOT_MQTT_BAD_PARAMETER, status );
+
+        status = IotMqtt_PublishBatch( _pMqttConnection, NULL, 3, 0, NULL );
+        TEST_ASSERT_EQUAL( IOT_MQTT_BAD_PARAMETER, status );
+
+        /* Setting the waitable flag with no references is not allowed. */
+        status = IotMqtt_PublishBatch( _pMqttConnection,
+                                       publishInfo,
+                                       3,
+                                       IOT_MQTT_FLAG_WAITABLE,
+                                       NULL );
+        TEST_ASSERT_EQUAL( IOT_MQTT_BAD_PARAMETER, status );
+
+        /* An invalid message anywhere in the batch rejects the whole batch. */
+        publishInfo[ 2 ].pTopicName = NULL;
+        status = IotMqtt_PublishBatch( _pMqttConnection,
+                                       publishInfo,
+                                       3,
+                                       IOT_MQTT_FLAG_WAITABLE,
+                                       publishOperations );
+        TEST_ASSERT_EQUAL( IOT_MQTT_BAD_PARAMETER, status );
+        TEST_ASSERT_EQUAL_PTR( IOT_MQTT_OPERATION_INITIALIZER, publishOperations[ 1 ] );
+        publishInfo[ 2 ].pTopicName = TEST_TOPIC_NAME;
+
+        /* Send the batch. Only the QoS 1 message should have a reference. */
+        status = IotMqtt_PublishBatch( _pMqttConnection,
+                                       publishInfo,
+                                       3,
+                                       IOT_MQTT_FLAG_WAITABLE,
+                                       publishOperations );
+        TEST_ASSERT_EQUAL( IOT_MQTT_STATUS_PENDING, status );
+        TEST_ASSERT_EQUAL_PTR( IOT_MQTT_OPERATION_INITIALIZER, publishOperations[ 0 ] );
+        TEST_ASSERT_NOT_NULL( publishOperations[ 1 ] );
+        TEST_ASSERT_EQUAL_PTR( IOT_MQTT_OPERATION_INITIALIZER, publishOperations[ 2 ] );
+
+        /* No PUBACK is received, so the QoS 1 message should time out. */
+        TEST_ASSERT_EQUAL( IOT_MQTT_TIMEOUT, IotMqtt_Wait( publishOperations[ 1 ], TIMEOUT_MS ) );
+    }
+
+    /* Clean up MQTT connection. */
+    IotMqtt_Disconnect( _pMqttConnection, IOT_MQTT_FLAG_CLEANUP_ONLY );
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Tests that @ref mqtt_function_publishbatch sends QoS 0 messages with
+ * fewer network sends than one @ref mqtt_function_publish call per message.
+ */
+TEST( MQTT_Unit_API, PublishBatchCoalesce )
+{
+    size_t i = 0;
+    uint32_t publishSendCount = 0;
+    static IotMqttPublishInfo_t publishInfo[ PUBLISH_BATCH_COUNT ];
+
+    /* Initialize parameters. */
+    _networkInterface.send = _sendCounting;
+
+    /* Create a new MQTT connection. */
+    _pMqttConnection = IotTestMqtt_createMqttConnection( AWS_IOT_MQTT_SERVER,
+                                                         &_networkInfo,
+                                                         0 );
+    TEST_ASSERT_NOT_NULL( _pMqttConnection );
+
+    /* Set the MQTT Context for the new MQTT Connection*/
+    TEST_ASSERT_EQUAL( IOT_MQTT_SUCCESS, _setContext( _pMqttConnection, transportSend ) );
+
+    for( i = 0; i < PUBLISH_BATCH_COUNT; i++ )
+    {
+        publishInfo[ i ] = ( IotMqttPublishInfo_t ) IOT_MQTT_PUBLISH_INFO_INITIALIZER;
+        publishInfo[ i ].qos = IOT_MQTT_QOS_0;
+        publishInfo[ i ].pTopicName = TEST_TOPIC_NAME;
+        publishInfo[ i ].topicNameLength = TEST_TOPIC_NAME_LENGTH;
+        publishInfo[ i ].pPayload = "sample";
+        publishInfo[ i ].payloadLength = 6;
+    }
+
+    if( TEST_PROTECT() )
+    {
+        _networkSendCount = 0;
+
+        for( i = 0; i < PUBLISH_BATCH_COUNT; i++ )
+        {
+            TEST_ASSERT_EQUAL( IOT_MQTT_SUCCESS,
+                               IotMqtt_Publish( _pMqttConnection, &( publishInfo[ i ] ), 0, NULL, NULL ) );
+        }
+
+        publishSendCount = _networkSendCount;
+        _networkSendCount = 0;
+
+        TEST_ASSERT_EQUAL( IOT_MQTT_SUCCESS,
+                           IotMqtt_PublishBatch( _pMqttConnection, publishInfo, PUBLISH_BATCH_COUNT, 0, NULL ) );
+
+        /* Every message needs at least one send on its own; batching must
+         * coalesce them into fewer sends. */
+        TEST_ASSERT_TRUE( publishSendCount >= PUBLISH_BATCH_COUNT );
+        TEST_ASSERT_LESS_THAN( publishSendCount, _networkSendCount );
+    }
+
+    /* Clean up MQTT connection. */
+    IotMqtt_Disconnect( _pMqttConnection, IOT_MQTT_FLAG_CLEANUP_ONLY );
+}
+
+/*-----------------------------------------------------------*/
+
 /**
  * @brief Tests that duplicate QoS 1 PUBLISH packets are different from the
  * original.
@@ -1849,3 +2050,123 @@ TEST( MQTT_Unit_API, WaitAfterDisconnect )
 }
 
 /*-----------------------------------------------------------*/
+
+/**
+ * @brief Test group for MQTT API benchmarks.
+ *
+ * These tests log throughput figures, so the test runner leaves them out
+ * unless testrunnerFULL_MQTTv4_BENCHMARK_ENABLED is 1.
+ */
+TEST_GROUP( MQTT_Benchmark_API );
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test setup for MQTT API benchmarks.
+ */
+TEST_SETUP( MQTT_Benchmark_API )
+{
+    _setUpTest();
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test tear down for MQTT API benchmarks.
+ */
+TEST_TEAR_DOWN( MQTT_Benchmark_API )
+{
+    _tearDownTest();
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test group runner for MQTT API benchmarks.
+ */
+TEST_GROUP_RUNNER( MQTT_Benchmark_API )
+{
+    RUN_TEST_CASE( MQTT_Benchmark_API, PublishBatchBenchmark );
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Compares the throughput of QoS 0 messages sent through @ref
+ * mqtt_function_publish against @ref mqtt_function_publishbatch.
+ */
+TEST( MQTT_Benchmark_API, PublishBatchBenchmark )
+{
+    size_t i = 0;
+    uint64_t startTime = 0, publishTime = 0, batchTime = 0;
+    uint32_t publishSendCount = 0, batchSendCount = 0;
+    static IotMqttPublishInfo_t publishInfo[ PUBLISH_BATCH_COUNT ];
+
+    /* Initialize parameters. */
+    _networkInterface.send = _sendCounting;
+
+    /* Create a new MQTT connection. */
+    _pMqttConnection = IotTestMqtt_createMqttConnection( AWS_IOT_MQTT_SERVER,
+                                                         &_networkInfo,
+                                                         0 );
+    TEST_ASSERT_NOT_NULL( _pMqttConnection );
+
+    /* Set the MQTT Context for the new MQTT Connection*/
+    TEST_ASSERT_EQUAL( IOT_MQTT_SUCCESS, _setContext( _pMqttConnection, transportSend ) );
+
+    for( i = 0; i < PUBLISH_BATCH_COUNT; i++ )
+    {
+        publishInfo[ i ] = ( IotMqttPublishInfo_t ) IOT_MQTT_PUBLISH_INFO_INITIALIZER;
+        publishInfo[ i ].qos = IOT_MQTT_QOS_0;
+        publishInfo[ i ].pTopicName = TEST_TOPIC_NAME;
+        publishInfo[ i ].topicNameLength = TEST_TOPIC_NAME_LENGTH;
+        publishInfo[ i ].pPayload = "sample";
+        publishInfo[ i ].payloadLength = 6;
+    }
+
+    if( TEST_PROTECT() )
+    {
+        /* Send each message with its own PUBLISH call. */
+        _networkSendCount = 0;
+        startTime = IotClock_GetTimeMs();
+
+        for( i = 0; i < PUBLISH_BATCH_COUNT; i++ )
+        {
+            TEST_ASSERT_EQUAL( IOT_MQTT_SUCCESS,
+                               IotMqtt_Publish( _pMqttConnection, &( publishInfo[ i ] ), 0, NULL, NULL ) );
+        }
+
+        publishTime = IotClock_GetTimeMs() - startTime;
+        publishSendCount = _networkSendCount;
+
+        /* Send the same messages as a single batch. */
+        _networkSendCount = 0;
+        startTime = IotClock_GetTimeMs();
+
+        TEST_ASSERT_EQUAL( IOT_MQTT_SUCCESS,
+                           IotMqtt_PublishBatch( _pMqttConnection, publishInfo, PUBLISH_BATCH_COUNT, 0, NULL ) );
+
+        batchTime = IotClock_GetTimeMs() - startTime;
+        batchSendCount = _networkSendCount;
+
+        IotLogInfo( "%d PUBLISH messages: %lu ms and %lu sends individually, %lu ms and %lu sends batched "
+                    "(%lu and %lu messages/s).",
+                    PUBLISH_BATCH_COUNT,
+                    ( unsigned long ) publishTime,
+                    ( unsigned long ) publishSendCount,
+                    ( unsigned long ) batchTime,
+                    ( unsigned long ) batchSendCount,
+                    ( unsigned long ) ( ( PUBLISH_BATCH_COUNT * 1000ULL ) / ( publishTime + 1U ) ),
+                    ( unsigned long ) ( ( PUBLISH_BATCH_COUNT * 1000ULL ) / ( batchTime + 1U ) ) );
+
+        /* Every message needs at least one send on its own; batching must
+         * coalesce them into fewer sends. */
+        TEST_ASSERT_TRUE( publishSendCount >= PUBLISH_BATCH_COUNT );
+        TEST_ASSERT_LESS_THAN( publishSendCount, batchSendCount );
+    }
+
+    /* Clean up MQTT connection. */
+    IotMqtt_Disconnect( _pMqttConnection, IOT_MQTT_FLAG_CLEANUP_ONLY );
+}
+
+/*-----------------------------------------------------------*/
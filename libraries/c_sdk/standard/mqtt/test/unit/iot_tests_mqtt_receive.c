@@ -38,6 +38,7 @@
 #include "iot_init.h"
 
 /* Platform layer includes. */
+#include "platform/iot_clock.h"
 #include "platform/iot_threads.h"
 
 /* MQTT internal include. */
@@ -110,6 +111,13 @@ static const uint8_t _pPingrespTemplate[] = { 0xd0, 0x00 };
  */
 #define PUBLISH_CALLBACK_TIMEOUT    ( 1000 )
 
+/**
+ * @brief Number of PUBLISH operations awaiting PUBACK in the large in-flight
+ * window test. More than fit in the index of pending responses, so that some
+ * operations are found by list search.
+ */
+#define LARGE_WINDOW_SIZE           ( 4U * IOT_MQTT_PENDING_RESPONSE_INDEX_SIZE )
+
 /**
  * @brief Declare a buffer holding a packet and its size.
  */
@@ -205,6 +213,16 @@ static bool _disconnectCallbackCalled = false;
  */
 static NetworkContext_t networkContext = { 0 };
 
+/**
+ * @brief The message buffer retained by #_retainCallback.
+ */
+static IotMqttMessageBuffer_t _retainedMessage = IOT_MQTT_MESSAGE_BUFFER_INITIALIZER;
+
+/**
+ * @brief The PUBLISH message retained by #_retainCallback.
+ */
+static IotMqttPublishInfo_t _retainedPublish = IOT_MQTT_PUBLISH_INFO_INITIALIZER;
+
 /*-----------------------------------------------------------*/
 
 /* Using initialized connToContext variable. */
@@ -319,7 +337,7 @@ static void _operationResetAndPush( _mqttOperation_t * pOperation )
     pOperation->u.operation.status = IOT_MQTT_STATUS_PENDING;
     pOperation->u.operation.jobReference = 1;
 
-    IotListDouble_InsertHead( &( _pMqttConnection->pendingResponse ), &( pOperation->link ) );
+    _IotMqtt_InsertPendingResponse( pOperation );
 }
 
 /*-----------------------------------------------------------*/
@@ -439,6 +457,54 @@ static void _publishCallback( void * pCallbackContext,
 
 /*-----------------------------------------------------------*/
 
+/**
+ * @brief Called when a PUBLISH message is "received"; keeps the buffer of the
+ * message after returning.
+ */
+static void _retainCallback( void * pCallbackContext,
+                             IotMqttCallbackParam_t * pPublish )
+{
+    IotSemaphore_t * pInvokeCount = ( IotSemaphore_t * ) pCallbackContext;
+
+    _retainedMessage = IotMqtt_RetainMessage( pPublish );
+    _retainedPublish = pPublish->u.message.info;
+
+    IotSemaphore_Post( pInvokeCount );
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Get the number of receive buffers in use, either in the size class that
+ * a packet uses or outside the pool.
+ */
+static uint32_t _receiveBuffersInUse( size_t remainingLength,
+                                      uint32_t * pAllocations )
+{
+    IotMqttReceivePoolStatus_t poolStatus = { 0 };
+    uint32_t sizeClass = 0;
+
+    TEST_ASSERT_EQUAL( IOT_MQTT_SUCCESS, IotMqtt_GetReceivePoolStatus( &poolStatus ) );
+
+    /* Use the smallest size class that fits the packet. */
+    for( sizeClass = 0; sizeClass < IOT_MQTT_RECEIVE_POOL_CLASSES; sizeClass++ )
+    {
+        if( ( poolStatus.sizeClass[ sizeClass ].bufferCount > 0 ) &&
+            ( poolStatus.sizeClass[ sizeClass ].bufferSize >= remainingLength ) )
+        {
+            *pAllocations = poolStatus.sizeClass[ sizeClass ].allocations;
+
+            return poolStatus.sizeClass[ sizeClass ].inUse;
+        }
+    }
+
+    *pAllocations = poolStatus.heapAllocations;
+
+    return poolStatus.heapInUse;
+}
+
+/*-----------------------------------------------------------*/
+
 /**
  * @brief A PUBACK serializer function that does nothing, but always returns failure.
  *
@@ -813,8 +879,10 @@ TEST_GROUP_RUNNER( MQTT_Unit_Receive )
     RUN_TEST_CASE( MQTT_Unit_Receive, ConnackInvalid );
     RUN_TEST_CASE( MQTT_Unit_Receive, PublishValid );
     RUN_TEST_CASE( MQTT_Unit_Receive, PublishInvalid );
+    RUN_TEST_CASE( MQTT_Unit_Receive, PublishRetainBuffer );
     RUN_TEST_CASE( MQTT_Unit_Receive, PubackValid );
     RUN_TEST_CASE( MQTT_Unit_Receive, PubackInvalid );
+    RUN_TEST_CASE( MQTT_Unit_Receive, PubackLargeWindow );
     RUN_TEST_CASE( MQTT_Unit_Receive, SubackValid );
     RUN_TEST_CASE( MQTT_Unit_Receive, SubackInvalid );
     RUN_TEST_CASE( MQTT_Unit_Receive, UnsubackValid );
@@ -1206,6 +1274,69 @@ TEST( MQTT_Unit_Receive, PublishValid )
 
 /*-----------------------------------------------------------*/
 
+/**
+ * @brief Tests that a subscription callback may keep the buffer of a PUBLISH with
+ * @ref mqtt_function_retainmessage, and that the buffer returns to the receive
+ * pool once released.
+ */
+TEST( MQTT_Unit_Receive, PublishRetainBuffer )
+{
+    int8_t contextIndex = _IotMqtt_getContextIndexFromConnection( _pMqttConnection );
+    uint32_t inUse = 0, allocations = 0, initialAllocations = 0, i = 0;
+    const size_t remainingLength = sizeof( _pPublishTemplate ) - 3;
+
+    ( void ) _receiveBuffersInUse( remainingLength, &initialAllocations );
+
+    connToContext[ contextIndex ].subscriptionArray[ 0 ].callback.function = _retainCallback;
+
+    if( TEST_PROTECT() )
+    {
+        DECLARE_PACKET( _pPublishTemplate, pPublish, publishSize );
+        TEST_ASSERT_EQUAL_INT( true, _processPublish( pPublish,
+                                                      publishSize,
+                                                      1 ) );
+
+        /* The retained message must still point into the receive buffer, even
+         * though the packet it was received from is gone. */
+        ( void ) memset( pPublish, 0x00, publishSize );
+        TEST_ASSERT_NOT_NULL( _retainedMessage );
+        TEST_ASSERT_EQUAL( TEST_TOPIC_LENGTH, _retainedPublish.topicNameLength );
+        TEST_ASSERT_EQUAL_MEMORY( TEST_TOPIC_NAME, _retainedPublish.pTopicName, TEST_TOPIC_LENGTH );
+        TEST_ASSERT_EQUAL_MEMORY( _pPublishTemplate + 16, _retainedPublish.pPayload, _retainedPublish.payloadLength );
+
+        inUse = _receiveBuffersInUse( remainingLength, &allocations );
+        TEST_ASSERT_EQUAL_UINT32( 1, inUse );
+        TEST_ASSERT_EQUAL_UINT32( initialAllocations + 1, allocations );
+
+        IotMqtt_ReleaseMessage( _retainedMessage );
+        _retainedMessage = IOT_MQTT_MESSAGE_BUFFER_INITIALIZER;
+
+        /* The incoming PUBLISH job releases its reference after the callback
+         * returns. Wait for the buffer to be returned. */
+        for( i = 0; i < PUBLISH_CALLBACK_TIMEOUT; i += 10 )
+        {
+            inUse = _receiveBuffersInUse( remainingLength, &allocations );
+
+            if( inUse == 0 )
+            {
+                break;
+            }
+
+            IotClock_SleepMs( 10 );
+        }
+
+        TEST_ASSERT_EQUAL_UINT32( 0, inUse );
+    }
+
+    connToContext[ contextIndex ].subscriptionArray[ 0 ].callback.function = _publishCallback;
+
+    /* Network close function should not have been invoked. */
+    TEST_ASSERT_EQUAL_INT( false, _networkCloseCalled );
+    TEST_ASSERT_EQUAL_INT( false, _disconnectCallbackCalled );
+}
+
+/*-----------------------------------------------------------*/
+
 /**
  * @brief Tests the behavior of @ref mqtt_function_receivecallback with a PUBLIS
  * that doesn't comply to MQTT spec.
@@ -1499,6 +1630,77 @@ TEST( MQTT_Unit_Receive, PubackInvalid )
 
 /*-----------------------------------------------------------*/
 
+/**
+ * @brief Tests the behavior of @ref mqtt_function_receivecallback with PUBACKs
+ * for a large window of in-flight PUBLISH operations, acknowledged out of order.
+ */
+TEST( MQTT_Unit_Receive, PubackLargeWindow )
+{
+    size_t i = 0, ackCount = 0;
+    int8_t contextIndex = -1;
+    uint16_t packetIdentifier = 0;
+    static _mqttOperation_t publish[ LARGE_WINDOW_SIZE ];
+
+    contextIndex = _IotMqtt_getContextIndexFromConnection( _pMqttConnection );
+    TEST_ASSERT_NOT_EQUAL( -1, contextIndex );
+
+    /* Put the window of PUBLISH operations in flight. */
+    for( i = 0; i < LARGE_WINDOW_SIZE; i++ )
+    {
+        publish[ i ] = ( _mqttOperation_t ) INITIALIZE_OPERATION( IOT_MQTT_PUBLISH_TO_SERVER );
+        publish[ i ].u.operation.packetIdentifier = ( uint16_t ) ( i + 1U );
+
+        /* Create the wait semaphore so notifications don't crash. The value of
+         * this semaphore will not be checked, so the maxValue argument is arbitrary. */
+        TEST_ASSERT_EQUAL_INT( true, IotSemaphore_Create( &( publish[ i ].u.operation.notify.waitSemaphore ),
+                                                          0,
+                                                          10 ) );
+
+        _operationResetAndPush( &( publish[ i ] ) );
+    }
+
+    /* Acknowledge the PUBLISH operations in an order unrelated to their packet
+     * identifiers. Because the stride is odd, every operation is acknowledged once. */
+    for( ackCount = 0; ackCount < LARGE_WINDOW_SIZE; ackCount++ )
+    {
+        i = ( ackCount * 37U ) % LARGE_WINDOW_SIZE;
+        packetIdentifier = publish[ i ].u.operation.packetIdentifier;
+
+        /* Add a publish record at the start index. */
+        connToContext[ contextIndex ].context.outgoingPublishRecords[ 0 ].packetId = packetIdentifier;
+        connToContext[ contextIndex ].context.outgoingPublishRecords[ 0 ].publishState = MQTTPubAckPending;
+        connToContext[ contextIndex ].context.outgoingPublishRecords[ 0 ].qos = MQTTQoS1;
+
+        {
+            DECLARE_PACKET( _pPubackTemplate, pPuback, pubackSize );
+            pPuback[ 2 ] = ( uint8_t ) ( packetIdentifier >> 8 );
+            pPuback[ 3 ] = ( uint8_t ) ( packetIdentifier & 0x00ffU );
+            TEST_ASSERT_EQUAL_INT( true, _processBuffer( &( publish[ i ] ),
+                                                         pPuback,
+                                                         pubackSize,
+                                                         IOT_MQTT_SUCCESS ) );
+        }
+
+        TEST_ASSERT_EQUAL_INT( false, IotLink_IsLinked( &( publish[ i ].link ) ) );
+    }
+
+    /* No operation should remain in the pending responses list or its index. */
+    TEST_ASSERT_EQUAL_INT( true, IotListDouble_IsEmpty( &( _pMqttConnection->pendingResponse ) ) );
+    TEST_ASSERT_EQUAL( 0, _pMqttConnection->pendingResponseIndexed );
+    TEST_ASSERT_EQUAL( 0, _pMqttConnection->pendingResponseUnindexed );
+
+    for( i = 0; i < LARGE_WINDOW_SIZE; i++ )
+    {
+        IotSemaphore_Destroy( &( publish[ i ].u.operation.notify.waitSemaphore ) );
+    }
+
+    /* Network close function should not have been invoked. */
+    TEST_ASSERT_EQUAL_INT( false, _networkCloseCalled );
+    TEST_ASSERT_EQUAL_INT( false, _disconnectCallbackCalled );
+}
+
+/*-----------------------------------------------------------*/
+
 /**
  * @brief Tests the behavior of @ref mqtt_function_receivecallback with a
  * spec-compliant SUBACK.
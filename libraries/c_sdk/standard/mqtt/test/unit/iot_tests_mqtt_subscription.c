@@ -113,6 +113,12 @@ extern _connContext_t connToContext[ MAX_NO_OF_MQTT_CONNECTIONS ];
 #define TEST_TOPIC_FILTER_FORMAT    ( "/test%lu" )                             /**< @brief Format of each topic filter. */
 #define TEST_TOPIC_FILTER_LENGTH    ( sizeof( TEST_TOPIC_FILTER_FORMAT ) + 1 ) /**< @brief Maximum length of each topic filter. */
 
+/*
+ * Constants relating to the topic trie benchmark.
+ */
+#define TOPIC_TRIE_BENCHMARK_ITERATIONS    ( 10000 ) /**< @brief Number of times each topic name is matched. */
+#define TOPIC_TRIE_BENCHMARK_LENGTH        ( 48 )    /**< @brief Maximum length of each topic filter and topic name. */
+
 /**
  * @brief A non-NULL function pointer to use for subscription callback. This
  * "function" should cause a crash if actually called.
@@ -548,19 +554,114 @@ static bool _isEmpty( _mqttSubscription_t * pSubscriptionArray )
 
     return status;
 }
+
 /*-----------------------------------------------------------*/
 
 /**
- * @brief Test group for MQTT subscription tests.
+ * @brief Clear the subscription array and the topic trie of the test connection.
  */
-TEST_GROUP( MQTT_Unit_Subscription );
+static void _clearSubscriptions( void )
+{
+    memset( &( connToContext[ contextIndex ].subscriptionArray[ 0 ] ),
+            0x00,
+            sizeof( connToContext[ contextIndex ].subscriptionArray ) );
+    memset( &( connToContext[ contextIndex ].subscriptionTrie ),
+            0x00,
+            sizeof( connToContext[ contextIndex ].subscriptionTrie ) );
+}
 
 /*-----------------------------------------------------------*/
 
 /**
- * @brief Test setup for MQTT subscription tests.
+ * @brief Add a subscription for a topic filter to the test connection.
  */
-TEST_SETUP( MQTT_Unit_Subscription )
+static void _addSubscription( const char * pTopicFilter )
+{
+    IotMqttSubscription_t subscription = IOT_MQTT_SUBSCRIPTION_INITIALIZER;
+
+    subscription.callback.function = SUBSCRIPTION_CALLBACK_FUNCTION;
+    subscription.pTopicFilter = pTopicFilter;
+    subscription.topicFilterLength = ( uint16_t ) strlen( pTopicFilter );
+
+    TEST_ASSERT_EQUAL( IOT_MQTT_SUCCESS, _IotMqtt_AddSubscriptions( _pMqttConnection,
+                                                                    1,
+                                                                    &subscription,
+                                                                    1 ) );
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Check that the topic trie and a scan of the subscription array find the
+ * same subscriptions for a topic name, from every starting index.
+ */
+static void _checkTrieMatches( const char * pTopicName )
+{
+    int8_t startIndex = 0;
+    _topicMatchParams_t topicMatchParams = { 0 };
+
+    topicMatchParams.pTopicName = pTopicName;
+    topicMatchParams.topicNameLength = ( uint16_t ) strlen( pTopicName );
+    topicMatchParams.exactMatchOnly = false;
+
+    for( startIndex = 0; startIndex < MAX_NO_OF_MQTT_SUBSCRIPTIONS; startIndex++ )
+    {
+        TEST_ASSERT_EQUAL_INT8( IotMqtt_FindFirstMatch( connToContext[ contextIndex ].subscriptionArray,
+                                                        startIndex,
+                                                        &topicMatchParams ),
+                                IotMqtt_FindFirstMatchInTrie( &( connToContext[ contextIndex ].subscriptionTrie ),
+                                                              connToContext[ contextIndex ].subscriptionArray,
+                                                              startIndex,
+                                                              &topicMatchParams ) );
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Count the subscriptions matching a topic name the way
+ * #_IotMqtt_InvokeSubscriptionCallback walks them, with or without the topic trie.
+ */
+static uint32_t _countMatches( _topicMatchParams_t * pTopicMatchParams,
+                               bool useTrie )
+{
+    uint32_t matchCount = 0;
+    int8_t index = 0;
+
+    while( index < MAX_NO_OF_MQTT_SUBSCRIPTIONS )
+    {
+        if( useTrie == true )
+        {
+            index = IotMqtt_FindFirstMatchInTrie( &( connToContext[ contextIndex ].subscriptionTrie ),
+                                                  connToContext[ contextIndex ].subscriptionArray,
+                                                  index,
+                                                  pTopicMatchParams );
+        }
+        else
+        {
+            index = IotMqtt_FindFirstMatch( connToContext[ contextIndex ].subscriptionArray,
+                                            index,
+                                            pTopicMatchParams );
+        }
+
+        if( index == -1 )
+        {
+            break;
+        }
+
+        matchCount++;
+        index++;
+    }
+
+    return matchCount;
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Initialize the libraries and create the MQTT connection used by the tests.
+ */
+static void _createConnection( void )
 {
     static IotNetworkInterface_t networkInterface = { 0 };
     IotMqttNetworkInfo_t networkInfo = IOT_MQTT_NETWORK_INFO_INITIALIZER;
@@ -588,9 +689,9 @@ TEST_SETUP( MQTT_Unit_Subscription )
 /*-----------------------------------------------------------*/
 
 /**
- * @brief Test tear down for MQTT subscription tests.
+ * @brief Destroy the MQTT connection used by the tests and clean up the libraries.
  */
-TEST_TEAR_DOWN( MQTT_Unit_Subscription )
+static void _destroyConnection( void )
 {
     /* Destroy the MQTT connection used for the tests. */
     if( _connectionCreated == true )
@@ -606,6 +707,33 @@ TEST_TEAR_DOWN( MQTT_Unit_Subscription )
 
 /*-----------------------------------------------------------*/
 
+/**
+ * @brief Test group for MQTT subscription tests.
+ */
+TEST_GROUP( MQTT_Unit_Subscription );
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test setup for MQTT subscription tests.
+ */
+TEST_SETUP( MQTT_Unit_Subscription )
+{
+    _createConnection();
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test tear down for MQTT subscription tests.
+ */
+TEST_TEAR_DOWN( MQTT_Unit_Subscription )
+{
+    _destroyConnection();
+}
+
+/*-----------------------------------------------------------*/
+
 /**
  * @brief Test group runner for MQTT subscription tests.
  */
@@ -623,6 +751,8 @@ TEST_GROUP_RUNNER( MQTT_Unit_Subscription )
     RUN_TEST_CASE( MQTT_Unit_Subscription, SubscriptionReferences );
     RUN_TEST_CASE( MQTT_Unit_Subscription, TopicFilterMatchTrue );
     RUN_TEST_CASE( MQTT_Unit_Subscription, TopicFilterMatchFalse );
+    RUN_TEST_CASE( MQTT_Unit_Subscription, TopicTrieMatch );
+    RUN_TEST_CASE( MQTT_Unit_Subscription, TopicTrieFull );
 }
 
 /*-----------------------------------------------------------*/
@@ -1245,6 +1375,8 @@ TEST( MQTT_Unit_Subscription, TopicFilterMatchTrue )
         TEST_TOPIC_MATCH( "aws//iot", "aws/+/iot", false, true );
         TEST_TOPIC_MATCH( "aws//iot", "aws//+", false, true );
         TEST_TOPIC_MATCH( "aws///iot", "aws/+/+/iot", false, true );
+        TEST_TOPIC_MATCH( "aws/i", "aws/+", false, true );
+        TEST_TOPIC_MATCH( "a/b/c", "+/b/+", false, true );
 
         /* Multi level wildcard matching. */
         TEST_TOPIC_MATCH( "/aws/iot/shadow", "#", false, true );
@@ -1307,3 +1439,248 @@ TEST( MQTT_Unit_Subscription, TopicFilterMatchFalse )
 }
 
 /*-----------------------------------------------------------*/
+
+/**
+ * @brief Tests that the topic trie finds the same subscriptions as a scan of the
+ * subscription array, as subscriptions are added and removed.
+ */
+TEST( MQTT_Unit_Subscription, TopicTrieMatch )
+{
+    size_t i = 0;
+    IotMqttSubscription_t subscription = IOT_MQTT_SUBSCRIPTION_INITIALIZER;
+    _topicMatchParams_t topicMatchParams = { 0 };
+    const char * pTopicFilters[] =
+    {
+        "aws/iot/shadow", "aws/+/shadow", "aws/#", "#", "+/+", "/+", "aws/iot/+", "aws/+/+/thing", "aws/"
+    };
+    const char * pTopicNames[] =
+    {
+        "aws/iot/shadow", "aws/iot", "aws", "aws/", "/aws", "aws/iot/shadow/thing", "aws/x/y/thing",
+        "aws//shadow", "aws/i", "a", "other/topic", "/"
+    };
+
+    /* Getting MQTT Context for the specified MQTT Connection. */
+    contextIndex = _IotMqtt_getContextIndexFromConnection( _pMqttConnection );
+
+    _clearSubscriptions();
+
+    /* On empty trie. */
+    _checkTrieMatches( "aws/iot/shadow" );
+
+    for( i = 0; i < sizeof( pTopicFilters ) / sizeof( pTopicFilters[ 0 ] ); i++ )
+    {
+        _addSubscription( pTopicFilters[ i ] );
+    }
+
+    TEST_ASSERT_FALSE( connToContext[ contextIndex ].subscriptionTrie.incomplete );
+
+    for( i = 0; i < sizeof( pTopicNames ) / sizeof( pTopicNames[ 0 ] ); i++ )
+    {
+        _checkTrieMatches( pTopicNames[ i ] );
+    }
+
+    /* A topic name matching every subscription except the exact one. */
+    topicMatchParams.pTopicName = "aws/iot/x";
+    topicMatchParams.topicNameLength = 9;
+    TEST_ASSERT_EQUAL_UINT32( 3, _countMatches( &topicMatchParams, true ) );
+
+    /* Removed subscriptions stay in the trie, but must not be matched. */
+    subscription.pTopicFilter = "aws/#";
+    subscription.topicFilterLength = 5;
+    _IotMqtt_RemoveSubscriptionByTopicFilter( _pMqttConnection, &subscription, 1 );
+    subscription.pTopicFilter = "#";
+    subscription.topicFilterLength = 1;
+    _IotMqtt_RemoveSubscriptionByTopicFilter( _pMqttConnection, &subscription, 1 );
+
+    for( i = 0; i < sizeof( pTopicNames ) / sizeof( pTopicNames[ 0 ] ); i++ )
+    {
+        _checkTrieMatches( pTopicNames[ i ] );
+    }
+
+    TEST_ASSERT_EQUAL_UINT32( 1, _countMatches( &topicMatchParams, true ) );
+
+    /* New subscriptions reuse the removed entries of the subscription array. */
+    _addSubscription( "aws/iot/#" );
+    _addSubscription( "+/iot/x" );
+
+    for( i = 0; i < sizeof( pTopicNames ) / sizeof( pTopicNames[ 0 ] ); i++ )
+    {
+        _checkTrieMatches( pTopicNames[ i ] );
+    }
+
+    TEST_ASSERT_EQUAL_UINT32( 3, _countMatches( &topicMatchParams, true ) );
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Tests that subscriptions are still matched when they do not fit in the
+ * topic trie.
+ */
+TEST( MQTT_Unit_Subscription, TopicTrieFull )
+{
+    size_t i = 0;
+    IotMqttSubscription_t subscription = IOT_MQTT_SUBSCRIPTION_INITIALIZER;
+    char pDeepTopicFilter[ ( MAX_NO_OF_MQTT_TOPIC_TRIE_LEVELS + 1 ) * 2 ] = { 0 };
+
+    /* Getting MQTT Context for the specified MQTT Connection. */
+    contextIndex = _IotMqtt_getContextIndexFromConnection( _pMqttConnection );
+
+    _clearSubscriptions();
+
+    /* A topic filter with one level more than the trie holds. */
+    for( i = 0; i < MAX_NO_OF_MQTT_TOPIC_TRIE_LEVELS + 1; i++ )
+    {
+        pDeepTopicFilter[ 2 * i ] = 'a';
+        pDeepTopicFilter[ ( 2 * i ) + 1 ] = '/';
+    }
+
+    pDeepTopicFilter[ sizeof( pDeepTopicFilter ) - 1 ] = '\0';
+
+    _addSubscription( "a/+" );
+    _addSubscription( pDeepTopicFilter );
+    _addSubscription( "a/#" );
+
+    TEST_ASSERT_TRUE( connToContext[ contextIndex ].subscriptionTrie.incomplete );
+
+    _checkTrieMatches( pDeepTopicFilter );
+    _checkTrieMatches( "a/a" );
+
+    /* The trie is rebuilt on the next subscription once the deep topic filter is
+     * removed. */
+    subscription.pTopicFilter = pDeepTopicFilter;
+    subscription.topicFilterLength = ( uint16_t ) strlen( pDeepTopicFilter );
+    _IotMqtt_RemoveSubscriptionByTopicFilter( _pMqttConnection, &subscription, 1 );
+
+    _addSubscription( "a/a" );
+
+    TEST_ASSERT_FALSE( connToContext[ contextIndex ].subscriptionTrie.incomplete );
+
+    _checkTrieMatches( pDeepTopicFilter );
+    _checkTrieMatches( "a/a" );
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test group for MQTT subscription benchmarks.
+ *
+ * The benchmarks log their timings, and only run when
+ * testrunnerFULL_MQTTv4_BENCHMARK_ENABLED is 1.
+ */
+TEST_GROUP( MQTT_Benchmark_Subscription );
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test setup for MQTT subscription benchmarks.
+ */
+TEST_SETUP( MQTT_Benchmark_Subscription )
+{
+    _createConnection();
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test tear down for MQTT subscription benchmarks.
+ */
+TEST_TEAR_DOWN( MQTT_Benchmark_Subscription )
+{
+    _destroyConnection();
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test group runner for MQTT subscription benchmarks.
+ */
+TEST_GROUP_RUNNER( MQTT_Benchmark_Subscription )
+{
+    RUN_TEST_CASE( MQTT_Benchmark_Subscription, TopicTrieBenchmark );
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Compares the time to match topic names with the topic trie and by
+ * scanning the subscription array, with a full subscription array of per-device
+ * topic filters.
+ */
+TEST( MQTT_Benchmark_Subscription, TopicTrieBenchmark )
+{
+    uint32_t i = 0, iteration = 0;
+    uint32_t trieMatches = 0, scanMatches = 0;
+    uint64_t startTime = 0, trieTime = 0, scanTime = 0;
+    char pTopicFilters[ MAX_NO_OF_MQTT_SUBSCRIPTIONS ][ TOPIC_TRIE_BENCHMARK_LENGTH ] = { { 0 } };
+    char pTopicNames[ 3 ][ TOPIC_TRIE_BENCHMARK_LENGTH ] = { { 0 } };
+    _topicMatchParams_t topicMatchParams = { 0 };
+
+    /* Getting MQTT Context for the specified MQTT Connection. */
+    contextIndex = _IotMqtt_getContextIndexFromConnection( _pMqttConnection );
+
+    _clearSubscriptions();
+
+    for( i = 0; i < MAX_NO_OF_MQTT_SUBSCRIPTIONS; i++ )
+    {
+        switch( i % 3 )
+        {
+            case 0:
+                ( void ) snprintf( pTopicFilters[ i ], TOPIC_TRIE_BENCHMARK_LENGTH, "dt/gateway/device%lu/telemetry", ( unsigned long ) i );
+                break;
+
+            case 1:
+                ( void ) snprintf( pTopicFilters[ i ], TOPIC_TRIE_BENCHMARK_LENGTH, "cmd/gateway/device%lu/+", ( unsigned long ) i );
+                break;
+
+            default:
+                ( void ) snprintf( pTopicFilters[ i ], TOPIC_TRIE_BENCHMARK_LENGTH, "$aws/things/device%lu/shadow/#", ( unsigned long ) i );
+                break;
+        }
+
+        _addSubscription( pTopicFilters[ i ] );
+    }
+
+    TEST_ASSERT_FALSE( connToContext[ contextIndex ].subscriptionTrie.incomplete );
+
+    /* A topic name matching the last subscription, one matching a wildcard and one
+     * matching nothing. */
+    ( void ) snprintf( pTopicNames[ 0 ], TOPIC_TRIE_BENCHMARK_LENGTH, "%s", pTopicFilters[ ( ( MAX_NO_OF_MQTT_SUBSCRIPTIONS - 1 ) / 3 ) * 3 ] );
+    ( void ) snprintf( pTopicNames[ 1 ], TOPIC_TRIE_BENCHMARK_LENGTH, "$aws/things/device2/shadow/update/accepted" );
+    ( void ) snprintf( pTopicNames[ 2 ], TOPIC_TRIE_BENCHMARK_LENGTH, "dt/gateway/unknown/telemetry" );
+
+    for( i = 0; i < 3; i++ )
+    {
+        _checkTrieMatches( pTopicNames[ i ] );
+
+        topicMatchParams.pTopicName = pTopicNames[ i ];
+        topicMatchParams.topicNameLength = ( uint16_t ) strlen( pTopicNames[ i ] );
+
+        startTime = IotClock_GetTimeMs();
+
+        for( iteration = 0; iteration < TOPIC_TRIE_BENCHMARK_ITERATIONS; iteration++ )
+        {
+            scanMatches += _countMatches( &topicMatchParams, false );
+        }
+
+        scanTime += IotClock_GetTimeMs() - startTime;
+        startTime = IotClock_GetTimeMs();
+
+        for( iteration = 0; iteration < TOPIC_TRIE_BENCHMARK_ITERATIONS; iteration++ )
+        {
+            trieMatches += _countMatches( &topicMatchParams, true );
+        }
+
+        trieTime += IotClock_GetTimeMs() - startTime;
+    }
+
+    TEST_ASSERT_EQUAL_UINT32( scanMatches, trieMatches );
+
+    IotLogInfo( "%lu subscriptions, %lu topic names matched in %lu ms by scanning, %lu ms with the topic trie.",
+                ( unsigned long ) MAX_NO_OF_MQTT_SUBSCRIPTIONS,
+                ( unsigned long ) ( 3 * TOPIC_TRIE_BENCHMARK_ITERATIONS ),
+                ( unsigned long ) scanTime,
+                ( unsigned long ) trieTime );
+}
+
+/*-----------------------------------------------------------*/
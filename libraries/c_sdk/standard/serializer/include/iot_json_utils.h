@@ -34,6 +34,55 @@
 /* Standard includes. */
 #include <stdbool.h>
 #include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief Classes of JSON characters, combined into the set of characters
+ * IotJsonUtils_ScanFor and IotJsonUtils_ScanPast look for.
+ */
+#define IOT_JSON_QUOTE         ( 0x01U ) /**< @brief The double quote. */
+#define IOT_JSON_BACKSLASH     ( 0x02U ) /**< @brief The backslash. */
+#define IOT_JSON_STRUCTURAL    ( 0x04U ) /**< @brief The characters { } [ ]. */
+#define IOT_JSON_DELIMITER     ( 0x08U ) /**< @brief The characters : and , */
+#define IOT_JSON_WHITESPACE    ( 0x10U ) /**< @brief Space, tab, carriage return and line feed. */
+
+/**
+ * @brief The parent of the keys in the top-level object of a document.
+ */
+#define IOT_JSON_QUERY_ROOT    ( -1 )
+
+/**
+ * @brief Initializer for an #IotJsonQueryKey_t from a string literal.
+ *
+ * @param[in] parent Index of the key's parent in the query, or #IOT_JSON_QUERY_ROOT.
+ * @param[in] key The key, which must be a string literal.
+ */
+#define IOT_JSON_QUERY_KEY( parent, key )    { ( key ), sizeof( key ) - 1U, ( int16_t ) ( parent ) }
+
+/**
+ * @brief One key path of a query.
+ *
+ * A query is a constant array of keys, usually built once with #IOT_JSON_QUERY_KEY.
+ * The dotted path `a.b.c` is three entries, where `b` names the index of `a` as its
+ * parent and `c` names the index of `b`. Parents must come before their children.
+ * A key whose parent's value is an array is looked up in every object of that array.
+ */
+typedef struct IotJsonQueryKey
+{
+    const char * pKey; /**< @brief The key, without quotes. */
+    size_t keyLength;  /**< @brief Length of pKey. */
+    int16_t parent;    /**< @brief Index of the parent key, or #IOT_JSON_QUERY_ROOT. */
+} IotJsonQueryKey_t;
+
+/**
+ * @brief The value found for one key of a query.
+ */
+typedef struct IotJsonQueryResult
+{
+    const char * pValue; /**< @brief The first value of the key, including quotes or brackets; NULL if not found. */
+    size_t valueLength;  /**< @brief Length of pValue. */
+    uint16_t count;      /**< @brief The number of times the key was found. */
+} IotJsonQueryResult_t;
 
 bool IotJsonUtils_FindJsonValue( const char * pJsonDocument,
                                  size_t jsonDocumentLength,
@@ -42,4 +91,82 @@ bool IotJsonUtils_FindJsonValue( const char * pJsonDocument,
                                  const char ** pJsonValue,
                                  size_t * pJsonValueLength );
 
+/**
+ * @brief Find the first character of a buffer that is in one of the classes.
+ *
+ * Checks 16 characters at a time where SSE2 or NEON is available.
+ *
+ * @param[in] pBuffer The characters to scan.
+ * @param[in] length The number of characters in pBuffer.
+ * @param[in] classes The classes to look for, for example
+ * `IOT_JSON_QUOTE | IOT_JSON_BACKSLASH` for the end of a string.
+ *
+ * @return The offset of the character found, or `length` if there is none.
+ */
+size_t IotJsonUtils_ScanFor( const char * pBuffer,
+                             size_t length,
+                             uint8_t classes );
+
+/**
+ * @brief Find the first character of a buffer that is in none of the classes.
+ *
+ * @param[in] pBuffer The characters to scan.
+ * @param[in] length The number of characters in pBuffer.
+ * @param[in] classes The classes to skip, for example #IOT_JSON_WHITESPACE.
+ *
+ * @return The offset of the character found, or `length` if there is none.
+ */
+size_t IotJsonUtils_ScanPast( const char * pBuffer,
+                              size_t length,
+                              uint8_t classes );
+
+/**
+ * @brief Find the values of all the keys of a query in one pass over a JSON document.
+ *
+ * Only the objects named by the query are walked key by key; every other value is
+ * skipped as a whole, checking only that its strings end and its brackets balance.
+ * Objects and arrays may be nested at most `IOT_JSON_QUERY_MAX_DEPTH` deep along
+ * the paths of the query (8 by default).
+ *
+ * @param[in] pJsonDocument The JSON document, whose top-level value must be an object.
+ * Characters after that object are ignored.
+ * @param[in] jsonDocumentLength The length of pJsonDocument.
+ * @param[in] pQuery The keys to look for.
+ * @param[in] queryLength The number of keys in pQuery.
+ * @param[out] pResults The value of each key, in the same order as pQuery.
+ *
+ * @return `true` if the document was walked; `false` if it is not valid JSON or
+ * nests too deeply. Keys that were not found have a count of 0 either way.
+ */
+bool IotJsonUtils_Query( const char * pJsonDocument,
+                         size_t jsonDocumentLength,
+                         const IotJsonQueryKey_t * pQuery,
+                         size_t queryLength,
+                         IotJsonQueryResult_t * pResults );
+
+/**
+ * @brief Read the next key and value of a JSON object.
+ *
+ * Start with an offset of 0 and call until it returns `false` to visit every
+ * member of the object in order.
+ *
+ * @param[in] pJsonObject The JSON object, starting at or before its opening brace.
+ * @param[in] jsonObjectLength The length of pJsonObject.
+ * @param[in,out] pOffset Where to continue reading; set after the value read.
+ * @param[out] pKey The key, without quotes.
+ * @param[out] pKeyLength Length of pKey.
+ * @param[out] pValue The value, including quotes or brackets.
+ * @param[out] pValueLength Length of pValue.
+ *
+ * @return `true` if a member was read; `false` at the end of the object or if
+ * it is not valid JSON.
+ */
+bool IotJsonUtils_NextObjectMember( const char * pJsonObject,
+                                    size_t jsonObjectLength,
+                                    size_t * pOffset,
+                                    const char ** pKey,
+                                    size_t * pKeyLength,
+                                    const char ** pValue,
+                                    size_t * pValueLength );
+
 #endif /* ifndef IOT_JSON_UTILS_H_ */
@@ -181,7 +181,8 @@ typedef enum
     IOT_SERIALIZER_UNDEFINED_TYPE,
     IOT_SERIALIZER_NOT_SUPPORTED,
     IOT_SERIALIZER_NOT_FOUND,
-    IOT_SERIALIZER_INTERNAL_FAILURE
+    IOT_SERIALIZER_INTERNAL_FAILURE,
+    IOT_SERIALIZER_FLUSH_FAILED
 } IotSerializerError_t;
 
 /* two categories:
@@ -247,6 +248,21 @@ typedef struct IotSerializerDecoderObject
 
 typedef void * IotSerializerDecoderIterator_t;
 
+/**
+ * @brief Consumes the encoded data of a streaming encoder, see
+ * IotSerializerEncodeInterface_t.initStream.
+ *
+ * @param[in] pFlushContext The context passed to initStream.
+ * @param[in] pData The next encoded bytes. They are only valid during the call.
+ * @param[in] dataLength The number of bytes in pData.
+ *
+ * @return true if the bytes were consumed; false makes the encoder call return
+ * IOT_SERIALIZER_FLUSH_FAILED, and the same bytes are passed to the next flush.
+ */
+typedef bool ( * IotSerializerFlushCallback_t )( void * pFlushContext,
+                                                 const uint8_t * pData,
+                                                 size_t dataLength );
+
 /**
  * @brief Table containing function pointers for encoder APIs.
  */
@@ -254,9 +270,10 @@ typedef struct IotSerializerEncodeInterface
 {
     /**
      * @brief Return the actual total size after encoding finished.
+     * For a streaming encoder, this includes the data already flushed.
      *
      * @param[in] pEncoderObject: the outermost object pointer; behavior is undefined for any other object
-     * @param[in] pDataBuffer: the buffer pointer passed into init; behavior is undefined for any other buffer pointer
+     * @param[in] pDataBuffer: the buffer pointer passed into init or initStream; behavior is undefined for any other buffer pointer
      */
     size_t ( * getEncodedSize )( IotSerializerEncoderObject_t * pEncoderObject,
                                  uint8_t * pDataBuffer );
@@ -291,6 +308,11 @@ typedef struct IotSerializerEncodeInterface
     /**
      * @brief Open a child container object.
      *
+     * If the window of a streaming encoder could not be flushed, the child is not
+     * opened: it has no handle, and the other functions return
+     * IOT_SERIALIZER_INVALID_INPUT for it until it is opened again. This also
+     * applies to openContainerWithKey.
+     *
      * @param[in] pEncoderObject: the parent object. It must be a container object
      * @param[in] pNewEncoderObject: the child object to create. It must be a container object
      * @param[in] length: pre-known length of the container or IOT_SERIALIZER_INDEFINITE_LENGTH
@@ -347,6 +369,34 @@ typedef struct IotSerializerEncodeInterface
     IotSerializerError_t ( * appendKeyValue )( IotSerializerEncoderObject_t * pEncoderObject,
                                                const char * pKey,
                                                IotSerializerScalarData_t scalarData );
+
+    /**
+     * @brief Initialize the object's handle to encode into a window that is passed to a
+     * flush callback whenever the next value does not fit, then reused.
+     *
+     * Encoding never needs more memory than the window, so the size of the data does not
+     * have to be calculated first. Every key and scalar value, with the characters around
+     * it, must fit in the window on its own; a larger one fails with
+     * IOT_SERIALIZER_BUFFER_TOO_SMALL. Call flush after closing the last container.
+     *
+     * @param[in] pEncoderObject Pointer of Encoder Object. After init, its type will be set to IOT_SERIALIZER_CONTAINER_STREAM.
+     * @param[in] pWindow Buffer the data is encoded into before it is flushed.
+     * @param[in] windowSize Size of pWindow.
+     * @param[in] flushCallback Called with the encoded data each time the window is flushed.
+     * @param[in] pFlushContext Passed to flushCallback.
+     */
+    IotSerializerError_t ( * initStream )( IotSerializerEncoderObject_t * pEncoderObject,
+                                           uint8_t * pWindow,
+                                           size_t windowSize,
+                                           IotSerializerFlushCallback_t flushCallback,
+                                           void * pFlushContext );
+
+    /**
+     * @brief Pass the data left in the window of a streaming encoder to its flush callback.
+     *
+     * @param[in] pEncoderObject: the outermost object pointer, initialized with initStream
+     */
+    IotSerializerError_t ( * flush )( IotSerializerEncoderObject_t * pEncoderObject );
 } IotSerializerEncodeInterface_t;
 
 /**
@@ -501,4 +551,9 @@ extern IotSerializerEncodeInterface_t _IotSerializerJsonEncoder;
 
 extern IotSerializerDecodeInterface_t _IotSerializerJsonDecoder;
 
+/* JSON decoder that indexes the document once in init, so that looking up keys and
+ * iterating don't re-scan the text. Uses 8 bytes of heap per token until the decoder
+ * objects of the document are destroyed. */
+extern IotSerializerDecodeInterface_t _IotSerializerJsonTapeDecoder;
+
 #endif /* ifndef IOT_SERIALIZER_H_ */
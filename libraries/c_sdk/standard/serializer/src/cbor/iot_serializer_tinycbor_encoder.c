@@ -34,6 +34,31 @@
 #include "iot_serializer.h"
 #include "cbor.h"
 
+/* The largest CBOR header: the initial byte and a 64 bit argument. */
+#define _CBOR_MAX_HEADER_LENGTH    ( 9U )
+
+/* The length of the break byte that closes an indefinite length container. */
+#define _CBOR_BREAK_LENGTH         ( 1U )
+
+/*
+ * The handle of every encoder object. The fields after cborEncoder are only
+ * used by the outermost object of a streaming encoder; every object of that
+ * stream points at it with pStream.
+ */
+typedef struct _cborEncoderWrapper
+{
+    CborEncoder cborEncoder;
+    struct _cborEncoderWrapper * pStream;       /* NULL unless initialized with _initStream. */
+    uint8_t * pWindow;
+    IotSerializerFlushCallback_t flushCallback;
+    void * pFlushContext;
+    size_t flushedLength;                       /* Bytes already passed to flushCallback. */
+} _cborEncoderWrapper_t;
+
+/* A container that was opened, and not closed or destroyed since. A container
+ * whose open failed has no handle. */
+#define _cborIsOpenContainer( pEncoderObject )    ( ( pEncoderObject )->pHandle != NULL )
+
 /* Translate cbor error to serializer error. */
 static void _translateErrorCode( CborError cborError,
                                  IotSerializerError_t * pSerializerError );
@@ -60,6 +85,19 @@ static IotSerializerError_t _append( IotSerializerEncoderObject_t * pEncoderObje
 static IotSerializerError_t _appendKeyValue( IotSerializerEncoderObject_t * pEncoderObject,
                                              const char * pKey,
                                              IotSerializerScalarData_t scalarData );
+static IotSerializerError_t _initStream( IotSerializerEncoderObject_t * pEncoderObject,
+                                         uint8_t * pWindow,
+                                         size_t windowSize,
+                                         IotSerializerFlushCallback_t flushCallback,
+                                         void * pFlushContext );
+static IotSerializerError_t _flush( IotSerializerEncoderObject_t * pEncoderObject );
+
+/* Flush the window of a streaming encoder when the next length bytes do not fit. */
+static IotSerializerError_t _makeRoom( _cborEncoderWrapper_t * pWrapper,
+                                       size_t length );
+
+/* The most bytes a scalar is encoded in. */
+static size_t _getMaxScalarLength( IotSerializerScalarData_t * pScalarData );
 
 
 IotSerializerEncodeInterface_t _IotSerializerCborEncoder =
@@ -73,6 +111,8 @@ IotSerializerEncodeInterface_t _IotSerializerCborEncoder =
     .closeContainer           = _closeContainer,
     .append                   = _append,
     .appendKeyValue           = _appendKeyValue,
+    .initStream               = _initStream,
+    .flush                    = _flush
 };
 
 /*-----------------------------------------------------------*/
@@ -106,21 +146,100 @@ static void _translateErrorCode( CborError cborError,
 
 /*-----------------------------------------------------------*/
 
+static IotSerializerError_t _flushWindow( _cborEncoderWrapper_t * pWrapper )
+{
+    IotSerializerError_t returnedError = IOT_SERIALIZER_SUCCESS;
+    _cborEncoderWrapper_t * pStream = pWrapper->pStream;
+    size_t length = ( size_t ) ( pWrapper->cborEncoder.data.ptr - pStream->pWindow );
+
+    if( pStream->flushCallback( pStream->pFlushContext, pStream->pWindow, length ) == true )
+    {
+        /* Only the innermost open encoder writes; the outer ones take its position
+         * back when their containers are closed. */
+        pStream->flushedLength += length;
+        pWrapper->cborEncoder.data.ptr = pStream->pWindow;
+    }
+    else
+    {
+        returnedError = IOT_SERIALIZER_FLUSH_FAILED;
+    }
+
+    return returnedError;
+}
+
+/*-----------------------------------------------------------*/
+
+static IotSerializerError_t _makeRoom( _cborEncoderWrapper_t * pWrapper,
+                                       size_t length )
+{
+    IotSerializerError_t returnedError = IOT_SERIALIZER_SUCCESS;
+    CborEncoder * pCborEncoder = &( pWrapper->cborEncoder );
+
+    if( pWrapper->pStream != NULL )
+    {
+        if( length > ( size_t ) ( pCborEncoder->end - pWrapper->pStream->pWindow ) )
+        {
+            /* The value would not fit even in an empty window. */
+            returnedError = IOT_SERIALIZER_BUFFER_TOO_SMALL;
+        }
+        else if( length > ( size_t ) ( pCborEncoder->end - pCborEncoder->data.ptr ) )
+        {
+            returnedError = _flushWindow( pWrapper );
+        }
+    }
+
+    return returnedError;
+}
+
+/*-----------------------------------------------------------*/
+
+static size_t _getMaxScalarLength( IotSerializerScalarData_t * pScalarData )
+{
+    size_t length = _CBOR_MAX_HEADER_LENGTH;
+
+    if( ( pScalarData->type == IOT_SERIALIZER_SCALAR_TEXT_STRING ) ||
+        ( pScalarData->type == IOT_SERIALIZER_SCALAR_BYTE_STRING ) )
+    {
+        length += pScalarData->value.u.string.length;
+    }
+
+    return length;
+}
+
+/*-----------------------------------------------------------*/
+
 static size_t _getEncodedSize( IotSerializerEncoderObject_t * pEncoderObject,
                                uint8_t * pDataBuffer )
 {
-    CborEncoder * pCborEncoder = ( CborEncoder * ) pEncoderObject->pHandle;
+    _cborEncoderWrapper_t * pWrapper = ( _cborEncoderWrapper_t * ) pEncoderObject->pHandle;
+    size_t encodedSize = 0;
+
+    if( pWrapper != NULL )
+    {
+        encodedSize = cbor_encoder_get_buffer_size( &( pWrapper->cborEncoder ), pDataBuffer );
+
+        if( pWrapper->pStream != NULL )
+        {
+            encodedSize += pWrapper->pStream->flushedLength;
+        }
+    }
 
-    return cbor_encoder_get_buffer_size( pCborEncoder, pDataBuffer );
+    return encodedSize;
 }
 
 /*-----------------------------------------------------------*/
 
 static size_t _getExtraBufferSizeNeeded( IotSerializerEncoderObject_t * pEncoderObject )
 {
-    CborEncoder * pCborEncoder = ( CborEncoder * ) pEncoderObject->pHandle;
+    _cborEncoderWrapper_t * pWrapper = ( _cborEncoderWrapper_t * ) pEncoderObject->pHandle;
+    size_t extraSizeNeeded = 0;
 
-    return cbor_encoder_get_extra_bytes_needed( pCborEncoder );
+    if( pWrapper != NULL )
+    {
+        extraSizeNeeded = cbor_encoder_get_extra_bytes_needed( &( pWrapper->cborEncoder ) );
+    }
+
+    return extraSizeNeeded;
 }
 
 /*-----------------------------------------------------------*/
@@ -134,18 +253,19 @@ static IotSerializerError_t _init( IotSerializerEncoderObject_t * pEncoderObject
     /* Unused flags for tinycbor init. */
     int unusedCborFlags = 0;
 
-    CborEncoder * pCborEncoder = IotSerializer_MallocCborEncoder( sizeof( CborEncoder ) );
+    _cborEncoderWrapper_t * pWrapper = IotSerializer_MallocCborEncoder( sizeof( _cborEncoderWrapper_t ) );
 
-    if( pCborEncoder != NULL )
+    if( pWrapper != NULL )
     {
         /* Store the CborEncoder pointer to handle. */
-        pEncoderObject->pHandle = pCborEncoder;
+        pEncoderObject->pHandle = pWrapper;
 
         /* Always set outmost type to IOT_SERIALIZER_CONTAINER_STREAM. */
         pEncoderObject->type = IOT_SERIALIZER_CONTAINER_STREAM;
 
         /* Perform the tinycbor init. */
-        cbor_encoder_init( pCborEncoder, pDataBuffer, maxSize, unusedCborFlags );
+        cbor_encoder_init( &( pWrapper->cborEncoder ), pDataBuffer, maxSize, unusedCborFlags );
+        pWrapper->pStream = NULL;
     }
     else
     {
@@ -159,12 +279,61 @@ static IotSerializerError_t _init( IotSerializerEncoderObject_t * pEncoderObject
 
 /*-----------------------------------------------------------*/
 
+static IotSerializerError_t _initStream( IotSerializerEncoderObject_t * pEncoderObject,
+                                         uint8_t * pWindow,
+                                         size_t windowSize,
+                                         IotSerializerFlushCallback_t flushCallback,
+                                         void * pFlushContext )
+{
+    IotSerializerError_t returnedError = IOT_SERIALIZER_INVALID_INPUT;
+    _cborEncoderWrapper_t * pWrapper = NULL;
+
+    if( ( pWindow != NULL ) && ( windowSize > 0 ) && ( flushCallback != NULL ) )
+    {
+        returnedError = _init( pEncoderObject, pWindow, windowSize );
+
+        if( returnedError == IOT_SERIALIZER_SUCCESS )
+        {
+            pWrapper = ( _cborEncoderWrapper_t * ) pEncoderObject->pHandle;
+            pWrapper->pStream = pWrapper;
+            pWrapper->pWindow = pWindow;
+            pWrapper->flushCallback = flushCallback;
+            pWrapper->pFlushContext = pFlushContext;
+            pWrapper->flushedLength = 0;
+        }
+    }
+
+    return returnedError;
+}
+
+/*-----------------------------------------------------------*/
+
+static IotSerializerError_t _flush( IotSerializerEncoderObject_t * pEncoderObject )
+{
+    IotSerializerError_t returnedError = IOT_SERIALIZER_INVALID_INPUT;
+    _cborEncoderWrapper_t * pWrapper = ( _cborEncoderWrapper_t * ) pEncoderObject->pHandle;
+
+    if( ( pWrapper != NULL ) && ( pWrapper->pStream != NULL ) )
+    {
+        returnedError = IOT_SERIALIZER_SUCCESS;
+
+        if( pWrapper->cborEncoder.data.ptr != pWrapper->pStream->pWindow )
+        {
+            returnedError = _flushWindow( pWrapper );
+        }
+    }
+
+    return returnedError;
+}
+
+/*-----------------------------------------------------------*/
+
 static void _destroy( IotSerializerEncoderObject_t * pEncoderObject )
 {
-    CborEncoder * pCborEncoder = ( CborEncoder * ) pEncoderObject->pHandle;
+    _cborEncoderWrapper_t * pWrapper = ( _cborEncoderWrapper_t * ) pEncoderObject->pHandle;
 
     /* Free the memory allocated in init function. */
-    IotSerializer_FreeCborEncoder( pCborEncoder );
+    IotSerializer_FreeCborEncoder( pWrapper );
 
     /* Reset pHandle to be NULL. */
     pEncoderObject->pHandle = NULL;
@@ -176,9 +345,10 @@ static IotSerializerError_t _openContainer( IotSerializerEncoderObject_t * pEnco
                                             IotSerializerEncoderObject_t * pNewEncoderObject,
                                             size_t length )
 {
-    /* New object must be a container of map or array. */
-    if( ( pNewEncoderObject->type != IOT_SERIALIZER_CONTAINER_ARRAY ) &&
-        ( pNewEncoderObject->type != IOT_SERIALIZER_CONTAINER_MAP ) )
+    /* New object must be a container of map or array, opened in an open container. */
+    if( ( ( pNewEncoderObject->type != IOT_SERIALIZER_CONTAINER_ARRAY ) &&
+          ( pNewEncoderObject->type != IOT_SERIALIZER_CONTAINER_MAP ) ) ||
+        !_cborIsOpenContainer( pEncoderObject ) )
     {
         return IOT_SERIALIZER_INVALID_INPUT;
     }
@@ -186,31 +356,54 @@ static IotSerializerError_t _openContainer( IotSerializerEncoderObject_t * pEnco
     IotSerializerError_t returnedError = IOT_SERIALIZER_SUCCESS;
     CborError cborError = CborNoError;
 
-    CborEncoder * pOuterEncoder = ( CborEncoder * ) pEncoderObject->pHandle;
-    CborEncoder * pInnerEncoder = IotSerializer_MallocCborEncoder( sizeof( CborEncoder ) );
+    _cborEncoderWrapper_t * pOuterWrapper = ( _cborEncoderWrapper_t * ) pEncoderObject->pHandle;
+    _cborEncoderWrapper_t * pInnerWrapper = NULL;
 
-    if( pInnerEncoder != NULL )
+    /* The header of the container is written before the inner encoder takes over.
+     * If the window could not be flushed, the container is not opened. */
+    returnedError = _makeRoom( pOuterWrapper, _CBOR_MAX_HEADER_LENGTH + _CBOR_BREAK_LENGTH );
+
+    if( returnedError != IOT_SERIALIZER_SUCCESS )
+    {
+        pNewEncoderObject->pHandle = NULL;
+
+        return returnedError;
+    }
+
+    pInnerWrapper = IotSerializer_MallocCborEncoder( sizeof( _cborEncoderWrapper_t ) );
+
+    if( pInnerWrapper != NULL )
     {
         /* Store the CborEncoder pointer to handle. */
-        pNewEncoderObject->pHandle = pInnerEncoder;
+        pNewEncoderObject->pHandle = pInnerWrapper;
+        pInnerWrapper->pStream = pOuterWrapper->pStream;
 
         switch( pNewEncoderObject->type )
         {
             case IOT_SERIALIZER_CONTAINER_MAP:
-                cborError = cbor_encoder_create_map( pOuterEncoder, pInnerEncoder, length );
+                cborError = cbor_encoder_create_map( &( pOuterWrapper->cborEncoder ), &( pInnerWrapper->cborEncoder ), length );
                 break;
 
             case IOT_SERIALIZER_CONTAINER_ARRAY:
-                cborError = cbor_encoder_create_array( pOuterEncoder, pInnerEncoder, length );
+                cborError = cbor_encoder_create_array( &( pOuterWrapper->cborEncoder ), &( pInnerWrapper->cborEncoder ), length );
                 break;
 
             default:
                 IotSerializer_Assert( 0 );
         }
+
+        /* The break byte of an indefinite length container stays reserved at
+         * the end of the window, so closing it never needs a flush. */
+        if( ( pInnerWrapper->pStream != NULL ) &&
+            ( ( pInnerWrapper->cborEncoder.flags & CborIteratorFlag_UnknownLength ) != 0 ) )
+        {
+            pInnerWrapper->cborEncoder.end -= _CBOR_BREAK_LENGTH;
+        }
     }
     else
     {
         /* pEncoderObject is untouched. */
+        pNewEncoderObject->pHandle = NULL;
         returnedError = IOT_SERIALIZER_OUT_OF_MEMORY;
     }
 
@@ -227,14 +420,33 @@ static IotSerializerError_t _openContainerWithKey( IotSerializerEncoderObject_t
                                                    size_t length )
 {
     IotSerializerScalarData_t keyScalarData = IotSerializer_ScalarTextString( pKey );
+    IotSerializerError_t returnedError = IOT_SERIALIZER_INVALID_INPUT;
 
-    IotSerializerError_t returnedError = _append( pEncoderObject, keyScalarData );
+    if( _cborIsOpenContainer( pEncoderObject ) )
+    {
+        /* Make room for the key and the header of the container together, so
+         * that a refused flush writes neither. */
+        returnedError = _makeRoom( ( _cborEncoderWrapper_t * ) pEncoderObject->pHandle,
+                                   _getMaxScalarLength( &keyScalarData ) + _CBOR_MAX_HEADER_LENGTH + _CBOR_BREAK_LENGTH );
+
+        if( returnedError == IOT_SERIALIZER_SUCCESS )
+        {
+            returnedError = _append( pEncoderObject, keyScalarData );
+        }
+    }
 
-    /* Buffer too small is a special error case that serialization should continue. */
-    if( ( returnedError == IOT_SERIALIZER_SUCCESS ) || ( returnedError == IOT_SERIALIZER_BUFFER_TOO_SMALL ) )
+    /* Buffer too small is a special error case that serialization should continue,
+     * unless streaming, where the key was not written. */
+    if( ( returnedError == IOT_SERIALIZER_SUCCESS ) ||
+        ( ( returnedError == IOT_SERIALIZER_BUFFER_TOO_SMALL ) &&
+          ( ( ( _cborEncoderWrapper_t * ) pEncoderObject->pHandle )->pStream == NULL ) ) )
     {
         returnedError = _openContainer( pEncoderObject, pNewEncoderObject, length );
     }
+    else
+    {
+        pNewEncoderObject->pHandle = NULL;
+    }
 
     return returnedError;
 }
@@ -247,13 +459,28 @@ static IotSerializerError_t _closeContainer( IotSerializerEncoderObject_t * pEnc
     IotSerializerError_t returnedError = IOT_SERIALIZER_SUCCESS;
     CborError cborError = CborNoError;
 
-    CborEncoder * pOuterEncoder = ( CborEncoder * ) pEncoderObject->pHandle;
-    CborEncoder * pInnerEncoder = ( CborEncoder * ) pNewEncoderObject->pHandle;
+    _cborEncoderWrapper_t * pOuterWrapper = ( _cborEncoderWrapper_t * ) pEncoderObject->pHandle;
+    _cborEncoderWrapper_t * pInnerWrapper = ( _cborEncoderWrapper_t * ) pNewEncoderObject->pHandle;
+
+    if( !_cborIsOpenContainer( pEncoderObject ) || !_cborIsOpenContainer( pNewEncoderObject ) )
+    {
+        return IOT_SERIALIZER_INVALID_INPUT;
+    }
+
+    /* An indefinite length container ends with a break byte, written at the
+     * position the outer encoder takes from the inner one. Give back the byte
+     * reserved for it when the container was opened. */
+    if( ( pInnerWrapper->pStream != NULL ) &&
+        ( ( pInnerWrapper->cborEncoder.flags & CborIteratorFlag_UnknownLength ) != 0 ) )
+    {
+        pInnerWrapper->cborEncoder.end += _CBOR_BREAK_LENGTH;
+    }
 
-    cborError = cbor_encoder_close_container( pOuterEncoder, pInnerEncoder );
+    cborError = cbor_encoder_close_container( &( pOuterWrapper->cborEncoder ), &( pInnerWrapper->cborEncoder ) );
 
     /* Free inner encoder's memory regardless the result of "close container". */
-    IotSerializer_FreeCborEncoder( pInnerEncoder );
+    IotSerializer_FreeCborEncoder( pInnerWrapper );
+    pNewEncoderObject->pHandle = NULL;
 
     _translateErrorCode( cborError, &returnedError );
 
@@ -268,7 +495,22 @@ static IotSerializerError_t _append( IotSerializerEncoderObject_t * pEncoderObje
     IotSerializerError_t returnedError = IOT_SERIALIZER_SUCCESS;
     CborError cborError = CborNoError;
 
-    CborEncoder * pCborEncoder = ( CborEncoder * ) pEncoderObject->pHandle;
+    _cborEncoderWrapper_t * pWrapper = ( _cborEncoderWrapper_t * ) pEncoderObject->pHandle;
+    CborEncoder * pCborEncoder = NULL;
+
+    if( !_cborIsOpenContainer( pEncoderObject ) )
+    {
+        return IOT_SERIALIZER_INVALID_INPUT;
+    }
+
+    pCborEncoder = &( pWrapper->cborEncoder );
+
+    returnedError = _makeRoom( pWrapper, _getMaxScalarLength( &scalarData ) );
+
+    if( returnedError != IOT_SERIALIZER_SUCCESS )
+    {
+        return returnedError;
+    }
 
     switch( scalarData.type )
     {
@@ -308,10 +550,26 @@ static IotSerializerError_t _appendKeyValue( IotSerializerEncoderObject_t * pEnc
                                              IotSerializerScalarData_t scalarData )
 {
     IotSerializerScalarData_t keyScalarData = IotSerializer_ScalarTextString( pKey );
-    IotSerializerError_t returnedError = _append( pEncoderObject, keyScalarData );
+    IotSerializerError_t returnedError = IOT_SERIALIZER_INVALID_INPUT;
+
+    if( _cborIsOpenContainer( pEncoderObject ) )
+    {
+        /* Make room for the key and the value together, so that a refused flush
+         * writes neither. */
+        returnedError = _makeRoom( ( _cborEncoderWrapper_t * ) pEncoderObject->pHandle,
+                                   _getMaxScalarLength( &keyScalarData ) + _getMaxScalarLength( &scalarData ) );
+
+        if( returnedError == IOT_SERIALIZER_SUCCESS )
+        {
+            returnedError = _append( pEncoderObject, keyScalarData );
+        }
+    }
 
-    /* Buffer too small is a special error case that serialization should continue. */
-    if( ( returnedError == IOT_SERIALIZER_SUCCESS ) || ( returnedError == IOT_SERIALIZER_BUFFER_TOO_SMALL ) )
+    /* Buffer too small is a special error case that serialization should continue,
+     * unless streaming, where the key was not written. */
+    if( ( returnedError == IOT_SERIALIZER_SUCCESS ) ||
+        ( ( returnedError == IOT_SERIALIZER_BUFFER_TOO_SMALL ) &&
+          ( ( ( _cborEncoderWrapper_t * ) pEncoderObject->pHandle )->pStream == NULL ) ) )
     {
         returnedError = _append( pEncoderObject, scalarData );
     }
@@ -37,6 +37,329 @@
 /* JSON utilities include. */
 #include "iot_json_utils.h"
 
+/* Vector extensions used to scan 16 characters at a time. Other targets scan
+ * one character at a time with a lookup table. */
+#if defined( __SSE2__ ) || defined( _M_X64 ) || ( defined( _M_IX86_FP ) && ( _M_IX86_FP >= 2 ) )
+    #include <emmintrin.h>
+    #if defined( _MSC_VER )
+        #include <intrin.h>
+    #endif
+    #define _SCAN_SSE2
+#elif ( defined( __ARM_NEON ) || defined( __ARM_NEON__ ) ) && defined( __GNUC__ )
+    #include <arm_neon.h>
+    #define _SCAN_NEON
+#endif
+
+/**
+ * @brief The number of characters checked at a time with vector extensions.
+ */
+#define _SCAN_BLOCK_SIZE       ( 16U )
+
+/**
+ * @brief The number of characters checked one at a time before scanning blocks.
+ */
+#define _SCAN_SCALAR_PREFIX    ( 8U )
+
+/**
+ * @brief The deepest IotJsonUtils_Query follows the paths of a query into a document.
+ */
+#ifndef IOT_JSON_QUERY_MAX_DEPTH
+    #define IOT_JSON_QUERY_MAX_DEPTH    ( 8 )
+#endif
+
+/**
+ * @brief Marks a value that is not the value of a key of the query.
+ */
+#define _QUERY_NO_KEY    ( -2 )
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief An object or array that IotJsonUtils_Query is walking.
+ */
+typedef struct _queryContainer
+{
+    size_t start;        /**< @brief Offset of the opening bracket in the document. */
+    int16_t scope;       /**< @brief Keys whose parent is this index are looked up in the container. */
+    int16_t key;         /**< @brief The key whose value is the container, or #_QUERY_NO_KEY. */
+    char closeCharacter; /**< @brief The bracket that closes the container. */
+} _queryContainer_t;
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief The JSON class of every character.
+ */
+static const uint8_t _characterClasses[ 256 ] =
+{
+    [ '\"' ]  = IOT_JSON_QUOTE,
+    [ '\\' ] = IOT_JSON_BACKSLASH,
+    [ '{' ]   = IOT_JSON_STRUCTURAL,
+    [ '}' ]   = IOT_JSON_STRUCTURAL,
+    [ '[' ]   = IOT_JSON_STRUCTURAL,
+    [ ']' ]   = IOT_JSON_STRUCTURAL,
+    [ ':' ]   = IOT_JSON_DELIMITER,
+    [ ',' ]   = IOT_JSON_DELIMITER,
+    [ ' ' ]   = IOT_JSON_WHITESPACE,
+    [ '\t' ]  = IOT_JSON_WHITESPACE,
+    [ '\r' ]  = IOT_JSON_WHITESPACE,
+    [ '\n' ]  = IOT_JSON_WHITESPACE
+};
+
+/*-----------------------------------------------------------*/
+
+#if defined( _SCAN_SSE2 )
+
+/**
+ * @brief Bit i of the mask is set if character i of the block is in one of the classes.
+ */
+    typedef uint32_t _blockMask_t;
+
+    #define _MASK_BITS_PER_CHARACTER    ( 1U )
+    #define _MASK_ALL_CHARACTERS        ( 0xffffU )
+
+    static _blockMask_t _classMask( const char * pBlock,
+                                    uint8_t classes )
+    {
+        const __m128i block = _mm_loadu_si128( ( const __m128i * ) pBlock );
+        __m128i match = _mm_setzero_si128();
+
+        if( ( classes & IOT_JSON_QUOTE ) != 0U )
+        {
+            match = _mm_or_si128( match, _mm_cmpeq_epi8( block, _mm_set1_epi8( '"' ) ) );
+        }
+
+        if( ( classes & IOT_JSON_BACKSLASH ) != 0U )
+        {
+            match = _mm_or_si128( match, _mm_cmpeq_epi8( block, _mm_set1_epi8( '\\' ) ) );
+        }
+
+        if( ( classes & IOT_JSON_STRUCTURAL ) != 0U )
+        {
+            match = _mm_or_si128( match, _mm_cmpeq_epi8( block, _mm_set1_epi8( '{' ) ) );
+            match = _mm_or_si128( match, _mm_cmpeq_epi8( block, _mm_set1_epi8( '}' ) ) );
+            match = _mm_or_si128( match, _mm_cmpeq_epi8( block, _mm_set1_epi8( '[' ) ) );
+            match = _mm_or_si128( match, _mm_cmpeq_epi8( block, _mm_set1_epi8( ']' ) ) );
+        }
+
+        if( ( classes & IOT_JSON_DELIMITER ) != 0U )
+        {
+            match = _mm_or_si128( match, _mm_cmpeq_epi8( block, _mm_set1_epi8( ':' ) ) );
+            match = _mm_or_si128( match, _mm_cmpeq_epi8( block, _mm_set1_epi8( ',' ) ) );
+        }
+
+        if( ( classes & IOT_JSON_WHITESPACE ) != 0U )
+        {
+            match = _mm_or_si128( match, _mm_cmpeq_epi8( block, _mm_set1_epi8( ' ' ) ) );
+            match = _mm_or_si128( match, _mm_cmpeq_epi8( block, _mm_set1_epi8( '\t' ) ) );
+            match = _mm_or_si128( match, _mm_cmpeq_epi8( block, _mm_set1_epi8( '\r' ) ) );
+            match = _mm_or_si128( match, _mm_cmpeq_epi8( block, _mm_set1_epi8( '\n' ) ) );
+        }
+
+        return ( _blockMask_t ) _mm_movemask_epi8( match );
+    }
+
+    static uint32_t _firstSetBit( _blockMask_t mask )
+    {
+        #if defined( _MSC_VER )
+            unsigned long index = 0;
+
+            ( void ) _BitScanForward( &index, mask );
+
+            return ( uint32_t ) index;
+        #else
+            return ( uint32_t ) __builtin_ctz( mask );
+        #endif
+    }
+
+#elif defined( _SCAN_NEON )
+
+/**
+ * @brief Bits 4i to 4i + 3 of the mask are set if character i of the block is in one
+ * of the classes. NEON has no movemask, narrowing the comparison is the cheapest way
+ * to get one bit field per character.
+ */
+    typedef uint64_t _blockMask_t;
+
+    #define _MASK_BITS_PER_CHARACTER    ( 4U )
+    #define _MASK_ALL_CHARACTERS        ( UINT64_MAX )
+
+    static _blockMask_t _classMask( const char * pBlock,
+                                    uint8_t classes )
+    {
+        const uint8x16_t block = vld1q_u8( ( const uint8_t * ) pBlock );
+        uint8x16_t match = vdupq_n_u8( 0 );
+
+        if( ( classes & IOT_JSON_QUOTE ) != 0U )
+        {
+            match = vorrq_u8( match, vceqq_u8( block, vdupq_n_u8( '"' ) ) );
+        }
+
+        if( ( classes & IOT_JSON_BACKSLASH ) != 0U )
+        {
+            match = vorrq_u8( match, vceqq_u8( block, vdupq_n_u8( '\\' ) ) );
+        }
+
+        if( ( classes & IOT_JSON_STRUCTURAL ) != 0U )
+        {
+            match = vorrq_u8( match, vceqq_u8( block, vdupq_n_u8( '{' ) ) );
+            match = vorrq_u8( match, vceqq_u8( block, vdupq_n_u8( '}' ) ) );
+            match = vorrq_u8( match, vceqq_u8( block, vdupq_n_u8( '[' ) ) );
+            match = vorrq_u8( match, vceqq_u8( block, vdupq_n_u8( ']' ) ) );
+        }
+
+        if( ( classes & IOT_JSON_DELIMITER ) != 0U )
+        {
+            match = vorrq_u8( match, vceqq_u8( block, vdupq_n_u8( ':' ) ) );
+            match = vorrq_u8( match, vceqq_u8( block, vdupq_n_u8( ',' ) ) );
+        }
+
+        if( ( classes & IOT_JSON_WHITESPACE ) != 0U )
+        {
+            match = vorrq_u8( match, vceqq_u8( block, vdupq_n_u8( ' ' ) ) );
+            match = vorrq_u8( match, vceqq_u8( block, vdupq_n_u8( '\t' ) ) );
+            match = vorrq_u8( match, vceqq_u8( block, vdupq_n_u8( '\r' ) ) );
+            match = vorrq_u8( match, vceqq_u8( block, vdupq_n_u8( '\n' ) ) );
+        }
+
+        return vget_lane_u64( vreinterpret_u64_u8( vshrn_n_u16( vreinterpretq_u16_u8( match ), 4 ) ), 0 );
+    }
+
+    static uint32_t _firstSetBit( _blockMask_t mask )
+    {
+        return ( uint32_t ) __builtin_ctzll( mask );
+    }
+
+#endif /* if defined( _SCAN_SSE2 ) */
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Scan the characters from offset for the first character in the classes,
+ * or with skip, the first character not in them.
+ */
+static size_t _scanBlocks( const char * pBuffer,
+                           size_t length,
+                           size_t offset,
+                           uint8_t classes,
+                           bool skip )
+{
+    bool found = false;
+
+    #if defined( _SCAN_SSE2 ) || defined( _SCAN_NEON )
+        _blockMask_t mask = 0;
+
+        while( ( found == false ) && ( ( length - offset ) >= _SCAN_BLOCK_SIZE ) )
+        {
+            mask = _classMask( pBuffer + offset, classes );
+
+            if( skip == true )
+            {
+                mask = ( ~mask ) & _MASK_ALL_CHARACTERS;
+            }
+
+            if( mask != 0U )
+            {
+                offset += _firstSetBit( mask ) / _MASK_BITS_PER_CHARACTER;
+                found = true;
+            }
+            else
+            {
+                offset += _SCAN_BLOCK_SIZE;
+            }
+        }
+
+        /* Check the characters after the last whole block with one more block that
+         * ends with the buffer, dropping the characters it shares with the last one. */
+        if( ( found == false ) && ( offset < length ) && ( length >= _SCAN_BLOCK_SIZE ) )
+        {
+            mask = _classMask( pBuffer + length - _SCAN_BLOCK_SIZE, classes );
+
+            if( skip == true )
+            {
+                mask = ( ~mask ) & _MASK_ALL_CHARACTERS;
+            }
+
+            mask >>= ( offset - ( length - _SCAN_BLOCK_SIZE ) ) * _MASK_BITS_PER_CHARACTER;
+
+            if( mask != 0U )
+            {
+                offset += _firstSetBit( mask ) / _MASK_BITS_PER_CHARACTER;
+            }
+            else
+            {
+                offset = length;
+            }
+
+            found = true;
+        }
+    #endif /* if defined( _SCAN_SSE2 ) || defined( _SCAN_NEON ) */
+
+    /* The characters after the last whole block. */
+    while( ( found == false ) && ( offset < length ) )
+    {
+        if( ( ( _characterClasses[ ( uint8_t ) pBuffer[ offset ] ] & classes ) != 0U ) != skip )
+        {
+            found = true;
+        }
+        else
+        {
+            offset++;
+        }
+    }
+
+    return offset;
+}
+
+/*-----------------------------------------------------------*/
+
+size_t IotJsonUtils_ScanFor( const char * pBuffer,
+                             size_t length,
+                             uint8_t classes )
+{
+    size_t offset = 0;
+    size_t prefixLength = ( length < _SCAN_SCALAR_PREFIX ) ? length : _SCAN_SCALAR_PREFIX;
+
+    /* Most keys and values are shorter than a block, so check the first few
+     * characters one at a time before loading blocks. */
+    while( ( offset < prefixLength ) &&
+           ( ( _characterClasses[ ( uint8_t ) pBuffer[ offset ] ] & classes ) == 0U ) )
+    {
+        offset++;
+    }
+
+    if( offset == _SCAN_SCALAR_PREFIX )
+    {
+        offset = _scanBlocks( pBuffer, length, offset, classes, false );
+    }
+
+    return offset;
+}
+
+/*-----------------------------------------------------------*/
+
+size_t IotJsonUtils_ScanPast( const char * pBuffer,
+                              size_t length,
+                              uint8_t classes )
+{
+    size_t offset = 0;
+    size_t prefixLength = ( length < _SCAN_SCALAR_PREFIX ) ? length : _SCAN_SCALAR_PREFIX;
+
+    /* Runs of whitespace and delimiters are usually short, see IotJsonUtils_ScanFor. */
+    while( ( offset < prefixLength ) &&
+           ( ( _characterClasses[ ( uint8_t ) pBuffer[ offset ] ] & classes ) != 0U ) )
+    {
+        offset++;
+    }
+
+    if( offset == _SCAN_SCALAR_PREFIX )
+    {
+        offset = _scanBlocks( pBuffer, length, offset, classes, true );
+    }
+
+    return offset;
+}
+
 /*-----------------------------------------------------------*/
 
 bool IotJsonUtils_FindJsonValue( const char * pJsonDocument,
@@ -46,8 +369,9 @@ bool IotJsonUtils_FindJsonValue( const char * pJsonDocument,
                                  const char ** pJsonValue,
                                  size_t * pJsonValueLength )
 {
-    size_t i = 0;
+    size_t i = 0, scanStart = 0;
     size_t jsonValueLength = 0;
+    const char * pKeyStart = NULL;
     char openCharacter = '\0', closeCharacter = '\0';
     int nestingLevel = 0;
 
@@ -64,6 +388,18 @@ bool IotJsonUtils_FindJsonValue( const char * pJsonDocument,
      * value. */
     while( i < jsonDocumentLength - jsonKeyLength - 3 )
     {
+        /* Jump to the next occurrence of the first character in the key. */
+        pKeyStart = memchr( pJsonDocument + i,
+                            pJsonKey[ 0 ],
+                            jsonDocumentLength - jsonKeyLength - 3 - i );
+
+        if( pKeyStart == NULL )
+        {
+            break;
+        }
+
+        i = ( size_t ) ( pKeyStart - pJsonDocument );
+
         /* If the first character in the key is found and there's an unescaped double
          * quote after the key length, do a string compare for the key. */
         if( ( pJsonDocument[ i ] == pJsonKey[ 0 ] ) &&
@@ -138,11 +474,28 @@ bool IotJsonUtils_FindJsonValue( const char * pJsonDocument,
                     i++;
 
                     /* Add the length of all characters in the JSON string. */
-                    while( pJsonDocument[ i ] != '\"' )
+                    while( true )
                     {
+                        /* Skip the characters up to the next double quote or backslash. */
+                        scanStart = i;
+                        i += IotJsonUtils_ScanFor( pJsonDocument + i,
+                                                   jsonDocumentLength - i,
+                                                   IOT_JSON_QUOTE | IOT_JSON_BACKSLASH );
+                        jsonValueLength += i - scanStart;
+
+                        /* If the end of the document is reached, this isn't a match. */
+                        if( i >= jsonDocumentLength )
+                        {
+                            return false;
+                        }
+
+                        if( pJsonDocument[ i ] == '\"' )
+                        {
+                            break;
+                        }
+
                         /* Ignore escaped double quotes. */
-                        if( ( pJsonDocument[ i ] == '\\' ) &&
-                            ( i + 1 < jsonDocumentLength ) &&
+                        if( ( i + 1 < jsonDocumentLength ) &&
                             ( pJsonDocument[ i + 1 ] == '\"' ) )
                         {
                             /* Skip the characters \" */
@@ -215,11 +568,37 @@ bool IotJsonUtils_FindJsonValue( const char * pJsonDocument,
                 /* Skip the opening character. */
                 i++;
 
+                /* If the end of the document is reached, this isn't a match. */
+                if( i >= jsonDocumentLength )
+                {
+                    return false;
+                }
+
                 /* Add the length of all characters in the JSON object or array. This
                  * includes the length of nested objects. */
                 while( pJsonDocument[ i ] != closeCharacter ||
                        ( pJsonDocument[ i ] == closeCharacter && nestingLevel != 0 ) )
                 {
+                    /* Only brackets change the nesting level, skip up to the next one. */
+                    if( ( pJsonDocument[ i ] != openCharacter ) &&
+                        ( pJsonDocument[ i ] != closeCharacter ) )
+                    {
+                        scanStart = i;
+                        i++;
+                        i += IotJsonUtils_ScanFor( pJsonDocument + i,
+                                                   jsonDocumentLength - i,
+                                                   IOT_JSON_STRUCTURAL );
+                        jsonValueLength += i - scanStart;
+
+                        /* If the end of the document is reached, this isn't a match. */
+                        if( i >= jsonDocumentLength )
+                        {
+                            return false;
+                        }
+
+                        continue;
+                    }
+
                     /* An opening character starts a nested object. */
                     if( pJsonDocument[ i ] == openCharacter )
                     {
@@ -258,3 +637,414 @@ bool IotJsonUtils_FindJsonValue( const char * pJsonDocument,
 }
 
 /*-----------------------------------------------------------*/
+
+/**
+ * @brief Skip the whitespace that starts at an offset. Most documents have none
+ * between tokens, so the first character is checked before scanning.
+ */
+static size_t _skipWhitespace( const char * pJsonDocument,
+                               size_t jsonDocumentLength,
+                               size_t offset )
+{
+    if( ( offset < jsonDocumentLength ) &&
+        ( ( _characterClasses[ ( uint8_t ) pJsonDocument[ offset ] ] & IOT_JSON_WHITESPACE ) != 0U ) )
+    {
+        offset += IotJsonUtils_ScanPast( pJsonDocument + offset,
+                                         jsonDocumentLength - offset,
+                                         IOT_JSON_WHITESPACE );
+    }
+
+    return offset;
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Skip the string that starts at an offset, including both quotes.
+ */
+static bool _skipString( const char * pJsonDocument,
+                         size_t jsonDocumentLength,
+                         size_t * pOffset )
+{
+    size_t i = *pOffset + 1U;
+    bool status = false;
+
+    while( ( status == false ) && ( i < jsonDocumentLength ) )
+    {
+        i += IotJsonUtils_ScanFor( pJsonDocument + i,
+                                   jsonDocumentLength - i,
+                                   IOT_JSON_QUOTE | IOT_JSON_BACKSLASH );
+
+        if( i < jsonDocumentLength )
+        {
+            if( pJsonDocument[ i ] == '\"' )
+            {
+                status = true;
+            }
+            else
+            {
+                /* Skip the backslash; the escaped character is skipped below. */
+                i++;
+            }
+
+            i++;
+        }
+    }
+
+    *pOffset = i;
+
+    return status;
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Skip the value that starts at an offset.
+ *
+ * Only the end of strings and the nesting of brackets are checked.
+ */
+static bool _skipValue( const char * pJsonDocument,
+                        size_t jsonDocumentLength,
+                        size_t * pOffset )
+{
+    size_t i = *pOffset;
+    size_t nestingLevel = 0;
+    bool status = true;
+
+    if( pJsonDocument[ i ] == '\"' )
+    {
+        status = _skipString( pJsonDocument, jsonDocumentLength, &i );
+    }
+    else if( ( pJsonDocument[ i ] == '{' ) || ( pJsonDocument[ i ] == '[' ) )
+    {
+        do
+        {
+            if( pJsonDocument[ i ] == '\"' )
+            {
+                /* Brackets in strings don't nest. */
+                status = _skipString( pJsonDocument, jsonDocumentLength, &i );
+            }
+            else
+            {
+                if( ( pJsonDocument[ i ] == '{' ) || ( pJsonDocument[ i ] == '[' ) )
+                {
+                    nestingLevel++;
+                }
+                else
+                {
+                    nestingLevel--;
+                }
+
+                i++;
+            }
+
+            if( ( status == true ) && ( nestingLevel > 0U ) )
+            {
+                /* Jump to the next bracket or string. */
+                i += IotJsonUtils_ScanFor( pJsonDocument + i,
+                                           jsonDocumentLength - i,
+                                           IOT_JSON_QUOTE | IOT_JSON_STRUCTURAL );
+
+                if( i >= jsonDocumentLength )
+                {
+                    status = false;
+                }
+            }
+        } while( ( status == true ) && ( nestingLevel > 0U ) );
+    }
+    else
+    {
+        /* A primitive ends at the next character that can't be part of it. The
+         * document can't end with one, the enclosing container is still open. */
+        i += IotJsonUtils_ScanFor( pJsonDocument + i,
+                                   jsonDocumentLength - i,
+                                   IOT_JSON_QUOTE | IOT_JSON_STRUCTURAL |
+                                   IOT_JSON_DELIMITER | IOT_JSON_WHITESPACE );
+
+        if( ( i == *pOffset ) || ( i >= jsonDocumentLength ) )
+        {
+            status = false;
+        }
+    }
+
+    *pOffset = i;
+
+    return status;
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Read the key that starts at an offset up to the start of its value, and
+ * find it among the keys of the query whose parent is scope.
+ */
+static bool _readKey( const char * pJsonDocument,
+                      size_t jsonDocumentLength,
+                      size_t * pOffset,
+                      const IotJsonQueryKey_t * pQuery,
+                      size_t queryLength,
+                      int16_t scope,
+                      int16_t * pKey )
+{
+    size_t i = *pOffset, keyStart = *pOffset + 1U, keyLength = 0, index = 0;
+    bool status = false;
+
+    *pKey = _QUERY_NO_KEY;
+
+    if( ( i < jsonDocumentLength ) &&
+        ( pJsonDocument[ i ] == '\"' ) &&
+        ( _skipString( pJsonDocument, jsonDocumentLength, &i ) == true ) )
+    {
+        /* Exclude the closing quote. */
+        keyLength = i - keyStart - 1U;
+
+        i = _skipWhitespace( pJsonDocument, jsonDocumentLength, i );
+
+        if( ( i < jsonDocumentLength ) && ( pJsonDocument[ i ] == ':' ) )
+        {
+            i++;
+            i = _skipWhitespace( pJsonDocument, jsonDocumentLength, i );
+            status = ( i < jsonDocumentLength );
+        }
+    }
+
+    for( index = 0; ( status == true ) && ( *pKey == _QUERY_NO_KEY ) && ( index < queryLength ); index++ )
+    {
+        if( ( pQuery[ index ].parent == scope ) &&
+            ( pQuery[ index ].keyLength == keyLength ) &&
+            ( memcmp( pQuery[ index ].pKey, pJsonDocument + keyStart, keyLength ) == 0 ) )
+        {
+            *pKey = ( int16_t ) index;
+        }
+    }
+
+    *pOffset = i;
+
+    return status;
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Check if any key of the query has a key as its parent.
+ */
+static bool _hasChildren( const IotJsonQueryKey_t * pQuery,
+                          size_t queryLength,
+                          int16_t key )
+{
+    size_t index = 0;
+    bool hasChildren = false;
+
+    for( index = 0; ( hasChildren == false ) && ( index < queryLength ); index++ )
+    {
+        hasChildren = ( pQuery[ index ].parent == key );
+    }
+
+    return hasChildren;
+}
+
+/*-----------------------------------------------------------*/
+
+bool IotJsonUtils_Query( const char * pJsonDocument,
+                         size_t jsonDocumentLength,
+                         const IotJsonQueryKey_t * pQuery,
+                         size_t queryLength,
+                         IotJsonQueryResult_t * pResults )
+{
+    _queryContainer_t containers[ IOT_JSON_QUERY_MAX_DEPTH ];
+    _queryContainer_t * pContainer = NULL;
+    size_t depth = 0, i = 0, valueStart = 0;
+    int16_t key = _QUERY_NO_KEY, scope = _QUERY_NO_KEY;
+    bool status = true, firstValue = true;
+
+    if( queryLength > 0U )
+    {
+        ( void ) memset( pResults, 0x00, queryLength * sizeof( IotJsonQueryResult_t ) );
+    }
+
+    /* The document must be an object, which contains the top-level keys. */
+    i = _skipWhitespace( pJsonDocument, jsonDocumentLength, 0 );
+
+    if( ( i < jsonDocumentLength ) && ( pJsonDocument[ i ] == '{' ) )
+    {
+        containers[ 0 ].start = i;
+        containers[ 0 ].scope = IOT_JSON_QUERY_ROOT;
+        containers[ 0 ].key = _QUERY_NO_KEY;
+        containers[ 0 ].closeCharacter = '}';
+        depth = 1;
+        i++;
+    }
+    else
+    {
+        status = false;
+    }
+
+    while( ( status == true ) && ( depth > 0U ) )
+    {
+        pContainer = &containers[ depth - 1U ];
+        i = _skipWhitespace( pJsonDocument, jsonDocumentLength, i );
+
+        if( i >= jsonDocumentLength )
+        {
+            status = false;
+        }
+        else if( pJsonDocument[ i ] == pContainer->closeCharacter )
+        {
+            i++;
+
+            /* Containers are values too; only the first value of a key is kept. */
+            if( ( pContainer->key != _QUERY_NO_KEY ) &&
+                ( pResults[ pContainer->key ].pValue == pJsonDocument + pContainer->start ) )
+            {
+                pResults[ pContainer->key ].valueLength = i - pContainer->start;
+            }
+
+            depth--;
+            firstValue = false;
+        }
+        else if( ( firstValue == false ) && ( pJsonDocument[ i ] != ',' ) )
+        {
+            status = false;
+        }
+        else
+        {
+            if( firstValue == false )
+            {
+                /* Skip the comma and the whitespace after it. */
+                i++;
+                i = _skipWhitespace( pJsonDocument, jsonDocumentLength, i );
+            }
+
+            firstValue = false;
+
+            /* Find the key of the value and the keys of the query inside the value.
+             * The keys under an array apply to the objects in it. */
+            if( pContainer->closeCharacter == '}' )
+            {
+                status = _readKey( pJsonDocument, jsonDocumentLength, &i,
+                                   pQuery, queryLength, pContainer->scope, &key );
+                scope = key;
+            }
+            else
+            {
+                status = ( i < jsonDocumentLength );
+                key = _QUERY_NO_KEY;
+                scope = pContainer->scope;
+            }
+
+            if( status == true )
+            {
+                valueStart = i;
+
+                if( key != _QUERY_NO_KEY )
+                {
+                    if( pResults[ key ].count == 0U )
+                    {
+                        pResults[ key ].pValue = pJsonDocument + i;
+                    }
+
+                    if( pResults[ key ].count < UINT16_MAX )
+                    {
+                        pResults[ key ].count++;
+                    }
+                }
+
+                /* Walk into the value if the query has keys in it, otherwise skip it. */
+                if( ( scope != _QUERY_NO_KEY ) &&
+                    ( ( pJsonDocument[ i ] == '{' ) ||
+                      ( ( pJsonDocument[ i ] == '[' ) && ( key != _QUERY_NO_KEY ) ) ) &&
+                    ( _hasChildren( pQuery, queryLength, scope ) == true ) )
+                {
+                    if( depth < IOT_JSON_QUERY_MAX_DEPTH )
+                    {
+                        containers[ depth ].start = i;
+                        containers[ depth ].scope = scope;
+                        containers[ depth ].key = key;
+                        containers[ depth ].closeCharacter = ( pJsonDocument[ i ] == '{' ) ? '}' : ']';
+                        depth++;
+                        i++;
+                        firstValue = true;
+                    }
+                    else
+                    {
+                        status = false;
+                    }
+                }
+                else
+                {
+                    status = _skipValue( pJsonDocument, jsonDocumentLength, &i );
+
+                    if( ( status == true ) &&
+                        ( key != _QUERY_NO_KEY ) &&
+                        ( pResults[ key ].pValue == pJsonDocument + valueStart ) )
+                    {
+                        pResults[ key ].valueLength = i - valueStart;
+                    }
+                }
+            }
+        }
+    }
+
+    return status;
+}
+
+/*-----------------------------------------------------------*/
+
+bool IotJsonUtils_NextObjectMember( const char * pJsonObject,
+                                    size_t jsonObjectLength,
+                                    size_t * pOffset,
+                                    const char ** pKey,
+                                    size_t * pKeyLength,
+                                    const char ** pValue,
+                                    size_t * pValueLength )
+{
+    size_t i = _skipWhitespace( pJsonObject, jsonObjectLength, *pOffset );
+    size_t keyStart = 0, valueStart = 0;
+    bool status = false;
+
+    /* The first member follows the opening brace, every other one a comma. */
+    if( i < jsonObjectLength )
+    {
+        status = ( pJsonObject[ i ] == ( ( *pOffset == 0U ) ? '{' : ',' ) );
+        i = _skipWhitespace( pJsonObject, jsonObjectLength, i + 1U );
+    }
+
+    if( ( status == true ) && ( i < jsonObjectLength ) && ( pJsonObject[ i ] == '\"' ) )
+    {
+        keyStart = i + 1U;
+        status = _skipString( pJsonObject, jsonObjectLength, &i );
+    }
+    else
+    {
+        status = false;
+    }
+
+    if( status == true )
+    {
+        /* Exclude the closing quote. */
+        *pKeyLength = i - keyStart - 1U;
+        i = _skipWhitespace( pJsonObject, jsonObjectLength, i );
+
+        if( ( i < jsonObjectLength ) && ( pJsonObject[ i ] == ':' ) )
+        {
+            valueStart = _skipWhitespace( pJsonObject, jsonObjectLength, i + 1U );
+            i = valueStart;
+            status = ( i < jsonObjectLength ) &&
+                     ( _skipValue( pJsonObject, jsonObjectLength, &i ) == true );
+        }
+        else
+        {
+            status = false;
+        }
+    }
+
+    if( status == true )
+    {
+        *pKey = pJsonObject + keyStart;
+        *pValue = pJsonObject + valueStart;
+        *pValueLength = i - valueStart;
+        *pOffset = i;
+    }
+
+    return status;
+}
@@ -76,6 +76,20 @@
         #error "IOT_SERIALIZER_DECODER_OBJECTS cannot be 0 or negative."
     #endif
 
+/**
+ * @brief The handle of a CBOR encoder object; must match the definition in
+ * iot_serializer_tinycbor_encoder.c.
+ */
+    typedef struct _cborEncoderWrapper
+    {
+        CborEncoder cborEncoder;                      /**< @brief The tinycbor encoder. */
+        struct _cborEncoderWrapper * pStream;         /**< @brief The outermost object of a streaming encoder. */
+        uint8_t * pWindow;                            /**< @brief The window of a streaming encoder. */
+        IotSerializerFlushCallback_t flushCallback;   /**< @brief Consumes the window of a streaming encoder. */
+        void * pFlushContext;                         /**< @brief Passed to flushCallback. */
+        size_t flushedLength;                         /**< @brief Bytes already passed to flushCallback. */
+    } _cborEncoderWrapper_t;
+
 /**
  * @todo Placeholder.
  */
@@ -91,7 +105,7 @@
  * Static memory buffers and flags, allocated and zeroed at compile-time.
  */
     static bool _inUseCborEncoders[ IOT_SERIALIZER_CBOR_ENCODERS ] = { 0 };
-    static CborEncoder _cborEncoders[ IOT_SERIALIZER_CBOR_ENCODERS ] = { { .data = { 0 } } };
+    static _cborEncoderWrapper_t _cborEncoders[ IOT_SERIALIZER_CBOR_ENCODERS ] = { { .pStream = NULL } };
 
     static bool _inUseCborParsers[ IOT_SERIALIZER_CBOR_PARSERS ] = { 0 };
     static CborParser _cborParsers[ IOT_SERIALIZER_CBOR_PARSERS ] = { { 0 } };
@@ -109,7 +123,7 @@
         int32_t freeIndex = -1;
         void * pNewCborEncoder = NULL;
 
-        if( size == sizeof( CborEncoder ) )
+        if( size == sizeof( _cborEncoderWrapper_t ) )
         {
             freeIndex = IotStaticMemory_FindFree( _inUseCborEncoders,
                                                   IOT_SERIALIZER_CBOR_ENCODERS );
@@ -131,7 +145,7 @@
                                      _cborEncoders,
                                      _inUseCborEncoders,
                                      IOT_SERIALIZER_CBOR_ENCODERS,
-                                     sizeof( CborEncoder ) );
+                                     sizeof( _cborEncoderWrapper_t ) );
     }
 
 /*-----------------------------------------------------------*/
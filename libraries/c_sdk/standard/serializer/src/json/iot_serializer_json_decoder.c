@@ -31,11 +31,17 @@
  * A special type called binary string is also supported as a value type. By default
  * binary strings are base-64 decoded.
  * The file implements decoder interface in aws_iot_serialize.h.
+ *
+ * Two decoders share the implementation. _IotSerializerJsonDecoder scans the
+ * document text again on every call. _IotSerializerJsonTapeDecoder indexes the
+ * document into a tape of tokens in init, so that find, get, stepIn and next
+ * jump straight to a token instead of scanning the text before it.
  */
 
 #include <string.h>
 
 #include "iot_serializer.h"
+#include "iot_json_utils.h"
 #include "mbedtls/base64.h"
 
 #define _MINIMUM_CONTAINER_LENGTH    ( 2 )
@@ -48,6 +54,9 @@
 #define _STOP_CHAR_MAP               '}'
 #define _STRING_QUOTE                '"'
 #define _QUOTE_ESCAPE                '\\'
+#define _INLINE_STRING_LENGTH        ( 16 )
+
+#define _TAPE_NO_CONTAINER           ( UINT32_MAX )
 
 #define _isValidContainer( decoder )                          \
     ( ( decoder ) &&                                          \
@@ -62,6 +71,10 @@ static IotSerializerError_t _init( IotSerializerDecoderObject_t * pDecoderObject
                                    const uint8_t * pDataBuffer,
                                    size_t maxSize );
 
+static IotSerializerError_t _initTape( IotSerializerDecoderObject_t * pDecoderObject,
+                                       const uint8_t * pDataBuffer,
+                                       size_t maxSize );
+
 static IotSerializerError_t _find( IotSerializerDecoderObject_t * pDecoderObject,
                                    const char * pKey,
                                    IotSerializerDecoderObject_t * pValueObject );
@@ -97,10 +110,41 @@ IotSerializerDecodeInterface_t _IotSerializerJsonDecoder =
     .destroy          = _destroy
 };
 
+IotSerializerDecodeInterface_t _IotSerializerJsonTapeDecoder =
+{
+    .init             = _initTape,
+    .find             = _find,
+    .stepIn           = _stepIn,
+    .isEndOfContainer = _isEndOfContainer,
+    .get              = _get,
+    .next             = _next,
+    .stepOut          = _stepOut,
+    .destroy          = _destroy
+};
+
+/* One token of an indexed document. A container has a second entry for its
+ * stop char, so its entries run from its own up to and including that one. */
+typedef struct _jsonTapeEntry
+{
+    uint32_t offset; /* Offset of the first char of the token in the document. */
+    uint32_t next;   /* Index of the entry after the token, after the whole container for a container. */
+} _jsonTapeEntry_t;
+
+/* Shared by all the containers decoded from the same document, and freed with the last one. */
+typedef struct _jsonTape
+{
+    const char * pDocument;
+    uint32_t references;
+    _jsonTapeEntry_t entries[];
+} _jsonTape_t;
+
 typedef struct _jsonContainer
 {
     const char * pStart;
     size_t length;
+    _jsonTape_t * pTape; /* NULL if the document isn't indexed. */
+    uint32_t index;      /* Tape entry of the token at pStart. */
+    uint32_t end;        /* Tape entry of the stop char of the container. */
 } _jsonContainer_t;
 
 /*-----------------------------------------------------------*/
@@ -166,6 +210,7 @@ static _jsonContainer_t * _createContainer( const char * pBuffer,
     {
         pContainer->pStart = pBuffer;
         pContainer->length = length;
+        pContainer->pTape = NULL;
     }
 
     return pContainer;
@@ -173,6 +218,57 @@ static _jsonContainer_t * _createContainer( const char * pBuffer,
 
 /*-----------------------------------------------------------*/
 
+static void _tapeSeek( _jsonContainer_t * pContainer,
+                       uint32_t index )
+{
+    const _jsonTapeEntry_t * pEntries = pContainer->pTape->entries;
+
+    /* Keep pStart and length in step, the functions that don't need the tape use them. */
+    pContainer->index = index;
+    pContainer->pStart = pContainer->pTape->pDocument + pEntries[ index ].offset;
+    pContainer->length = ( pEntries[ pContainer->end ].offset + 1 ) - pEntries[ index ].offset;
+}
+
+/*-----------------------------------------------------------*/
+
+static _jsonContainer_t * _createTapeContainer( _jsonTape_t * pTape,
+                                                uint32_t start )
+{
+    _jsonContainer_t * pContainer = _createContainer( pTape->pDocument, 0 );
+
+    if( pContainer != NULL )
+    {
+        /* The entries of the container follow the entry of its start char. */
+        pContainer->pTape = pTape;
+        pContainer->end = pTape->entries[ start ].next - 1;
+        _tapeSeek( pContainer, start + 1 );
+        pTape->references++;
+    }
+
+    return pContainer;
+}
+
+/*-----------------------------------------------------------*/
+
+static void _destroyContainer( _jsonContainer_t * pContainer )
+{
+    _jsonTape_t * pTape = pContainer->pTape;
+
+    if( pTape != NULL )
+    {
+        pTape->references--;
+
+        if( pTape->references == 0 )
+        {
+            vPortFree( pTape );
+        }
+    }
+
+    vPortFree( pContainer );
+}
+
+/*-----------------------------------------------------------*/
+
 static void _skipWhiteSpacesAndDelimeters( const char * pBuffer,
                                            const size_t bufLength,
                                            size_t * pOffset )
@@ -260,17 +356,43 @@ static void parseTextString( const char * pBuffer,
                              size_t * pOffset )
 
 {
-    size_t offset = *pOffset;
+    size_t offset = *pOffset, inlineEnd = 0;
 
-    for( ; offset < bufLength && pBuffer[ offset ] != _STRING_QUOTE; offset++ )
+    while( offset < bufLength )
     {
+        /* Most strings are short enough that checking them in place is cheaper
+         * than calling the scanner. */
+        inlineEnd = ( ( bufLength - offset ) > _INLINE_STRING_LENGTH ) ?
+                    ( offset + _INLINE_STRING_LENGTH ) : bufLength;
+
+        while( ( offset < inlineEnd ) &&
+               ( pBuffer[ offset ] != _STRING_QUOTE ) &&
+               ( pBuffer[ offset ] != _QUOTE_ESCAPE ) )
+        {
+            offset++;
+        }
+
+        /* Skip the rest of a long string up to the next quote or backslash. */
+        if( offset == inlineEnd )
+        {
+            offset += IotJsonUtils_ScanFor( pBuffer + offset,
+                                            bufLength - offset,
+                                            IOT_JSON_QUOTE | IOT_JSON_BACKSLASH );
+        }
+
+        if( ( offset >= bufLength ) || ( pBuffer[ offset ] == _STRING_QUOTE ) )
+        {
+            break;
+        }
+
         /* Backslash: Quoted symbol expected */
         if( ( offset < bufLength - 1 ) &&
-            ( pBuffer[ offset ] == _QUOTE_ESCAPE ) &&
             ( pBuffer[ offset + 1 ] == _STRING_QUOTE ) )
         {
             offset++;
         }
+
+        offset++;
     }
 
     *pOffset = offset;
@@ -420,6 +542,211 @@ static IotSerializerError_t parseTokenValue( const char * pBuffer,
 
 /*-----------------------------------------------------------*/
 
+/*
+ * Index the container at the start of the buffer into pEntries. With pEntries NULL,
+ * only count the entries needed. Returns 0 if the container can't be indexed, for
+ * example if it doesn't end within the buffer.
+ */
+static uint32_t _buildTape( const char * pBuffer,
+                            const size_t bufLength,
+                            _jsonTapeEntry_t * pEntries )
+{
+    size_t offset = 0;
+    uint32_t count = 0, depth = 0;
+    uint32_t open = _TAPE_NO_CONTAINER, parent;
+    bool isValid = ( bufLength < UINT32_MAX );
+
+    while( isValid )
+    {
+        _skipWhiteSpacesAndDelimeters( pBuffer, bufLength, &offset );
+
+        if( offset >= bufLength )
+        {
+            isValid = false;
+            break;
+        }
+
+        if( pEntries != NULL )
+        {
+            pEntries[ count ].offset = ( uint32_t ) offset;
+            pEntries[ count ].next = count + 1;
+        }
+
+        switch( pBuffer[ offset ] )
+        {
+            case _START_CHAR_MAP:
+            case _START_CHAR_ARRAY:
+
+                /* Until the container ends, next links it to the container it is in. */
+                if( pEntries != NULL )
+                {
+                    pEntries[ count ].next = open;
+                    open = count;
+                }
+
+                depth++;
+                offset++;
+                break;
+
+            case _STOP_CHAR_MAP:
+            case _STOP_CHAR_ARRAY:
+
+                if( depth == 0 )
+                {
+                    isValid = false;
+                }
+                else
+                {
+                    /* The stop char has to match the start char of the container. */
+                    if( pEntries != NULL )
+                    {
+                        if( ( pBuffer[ pEntries[ open ].offset ] == _START_CHAR_MAP ) != ( pBuffer[ offset ] == _STOP_CHAR_MAP ) )
+                        {
+                            isValid = false;
+                        }
+                        else
+                        {
+                            parent = pEntries[ open ].next;
+                            pEntries[ open ].next = count + 1;
+                            open = parent;
+                        }
+                    }
+
+                    depth--;
+                }
+
+                offset++;
+                break;
+
+            case _STRING_QUOTE:
+                offset++;
+                parseTextString( pBuffer, bufLength, &offset );
+                offset++; /* Skip past the closing quote */
+                break;
+
+            default:
+
+                if( _getTokenType( pBuffer, offset ) == IOT_SERIALIZER_UNDEFINED )
+                {
+                    isValid = false;
+                }
+
+                /* Numbers, booleans and null run up to the next delimiter. */
+                for( offset++; offset < bufLength; offset++ )
+                {
+                    if( ( pBuffer[ offset ] == ' ' ) ||
+                        ( pBuffer[ offset ] == '\r' ) ||
+                        ( pBuffer[ offset ] == '\n' ) ||
+                        ( pBuffer[ offset ] == '\t' ) ||
+                        ( pBuffer[ offset ] == ':' ) ||
+                        ( pBuffer[ offset ] == ',' ) ||
+                        ( pBuffer[ offset ] == _STOP_CHAR_MAP ) ||
+                        ( pBuffer[ offset ] == _STOP_CHAR_ARRAY ) )
+                    {
+                        break;
+                    }
+                }
+
+                break;
+        }
+
+        count++;
+
+        /* Stop at the end of the container the buffer starts with. */
+        if( depth == 0 )
+        {
+            break;
+        }
+    }
+
+    return isValid ? count : 0;
+}
+
+/*-----------------------------------------------------------*/
+
+static IotSerializerError_t _getTapeValue( _jsonContainer_t * pObject,
+                                           uint32_t index,
+                                           IotSerializerDecoderObject_t * pValue )
+{
+    const _jsonTapeEntry_t * pEntries = pObject->pTape->entries;
+    const char * pDocument = pObject->pTape->pDocument;
+    size_t offset = pEntries[ index ].offset;
+    IotSerializerDataType_t tokenType = _getTokenType( pDocument, offset );
+    _jsonContainer_t * pContainer;
+    IotSerializerError_t error = IOT_SERIALIZER_SUCCESS;
+
+    if( ( tokenType == IOT_SERIALIZER_CONTAINER_MAP ) ||
+        ( tokenType == IOT_SERIALIZER_CONTAINER_ARRAY ) )
+    {
+        /* The extent of the container is on the tape, so don't scan it. */
+        if( pValue != NULL )
+        {
+            pContainer = _createTapeContainer( pObject->pTape, index );
+
+            if( pContainer != NULL )
+            {
+                pValue->type = tokenType;
+                pValue->u.pHandle = pContainer;
+            }
+            else
+            {
+                error = IOT_SERIALIZER_OUT_OF_MEMORY;
+            }
+        }
+    }
+    else
+    {
+        error = parseTokenValue( pDocument, pEntries[ pObject->end ].offset + 1, &offset, tokenType, pValue );
+    }
+
+    return error;
+}
+
+/*-----------------------------------------------------------*/
+
+static IotSerializerError_t _findTapeKeyValue( _jsonContainer_t * pObject,
+                                               const char * pKey,
+                                               IotSerializerDecoderObject_t * pValue )
+{
+    const _jsonTapeEntry_t * pEntries = pObject->pTape->entries;
+    const char * pDocument = pObject->pTape->pDocument;
+    uint32_t index = pObject->index, valueIndex;
+    size_t start, offset;
+    IotSerializerError_t ret = IOT_SERIALIZER_NOT_FOUND;
+
+    /* Keys and values alternate, and a value is skipped in one step however large it is. */
+    while( ( index < pObject->end ) && ( ret == IOT_SERIALIZER_NOT_FOUND ) )
+    {
+        valueIndex = pEntries[ index ].next;
+
+        /* JSON key can only be text string, and has to be followed by a value. */
+        if( ( pDocument[ pEntries[ index ].offset ] != _STRING_QUOTE ) ||
+            ( valueIndex >= pObject->end ) )
+        {
+            ret = IOT_SERIALIZER_INTERNAL_FAILURE;
+        }
+        else
+        {
+            start = pEntries[ index ].offset + 1;
+            offset = start;
+            parseTextString( pDocument, pEntries[ valueIndex ].offset, &offset );
+
+            if( strncmp( pKey, pDocument + start, offset - start ) == 0 )
+            {
+                ret = _getTapeValue( pObject, valueIndex, pValue );
+            }
+            else
+            {
+                index = pEntries[ valueIndex ].next;
+            }
+        }
+    }
+
+    return ret;
+}
+
+/*-----------------------------------------------------------*/
+
 static IotSerializerError_t _findKeyValue( _jsonContainer_t * pObject,
                                            const char * pKey,
                                            size_t keyLength,
@@ -578,6 +905,53 @@ static IotSerializerError_t _init( IotSerializerDecoderObject_t * pDecoderObject
     return error;
 }
 
+/*-----------------------------------------------------------*/
+
+static IotSerializerError_t _initTape( IotSerializerDecoderObject_t * pDecoderObject,
+                                       const uint8_t * pDataBuffer,
+                                       size_t maxSize )
+{
+    _jsonContainer_t * pContainer;
+    _jsonTape_t * pTape = NULL;
+    const char * pStart = ( const char * ) pDataBuffer;
+    size_t length = 0;
+    uint32_t count = 0;
+    IotSerializerError_t error = _init( pDecoderObject, pDataBuffer, maxSize );
+
+    if( error == IOT_SERIALIZER_SUCCESS )
+    {
+        pContainer = pDecoderObject->u.pHandle;
+        length = pContainer->length + 1; /* The container starts after the start char */
+
+        /* Size the tape, then fill it. */
+        count = _buildTape( pStart, length, NULL );
+
+        if( count > 0 )
+        {
+            pTape = pvPortMalloc( sizeof( _jsonTape_t ) + ( count * sizeof( _jsonTapeEntry_t ) ) );
+        }
+
+        /* Only filling the tape checks that stop chars match their start chars. */
+        if( ( pTape != NULL ) && ( _buildTape( pStart, length, pTape->entries ) != count ) )
+        {
+            vPortFree( pTape );
+            pTape = NULL;
+        }
+
+        /* If the document can't be indexed, it is decoded from the text like
+         * _IotSerializerJsonDecoder does. */
+        if( pTape != NULL )
+        {
+            pTape->pDocument = pStart;
+            pTape->references = 1;
+            pContainer->pTape = pTape;
+            pContainer->end = pTape->entries[ 0 ].next - 1;
+            _tapeSeek( pContainer, 1 );
+        }
+    }
+
+    return error;
+}
 
 /*-----------------------------------------------------------*/
 
@@ -591,11 +965,19 @@ static IotSerializerError_t _find( IotSerializerDecoderObject_t * pDecoderObject
     if( pDecoderObject->type == IOT_SERIALIZER_CONTAINER_MAP )
     {
         pContainer = ( _jsonContainer_t * ) pDecoderObject->u.pHandle;
-        error = _findKeyValue(
-            pContainer,
-            pKey,
-            strlen( pKey ),
-            pValueObject );
+
+        if( pContainer->pTape != NULL )
+        {
+            error = _findTapeKeyValue( pContainer, pKey, pValueObject );
+        }
+        else
+        {
+            error = _findKeyValue(
+                pContainer,
+                pKey,
+                strlen( pKey ),
+                pValueObject );
+        }
     }
     else
     {
@@ -636,6 +1018,15 @@ static IotSerializerError_t _stepIn( IotSerializerDecoderObject_t * pDecoderObje
 
                 if( pNewObject != NULL )
                 {
+                    /* The iterator starts at the same token on the same tape. */
+                    if( pContainer->pTape != NULL )
+                    {
+                        pNewContainer->pTape = pContainer->pTape;
+                        pNewContainer->index = pContainer->index;
+                        pNewContainer->end = pContainer->end;
+                        pContainer->pTape->references++;
+                    }
+
                     pNewObject->type = pDecoderObject->type;
                     pNewObject->u.pHandle = pNewContainer;
                     *pIterator = ( IotSerializerDecoderIterator_t ) pNewObject;
@@ -718,7 +1109,15 @@ static IotSerializerError_t _get( IotSerializerDecoderIterator_t iterator,
         pContainer = _castDecoderIteratorToJsonContainer( iterator );
         type = _getTokenType( pContainer->pStart, offset );
 
-        if( type != IOT_SERIALIZER_UNDEFINED )
+        if( type == IOT_SERIALIZER_UNDEFINED )
+        {
+            error = IOT_SERIALIZER_INTERNAL_FAILURE;
+        }
+        else if( ( pContainer->pTape != NULL ) && ( pContainer->index <= pContainer->end ) )
+        {
+            error = _getTapeValue( pContainer, pContainer->index, pValueObject );
+        }
+        else
         {
             parseTokenValue( pContainer->pStart, pContainer->length, &offset, type, pValueObject );
 
@@ -727,10 +1126,6 @@ static IotSerializerError_t _get( IotSerializerDecoderIterator_t iterator,
                 error = IOT_SERIALIZER_BUFFER_TOO_SMALL;
             }
         }
-        else
-        {
-            error = IOT_SERIALIZER_INTERNAL_FAILURE;
-        }
     }
     else
     {
@@ -754,17 +1149,31 @@ static IotSerializerError_t _next( IotSerializerDecoderIterator_t iterator )
     if( _isValidContainer( pObject ) )
     {
         pContainer = pObject->u.pHandle;
-        type = _getTokenType( pContainer->pStart, offset );
-        parseTokenValue( pContainer->pStart, pContainer->length, &offset, type, NULL );
-        _skipWhiteSpacesAndDelimeters( pContainer->pStart, pContainer->length, &offset );
 
-        if( offset < pContainer->length )
+        if( pContainer->pTape != NULL )
         {
-            pContainer->pStart += offset;
+            /* Stay on the stop char at the end of the container. */
+            if( pContainer->index < pContainer->end )
+            {
+                _tapeSeek( pContainer, pContainer->pTape->entries[ pContainer->index ].next );
+            }
         }
         else
         {
-            error = IOT_SERIALIZER_BUFFER_TOO_SMALL;
+            type = _getTokenType( pContainer->pStart, offset );
+            parseTokenValue( pContainer->pStart, pContainer->length, &offset, type, NULL );
+            _skipWhiteSpacesAndDelimeters( pContainer->pStart, pContainer->length, &offset );
+
+            /* The scans read up to length chars, so keep it to the end of the container. */
+            if( offset < pContainer->length )
+            {
+                pContainer->pStart += offset;
+                pContainer->length -= offset;
+            }
+            else
+            {
+                error = IOT_SERIALIZER_BUFFER_TOO_SMALL;
+            }
         }
     }
     else
@@ -791,8 +1200,10 @@ static IotSerializerError_t _stepOut( IotSerializerDecoderIterator_t iterator,
 
         if( _isEOF( pIterContainer->pStart, pIterObject->type ) )
         {
+            pContainer->length -= ( size_t ) ( ( pIterContainer->pStart + 1 ) - pContainer->pStart );
             pContainer->pStart = ( pIterContainer->pStart + 1 );
-            vPortFree( pIterContainer );
+            pContainer->index = pIterContainer->end + 1;
+            _destroyContainer( pIterContainer );
             vPortFree( pIterObject );
         }
         else
@@ -816,7 +1227,7 @@ static void _destroy( IotSerializerDecoderObject_t * pDecoderObject )
     {
         if( pDecoderObject->u.pHandle != NULL )
         {
-            vPortFree( pDecoderObject->u.pHandle );
+            _destroyContainer( pDecoderObject->u.pHandle );
             pDecoderObject->u.pHandle = NULL;
         }
     }
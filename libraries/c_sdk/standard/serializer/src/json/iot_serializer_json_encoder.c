@@ -93,6 +93,11 @@
         ( ( container )->type >= IOT_SERIALIZER_CONTAINER_STREAM ) && \
         ( ( container )->type <= IOT_SERIALIZER_CONTAINER_MAP ) )
 
+/* A container that was opened, and not closed or destroyed since. A container
+ * whose open failed has no handle. */
+#define _jsonIsOpenContainer( container ) \
+    ( _jsonIsValidContainer( container ) && ( ( container )->pHandle != NULL ) )
+
 typedef struct _jsonContainer
 {
     IotSerializerDataType_t containerType;
@@ -102,6 +107,10 @@ typedef struct _jsonContainer
     size_t remainingLength;
     size_t maxLength;
     size_t overflowLength;
+    IotSerializerFlushCallback_t flushCallback; /* NULL unless initialized with _initStream. */
+    void * pFlushContext;
+    size_t flushedLength;                       /* Bytes already passed to flushCallback. */
+    size_t openContainers;                      /* Each open container keeps its closing character reserved. */
 } _jsonContainer_t;
 
 /**
@@ -145,6 +154,33 @@ static IotSerializerError_t _init( IotSerializerEncoderObject_t * pEncoderObject
                                    uint8_t * pDataBuffer,
                                    size_t maxSize );
 
+/**
+ * @brief Initializes the JSON encoder object to encode into a window that is flushed
+ * whenever the next value does not fit.
+ *
+ * @param[in] pEncoderObject: Pointer to the JSON encoder object
+ * @param[in] pWindow Pointer to the window
+ * @param[in] windowSize Size of the window
+ * @param[in] flushCallback Called with the encoded data each time the window is flushed
+ * @param[in] pFlushContext Passed to flushCallback
+ *
+ * @return IOT_SERIALIZER_SUCCESS on success
+ */
+static IotSerializerError_t _initStream( IotSerializerEncoderObject_t * pEncoderObject,
+                                         uint8_t * pWindow,
+                                         size_t windowSize,
+                                         IotSerializerFlushCallback_t flushCallback,
+                                         void * pFlushContext );
+
+/**
+ * @brief Passes the data left in the window of a streaming encoder to its flush callback.
+ *
+ * @param[in] pEncoderObject Pointer to the outermost JSON encoder object
+ *
+ * @return IOT_SERIALIZER_SUCCESS on success
+ */
+static IotSerializerError_t _flush( IotSerializerEncoderObject_t * pEncoderObject );
+
 /**
  * @brief Destroys the encoder object
  *
@@ -233,6 +269,9 @@ static size_t _getValueLength( _jsonContainer_t * pContainer,
                                IotSerializerDataType_t valueType,
                                IotSerializerScalarData_t * pScalarValue );
 
+static IotSerializerError_t _flushWindow( _jsonContainer_t * pContainer );
+static IotSerializerError_t _makeRoom( _jsonContainer_t * pContainer,
+                                       size_t length );
 static void _stopContainer( _jsonContainer_t * pContainer,
                             IotSerializerDataType_t containerType );
 static void _appendTextString( _jsonContainer_t * pContainer,
@@ -267,11 +306,54 @@ IotSerializerEncodeInterface_t _IotSerializerJsonEncoder =
     .openContainerWithKey     = _openContainerWithKey,
     .closeContainer           = _closeContainer,
     .append                   = _append,
-    .appendKeyValue           = _appendKeyValue
+    .appendKeyValue           = _appendKeyValue,
+    .initStream               = _initStream,
+    .flush                    = _flush
 };
 
 /*-----------------------------------------------------------*/
 
+static IotSerializerError_t _flushWindow( _jsonContainer_t * pContainer )
+{
+    IotSerializerError_t error = IOT_SERIALIZER_SUCCESS;
+
+    if( pContainer->flushCallback( pContainer->pFlushContext,
+                                   pContainer->pBuffer,
+                                   pContainer->offset ) == true )
+    {
+        /* The closing characters of the open containers stay reserved. */
+        pContainer->flushedLength += pContainer->offset;
+        pContainer->remainingLength = pContainer->maxLength - pContainer->openContainers;
+        pContainer->offset = 0;
+    }
+    else
+    {
+        error = IOT_SERIALIZER_FLUSH_FAILED;
+    }
+
+    return error;
+}
+
+/*-----------------------------------------------------------*/
+
+static IotSerializerError_t _makeRoom( _jsonContainer_t * pContainer,
+                                       size_t length )
+{
+    IotSerializerError_t error = IOT_SERIALIZER_SUCCESS;
+
+    /* A streaming encoder flushes the window when the next value does not fit. */
+    if( ( pContainer->flushCallback != NULL ) &&
+        ( pContainer->remainingLength < length ) &&
+        ( pContainer->offset > 0 ) )
+    {
+        error = _flushWindow( pContainer );
+    }
+
+    return error;
+}
+
+/*-----------------------------------------------------------*/
+
 static void _stopContainer( _jsonContainer_t * pContainer,
                             IotSerializerDataType_t containerType )
 {
@@ -523,6 +605,10 @@ static IotSerializerError_t _init( IotSerializerEncoderObject_t * pEncoderObject
         pContainer->offset = 0;
         pContainer->overflowLength = 0;
         pContainer->isEmpty = true;
+        pContainer->flushCallback = NULL;
+        pContainer->pFlushContext = NULL;
+        pContainer->flushedLength = 0;
+        pContainer->openContainers = 0;
 
         /* Set the outermost container default type as stream */
         pEncoderObject->type = IOT_SERIALIZER_CONTAINER_STREAM;
@@ -540,6 +626,57 @@ static IotSerializerError_t _init( IotSerializerEncoderObject_t * pEncoderObject
 
 /*-----------------------------------------------------------*/
 
+static IotSerializerError_t _initStream( IotSerializerEncoderObject_t * pEncoderObject,
+                                         uint8_t * pWindow,
+                                         size_t windowSize,
+                                         IotSerializerFlushCallback_t flushCallback,
+                                         void * pFlushContext )
+{
+    _jsonContainer_t * pContainer;
+    IotSerializerError_t error = IOT_SERIALIZER_INVALID_INPUT;
+
+    if( ( pWindow != NULL ) && ( windowSize > 0 ) && ( flushCallback != NULL ) )
+    {
+        error = _init( pEncoderObject, pWindow, windowSize );
+
+        if( error == IOT_SERIALIZER_SUCCESS )
+        {
+            pContainer = ( _jsonContainer_t * ) ( pEncoderObject->pHandle );
+            pContainer->flushCallback = flushCallback;
+            pContainer->pFlushContext = pFlushContext;
+        }
+    }
+
+    return error;
+}
+
+/*-----------------------------------------------------------*/
+
+static IotSerializerError_t _flush( IotSerializerEncoderObject_t * pEncoderObject )
+{
+    IotSerializerError_t error = IOT_SERIALIZER_SUCCESS;
+    _jsonContainer_t * pContainer = NULL;
+
+    if( _jsonIsOpenContainer( pEncoderObject ) &&
+        ( ( ( _jsonContainer_t * ) ( pEncoderObject->pHandle ) )->flushCallback != NULL ) )
+    {
+        pContainer = ( _jsonContainer_t * ) ( pEncoderObject->pHandle );
+
+        if( pContainer->offset > 0 )
+        {
+            error = _flushWindow( pContainer );
+        }
+    }
+    else
+    {
+        error = IOT_SERIALIZER_INVALID_INPUT;
+    }
+
+    return error;
+}
+
+/*-----------------------------------------------------------*/
+
 static void _destroy( IotSerializerEncoderObject_t * pEncoderObject )
 {
     _jsonContainer_t * pContainer;
@@ -562,27 +699,39 @@ static IotSerializerError_t _openContainer( IotSerializerEncoderObject_t * pEnco
 
     ( void ) length;
 
-    if( _jsonIsValidContainer( pEncoderObject ) &&
+    if( _jsonIsOpenContainer( pEncoderObject ) &&
         _jsonIsValidContainer( pNewEncoderObject ) )
     {
         pContainer = ( _jsonContainer_t * ) pEncoderObject->pHandle;
         serializedLength = _getValueLength( pContainer, pNewEncoderObject->type, NULL );
 
-        if( pContainer->remainingLength >= serializedLength )
+        /* Nothing changes if the window of a streaming encoder could not be flushed,
+         * and the child container is not opened. */
+        error = _makeRoom( pContainer, serializedLength );
+
+        if( error != IOT_SERIALIZER_SUCCESS )
         {
-            _appendJsonValue( pContainer, pNewEncoderObject->type, NULL );
-            pContainer->remainingLength -= serializedLength;
+            pNewEncoderObject->pHandle = NULL;
         }
         else
         {
-            pContainer->overflowLength += ( serializedLength - pContainer->remainingLength );
-            pContainer->remainingLength = 0;
-            error = IOT_SERIALIZER_BUFFER_TOO_SMALL;
+            if( pContainer->remainingLength >= serializedLength )
+            {
+                _appendJsonValue( pContainer, pNewEncoderObject->type, NULL );
+                pContainer->remainingLength -= serializedLength;
+                pContainer->openContainers++;
+            }
+            else
+            {
+                pContainer->overflowLength += ( serializedLength - pContainer->remainingLength );
+                pContainer->remainingLength = 0;
+                error = IOT_SERIALIZER_BUFFER_TOO_SMALL;
+            }
+
+            pContainer->isEmpty = true;
+            pContainer->containerType = pNewEncoderObject->type;
+            pNewEncoderObject->pHandle = ( void * ) pContainer;
         }
-
-        pContainer->isEmpty = true;
-        pContainer->containerType = pNewEncoderObject->type;
-        pNewEncoderObject->pHandle = ( void * ) pContainer;
     }
     else
     {
@@ -605,28 +754,40 @@ static IotSerializerError_t _openContainerWithKey( IotSerializerEncoderObject_t
 
     ( void ) length;
 
-    if( _jsonIsValidContainer( pEncoderObject ) &&
+    if( _jsonIsOpenContainer( pEncoderObject ) &&
         _jsonIsValidContainer( pNewEncoderObject ) &&
         ( pEncoderObject->type == IOT_SERIALIZER_CONTAINER_MAP ) )
     {
         pContainer = ( _jsonContainer_t * ) pEncoderObject->pHandle;
         serializedLength = _getKeyValueLength( pContainer, keyLength, pNewEncoderObject->type, NULL );
 
-        if( pContainer->remainingLength >= serializedLength )
+        /* Nothing changes if the window of a streaming encoder could not be flushed,
+         * and the child container is not opened. */
+        error = _makeRoom( pContainer, serializedLength );
+
+        if( error != IOT_SERIALIZER_SUCCESS )
         {
-            _appendJsonKeyValuePair( pContainer, pKey, keyLength, pNewEncoderObject->type, NULL );
-            pContainer->remainingLength -= serializedLength;
+            pNewEncoderObject->pHandle = NULL;
         }
         else
         {
-            pContainer->overflowLength += ( serializedLength - pContainer->remainingLength );
-            pContainer->remainingLength = 0;
-            error = IOT_SERIALIZER_BUFFER_TOO_SMALL;
+            if( pContainer->remainingLength >= serializedLength )
+            {
+                _appendJsonKeyValuePair( pContainer, pKey, keyLength, pNewEncoderObject->type, NULL );
+                pContainer->remainingLength -= serializedLength;
+                pContainer->openContainers++;
+            }
+            else
+            {
+                pContainer->overflowLength += ( serializedLength - pContainer->remainingLength );
+                pContainer->remainingLength = 0;
+                error = IOT_SERIALIZER_BUFFER_TOO_SMALL;
+            }
+
+            pContainer->isEmpty = true;
+            pContainer->containerType = pNewEncoderObject->type;
+            pNewEncoderObject->pHandle = ( void * ) pContainer;
         }
-
-        pContainer->isEmpty = true;
-        pContainer->containerType = pNewEncoderObject->type;
-        pNewEncoderObject->pHandle = ( void * ) pContainer;
     }
     else
     {
@@ -645,7 +806,7 @@ static IotSerializerError_t _closeContainer( IotSerializerEncoderObject_t * pEnc
     _jsonContainer_t * pContainer;
 
     if( _jsonIsValidContainer( pEncoderObject ) &&
-        _jsonIsValidContainer( pNewEncoderObject ) )
+        _jsonIsOpenContainer( pNewEncoderObject ) )
     {
         pContainer = ( _jsonContainer_t * ) ( pNewEncoderObject->pHandle );
 
@@ -658,6 +819,11 @@ static IotSerializerError_t _closeContainer( IotSerializerEncoderObject_t * pEnc
             error = IOT_SERIALIZER_BUFFER_TOO_SMALL;
         }
 
+        if( pContainer->openContainers > 0 )
+        {
+            pContainer->openContainers--;
+        }
+
         pContainer->containerType = pEncoderObject->type;
         pContainer->isEmpty = false;
         pEncoderObject->pHandle = ( void * ) pContainer;
@@ -680,26 +846,32 @@ static IotSerializerError_t _append( IotSerializerEncoderObject_t * pEncoderObje
     _jsonContainer_t * pContainer;
     size_t serializedLength;
 
-    if( _jsonIsValidContainer( pEncoderObject ) &&
+    if( _jsonIsOpenContainer( pEncoderObject ) &&
         ( pEncoderObject->type == IOT_SERIALIZER_CONTAINER_ARRAY ) &&
         _jsonIsValidScalar( &scalarData ) )
     {
         pContainer = ( _jsonContainer_t * ) ( pEncoderObject->pHandle );
         serializedLength = _getValueLength( pContainer, scalarData.type, &scalarData );
 
-        if( pContainer->remainingLength >= serializedLength )
-        {
-            _appendJsonValue( pContainer, scalarData.type, &scalarData );
-            pContainer->remainingLength -= serializedLength;
-        }
-        else
+        /* Nothing changes if the window of a streaming encoder could not be flushed. */
+        error = _makeRoom( pContainer, serializedLength );
+
+        if( error == IOT_SERIALIZER_SUCCESS )
         {
-            pContainer->overflowLength += ( serializedLength - pContainer->remainingLength );
-            pContainer->remainingLength = 0;
-            error = IOT_SERIALIZER_BUFFER_TOO_SMALL;
+            if( pContainer->remainingLength >= serializedLength )
+            {
+                _appendJsonValue( pContainer, scalarData.type, &scalarData );
+                pContainer->remainingLength -= serializedLength;
+            }
+            else
+            {
+                pContainer->overflowLength += ( serializedLength - pContainer->remainingLength );
+                pContainer->remainingLength = 0;
+                error = IOT_SERIALIZER_BUFFER_TOO_SMALL;
+            }
+
+            pContainer->isEmpty = false;
         }
-
-        pContainer->isEmpty = false;
     }
     else
     {
@@ -720,26 +892,32 @@ static IotSerializerError_t _appendKeyValue( IotSerializerEncoderObject_t * pEnc
     size_t serializedLength, keyLength = strlen( pKey );
 
 
-    if( _jsonIsValidContainer( pEncoderObject ) &&
+    if( _jsonIsOpenContainer( pEncoderObject ) &&
         ( pEncoderObject->type == IOT_SERIALIZER_CONTAINER_MAP ) &&
         _jsonIsValidScalar( &scalarData ) )
     {
         pContainer = ( _jsonContainer_t * ) ( pEncoderObject->pHandle );
         serializedLength = _getKeyValueLength( pContainer, keyLength, scalarData.type, &scalarData );
 
-        if( pContainer->remainingLength >= serializedLength )
-        {
-            _appendJsonKeyValuePair( pContainer, pKey, keyLength, scalarData.type, &scalarData );
-            pContainer->remainingLength -= serializedLength;
-        }
-        else
+        /* Nothing changes if the window of a streaming encoder could not be flushed. */
+        error = _makeRoom( pContainer, serializedLength );
+
+        if( error == IOT_SERIALIZER_SUCCESS )
         {
-            pContainer->overflowLength += ( serializedLength - pContainer->remainingLength );
-            pContainer->remainingLength = 0;
-            error = IOT_SERIALIZER_BUFFER_TOO_SMALL;
+            if( pContainer->remainingLength >= serializedLength )
+            {
+                _appendJsonKeyValuePair( pContainer, pKey, keyLength, scalarData.type, &scalarData );
+                pContainer->remainingLength -= serializedLength;
+            }
+            else
+            {
+                pContainer->overflowLength += ( serializedLength - pContainer->remainingLength );
+                pContainer->remainingLength = 0;
+                error = IOT_SERIALIZER_BUFFER_TOO_SMALL;
+            }
+
+            pContainer->isEmpty = false;
         }
-
-        pContainer->isEmpty = false;
     }
     else
     {
@@ -763,7 +941,7 @@ static size_t _getEncodedSize( IotSerializerEncoderObject_t * pEncoderObject,
 
         if( ( pContainer != NULL ) && ( pDataBuffer == pContainer->pBuffer ) )
         {
-            encodedSize = pContainer->offset;
+            encodedSize = pContainer->flushedLength + pContainer->offset;
         }
     }
 
@@ -29,9 +29,23 @@
 
 /* Serializer includes. */
 #include "iot_serializer.h"
+#include "iot_json_utils.h"
 
-#define _encoder    _IotSerializerJsonEncoder
-#define _decoder    _IotSerializerJsonDecoder
+/* Platform layer includes. */
+#include "platform/iot_clock.h"
+
+/* Configure logs for the benchmark. */
+#define LIBRARY_LOG_LEVEL    IOT_LOG_INFO
+#define LIBRARY_LOG_NAME     ( "SERIALIZER_TEST" )
+#include "iot_logging_setup.h"
+
+#define _encoder                      _IotSerializerJsonEncoder
+#define _decoder                      _IotSerializerJsonDecoder
+#define _tapeDecoder                  _IotSerializerJsonTapeDecoder
+
+#define _TAPE_BENCHMARK_ITERATIONS    ( 1000 ) /**< @brief Number of times each document is decoded. */
+#define _MAX_KEY_LENGTH               ( 32 )   /**< @brief Longest key of the key paths looked up in the tests. */
+#define _SCAN_BENCHMARK_ITERATIONS    ( 2000 ) /**< @brief Number of times each document is scanned. */
 
 static IotSerializerDecoderObject_t rootObject = IOT_SERIALIZER_DECODER_OBJECT_INITIALIZER;
 static IotSerializerDecoderObject_t childObject = IOT_SERIALIZER_DECODER_OBJECT_INITIALIZER;
@@ -50,6 +64,327 @@ static const uint8_t test_data[] =
 
 static const uint16_t test_data_length = sizeof( test_data ) / sizeof( test_data[ 0 ] );
 
+/* A Shadow /update/documents message. */
+static const uint8_t shadow_document[] =
+    "{\"previous\":{\"state\":{\"desired\":{\"powerOn\":true,\"targetTemperature\":21,\"fanSpeed\":2,\"mode\":\"heat\"},"
+    "\"reported\":{\"powerOn\":true,\"temperature\":19,\"humidity\":41,\"fanSpeed\":1,\"mode\":\"heat\",\"firmware\":\"1.2.0\","
+    "\"uptime\":86400,\"rssi\":-61,\"errors\":[],\"sensors\":[{\"id\":\"t0\",\"value\":19},{\"id\":\"t1\",\"value\":20}]}},"
+    "\"metadata\":{\"desired\":{\"powerOn\":{\"timestamp\":1589485521},\"targetTemperature\":{\"timestamp\":1589485521},"
+    "\"fanSpeed\":{\"timestamp\":1589485521},\"mode\":{\"timestamp\":1589485521}},\"reported\":{\"powerOn\":{\"timestamp\":1589485490},"
+    "\"temperature\":{\"timestamp\":1589485490},\"humidity\":{\"timestamp\":1589485490},\"fanSpeed\":{\"timestamp\":1589485490},"
+    "\"mode\":{\"timestamp\":1589485490},\"firmware\":{\"timestamp\":1589485490},\"uptime\":{\"timestamp\":1589485490},"
+    "\"rssi\":{\"timestamp\":1589485490},\"errors\":{\"timestamp\":1589485490},\"sensors\":[{\"id\":{\"timestamp\":1589485490},"
+    "\"value\":{\"timestamp\":1589485490}},{\"id\":{\"timestamp\":1589485490},\"value\":{\"timestamp\":1589485490}}]}},\"version\":41},"
+    "\"current\":{\"state\":{\"desired\":{\"powerOn\":true,\"targetTemperature\":21,\"fanSpeed\":2,\"mode\":\"heat\"},"
+    "\"reported\":{\"powerOn\":true,\"temperature\":20,\"humidity\":40,\"fanSpeed\":2,\"mode\":\"heat\",\"firmware\":\"1.2.0\","
+    "\"uptime\":86460,\"rssi\":-60,\"errors\":[],\"sensors\":[{\"id\":\"t0\",\"value\":20},{\"id\":\"t1\",\"value\":20}]}},"
+    "\"metadata\":{\"desired\":{\"powerOn\":{\"timestamp\":1589485521},\"targetTemperature\":{\"timestamp\":1589485521},"
+    "\"fanSpeed\":{\"timestamp\":1589485521},\"mode\":{\"timestamp\":1589485521}},\"reported\":{\"powerOn\":{\"timestamp\":1589485550},"
+    "\"temperature\":{\"timestamp\":1589485550},\"humidity\":{\"timestamp\":1589485550},\"fanSpeed\":{\"timestamp\":1589485550},"
+    "\"mode\":{\"timestamp\":1589485550},\"firmware\":{\"timestamp\":1589485550},\"uptime\":{\"timestamp\":1589485550},"
+    "\"rssi\":{\"timestamp\":1589485550},\"errors\":{\"timestamp\":1589485550},\"sensors\":[{\"id\":{\"timestamp\":1589485550},"
+    "\"value\":{\"timestamp\":1589485550}},{\"id\":{\"timestamp\":1589485550},\"value\":{\"timestamp\":1589485550}}]}},\"version\":42},"
+    "\"timestamp\":1589485550,\"clientToken\":\"thermostat-1589485550\"}";
+
+/* The keys of the Shadow document an application would read. */
+static const char * const shadow_key_paths[] =
+{
+    "current.version",
+    "current.state.reported.temperature",
+    "current.state.reported.humidity",
+    "current.state.reported.fanSpeed",
+    "current.state.reported.mode",
+    "current.state.desired.targetTemperature",
+    "current.state.desired.fanSpeed",
+    "current.state.desired.mode",
+    "previous.version",
+    "timestamp",
+    "clientToken"
+};
+
+/* A Jobs notify-next message with an OTA job document. */
+static const uint8_t jobs_document[] =
+    "{\"timestamp\":1589485550,\"execution\":{\"jobId\":\"AFR_OTA-fw-1.3.0\",\"status\":\"QUEUED\",\"queuedAt\":1589485500,"
+    "\"lastUpdatedAt\":1589485500,\"versionNumber\":1,\"executionNumber\":1,\"jobDocument\":{\"afr_ota\":{\"protocols\":[\"MQTT\",\"HTTP\"],"
+    "\"streamname\":\"AFR_OTA-7c2f1bd2\",\"files\":[{\"filepath\":\"firmware.bin\",\"filesize\":181584,\"fileid\":0,\"certfile\":\"ecdsa-sha256-signer.crt.pem\","
+    "\"update_data_url\":\"https://ota-bucket.s3.amazonaws.com/firmware.bin?X-Amz-Algorithm=AWS4-HMAC-SHA256&X-Amz-Expires=3600\",\"auth_scheme\":\"aws.s3.presigned\","
+    "\"sig-sha256-ecdsa\":\"MEUCIQCJ5kbmPWUlcwZMrIrfu9MG8UHkJsoJaLhZ+6m1wUsjgQIgQ2kTxXJxs2F8WyhA+UBhztU9BP8VAn/eMAqQ1Qds4A4=\"}]}}}}";
+
+/* The keys of the job document the OTA agent reads. */
+static const char * const jobs_key_paths[] =
+{
+    "execution.jobId",
+    "execution.status",
+    "execution.jobDocument.afr_ota.streamname",
+    "execution.jobDocument.afr_ota.protocols",
+    "execution.jobDocument.afr_ota.files",
+    "timestamp"
+};
+
+/* shadow_key_paths as a query; each key names the index of its parent. */
+static const IotJsonQueryKey_t shadow_query[] =
+{
+    IOT_JSON_QUERY_KEY( IOT_JSON_QUERY_ROOT, "current" ),    /* 0 */
+    IOT_JSON_QUERY_KEY( 0, "version" ),                      /* 1 */
+    IOT_JSON_QUERY_KEY( 0, "state" ),                        /* 2 */
+    IOT_JSON_QUERY_KEY( 2, "reported" ),                     /* 3 */
+    IOT_JSON_QUERY_KEY( 3, "temperature" ),                  /* 4 */
+    IOT_JSON_QUERY_KEY( 3, "humidity" ),                     /* 5 */
+    IOT_JSON_QUERY_KEY( 3, "fanSpeed" ),                     /* 6 */
+    IOT_JSON_QUERY_KEY( 3, "mode" ),                         /* 7 */
+    IOT_JSON_QUERY_KEY( 2, "desired" ),                      /* 8 */
+    IOT_JSON_QUERY_KEY( 8, "targetTemperature" ),            /* 9 */
+    IOT_JSON_QUERY_KEY( 8, "fanSpeed" ),                     /* 10 */
+    IOT_JSON_QUERY_KEY( 8, "mode" ),                         /* 11 */
+    IOT_JSON_QUERY_KEY( IOT_JSON_QUERY_ROOT, "previous" ),   /* 12 */
+    IOT_JSON_QUERY_KEY( 12, "version" ),                     /* 13 */
+    IOT_JSON_QUERY_KEY( IOT_JSON_QUERY_ROOT, "timestamp" ),  /* 14 */
+    IOT_JSON_QUERY_KEY( IOT_JSON_QUERY_ROOT, "clientToken" ) /* 15 */
+};
+
+/* jobs_key_paths as a query, plus two keys of the objects in the files array. */
+static const IotJsonQueryKey_t jobs_query[] =
+{
+    IOT_JSON_QUERY_KEY( IOT_JSON_QUERY_ROOT, "execution" ), /* 0 */
+    IOT_JSON_QUERY_KEY( 0, "jobId" ),                       /* 1 */
+    IOT_JSON_QUERY_KEY( 0, "status" ),                      /* 2 */
+    IOT_JSON_QUERY_KEY( 0, "jobDocument" ),                 /* 3 */
+    IOT_JSON_QUERY_KEY( 3, "afr_ota" ),                     /* 4 */
+    IOT_JSON_QUERY_KEY( 4, "streamname" ),                  /* 5 */
+    IOT_JSON_QUERY_KEY( 4, "protocols" ),                   /* 6 */
+    IOT_JSON_QUERY_KEY( 4, "files" ),                       /* 7 */
+    IOT_JSON_QUERY_KEY( 7, "filepath" ),                    /* 8 */
+    IOT_JSON_QUERY_KEY( 7, "filesize" ),                    /* 9 */
+    IOT_JSON_QUERY_KEY( IOT_JSON_QUERY_ROOT, "timestamp" )  /* 10 */
+};
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Look up a value by its dot separated key path, with find at every level.
+ */
+static IotSerializerError_t _findPath( const IotSerializerDecodeInterface_t * pDecoder,
+                                       IotSerializerDecoderObject_t * pObject,
+                                       const char * pPath,
+                                       IotSerializerDecoderObject_t * pValue )
+{
+    IotSerializerDecoderObject_t container = *pObject;
+    IotSerializerError_t error = IOT_SERIALIZER_SUCCESS;
+    char key[ _MAX_KEY_LENGTH + 1 ];
+    const char * pKeyEnd = NULL;
+    size_t keyLength = 0;
+
+    while( error == IOT_SERIALIZER_SUCCESS )
+    {
+        pKeyEnd = strchr( pPath, '.' );
+        keyLength = ( pKeyEnd != NULL ) ? ( size_t ) ( pKeyEnd - pPath ) : strlen( pPath );
+        TEST_ASSERT_LESS_OR_EQUAL( _MAX_KEY_LENGTH, keyLength );
+
+        memcpy( key, pPath, keyLength );
+        key[ keyLength ] = '\0';
+
+        error = pDecoder->find( &container, key, pValue );
+
+        /* Destroy the containers found on the way, but not the one passed in. */
+        if( container.u.pHandle != pObject->u.pHandle )
+        {
+            pDecoder->destroy( &container );
+        }
+
+        if( pKeyEnd == NULL )
+        {
+            break;
+        }
+
+        container = *pValue;
+        pPath = pKeyEnd + 1;
+    }
+
+    return error;
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Check that both decoders find the same values for the key paths.
+ */
+static void _checkTapeFindsSameValues( const uint8_t * pDocument,
+                                       size_t length,
+                                       const char * const * pKeyPaths,
+                                       size_t keyPathCount )
+{
+    IotSerializerDecoderObject_t root = IOT_SERIALIZER_DECODER_OBJECT_INITIALIZER;
+    IotSerializerDecoderObject_t tapeRoot = IOT_SERIALIZER_DECODER_OBJECT_INITIALIZER;
+    IotSerializerDecoderObject_t value = IOT_SERIALIZER_DECODER_OBJECT_INITIALIZER;
+    IotSerializerDecoderObject_t tapeValue = IOT_SERIALIZER_DECODER_OBJECT_INITIALIZER;
+    size_t i = 0;
+
+    TEST_ASSERT_EQUAL( IOT_SERIALIZER_SUCCESS, _decoder.init( &root, pDocument, length ) );
+    TEST_ASSERT_EQUAL( IOT_SERIALIZER_SUCCESS, _tapeDecoder.init( &tapeRoot, pDocument, length ) );
+
+    for( i = 0; i < keyPathCount; i++ )
+    {
+        TEST_ASSERT_EQUAL( IOT_SERIALIZER_SUCCESS, _findPath( &_decoder, &root, pKeyPaths[ i ], &value ) );
+        TEST_ASSERT_EQUAL( IOT_SERIALIZER_SUCCESS, _findPath( &_tapeDecoder, &tapeRoot, pKeyPaths[ i ], &tapeValue ) );
+        TEST_ASSERT_EQUAL( value.type, tapeValue.type );
+
+        switch( value.type )
+        {
+            case IOT_SERIALIZER_SCALAR_TEXT_STRING:
+                TEST_ASSERT_EQUAL_PTR( value.u.value.u.string.pString, tapeValue.u.value.u.string.pString );
+                TEST_ASSERT_EQUAL( value.u.value.u.string.length, tapeValue.u.value.u.string.length );
+                break;
+
+            case IOT_SERIALIZER_SCALAR_SIGNED_INT:
+                TEST_ASSERT_EQUAL( value.u.value.u.signedInt, tapeValue.u.value.u.signedInt );
+                break;
+
+            default:
+                break;
+        }
+
+        _decoder.destroy( &value );
+        _tapeDecoder.destroy( &tapeValue );
+    }
+
+    _decoder.destroy( &root );
+    _tapeDecoder.destroy( &tapeRoot );
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Check the value a query found for a key.
+ */
+static void _checkQueryResult( const IotJsonQueryResult_t * pResult,
+                               const char * pExpectedValue )
+{
+    TEST_ASSERT_EQUAL( 1, pResult->count );
+    TEST_ASSERT_EQUAL( strlen( pExpectedValue ), pResult->valueLength );
+    TEST_ASSERT_EQUAL_STRING_LEN( pExpectedValue, pResult->pValue, pResult->valueLength );
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief A step of a benchmark, run once per iteration by #_timeIterations.
+ */
+typedef void (* _benchmarkStep_t)( void * pArgument );
+
+/**
+ * @brief The key paths to look up in a document with a decoder.
+ */
+typedef struct _keyLookups
+{
+    const IotSerializerDecodeInterface_t * pDecoder;
+    const uint8_t * pDocument;
+    size_t length;
+    const char * const * pKeyPaths;
+    size_t keyPathCount;
+} _keyLookups_t;
+
+/**
+ * @brief A query to run on a document.
+ */
+typedef struct _query
+{
+    const uint8_t * pDocument;
+    size_t length;
+    const IotJsonQueryKey_t * pQuery;
+    size_t queryLength;
+} _query_t;
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Run a benchmark step a number of times. Returns the time taken in
+ * milliseconds.
+ */
+static uint64_t _timeIterations( _benchmarkStep_t step,
+                                 void * pArgument,
+                                 uint32_t iterations )
+{
+    uint64_t startTime = IotClock_GetTimeMs();
+    uint32_t iteration = 0;
+
+    for( iteration = 0; iteration < iterations; iteration++ )
+    {
+        step( pArgument );
+    }
+
+    return IotClock_GetTimeMs() - startTime;
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Decode a document and look up all its key paths.
+ */
+static void _lookUpKeyPaths( void * pArgument )
+{
+    const _keyLookups_t * pLookups = pArgument;
+    IotSerializerDecoderObject_t root = IOT_SERIALIZER_DECODER_OBJECT_INITIALIZER;
+    IotSerializerDecoderObject_t value = IOT_SERIALIZER_DECODER_OBJECT_INITIALIZER;
+    size_t i = 0;
+
+    TEST_ASSERT_EQUAL( IOT_SERIALIZER_SUCCESS, pLookups->pDecoder->init( &root, pLookups->pDocument, pLookups->length ) );
+
+    for( i = 0; i < pLookups->keyPathCount; i++ )
+    {
+        TEST_ASSERT_EQUAL( IOT_SERIALIZER_SUCCESS, _findPath( pLookups->pDecoder, &root, pLookups->pKeyPaths[ i ], &value ) );
+        pLookups->pDecoder->destroy( &value );
+    }
+
+    pLookups->pDecoder->destroy( &root );
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Run a query on a document.
+ */
+static void _runQuery( void * pArgument )
+{
+    const _query_t * pQuery = pArgument;
+    IotJsonQueryResult_t results[ sizeof( shadow_query ) / sizeof( shadow_query[ 0 ] ) ];
+
+    TEST_ASSERT_LESS_OR_EQUAL( sizeof( results ) / sizeof( results[ 0 ] ), pQuery->queryLength );
+    TEST_ASSERT_TRUE( IotJsonUtils_Query( ( const char * ) pQuery->pDocument, pQuery->length,
+                                          pQuery->pQuery, pQuery->queryLength, results ) );
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Time decoding a document and looking up all its key paths the number
+ * of times of the benchmark. Returns the time taken in milliseconds.
+ */
+static uint64_t _timeKeyLookups( const IotSerializerDecodeInterface_t * pDecoder,
+                                 const uint8_t * pDocument,
+                                 size_t length,
+                                 const char * const * pKeyPaths,
+                                 size_t keyPathCount )
+{
+    _keyLookups_t lookups = { pDecoder, pDocument, length, pKeyPaths, keyPathCount };
+
+    return _timeIterations( _lookUpKeyPaths, &lookups, _TAPE_BENCHMARK_ITERATIONS );
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Time running a query on a document.
+ */
+static uint64_t _timeQueries( const uint8_t * pDocument,
+                              size_t length,
+                              const IotJsonQueryKey_t * pQuery,
+                              size_t queryLength )
+{
+    _query_t query = { pDocument, length, pQuery, queryLength };
+
+    return _timeIterations( _runQuery, &query, _TAPE_BENCHMARK_ITERATIONS );
+}
+
 TEST_GROUP( Serializer_Unit_JSON_deserialize );
 
 TEST_SETUP( Serializer_Unit_JSON_deserialize )
@@ -70,12 +405,190 @@ TEST_TEAR_DOWN( Serializer_Unit_JSON_deserialize )
                       childObject.u.pHandle == NULL );
 }
 
+/**
+ * @brief Classify a character one comparison at a time, for checking the scanner.
+ */
+static uint8_t _characterClass( char character )
+{
+    switch( character )
+    {
+        case '\"':
+            return IOT_JSON_QUOTE;
+
+        case '\\':
+            return IOT_JSON_BACKSLASH;
+
+        case '{':
+        case '}':
+        case '[':
+        case ']':
+            return IOT_JSON_STRUCTURAL;
+
+        case ':':
+        case ',':
+            return IOT_JSON_DELIMITER;
+
+        case ' ':
+        case '\t':
+        case '\r':
+        case '\n':
+            return IOT_JSON_WHITESPACE;
+
+        default:
+            return 0;
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Offset of the first character whose class match is not equal to `skip`.
+ */
+static size_t _scanOneAtATime( const char * pBuffer,
+                               size_t length,
+                               uint8_t classes,
+                               bool skip )
+{
+    size_t i = 0;
+
+    for( i = 0; i < length; i++ )
+    {
+        if( ( ( _characterClass( pBuffer[ i ] ) & classes ) != 0 ) != skip )
+        {
+            break;
+        }
+    }
+
+    return i;
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief A walk of a document from one quote or backslash to the next.
+ */
+typedef struct _stringScan
+{
+    const uint8_t * pDocument;
+    size_t length;
+    bool useScanner;
+    uint32_t stops; /**< @brief Number of characters the walk stopped at. */
+} _stringScan_t;
+
+/**
+ * @brief A search for a key in a document.
+ */
+typedef struct _keySearch
+{
+    const uint8_t * pDocument;
+    size_t length;
+    const char * pKey;
+    const char * pValue;
+    size_t valueLength;
+} _keySearch_t;
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Compute the throughput of a benchmark in hundredths of a MB/s. A time
+ * below the resolution of the clock counts as 1 ms.
+ */
+static uint32_t _throughput( size_t length,
+                             uint32_t iterations,
+                             uint64_t timeMs )
+{
+    uint64_t totalLength = ( uint64_t ) length * iterations;
+
+    if( timeMs == 0U )
+    {
+        timeMs = 1U;
+    }
+
+    /* Bytes per millisecond are thousandths of a MB/s. */
+    return ( uint32_t ) ( totalLength / ( timeMs * 10U ) );
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Walk a document from one quote or backslash to the next, as the string
+ * parsers do.
+ */
+static void _scanStrings( void * pArgument )
+{
+    _stringScan_t * pScan = pArgument;
+    const char * pCharacters = ( const char * ) pScan->pDocument;
+    size_t offset = 0;
+
+    pScan->stops = 0;
+
+    for( offset = 0; offset < pScan->length; offset++ )
+    {
+        if( pScan->useScanner == true )
+        {
+            offset += IotJsonUtils_ScanFor( pCharacters + offset, pScan->length - offset,
+                                            IOT_JSON_QUOTE | IOT_JSON_BACKSLASH );
+        }
+        else
+        {
+            offset += _scanOneAtATime( pCharacters + offset, pScan->length - offset,
+                                       IOT_JSON_QUOTE | IOT_JSON_BACKSLASH, false );
+        }
+
+        pScan->stops++;
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Search a document for a key.
+ */
+static void _searchKey( void * pArgument )
+{
+    _keySearch_t * pSearch = pArgument;
+
+    TEST_ASSERT_TRUE( IotJsonUtils_FindJsonValue( ( const char * ) pSearch->pDocument, pSearch->length,
+                                                  pSearch->pKey, strlen( pSearch->pKey ),
+                                                  &( pSearch->pValue ), &( pSearch->valueLength ) ) );
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Time walking a document from one quote or backslash to the next.
+ */
+static uint64_t _timeStringScans( const uint8_t * pDocument,
+                                  size_t length,
+                                  bool useScanner,
+                                  uint32_t * pStops )
+{
+    _stringScan_t scan = { pDocument, length, useScanner, 0 };
+    uint64_t time = _timeIterations( _scanStrings, &scan, _SCAN_BENCHMARK_ITERATIONS );
+
+    *pStops = scan.stops;
+
+    return time;
+}
+
+/*-----------------------------------------------------------*/
+
 TEST_GROUP_RUNNER( Serializer_Unit_JSON_deserialize )
 {
     RUN_TEST_CASE( Serializer_Unit_JSON_deserialize, find_key_string_value );
     RUN_TEST_CASE( Serializer_Unit_JSON_deserialize, find_key_object_value );
     RUN_TEST_CASE( Serializer_Unit_JSON_deserialize, find_key_array_of_objects_value );
     RUN_TEST_CASE( Serializer_Unit_JSON_deserialize, find_nested_key_array_of_objects_value );
+    RUN_TEST_CASE( Serializer_Unit_JSON_deserialize, tape_find_same_values );
+    RUN_TEST_CASE( Serializer_Unit_JSON_deserialize, tape_iterate_array_of_objects );
+    RUN_TEST_CASE( Serializer_Unit_JSON_deserialize, tape_container_outlives_root );
+    RUN_TEST_CASE( Serializer_Unit_JSON_deserialize, scan_matches_character_loop );
+    RUN_TEST_CASE( Serializer_Unit_JSON_deserialize, find_json_value_escaped_strings );
+    RUN_TEST_CASE( Serializer_Unit_JSON_deserialize, query_key_paths );
+    RUN_TEST_CASE( Serializer_Unit_JSON_deserialize, query_array_of_objects );
+    RUN_TEST_CASE( Serializer_Unit_JSON_deserialize, query_duplicates_and_missing_keys );
+    RUN_TEST_CASE( Serializer_Unit_JSON_deserialize, query_invalid_documents );
+    RUN_TEST_CASE( Serializer_Unit_JSON_deserialize, next_object_member );
 }
 
 TEST( Serializer_Unit_JSON_deserialize, find_key_string_value )
@@ -121,3 +634,455 @@ TEST( Serializer_Unit_JSON_deserialize, find_nested_key_array_of_objects_value )
 
     _decoder.destroy( &nestedObject );
 }
+
+TEST( Serializer_Unit_JSON_deserialize, tape_find_same_values )
+{
+    static const char * const test_data_key_paths[] =
+    {
+        "name",
+        "number",
+        "returns.type",
+        "parameters",
+        "related.id",
+        "related.types"
+    };
+
+    _checkTapeFindsSameValues( test_data, test_data_length,
+                               test_data_key_paths, sizeof( test_data_key_paths ) / sizeof( test_data_key_paths[ 0 ] ) );
+    _checkTapeFindsSameValues( shadow_document, sizeof( shadow_document ),
+                               shadow_key_paths, sizeof( shadow_key_paths ) / sizeof( shadow_key_paths[ 0 ] ) );
+    _checkTapeFindsSameValues( jobs_document, sizeof( jobs_document ),
+                               jobs_key_paths, sizeof( jobs_key_paths ) / sizeof( jobs_key_paths[ 0 ] ) );
+}
+
+TEST( Serializer_Unit_JSON_deserialize, tape_iterate_array_of_objects )
+{
+    IotSerializerDecoderObject_t tapeRoot = IOT_SERIALIZER_DECODER_OBJECT_INITIALIZER;
+    IotSerializerDecoderObject_t parameters = IOT_SERIALIZER_DECODER_OBJECT_INITIALIZER;
+    IotSerializerDecoderObject_t parameter = IOT_SERIALIZER_DECODER_OBJECT_INITIALIZER;
+    IotSerializerDecoderObject_t index = IOT_SERIALIZER_DECODER_OBJECT_INITIALIZER;
+    IotSerializerDecoderIterator_t iterator = IOT_SERIALIZER_DECODER_ITERATOR_INITIALIZER;
+    int64_t expectedIndex = 1;
+
+    TEST_ASSERT_EQUAL( IOT_SERIALIZER_SUCCESS, _tapeDecoder.init( &tapeRoot, test_data, test_data_length ) );
+    TEST_ASSERT_EQUAL( IOT_SERIALIZER_SUCCESS, _tapeDecoder.find( &tapeRoot, "parameters", &parameters ) );
+    TEST_ASSERT_EQUAL( IOT_SERIALIZER_CONTAINER_ARRAY, parameters.type );
+
+    TEST_ASSERT_EQUAL( IOT_SERIALIZER_SUCCESS, _tapeDecoder.stepIn( &parameters, &iterator ) );
+
+    while( !_tapeDecoder.isEndOfContainer( iterator ) )
+    {
+        TEST_ASSERT_EQUAL( IOT_SERIALIZER_SUCCESS, _tapeDecoder.get( iterator, &parameter ) );
+        TEST_ASSERT_EQUAL( IOT_SERIALIZER_CONTAINER_MAP, parameter.type );
+
+        TEST_ASSERT_EQUAL( IOT_SERIALIZER_SUCCESS, _tapeDecoder.find( &parameter, "index", &index ) );
+        TEST_ASSERT_EQUAL( IOT_SERIALIZER_SCALAR_SIGNED_INT, index.type );
+        TEST_ASSERT_EQUAL( expectedIndex, index.u.value.u.signedInt );
+        _tapeDecoder.destroy( &parameter );
+
+        TEST_ASSERT_EQUAL( IOT_SERIALIZER_SUCCESS, _tapeDecoder.next( iterator ) );
+        expectedIndex++;
+    }
+
+    TEST_ASSERT_EQUAL( 4, expectedIndex );
+    TEST_ASSERT_EQUAL( IOT_SERIALIZER_SUCCESS, _tapeDecoder.stepOut( iterator, &parameters ) );
+
+    _tapeDecoder.destroy( &parameters );
+    _tapeDecoder.destroy( &tapeRoot );
+}
+
+TEST( Serializer_Unit_JSON_deserialize, tape_container_outlives_root )
+{
+    IotSerializerDecoderObject_t tapeRoot = IOT_SERIALIZER_DECODER_OBJECT_INITIALIZER;
+    IotSerializerDecoderObject_t related = IOT_SERIALIZER_DECODER_OBJECT_INITIALIZER;
+    IotSerializerDecoderObject_t id = IOT_SERIALIZER_DECODER_OBJECT_INITIALIZER;
+
+    TEST_ASSERT_EQUAL( IOT_SERIALIZER_SUCCESS, _tapeDecoder.init( &tapeRoot, test_data, test_data_length ) );
+    TEST_ASSERT_EQUAL( IOT_SERIALIZER_SUCCESS, _tapeDecoder.find( &tapeRoot, "related", &related ) );
+
+    /* The tape is shared, so it has to stay until the last container is destroyed. */
+    _tapeDecoder.destroy( &tapeRoot );
+
+    TEST_ASSERT_EQUAL( IOT_SERIALIZER_SUCCESS, _tapeDecoder.find( &related, "id", &id ) );
+    TEST_ASSERT_EQUAL( IOT_SERIALIZER_SCALAR_TEXT_STRING, id.type );
+    TEST_ASSERT_EQUAL( 0, strncmp( ( const char * ) id.u.value.u.string.pString, "ABC123", id.u.value.u.string.length ) );
+    TEST_ASSERT_EQUAL( IOT_SERIALIZER_NOT_FOUND, _tapeDecoder.find( &related, "name", &id ) );
+
+    _tapeDecoder.destroy( &related );
+}
+
+TEST( Serializer_Unit_JSON_deserialize, scan_matches_character_loop )
+{
+    const char * pDocument = ( const char * ) shadow_document;
+    const uint8_t classes[] =
+    {
+        IOT_JSON_QUOTE | IOT_JSON_BACKSLASH,
+        IOT_JSON_STRUCTURAL,
+        IOT_JSON_WHITESPACE | IOT_JSON_DELIMITER,
+        IOT_JSON_WHITESPACE | IOT_JSON_DELIMITER | IOT_JSON_STRUCTURAL
+    };
+    size_t offset = 0, length = 0, i = 0;
+
+    /* Every start offset and length exercises both the block loop and the tail. */
+    for( i = 0; i < sizeof( classes ); i++ )
+    {
+        for( offset = 0; offset < 128; offset++ )
+        {
+            for( length = 0; length < 96; length++ )
+            {
+                TEST_ASSERT_EQUAL( _scanOneAtATime( pDocument + offset, length, classes[ i ], false ),
+                                   IotJsonUtils_ScanFor( pDocument + offset, length, classes[ i ] ) );
+                TEST_ASSERT_EQUAL( _scanOneAtATime( pDocument + offset, length, classes[ i ], true ),
+                                   IotJsonUtils_ScanPast( pDocument + offset, length, classes[ i ] ) );
+            }
+        }
+    }
+
+    /* Characters with the high bit set never match a class. */
+    TEST_ASSERT_EQUAL( 17, IotJsonUtils_ScanFor( "\xc3\xa9\xff\x80\xc3\xa9\xff\x80\xc3\xa9\xff\x80\xc3\xa9\xff\x80\x7f\"", 18,
+                                                 IOT_JSON_QUOTE ) );
+}
+
+/*-----------------------------------------------------------*/
+
+TEST( Serializer_Unit_JSON_deserialize, find_json_value_escaped_strings )
+{
+    const char document[] = "{\"a\":\"x\\\"y\\\\z and a long enough tail\",\"b\":[1,{\"c\":[2]}],\"d\":true}";
+    const char * pValue = NULL;
+    size_t valueLength = 0;
+
+    TEST_ASSERT_TRUE( IotJsonUtils_FindJsonValue( document, sizeof( document ) - 1, "a", 1, &pValue, &valueLength ) );
+    TEST_ASSERT_EQUAL( strlen( "\"x\\\"y\\\\z and a long enough tail\"" ), valueLength );
+    TEST_ASSERT_EQUAL_PTR( document + 5, pValue );
+
+    TEST_ASSERT_TRUE( IotJsonUtils_FindJsonValue( document, sizeof( document ) - 1, "b", 1, &pValue, &valueLength ) );
+    TEST_ASSERT_EQUAL_STRING_LEN( "[1,{\"c\":[2]}]", pValue, valueLength );
+
+    TEST_ASSERT_TRUE( IotJsonUtils_FindJsonValue( document, sizeof( document ) - 1, "d", 1, &pValue, &valueLength ) );
+    TEST_ASSERT_EQUAL_STRING_LEN( "true", pValue, valueLength );
+
+    /* A document that ends inside a value does not match. */
+    TEST_ASSERT_FALSE( IotJsonUtils_FindJsonValue( document, 20, "a", 1, &pValue, &valueLength ) );
+    TEST_ASSERT_FALSE( IotJsonUtils_FindJsonValue( document, 50, "b", 1, &pValue, &valueLength ) );
+}
+
+/*-----------------------------------------------------------*/
+
+TEST( Serializer_Unit_JSON_deserialize, query_key_paths )
+{
+    IotJsonQueryResult_t results[ sizeof( shadow_query ) / sizeof( shadow_query[ 0 ] ) ];
+
+    /* The terminating NULL after the document is ignored. */
+    TEST_ASSERT_TRUE( IotJsonUtils_Query( ( const char * ) shadow_document, sizeof( shadow_document ),
+                                          shadow_query, sizeof( shadow_query ) / sizeof( shadow_query[ 0 ] ), results ) );
+
+    _checkQueryResult( &results[ 1 ], "42" );
+    _checkQueryResult( &results[ 4 ], "20" );
+    _checkQueryResult( &results[ 5 ], "40" );
+    _checkQueryResult( &results[ 6 ], "2" );
+    _checkQueryResult( &results[ 7 ], "\"heat\"" );
+    _checkQueryResult( &results[ 8 ], "{\"powerOn\":true,\"targetTemperature\":21,\"fanSpeed\":2,\"mode\":\"heat\"}" );
+    _checkQueryResult( &results[ 9 ], "21" );
+    _checkQueryResult( &results[ 10 ], "2" );
+    _checkQueryResult( &results[ 13 ], "41" );
+    _checkQueryResult( &results[ 14 ], "1589485550" );
+    _checkQueryResult( &results[ 15 ], "\"thermostat-1589485550\"" );
+
+    /* A container's value runs from its opening to its closing bracket. */
+    TEST_ASSERT_EQUAL( '{', results[ 0 ].pValue[ 0 ] );
+    TEST_ASSERT_EQUAL( '}', results[ 0 ].pValue[ results[ 0 ].valueLength - 1 ] );
+    TEST_ASSERT_EQUAL_PTR( results[ 14 ].pValue - strlen( ",\"timestamp\":" ),
+                           results[ 0 ].pValue + results[ 0 ].valueLength );
+}
+
+/*-----------------------------------------------------------*/
+
+TEST( Serializer_Unit_JSON_deserialize, query_array_of_objects )
+{
+    IotJsonQueryResult_t results[ sizeof( jobs_query ) / sizeof( jobs_query[ 0 ] ) ];
+
+    TEST_ASSERT_TRUE( IotJsonUtils_Query( ( const char * ) jobs_document, sizeof( jobs_document ) - 1,
+                                          jobs_query, sizeof( jobs_query ) / sizeof( jobs_query[ 0 ] ), results ) );
+
+    _checkQueryResult( &results[ 1 ], "\"AFR_OTA-fw-1.3.0\"" );
+    _checkQueryResult( &results[ 2 ], "\"QUEUED\"" );
+    _checkQueryResult( &results[ 5 ], "\"AFR_OTA-7c2f1bd2\"" );
+    _checkQueryResult( &results[ 6 ], "[\"MQTT\",\"HTTP\"]" );
+    _checkQueryResult( &results[ 8 ], "\"firmware.bin\"" );
+    _checkQueryResult( &results[ 9 ], "181584" );
+    _checkQueryResult( &results[ 10 ], "1589485550" );
+
+    /* The array holding the objects is a value too. */
+    TEST_ASSERT_EQUAL( 1, results[ 7 ].count );
+    TEST_ASSERT_EQUAL( '[', results[ 7 ].pValue[ 0 ] );
+    TEST_ASSERT_EQUAL_STRING_LEN( "}]", results[ 7 ].pValue + results[ 7 ].valueLength - 2, 2 );
+}
+
+/*-----------------------------------------------------------*/
+
+TEST( Serializer_Unit_JSON_deserialize, query_duplicates_and_missing_keys )
+{
+    const char document[] = "{ \"b\" : { \"a\" : [ { \"c\" : 1 }, 7, { \"c\" : \"}\\\"\" } ] }, "
+                            "\"a\" : { \"c\" : 3 }, \"a\" : 4, \"d\" : { \"c\" : 5 } }";
+    const IotJsonQueryKey_t query[] =
+    {
+        IOT_JSON_QUERY_KEY( IOT_JSON_QUERY_ROOT, "a" ), /* 0 */
+        IOT_JSON_QUERY_KEY( 0, "c" ),                   /* 1 */
+        IOT_JSON_QUERY_KEY( IOT_JSON_QUERY_ROOT, "b" ), /* 2 */
+        IOT_JSON_QUERY_KEY( 2, "a" ),                   /* 3 */
+        IOT_JSON_QUERY_KEY( 3, "c" ),                   /* 4 */
+        IOT_JSON_QUERY_KEY( 2, "e" )                    /* 5 */
+    };
+    IotJsonQueryResult_t results[ sizeof( query ) / sizeof( query[ 0 ] ) ];
+
+    TEST_ASSERT_TRUE( IotJsonUtils_Query( document, sizeof( document ) - 1,
+                                          query, sizeof( query ) / sizeof( query[ 0 ] ), results ) );
+
+    /* Keys are matched by their whole path; the first value is kept. */
+    TEST_ASSERT_EQUAL( 2, results[ 0 ].count );
+    TEST_ASSERT_EQUAL_STRING_LEN( "{ \"c\" : 3 }", results[ 0 ].pValue, results[ 0 ].valueLength );
+    _checkQueryResult( &results[ 1 ], "3" );
+    _checkQueryResult( &results[ 3 ], "[ { \"c\" : 1 }, 7, { \"c\" : \"}\\\"\" } ]" );
+    TEST_ASSERT_EQUAL( 2, results[ 4 ].count );
+    TEST_ASSERT_EQUAL_STRING_LEN( "1", results[ 4 ].pValue, results[ 4 ].valueLength );
+
+    /* Keys that are not in the document are not found. */
+    TEST_ASSERT_EQUAL( 0, results[ 5 ].count );
+    TEST_ASSERT_NULL( results[ 5 ].pValue );
+}
+
+/*-----------------------------------------------------------*/
+
+TEST( Serializer_Unit_JSON_deserialize, query_invalid_documents )
+{
+    const char * const documents[] =
+    {
+        "",
+        "[1]",
+        "{\"a\":1",
+        "{\"a\":1,}",
+        "{\"a\" 1}",
+        "{\"a\":}",
+        "{\"a\":1 \"b\":2}",
+        "{a:1}",
+        "{\"b\":{\"x\":\"}\"}",
+        "{\"b\":{\"a\":[1,]}}",
+        "{\"b\":{\"a\":\"\\\"}}"
+    };
+    const IotJsonQueryKey_t query[] =
+    {
+        IOT_JSON_QUERY_KEY( IOT_JSON_QUERY_ROOT, "b" ),
+        IOT_JSON_QUERY_KEY( 0, "a" ),
+        IOT_JSON_QUERY_KEY( 1, "c" )
+    };
+    const IotJsonQueryKey_t deepQuery[] =
+    {
+        IOT_JSON_QUERY_KEY( IOT_JSON_QUERY_ROOT, "a" ),
+        IOT_JSON_QUERY_KEY( 0, "a" ),
+        IOT_JSON_QUERY_KEY( 1, "a" ),
+        IOT_JSON_QUERY_KEY( 2, "a" ),
+        IOT_JSON_QUERY_KEY( 3, "a" ),
+        IOT_JSON_QUERY_KEY( 4, "a" ),
+        IOT_JSON_QUERY_KEY( 5, "a" ),
+        IOT_JSON_QUERY_KEY( 6, "a" ),
+        IOT_JSON_QUERY_KEY( 7, "a" )
+    };
+    const char deepDocument[] = "{\"a\":{\"a\":{\"a\":{\"a\":{\"a\":{\"a\":{\"a\":{\"a\":{\"a\":1}}}}}}}}}";
+    IotJsonQueryResult_t results[ sizeof( jobs_query ) / sizeof( jobs_query[ 0 ] ) ];
+    size_t i = 0;
+
+    TEST_ASSERT_LESS_OR_EQUAL( sizeof( results ) / sizeof( results[ 0 ] ), sizeof( deepQuery ) / sizeof( deepQuery[ 0 ] ) );
+
+    for( i = 0; i < sizeof( documents ) / sizeof( documents[ 0 ] ); i++ )
+    {
+        TEST_ASSERT_FALSE( IotJsonUtils_Query( documents[ i ], strlen( documents[ i ] ),
+                                               query, sizeof( query ) / sizeof( query[ 0 ] ), results ) );
+    }
+
+    /* Every truncation of a valid document is rejected. */
+    for( i = 0; i < sizeof( jobs_document ) - 1; i++ )
+    {
+        TEST_ASSERT_FALSE( IotJsonUtils_Query( ( const char * ) jobs_document, i,
+                                               jobs_query, sizeof( jobs_query ) / sizeof( jobs_query[ 0 ] ), results ) );
+    }
+
+    /* Only the containers on the paths of the query count towards the depth. */
+    TEST_ASSERT_TRUE( IotJsonUtils_Query( deepDocument, sizeof( deepDocument ) - 1, query, 1, results ) );
+    TEST_ASSERT_TRUE( IotJsonUtils_Query( deepDocument, sizeof( deepDocument ) - 1, deepQuery, 8, results ) );
+    TEST_ASSERT_FALSE( IotJsonUtils_Query( deepDocument, sizeof( deepDocument ) - 1,
+                                           deepQuery, sizeof( deepQuery ) / sizeof( deepQuery[ 0 ] ), results ) );
+}
+
+/*-----------------------------------------------------------*/
+
+TEST( Serializer_Unit_JSON_deserialize, next_object_member )
+{
+    const char object[] = " { \"a\" : 1 , \"b\\\"\":{\"c\":[2,{}]},\"d\":\"}\" } ";
+    const char * pKey = NULL, * pValue = NULL;
+    size_t keyLength = 0, valueLength = 0, offset = 0;
+
+    TEST_ASSERT_TRUE( IotJsonUtils_NextObjectMember( object, sizeof( object ) - 1, &offset,
+                                                     &pKey, &keyLength, &pValue, &valueLength ) );
+    TEST_ASSERT_EQUAL_STRING_LEN( "a", pKey, keyLength );
+    TEST_ASSERT_EQUAL_STRING_LEN( "1", pValue, valueLength );
+
+    TEST_ASSERT_TRUE( IotJsonUtils_NextObjectMember( object, sizeof( object ) - 1, &offset,
+                                                     &pKey, &keyLength, &pValue, &valueLength ) );
+    TEST_ASSERT_EQUAL_STRING_LEN( "b\\\"", pKey, keyLength );
+    TEST_ASSERT_EQUAL_STRING_LEN( "{\"c\":[2,{}]}", pValue, valueLength );
+
+    TEST_ASSERT_TRUE( IotJsonUtils_NextObjectMember( object, sizeof( object ) - 1, &offset,
+                                                     &pKey, &keyLength, &pValue, &valueLength ) );
+    TEST_ASSERT_EQUAL_STRING_LEN( "d", pKey, keyLength );
+    TEST_ASSERT_EQUAL_STRING_LEN( "\"}\"", pValue, valueLength );
+
+    /* The end of the object. */
+    TEST_ASSERT_FALSE( IotJsonUtils_NextObjectMember( object, sizeof( object ) - 1, &offset,
+                                                      &pKey, &keyLength, &pValue, &valueLength ) );
+
+    /* Empty objects, values that are not objects, and invalid members. */
+    offset = 0;
+    TEST_ASSERT_FALSE( IotJsonUtils_NextObjectMember( "{}", 2, &offset, &pKey, &keyLength, &pValue, &valueLength ) );
+    offset = 0;
+    TEST_ASSERT_FALSE( IotJsonUtils_NextObjectMember( "[1]", 3, &offset, &pKey, &keyLength, &pValue, &valueLength ) );
+    offset = 0;
+    TEST_ASSERT_FALSE( IotJsonUtils_NextObjectMember( "{\"a\" 1}", 7, &offset, &pKey, &keyLength, &pValue, &valueLength ) );
+    offset = 0;
+    TEST_ASSERT_FALSE( IotJsonUtils_NextObjectMember( "{\"a\":[1", 7, &offset, &pKey, &keyLength, &pValue, &valueLength ) );
+}
+
+/*-----------------------------------------------------------*/
+
+TEST_GROUP( Serializer_Benchmark_JSON_deserialize );
+
+TEST_SETUP( Serializer_Benchmark_JSON_deserialize )
+{
+}
+
+TEST_TEAR_DOWN( Serializer_Benchmark_JSON_deserialize )
+{
+}
+
+/*-----------------------------------------------------------*/
+
+/*
+ * The benchmarks only log their timings, so they are kept out of the unit tests.
+ * The test runner runs them when testrunnerFULL_SERIALIZER_BENCHMARK_ENABLED is 1.
+ */
+TEST_GROUP_RUNNER( Serializer_Benchmark_JSON_deserialize )
+{
+    RUN_TEST_CASE( Serializer_Benchmark_JSON_deserialize, tape_benchmark );
+    RUN_TEST_CASE( Serializer_Benchmark_JSON_deserialize, scan_benchmark );
+    RUN_TEST_CASE( Serializer_Benchmark_JSON_deserialize, query_benchmark );
+}
+
+/*-----------------------------------------------------------*/
+
+TEST( Serializer_Benchmark_JSON_deserialize, tape_benchmark )
+{
+    uint64_t shadowTime = 0, shadowTapeTime = 0, jobsTime = 0, jobsTapeTime = 0;
+
+    shadowTime = _timeKeyLookups( &_decoder, shadow_document, sizeof( shadow_document ),
+                                  shadow_key_paths, sizeof( shadow_key_paths ) / sizeof( shadow_key_paths[ 0 ] ) );
+    shadowTapeTime = _timeKeyLookups( &_tapeDecoder, shadow_document, sizeof( shadow_document ),
+                                      shadow_key_paths, sizeof( shadow_key_paths ) / sizeof( shadow_key_paths[ 0 ] ) );
+    jobsTime = _timeKeyLookups( &_decoder, jobs_document, sizeof( jobs_document ),
+                                jobs_key_paths, sizeof( jobs_key_paths ) / sizeof( jobs_key_paths[ 0 ] ) );
+    jobsTapeTime = _timeKeyLookups( &_tapeDecoder, jobs_document, sizeof( jobs_document ),
+                                    jobs_key_paths, sizeof( jobs_key_paths ) / sizeof( jobs_key_paths[ 0 ] ) );
+
+    IotLogInfo( "%lu decodes of a %lu byte Shadow document: %lu ms, %lu ms with the tape decoder.",
+                ( unsigned long ) _TAPE_BENCHMARK_ITERATIONS,
+                ( unsigned long ) sizeof( shadow_document ),
+                ( unsigned long ) shadowTime,
+                ( unsigned long ) shadowTapeTime );
+    IotLogInfo( "%lu decodes of a %lu byte job document: %lu ms, %lu ms with the tape decoder.",
+                ( unsigned long ) _TAPE_BENCHMARK_ITERATIONS,
+                ( unsigned long ) sizeof( jobs_document ),
+                ( unsigned long ) jobsTime,
+                ( unsigned long ) jobsTapeTime );
+}
+
+/*-----------------------------------------------------------*/
+
+TEST( Serializer_Benchmark_JSON_deserialize, scan_benchmark )
+{
+    uint64_t shadowLoopTime = 0, shadowScanTime = 0, jobsLoopTime = 0, jobsScanTime = 0, findTime = 0;
+    uint32_t loopStops = 0, scanStops = 0, loopThroughput = 0, scanThroughput = 0, findThroughput = 0;
+    _keySearch_t search = { shadow_document, sizeof( shadow_document ) - 1, "clientToken", NULL, 0 };
+
+    /* Both walks must stop at the same characters. */
+    shadowLoopTime = _timeStringScans( shadow_document, sizeof( shadow_document ), false, &loopStops );
+    shadowScanTime = _timeStringScans( shadow_document, sizeof( shadow_document ), true, &scanStops );
+    TEST_ASSERT_EQUAL( loopStops, scanStops );
+
+    jobsLoopTime = _timeStringScans( jobs_document, sizeof( jobs_document ), false, &loopStops );
+    jobsScanTime = _timeStringScans( jobs_document, sizeof( jobs_document ), true, &scanStops );
+    TEST_ASSERT_EQUAL( loopStops, scanStops );
+
+    /* The last key of the Shadow document is found after skipping every value before it. */
+    findTime = _timeIterations( _searchKey, &search, _SCAN_BENCHMARK_ITERATIONS );
+    TEST_ASSERT_EQUAL_STRING_LEN( "\"thermostat-1589485550\"", search.pValue, search.valueLength );
+
+    loopThroughput = _throughput( sizeof( shadow_document ), _SCAN_BENCHMARK_ITERATIONS, shadowLoopTime );
+    scanThroughput = _throughput( sizeof( shadow_document ), _SCAN_BENCHMARK_ITERATIONS, shadowScanTime );
+    IotLogInfo( "%lu string scans of a %lu byte Shadow document: %lu ms (%lu.%02lu MB/s) one character at a time, "
+                "%lu ms (%lu.%02lu MB/s) with IotJsonUtils_ScanFor.",
+                ( unsigned long ) _SCAN_BENCHMARK_ITERATIONS,
+                ( unsigned long ) sizeof( shadow_document ),
+                ( unsigned long ) shadowLoopTime,
+                ( unsigned long ) ( loopThroughput / 100U ),
+                ( unsigned long ) ( loopThroughput % 100U ),
+                ( unsigned long ) shadowScanTime,
+                ( unsigned long ) ( scanThroughput / 100U ),
+                ( unsigned long ) ( scanThroughput % 100U ) );
+
+    loopThroughput = _throughput( sizeof( jobs_document ), _SCAN_BENCHMARK_ITERATIONS, jobsLoopTime );
+    scanThroughput = _throughput( sizeof( jobs_document ), _SCAN_BENCHMARK_ITERATIONS, jobsScanTime );
+    IotLogInfo( "%lu string scans of a %lu byte job document: %lu ms (%lu.%02lu MB/s) one character at a time, "
+                "%lu ms (%lu.%02lu MB/s) with IotJsonUtils_ScanFor.",
+                ( unsigned long ) _SCAN_BENCHMARK_ITERATIONS,
+                ( unsigned long ) sizeof( jobs_document ),
+                ( unsigned long ) jobsLoopTime,
+                ( unsigned long ) ( loopThroughput / 100U ),
+                ( unsigned long ) ( loopThroughput % 100U ),
+                ( unsigned long ) jobsScanTime,
+                ( unsigned long ) ( scanThroughput / 100U ),
+                ( unsigned long ) ( scanThroughput % 100U ) );
+
+    findThroughput = _throughput( search.length, _SCAN_BENCHMARK_ITERATIONS, findTime );
+    IotLogInfo( "%lu searches for the last key of the Shadow document: %lu ms (%lu.%02lu MB/s).",
+                ( unsigned long ) _SCAN_BENCHMARK_ITERATIONS,
+                ( unsigned long ) findTime,
+                ( unsigned long ) ( findThroughput / 100U ),
+                ( unsigned long ) ( findThroughput % 100U ) );
+}
+
+/*-----------------------------------------------------------*/
+
+TEST( Serializer_Benchmark_JSON_deserialize, query_benchmark )
+{
+    uint64_t shadowTapeTime = 0, shadowQueryTime = 0, jobsTapeTime = 0, jobsQueryTime = 0;
+
+    shadowTapeTime = _timeKeyLookups( &_tapeDecoder, shadow_document, sizeof( shadow_document ),
+                                      shadow_key_paths, sizeof( shadow_key_paths ) / sizeof( shadow_key_paths[ 0 ] ) );
+    shadowQueryTime = _timeQueries( shadow_document, sizeof( shadow_document ),
+                                    shadow_query, sizeof( shadow_query ) / sizeof( shadow_query[ 0 ] ) );
+    jobsTapeTime = _timeKeyLookups( &_tapeDecoder, jobs_document, sizeof( jobs_document ),
+                                    jobs_key_paths, sizeof( jobs_key_paths ) / sizeof( jobs_key_paths[ 0 ] ) );
+    jobsQueryTime = _timeQueries( jobs_document, sizeof( jobs_document ),
+                                  jobs_query, sizeof( jobs_query ) / sizeof( jobs_query[ 0 ] ) );
+
+    IotLogInfo( "%lu lookups of %lu key paths in a %lu byte Shadow document: %lu ms with the tape decoder, %lu ms with a query.",
+                ( unsigned long ) _TAPE_BENCHMARK_ITERATIONS,
+                ( unsigned long ) ( sizeof( shadow_key_paths ) / sizeof( shadow_key_paths[ 0 ] ) ),
+                ( unsigned long ) sizeof( shadow_document ),
+                ( unsigned long ) shadowTapeTime,
+                ( unsigned long ) shadowQueryTime );
+    IotLogInfo( "%lu lookups of %lu key paths in a %lu byte job document: %lu ms with the tape decoder, %lu ms with a query.",
+                ( unsigned long ) _TAPE_BENCHMARK_ITERATIONS,
+                ( unsigned long ) ( sizeof( jobs_key_paths ) / sizeof( jobs_key_paths[ 0 ] ) ),
+                ( unsigned long ) sizeof( jobs_document ),
+                ( unsigned long ) jobsTapeTime,
+                ( unsigned long ) jobsQueryTime );
+}
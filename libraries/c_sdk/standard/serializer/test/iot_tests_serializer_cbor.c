@@ -48,6 +48,89 @@ static IotSerializerDecoderObject_t _decoderObject;
 
 uint8_t _buffer[ _BUFFER_SIZE ];
 
+#define _STREAM_WINDOW_SIZE    32
+
+/* Data passed to the flush callback of a streaming encoder. */
+typedef struct _streamOutput
+{
+    uint8_t data[ _BUFFER_SIZE ];
+    size_t length;
+    bool accept;
+} _streamOutput_t;
+
+/*-----------------------------------------------------------*/
+
+static bool _collectFlushedData( void * pFlushContext,
+                                 const uint8_t * pData,
+                                 size_t dataLength )
+{
+    _streamOutput_t * pOutput = ( _streamOutput_t * ) pFlushContext;
+
+    TEST_ASSERT_TRUE( dataLength > 0 );
+    TEST_ASSERT_TRUE( pOutput->length + dataLength <= sizeof( pOutput->data ) );
+
+    if( pOutput->accept == true )
+    {
+        memcpy( pOutput->data + pOutput->length, pData, dataLength );
+        pOutput->length += dataLength;
+    }
+
+    return pOutput->accept;
+}
+
+/*-----------------------------------------------------------*/
+
+/* Encode a document with nested containers and every scalar type. */
+static void _encodeTestDocument( IotSerializerEncoderObject_t * pEncoderObject )
+{
+    IotSerializerEncoderObject_t mapObject = IOT_SERIALIZER_ENCODER_CONTAINER_INITIALIZER_MAP;
+    IotSerializerEncoderObject_t arrayObject = IOT_SERIALIZER_ENCODER_CONTAINER_INITIALIZER_ARRAY;
+    IotSerializerEncoderObject_t flagsObject = IOT_SERIALIZER_ENCODER_CONTAINER_INITIALIZER_MAP;
+    IotSerializerScalarData_t boolData = { .value = { .u.booleanValue = true }, .type = IOT_SERIALIZER_SCALAR_BOOL };
+    IotSerializerScalarData_t nullData = { .type = IOT_SERIALIZER_SCALAR_NULL };
+    uint8_t bytes[] = { 0x01, 0x02, 0xfe };
+    int64_t numberArray[] = { 21, -3, 1589 };
+    uint8_t i = 0;
+
+    TEST_ASSERT_EQUAL( IOT_SERIALIZER_SUCCESS,
+                       _encoder.openContainer( pEncoderObject, &mapObject, 4 ) );
+
+    TEST_ASSERT_EQUAL( IOT_SERIALIZER_SUCCESS,
+                       _encoder.appendKeyValue( &mapObject, "device", IotSerializer_ScalarTextString( "sensor-1" ) ) );
+
+    TEST_ASSERT_EQUAL( IOT_SERIALIZER_SUCCESS,
+                       _encoder.openContainerWithKey( &mapObject, "readings", &arrayObject, 3 ) );
+
+    for( i = 0; i < 3; i++ )
+    {
+        TEST_ASSERT_EQUAL( IOT_SERIALIZER_SUCCESS,
+                           _encoder.append( &arrayObject, IotSerializer_ScalarSignedInt( numberArray[ i ] ) ) );
+    }
+
+    TEST_ASSERT_EQUAL( IOT_SERIALIZER_SUCCESS,
+                       _encoder.closeContainer( &mapObject, &arrayObject ) );
+
+    TEST_ASSERT_EQUAL( IOT_SERIALIZER_SUCCESS,
+                       _encoder.openContainerWithKey( &mapObject, "flags", &flagsObject, 2 ) );
+
+    TEST_ASSERT_EQUAL( IOT_SERIALIZER_SUCCESS,
+                       _encoder.appendKeyValue( &flagsObject, "on", boolData ) );
+
+    TEST_ASSERT_EQUAL( IOT_SERIALIZER_SUCCESS,
+                       _encoder.appendKeyValue( &flagsObject, "error", nullData ) );
+
+    TEST_ASSERT_EQUAL( IOT_SERIALIZER_SUCCESS,
+                       _encoder.closeContainer( &mapObject, &flagsObject ) );
+
+    TEST_ASSERT_EQUAL( IOT_SERIALIZER_SUCCESS,
+                       _encoder.appendKeyValue( &mapObject, "key", IotSerializer_ScalarByteString( bytes, sizeof( bytes ) ) ) );
+
+    TEST_ASSERT_EQUAL( IOT_SERIALIZER_SUCCESS,
+                       _encoder.closeContainer( pEncoderObject, &mapObject ) );
+}
+
+/*-----------------------------------------------------------*/
+
 TEST_GROUP( Serializer_Unit_CBOR );
 
 TEST_SETUP( Serializer_Unit_CBOR )
@@ -86,6 +169,11 @@ TEST_GROUP_RUNNER( Serializer_Unit_CBOR )
 
     RUN_TEST_CASE( Serializer_Unit_CBOR, Encoder_map_nest_map );
     RUN_TEST_CASE( Serializer_Unit_CBOR, Encoder_map_nest_array );
+
+    RUN_TEST_CASE( Serializer_Unit_CBOR, Encoder_stream_matches_buffer );
+    RUN_TEST_CASE( Serializer_Unit_CBOR, Encoder_stream_value_larger_than_window );
+    RUN_TEST_CASE( Serializer_Unit_CBOR, Encoder_stream_flush_failure );
+    RUN_TEST_CASE( Serializer_Unit_CBOR, Encoder_stream_flush_failure_nested );
 }
 
 TEST( Serializer_Unit_CBOR, Encoder_init_with_null_buffer )
@@ -383,6 +471,208 @@ TEST( Serializer_Unit_CBOR, Encoder_map_nest_array )
     TEST_ASSERT_TRUE( cbor_value_at_end( &arrayElement ) );
 }
 
+TEST( Serializer_Unit_CBOR, Encoder_stream_matches_buffer )
+{
+    IotSerializerEncoderObject_t streamObject = IOT_SERIALIZER_ENCODER_CONTAINER_INITIALIZER_STREAM;
+    _streamOutput_t output = { .length = 0, .accept = true };
+    uint8_t window[ _BUFFER_SIZE ];
+    size_t encodedSize = 0, windowSize = 0;
+
+    _encodeTestDocument( &_encoderObject );
+    encodedSize = _encoder.getEncodedSize( &_encoderObject, _buffer );
+
+    /* Every window size from the smallest that holds the largest value up to one
+     * that holds the whole document gives the same data. */
+    for( windowSize = _STREAM_WINDOW_SIZE; windowSize <= encodedSize; windowSize++ )
+    {
+        output.length = 0;
+
+        TEST_ASSERT_EQUAL( IOT_SERIALIZER_SUCCESS,
+                           _encoder.initStream( &streamObject, window, windowSize, _collectFlushedData, &output ) );
+
+        _encodeTestDocument( &streamObject );
+
+        TEST_ASSERT_EQUAL( IOT_SERIALIZER_SUCCESS, _encoder.flush( &streamObject ) );
+        TEST_ASSERT_EQUAL( encodedSize, _encoder.getEncodedSize( &streamObject, window ) );
+
+        _encoder.destroy( &streamObject );
+
+        TEST_ASSERT_EQUAL( encodedSize, output.length );
+        TEST_ASSERT_EQUAL( 0, memcmp( _buffer, output.data, encodedSize ) );
+    }
+}
+
+TEST( Serializer_Unit_CBOR, Encoder_stream_value_larger_than_window )
+{
+    IotSerializerEncoderObject_t streamObject = IOT_SERIALIZER_ENCODER_CONTAINER_INITIALIZER_STREAM;
+    IotSerializerEncoderObject_t mapObject = IOT_SERIALIZER_ENCODER_CONTAINER_INITIALIZER_MAP;
+    _streamOutput_t output = { .length = 0, .accept = true };
+    uint8_t window[ _STREAM_WINDOW_SIZE ];
+
+    TEST_ASSERT_EQUAL( IOT_SERIALIZER_SUCCESS,
+                       _encoder.initStream( &streamObject, window, sizeof( window ), _collectFlushedData, &output ) );
+
+    TEST_ASSERT_EQUAL( IOT_SERIALIZER_SUCCESS,
+                       _encoder.openContainer( &streamObject, &mapObject, 1 ) );
+
+    TEST_ASSERT_EQUAL( IOT_SERIALIZER_BUFFER_TOO_SMALL,
+                       _encoder.appendKeyValue( &mapObject, "key", IotSerializer_ScalarTextString( "a value longer than the window" ) ) );
+
+    _encoder.closeContainer( &streamObject, &mapObject );
+    _encoder.destroy( &streamObject );
+}
+
+TEST( Serializer_Unit_CBOR, Encoder_stream_flush_failure )
+{
+    IotSerializerEncoderObject_t streamObject = IOT_SERIALIZER_ENCODER_CONTAINER_INITIALIZER_STREAM;
+    IotSerializerEncoderObject_t arrayObject = IOT_SERIALIZER_ENCODER_CONTAINER_INITIALIZER_ARRAY;
+    _streamOutput_t output = { .length = 0, .accept = false };
+    uint8_t window[ _STREAM_WINDOW_SIZE ];
+    IotSerializerError_t error = IOT_SERIALIZER_SUCCESS;
+    int64_t i = 0;
+
+    /* Init requires a window and a callback. */
+    TEST_ASSERT_EQUAL( IOT_SERIALIZER_INVALID_INPUT,
+                       _encoder.initStream( &streamObject, window, sizeof( window ), NULL, &output ) );
+    TEST_ASSERT_EQUAL( IOT_SERIALIZER_INVALID_INPUT,
+                       _encoder.initStream( &streamObject, NULL, sizeof( window ), _collectFlushedData, &output ) );
+
+    /* An encoder without a window can not be flushed. */
+    TEST_ASSERT_EQUAL( IOT_SERIALIZER_INVALID_INPUT, _encoder.flush( &_encoderObject ) );
+
+    TEST_ASSERT_EQUAL( IOT_SERIALIZER_SUCCESS,
+                       _encoder.initStream( &streamObject, window, sizeof( window ), _collectFlushedData, &output ) );
+
+    TEST_ASSERT_EQUAL( IOT_SERIALIZER_SUCCESS,
+                       _encoder.openContainer( &streamObject, &arrayObject, _STREAM_WINDOW_SIZE ) );
+
+    /* Append until the window is full and the refused flush is reported. */
+    for( i = 0; i < _STREAM_WINDOW_SIZE; i++ )
+    {
+        error = _encoder.append( &arrayObject, IotSerializer_ScalarSignedInt( i ) );
+
+        if( error != IOT_SERIALIZER_SUCCESS )
+        {
+            break;
+        }
+    }
+
+    TEST_ASSERT_EQUAL( IOT_SERIALIZER_FLUSH_FAILED, error );
+    TEST_ASSERT_EQUAL( 0, output.length );
+
+    /* The refused data is kept for the next flush and the value that was not
+     * appended can be appended again. */
+    output.accept = true;
+
+    for( ; i < _STREAM_WINDOW_SIZE; i++ )
+    {
+        TEST_ASSERT_EQUAL( IOT_SERIALIZER_SUCCESS,
+                           _encoder.append( &arrayObject, IotSerializer_ScalarSignedInt( i ) ) );
+    }
+
+    TEST_ASSERT_EQUAL( IOT_SERIALIZER_SUCCESS,
+                       _encoder.closeContainer( &streamObject, &arrayObject ) );
+
+    TEST_ASSERT_EQUAL( IOT_SERIALIZER_SUCCESS, _encoder.flush( &streamObject ) );
+    TEST_ASSERT_EQUAL( _encoder.getEncodedSize( &streamObject, window ), output.length );
+
+    _encoder.destroy( &streamObject );
+}
+
+TEST( Serializer_Unit_CBOR, Encoder_stream_flush_failure_nested )
+{
+    IotSerializerEncoderObject_t streamObject = IOT_SERIALIZER_ENCODER_CONTAINER_INITIALIZER_STREAM;
+    IotSerializerEncoderObject_t mapObject = IOT_SERIALIZER_ENCODER_CONTAINER_INITIALIZER_MAP;
+    IotSerializerEncoderObject_t arrayObject = IOT_SERIALIZER_ENCODER_CONTAINER_INITIALIZER_ARRAY;
+    IotSerializerEncoderObject_t innerObject = IOT_SERIALIZER_ENCODER_CONTAINER_INITIALIZER_MAP;
+    _streamOutput_t output = { .length = 0, .accept = true };
+    uint8_t window[ _STREAM_WINDOW_SIZE ];
+    IotSerializerError_t error = IOT_SERIALIZER_SUCCESS;
+    size_t emptyCount = 0, i = 0;
+
+    TEST_ASSERT_EQUAL( IOT_SERIALIZER_SUCCESS,
+                       _encoder.initStream( &streamObject, window, sizeof( window ), _collectFlushedData, &output ) );
+
+    TEST_ASSERT_EQUAL( IOT_SERIALIZER_SUCCESS,
+                       _encoder.openContainer( &streamObject, &mapObject, IOT_SERIALIZER_INDEFINITE_LENGTH ) );
+    TEST_ASSERT_EQUAL( IOT_SERIALIZER_SUCCESS,
+                       _encoder.openContainerWithKey( &mapObject, "array", &arrayObject, IOT_SERIALIZER_INDEFINITE_LENGTH ) );
+
+    /* Open empty maps in the array until opening one needs a flush, and refuse it. */
+    output.accept = false;
+
+    while( emptyCount < _STREAM_WINDOW_SIZE )
+    {
+        error = _encoder.openContainer( &arrayObject, &innerObject, 0 );
+
+        if( error != IOT_SERIALIZER_SUCCESS )
+        {
+            break;
+        }
+
+        TEST_ASSERT_EQUAL( IOT_SERIALIZER_SUCCESS,
+                           _encoder.closeContainer( &arrayObject, &innerObject ) );
+        emptyCount++;
+    }
+
+    /* The map that could not be opened has no handle, and every function refuses
+     * it instead of writing through it. */
+    TEST_ASSERT_EQUAL( IOT_SERIALIZER_FLUSH_FAILED, error );
+    TEST_ASSERT_NULL( innerObject.pHandle );
+    TEST_ASSERT_EQUAL( IOT_SERIALIZER_INVALID_INPUT,
+                       _encoder.appendKeyValue( &innerObject, "key", IotSerializer_ScalarSignedInt( 1 ) ) );
+    TEST_ASSERT_EQUAL( IOT_SERIALIZER_INVALID_INPUT,
+                       _encoder.closeContainer( &arrayObject, &innerObject ) );
+    TEST_ASSERT_NOT_NULL( arrayObject.pHandle );
+
+    /* Once the flush is accepted, the map can be opened again, and the data is
+     * the same as that encoded into a buffer. */
+    output.accept = true;
+
+    TEST_ASSERT_EQUAL( IOT_SERIALIZER_SUCCESS,
+                       _encoder.openContainer( &arrayObject, &innerObject, 1 ) );
+    TEST_ASSERT_EQUAL( IOT_SERIALIZER_SUCCESS,
+                       _encoder.appendKeyValue( &innerObject, "key", IotSerializer_ScalarSignedInt( 1 ) ) );
+    TEST_ASSERT_EQUAL( IOT_SERIALIZER_SUCCESS,
+                       _encoder.closeContainer( &arrayObject, &innerObject ) );
+    TEST_ASSERT_EQUAL( IOT_SERIALIZER_SUCCESS,
+                       _encoder.closeContainer( &mapObject, &arrayObject ) );
+    TEST_ASSERT_EQUAL( IOT_SERIALIZER_SUCCESS,
+                       _encoder.closeContainer( &streamObject, &mapObject ) );
+    TEST_ASSERT_EQUAL( IOT_SERIALIZER_SUCCESS, _encoder.flush( &streamObject ) );
+
+    TEST_ASSERT_EQUAL( IOT_SERIALIZER_SUCCESS,
+                       _encoder.openContainer( &_encoderObject, &mapObject, IOT_SERIALIZER_INDEFINITE_LENGTH ) );
+    TEST_ASSERT_EQUAL( IOT_SERIALIZER_SUCCESS,
+                       _encoder.openContainerWithKey( &mapObject, "array", &arrayObject, IOT_SERIALIZER_INDEFINITE_LENGTH ) );
+
+    for( i = 0; i < emptyCount; i++ )
+    {
+        TEST_ASSERT_EQUAL( IOT_SERIALIZER_SUCCESS,
+                           _encoder.openContainer( &arrayObject, &innerObject, 0 ) );
+        TEST_ASSERT_EQUAL( IOT_SERIALIZER_SUCCESS,
+                           _encoder.closeContainer( &arrayObject, &innerObject ) );
+    }
+
+    TEST_ASSERT_EQUAL( IOT_SERIALIZER_SUCCESS,
+                       _encoder.openContainer( &arrayObject, &innerObject, 1 ) );
+    TEST_ASSERT_EQUAL( IOT_SERIALIZER_SUCCESS,
+                       _encoder.appendKeyValue( &innerObject, "key", IotSerializer_ScalarSignedInt( 1 ) ) );
+    TEST_ASSERT_EQUAL( IOT_SERIALIZER_SUCCESS,
+                       _encoder.closeContainer( &arrayObject, &innerObject ) );
+    TEST_ASSERT_EQUAL( IOT_SERIALIZER_SUCCESS,
+                       _encoder.closeContainer( &mapObject, &arrayObject ) );
+    TEST_ASSERT_EQUAL( IOT_SERIALIZER_SUCCESS,
+                       _encoder.closeContainer( &_encoderObject, &mapObject ) );
+
+    TEST_ASSERT_GREATER_THAN( 0, emptyCount );
+    TEST_ASSERT_EQUAL( _encoder.getEncodedSize( &_encoderObject, _buffer ), output.length );
+    TEST_ASSERT_EQUAL( output.length, _encoder.getEncodedSize( &streamObject, window ) );
+    TEST_ASSERT_EQUAL( 0, memcmp( _buffer, output.data, output.length ) );
+
+    _encoder.destroy( &streamObject );
+}
+
 /*----------------------------------------------------------------------------------------------
  *      DECODER
  *----------------------------------------------------------------------------------------------*/
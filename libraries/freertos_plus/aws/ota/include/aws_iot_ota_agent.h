@@ -229,6 +229,9 @@ typedef enum
 /* Forward delcaration of OTA_FileContext_t. */
 typedef struct OTA_FileContext   OTA_FileContext_t;
 
+/* Forward declaration of the tracker of the blocks of a file that are not received yet. */
+typedef struct OTA_BlockTracker  OTA_BlockTracker_t;
+
 /**
  * @brief OTA Error type.
  */
@@ -374,6 +377,78 @@ typedef int16_t (* pxOTAPALWriteBlockCallback_t)( OTA_FileContext_t * const C,
 typedef OTA_JobParseErr_t (* pxOTACustomJobCallback_t)( const char * pcJSON,
                                                         uint32_t ulMsgLen );
 
+/**
+ * @ingroup ota_datatypes_functionpointers
+ * @brief OTA resume file for receive callback function typedef.
+ *
+ * The user may register a callback function when initializing the OTA Agent. This
+ * callback is used to reopen a partially received file after a reset or a lost
+ * connection, keeping the blocks already written to it. It is only called when a
+ * checkpoint saved for the same job and file is found.
+ *
+ * @param[in] C File context of the job being resumed
+ */
+typedef OTA_Err_t (* pxOTAPALResumeFileForRxCallback_t)( OTA_FileContext_t * const C );
+
+/**
+ * @ingroup ota_datatypes_functionpointers
+ * @brief OTA save checkpoint callback function typedef.
+ *
+ * The user may register a callback function when initializing the OTA Agent. This
+ * callback is used to store the download progress of a file in non-volatile memory,
+ * replacing any checkpoint stored before. The blocks written to the receive file so
+ * far must be stored before the checkpoint is.
+ *
+ * @param[in] C File context of the file being received
+ * @param[in] pucData Checkpoint data to store
+ * @param[in] ulSize Size of the checkpoint data
+ */
+typedef OTA_Err_t (* pxOTAPALSaveCheckpointCallback_t)( OTA_FileContext_t * const C,
+                                                        const uint8_t * pucData,
+                                                        uint32_t ulSize );
+
+/**
+ * @ingroup ota_datatypes_functionpointers
+ * @brief OTA load checkpoint callback function typedef.
+ *
+ * The user may register a callback function when initializing the OTA Agent. This
+ * callback is used to read back the checkpoint last stored by the save checkpoint callback.
+ *
+ * @param[out] pucData Buffer for the checkpoint data
+ * @param[in] ulSize Size of the buffer
+ * @param[out] pulSizeRead Size of the checkpoint data read
+ */
+typedef OTA_Err_t (* pxOTAPALLoadCheckpointCallback_t)( uint8_t * pucData,
+                                                        uint32_t ulSize,
+                                                        uint32_t * pulSizeRead );
+
+/**
+ * @ingroup ota_datatypes_functionpointers
+ * @brief OTA erase checkpoint callback function typedef.
+ *
+ * The user may register a callback function when initializing the OTA Agent. This
+ * callback is used to remove the stored checkpoint once the file is received or the
+ * job fails.
+ */
+typedef OTA_Err_t (* pxOTAPALEraseCheckpointCallback_t)( void );
+
+/**
+ * @ingroup ota_datatypes_functionpointers
+ * @brief OTA read active image callback function typedef.
+ *
+ * The user may register a callback function when initializing the OTA Agent. This
+ * callback is used to read the image currently running on the device, which a delta
+ * update (a file with a non zero ulImageSize) is applied to. It must read exactly
+ * ulSize bytes and fail if the range is not inside the active image.
+ *
+ * @param[in] ulOffset Offset of the data in the active image
+ * @param[out] pucData Buffer for the data
+ * @param[in] ulSize Number of bytes to read
+ */
+typedef OTA_Err_t (* pxOTAPALReadActiveImageCallback_t)( uint32_t ulOffset,
+                                                         uint8_t * pucData,
+                                                         uint32_t ulSize );
+
 
 /*--------------------------- OTA structs ----------------------------*/
 
@@ -417,13 +492,19 @@ typedef struct OTA_FileContext
     uint8_t * pucJobName;       /*!< The job name associated with this file from the job service. */
     uint8_t * pucStreamName;    /*!< The stream associated with this file from the OTA service. */
     Sig256_t * pxSignature;     /*!< Pointer to the file's signature structure. */
-    uint8_t * pucRxBlockBitmap; /*!< Bitmap of blocks received (for de-duping and missing block request). */
+    OTA_BlockTracker_t * pxRxBlockTracker; /*!< Blocks not received yet (for de-duping and missing block request). */
     uint8_t * pucCertFilepath;  /*!< Pathname of the certificate file used to validate the receive file. */
     uint8_t * pucUpdateUrlPath; /*!< Url for the file. */
     uint8_t * pucAuthScheme;    /*!< Authorization scheme. */
     uint32_t ulUpdaterVersion;  /*!< Used by OTA self-test detection, the version of FW that did the update. */
     bool bIsInSelfTest;         /*!< True if the job is in self test mode. */
     uint8_t * pucProtocols;     /*!< Authorization scheme. */
+    void * pvSigVerifyContext;  /*!< Signature verification context holding the hash of the whole file, computed by the
+                                 * agent as the file is received. The PAL may pass it to CRYPTO_SignatureVerificationFinal()
+                                 * on close instead of reading the file back, and must then set it to NULL. NULL if the
+                                 * hash is not available. */
+    uint32_t ulImageSize;       /*!< If not 0, the file is a delta patch against the active image and this is the
+                                 * size of the image rebuilt from it. The rebuilt image is what is written. */
 } OTA_FileContext_t;
 
 /**
@@ -455,6 +536,11 @@ typedef struct
     pxOTAPALWriteBlockCallback_t xWriteBlock;                       /* OTA Write Block callback pointer */
     pxOTACompleteCallback_t xCompleteCallback;                      /* OTA Job Completed callback pointer */
     pxOTACustomJobCallback_t xCustomJobCallback;                    /* OTA Custom Job callback pointer */
+    pxOTAPALResumeFileForRxCallback_t xResumeFileForRx;             /* OTA Resume File for Receive callback pointer, NULL if not supported */
+    pxOTAPALSaveCheckpointCallback_t xSaveCheckpoint;               /* OTA Save Checkpoint callback pointer, NULL if not supported */
+    pxOTAPALLoadCheckpointCallback_t xLoadCheckpoint;               /* OTA Load Checkpoint callback pointer, NULL if not supported */
+    pxOTAPALEraseCheckpointCallback_t xEraseCheckpoint;             /* OTA Erase Checkpoint callback pointer, NULL if not supported */
+    pxOTAPALReadActiveImageCallback_t xReadActiveImage;             /* OTA Read Active Image callback pointer, NULL if not supported */
 } OTA_PAL_Callbacks_t;
 
 
@@ -517,6 +603,8 @@ typedef struct
 #define kOTA_Err_EventQueueSendFailed    0x2c000000UL     /*!< Posting event message to the event queue failed. */
 #define kOTA_Err_InvalidDataProtocol     0x2d000000UL     /*!< Job does not have a valid protocol for data transfer. */
 #define kOTA_Err_OTAAgentStopped         0x2e000000UL     /*!< Returned when operations are performed that requires OTA Agent running & its stopped. */
+#define kOTA_Err_CheckpointFailed        0x2f000000UL     /*!< The PAL failed to save, load or erase the download checkpoint. */
+#define kOTA_Err_DeltaUpdateFailed       0x30000000UL     /*!< The delta patch could not be applied to the active image. */
 /* @[define_ota_err_codes] */
 
 /* @[define_ota_err_code_helpers] */
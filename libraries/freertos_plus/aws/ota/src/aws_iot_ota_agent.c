@@ -48,7 +48,7 @@
 #include "aws_iot_ota_agent_internal.h"
 
 /* JSON job document parser includes. */
-#include "jsmn.h"
+#include "iot_json_utils.h"
 
 /* Mbed tls base64 includes. */
 #include "mbedtls/base64.h"
@@ -59,6 +59,11 @@
 /* OTA interface includes. */
 #include "aws_iot_ota_interface.h"
 
+#if ( OTA_STREAMING_SIGNATURE_VERIFICATION == 1 )
+    /* Crypto includes for hashing the file as it is received. */
+    #include "iot_crypto.h"
+#endif
+
 /* OTA event handler definiton. */
 
 typedef OTA_Err_t ( * OTAEventHandler_t )( OTA_EventData_t * pxEventMsg );
@@ -105,15 +110,6 @@ static OTA_ControlInterface_t xOTA_ControlInterface;
 
 static OTA_DataInterface_t xOTA_DataInterface;
 
-/*
- * Test a null terminated string against a JSON string of known length and return whether
- * it is the same or not.
- */
-
-static bool JSON_IsCStringEqual( const char * pcJSONString,
-                                 uint32_t ulLen,
-                                 const char * pcCString );
-
 /* OTA agent private function prototypes. */
 
 /* OTA agent task fucntion. */
@@ -176,6 +172,47 @@ static OTA_FileContext_t * prvParseJobDoc( const char * pcJSON,
 
 static bool prvOTA_Close( OTA_FileContext_t * const C );
 
+/* Resume the download of a file from the checkpoint saved for it, if any. */
+
+static bool prvCheckpointResume( OTA_FileContext_t * const C );
+
+/* Save the download progress of a file through the PAL. */
+
+static void prvCheckpointSave( OTA_FileContext_t * const C );
+
+/* Erase the checkpoint saved through the PAL. */
+
+static void prvCheckpointErase( void );
+
+/* Set up the patch applier if the file is a delta update. */
+
+static OTA_Err_t prvDeltaStart( const OTA_FileContext_t * C );
+
+/* Free the patch applier of the agent, if any. */
+
+static void prvDeltaStop( void );
+
+#if ( OTA_STREAMING_SIGNATURE_VERIFICATION == 1 )
+
+/* Start hashing a new receive file. */
+
+    static void prvStreamHashStart( void );
+
+/* Add a block written to the receive file to the hash. */
+
+    static void prvStreamHashBlock( uint32_t ulBlockIndex,
+                                    const uint8_t * pucData,
+                                    uint32_t ulBlockSize );
+
+/* Hand the hash of the complete file over to the PAL before the file is closed. */
+
+    static void prvStreamHashFinish( OTA_FileContext_t * const C );
+
+/* Stop hashing and free the hash and any buffered blocks. */
+
+    static void prvStreamHashRelease( OTA_FileContext_t * const C );
+#endif
+
 
 /* Internal function to set the image state including an optional reason code. */
 
@@ -212,12 +249,12 @@ static OTA_Err_t prvPAL_DefaultActivateNewImage( uint32_t ulServerFileID );
 
 static void prvAgentShutdownCleanup( void );
 
-/* Search the document model for a key that matches the specified JSON key. */
+/* Store the value of a document model parameter found in a JSON document. */
 
-static DocParseErr_t prvSearchModelForTokenKey( JSON_DocModel_t * pxDocModel,
-                                                const char * pcJSONString,
-                                                uint32_t ulStrLen,
-                                                uint16_t * pulMatchingIndexResult );
+static DocParseErr_t prvExtractParameter( const JSON_DocParam_t * pxModelParam,
+                                          MultiParmPtr_t xParamAddr,
+                                          const char * pcValue,
+                                          uint32_t ulValueLen );
 
 /*
  * Prepare the document model for use by sanity checking the initialization parameters
@@ -786,6 +823,15 @@ static void prvSetPALCallbacks( const OTA_PAL_Callbacks_t * pxCallbacks )
     {
         xOTA_Agent.xPALCallbacks.xCustomJobCallback = prvDefaultCustomJobCallback;
     }
+
+    /* Resuming downloads is optional, there is no default. */
+    xOTA_Agent.xPALCallbacks.xResumeFileForRx = pxCallbacks->xResumeFileForRx;
+    xOTA_Agent.xPALCallbacks.xSaveCheckpoint = pxCallbacks->xSaveCheckpoint;
+    xOTA_Agent.xPALCallbacks.xLoadCheckpoint = pxCallbacks->xLoadCheckpoint;
+    xOTA_Agent.xPALCallbacks.xEraseCheckpoint = pxCallbacks->xEraseCheckpoint;
+
+    /* Delta updates are optional, there is no default. */
+    xOTA_Agent.xPALCallbacks.xReadActiveImage = pxCallbacks->xReadActiveImage;
 }
 
 static OTA_Err_t prvStartHandler( OTA_EventData_t * pxEventData )
@@ -1124,6 +1170,9 @@ static OTA_Err_t prvProcessDataHandler( OTA_EventData_t * pxEventData )
         /* Stop the request timer.*/
         prvStopRequestTimer();
 
+        /* The download won't be resumed either way. */
+        prvCheckpointErase();
+
         if( xResult == eIngest_Result_FileComplete )
         {
             /* File receive is complete and authenticated. Update the job status with the self_test ready identifier. */
@@ -1202,6 +1251,14 @@ static OTA_Err_t prvProcessDataHandler( OTA_EventData_t * pxEventData )
             {
                 OTA_LOG_L2( "[%s] Failed to update job status %d\r\n", OTA_METHOD_NAME, xErr );
             }
+
+            /* Save the progress every so often so an interrupted download can be resumed. */
+            xOTA_Agent.ulBlocksSinceCheckpoint++;
+
+            if( xOTA_Agent.ulBlocksSinceCheckpoint >= OTA_CHECKPOINT_INTERVAL_BLOCKS )
+            {
+                prvCheckpointSave( pxFileContext );
+            }
         }
 
         if( xOTA_Agent.ulNumOfBlocksToReceive > 1U )
@@ -1252,6 +1309,7 @@ static OTA_Err_t prvUserAbortHandler( OTA_EventData_t * pxEventData )
 
         if( xErr == kOTA_Err_None )
         {
+            prvCheckpointErase();
             ( void ) prvOTA_Close( &( xOTA_Agent.pxOTA_Files[ xOTA_Agent.ulFileIndex ] ) );
         }
     }
@@ -1416,6 +1474,371 @@ OTA_EventData_t * prvOTAEventBufferGet( void )
     return pxOTAFreeMsg;
 }
 
+/* Find the first run of missing blocks that ends after ulBlockIndex. Returns the number of runs
+ * in use if there is none. */
+static uint32_t prvBlockTrackerFindRange( const OTA_BlockTracker_t * pxTracker,
+                                          uint32_t ulBlockIndex )
+{
+    uint32_t ulLow = 0U;
+    uint32_t ulHigh = pxTracker->ulNumRanges;
+    uint32_t ulMid;
+
+    /* Binary search, the runs are sorted and don't overlap. */
+    while( ulLow < ulHigh )
+    {
+        ulMid = ulLow + ( ( ulHigh - ulLow ) >> 1U );
+
+        if( pxTracker->xRanges[ ulMid ].ulEnd <= ulBlockIndex )
+        {
+            ulLow = ulMid + 1U;
+        }
+        else
+        {
+            ulHigh = ulMid;
+        }
+    }
+
+    return ulLow;
+}
+
+OTA_BlockTracker_t * prvBlockTrackerCreate( uint32_t ulNumBlocks )
+{
+    OTA_BlockTracker_t * pxTracker = ( OTA_BlockTracker_t * ) pvPortMalloc( sizeof( OTA_BlockTracker_t ) ); /*lint !e9079 FreeRTOS malloc port returns void*. */
+
+    if( pxTracker != NULL )
+    {
+        /* All blocks are missing, which is a single run unless the file is empty. */
+        pxTracker->ulNumRanges = ( ulNumBlocks > 0U ) ? 1U : 0U;
+        pxTracker->xRanges[ 0 ].ulStart = 0U;
+        pxTracker->xRanges[ 0 ].ulEnd = ulNumBlocks;
+    }
+
+    return pxTracker;
+}
+
+void prvBlockTrackerDelete( OTA_BlockTracker_t * pxTracker )
+{
+    if( pxTracker != NULL )
+    {
+        vPortFree( pxTracker );
+    }
+}
+
+bool prvBlockTrackerIsMissing( const OTA_BlockTracker_t * pxTracker,
+                               uint32_t ulBlockIndex )
+{
+    uint32_t ulRange;
+    bool bMissing = false;
+
+    if( pxTracker != NULL )
+    {
+        ulRange = prvBlockTrackerFindRange( pxTracker, ulBlockIndex );
+
+        if( ( ulRange < pxTracker->ulNumRanges ) && ( pxTracker->xRanges[ ulRange ].ulStart <= ulBlockIndex ) )
+        {
+            bMissing = true;
+        }
+    }
+
+    return bMissing;
+}
+
+bool prvBlockTrackerMarkReceived( OTA_BlockTracker_t * pxTracker,
+                                  uint32_t ulBlockIndex )
+{
+    uint32_t ulRange;
+    OTA_BlockRange_t * pxRange;
+    bool bMarked = false;
+
+    if( prvBlockTrackerIsMissing( pxTracker, ulBlockIndex ) )
+    {
+        ulRange = prvBlockTrackerFindRange( pxTracker, ulBlockIndex );
+        pxRange = &pxTracker->xRanges[ ulRange ];
+
+        if( ( pxRange->ulStart == ulBlockIndex ) && ( pxRange->ulEnd == ( ulBlockIndex + 1U ) ) )
+        {
+            /* Last block of the run, remove the run. */
+            ( void ) memmove( pxRange, &pxRange[ 1 ], ( pxTracker->ulNumRanges - ulRange - 1U ) * sizeof( OTA_BlockRange_t ) );
+            pxTracker->ulNumRanges--;
+            bMarked = true;
+        }
+        else if( pxRange->ulStart == ulBlockIndex )
+        {
+            pxRange->ulStart++;
+            bMarked = true;
+        }
+        else if( pxRange->ulEnd == ( ulBlockIndex + 1U ) )
+        {
+            pxRange->ulEnd--;
+            bMarked = true;
+        }
+        else if( pxTracker->ulNumRanges < OTA_MAX_BLOCK_RANGES )
+        {
+            /* The block is inside the run so split it in two. */
+            ( void ) memmove( &pxRange[ 1 ], pxRange, ( pxTracker->ulNumRanges - ulRange ) * sizeof( OTA_BlockRange_t ) );
+            pxTracker->ulNumRanges++;
+            pxRange->ulEnd = ulBlockIndex;
+            pxRange[ 1 ].ulStart = ulBlockIndex + 1U;
+            bMarked = true;
+        }
+        else
+        {
+            /* No room for another run. The block stays missing. */
+        }
+    }
+
+    return bMarked;
+}
+
+uint32_t prvBlockTrackerNextMissing( const OTA_BlockTracker_t * pxTracker,
+                                     uint32_t ulFromBlock,
+                                     uint32_t * pulFirstBlock )
+{
+    uint32_t ulRange;
+    uint32_t ulNumBlocks = 0U;
+
+    if( pxTracker != NULL )
+    {
+        ulRange = prvBlockTrackerFindRange( pxTracker, ulFromBlock );
+
+        if( ulRange < pxTracker->ulNumRanges )
+        {
+            *pulFirstBlock = ( pxTracker->xRanges[ ulRange ].ulStart > ulFromBlock ) ? pxTracker->xRanges[ ulRange ].ulStart : ulFromBlock;
+            ulNumBlocks = pxTracker->xRanges[ ulRange ].ulEnd - *pulFirstBlock;
+        }
+    }
+
+    return ulNumBlocks;
+}
+
+void prvBlockTrackerGetBitmap( const OTA_BlockTracker_t * pxTracker,
+                               uint32_t ulOffset,
+                               uint8_t * pucBitmap,
+                               uint32_t ulBitmapLen )
+{
+    uint32_t ulRange;
+    uint32_t ulBlock;
+    uint32_t ulEnd;
+    uint32_t ulWindowEnd = ulOffset + ( ulBitmapLen * BITS_PER_BYTE );
+
+    ( void ) memset( pucBitmap, 0, ulBitmapLen );
+
+    if( pxTracker != NULL )
+    {
+        for( ulRange = prvBlockTrackerFindRange( pxTracker, ulOffset );
+             ( ulRange < pxTracker->ulNumRanges ) && ( pxTracker->xRanges[ ulRange ].ulStart < ulWindowEnd );
+             ulRange++ )
+        {
+            ulBlock = ( pxTracker->xRanges[ ulRange ].ulStart > ulOffset ) ? pxTracker->xRanges[ ulRange ].ulStart : ulOffset;
+            ulEnd = ( pxTracker->xRanges[ ulRange ].ulEnd < ulWindowEnd ) ? pxTracker->xRanges[ ulRange ].ulEnd : ulWindowEnd;
+
+            for( ; ulBlock < ulEnd; ulBlock++ )
+            {
+                pucBitmap[ ( ulBlock - ulOffset ) >> LOG2_BITS_PER_BYTE ] |= ( uint8_t ) ( 1U << ( ( ulBlock - ulOffset ) % BITS_PER_BYTE ) );
+            }
+        }
+    }
+}
+
+/* FNV-1a hash of a checkpoint, computed with its checksum field set to 0. */
+static uint32_t prvCheckpointChecksum( const OTA_Checkpoint_t * pxCheckpoint )
+{
+    const uint8_t * pucData = ( const uint8_t * ) pxCheckpoint;
+    uint32_t ulChecksum = 2166136261UL;
+    uint32_t ulIndex;
+
+    for( ulIndex = 0U; ulIndex < sizeof( OTA_Checkpoint_t ); ulIndex++ )
+    {
+        if( ( ulIndex < offsetof( OTA_Checkpoint_t, ulChecksum ) ) ||
+            ( ulIndex >= ( offsetof( OTA_Checkpoint_t, ulChecksum ) + sizeof( uint32_t ) ) ) )
+        {
+            ulChecksum = ( ulChecksum ^ pucData[ ulIndex ] ) * 16777619UL;
+        }
+    }
+
+    return ulChecksum;
+}
+
+bool prvCheckpointCreate( OTA_Checkpoint_t * pxCheckpoint,
+                          const OTA_FileContext_t * C )
+{
+    bool bCreated = false;
+
+    /* The state of a delta patch applier is not checkpointed, a delta update starts over. */
+    if( ( C->pucJobName != NULL ) && ( C->pxSignature != NULL ) && ( C->pxRxBlockTracker != NULL ) &&
+        ( C->ulImageSize == 0U ) &&
+        ( strlen( ( const char * ) C->pucJobName ) <= OTA_CHECKPOINT_JOB_NAME_MAX_LEN ) )
+    {
+        /* Clear the padding too, it is part of the checksum. */
+        ( void ) memset( pxCheckpoint, 0, sizeof( OTA_Checkpoint_t ) );
+
+        pxCheckpoint->ulMagic = OTA_CHECKPOINT_MAGIC;
+        pxCheckpoint->ulServerFileID = C->ulServerFileID;
+        pxCheckpoint->ulFileSize = C->ulFileSize;
+        pxCheckpoint->ulBlockSize = OTA_FILE_BLOCK_SIZE;
+        ( void ) strcpy( ( char * ) pxCheckpoint->ucJobName, ( const char * ) C->pucJobName );
+        ( void ) memcpy( &pxCheckpoint->xSignature, C->pxSignature, sizeof( Sig256_t ) );
+        ( void ) memcpy( &pxCheckpoint->xRxBlockTracker, C->pxRxBlockTracker, sizeof( OTA_BlockTracker_t ) );
+        pxCheckpoint->ulChecksum = prvCheckpointChecksum( pxCheckpoint );
+
+        bCreated = true;
+    }
+
+    return bCreated;
+}
+
+bool prvCheckpointMatches( const OTA_Checkpoint_t * pxCheckpoint,
+                           const OTA_FileContext_t * C )
+{
+    const OTA_BlockTracker_t * pxTracker = &pxCheckpoint->xRxBlockTracker;
+    uint32_t ulNumBlocks = ( C->ulFileSize + ( OTA_FILE_BLOCK_SIZE - 1U ) ) >> otaconfigLOG2_FILE_BLOCK_SIZE;
+    uint32_t ulPrevEnd = 0U;
+    uint32_t ulRange;
+    bool bMatches = false;
+
+    if( ( pxCheckpoint->ulMagic == OTA_CHECKPOINT_MAGIC ) &&
+        ( pxCheckpoint->ulChecksum == prvCheckpointChecksum( pxCheckpoint ) ) &&
+        ( C->pucJobName != NULL ) && ( C->pxSignature != NULL ) && ( C->ulImageSize == 0U ) &&
+        ( pxCheckpoint->ulServerFileID == C->ulServerFileID ) &&
+        ( pxCheckpoint->ulFileSize == C->ulFileSize ) &&
+        ( pxCheckpoint->ulBlockSize == OTA_FILE_BLOCK_SIZE ) &&
+        ( strncmp( ( const char * ) pxCheckpoint->ucJobName, ( const char * ) C->pucJobName, sizeof( pxCheckpoint->ucJobName ) ) == 0 ) &&
+        ( pxCheckpoint->xSignature.usSize == C->pxSignature->usSize ) &&
+        ( C->pxSignature->usSize <= kOTA_MaxSignatureSize ) &&
+        ( memcmp( pxCheckpoint->xSignature.ucData, C->pxSignature->ucData, C->pxSignature->usSize ) == 0 ) &&
+        ( pxTracker->ulNumRanges <= OTA_MAX_BLOCK_RANGES ) )
+    {
+        bMatches = true;
+
+        /* The runs must be sorted, non empty and inside the file. */
+        for( ulRange = 0U; ulRange < pxTracker->ulNumRanges; ulRange++ )
+        {
+            if( ( pxTracker->xRanges[ ulRange ].ulStart < ulPrevEnd ) ||
+                ( pxTracker->xRanges[ ulRange ].ulStart >= pxTracker->xRanges[ ulRange ].ulEnd ) ||
+                ( pxTracker->xRanges[ ulRange ].ulEnd > ulNumBlocks ) )
+            {
+                bMatches = false;
+            }
+
+            ulPrevEnd = pxTracker->xRanges[ ulRange ].ulEnd;
+        }
+    }
+
+    return bMatches;
+}
+
+void prvCheckpointRestore( const OTA_Checkpoint_t * pxCheckpoint,
+                           OTA_FileContext_t * C )
+{
+    const OTA_BlockTracker_t * pxTracker = &pxCheckpoint->xRxBlockTracker;
+    uint32_t ulRange;
+
+    ( void ) memcpy( C->pxRxBlockTracker, pxTracker, sizeof( OTA_BlockTracker_t ) );
+
+    C->ulBlocksRemaining = 0U;
+
+    for( ulRange = 0U; ulRange < pxTracker->ulNumRanges; ulRange++ )
+    {
+        C->ulBlocksRemaining += pxTracker->xRanges[ ulRange ].ulEnd - pxTracker->xRanges[ ulRange ].ulStart;
+    }
+}
+
+static bool prvCheckpointResume( OTA_FileContext_t * const C )
+{
+    DEFINE_OTA_METHOD_NAME( "prvCheckpointResume" );
+
+    OTA_Checkpoint_t * pxCheckpoint = NULL;
+    uint32_t ulSizeRead = 0U;
+    OTA_Err_t xErr = kOTA_Err_Uninitialized;
+    bool bResumed = false;
+
+    if( ( xOTA_Agent.xPALCallbacks.xResumeFileForRx != NULL ) &&
+        ( xOTA_Agent.xPALCallbacks.xLoadCheckpoint != NULL ) )
+    {
+        pxCheckpoint = ( OTA_Checkpoint_t * ) pvPortMalloc( sizeof( OTA_Checkpoint_t ) ); /*lint !e9079 FreeRTOS malloc port returns void*. */
+    }
+
+    if( pxCheckpoint != NULL )
+    {
+        xErr = xOTA_Agent.xPALCallbacks.xLoadCheckpoint( ( uint8_t * ) pxCheckpoint, sizeof( OTA_Checkpoint_t ), &ulSizeRead );
+
+        if( ( xErr != kOTA_Err_None ) || ( ulSizeRead != sizeof( OTA_Checkpoint_t ) ) )
+        {
+            /* No checkpoint, or one from a build with a different layout. */
+        }
+        else if( prvCheckpointMatches( pxCheckpoint, C ) == false )
+        {
+            OTA_LOG_L1( "[%s] Checkpoint is for another file, starting over.\r\n", OTA_METHOD_NAME );
+        }
+        else if( xOTA_Agent.xPALCallbacks.xResumeFileForRx( C ) != kOTA_Err_None )
+        {
+            OTA_LOG_L1( "[%s] Warning: Failed to reopen the receive file, starting over.\r\n", OTA_METHOD_NAME );
+        }
+        else
+        {
+            prvCheckpointRestore( pxCheckpoint, C );
+            bResumed = true;
+
+            OTA_LOG_L1( "[%s] Resuming job %s, %u blocks remaining.\r\n", OTA_METHOD_NAME,
+                        ( const char * ) C->pucJobName,
+                        C->ulBlocksRemaining );
+        }
+
+        vPortFree( pxCheckpoint );
+    }
+
+    return bResumed;
+}
+
+static void prvCheckpointSave( OTA_FileContext_t * const C )
+{
+    DEFINE_OTA_METHOD_NAME( "prvCheckpointSave" );
+
+    OTA_Checkpoint_t * pxCheckpoint = NULL;
+    OTA_Err_t xErr = kOTA_Err_Uninitialized;
+
+    xOTA_Agent.ulBlocksSinceCheckpoint = 0U;
+
+    if( ( xOTA_Agent.xPALCallbacks.xSaveCheckpoint != NULL ) && ( C->ulBlocksRemaining > 0U ) )
+    {
+        pxCheckpoint = ( OTA_Checkpoint_t * ) pvPortMalloc( sizeof( OTA_Checkpoint_t ) ); /*lint !e9079 FreeRTOS malloc port returns void*. */
+    }
+
+    if( pxCheckpoint != NULL )
+    {
+        if( prvCheckpointCreate( pxCheckpoint, C ) == true )
+        {
+            xErr = xOTA_Agent.xPALCallbacks.xSaveCheckpoint( C, ( const uint8_t * ) pxCheckpoint, sizeof( OTA_Checkpoint_t ) );
+
+            if( xErr != kOTA_Err_None )
+            {
+                OTA_LOG_L1( "[%s] Warning: Failed to save checkpoint (0x%08x).\r\n", OTA_METHOD_NAME, xErr );
+            }
+        }
+
+        vPortFree( pxCheckpoint );
+    }
+}
+
+static void prvCheckpointErase( void )
+{
+    DEFINE_OTA_METHOD_NAME( "prvCheckpointErase" );
+
+    OTA_Err_t xErr = kOTA_Err_Uninitialized;
+
+    xOTA_Agent.ulBlocksSinceCheckpoint = 0U;
+
+    if( xOTA_Agent.xPALCallbacks.xEraseCheckpoint != NULL )
+    {
+        xErr = xOTA_Agent.xPALCallbacks.xEraseCheckpoint();
+
+        if( xErr != kOTA_Err_None )
+        {
+            OTA_LOG_L1( "[%s] Warning: Failed to erase checkpoint (0x%08x).\r\n", OTA_METHOD_NAME, xErr );
+        }
+    }
+}
+
 static void prvOTA_FreeContext( OTA_FileContext_t * const C )
 {
     if( C != NULL )
@@ -1432,10 +1855,10 @@ static void prvOTA_FreeContext( OTA_FileContext_t * const C )
             C->pucJobName = NULL;
         }
 
-        if( C->pucRxBlockBitmap != NULL )
+        if( C->pxRxBlockTracker != NULL )
         {
-            vPortFree( C->pucRxBlockBitmap ); /* Free the previously allocated block bitmap. */
-            C->pucRxBlockBitmap = NULL;
+            prvBlockTrackerDelete( C->pxRxBlockTracker ); /* Free the previously allocated block tracker. */
+            C->pxRxBlockTracker = NULL;
         }
 
         if( C->pxSignature != NULL )
@@ -1499,6 +1922,12 @@ static bool prvOTA_Close( OTA_FileContext_t * const C )
          */
         ( void ) xOTA_Agent.xPALCallbacks.xAbort( C );
 
+        #if ( OTA_STREAMING_SIGNATURE_VERIFICATION == 1 )
+            prvStreamHashRelease( C );
+        #endif
+
+        prvDeltaStop();
+
         /* Free the resources. */
         prvOTA_FreeContext( C );
 
@@ -1538,63 +1967,118 @@ static OTA_FileContext_t * prvGetFreeContext( void )
     return C;
 }
 
-static bool JSON_IsCStringEqual( const char * pcJSONString,
-                                 uint32_t ulLen,
-                                 const char * pcCString )
+/* Store the value of a document model parameter found in a JSON document. The value
+ * of a string excludes its quotes. */
+
+static DocParseErr_t prvExtractParameter( const JSON_DocParam_t * pxModelParam,
+                                          MultiParmPtr_t xParamAddr,
+                                          const char * pcValue,
+                                          uint32_t ulValueLen )
 {
-    bool bResult;
+    DEFINE_OTA_METHOD_NAME( "prvExtractParameter" );
+
+    DocParseErr_t eErr = eDocParseErr_None;
 
-    if( ( ulLen <= OTA_MAX_JSON_STR_LEN ) &&
-        ( strncmp( pcJSONString, pcCString, ulLen ) == 0 ) && /*lint !e9007 I see no side effect. Possibly a lint bug. */
-        ( pcCString[ ulLen ] == '\0' ) )
+    if( ( eModelParamType_StringCopy == pxModelParam->xModelParamType ) ||
+        ( eModelParamType_ArrayCopy == pxModelParam->xModelParamType ) )
     {
-        bResult = true;
+        /* Malloc memory for a copy of the value string plus a zero terminator. */
+        void * pvStringCopy = pvPortMalloc( ulValueLen + 1U );
+
+        if( pvStringCopy != NULL )
+        {
+            *xParamAddr.ppvPtr = pvStringCopy;
+            char * pcStringCopy = *xParamAddr.ppcPtr;
+            /* Copy parameter string into newly allocated memory. */
+            ( void ) memcpy( pcStringCopy, pcValue, ulValueLen );
+            /* Zero terminate the new string. */
+            pcStringCopy[ ulValueLen ] = '\0';
+            OTA_LOG_L1( "[%s] Extracted parameter [ %s: %s ]\r\n",
+                        OTA_METHOD_NAME,
+                        pxModelParam->pcSrcKey,
+                        pcStringCopy );
+        }
+        else
+        { /* Stop processing on error. */
+            eErr = eDocParseErr_OutOfMemory;
+        }
     }
-    else
+    else if( eModelParamType_StringInDoc == pxModelParam->xModelParamType )
     {
-        bResult = false;
+        /* Copy pointer to source string instead of duplicating the string. */
+        *xParamAddr.ppccPtr = pcValue;
+        OTA_LOG_L1( "[%s] Extracted parameter [ %s: %.*s ]\r\n",
+                    OTA_METHOD_NAME,
+                    pxModelParam->pcSrcKey,
+                    ulValueLen, pcValue );
     }
+    else if( eModelParamType_UInt32 == pxModelParam->xModelParamType )
+    {
+        char * pEnd;
+        *xParamAddr.pulPtr = strtoul( pcValue, &pEnd, 0 );
 
-    return bResult;
-}
-
-
-/* Search our document model for a key match with the given token. */
-
-static DocParseErr_t prvSearchModelForTokenKey( JSON_DocModel_t * pxDocModel,
-                                                const char * pcJSONString,
-                                                uint32_t ulStrLen,
-                                                uint16_t * pulMatchingIndexResult )
-{
-    DocParseErr_t eErr = eDocParseErr_ParamKeyNotInModel;
-    uint16_t usParamIndex;
-
-    for( usParamIndex = 0; usParamIndex < pxDocModel->usNumModelParams; usParamIndex++ )
+        if( pEnd == &pcValue[ ulValueLen ] )
+        {
+            OTA_LOG_L1( "[%s] Extracted parameter [ %s: %u ]\r\n",
+                        OTA_METHOD_NAME,
+                        pxModelParam->pcSrcKey,
+                        *xParamAddr.pulPtr );
+        }
+        else
+        {
+            eErr = eDocParseErr_InvalidNumChar;
+        }
+    }
+    else if( eModelParamType_SigBase64 == pxModelParam->xModelParamType )
     {
-        if( JSON_IsCStringEqual( pcJSONString, ulStrLen,
-                                 pxDocModel->pxBodyDef[ usParamIndex ].pcSrcKey ) )
+        /* Allocate space for and decode the base64 signature. */
+        void * pvSignature = pvPortMalloc( sizeof( Sig256_t ) );
+
+        if( pvSignature != NULL )
         {
-            /* Per Security, don't allow multiple entries of the same parameter. */
-            if( ( pxDocModel->ulParamsReceivedBitmap & ( ( uint32_t ) 1U << usParamIndex ) ) != 0U ) /*lint !e9032 usParamIndex will never be greater than kDocModel_MaxParams, which is the the size of the bitmap. */
-            {
-                eErr = eDocParseErr_DuplicatesNotAllowed;
+            size_t xActualLen = 0;
+            *xParamAddr.ppvPtr = pvSignature;
+            Sig256_t * pxSig256 = *xParamAddr.ppxSig256Ptr;
+
+            if( mbedtls_base64_decode( pxSig256->ucData, sizeof( pxSig256->ucData ), &xActualLen,
+                                       ( const uint8_t * ) pcValue, ulValueLen ) != 0 )
+            { /* Stop processing on error. */
+                OTA_LOG_L1( "[%s] mbedtls_base64_decode failed.\r\n", OTA_METHOD_NAME );
+                eErr = eDocParseErr_Base64Decode;
             }
             else
             {
-                /* Mark parameter as received in the bitmap. */
-                pxDocModel->ulParamsReceivedBitmap |= ( ( uint32_t ) 1U << usParamIndex ); /*lint !e9032 usParamIndex will never be greater than kDocModel_MaxParams, which is the the size of the bitmap. */
-                *pulMatchingIndexResult = usParamIndex;                                    /* Save result index for caller. */
-                eErr = eDocParseErr_None;                                                  /* We found a matching key in the document model. */
+                pxSig256->usSize = ( uint16_t ) xActualLen;
+                OTA_LOG_L1( "[%s] Extracted parameter [ %s: %.32s... ]\r\n",
+                            OTA_METHOD_NAME,
+                            pxModelParam->pcSrcKey,
+                            pcValue );
             }
-
-            break; /* We found a key match so stop searching. */
         }
+        else
+        {
+            /* We failed to allocate needed memory. Everything will be freed below upon failure. */
+            eErr = eDocParseErr_OutOfMemory;
+        }
+    }
+    else if( eModelParamType_Ident == pxModelParam->xModelParamType )
+    {
+        OTA_LOG_L1( "[%s] Identified parameter [ %s ]\r\n",
+                    OTA_METHOD_NAME,
+                    pxModelParam->pcSrcKey );
+        *xParamAddr.pbBoolPtr = true;
+    }
+    else
+    {
+        /* Ignore invalid document model type. */
     }
 
     return eErr;
 }
 
-/* Extract the desired fields from the JSON document based on the specified document model. */
+/* Extract the desired fields from the JSON document based on the specified document model.
+ * The model is run as a query over the document, which finds every parameter in one pass
+ * and skips everything else without tokenizing it. */
 
 static DocParseErr_t prvParseJSONbyModel( const char * pcJSON,
                                           uint32_t ulMsgLen,
@@ -1603,20 +2087,17 @@ static DocParseErr_t prvParseJSONbyModel( const char * pcJSON,
     DEFINE_OTA_METHOD_NAME( "prvParseJSONbyModel" );
 
     const JSON_DocParam_t * pxModelParam = NULL;
-    jsmn_parser xParser;
-    jsmntok_t * pxTokens = NULL;
-    const jsmntok_t * pxValTok = NULL;
-    int32_t jsmn_result = 0;
-    uint32_t ulNumTokens = 0, ulTokenLen = 0;
+    IotJsonQueryKey_t * pxQuery = NULL;
+    IotJsonQueryResult_t * pxResults = NULL;
+    const IotJsonQueryResult_t * pxResult = NULL;
+    jsmntype_t eValueType = JSMN_UNDEFINED;
+    const char * pcValue = NULL;
+    uint32_t ulValueLen = 0;
     MultiParmPtr_t xParamAddr; /*lint !e9018 We intentionally use this union to cast the parameter address to the proper type. */
-    uint32_t ulIndex = 0;
     uint16_t usModelParamIndex = 0;
     uint32_t ulScanIndex = 0;
     DocParseErr_t eErr = eDocParseErr_None;
 
-    /* Reset the Jasmine tokenizer. */
-    jsmn_init( &xParser );
-
     /* Check if document model is valid. */
     if( pxDocModel == NULL )
     {
@@ -1654,264 +2135,126 @@ static DocParseErr_t prvParseJSONbyModel( const char * pcJSON,
         }
     }
 
-    /* Check if token numbe is valid. */
-    if( eErr == eDocParseErr_None )
+    /* Allocate space on heap for the query of the document model and its results. */
+    if( ( eErr == eDocParseErr_None ) && ( pxDocModel->usNumModelParams > 0U ) )
     {
         pxModelParam = pxDocModel->pxBodyDef;
+        pxResults = ( IotJsonQueryResult_t * ) pvPortMalloc( pxDocModel->usNumModelParams *
+                                                             ( sizeof( IotJsonQueryResult_t ) + sizeof( IotJsonQueryKey_t ) ) );
 
-        /* Count the total number of tokens in our JSON document. */
-        jsmn_result = jsmn_parse( &xParser, pcJSON, ( size_t ) ulMsgLen, NULL, 1UL );
-        ulNumTokens = jsmn_result < 0 ? 0 : ( uint32_t ) jsmn_result;
-
-        if( ulNumTokens == 0 )
+        if( pxResults == NULL )
         {
-            OTA_LOG_L1( "[%s] Invalid JSON document. No tokens parsed. \r\n", OTA_METHOD_NAME );
-            eErr = eDocParseErr_NoTokens;
+            OTA_LOG_L1( "[%s] No memory for the document model query.\r\n", OTA_METHOD_NAME );
+            eErr = eDocParseErr_OutOfMemory;
+        }
+        else
+        {
+            pxQuery = ( IotJsonQueryKey_t * ) &pxResults[ pxDocModel->usNumModelParams ]; /*lint !e9087 The keys follow the results in the same allocation. */
+
+            for( usModelParamIndex = 0U; usModelParamIndex < pxDocModel->usNumModelParams; usModelParamIndex++ )
+            {
+                pxQuery[ usModelParamIndex ].pKey = pxModelParam[ usModelParamIndex ].pcSrcKey;
+                pxQuery[ usModelParamIndex ].keyLength = strlen( pxModelParam[ usModelParamIndex ].pcSrcKey );
+                pxQuery[ usModelParamIndex ].parent = pxModelParam[ usModelParamIndex ].sParentParam;
+            }
         }
     }
 
-    /* Check if the JSON document isn't too big for our token array. */
+    /* Find all the parameters of the model in the document. */
     if( eErr == eDocParseErr_None )
     {
-        if( ulNumTokens > OTA_MAX_JSON_TOKENS )
+        if( IotJsonUtils_Query( pcJSON, ( size_t ) ulMsgLen, pxQuery,
+                                pxDocModel->usNumModelParams, pxResults ) == false )
         {
-            OTA_LOG_L1( "[%s] Document has too many keys.\r\n", OTA_METHOD_NAME );
-            eErr = eDocParseErr_TooManyTokens;
+            OTA_LOG_L1( "[%s] Invalid JSON document. No tokens parsed. \r\n", OTA_METHOD_NAME );
+            eErr = eDocParseErr_NoTokens;
         }
     }
 
-    /* Allocate space on heap for temporary token array. */
-    if( eErr == eDocParseErr_None )
+    /* Extract the parameters that were found. */
+    for( usModelParamIndex = 0U;
+         ( eErr == eDocParseErr_None ) && ( usModelParamIndex < pxDocModel->usNumModelParams );
+         usModelParamIndex++ )
     {
-        /* Allocate space for the document JSON tokens. */
-        pxTokens = ( jsmntok_t * ) pvPortMalloc( ulNumTokens * sizeof( jsmntok_t ) );
+        pxResult = &pxResults[ usModelParamIndex ];
 
-        if( pxTokens == NULL )
+        /* Per Security, don't allow multiple entries of the same parameter. */
+        if( pxResult->count > 1U )
         {
-            OTA_LOG_L1( "[%s] No memory for JSON tokens.\r\n", OTA_METHOD_NAME );
-            eErr = eDocParseErr_OutOfMemory;
+            OTA_LOG_L1( "[%s] parameter is duplicated: %s\r\n",
+                        OTA_METHOD_NAME,
+                        pxModelParam[ usModelParamIndex ].pcSrcKey );
+            eErr = eDocParseErr_DuplicatesNotAllowed;
         }
-    }
-
-    /* Init Jasmine and check number of tokens.*/
-    if( eErr == eDocParseErr_None )
-    {
-        /* Reset Jasmine again and tokenize the document for real. */
-        jsmn_init( &xParser );
-        ulIndex = ( uint32_t ) jsmn_parse( &xParser, pcJSON, ulMsgLen, pxTokens, ulNumTokens );
-
-        if( ulIndex != ulNumTokens )
+        else if( pxResult->count == 1U )
         {
-            OTA_LOG_L1( "[%s] jsmn_parse didn't match token count when parsing.\r\n", OTA_METHOD_NAME );
-            eErr = eDocParseErr_JasmineCountMismatch;
-        }
-    }
+            /* Mark parameter as received in the bitmap. */
+            pxDocModel->ulParamsReceivedBitmap |= ( ( uint32_t ) 1U << usModelParamIndex ); /*lint !e9032 usModelParamIndex will never be greater than kDocModel_MaxParams, which is the the size of the bitmap. */
 
-    /* Process JSON tokens. */
-    if( eErr == eDocParseErr_None )
-    {
-        /* Examine each JSON token, searching for job parameters based on our document model. */
-        for( ulIndex = 0U; ( eErr == eDocParseErr_None ) && ( ulIndex < ulNumTokens ); ulIndex++ )
-        {
-            /* All parameter keys are JSON strings. */
-            if( pxTokens[ ulIndex ].type == JSMN_STRING )
-            {
-                /* Search the document model to see if it matches the current key. */
-                ulTokenLen = ( uint32_t ) pxTokens[ ulIndex ].end - ( uint32_t ) pxTokens[ ulIndex ].start;
-                eErr = prvSearchModelForTokenKey( pxDocModel, &pcJSON[ pxTokens[ ulIndex ].start ], ulTokenLen, &usModelParamIndex );
+            /* The first character of a JSON value determines its type. The value of a
+             * string is between its quotes. */
+            pcValue = pxResult->pValue;
+            ulValueLen = ( uint32_t ) pxResult->valueLength;
 
-                /* If we didn't find a match in the model, skip over it and its descendants. */
-                if( eErr == eDocParseErr_ParamKeyNotInModel )
-                {
-                    int32_t iRoot = ( int32_t ) ulIndex; /* Create temp root from the unrecognized tokens index. Use signed int since the parent index is signed. */
-                    ulIndex++;                           /* Skip the active key since it's the one we don't recognize. */
+            if( pcValue[ 0 ] == '"' )
+            {
+                eValueType = JSMN_STRING;
+                pcValue++;
+                ulValueLen -= 2U;
+            }
+            else if( pcValue[ 0 ] == '{' )
+            {
+                eValueType = JSMN_OBJECT;
+            }
+            else if( pcValue[ 0 ] == '[' )
+            {
+                eValueType = JSMN_ARRAY;
+            }
+            else
+            {
+                eValueType = JSMN_PRIMITIVE;
+            }
 
-                    /* Skip tokens whose parents are equal to or deeper than the unrecognized temporary root token level. */
-                    while( ( ulIndex < ulNumTokens ) && ( pxTokens[ ulIndex ].parent >= iRoot ) )
-                    {
-                        ulIndex++; /* Skip over all descendants of the unknown parent. */
-                    }
+            /* Verify the field type is what we expect for this parameter. */
+            if( eValueType != pxModelParam[ usModelParamIndex ].eJasmineType )
+            {
+                OTA_LOG_L1( "[%s] parameter type mismatch [ %s : %.*s ] type %u, expected %u\r\n",
+                            OTA_METHOD_NAME, pxModelParam[ usModelParamIndex ].pcSrcKey, ulValueLen,
+                            pcValue, eValueType, pxModelParam[ usModelParamIndex ].eJasmineType );
+                eErr = eDocParseErr_FieldTypeMismatch;
+            }
+            else if( OTA_DONT_STORE_PARAM == pxModelParam[ usModelParamIndex ].ulDestOffset )
+            {
+                /* Nothing to do with this parameter since we're not storing it. */
+            }
+            else
+            {
+                /* Get destination offset to parameter storage location. */
 
-                    --ulIndex;                /* Adjust for outer for-loop increment. */
-                    eErr = eDocParseErr_None; /* Unknown key structures are simply skipped so clear the error state to continue. */
-                }
-                else if( eErr == eDocParseErr_None )
+                /* If it's within the models context structure, add in the context instance base address. */
+                if( pxModelParam[ usModelParamIndex ].ulDestOffset < pxDocModel->ulContextSize )
                 {
-                    /* We found the parameter key in the document model. */
-
-                    /* Get the value field (i.e. the following token) for the parameter. */
-                    pxValTok = &pxTokens[ ulIndex + 1UL ];
-
-                    /* Verify the field type is what we expect for this parameter. */
-                    if( pxValTok->type != pxModelParam[ usModelParamIndex ].eJasmineType )
-                    {
-                        ulTokenLen = ( uint32_t ) ( pxValTok->end ) - ( uint32_t ) ( pxValTok->start );
-                        OTA_LOG_L1( "[%s] parameter type mismatch [ %s : %.*s ] type %u, expected %u\r\n",
-                                    OTA_METHOD_NAME, pxModelParam[ usModelParamIndex ].pcSrcKey, ulTokenLen,
-                                    &pcJSON[ pxValTok->start ],
-                                    pxValTok->type, pxModelParam[ usModelParamIndex ].eJasmineType );
-                        eErr = eDocParseErr_FieldTypeMismatch;
-                    }
-                    else if( OTA_DONT_STORE_PARAM == pxModelParam[ usModelParamIndex ].ulDestOffset )
-                    {
-                        /* Nothing to do with this parameter since we're not storing it. */
-                        continue;
-                    }
-                    else
-                    {
-                        /* Get destination offset to parameter storage location. */
-
-                        /* If it's within the models context structure, add in the context instance base address. */
-                        if( pxModelParam[ usModelParamIndex ].ulDestOffset < pxDocModel->ulContextSize )
-                        {
-                            xParamAddr.ulVal = pxDocModel->ulContextBase + pxModelParam[ usModelParamIndex ].ulDestOffset;
-                        }
-                        else
-                        {
-                            /* It's a raw pointer so keep it as is. */
-                            xParamAddr.ulVal = pxModelParam[ usModelParamIndex ].ulDestOffset;
-                        }
-
-                        if( eModelParamType_StringCopy == pxModelParam[ usModelParamIndex ].xModelParamType )
-                        {
-                            /* Malloc memory for a copy of the value string plus a zero terminator. */
-                            ulTokenLen = ( uint32_t ) ( pxValTok->end ) - ( uint32_t ) ( pxValTok->start );
-                            void * pvStringCopy = pvPortMalloc( ulTokenLen + 1U );
-
-                            if( pvStringCopy != NULL )
-                            {
-                                *xParamAddr.ppvPtr = pvStringCopy;
-                                char * pcStringCopy = *xParamAddr.ppcPtr;
-                                /* Copy parameter string into newly allocated memory. */
-                                ( void ) memcpy( pcStringCopy, &pcJSON[ pxValTok->start ], ulTokenLen );
-                                /* Zero terminate the new string. */
-                                pcStringCopy[ ulTokenLen ] = '\0';
-                                OTA_LOG_L1( "[%s] Extracted parameter [ %s: %s ]\r\n",
-                                            OTA_METHOD_NAME,
-                                            pxModelParam[ usModelParamIndex ].pcSrcKey,
-                                            pcStringCopy );
-                            }
-                            else
-                            { /* Stop processing on error. */
-                                eErr = eDocParseErr_OutOfMemory;
-                            }
-                        }
-                        else if( eModelParamType_StringInDoc == pxModelParam[ usModelParamIndex ].xModelParamType )
-                        {
-                            /* Copy pointer to source string instead of duplicating the string. */
-                            const char * pcStringInDoc = &pcJSON[ pxValTok->start ];
-                            *xParamAddr.ppccPtr = pcStringInDoc;
-                            ulTokenLen = ( uint32_t ) ( pxValTok->end ) - ( uint32_t ) ( pxValTok->start );
-                            OTA_LOG_L1( "[%s] Extracted parameter [ %s: %.*s ]\r\n",
-                                        OTA_METHOD_NAME,
-                                        pxModelParam[ usModelParamIndex ].pcSrcKey,
-                                        ulTokenLen, pcStringInDoc );
-                        }
-                        else if( eModelParamType_UInt32 == pxModelParam[ usModelParamIndex ].xModelParamType )
-                        {
-                            char * pEnd;
-                            const char * pStart = &pcJSON[ pxValTok->start ];
-                            *xParamAddr.pulPtr = strtoul( pStart, &pEnd, 0 );
-
-                            if( pEnd == &pcJSON[ pxValTok->end ] )
-                            {
-                                OTA_LOG_L1( "[%s] Extracted parameter [ %s: %u ]\r\n",
-                                            OTA_METHOD_NAME,
-                                            pxModelParam[ usModelParamIndex ].pcSrcKey,
-                                            *xParamAddr.pulPtr );
-                            }
-                            else
-                            {
-                                eErr = eDocParseErr_InvalidNumChar;
-                            }
-                        }
-                        else if( eModelParamType_SigBase64 == pxModelParam[ usModelParamIndex ].xModelParamType )
-                        {
-                            /* Allocate space for and decode the base64 signature. */
-                            void * pvSignature = pvPortMalloc( sizeof( Sig256_t ) );
-
-                            if( pvSignature != NULL )
-                            {
-                                size_t xActualLen = 0;
-                                *xParamAddr.ppvPtr = pvSignature;
-                                Sig256_t * pxSig256 = *xParamAddr.ppxSig256Ptr;
-                                ulTokenLen = ( uint32_t ) ( pxValTok->end ) - ( uint32_t ) ( pxValTok->start );
-
-                                if( mbedtls_base64_decode( pxSig256->ucData, sizeof( pxSig256->ucData ), &xActualLen,
-                                                           ( const uint8_t * ) &pcJSON[ pxValTok->start ], ulTokenLen ) != 0 )
-                                { /* Stop processing on error. */
-                                    OTA_LOG_L1( "[%s] mbedtls_base64_decode failed.\r\n", OTA_METHOD_NAME );
-                                    eErr = eDocParseErr_Base64Decode;
-                                }
-                                else
-                                {
-                                    pxSig256->usSize = ( uint16_t ) xActualLen;
-                                    OTA_LOG_L1( "[%s] Extracted parameter [ %s: %.32s... ]\r\n",
-                                                OTA_METHOD_NAME,
-                                                pxModelParam[ usModelParamIndex ].pcSrcKey,
-                                                &pcJSON[ pxValTok->start ] );
-                                }
-                            }
-                            else
-                            {
-                                /* We failed to allocate needed memory. Everything will be freed below upon failure. */
-                                eErr = eDocParseErr_OutOfMemory;
-                            }
-                        }
-                        else if( eModelParamType_Ident == pxModelParam[ usModelParamIndex ].xModelParamType )
-                        {
-                            OTA_LOG_L1( "[%s] Identified parameter [ %s ]\r\n",
-                                        OTA_METHOD_NAME,
-                                        pxModelParam[ usModelParamIndex ].pcSrcKey );
-                            *xParamAddr.pbBoolPtr = true;
-                        }
-
-                        if( eModelParamType_ArrayCopy == pxModelParam[ usModelParamIndex ].xModelParamType )
-                        {
-                            /* Malloc memory for a copy of the value string plus a zero terminator. */
-                            ulTokenLen = ( uint32_t ) ( pxValTok->end ) - ( uint32_t ) ( pxValTok->start );
-                            void * pvStringCopy = pvPortMalloc( ulTokenLen + 1U );
-
-                            if( pvStringCopy != NULL )
-                            {
-                                *xParamAddr.ppvPtr = pvStringCopy;
-                                char * pcStringCopy = *xParamAddr.ppcPtr;
-                                /* Copy parameter string into newly allocated memory. */
-                                ( void ) memcpy( pcStringCopy, &pcJSON[ pxValTok->start ], ulTokenLen );
-                                /* Zero terminate the new string. */
-                                pcStringCopy[ ulTokenLen ] = '\0';
-                                OTA_LOG_L1( "[%s] Extracted parameter [ %s: %s ]\r\n",
-                                            OTA_METHOD_NAME,
-                                            pxModelParam[ usModelParamIndex ].pcSrcKey,
-                                            pcStringCopy );
-                            }
-                            else
-                            { /* Stop processing on error. */
-                                eErr = eDocParseErr_OutOfMemory;
-                            }
-                        }
-                        else
-                        {
-                            /* Ignore invalid document model type. */
-                        }
-                    }
+                    xParamAddr.ulVal = pxDocModel->ulContextBase + pxModelParam[ usModelParamIndex ].ulDestOffset;
                 }
                 else
                 {
-                    /* Nothing special to do. The error will break us out of the loop. */
+                    /* It's a raw pointer so keep it as is. */
+                    xParamAddr.ulVal = pxModelParam[ usModelParamIndex ].ulDestOffset;
                 }
-            }
-            else
-            {
-                /* Ignore tokens that are not strings and move on to the next. */
+
+                eErr = prvExtractParameter( &pxModelParam[ usModelParamIndex ], xParamAddr, pcValue, ulValueLen );
             }
         }
+        else
+        {
+            /* The parameter is not in the document. Required parameters are checked below. */
+        }
     }
 
-    if( pxTokens != NULL )
+    if( pxResults != NULL )
     {
-        /* Free the token memory. */
-        vPortFree( pxTokens ); /*lint !e850 ulIndex is intentionally modified within the loop to skip over unknown tags. */
+        /* Free the query memory. */
+        vPortFree( pxResults );
     }
 
     if( eErr == eDocParseErr_None )
@@ -2063,26 +2406,28 @@ static OTA_FileContext_t * prvParseJobDoc( const char * pcJSON,
     /* Namely union initialization and pointers converted to values. */
     static const JSON_DocParam_t xOTA_JobDocModelParamStructure[ OTA_NUM_JOB_PARAMS ] =
     {
-        { OTA_JSON_CLIENT_TOKEN_KEY,    OTA_JOB_PARAM_OPTIONAL, { ( uint32_t ) &xOTA_Agent.pcClientTokenFromJob }, eModelParamType_StringInDoc, JSMN_STRING    }, /*lint !e9078 !e923 Get address of token as value. */
-        { OTA_JSON_TIMESTAMP_KEY,       OTA_JOB_PARAM_OPTIONAL, { ( uint32_t ) &xOTA_Agent.ulTimestampFromJob   }, eModelParamType_UInt32,      JSMN_PRIMITIVE },
-        { OTA_JSON_EXECUTION_KEY,       OTA_JOB_PARAM_REQUIRED, { OTA_DONT_STORE_PARAM                          }, eModelParamType_Object,      JSMN_OBJECT    },
-        { OTA_JSON_JOB_ID_KEY,          OTA_JOB_PARAM_REQUIRED, { offsetof( OTA_FileContext_t, pucJobName )     }, eModelParamType_StringCopy,  JSMN_STRING    },
-        { OTA_JSON_STATUS_DETAILS_KEY,  OTA_JOB_PARAM_OPTIONAL, { OTA_DONT_STORE_PARAM                          }, eModelParamType_Object,      JSMN_OBJECT    },
-        { OTA_JSON_SELF_TEST_KEY,       OTA_JOB_PARAM_OPTIONAL, { offsetof( OTA_FileContext_t, bIsInSelfTest )  }, eModelParamType_Ident,       JSMN_STRING    },
-        { OTA_JSON_UPDATED_BY_KEY,      OTA_JOB_PARAM_OPTIONAL, { offsetof( OTA_FileContext_t, ulUpdaterVersion )}, eModelParamType_UInt32,      JSMN_STRING    },
-        { OTA_JSON_JOB_DOC_KEY,         OTA_JOB_PARAM_REQUIRED, { OTA_DONT_STORE_PARAM                          }, eModelParamType_Object,      JSMN_OBJECT    },
-        { OTA_JSON_OTA_UNIT_KEY,        OTA_JOB_PARAM_REQUIRED, { OTA_DONT_STORE_PARAM                          }, eModelParamType_Object,      JSMN_OBJECT    },
-        { OTA_JSON_STREAM_NAME_KEY,     OTA_JOB_PARAM_OPTIONAL, { offsetof( OTA_FileContext_t, pucStreamName )  }, eModelParamType_StringCopy,  JSMN_STRING    },
-        { OTA_JSON_PROTOCOLS_KEY,       OTA_JOB_PARAM_REQUIRED, { offsetof( OTA_FileContext_t, pucProtocols )   }, eModelParamType_ArrayCopy,   JSMN_ARRAY     },
-        { OTA_JSON_FILE_GROUP_KEY,      OTA_JOB_PARAM_REQUIRED, { OTA_DONT_STORE_PARAM                          }, eModelParamType_Array,       JSMN_ARRAY     },
-        { OTA_JSON_FILE_PATH_KEY,       OTA_JOB_PARAM_REQUIRED, { offsetof( OTA_FileContext_t, pucFilePath )    }, eModelParamType_StringCopy,  JSMN_STRING    },
-        { OTA_JSON_FILE_SIZE_KEY,       OTA_JOB_PARAM_REQUIRED, { offsetof( OTA_FileContext_t, ulFileSize )     }, eModelParamType_UInt32,      JSMN_PRIMITIVE },
-        { OTA_JSON_FILE_ID_KEY,         OTA_JOB_PARAM_REQUIRED, { offsetof( OTA_FileContext_t, ulServerFileID ) }, eModelParamType_UInt32,      JSMN_PRIMITIVE },
-        { OTA_JSON_FILE_CERT_NAME_KEY,  OTA_JOB_PARAM_REQUIRED, { offsetof( OTA_FileContext_t, pucCertFilepath )}, eModelParamType_StringCopy,  JSMN_STRING    },
-        { OTA_JSON_UPDATE_DATA_URL_KEY, OTA_JOB_PARAM_OPTIONAL, { offsetof( OTA_FileContext_t, pucUpdateUrlPath )}, eModelParamType_StringCopy,  JSMN_STRING    },
-        { OTA_JSON_AUTH_SCHEME_KEY,     OTA_JOB_PARAM_OPTIONAL, { offsetof( OTA_FileContext_t, pucAuthScheme )  }, eModelParamType_StringCopy,  JSMN_STRING    },
-        { cOTA_JSON_FileSignatureKey,   OTA_JOB_PARAM_REQUIRED, { offsetof( OTA_FileContext_t, pxSignature )    }, eModelParamType_SigBase64,   JSMN_STRING    },
-        { OTA_JSON_FILE_ATTRIBUTE_KEY,  OTA_JOB_PARAM_OPTIONAL, { offsetof( OTA_FileContext_t, ulFileAttributes )}, eModelParamType_UInt32,      JSMN_PRIMITIVE },
+        { OTA_JSON_CLIENT_TOKEN_KEY,    OTA_JOB_PARAM_ROOT,           OTA_JOB_PARAM_OPTIONAL, { ( uint32_t ) &xOTA_Agent.pcClientTokenFromJob }, eModelParamType_StringInDoc, JSMN_STRING    }, /*lint !e9078 !e923 Get address of token as value. */
+        { OTA_JSON_TIMESTAMP_KEY,       OTA_JOB_PARAM_ROOT,           OTA_JOB_PARAM_OPTIONAL, { ( uint32_t ) &xOTA_Agent.ulTimestampFromJob   }, eModelParamType_UInt32,      JSMN_PRIMITIVE },
+        { OTA_JSON_EXECUTION_KEY,       OTA_JOB_PARAM_ROOT,           OTA_JOB_PARAM_REQUIRED, { OTA_DONT_STORE_PARAM                          }, eModelParamType_Object,      JSMN_OBJECT    },
+        { OTA_JSON_JOB_ID_KEY,          OTA_JOB_PARAM_EXECUTION,      OTA_JOB_PARAM_REQUIRED, { offsetof( OTA_FileContext_t, pucJobName )     }, eModelParamType_StringCopy,  JSMN_STRING    },
+        { OTA_JSON_STATUS_DETAILS_KEY,  OTA_JOB_PARAM_EXECUTION,      OTA_JOB_PARAM_OPTIONAL, { OTA_DONT_STORE_PARAM                          }, eModelParamType_Object,      JSMN_OBJECT    },
+        { OTA_JSON_SELF_TEST_KEY,       OTA_JOB_PARAM_STATUS_DETAILS, OTA_JOB_PARAM_OPTIONAL, { offsetof( OTA_FileContext_t, bIsInSelfTest )  }, eModelParamType_Ident,       JSMN_STRING    },
+        { OTA_JSON_UPDATED_BY_KEY,      OTA_JOB_PARAM_STATUS_DETAILS, OTA_JOB_PARAM_OPTIONAL, { offsetof( OTA_FileContext_t, ulUpdaterVersion )}, eModelParamType_UInt32,      JSMN_STRING    },
+        { OTA_JSON_JOB_DOC_KEY,         OTA_JOB_PARAM_EXECUTION,      OTA_JOB_PARAM_REQUIRED, { OTA_DONT_STORE_PARAM                          }, eModelParamType_Object,      JSMN_OBJECT    },
+        { OTA_JSON_OTA_UNIT_KEY,        OTA_JOB_PARAM_JOB_DOC,        OTA_JOB_PARAM_REQUIRED, { OTA_DONT_STORE_PARAM                          }, eModelParamType_Object,      JSMN_OBJECT    },
+        { OTA_JSON_STREAM_NAME_KEY,     OTA_JOB_PARAM_OTA_UNIT,       OTA_JOB_PARAM_OPTIONAL, { offsetof( OTA_FileContext_t, pucStreamName )  }, eModelParamType_StringCopy,  JSMN_STRING    },
+        { OTA_JSON_PROTOCOLS_KEY,       OTA_JOB_PARAM_OTA_UNIT,       OTA_JOB_PARAM_REQUIRED, { offsetof( OTA_FileContext_t, pucProtocols )   }, eModelParamType_ArrayCopy,   JSMN_ARRAY     },
+        { OTA_JSON_FILE_GROUP_KEY,      OTA_JOB_PARAM_OTA_UNIT,       OTA_JOB_PARAM_REQUIRED, { OTA_DONT_STORE_PARAM                          }, eModelParamType_Array,       JSMN_ARRAY     },
+        { OTA_JSON_FILE_PATH_KEY,       OTA_JOB_PARAM_FILE_GROUP,     OTA_JOB_PARAM_REQUIRED, { offsetof( OTA_FileContext_t, pucFilePath )    }, eModelParamType_StringCopy,  JSMN_STRING    },
+        { OTA_JSON_FILE_SIZE_KEY,       OTA_JOB_PARAM_FILE_GROUP,     OTA_JOB_PARAM_REQUIRED, { offsetof( OTA_FileContext_t, ulFileSize )     }, eModelParamType_UInt32,      JSMN_PRIMITIVE },
+        { OTA_JSON_FILE_ID_KEY,         OTA_JOB_PARAM_FILE_GROUP,     OTA_JOB_PARAM_REQUIRED, { offsetof( OTA_FileContext_t, ulServerFileID ) }, eModelParamType_UInt32,      JSMN_PRIMITIVE },
+        { OTA_JSON_FILE_CERT_NAME_KEY,  OTA_JOB_PARAM_FILE_GROUP,     OTA_JOB_PARAM_REQUIRED, { offsetof( OTA_FileContext_t, pucCertFilepath )}, eModelParamType_StringCopy,  JSMN_STRING    },
+        { OTA_JSON_UPDATE_DATA_URL_KEY, OTA_JOB_PARAM_FILE_GROUP,     OTA_JOB_PARAM_OPTIONAL, { offsetof( OTA_FileContext_t, pucUpdateUrlPath )}, eModelParamType_StringCopy,  JSMN_STRING    },
+        { OTA_JSON_AUTH_SCHEME_KEY,     OTA_JOB_PARAM_FILE_GROUP,     OTA_JOB_PARAM_OPTIONAL, { offsetof( OTA_FileContext_t, pucAuthScheme )  }, eModelParamType_StringCopy,  JSMN_STRING    },
+        { cOTA_JSON_FileSignatureKey,   OTA_JOB_PARAM_FILE_GROUP,     OTA_JOB_PARAM_REQUIRED, { offsetof( OTA_FileContext_t, pxSignature )    }, eModelParamType_SigBase64,   JSMN_STRING    },
+        { OTA_JSON_FILE_ATTRIBUTE_KEY,  OTA_JOB_PARAM_FILE_GROUP,     OTA_JOB_PARAM_OPTIONAL, { offsetof( OTA_FileContext_t, ulFileAttributes )}, eModelParamType_UInt32,      JSMN_PRIMITIVE },
+        { OTA_JSON_PATCH_KEY,           OTA_JOB_PARAM_FILE_GROUP,     OTA_JOB_PARAM_OPTIONAL, { OTA_DONT_STORE_PARAM                          }, eModelParamType_Object,      JSMN_OBJECT    },
+        { OTA_JSON_IMAGE_SIZE_KEY,      OTA_JOB_PARAM_PATCH,          OTA_JOB_PARAM_OPTIONAL, { offsetof( OTA_FileContext_t, ulImageSize )    }, eModelParamType_UInt32,      JSMN_PRIMITIVE },
     };
 
     OTA_Err_t xOTAErr = kOTA_Err_None;
@@ -2339,9 +2684,7 @@ static OTA_FileContext_t * prvGetFileContextFromJob( const char * pcRawMsg,
 {
     DEFINE_OTA_METHOD_NAME( "prvGetFileContextFromJob" );
 
-    uint32_t ulIndex;
     uint32_t ulNumBlocks;              /* How many data pages are in the expected update image. */
-    uint32_t ulBitmapLen;              /* Length of the file block bitmap in bytes. */
     OTA_FileContext_t * pstUpdateFile; /* Pointer to an OTA update context. */
     OTA_Err_t xErr = kOTA_Err_Uninitialized;
 
@@ -2358,44 +2701,46 @@ static OTA_FileContext_t * prvGetFileContextFromJob( const char * pcRawMsg,
 
     if( ( bUpdateJob == false ) && ( pstUpdateFile != NULL ) && ( prvInSelftest() == false ) )
     {
-        if( pstUpdateFile->pucRxBlockBitmap != NULL )
+        if( pstUpdateFile->pxRxBlockTracker != NULL )
         {
-            vPortFree( pstUpdateFile->pucRxBlockBitmap ); /* Free any previously allocated bitmap. */
-            pstUpdateFile->pucRxBlockBitmap = NULL;
+            prvBlockTrackerDelete( pstUpdateFile->pxRxBlockTracker ); /* Free any previously allocated block tracker. */
+            pstUpdateFile->pxRxBlockTracker = NULL;
         }
 
-        /* Calculate how many bytes we need in our bitmap for tracking received blocks.
-         * The below calculation requires power of 2 page sizes. */
+        /* Calculate how many blocks the file has. The below calculation requires power of 2 page sizes.
+         * Blocks past the end of the file are never tracked so they can't be requested or accepted. */
 
         ulNumBlocks = ( pstUpdateFile->ulFileSize + ( OTA_FILE_BLOCK_SIZE - 1U ) ) >> otaconfigLOG2_FILE_BLOCK_SIZE;
-        ulBitmapLen = ( ulNumBlocks + ( BITS_PER_BYTE - 1U ) ) >> LOG2_BITS_PER_BYTE;
-        pstUpdateFile->pucRxBlockBitmap = ( uint8_t * ) pvPortMalloc( ulBitmapLen ); /*lint !e9079 FreeRTOS malloc port returns void*. */
+        pstUpdateFile->pxRxBlockTracker = prvBlockTrackerCreate( ulNumBlocks );
 
-        if( pstUpdateFile->pucRxBlockBitmap != NULL )
+        if( pstUpdateFile->pxRxBlockTracker != NULL )
         {
-            /* Set all bits in the bitmap to the erased state (we use 1 for erased just like flash memory). */
-            ( void ) memset( pstUpdateFile->pucRxBlockBitmap, ( int32_t ) OTA_ERASED_BLOCKS_VAL, ulBitmapLen );
-
-            /* Mark as used any pages in the bitmap that are out of range, based on the file size.
-             * This keeps us from requesting those pages during retry processing or if using a windowed
-             * block request. It also avoids erroneously accepting an out of range data block should it
-             * get past any safety checks.
-             * Files aren't always a multiple of 8 pages (8 bits/pages per byte) so some bits of the
-             * last byte may be out of range and those are the bits we want to clear. */
-
-            uint8_t ulBit = 1U << ( BITS_PER_BYTE - 1U );
-            uint32_t ulNumOutOfRange = ( ulBitmapLen * BITS_PER_BYTE ) - ulNumBlocks;
+            pstUpdateFile->ulBlocksRemaining = ulNumBlocks; /* Initialize our blocks remaining counter. */
+            xOTA_Agent.ulBlocksSinceCheckpoint = 0U;
 
-            for( ulIndex = 0U; ulIndex < ulNumOutOfRange; ulIndex++ )
+            if( prvCheckpointResume( pstUpdateFile ) == true )
             {
-                pstUpdateFile->pucRxBlockBitmap[ ulBitmapLen - 1U ] &= ~ulBit;
-                ulBit >>= 1U;
+                /* The blocks received before the interruption are not hashed again, so the PAL
+                 * reads the file back to check the signature. */
+                xErr = kOTA_Err_None;
             }
+            else
+            {
+                /* Any checkpoint left is for another file. */
+                prvCheckpointErase();
 
-            pstUpdateFile->ulBlocksRemaining = ulNumBlocks; /* Initialize our blocks remaining counter. */
+                #if ( OTA_STREAMING_SIGNATURE_VERIFICATION == 1 )
+                    prvStreamHashStart();
+                #endif
 
-            /* Create/Open the OTA file on the file system. */
-            xErr = xOTA_Agent.xPALCallbacks.xCreateFileForRx( pstUpdateFile );
+                xErr = prvDeltaStart( pstUpdateFile );
+
+                if( xErr == kOTA_Err_None )
+                {
+                    /* Create/Open the OTA file on the file system. */
+                    xErr = xOTA_Agent.xPALCallbacks.xCreateFileForRx( pstUpdateFile );
+                }
+            }
 
             if( xErr != kOTA_Err_None )
             {
@@ -2440,6 +2785,508 @@ static bool prvValidateDataBlock( const OTA_FileContext_t * C,
     return bRet;
 }
 
+#if ( OTA_STREAMING_SIGNATURE_VERIFICATION == 1 )
+
+/*
+ * prvStreamHashStart
+ *
+ * Start hashing the file that is about to be created for receiving. The algorithms are taken from the
+ * signature key of the PAL, e.g. "sig-sha256-ecdsa". If the hash can't be started, the PAL reads
+ * the file back to check the signature on close, as it does without streaming.
+ */
+    static void prvStreamHashStart( void )
+    {
+        DEFINE_OTA_METHOD_NAME( "prvStreamHashStart" );
+
+        OTA_StreamHash_t * pxHash = &xOTA_Agent.xStreamHash;
+        BaseType_t xAsymmetricAlgorithm = cryptoASYMMETRIC_ALGORITHM_ECDSA;
+        BaseType_t xHashAlgorithm = cryptoHASH_ALGORITHM_SHA256;
+
+        /* Drop anything left from a previous file. */
+        prvStreamHashRelease( NULL );
+
+        if( strstr( cOTA_JSON_FileSignatureKey, "rsa" ) != NULL )
+        {
+            xAsymmetricAlgorithm = cryptoASYMMETRIC_ALGORITHM_RSA;
+        }
+
+        if( strstr( cOTA_JSON_FileSignatureKey, "sha1" ) != NULL )
+        {
+            xHashAlgorithm = cryptoHASH_ALGORITHM_SHA1;
+        }
+
+        if( CRYPTO_SignatureVerificationStart( &pxHash->pvSigVerifyContext,
+                                               xAsymmetricAlgorithm,
+                                               xHashAlgorithm ) == pdFALSE )
+        {
+            OTA_LOG_L1( "[%s] Warning: Failed to start hashing the file, the signature will be checked on close.\r\n", OTA_METHOD_NAME );
+            pxHash->pvSigVerifyContext = NULL;
+        }
+    }
+
+/*
+ * prvStreamHashBlock
+ *
+ * Add a block that was written to the receive file to the hash. The hash is computed in file order,
+ * so a block received ahead of the hashed part of the file is kept in RAM until the blocks before it
+ * arrive. If there is no room to keep it, hashing is given up for this file.
+ */
+    static void prvStreamHashBlock( uint32_t ulBlockIndex,
+                                    const uint8_t * pucData,
+                                    uint32_t ulBlockSize )
+    {
+        DEFINE_OTA_METHOD_NAME( "prvStreamHashBlock" );
+
+        OTA_StreamHash_t * pxHash = &xOTA_Agent.xStreamHash;
+        OTA_PendingBlock_t * pxPending = NULL;
+        uint32_t ulIndex = 0U;
+
+        if( pxHash->pvSigVerifyContext == NULL )
+        {
+            /* Not hashing this file. */
+        }
+        else if( ulBlockIndex == pxHash->ulNextBlock )
+        {
+            CRYPTO_SignatureVerificationUpdate( pxHash->pvSigVerifyContext, pucData, ulBlockSize );
+            pxHash->ulNextBlock++;
+
+            /* Hash the kept blocks that now continue the hashed part of the file. */
+            while( ulIndex < OTA_STREAM_HASH_MAX_PENDING_BLOCKS )
+            {
+                pxPending = &pxHash->xPending[ ulIndex ];
+
+                if( ( pxPending->pucData != NULL ) && ( pxPending->ulBlockIndex == pxHash->ulNextBlock ) )
+                {
+                    CRYPTO_SignatureVerificationUpdate( pxHash->pvSigVerifyContext, pxPending->pucData, pxPending->ulBlockSize );
+                    vPortFree( pxPending->pucData );
+                    pxPending->pucData = NULL;
+                    pxHash->ulNextBlock++;
+
+                    /* The next block may be kept in an earlier entry, so start over. */
+                    ulIndex = 0U;
+                }
+                else
+                {
+                    ulIndex++;
+                }
+            }
+        }
+        else
+        {
+            /* Keep the block until the blocks before it are hashed. */
+            while( ( ulIndex < OTA_STREAM_HASH_MAX_PENDING_BLOCKS ) && ( pxHash->xPending[ ulIndex ].pucData != NULL ) )
+            {
+                ulIndex++;
+            }
+
+            if( ulIndex < OTA_STREAM_HASH_MAX_PENDING_BLOCKS )
+            {
+                pxPending = &pxHash->xPending[ ulIndex ];
+                pxPending->pucData = ( uint8_t * ) pvPortMalloc( ulBlockSize ); /*lint !e9079 FreeRTOS malloc port returns void*. */
+            }
+
+            if( ( pxPending != NULL ) && ( pxPending->pucData != NULL ) )
+            {
+                ( void ) memcpy( pxPending->pucData, pucData, ulBlockSize );
+                pxPending->ulBlockIndex = ulBlockIndex;
+                pxPending->ulBlockSize = ulBlockSize;
+            }
+            else
+            {
+                OTA_LOG_L1( "[%s] Warning: Can't keep block %u until block %u arrives, the signature will be checked on close.\r\n",
+                            OTA_METHOD_NAME, ulBlockIndex, pxHash->ulNextBlock );
+                prvStreamHashRelease( NULL );
+            }
+        }
+    }
+
+/*
+ * prvStreamHashFinish
+ *
+ * Hand the hash over to the PAL through the file context if it covers the whole file.
+ */
+    static void prvStreamHashFinish( OTA_FileContext_t * const C )
+    {
+        OTA_StreamHash_t * pxHash = &xOTA_Agent.xStreamHash;
+        uint32_t ulSize = ( C->ulImageSize != 0U ) ? C->ulImageSize : C->ulFileSize; /* A delta update hashes the rebuilt image. */
+        uint32_t ulNumBlocks = ( ulSize + ( OTA_FILE_BLOCK_SIZE - 1U ) ) >> otaconfigLOG2_FILE_BLOCK_SIZE;
+
+        if( ( pxHash->pvSigVerifyContext != NULL ) && ( pxHash->ulNextBlock == ulNumBlocks ) )
+        {
+            C->pvSigVerifyContext = pxHash->pvSigVerifyContext;
+            pxHash->pvSigVerifyContext = NULL;
+        }
+
+        prvStreamHashRelease( NULL );
+    }
+
+/*
+ * prvStreamHashRelease
+ *
+ * Free the hash of the agent, the blocks kept for it and, if C is not NULL, the hash handed over to
+ * the PAL in the file context. Passing only the context to CRYPTO_SignatureVerificationFinal() frees
+ * it without verifying anything.
+ */
+    static void prvStreamHashRelease( OTA_FileContext_t * const C )
+    {
+        OTA_StreamHash_t * pxHash = &xOTA_Agent.xStreamHash;
+        uint32_t ulIndex;
+
+        if( pxHash->pvSigVerifyContext != NULL )
+        {
+            ( void ) CRYPTO_SignatureVerificationFinal( pxHash->pvSigVerifyContext, NULL, 0, NULL, 0 );
+            pxHash->pvSigVerifyContext = NULL;
+        }
+
+        for( ulIndex = 0U; ulIndex < OTA_STREAM_HASH_MAX_PENDING_BLOCKS; ulIndex++ )
+        {
+            if( pxHash->xPending[ ulIndex ].pucData != NULL )
+            {
+                vPortFree( pxHash->xPending[ ulIndex ].pucData );
+                pxHash->xPending[ ulIndex ].pucData = NULL;
+            }
+        }
+
+        pxHash->ulNextBlock = 0U;
+
+        if( ( C != NULL ) && ( C->pvSigVerifyContext != NULL ) )
+        {
+            ( void ) CRYPTO_SignatureVerificationFinal( C->pvSigVerifyContext, NULL, 0, NULL, 0 );
+            C->pvSigVerifyContext = NULL;
+        }
+    }
+#endif /* if ( OTA_STREAMING_SIGNATURE_VERIFICATION == 1 ) */
+
+/*
+ * prvDeltaStart
+ *
+ * A delta update is rebuilt from the active image, so the PAL must be able to read it. Other files
+ * are written as they are received.
+ */
+static OTA_Err_t prvDeltaStart( const OTA_FileContext_t * C )
+{
+    DEFINE_OTA_METHOD_NAME( "prvDeltaStart" );
+
+    OTA_Err_t xErr = kOTA_Err_None;
+
+    /* Drop anything left from a previous file. */
+    prvDeltaStop();
+
+    if( C->ulImageSize == 0U )
+    {
+        /* Not a delta update. */
+    }
+    else if( xOTA_Agent.xPALCallbacks.xReadActiveImage == NULL )
+    {
+        OTA_LOG_L1( "[%s] Error: The PAL can't read the active image to apply a delta update.\r\n", OTA_METHOD_NAME );
+        xErr = kOTA_Err_DeltaUpdateFailed;
+    }
+    else
+    {
+        xOTA_Agent.pxDeltaApplier = prvDeltaCreate( C->ulImageSize,
+                                                    xOTA_Agent.xPALCallbacks.xReadActiveImage,
+                                                    xOTA_Agent.xPALCallbacks.xWriteBlock );
+
+        if( xOTA_Agent.pxDeltaApplier == NULL )
+        {
+            OTA_LOG_L1( "[%s] Error: No memory to apply a delta update.\r\n", OTA_METHOD_NAME );
+            xErr = kOTA_Err_OutOfMemory;
+        }
+        else
+        {
+            OTA_LOG_L1( "[%s] Rebuilding a %u byte image from a %u byte patch.\r\n", OTA_METHOD_NAME,
+                        C->ulImageSize,
+                        C->ulFileSize );
+        }
+    }
+
+    return xErr;
+}
+
+static void prvDeltaStop( void )
+{
+    if( xOTA_Agent.pxDeltaApplier != NULL )
+    {
+        prvDeltaDelete( xOTA_Agent.pxDeltaApplier );
+        xOTA_Agent.pxDeltaApplier = NULL;
+    }
+}
+
+OTA_DeltaApplier_t * prvDeltaCreate( uint32_t ulImageSize,
+                                     pxOTAPALReadActiveImageCallback_t xReadActiveImage,
+                                     pxOTAPALWriteBlockCallback_t xWriteBlock )
+{
+    OTA_DeltaApplier_t * pxDelta = ( OTA_DeltaApplier_t * ) pvPortMalloc( sizeof( OTA_DeltaApplier_t ) ); /*lint !e9079 FreeRTOS malloc port returns void*. */
+
+    if( pxDelta != NULL )
+    {
+        ( void ) memset( pxDelta, 0, sizeof( OTA_DeltaApplier_t ) );
+        pxDelta->xReadActiveImage = xReadActiveImage;
+        pxDelta->xWriteBlock = xWriteBlock;
+        pxDelta->ulImageSize = ulImageSize;
+        pxDelta->eState = eDeltaState_Header;
+    }
+
+    return pxDelta;
+}
+
+void prvDeltaDelete( OTA_DeltaApplier_t * pxDelta )
+{
+    vPortFree( pxDelta );
+}
+
+/* Decode a number of the patch. Returns false if its magnitude doesn't fit in 32 bits. */
+static bool prvDeltaDecodeNumber( const uint8_t * pucNumber,
+                                  uint32_t * pulMagnitude,
+                                  bool * pbNegative )
+{
+    bool bValid = false;
+
+    if( ( pucNumber[ 4 ] == 0U ) && ( pucNumber[ 5 ] == 0U ) && ( pucNumber[ 6 ] == 0U ) && ( ( pucNumber[ 7 ] & 0x7fU ) == 0U ) )
+    {
+        *pulMagnitude = ( uint32_t ) pucNumber[ 0 ] |
+                        ( ( uint32_t ) pucNumber[ 1 ] << 8 ) |
+                        ( ( uint32_t ) pucNumber[ 2 ] << 16 ) |
+                        ( ( uint32_t ) pucNumber[ 3 ] << 24 );
+        *pbNegative = ( ( pucNumber[ 7 ] & 0x80U ) != 0U ) && ( *pulMagnitude != 0U );
+        bValid = true;
+    }
+
+    return bValid;
+}
+
+/* Pick what the next patch bytes are from what is left of the current record. Once the record is
+ * done, move to the position in the active image the next record starts at. */
+static OTA_DeltaState_t prvDeltaNextState( OTA_DeltaApplier_t * pxDelta )
+{
+    OTA_DeltaState_t eState = eDeltaState_Control;
+
+    if( pxDelta->ulDiffLeft > 0U )
+    {
+        eState = eDeltaState_Diff;
+    }
+    else if( pxDelta->ulExtraLeft > 0U )
+    {
+        eState = eDeltaState_Extra;
+    }
+    else
+    {
+        pxDelta->ulSourceOffset = pxDelta->ulNextSourceOffset;
+    }
+
+    return eState;
+}
+
+static OTA_DeltaState_t prvDeltaParseHeader( OTA_DeltaApplier_t * pxDelta )
+{
+    DEFINE_OTA_METHOD_NAME( "prvDeltaParseHeader" );
+
+    OTA_DeltaState_t eState = eDeltaState_Error;
+    uint32_t ulNewSize = 0U;
+    bool bNegative = false;
+
+    if( memcmp( pxDelta->ucField, OTA_DELTA_MAGIC, OTA_DELTA_MAGIC_SIZE ) != 0 )
+    {
+        OTA_LOG_L1( "[%s] Error: The file is not a delta patch.\r\n", OTA_METHOD_NAME );
+    }
+    else if( ( prvDeltaDecodeNumber( &pxDelta->ucField[ OTA_DELTA_MAGIC_SIZE ], &ulNewSize, &bNegative ) == false ) ||
+             ( bNegative == true ) ||
+             ( ulNewSize != pxDelta->ulImageSize ) )
+    {
+        OTA_LOG_L1( "[%s] Error: The patch doesn't rebuild a %u byte image.\r\n", OTA_METHOD_NAME, pxDelta->ulImageSize );
+    }
+    else
+    {
+        eState = eDeltaState_Control;
+    }
+
+    return eState;
+}
+
+static OTA_DeltaState_t prvDeltaParseControl( OTA_DeltaApplier_t * pxDelta )
+{
+    DEFINE_OTA_METHOD_NAME( "prvDeltaParseControl" );
+
+    OTA_DeltaState_t eState = eDeltaState_Error;
+    uint32_t ulImageLeft = pxDelta->ulImageSize - ( pxDelta->ulImageOffset + pxDelta->ulBufferLen );
+    uint32_t ulDiff = 0U, ulExtra = 0U, ulSeek = 0U, ulSourceEnd = 0U;
+    bool bDiffNegative = false, bExtraNegative = false, bSeekBack = false;
+
+    if( ( prvDeltaDecodeNumber( &pxDelta->ucField[ 0 ], &ulDiff, &bDiffNegative ) == false ) ||
+        ( prvDeltaDecodeNumber( &pxDelta->ucField[ OTA_DELTA_NUMBER_SIZE ], &ulExtra, &bExtraNegative ) == false ) ||
+        ( prvDeltaDecodeNumber( &pxDelta->ucField[ 2U * OTA_DELTA_NUMBER_SIZE ], &ulSeek, &bSeekBack ) == false ) ||
+        ( bDiffNegative == true ) || ( bExtraNegative == true ) )
+    {
+        OTA_LOG_L1( "[%s] Error: Bad patch record.\r\n", OTA_METHOD_NAME );
+    }
+    else if( ( ulDiff > ulImageLeft ) || ( ulExtra > ( ulImageLeft - ulDiff ) ) )
+    {
+        OTA_LOG_L1( "[%s] Error: The patch goes past the end of the image.\r\n", OTA_METHOD_NAME );
+    }
+    else if( ulDiff > ( UINT32_MAX - pxDelta->ulSourceOffset ) )
+    {
+        OTA_LOG_L1( "[%s] Error: The patch reads past the end of the active image.\r\n", OTA_METHOD_NAME );
+    }
+    else
+    {
+        ulSourceEnd = pxDelta->ulSourceOffset + ulDiff;
+
+        if( ( bSeekBack == true ) ? ( ulSeek > ulSourceEnd ) : ( ulSeek > ( UINT32_MAX - ulSourceEnd ) ) )
+        {
+            OTA_LOG_L1( "[%s] Error: The patch seeks outside of the active image.\r\n", OTA_METHOD_NAME );
+        }
+        else
+        {
+            pxDelta->ulDiffLeft = ulDiff;
+            pxDelta->ulExtraLeft = ulExtra;
+            pxDelta->ulNextSourceOffset = ( bSeekBack == true ) ? ( ulSourceEnd - ulSeek ) : ( ulSourceEnd + ulSeek );
+            eState = prvDeltaNextState( pxDelta );
+        }
+    }
+
+    return eState;
+}
+
+/* Write the block of the new image rebuilt so far. */
+static OTA_Err_t prvDeltaFlush( OTA_DeltaApplier_t * pxDelta,
+                                OTA_FileContext_t * C )
+{
+    DEFINE_OTA_METHOD_NAME( "prvDeltaFlush" );
+
+    OTA_Err_t xErr = kOTA_Err_None;
+    int16_t sBytesWritten = 0;
+
+    if( pxDelta->ulBufferLen > 0U )
+    {
+        sBytesWritten = pxDelta->xWriteBlock( C, pxDelta->ulImageOffset, pxDelta->ucBuffer, pxDelta->ulBufferLen );
+
+        if( sBytesWritten < 0 )
+        {
+            OTA_LOG_L1( "[%s] Error (%d) writing image block\r\n", OTA_METHOD_NAME, sBytesWritten );
+            xErr = kOTA_Err_DeltaUpdateFailed;
+        }
+        else
+        {
+            #if ( OTA_STREAMING_SIGNATURE_VERIFICATION == 1 )
+                /* The new image is rebuilt in order, one block at a time. */
+                prvStreamHashBlock( pxDelta->ulImageOffset >> otaconfigLOG2_FILE_BLOCK_SIZE, pxDelta->ucBuffer, pxDelta->ulBufferLen );
+            #endif
+
+            pxDelta->ulImageOffset += pxDelta->ulBufferLen;
+            pxDelta->ulBufferLen = 0U;
+        }
+    }
+
+    return xErr;
+}
+
+OTA_Err_t prvDeltaApply( OTA_DeltaApplier_t * pxDelta,
+                         OTA_FileContext_t * C,
+                         const uint8_t * pucPatch,
+                         uint32_t ulSize )
+{
+    DEFINE_OTA_METHOD_NAME( "prvDeltaApply" );
+
+    uint32_t ulIndex = 0U;
+    uint32_t ulCount = 0U;
+    uint32_t ulByte = 0U;
+    uint8_t * pucOut = NULL;
+
+    while( ( ulIndex < ulSize ) && ( pxDelta->eState != eDeltaState_Error ) )
+    {
+        if( ( pxDelta->eState == eDeltaState_Header ) || ( pxDelta->eState == eDeltaState_Control ) )
+        {
+            /* The header and the control triples have the same size and may span patch blocks. */
+            ulCount = OTA_DELTA_HEADER_SIZE - pxDelta->ulFieldLen;
+            ulCount = ( ulCount < ( ulSize - ulIndex ) ) ? ulCount : ( ulSize - ulIndex );
+            ( void ) memcpy( &pxDelta->ucField[ pxDelta->ulFieldLen ], &pucPatch[ ulIndex ], ulCount );
+            pxDelta->ulFieldLen += ulCount;
+            ulIndex += ulCount;
+
+            if( pxDelta->ulFieldLen == OTA_DELTA_HEADER_SIZE )
+            {
+                pxDelta->ulFieldLen = 0U;
+                pxDelta->eState = ( pxDelta->eState == eDeltaState_Header ) ? prvDeltaParseHeader( pxDelta ) : prvDeltaParseControl( pxDelta );
+            }
+        }
+        else
+        {
+            /* Take as much diff or extra data as the record, the patch data and the image block allow. */
+            ulCount = ( pxDelta->eState == eDeltaState_Diff ) ? pxDelta->ulDiffLeft : pxDelta->ulExtraLeft;
+            ulCount = ( ulCount < ( ulSize - ulIndex ) ) ? ulCount : ( ulSize - ulIndex );
+            ulCount = ( ulCount < ( OTA_FILE_BLOCK_SIZE - pxDelta->ulBufferLen ) ) ? ulCount : ( OTA_FILE_BLOCK_SIZE - pxDelta->ulBufferLen );
+            pucOut = &pxDelta->ucBuffer[ pxDelta->ulBufferLen ];
+
+            if( pxDelta->eState == eDeltaState_Extra )
+            {
+                ( void ) memcpy( pucOut, &pucPatch[ ulIndex ], ulCount );
+                pxDelta->ulExtraLeft -= ulCount;
+            }
+            else if( pxDelta->xReadActiveImage( pxDelta->ulSourceOffset, pucOut, ulCount ) == kOTA_Err_None )
+            {
+                /* Diff data is added byte by byte to the active image. */
+                for( ulByte = 0U; ulByte < ulCount; ulByte++ )
+                {
+                    pucOut[ ulByte ] = ( uint8_t ) ( pucOut[ ulByte ] + pucPatch[ ulIndex + ulByte ] );
+                }
+
+                pxDelta->ulSourceOffset += ulCount;
+                pxDelta->ulDiffLeft -= ulCount;
+            }
+            else
+            {
+                OTA_LOG_L1( "[%s] Error: Failed to read %u bytes at offset %u of the active image.\r\n", OTA_METHOD_NAME,
+                            ulCount,
+                            pxDelta->ulSourceOffset );
+                pxDelta->eState = eDeltaState_Error;
+            }
+
+            if( pxDelta->eState != eDeltaState_Error )
+            {
+                ulIndex += ulCount;
+                pxDelta->ulBufferLen += ulCount;
+
+                if( ( pxDelta->ulBufferLen == OTA_FILE_BLOCK_SIZE ) && ( prvDeltaFlush( pxDelta, C ) != kOTA_Err_None ) )
+                {
+                    pxDelta->eState = eDeltaState_Error;
+                }
+                else
+                {
+                    pxDelta->eState = prvDeltaNextState( pxDelta );
+                }
+            }
+        }
+    }
+
+    return ( pxDelta->eState == eDeltaState_Error ) ? kOTA_Err_DeltaUpdateFailed : kOTA_Err_None;
+}
+
+OTA_Err_t prvDeltaFinish( OTA_DeltaApplier_t * pxDelta,
+                          OTA_FileContext_t * C )
+{
+    DEFINE_OTA_METHOD_NAME( "prvDeltaFinish" );
+
+    OTA_Err_t xErr = kOTA_Err_DeltaUpdateFailed;
+
+    if( ( pxDelta->eState == eDeltaState_Control ) && ( pxDelta->ulFieldLen == 0U ) &&
+        ( ( pxDelta->ulImageOffset + pxDelta->ulBufferLen ) == pxDelta->ulImageSize ) )
+    {
+        xErr = prvDeltaFlush( pxDelta, C );
+    }
+    else if( pxDelta->eState != eDeltaState_Error )
+    {
+        OTA_LOG_L1( "[%s] Error: The patch ended after %u of %u bytes of the image.\r\n", OTA_METHOD_NAME,
+                    pxDelta->ulImageOffset + pxDelta->ulBufferLen,
+                    pxDelta->ulImageSize );
+    }
+    else
+    {
+        /* The error was logged when it happened. */
+    }
+
+    return xErr;
+}
+
 /*
  * prvIngestDataBlock
  *
@@ -2465,8 +3312,6 @@ static IngestResult_t prvIngestDataBlock( OTA_FileContext_t * C,
     uint32_t ulBlockIndex = 0;
     uint8_t * pucPayload = NULL;
     size_t xPayloadSize = 0;
-    uint32_t ulByte = 0;
-    uint8_t ucBitMask = 0;
 
     /* Check if the file context is NULL. */
     if( C == NULL )
@@ -2491,8 +3336,8 @@ static IngestResult_t prvIngestDataBlock( OTA_FileContext_t * C,
     /* Decode the received data block. */
     if( eIngestResult == eIngest_Result_Uninitialized )
     {
-        /* If we have a block bitmap available then process the message. */
-        if( ( C->pucRxBlockBitmap != NULL ) && ( C->ulBlocksRemaining > 0U ) )
+        /* If we have a block tracker available then process the message. */
+        if( ( C->pxRxBlockTracker != NULL ) && ( C->ulBlocksRemaining > 0U ) )
         {
             /* Reset or start the firmware request timer. */
             prvStartRequestTimer( otaconfigFILE_REQUEST_WAIT_MS );
@@ -2528,14 +3373,8 @@ static IngestResult_t prvIngestDataBlock( OTA_FileContext_t * C,
         {
             OTA_LOG_L1( "[%s] Received file block %u, size %u\r\n", OTA_METHOD_NAME, ulBlockIndex, ulBlockSize );
 
-            /* Create bit mask for use in our bitmap. */
-            ucBitMask = 1U << ( ulBlockIndex % BITS_PER_BYTE ); /*lint !e9031 The composite expression will never be greater than BITS_PER_BYTE(8). */
-
-            /* Calculate byte offset into bitmap. */
-            ulByte = ulBlockIndex >> LOG2_BITS_PER_BYTE;
-
             /* Check if we've already received this block. */
-            if( ( ( C->pucRxBlockBitmap[ ulByte ] ) & ucBitMask ) == 0U )
+            if( prvBlockTrackerIsMissing( C->pxRxBlockTracker, ulBlockIndex ) == false )
             {
                 OTA_LOG_L1( "[%s] block %u is a DUPLICATE. %u blocks remaining.\r\n", OTA_METHOD_NAME,
                             ulBlockIndex,
@@ -2544,6 +3383,34 @@ static IngestResult_t prvIngestDataBlock( OTA_FileContext_t * C,
                 eIngestResult = eIngest_Result_Duplicate_Continue;
                 *pxCloseResult = kOTA_Err_None; /* This is a success path. */
             }
+            else if( ( xOTA_Agent.pxDeltaApplier != NULL ) &&
+                     ( C->pxRxBlockTracker->xRanges[ 0 ].ulStart != ulBlockIndex ) )
+            {
+                /* A delta patch is applied in order. The block is missing so the tracker is not empty
+                 * and its first run starts with the next block of the patch. */
+                OTA_LOG_L1( "[%s] block %u is ahead of the patch, dropping it. %u blocks remaining.\r\n", OTA_METHOD_NAME,
+                            ulBlockIndex,
+                            C->ulBlocksRemaining );
+
+                eIngestResult = eIngest_Result_Dropped_Continue;
+                *pxCloseResult = kOTA_Err_None; /* This is a success path. */
+            }
+            else if( prvBlockTrackerMarkReceived( C->pxRxBlockTracker, ulBlockIndex ) == false )
+            {
+                /* Recording the block would need more runs than the tracker holds. Drop it, it will
+                 * be requested again once the runs around it are received. */
+                OTA_LOG_L1( "[%s] block %u can't be tracked, dropping it. %u blocks remaining.\r\n", OTA_METHOD_NAME,
+                            ulBlockIndex,
+                            C->ulBlocksRemaining );
+
+                eIngestResult = eIngest_Result_Dropped_Continue;
+                *pxCloseResult = kOTA_Err_None; /* This is a success path. */
+            }
+            else
+            {
+                /* The block is new and now marked as received. A write failure below aborts the
+                 * file so there is no need to undo this. */
+            }
         }
         else
         {
@@ -2555,7 +3422,23 @@ static IngestResult_t prvIngestDataBlock( OTA_FileContext_t * C,
     /* Process the received data block. */
     if( eIngestResult == eIngest_Result_Uninitialized )
     {
-        if( C->pucFile != NULL )
+        if( ( C->pucFile != NULL ) && ( xOTA_Agent.pxDeltaApplier != NULL ) )
+        {
+            /* The PAL is given the blocks of the new image rebuilt from the patch, not the patch. */
+            *pxCloseResult = prvDeltaApply( xOTA_Agent.pxDeltaApplier, C, pucPayload, ulBlockSize );
+
+            if( *pxCloseResult != kOTA_Err_None )
+            {
+                OTA_LOG_L1( "[%s] Error (0x%08x) applying patch block %u\r\n", OTA_METHOD_NAME, *pxCloseResult, ulBlockIndex );
+                eIngestResult = eIngest_Result_WriteBlockFailed;
+            }
+            else
+            {
+                C->ulBlocksRemaining--;
+                eIngestResult = eIngest_Result_Accepted_Continue;
+            }
+        }
+        else if( C->pucFile != NULL )
         {
             int32_t iBytesWritten = xOTA_Agent.xPALCallbacks.xWriteBlock( C, ( ulBlockIndex * OTA_FILE_BLOCK_SIZE ), pucPayload, ulBlockSize );
 
@@ -2566,10 +3449,13 @@ static IngestResult_t prvIngestDataBlock( OTA_FileContext_t * C,
             }
             else
             {
-                C->pucRxBlockBitmap[ ulByte ] &= ~ucBitMask; /* Mark this block as received in our bitmap. */
                 C->ulBlocksRemaining--;
                 eIngestResult = eIngest_Result_Accepted_Continue;
                 *pxCloseResult = kOTA_Err_None;
+
+                #if ( OTA_STREAMING_SIGNATURE_VERIFICATION == 1 )
+                    prvStreamHashBlock( ulBlockIndex, pucPayload, ulBlockSize );
+                #endif
             }
         }
         else
@@ -2586,14 +3472,39 @@ static IngestResult_t prvIngestDataBlock( OTA_FileContext_t * C,
         {
             OTA_LOG_L1( "[%s] Received final expected block of file.\r\n", OTA_METHOD_NAME );
 
-            prvStopRequestTimer();            /* Don't request any more since we're done. */
-            vPortFree( C->pucRxBlockBitmap ); /* Free the bitmap now that we're done with the download. */
-            C->pucRxBlockBitmap = NULL;
+            prvStopRequestTimer();                        /* Don't request any more since we're done. */
+            prvBlockTrackerDelete( C->pxRxBlockTracker ); /* Free the tracker now that we're done with the download. */
+            C->pxRxBlockTracker = NULL;
 
-            if( C->pucFile != NULL )
+            if( xOTA_Agent.pxDeltaApplier != NULL )
             {
+                *pxCloseResult = prvDeltaFinish( xOTA_Agent.pxDeltaApplier, C );
+                prvDeltaStop();
+
+                if( *pxCloseResult != kOTA_Err_None )
+                {
+                    /* The file is left open, it is aborted when the context is closed. */
+                    OTA_LOG_L1( "[%s] Error (0x%08x) finishing the patch.\r\n", OTA_METHOD_NAME, *pxCloseResult );
+                    eIngestResult = eIngest_Result_FileCloseFail;
+                }
+            }
+
+            if( eIngestResult != eIngest_Result_Accepted_Continue )
+            {
+                /* The new image is incomplete. */
+            }
+            else if( C->pucFile != NULL )
+            {
+                #if ( OTA_STREAMING_SIGNATURE_VERIFICATION == 1 )
+                    prvStreamHashFinish( C );
+                #endif
+
                 *pxCloseResult = xOTA_Agent.xPALCallbacks.xCloseFile( C );
 
+                #if ( OTA_STREAMING_SIGNATURE_VERIFICATION == 1 )
+                    prvStreamHashRelease( C ); /* Free the hash if the PAL did not use it. */
+                #endif
+
                 if( *pxCloseResult == kOTA_Err_None )
                 {
                     OTA_LOG_L1( "[%s] File receive complete and signature is valid.\r\n", OTA_METHOD_NAME );
@@ -2679,10 +3590,17 @@ static void prvAgentShutdownCleanup( void )
     }
 
     /*
-     * Close any open OTA transfers.
+     * Close any open OTA transfers. The progress of a download that is not finished is saved first
+     * so it can be resumed once the agent is started again.
      */
     for( ulIndex = 0; ulIndex < OTA_MAX_FILES; ulIndex++ )
     {
+        if( ( xOTA_Agent.pxOTA_Files[ ulIndex ].pxRxBlockTracker != NULL ) &&
+            ( xOTA_Agent.ulBlocksSinceCheckpoint > 0U ) )
+        {
+            prvCheckpointSave( &xOTA_Agent.pxOTA_Files[ ulIndex ] );
+        }
+
         ( void ) prvOTA_Close( &xOTA_Agent.pxOTA_Files[ ulIndex ] );
     }
 
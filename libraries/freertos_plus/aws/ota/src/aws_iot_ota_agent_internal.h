@@ -35,6 +35,9 @@
 #include "aws_ota_agent_config.h"
 #include "jsmn.h"
 
+/* JSON utilities include. */
+#include "iot_json_utils.h"
+
 /* FreeRTOS includes. */
 #include "FreeRTOS.h"
 #include "event_groups.h"
@@ -46,23 +49,71 @@
 #define BITS_PER_BYTE                ( 1UL << LOG2_BITS_PER_BYTE )                     /* Number of bits in a byte. This is used by the block bitmap implementation. */
 #define OTA_FILE_BLOCK_SIZE          ( 1UL << otaconfigLOG2_FILE_BLOCK_SIZE )          /* Data section size of the file data block message (excludes the header). */
 #define OTA_MAX_FILES                1U                                                /* [MUST REMAIN 1! Future support.] Maximum number of concurrent OTA files. */
-#define OTA_MAX_BLOCK_BITMAP_SIZE    128U                                              /* Max allowed number of bytes to track all blocks of an OTA file. Adjust block size if more range is needed. */
+#define OTA_MAX_BLOCK_BITMAP_SIZE    128U                                              /* Max number of bytes of the block bitmap sent in a single stream request. */
 #define OTA_REQUEST_MSG_MAX_SIZE     ( 3U * OTA_MAX_BLOCK_BITMAP_SIZE )
 #define OTA_REQUEST_URL_MAX_SIZE     ( 1500 )
-#define OTA_ERASED_BLOCKS_VAL        0xffU                 /* The starting state of a group of erased blocks in the Rx block bitmap. */
 #ifdef configOTA_NUM_MSG_Q_ENTRIES
     #define OTA_NUM_MSG_Q_ENTRIES    configOTA_NUM_MSG_Q_ENTRIES
 #else
     #define OTA_NUM_MSG_Q_ENTRIES    20U                   /* Maximum number of entries in the OTA message queue. */
 #endif
 
+/* Maximum number of runs of missing blocks the block tracker of a file can hold. The tracker uses
+ * 8 bytes per run whatever the size of the file. A received block that would split a run when all
+ * of them are in use is dropped and requested again later. Must be at least 1. */
+#ifdef otaconfigMAX_NUM_BLOCK_RANGES
+    #define OTA_MAX_BLOCK_RANGES    otaconfigMAX_NUM_BLOCK_RANGES
+#else
+    #define OTA_MAX_BLOCK_RANGES    32U
+#endif
+
+/* Number of blocks received between two checkpoints of the download progress. Checkpoints are only
+ * saved if the PAL provides the checkpoint callbacks, see OTA_PAL_Callbacks_t. After a reset or a
+ * lost connection, at most this many blocks are downloaded again. */
+#ifdef otaconfigCHECKPOINT_INTERVAL_BLOCKS
+    #define OTA_CHECKPOINT_INTERVAL_BLOCKS    otaconfigCHECKPOINT_INTERVAL_BLOCKS
+#else
+    #define OTA_CHECKPOINT_INTERVAL_BLOCKS    32U
+#endif
+
+#define OTA_CHECKPOINT_MAGIC               0x4f544143UL /* "OTAC", marks a checkpoint written by this agent. */
+#define OTA_CHECKPOINT_JOB_NAME_MAX_LEN    64U          /* Longest job name a checkpoint can hold. Downloads of jobs with longer names are not checkpointed. */
+
+/* Streaming signature verification. When enabled, the agent hashes the file in order as blocks are
+ * received and hands the hash to the PAL on close, so the signature can be checked without reading
+ * the whole file back from storage. */
+#ifdef otaconfigSTREAMING_SIGNATURE_VERIFICATION
+    #define OTA_STREAMING_SIGNATURE_VERIFICATION    otaconfigSTREAMING_SIGNATURE_VERIFICATION
+#else
+    #define OTA_STREAMING_SIGNATURE_VERIFICATION    0
+#endif
+
+/* Maximum number of blocks received ahead of the hashed part of the file that are kept in RAM until
+ * the blocks before them arrive. If more are needed, streaming is given up for the file and the PAL
+ * reads the file back to check the signature. Must be at least 1. */
+#ifdef otaconfigSTREAM_HASH_MAX_PENDING_BLOCKS
+    #define OTA_STREAM_HASH_MAX_PENDING_BLOCKS    otaconfigSTREAM_HASH_MAX_PENDING_BLOCKS
+#else
+    #define OTA_STREAM_HASH_MAX_PENDING_BLOCKS    4U
+#endif
+
+/* Delta updates. The patch is in the uncompressed format of bsdiff 4.3 ("ENDSLEY/BSDIFF43"): a header
+ * with the size of the new image, then records of a control triple (length of the diff data, length of
+ * the extra data, seek in the active image) followed by that diff and extra data. All numbers are 64 bit
+ * little endian with the sign in the top bit. The records are applied in patch order, so the patch is
+ * accepted in order and only one block of the new image is held in RAM. */
+#define OTA_DELTA_MAGIC                "ENDSLEY/BSDIFF43"
+#define OTA_DELTA_MAGIC_SIZE           16U
+#define OTA_DELTA_NUMBER_SIZE          8U                                                 /* Size of a number in the patch. */
+#define OTA_DELTA_HEADER_SIZE          ( OTA_DELTA_MAGIC_SIZE + OTA_DELTA_NUMBER_SIZE )   /* Magic and size of the new image. */
+#define OTA_DELTA_CONTROL_SIZE         ( 3U * OTA_DELTA_NUMBER_SIZE )                     /* Diff length, extra length and seek. Same size as the header. */
+
 /* Job document parser constants. */
-#define OTA_MAX_JSON_TOKENS         64U                                                                         /* Number of JSON tokens supported in a single parser call. */
-#define OTA_MAX_JSON_STR_LEN        256U                                                                        /* Limit our JSON string compares to something small to avoid going into the weeds. */
 #define OTA_DOC_MODEL_MAX_PARAMS    32U                                                                         /* The parameter list is backed by a 32 bit longword bitmap by design. */
 #define OTA_JOB_PARAM_REQUIRED      true                                                                        /* Used to denote a required document model parameter. */
 #define OTA_JOB_PARAM_OPTIONAL      false                                                                       /* Used to denote an optional document model parameter. */
 #define OTA_DONT_STORE_PARAM        0xffffffffUL                                                                /* If ulDestOffset in the model is 0xffffffff, do not store the value. */
+#define OTA_JOB_PARAM_ROOT          IOT_JSON_QUERY_ROOT                                                         /* Used to denote a parameter in the top level object of a document. */
 #define OTA_DATA_BLOCK_SIZE         ( ( 1U << otaconfigLOG2_FILE_BLOCK_SIZE ) + OTA_REQUEST_URL_MAX_SIZE + 30 ) /* Header is 19 bytes.*/
 
 
@@ -91,6 +142,7 @@ typedef enum
     eIngest_Result_Uninitialized = -127,    /* Software BUG: We forgot to set the result code. */
     eIngest_Result_Accepted_Continue = 0,   /* The block was accepted and we're expecting more. */
     eIngest_Result_Duplicate_Continue = 1,  /* The block was a duplicate but that's OK. Continue. */
+    eIngest_Result_Dropped_Continue = 2,    /* The block could not be tracked so it was dropped. It will be requested again. Continue. */
 } IngestResult_t;
 
 /* Generic JSON document parser errors. */
@@ -136,6 +188,10 @@ typedef enum
  * locally when it is extracted from the JSON document. It also contains the
  * expected Jasmine type of the value field for validation.
  *
+ * A key is only matched in the object named by sParentParam, so the model describes
+ * the full key path of every parameter, e.g. execution.jobDocument.afr_ota.files.
+ * Keys under an array parameter are matched in the objects of that array.
+ *
  * NOTE: The ulDestOffset field may be either an offset into the models context structure
  *       or an absolute memory pointer, although it is usually an offset.
  *       If the value of ulDestOffset is less than the size of the context structure,
@@ -147,8 +203,9 @@ typedef enum
  */
 typedef struct
 {
-    const char * pcSrcKey; /* Expected key name. */
-    const bool bRequired;  /* If true, this parameter must exist in the document. */
+    const char * pcSrcKey;      /* Expected key name. */
+    const int16_t sParentParam; /* Index of the parameter whose value holds this key, or OTA_JOB_PARAM_ROOT. */
+    const bool bRequired;       /* If true, this parameter must exist in the document. */
     union
     {
         const uint32_t ulDestOffset;        /* Pointer or offset to where we'll store the value, if not ~0. */
@@ -205,7 +262,15 @@ enum
  * size, attributes, etc. The following value specifies the number of parameters
  * that are included in the job document model although some may be optional. */
 
-#define OTA_NUM_JOB_PARAMS              ( 20 ) /* Number of parameters in the job document. */
+#define OTA_NUM_JOB_PARAMS              ( 22 ) /* Number of parameters in the job document. */
+
+/* Indices of the job document parameters that hold other parameters. */
+#define OTA_JOB_PARAM_EXECUTION         ( 2 )
+#define OTA_JOB_PARAM_STATUS_DETAILS    ( 4 )
+#define OTA_JOB_PARAM_JOB_DOC           ( 7 )
+#define OTA_JOB_PARAM_OTA_UNIT          ( 8 )
+#define OTA_JOB_PARAM_FILE_GROUP        ( 11 )
+#define OTA_JOB_PARAM_PATCH             ( 20 )
 
 /* Keys in OTA job doc . */
 #define OTA_JSON_CLIENT_TOKEN_KEY       "clientToken"
@@ -227,6 +292,8 @@ enum
 #define OTA_JSON_FILE_CERT_NAME_KEY     "certfile"
 #define OTA_JSON_UPDATE_DATA_URL_KEY    "update_data_url"
 #define OTA_JSON_AUTH_SCHEME_KEY        "auth_scheme"
+#define OTA_JSON_PATCH_KEY              "patch"
+#define OTA_JSON_IMAGE_SIZE_KEY         "imagesize"
 
 /* This is the OTA statistics structure to hold useful info. */
 
@@ -238,8 +305,92 @@ typedef struct ota_agent_statistics
     uint32_t ulOTA_PacketsDropped;   /* Number of OTA packets dropped due to congestion. */
 } OTA_AgentStatistics_t;
 
+/* A run of consecutive blocks of a file that are not received yet. */
+
+typedef struct
+{
+    uint32_t ulStart; /* Index of the first missing block of the run. */
+    uint32_t ulEnd;   /* Index one past the last missing block of the run. */
+} OTA_BlockRange_t;
+
+/* Blocks of a file that are not received yet, kept as sorted, non adjacent runs so the memory used
+ * depends on how fragmented the download is rather than on the size of the file. */
+
+struct OTA_BlockTracker
+{
+    uint32_t ulNumRanges;                           /* Number of runs in use. */
+    OTA_BlockRange_t xRanges[ OTA_MAX_BLOCK_RANGES ]; /* Runs of missing blocks in ascending order. */
+};
+
+/* Download progress of a file, saved through the PAL so an interrupted download can be resumed.
+ * It is stored as is, so a checkpoint written by a build with a different layout is rejected by
+ * its size. */
+
+typedef struct
+{
+    uint32_t ulMagic;                                          /* OTA_CHECKPOINT_MAGIC. */
+    uint32_t ulChecksum;                                       /* Checksum of the checkpoint with this field set to 0. */
+    uint32_t ulServerFileID;                                   /* The file ID in the OTA job. */
+    uint32_t ulFileSize;                                       /* Size of the file in bytes. */
+    uint32_t ulBlockSize;                                      /* Size of a file block in bytes. */
+    uint8_t ucJobName[ OTA_CHECKPOINT_JOB_NAME_MAX_LEN + 1U ]; /* Job name + zero terminator. */
+    Sig256_t xSignature;                                       /* Signature of the file, identifies its content. */
+    OTA_BlockTracker_t xRxBlockTracker;                        /* Blocks not received yet. */
+} OTA_Checkpoint_t;
+
+/* State of the patch parser of a delta update. */
+
+typedef enum
+{
+    eDeltaState_Header = 0, /* Receiving the patch header. */
+    eDeltaState_Control,    /* Receiving the control triple of a record. */
+    eDeltaState_Diff,       /* Adding diff data to the active image. */
+    eDeltaState_Extra,      /* Copying extra data. */
+    eDeltaState_Error       /* The patch is bad or the new image could not be written. */
+} OTA_DeltaState_t;
+
+/* Rebuilds a new image from the active image and a delta patch received in order. */
+
+typedef struct
+{
+    pxOTAPALReadActiveImageCallback_t xReadActiveImage; /* Reads the image the patch applies to. */
+    pxOTAPALWriteBlockCallback_t xWriteBlock;           /* Writes the new image to the receive file. */
+    OTA_DeltaState_t eState;                            /* What the next patch bytes are. */
+    uint8_t ucField[ OTA_DELTA_HEADER_SIZE ];           /* Header or control triple received so far. */
+    uint32_t ulFieldLen;                                /* Number of bytes in ucField. */
+    uint32_t ulDiffLeft;                                /* Diff bytes left in the current record. */
+    uint32_t ulExtraLeft;                               /* Extra bytes left in the current record. */
+    uint32_t ulSourceOffset;                            /* Offset in the active image of the next diff byte. */
+    uint32_t ulNextSourceOffset;                        /* Offset in the active image after the seek of the current record. */
+    uint32_t ulImageSize;                               /* Size of the new image. */
+    uint32_t ulImageOffset;                             /* Offset in the new image of ucBuffer. */
+    uint32_t ulBufferLen;                               /* Number of bytes in ucBuffer. */
+    uint8_t ucBuffer[ OTA_FILE_BLOCK_SIZE ];            /* Block of the new image being rebuilt. */
+} OTA_DeltaApplier_t;
+
 /* The OTA agent is a singleton today. The structure keeps it nice and organized. */
 
+#if ( OTA_STREAMING_SIGNATURE_VERIFICATION == 1 )
+
+/* A block received ahead of the hashed part of the file. */
+
+    typedef struct
+    {
+        uint8_t * pucData;     /* Copy of the block data, NULL if this entry is free. */
+        uint32_t ulBlockIndex; /* Index of the block in the file. */
+        uint32_t ulBlockSize;  /* Size of the block in bytes. */
+    } OTA_PendingBlock_t;
+
+/* Hash of the file being received, computed in file order. */
+
+    typedef struct
+    {
+        void * pvSigVerifyContext;                                        /* Hash of the blocks before ulNextBlock, NULL if not hashing. */
+        uint32_t ulNextBlock;                                             /* Index of the next block to add to the hash. */
+        OTA_PendingBlock_t xPending[ OTA_STREAM_HASH_MAX_PENDING_BLOCKS ]; /* Blocks waiting for the blocks before them. */
+    } OTA_StreamHash_t;
+#endif /* if ( OTA_STREAMING_SIGNATURE_VERIFICATION == 1 ) */
+
 typedef struct ota_agent_context
 {
     OTA_State_t eState;                                     /* State of the OTA agent. */
@@ -260,6 +411,11 @@ typedef struct ota_agent_context
     OTA_AgentStatistics_t xStatistics;                      /* The OTA agent statistics block. */
     SemaphoreHandle_t xOTA_ThreadSafetyMutex;               /* Mutex used to ensure thread safety while managing data buffers. */
     uint32_t ulRequestMomentum;                             /* The number of requests sent before a response was received. */
+    uint32_t ulBlocksSinceCheckpoint;                       /* Number of blocks received since the last checkpoint. */
+    OTA_DeltaApplier_t * pxDeltaApplier;                    /* Rebuilds the image of a delta update, NULL for a full image. */
+    #if ( OTA_STREAMING_SIGNATURE_VERIFICATION == 1 )
+        OTA_StreamHash_t xStreamHash;                       /* Hash of the file being received. */
+    #endif
 } OTA_AgentContext_t;
 
 /* The OTA Agent event and data structures. */
@@ -295,4 +451,102 @@ void prvOTAEventBufferFree( OTA_EventData_t * const pxBuffer );
  */
 bool OTA_SignalEvent( const OTA_EventMsg_t * const pxEventMsg );
 
+/*
+ * Allocate a block tracker with all ulNumBlocks blocks of a file missing.
+ *
+ * Returns NULL if out of memory.
+ */
+OTA_BlockTracker_t * prvBlockTrackerCreate( uint32_t ulNumBlocks );
+
+/*
+ * Free a block tracker. NULL is ignored.
+ */
+void prvBlockTrackerDelete( OTA_BlockTracker_t * pxTracker );
+
+/*
+ * Check if a block has not been received yet.
+ */
+bool prvBlockTrackerIsMissing( const OTA_BlockTracker_t * pxTracker,
+                               uint32_t ulBlockIndex );
+
+/*
+ * Record a missing block as received.
+ *
+ * Returns false if the block is not missing, or if recording it would need more
+ * than OTA_MAX_BLOCK_RANGES runs. The block is then still missing.
+ */
+bool prvBlockTrackerMarkReceived( OTA_BlockTracker_t * pxTracker,
+                                  uint32_t ulBlockIndex );
+
+/*
+ * Find the first run of missing blocks at or after ulFromBlock.
+ *
+ * The index of the first block of the run is written to pulFirstBlock. Returns
+ * the number of blocks in the run, or 0 if no block is missing from ulFromBlock on.
+ */
+uint32_t prvBlockTrackerNextMissing( const OTA_BlockTracker_t * pxTracker,
+                                     uint32_t ulFromBlock,
+                                     uint32_t * pulFirstBlock );
+
+/*
+ * Write the bitmap of the missing blocks from ulOffset on into pucBitmap.
+ *
+ * Bit n of byte m is set if block ( ulOffset + 8 * m + n ) is missing. Blocks
+ * past the end of the file are clear.
+ */
+void prvBlockTrackerGetBitmap( const OTA_BlockTracker_t * pxTracker,
+                               uint32_t ulOffset,
+                               uint8_t * pucBitmap,
+                               uint32_t ulBitmapLen );
+
+/*
+ * Fill a checkpoint with the download progress of a file.
+ *
+ * Returns false if the progress of the file can't be checkpointed.
+ */
+bool prvCheckpointCreate( OTA_Checkpoint_t * pxCheckpoint,
+                          const OTA_FileContext_t * C );
+
+/*
+ * Check if a checkpoint is intact and was saved for the same job and file as C.
+ */
+bool prvCheckpointMatches( const OTA_Checkpoint_t * pxCheckpoint,
+                           const OTA_FileContext_t * C );
+
+/*
+ * Restore the download progress of a file from a checkpoint that matches it.
+ */
+void prvCheckpointRestore( const OTA_Checkpoint_t * pxCheckpoint,
+                           OTA_FileContext_t * C );
+
+/*
+ * Create the applier of a delta patch that rebuilds an image of ulImageSize bytes.
+ *
+ * Returns NULL if there is not enough memory.
+ */
+OTA_DeltaApplier_t * prvDeltaCreate( uint32_t ulImageSize,
+                                     pxOTAPALReadActiveImageCallback_t xReadActiveImage,
+                                     pxOTAPALWriteBlockCallback_t xWriteBlock );
+
+/*
+ * Free a delta patch applier.
+ */
+void prvDeltaDelete( OTA_DeltaApplier_t * pxDelta );
+
+/*
+ * Apply the next ulSize bytes of the patch, writing the new image to the receive file of C as
+ * its blocks are completed. The patch may be split anywhere.
+ */
+OTA_Err_t prvDeltaApply( OTA_DeltaApplier_t * pxDelta,
+                         OTA_FileContext_t * C,
+                         const uint8_t * pucPatch,
+                         uint32_t ulSize );
+
+/*
+ * Write the rest of the new image once the whole patch is applied. Fails if the patch ended early
+ * or did not rebuild the whole image.
+ */
+OTA_Err_t prvDeltaFinish( OTA_DeltaApplier_t * pxDelta,
+                          OTA_FileContext_t * C );
+
 #endif /* ifndef _AWS_IOT_OTA_AGENT_INTERNAL_H_ */
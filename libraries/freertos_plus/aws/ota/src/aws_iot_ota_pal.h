@@ -196,4 +196,88 @@ OTA_Err_t prvPAL_SetPlatformImageState( OTA_ImageState_t eState );
  */
 OTA_PAL_ImageState_t prvPAL_GetPlatformImageState( void );
 
+/*
+ * The functions below are optional. A port that supports resuming interrupted downloads or delta
+ * updates implements the ones needed and the application passes them to OTA_AgentInit_internal()
+ * in OTA_PAL_Callbacks_t.
+ */
+
+/**
+ * @brief Reopen a partially received file to resume its download.
+ *
+ * Opens the file indicated in the OTA file context for writing like prvPAL_CreateFileForRx(), but
+ * keeps the blocks already written to it. The OTA agent only calls this function when a checkpoint
+ * saved for the same job and file was loaded.
+ *
+ * @param[in] C OTA file context information.
+ *
+ * @return The OTA PAL layer error code combined with the MCU specific error code. See OTA Agent
+ * error codes information in aws_iot_ota_agent.h.
+ *
+ * kOTA_Err_None is returned when the file is open with its content preserved.
+ * kOTA_Err_RxFileCreateFailed is returned if the file does not exist or can't be opened. The agent
+ * then starts the download over with prvPAL_CreateFileForRx().
+ */
+OTA_Err_t prvPAL_ResumeFileForRx( OTA_FileContext_t * const C );
+
+/**
+ * @brief Store a checkpoint of the download progress in non-volatile memory.
+ *
+ * Replaces the checkpoint stored before, if any. The checkpoint describes the blocks written to the
+ * receive file so far, so these blocks must be in non-volatile memory before the checkpoint is.
+ * A checkpoint that is only partially written, e.g. because of a reset, is rejected by the agent
+ * by its size and checksum.
+ *
+ * @param[in] C OTA file context information of the file being received.
+ * @param[in] pucData Checkpoint data. The format is private to the OTA agent.
+ * @param[in] ulSize Size of the checkpoint data in bytes.
+ *
+ * @return kOTA_Err_None on success, kOTA_Err_CheckpointFailed combined with the MCU specific error
+ * code otherwise.
+ */
+OTA_Err_t prvPAL_SaveCheckpoint( OTA_FileContext_t * const C,
+                                 const uint8_t * pucData,
+                                 uint32_t ulSize );
+
+/**
+ * @brief Read the checkpoint stored by prvPAL_SaveCheckpoint().
+ *
+ * @param[out] pucData Buffer to read the checkpoint data into.
+ * @param[in] ulSize Size of the buffer in bytes.
+ * @param[out] pulSizeRead Number of bytes read.
+ *
+ * @return kOTA_Err_None on success, kOTA_Err_CheckpointFailed combined with the MCU specific error
+ * code if no checkpoint is stored or it can't be read.
+ */
+OTA_Err_t prvPAL_LoadCheckpoint( uint8_t * pucData,
+                                 uint32_t ulSize,
+                                 uint32_t * pulSizeRead );
+
+/**
+ * @brief Remove the checkpoint stored by prvPAL_SaveCheckpoint().
+ *
+ * @return kOTA_Err_None on success or if no checkpoint is stored, kOTA_Err_CheckpointFailed
+ * combined with the MCU specific error code otherwise.
+ */
+OTA_Err_t prvPAL_EraseCheckpoint( void );
+
+/**
+ * @brief Read part of the image the device is running.
+ *
+ * Needed to receive delta updates. A delta update (a file with a non zero ulImageSize) is
+ * a patch against the active image; the agent reads the active image through this function while it
+ * rebuilds the new image and writes it with prvPAL_WriteBlock(). The active image must not change
+ * until the new image is activated.
+ *
+ * @param[in] ulOffset Offset of the data in the active image.
+ * @param[out] pucData Buffer to read the data into.
+ * @param[in] ulSize Number of bytes to read.
+ *
+ * @return kOTA_Err_None if all ulSize bytes were read, kOTA_Err_DeltaUpdateFailed combined with the
+ * MCU specific error code if the range is not inside the active image or it can't be read.
+ */
+OTA_Err_t prvPAL_ReadActiveImage( uint32_t ulOffset,
+                                  uint8_t * pucData,
+                                  uint32_t ulSize );
+
 #endif /* ifndef _AWS_OTA_PAL_H_ */
@@ -29,6 +29,11 @@
 #include <string.h>
 #include <stdio.h>
 
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+#include "semphr.h"
+
 /* Error handling from C-SDK. */
 #include "private/iot_error.h"
 
@@ -131,6 +136,46 @@
  */
 #define HTTP_HEADER_CONNECTION_VALUE_MAX_LEN    ( sizeof( "keep-alive" ) )
 
+/**
+ * The maximum number of consecutive file blocks requested in a single HTTP range request.
+ *
+ * Each request asks for the first block that is still missing in the block tracker together with up to
+ * this many missing blocks that follow it. The blocks of the response are passed to the OTA agent one
+ * at a time as they are read from the network. Larger values save a request round trip per block, which
+ * matters on high-latency links. Define otaconfigHTTP_MAX_NUM_BLOCKS_REQUEST in aws_ota_agent_config.h
+ * to override the default of one block per request.
+ */
+#ifdef otaconfigHTTP_MAX_NUM_BLOCKS_REQUEST
+    #define HTTP_MAX_NUM_BLOCKS_REQUEST    otaconfigHTTP_MAX_NUM_BLOCKS_REQUEST
+#else
+    #define HTTP_MAX_NUM_BLOCKS_REQUEST    1U
+#endif
+
+/* Size of the block index stored in front of the block data in an OTA event buffer. */
+#define HTTP_BLOCK_INDEX_SIZE                   ( sizeof( uint32_t ) )
+
+/**
+ * The number of HTTP connections used to download the file in parallel.
+ *
+ * Each connection requests its own run of missing blocks, so the download is not limited by the
+ * throughput of a single TCP connection, e.g. on lossy or high-latency links. Every connection needs
+ * its own set of HTTP buffers. Blocks from all connections are written by the OTA agent task one at a
+ * time; a block that arrives when no OTA event buffer is free is dropped and requested again, so it is
+ * best to set otaconfigMAX_NUM_OTA_DATA_BUFFERS to at least the number of connections. Define
+ * otaconfigHTTP_MAX_NUM_CONNECTIONS in aws_ota_agent_config.h to override the default of a single
+ * connection.
+ */
+#ifdef otaconfigHTTP_MAX_NUM_CONNECTIONS
+    #define HTTP_MAX_NUM_CONNECTIONS    otaconfigHTTP_MAX_NUM_CONNECTIONS
+#else
+    #define HTTP_MAX_NUM_CONNECTIONS    1U
+#endif
+
+/* Time to wait for a response before assuming the connection is closed by the server. This is shorter
+ * than the request timer of the OTA agent so that the check made when that timer expires always finds
+ * the request timed out. */
+#define HTTP_RESPONSE_TIMEOUT_MS                ( otaconfigFILE_REQUEST_WAIT_MS / 2U )
+
 /* Struct for HTTP callback data. */
 typedef struct _httpCallbackData
 {
@@ -175,7 +220,8 @@ typedef enum
     OTA_HTTP_ERR_GENERIC = 101,
     OTA_HTTP_ERR_CANCELED = 102,
     OTA_HTTP_ERR_NEED_RECONNECT = 103,
-    OTA_HTTP_ERR_URL_EXPIRED = 104
+    OTA_HTTP_ERR_URL_EXPIRED = 104,
+    OTA_HTTP_ERR_DROPPED = 105
 } _httpErr;
 
 typedef enum
@@ -187,68 +233,94 @@ typedef enum
     OTA_HTTP_PROCESSING_RESPONSE
 } _httpState;
 
-/* Struct for OTA HTTP downloader. */
-typedef struct _httpDownloader
+/* Struct for one connection of the OTA HTTP downloader and the request in progress on it. */
+typedef struct _httpSession
 {
-    OTA_AgentContext_t * pAgentCtx;       /* OTA agent context. */
-    _httpState state;                     /* HTTP downloader state. */
-    _httpErr err;                         /* HTTP downloader error status. */
-    _httpUrlInfo_t httpUrlInfo;           /* HTTP url of the file to download. */
+    _httpState state;                     /* HTTP session state. */
+    _httpErr err;                         /* HTTP session error status. */
     _httpConnection_t httpConnection;     /* HTTP connection data. */
     _httpRequest_t httpRequest;           /* HTTP request data. */
     _httpResponse_t httpResponse;         /* HTTP response data. */
     _httpCallbackData_t httpCallbackData; /* Data used in the HTTP callback. */
-    uint32_t currBlock;                   /* Current requesting block in bitmap. */
-    uint32_t currBlockSize;               /* Size of current requesting block. */
+    TickType_t requestTime;               /* Tick count when the current request was sent. */
+    uint32_t currBlock;                   /* First block of the current request in the file. */
+    uint32_t currNumBlocks;               /* Number of blocks in the current request. */
+    uint32_t currBlocksRead;              /* Number of blocks read from the current response. */
+    uint32_t currRangeSize;               /* Size of the byte range of the current request. */
+    uint8_t * pConnectionUserBuffer;      /* Buffer to store the HTTP connection context. */
+    uint8_t * pRequestUserBuffer;         /* Buffer to store the HTTP request context and header. */
+    uint8_t * pResponseUserBuffer;        /* Buffer to store the HTTP response context and header. */
+    uint8_t * pResponseBodyBuffer;        /* Buffer to store the HTTP response body. */
+} _httpSession_t;
+
+/* Struct for OTA HTTP downloader.
+ *
+ * The sessions are shared by the OTA agent task and the HTTP client callbacks. The state and error of
+ * a session are only read and written with sessionMutex taken. The OTA agent owns a session while it is
+ * idle or sending a request, the HTTP callbacks own it while it is waiting for or processing the
+ * response. The OTA agent takes a session back from the HTTP callbacks only when its request timed
+ * out. The mutex is never held across calls into the HTTP client. */
+typedef struct _httpDownloader
+{
+    OTA_AgentContext_t * pAgentCtx;                     /* OTA agent context. */
+    _httpUrlInfo_t httpUrlInfo;                         /* HTTP url of the file to download. */
+    _httpSession_t sessions[ HTTP_MAX_NUM_CONNECTIONS ]; /* HTTP connections downloading the file. */
+    SemaphoreHandle_t sessionMutex;                     /* Mutex protecting the state of the sessions. */
 } _httpDownloader_t;
 
 /* Global HTTP downloader instance. */
 static _httpDownloader_t _httpDownloader = { 0 };
 
-/* Buffers for HTTP library. */
-uint8_t * pConnectionUserBuffer = NULL; /* Buffer to store the HTTP connection context. */
-uint8_t * pRequestUserBuffer = NULL;    /* Buffer to store the HTTP request context and header. */
-uint8_t * pResponseUserBuffer = NULL;   /* Buffer to store the HTTP response context and header. */
-uint8_t * pResponseBodyBuffer = NULL;   /* Buffer to store the HTTP response body. */
-
 /* We need to use this function defined in iot_logging_task_dynamic_buffers.c to print HTTP message
  * without appending the task name and tick count. */
 void vLoggingPrint( const char * pcMessage );
 
 /*-----------------------------------------------------------*/
 
+/* Take the mutex protecting the state of the sessions. */
+static void _httpLockSessions( void )
+{
+    ( void ) xSemaphoreTake( _httpDownloader.sessionMutex, portMAX_DELAY );
+}
+
+/* Give the mutex protecting the state of the sessions. */
+static void _httpUnlockSessions( void )
+{
+    ( void ) xSemaphoreGive( _httpDownloader.sessionMutex );
+}
+
 /* Helper function to allocate buffers for HTTP library. */
-static bool _httpAllocateBuffers()
+static bool _httpAllocateBuffers( _httpSession_t * pSession )
 {
     bool isSuccess = true;
 
-    pConnectionUserBuffer = pvPortMalloc( HTTPS_CONNECTION_USER_BUFFER_SIZE );
+    pSession->pConnectionUserBuffer = pvPortMalloc( HTTPS_CONNECTION_USER_BUFFER_SIZE );
 
-    if( pConnectionUserBuffer == NULL )
+    if( pSession->pConnectionUserBuffer == NULL )
     {
         IotLogError( "Failed to allocate memory for HTTP connection user buffer." );
         isSuccess = false;
     }
 
-    pRequestUserBuffer = pvPortMalloc( HTTPS_REQUEST_USER_BUFFER_SIZE );
+    pSession->pRequestUserBuffer = pvPortMalloc( HTTPS_REQUEST_USER_BUFFER_SIZE );
 
-    if( isSuccess && ( pRequestUserBuffer == NULL ) )
+    if( isSuccess && ( pSession->pRequestUserBuffer == NULL ) )
     {
         IotLogError( "Failed to allocate memory for HTTP request user buffer." );
         isSuccess = false;
     }
 
-    pResponseUserBuffer = pvPortMalloc( HTTPS_RESPONSE_USER_BUFFER_SIZE );
+    pSession->pResponseUserBuffer = pvPortMalloc( HTTPS_RESPONSE_USER_BUFFER_SIZE );
 
-    if( isSuccess && ( pResponseUserBuffer == NULL ) )
+    if( isSuccess && ( pSession->pResponseUserBuffer == NULL ) )
     {
         IotLogError( "Failed to allocate memory for HTTP response user buffer." );
         isSuccess = false;
     }
 
-    pResponseBodyBuffer = pvPortMalloc( HTTPS_RESPONSE_BODY_BUFFER_SIZE );
+    pSession->pResponseBodyBuffer = pvPortMalloc( HTTPS_RESPONSE_BODY_BUFFER_SIZE );
 
-    if( isSuccess && ( pResponseBodyBuffer == NULL ) )
+    if( isSuccess && ( pSession->pResponseBodyBuffer == NULL ) )
     {
         IotLogError( "Failed to allocate memory for HTTP response body buffer." );
         isSuccess = false;
@@ -258,36 +330,67 @@ static bool _httpAllocateBuffers()
 }
 
 /* Helper function to free buffers for HTTP library. */
-static void _httpFreeBuffers()
+static void _httpFreeBuffers( _httpSession_t * pSession )
 {
-    if( pResponseBodyBuffer )
+    if( pSession->pResponseBodyBuffer )
     {
-        vPortFree( pResponseBodyBuffer );
-        pResponseBodyBuffer = NULL;
+        vPortFree( pSession->pResponseBodyBuffer );
+        pSession->pResponseBodyBuffer = NULL;
     }
 
-    if( pResponseUserBuffer )
+    if( pSession->pResponseUserBuffer )
     {
-        vPortFree( pResponseUserBuffer );
-        pResponseUserBuffer = NULL;
+        vPortFree( pSession->pResponseUserBuffer );
+        pSession->pResponseUserBuffer = NULL;
     }
 
-    if( pRequestUserBuffer )
+    if( pSession->pRequestUserBuffer )
     {
-        vPortFree( pRequestUserBuffer );
-        pRequestUserBuffer = NULL;
+        vPortFree( pSession->pRequestUserBuffer );
+        pSession->pRequestUserBuffer = NULL;
     }
 
-    if( pConnectionUserBuffer )
+    if( pSession->pConnectionUserBuffer )
     {
-        vPortFree( pConnectionUserBuffer );
-        pConnectionUserBuffer = NULL;
+        vPortFree( pSession->pConnectionUserBuffer );
+        pSession->pConnectionUserBuffer = NULL;
     }
 }
 
+/* Size of a block of the current request of a session. Every block but the last one of the file is a
+ * full block. */
+static uint32_t _httpGetBlockSize( const _httpSession_t * pSession,
+                                   uint32_t blockInRequest )
+{
+    uint32_t blockSize = pSession->currRangeSize - blockInRequest * OTA_FILE_BLOCK_SIZE;
+
+    if( blockSize > OTA_FILE_BLOCK_SIZE )
+    {
+        blockSize = OTA_FILE_BLOCK_SIZE;
+    }
+
+    return blockSize;
+}
+
+/* Copy a file block to an OTA event buffer. The block index is stored in front of the block data so
+ * that blocks of a multi-block response can be queued to the OTA agent before the previous ones are
+ * processed. _AwsIotOTA_DecodeFileBlock_HTTP splits them again. */
+static void _httpFillEventBuffer( OTA_EventData_t * pMessage,
+                                  uint32_t blockIndex,
+                                  const uint8_t * pBlock,
+                                  uint32_t blockSize )
+{
+    pMessage->ulDataLength = HTTP_BLOCK_INDEX_SIZE + blockSize;
+
+    memcpy( pMessage->ucData, &blockIndex, HTTP_BLOCK_INDEX_SIZE );
+    memcpy( pMessage->ucData + HTTP_BLOCK_INDEX_SIZE, pBlock, blockSize );
+}
+
 /* Process the HTTP response body, copy to another buffer and signal OTA agent the file block
- * download is complete. */
-static void _httpProcessResponseBody( OTA_AgentContext_t * pAgentCtx,
+ * download is complete. This is called from the HTTP client callbacks, so it does not wait for a free
+ * OTA event buffer. Returns false if the block is dropped. */
+static bool _httpProcessResponseBody( OTA_AgentContext_t * pAgentCtx,
+                                      uint32_t blockIndex,
                                       uint8_t * pHTTPResponseBody,
                                       uint32_t bufferSize )
 {
@@ -304,28 +407,29 @@ static void _httpProcessResponseBody( OTA_AgentContext_t * pAgentCtx,
     if( pMessage == NULL )
     {
         pAgentCtx->xStatistics.ulOTA_PacketsDropped++;
-        IotLogError( "Could not get a free buffer to copy callback data." );
+        IotLogWarn( "No free buffer for block %u, it will be requested again.", ( unsigned int ) blockIndex );
     }
     else
     {
-        pMessage->ulDataLength = bufferSize;
-
-        memcpy( pMessage->ucData, pHTTPResponseBody, pMessage->ulDataLength );
+        _httpFillEventBuffer( pMessage, blockIndex, pHTTPResponseBody, bufferSize );
         eventMsg.xEventId = eOTA_AgentEvent_ReceivedFileBlock;
         eventMsg.pxEventData = pMessage;
         /* Send job document received event. */
         OTA_SignalEvent( &eventMsg );
     }
+
+    return( pMessage != NULL );
 }
 
 /* Error handler for HTTP response code. */
-static void _httpErrorHandler( uint16_t responseCode )
+static void _httpErrorHandler( _httpSession_t * pSession,
+                               uint16_t responseCode )
 {
-    const char * pResponseBody = ( const char * ) pResponseBodyBuffer;
+    const char * pResponseBody = ( const char * ) pSession->pResponseBodyBuffer;
     char * endPos = NULL;
 
     /* Force the response body to be NULL terminated. */
-    pResponseBodyBuffer[ HTTPS_RESPONSE_BODY_BUFFER_SIZE - 1 ] = '\0';
+    pSession->pResponseBodyBuffer[ HTTPS_RESPONSE_BODY_BUFFER_SIZE - 1 ] = '\0';
 
     /* Search the </Error> tag, if found, set the NULL terminator at the end of this tag. */
     endPos = strstr( pResponseBody, "</Error>" );
@@ -345,31 +449,31 @@ static void _httpErrorHandler( uint16_t responseCode )
         if( NULL != strstr( pResponseBody, "Request has expired" ) )
         {
             IotLogInfo( "Pre-signed URL have expired, requesting new job document." );
-            _httpDownloader.err = OTA_HTTP_ERR_URL_EXPIRED;
+            pSession->err = OTA_HTTP_ERR_URL_EXPIRED;
         }
         else
         {
-            _httpDownloader.err = OTA_HTTP_ERR_GENERIC;
+            pSession->err = OTA_HTTP_ERR_GENERIC;
         }
     }
     else
     {
-        _httpDownloader.err = OTA_HTTP_ERR_GENERIC;
+        pSession->err = OTA_HTTP_ERR_GENERIC;
     }
 }
 
 /* Helper function to reconnect to the HTTP server. */
-static IotHttpsReturnCode_t _httpReconnect()
+static IotHttpsReturnCode_t _httpReconnect( _httpSession_t * pSession )
 {
     /* HTTP API return status. */
     IotHttpsReturnCode_t httpsStatus = IotHttpsClient_Connect(
-        &_httpDownloader.httpConnection.connectionHandle,
-        &_httpDownloader.httpConnection.connectionConfig );
+        &pSession->httpConnection.connectionHandle,
+        &pSession->httpConnection.connectionConfig );
 
     if( httpsStatus != IOT_HTTPS_OK )
     {
         IotLogError( "Failed to reconnect to the HTTP server. Error code: %d.", httpsStatus );
-        _httpDownloader.err = OTA_HTTP_ERR_NEED_RECONNECT;
+        pSession->err = OTA_HTTP_ERR_NEED_RECONNECT;
     }
     else
     {
@@ -387,15 +491,32 @@ static void _httpAppendHeaderCallback( void * pPrivateData,
 {
     IotLogDebug( "Invoking _httpAppendHeaderCallback." );
 
+    /* HTTP session this request is sent on. */
+    _httpSession_t * pSession = ( _httpSession_t * ) pPrivateData;
+
+    /* Whether the HTTP downloader is stopped by the OTA agent. */
+    bool isStopped = false;
+
+    /* The request is sent, the HTTP callbacks own the session until the response is complete. */
+    _httpLockSessions();
+    isStopped = ( pSession->state == OTA_HTTP_STOPPED );
+
+    if( isStopped == false )
+    {
+        pSession->state = OTA_HTTP_WAITING_RESPONSE;
+    }
+
+    _httpUnlockSessions();
+
     /* Cancel the request if the HTTP downloader is stopped by the OTA agent. */
-    if( _httpDownloader.state == OTA_HTTP_STOPPED )
+    if( isStopped )
     {
         IotHttpsClient_CancelRequestAsync( requestHandle );
         return;
     }
 
     /* Value of the "Range" field in HTTP GET request header, set when requesting the file block. */
-    char * pRangeValueStr = ( ( _httpCallbackData_t * ) ( pPrivateData ) )->pRangeValueStr;
+    char * pRangeValueStr = pSession->httpCallbackData.pRangeValueStr;
 
     /* Set the header for this range request. */
     IotHttpsReturnCode_t status = IotHttpsClient_AddHeader( requestHandle,
@@ -410,14 +531,39 @@ static void _httpAppendHeaderCallback( void * pPrivateData,
     {
         IotLogError( "Failed to add HTTP header. Error code: %d. Canceling current request.", status );
         IotHttpsClient_CancelRequestAsync( requestHandle );
-        _httpDownloader.err = OTA_HTTP_ERR_CANCELED;
+        pSession->err = OTA_HTTP_ERR_CANCELED;
     }
-    else
+
+    /* Otherwise we're now waiting for a response, _httpReadReadyCallback is expected to be invoked
+     * next upon receiving a response from the server. */
+}
+
+/* Check if a session is owned by the HTTP callbacks, i.e. its request is sent and neither the
+ * HTTP downloader is stopped nor the OTA agent gave up on the request after the response timeout.
+ * Must be called with the session mutex taken. */
+static bool _httpIsWaitingForResponse( const _httpSession_t * pSession )
+{
+    return( ( pSession->state == OTA_HTTP_WAITING_RESPONSE ) ||
+            ( pSession->state == OTA_HTTP_PROCESSING_RESPONSE ) );
+}
+
+/* Set the state of a session to processing response when a response is received. Returns false if
+ * the session is not waiting for a response anymore. */
+static bool _httpStartProcessingResponse( _httpSession_t * pSession )
+{
+    bool isWaiting = false;
+
+    _httpLockSessions();
+    isWaiting = _httpIsWaitingForResponse( pSession );
+
+    if( isWaiting )
     {
-        /* We've successfully sent the request, now waiting for a response, _httpReadReadyCallback
-         * is expected to be invoked next upon receiving a response from the server. */
-        _httpDownloader.state = OTA_HTTP_WAITING_RESPONSE;
+        pSession->state = OTA_HTTP_PROCESSING_RESPONSE;
     }
+
+    _httpUnlockSessions();
+
+    return isWaiting;
 }
 
 static void _httpReadReadyCallback( void * pPrivateData,
@@ -428,9 +574,11 @@ static void _httpReadReadyCallback( void * pPrivateData,
     IotLogDebug( "Invoking _httpReadReadyCallback." );
 
     /* Unused parameters. */
-    ( void ) pPrivateData;
     ( void ) returnCode;
 
+    /* HTTP session this response is received on. */
+    _httpSession_t * pSession = ( _httpSession_t * ) pPrivateData;
+
     /* HTTP return status. */
     IotHttpsReturnCode_t httpsStatus = IOT_HTTPS_OK;
 
@@ -440,29 +588,33 @@ static void _httpReadReadyCallback( void * pPrivateData,
     /* Size of the response body returned from HTTP API. */
     uint32_t responseBodyLength = 0;
 
+    /* Size of the block expected next in the response body. */
+    uint32_t expectedBlockSize = 0;
+
     /* Buffer to read the "Connection" field in HTTP header. */
     char connectionValueStr[ HTTP_HEADER_CONNECTION_VALUE_MAX_LEN ] = { 0 };
 
-    /* Bail out if this callback is invoked after http downloader stopped. */
-    if( _httpDownloader.state == OTA_HTTP_STOPPED )
+    /* A response is received from the server, setting the state to processing response. Bail out if
+     * this callback is invoked after http downloader stopped or the request timed out. */
+    if( _httpStartProcessingResponse( pSession ) == false )
     {
         IotHttpsClient_CancelResponseAsync( responseHandle );
         return;
     }
 
-    /* A response is received from the server, setting the state to processing response. */
-    _httpDownloader.state = OTA_HTTP_PROCESSING_RESPONSE;
+    /* This callback is invoked until the whole response body is read, one block at a time. */
+    expectedBlockSize = _httpGetBlockSize( pSession, pSession->currBlocksRead );
 
     /* Read the data from the network. */
     responseBodyLength = HTTPS_RESPONSE_BODY_BUFFER_SIZE;
     httpsStatus = IotHttpsClient_ReadResponseBody( responseHandle,
-                                                   pResponseBodyBuffer,
+                                                   pSession->pResponseBodyBuffer,
                                                    &responseBodyLength );
 
     if( httpsStatus != IOT_HTTPS_OK )
     {
         IotLogError( "Failed to read the response body. Error code: %d.", httpsStatus );
-        _httpDownloader.err = OTA_HTTP_ERR_GENERIC;
+        pSession->err = OTA_HTTP_ERR_GENERIC;
         OTA_GOTO_CLEANUP();
     }
 
@@ -470,25 +622,55 @@ static void _httpReadReadyCallback( void * pPrivateData,
     if( responseStatus != IOT_HTTPS_STATUS_PARTIAL_CONTENT )
     {
         IotLogError( "Expect a HTTP partial response, but received code %d", responseStatus );
-        _httpErrorHandler( responseStatus );
+        _httpErrorHandler( pSession, responseStatus );
         OTA_GOTO_CLEANUP();
     }
 
-    /* Read the "Content-Length" field from HTTP header. */
-    httpsStatus = IotHttpsClient_ReadContentLength( responseHandle, &contentLength );
+    /* The headers only need to be checked when reading the first block of the response. */
+    if( pSession->currBlocksRead == 0 )
+    {
+        /* Read the "Content-Length" field from HTTP header. */
+        httpsStatus = IotHttpsClient_ReadContentLength( responseHandle, &contentLength );
+
+        if( ( httpsStatus != IOT_HTTPS_OK ) || ( contentLength == 0 ) )
+        {
+            IotLogError( "Failed to retrieve the Content-Length from the response. " );
+            pSession->err = OTA_HTTP_ERR_GENERIC;
+            OTA_GOTO_CLEANUP();
+        }
+
+        /* Check if the value of "Content-Length" matches what we have requested. */
+        if( contentLength != pSession->currRangeSize )
+        {
+            IotLogError( "Content-Length value in HTTP header does not match what we requested. " );
+            pSession->err = OTA_HTTP_ERR_GENERIC;
+            OTA_GOTO_CLEANUP();
+        }
+    }
 
-    if( ( httpsStatus != IOT_HTTPS_OK ) || ( contentLength == 0 ) )
+    /* The body buffer holds exactly one block, so every read must return a complete block. */
+    if( responseBodyLength != expectedBlockSize )
     {
-        IotLogError( "Failed to retrieve the Content-Length from the response. " );
-        _httpDownloader.err = OTA_HTTP_ERR_GENERIC;
+        IotLogError( "Received %u bytes for block %u, expected %u bytes.",
+                     ( unsigned int ) responseBodyLength,
+                     ( unsigned int ) ( pSession->currBlock + pSession->currBlocksRead ),
+                     ( unsigned int ) expectedBlockSize );
+        pSession->err = OTA_HTTP_ERR_GENERIC;
         OTA_GOTO_CLEANUP();
     }
 
-    /* Check if the value of "Content-Length" matches what we have requested. */
-    if( contentLength != _httpDownloader.currBlockSize )
+    pSession->currBlocksRead++;
+
+    /* Hand every block but the last one over to the OTA agent right away. The last block is handed
+     * over in _httpResponseCompleteCallback, after the HTTP client is done with the response. If the
+     * OTA agent has no room for a block, the rest of the response is dropped. */
+    if( ( pSession->currBlocksRead < pSession->currNumBlocks ) &&
+        ( _httpProcessResponseBody( _httpDownloader.pAgentCtx,
+                                    pSession->currBlock + pSession->currBlocksRead - 1,
+                                    pSession->pResponseBodyBuffer,
+                                    responseBodyLength ) == false ) )
     {
-        IotLogError( "Content-Length value in HTTP header does not match what we requested. " );
-        _httpDownloader.err = OTA_HTTP_ERR_GENERIC;
+        pSession->err = OTA_HTTP_ERR_DROPPED;
         OTA_GOTO_CLEANUP();
     }
 
@@ -507,7 +689,7 @@ static void _httpReadReadyCallback( void * pPrivateData,
     if( ( httpsStatus != IOT_HTTPS_OK ) && ( httpsStatus != IOT_HTTPS_NOT_FOUND ) )
     {
         IotLogError( "Failed to read header Connection. Error code: %d.", httpsStatus );
-        _httpDownloader.err = OTA_HTTP_ERR_GENERIC;
+        pSession->err = OTA_HTTP_ERR_GENERIC;
     }
     else
     {
@@ -515,7 +697,7 @@ static void _httpReadReadyCallback( void * pPrivateData,
         if( strncmp( "close", connectionValueStr, sizeof( "close" ) ) == 0 )
         {
             IotLogInfo( "Connection has been closed by the HTTP server, reconnect in next request." );
-            _httpDownloader.err = OTA_HTTP_ERR_NEED_RECONNECT;
+            pSession->err = OTA_HTTP_ERR_NEED_RECONNECT;
         }
     }
 
@@ -523,7 +705,7 @@ static void _httpReadReadyCallback( void * pPrivateData,
      * If the HTTP error is IOT_HTTPS_NETWORK_ERROR, the connection will then be closed by the HTTP
      * client, followed by invoking _httpConnectionClosedCallback and _httpResponseCompleteCallback.
      * In other cases, only _httpResponseCompleteCallback will be invoked. */
-    if( _httpDownloader.err != OTA_HTTP_ERR_NONE )
+    if( pSession->err != OTA_HTTP_ERR_NONE )
     {
         IotHttpsClient_CancelResponseAsync( responseHandle );
     }
@@ -539,30 +721,63 @@ static void _httpResponseCompleteCallback( void * pPrivateData,
     IotLogDebug( "Invoking _httpResponseCompleteCallback." );
 
     /* Unused parameters. */
-    ( void ) pPrivateData;
     ( void ) responseHandle;
     ( void ) returnCode;
     ( void ) responseStatus;
 
+    /* HTTP session this response is received on. */
+    _httpSession_t * pSession = ( _httpSession_t * ) pPrivateData;
+
     /* OTA Event. */
     OTA_EventMsg_t eventMsg = { 0 };
 
-    /* Bail out if this callback is invoked after http downloader stopped. */
-    if( _httpDownloader.state == OTA_HTTP_STOPPED )
+    /* Whether the session is still waiting for this response. */
+    bool isWaiting = false;
+
+    /* Bail out if this callback is invoked after http downloader stopped or the request timed out. */
+    _httpLockSessions();
+    isWaiting = _httpIsWaitingForResponse( pSession );
+    _httpUnlockSessions();
+
+    if( isWaiting == false )
     {
         return;
     }
 
-    if( _httpDownloader.err == OTA_HTTP_ERR_NONE )
+    /* A response that ended before all the requested blocks were read is a failed download. */
+    if( ( pSession->err == OTA_HTTP_ERR_NONE ) &&
+        ( pSession->currBlocksRead != pSession->currNumBlocks ) )
     {
-        _httpProcessResponseBody( _httpDownloader.pAgentCtx, pResponseBodyBuffer, _httpDownloader.currBlockSize );
+        IotLogError( "Received %u of %u requested blocks.",
+                     ( unsigned int ) pSession->currBlocksRead,
+                     ( unsigned int ) pSession->currNumBlocks );
+        pSession->err = OTA_HTTP_ERR_GENERIC;
     }
-    else
+
+    /* The last block of the response is still in the body buffer. */
+    if( ( pSession->err == OTA_HTTP_ERR_NONE ) &&
+        ( _httpProcessResponseBody( _httpDownloader.pAgentCtx,
+                                    pSession->currBlock + pSession->currNumBlocks - 1,
+                                    pSession->pResponseBodyBuffer,
+                                    _httpGetBlockSize( pSession, pSession->currNumBlocks - 1 ) ) == false ) )
+    {
+        pSession->err = OTA_HTTP_ERR_DROPPED;
+    }
+
+    /* Otherwise the OTA agent sets the state to idle when it decodes the last block. */
+    if( pSession->err != OTA_HTTP_ERR_NONE )
     {
         /* Reset the state to idle when current download fails. */
-        _httpDownloader.state = OTA_HTTP_IDLE;
+        _httpLockSessions();
+
+        if( _httpIsWaitingForResponse( pSession ) )
+        {
+            pSession->state = OTA_HTTP_IDLE;
+        }
 
-        switch( _httpDownloader.err )
+        _httpUnlockSessions();
+
+        switch( pSession->err )
         {
             case OTA_HTTP_ERR_NEED_RECONNECT:
                 IotLogInfo( "HTTP connection is closed, will reconnection in next request." );
@@ -575,15 +790,24 @@ static void _httpResponseCompleteCallback( void * pPrivateData,
                 break;
 
             case OTA_HTTP_ERR_CANCELED:
-                IotLogError( "Request to download block %d has been canceled.", _httpDownloader.currBlock );
+                IotLogError( "Request to download block %d has been canceled.", pSession->currBlock );
+                break;
+
+            case OTA_HTTP_ERR_DROPPED:
+
+                /* The dropped blocks are still missing in the block tracker. The OTA agent handles this
+                 * event after the blocks queued before it, so they are requested again once the OTA
+                 * agent has made room for them. */
+                eventMsg.xEventId = eOTA_AgentEvent_RequestFileBlock;
+                OTA_SignalEvent( &eventMsg );
                 break;
 
             case OTA_HTTP_ERR_GENERIC:
-                IotLogError( "Fail to download block %d.", _httpDownloader.currBlock );
+                IotLogError( "Fail to download block %d.", pSession->currBlock );
                 break;
 
             default:
-                IotLogError( "Unhandled OTA HTTP state %d, aborting OTA.", _httpDownloader.state );
+                IotLogError( "Unhandled OTA HTTP state %d, aborting OTA.", pSession->state );
                 eventMsg.xEventId = eOTA_AgentEvent_UserAbort;
                 OTA_SignalEvent( &eventMsg );
                 break;
@@ -599,16 +823,22 @@ static void _httpErrorCallback( void * pPrivateData,
     IotLogDebug( "Invoking _httpErrorCallback." );
 
     /* Unused parameters. */
-    ( void ) pPrivateData;
     ( void ) requestHandle;
     ( void ) responseHandle;
     ( void ) returnCode;
 
-    if( _httpDownloader.err == OTA_HTTP_ERR_NONE )
+    /* HTTP session the error occurred on. */
+    _httpSession_t * pSession = ( _httpSession_t * ) pPrivateData;
+
+    _httpLockSessions();
+
+    if( pSession->err == OTA_HTTP_ERR_NONE )
     {
-        _httpDownloader.err = OTA_HTTP_ERR_GENERIC;
+        pSession->err = OTA_HTTP_ERR_GENERIC;
     }
 
+    _httpUnlockSessions();
+
     IotLogError( "An error occurred for HTTP async request: %d", returnCode );
 }
 
@@ -619,12 +849,17 @@ static void _httpConnectionClosedCallback( void * pPrivateData,
     IotLogDebug( "Invoking _httpConnectionClosedCallback." );
 
     /* Unused parameters. */
-    ( void ) pPrivateData;
     ( void ) connectionHandle;
     ( void ) returnCode;
 
+    /* HTTP session whose connection is closed. */
+    _httpSession_t * pSession = ( _httpSession_t * ) pPrivateData;
+
     IotLogInfo( "Connection has been closed by the HTTP server, reconnect in next request." );
-    _httpDownloader.err = OTA_HTTP_ERR_NEED_RECONNECT;
+
+    _httpLockSessions();
+    pSession->err = OTA_HTTP_ERR_NEED_RECONNECT;
+    _httpUnlockSessions();
 }
 
 static IotHttpsReturnCode_t _httpInitUrl( const char * pURL )
@@ -666,23 +901,24 @@ static IotHttpsReturnCode_t _httpInitUrl( const char * pURL )
     return httpsStatus;
 }
 
-static IotHttpsReturnCode_t _httpConnect( const IotNetworkInterface_t * pNetworkInterface,
+static IotHttpsReturnCode_t _httpConnect( _httpSession_t * pSession,
+                                          const IotNetworkInterface_t * pNetworkInterface,
                                           struct IotNetworkCredentials * pNetworkCredentials )
 {
     /* HTTP API return status. */
     IotHttpsReturnCode_t httpsStatus = IOT_HTTPS_OK;
 
     /* HTTP connection data. */
-    _httpConnection_t * pConnection = &_httpDownloader.httpConnection;
+    _httpConnection_t * pConnection = &pSession->httpConnection;
 
     /* HTTP connection configuration. */
     IotHttpsConnectionInfo_t * pConnectionConfig = &pConnection->connectionConfig;
 
     /* HTTP request data. */
-    _httpRequest_t * pRequest = &_httpDownloader.httpRequest;
+    _httpRequest_t * pRequest = &pSession->httpRequest;
 
     /* HTTP response data. */
-    _httpResponse_t * pResponse = &_httpDownloader.httpResponse;
+    _httpResponse_t * pResponse = &pSession->httpResponse;
 
     /* HTTP URL information. */
     _httpUrlInfo_t * pUrlInfo = &_httpDownloader.httpUrlInfo;
@@ -693,7 +929,7 @@ static IotHttpsReturnCode_t _httpConnect( const IotNetworkInterface_t * pNetwork
     pConnectionConfig->port = HTTPS_PORT;
     pConnectionConfig->pCaCert = HTTPS_TRUSTED_ROOT_CA;
     pConnectionConfig->caCertLen = sizeof( HTTPS_TRUSTED_ROOT_CA );
-    pConnectionConfig->userBuffer.pBuffer = pConnectionUserBuffer;
+    pConnectionConfig->userBuffer.pBuffer = pSession->pConnectionUserBuffer;
     pConnectionConfig->userBuffer.bufferLen = HTTPS_CONNECTION_USER_BUFFER_SIZE;
     pConnectionConfig->pClientCert = pNetworkCredentials->pClientCert;
     pConnectionConfig->clientCertLen = pNetworkCredentials->clientCertSize;
@@ -707,23 +943,23 @@ static IotHttpsReturnCode_t _httpConnect( const IotNetworkInterface_t * pNetwork
     pRequest->requestConfig.pHost = pUrlInfo->pAddress;
     pRequest->requestConfig.hostLen = pUrlInfo->addressLength;
     pRequest->requestConfig.method = IOT_HTTPS_METHOD_GET;
-    pRequest->requestConfig.userBuffer.pBuffer = pRequestUserBuffer;
+    pRequest->requestConfig.userBuffer.pBuffer = pSession->pRequestUserBuffer;
     pRequest->requestConfig.userBuffer.bufferLen = HTTPS_REQUEST_USER_BUFFER_SIZE;
     pRequest->requestConfig.isAsync = true;
     pRequest->requestConfig.u.pAsyncInfo = &pRequest->asyncInfo;
 
     /* Initialize HTTP response configuration. */
-    pResponse->responseConfig.userBuffer.pBuffer = pResponseUserBuffer;
+    pResponse->responseConfig.userBuffer.pBuffer = pSession->pResponseUserBuffer;
     pResponse->responseConfig.userBuffer.bufferLen = HTTPS_RESPONSE_USER_BUFFER_SIZE;
     pResponse->responseConfig.pSyncInfo = NULL;
 
-    /* Initialize HTTP asynchronous configuration. */
+    /* Initialize HTTP asynchronous configuration. The callbacks receive the session they belong to. */
     pRequest->asyncInfo.callbacks.appendHeaderCallback = _httpAppendHeaderCallback;
     pRequest->asyncInfo.callbacks.readReadyCallback = _httpReadReadyCallback;
     pRequest->asyncInfo.callbacks.responseCompleteCallback = _httpResponseCompleteCallback;
     pRequest->asyncInfo.callbacks.errorCallback = _httpErrorCallback;
     pRequest->asyncInfo.callbacks.connectionClosedCallback = _httpConnectionClosedCallback;
-    pRequest->asyncInfo.pPrivData = ( void * ) ( &_httpDownloader.httpCallbackData );
+    pRequest->asyncInfo.pPrivData = ( void * ) pSession;
 
     httpsStatus = IotHttpsClient_Connect( &pConnection->connectionHandle, pConnectionConfig );
 
@@ -734,7 +970,8 @@ static IotHttpsReturnCode_t _httpConnect( const IotNetworkInterface_t * pNetwork
  * with S3 requires generating a Sigv4 signature in an authorization header field. So here we use
  * a GET request with range set to 0, then extract the file size from the "Content-Range" field in
  * the HTTP response. */
-static _httpErr _httpGetFileSize( uint32_t * pFileSize )
+static _httpErr _httpGetFileSize( _httpSession_t * pSession,
+                                  uint32_t * pFileSize )
 {
     /* Return status. */
     _httpErr status = OTA_HTTP_ERR_NONE;
@@ -770,7 +1007,7 @@ static _httpErr _httpGetFileSize( uint32_t * pFileSize )
     requestSyncInfo.bodyLen = 0;
 
     /* Store the response body in case there's any failure. */
-    responseSyncInfo.pBody = pResponseBodyBuffer;
+    responseSyncInfo.pBody = pSession->pResponseBodyBuffer;
     responseSyncInfo.bodyLen = HTTPS_RESPONSE_BODY_BUFFER_SIZE;
 
     /* Set the request configurations. */
@@ -779,13 +1016,13 @@ static _httpErr _httpGetFileSize( uint32_t * pFileSize )
     requestConfig.pHost = pUrlInfo->pAddress;
     requestConfig.hostLen = pUrlInfo->addressLength;
     requestConfig.method = IOT_HTTPS_METHOD_GET;
-    requestConfig.userBuffer.pBuffer = pRequestUserBuffer;
+    requestConfig.userBuffer.pBuffer = pSession->pRequestUserBuffer;
     requestConfig.userBuffer.bufferLen = HTTPS_REQUEST_USER_BUFFER_SIZE;
     requestConfig.isAsync = false;
     requestConfig.u.pSyncInfo = &requestSyncInfo;
 
     /* Set the response configurations. */
-    responseConfig.userBuffer.pBuffer = pResponseUserBuffer;
+    responseConfig.userBuffer.pBuffer = pSession->pResponseUserBuffer;
     responseConfig.userBuffer.bufferLen = HTTPS_RESPONSE_USER_BUFFER_SIZE;
     responseConfig.pSyncInfo = &responseSyncInfo;
 
@@ -814,7 +1051,7 @@ static _httpErr _httpGetFileSize( uint32_t * pFileSize )
     }
 
     /* Send the request synchronously. */
-    httpsStatus = IotHttpsClient_SendSync( _httpDownloader.httpConnection.connectionHandle,
+    httpsStatus = IotHttpsClient_SendSync( pSession->httpConnection.connectionHandle,
                                            requestHandle,
                                            &responseHandle,
                                            &responseConfig,
@@ -840,7 +1077,7 @@ static _httpErr _httpGetFileSize( uint32_t * pFileSize )
     {
         IotLogError( "Fail to get the object size from HTTP server, HTTP response code from server: %d", responseStatus );
         status = OTA_HTTP_ERR_GENERIC;
-        _httpErrorHandler( responseStatus );
+        _httpErrorHandler( pSession, responseStatus );
         OTA_GOTO_CLEANUP();
     }
 
@@ -885,45 +1122,284 @@ static _httpErr _httpGetFileSize( uint32_t * pFileSize )
     return status;
 }
 
-/* Performs some pre-checks before requesting a new block. */
-static _httpErr _requestDataBlockPreCheck()
+/* Check if a session did not receive any response within the response timeout. Must be called with
+ * the session mutex taken. */
+static bool _httpIsRequestTimedOut( const _httpSession_t * pSession,
+                                    TickType_t now )
 {
-    _httpErr status = OTA_HTTP_ERR_NONE;
+    return( ( pSession->state == OTA_HTTP_WAITING_RESPONSE ) &&
+            ( ( now - pSession->requestTime ) >= pdMS_TO_TICKS( HTTP_RESPONSE_TIMEOUT_MS ) ) );
+}
 
-    /* Reconnect to the HTTP server if we detect an error when processing the response and a reconnect
-     * is needed or we did not receive any response within OTA agent request data timeout. */
-    if( _httpDownloader.err == OTA_HTTP_ERR_NEED_RECONNECT )
-    {
-        IotLogInfo( "Error happened during last request requires reconnecting." );
+/* Check if a block is requested by another session that has not finished its download yet. Such a
+ * block is still missing in the block tracker but must not be requested again, unless the request
+ * timed out. Must be called with the session mutex taken. */
+static bool _httpIsBlockInFlight( const _httpSession_t * pSession,
+                                  uint32_t blockIndex,
+                                  TickType_t now )
+{
+    const _httpSession_t * pOther = NULL;
+    uint32_t index = 0;
+    bool isInFlight = false;
 
-        if( _httpReconnect() != IOT_HTTPS_OK )
+    for( index = 0; ( index < HTTP_MAX_NUM_CONNECTIONS ) && ( isInFlight == false ); index++ )
+    {
+        pOther = &_httpDownloader.sessions[ index ];
+
+        if( ( pOther != pSession ) &&
+            ( pOther->state != OTA_HTTP_IDLE ) &&
+            ( pOther->state != OTA_HTTP_STOPPED ) &&
+            ( _httpIsRequestTimedOut( pOther, now ) == false ) &&
+            ( blockIndex >= pOther->currBlock ) &&
+            ( blockIndex < pOther->currBlock + pOther->currNumBlocks ) )
         {
-            status = OTA_HTTP_ERR_NEED_RECONNECT;
+            isInFlight = true;
         }
     }
-    else if( _httpDownloader.state == OTA_HTTP_WAITING_RESPONSE )
+
+    return isInFlight;
+}
+
+/* Find the first block that is not received yet nor requested by another session and the number of
+ * such consecutive blocks that start with it, up to HTTP_MAX_NUM_BLOCKS_REQUEST. Returns false if no
+ * block is left to request. Must be called with the session mutex taken. */
+static bool _httpGetNextMissingBlocks( const _httpSession_t * pSession,
+                                       OTA_FileContext_t * fileContext,
+                                       TickType_t now,
+                                       uint32_t * pFirstBlock,
+                                       uint32_t * pNumBlocks )
+{
+    uint32_t blockIndex = 0;
+    uint32_t runLength = 0;
+    uint32_t numBlocks = 0;
+
+    /* Walk the runs of missing blocks of the tracker until one of them has a block that no other
+     * session is downloading. */
+    runLength = prvBlockTrackerNextMissing( fileContext->pxRxBlockTracker, 0, &blockIndex );
+
+    while( ( runLength > 0 ) && ( numBlocks == 0 ) )
     {
-        IotLogInfo( "Still waiting for a response from the server after request timeout. Assuming "
-                    "the connection is closed by the server, reconnecting..." );
+        while( ( runLength > 0 ) && _httpIsBlockInFlight( pSession, blockIndex, now ) )
+        {
+            blockIndex++;
+            runLength--;
+        }
 
-        if( _httpReconnect() != IOT_HTTPS_OK )
+        while( ( numBlocks < runLength ) &&
+               ( numBlocks < HTTP_MAX_NUM_BLOCKS_REQUEST ) &&
+               ( _httpIsBlockInFlight( pSession, blockIndex + numBlocks, now ) == false ) )
         {
-            status = OTA_HTTP_ERR_NEED_RECONNECT;
+            numBlocks++;
+        }
+
+        if( numBlocks == 0 )
+        {
+            runLength = prvBlockTrackerNextMissing( fileContext->pxRxBlockTracker, blockIndex + runLength, &blockIndex );
         }
     }
 
+    *pFirstBlock = blockIndex;
+    *pNumBlocks = numBlocks;
+
+    return( numBlocks > 0 );
+}
+
+/* Set the byte range of the current request of a session from its first block and number of blocks,
+ * and write the value of its "Range" header. The last block of the file may be shorter than a full
+ * block. Returns false if the value does not fit in the header buffer. */
+static bool _httpSetRange( _httpSession_t * pSession,
+                           uint32_t fileSize )
+{
+    uint32_t rangeStart = pSession->currBlock * OTA_FILE_BLOCK_SIZE;
+    uint32_t rangeEnd = rangeStart + pSession->currNumBlocks * OTA_FILE_BLOCK_SIZE - 1;
+    int numWritten = 0;
+
+    if( rangeEnd >= fileSize )
+    {
+        rangeEnd = fileSize - 1;
+    }
+
+    pSession->currRangeSize = rangeEnd - rangeStart + 1;
+
+    numWritten = snprintf( pSession->httpCallbackData.pRangeValueStr,
+                           HTTP_HEADER_RANGE_VALUE_MAX_LEN,
+                           "bytes=%u-%u",
+                           ( unsigned int ) rangeStart,
+                           ( unsigned int ) rangeEnd );
+
+    return( ( numWritten > 0 ) && ( numWritten < HTTP_HEADER_RANGE_VALUE_MAX_LEN ) );
+}
+
+/* Take a session over from the HTTP callbacks or the previous request to send a new request on it.
+ * This sets the state to sending request so that the HTTP callbacks and the other sessions leave it
+ * alone. Returns OTA_HTTP_ERR_NEED_RECONNECT if the session must reconnect before sending, or
+ * OTA_HTTP_ERR_GENERIC without taking the session over if it is still busy. */
+static _httpErr _httpClaimSession( _httpSession_t * pSession,
+                                   TickType_t now )
+{
+    _httpErr status = OTA_HTTP_ERR_NONE;
+
+    _httpLockSessions();
+
+    /* Reconnect to the HTTP server if we did not receive any response within the response timeout or
+     * we detected an error when processing the last response and a reconnect is needed. */
+    if( _httpIsRequestTimedOut( pSession, now ) )
+    {
+        IotLogInfo( "Still waiting for a response from the server after request timeout. Assuming "
+                    "the connection is closed by the server, reconnecting..." );
+        status = OTA_HTTP_ERR_NEED_RECONNECT;
+    }
+
     /* Otherwise exit if not in idle state, this means we're still sending the request or processing
      * a response. */
-    else if( _httpDownloader.state != OTA_HTTP_IDLE )
+    else if( pSession->state != OTA_HTTP_IDLE )
     {
-        IotLogInfo( "Current download is not finished, skipping the request." );
+        IotLogDebug( "Current download is not finished, skipping the request." );
         status = OTA_HTTP_ERR_GENERIC;
     }
+    else if( pSession->err == OTA_HTTP_ERR_NEED_RECONNECT )
+    {
+        IotLogInfo( "Error happened during last request requires reconnecting." );
+        status = OTA_HTTP_ERR_NEED_RECONNECT;
+    }
     else
     {
         status = OTA_HTTP_ERR_NONE;
     }
 
+    if( status != OTA_HTTP_ERR_GENERIC )
+    {
+        pSession->state = OTA_HTTP_SENDING_REQUEST;
+        pSession->err = OTA_HTTP_ERR_NONE;
+    }
+
+    _httpUnlockSessions();
+
+    return status;
+}
+
+/* Performs some pre-checks before requesting a new block. */
+static _httpErr _requestDataBlockPreCheck( _httpSession_t * pSession )
+{
+    _httpErr status = _httpClaimSession( pSession, xTaskGetTickCount() );
+
+    /* The session mutex is not held here, so the HTTP callbacks of the other sessions keep running
+     * while reconnecting. */
+    if( ( status == OTA_HTTP_ERR_NEED_RECONNECT ) && ( _httpReconnect( pSession ) == IOT_HTTPS_OK ) )
+    {
+        status = OTA_HTTP_ERR_NONE;
+    }
+
+    return status;
+}
+
+/* Request the next run of missing blocks on one session. */
+static OTA_Err_t _httpRequestDataBlock( OTA_AgentContext_t * pAgentCtx,
+                                        OTA_FileContext_t * fileContext,
+                                        _httpSession_t * pSession )
+{
+    /* Return status. */
+    OTA_Err_t status = kOTA_Err_None;
+    IotHttpsReturnCode_t httpsStatus = IOT_HTTPS_OK;
+
+    /* HTTP connection data. */
+    _httpConnection_t * pConnection = &pSession->httpConnection;
+
+    /* HTTP request data. */
+    _httpRequest_t * pRequest = &pSession->httpRequest;
+
+    /* HTTP response data. */
+    _httpResponse_t * pResponse = &pSession->httpResponse;
+
+    /* Whether a block is left to request. */
+    bool hasMissingBlocks = false;
+
+    /* Exit if we're still busy downloading or reconnect is required but failed. */
+    if( _requestDataBlockPreCheck( pSession ) != OTA_HTTP_ERR_NONE )
+    {
+        status = kOTA_Err_HTTPRequestFailed;
+        OTA_GOTO_CLEANUP();
+    }
+
+    /* Request the next run of missing blocks. Blocks that were dropped or failed earlier are
+     * requested again this way. */
+    _httpLockSessions();
+    hasMissingBlocks = _httpGetNextMissingBlocks( pSession,
+                                                  fileContext,
+                                                  xTaskGetTickCount(),
+                                                  &pSession->currBlock,
+                                                  &pSession->currNumBlocks );
+    _httpUnlockSessions();
+
+    if( hasMissingBlocks == false )
+    {
+        IotLogDebug( "No missing block left to request." );
+        status = kOTA_Err_HTTPRequestFailed;
+        OTA_GOTO_CLEANUP();
+    }
+
+    /* Set number of blocks to request. With more than one connection, ask the OTA agent to request
+     * again after every block so that a connection is given a new range as soon as it is idle. */
+    #if ( HTTP_MAX_NUM_CONNECTIONS > 1 )
+        pAgentCtx->ulNumOfBlocksToReceive = 1;
+    #else
+        pAgentCtx->ulNumOfBlocksToReceive = pSession->currNumBlocks;
+    #endif
+
+    pSession->currBlocksRead = 0;
+
+    /* Creating the "range" field in HTTP header. */
+    if( _httpSetRange( pSession, fileContext->ulFileSize ) == false )
+    {
+        IotLogError( "Fail to write the \"Range\" value for HTTP header." );
+        status = kOTA_Err_HTTPRequestFailed;
+        OTA_GOTO_CLEANUP();
+    }
+
+    /* Re-initialize the request handle as it could be changed when handling last response. */
+    httpsStatus = IotHttpsClient_InitializeRequest( &pRequest->requestHandle, &pRequest->requestConfig );
+
+    if( httpsStatus != IOT_HTTPS_OK )
+    {
+        IotLogError( "Fail to initialize the HTTP request. Error code: %d.", httpsStatus );
+        status = kOTA_Err_HTTPRequestFailed;
+        OTA_GOTO_CLEANUP();
+    }
+
+    /* Send the request asynchronously. Receiving is handled in a callback. */
+    IotLogInfo( "Sending HTTP request to download %u block(s) starting at block %u.",
+                ( unsigned int ) pSession->currNumBlocks,
+                ( unsigned int ) pSession->currBlock );
+    pSession->requestTime = xTaskGetTickCount();
+    httpsStatus = IotHttpsClient_SendAsync( pConnection->connectionHandle,
+                                            pRequest->requestHandle,
+                                            &pResponse->responseHandle,
+                                            &pResponse->responseConfig );
+
+    if( httpsStatus != IOT_HTTPS_OK )
+    {
+        IotLogError( "Fail to send the HTTP request asynchronously. Error code: %d.", httpsStatus );
+        status = kOTA_Err_HTTPRequestFailed;
+        OTA_GOTO_CLEANUP();
+    }
+
+    OTA_FUNCTION_CLEANUP_BEGIN();
+
+    /* Reset the state to idle if there's any error occurred, i.e. the request is not sent. */
+    if( status != kOTA_Err_None )
+    {
+        _httpLockSessions();
+
+        if( pSession->state == OTA_HTTP_SENDING_REQUEST )
+        {
+            pSession->state = OTA_HTTP_IDLE;
+        }
+
+        _httpUnlockSessions();
+    }
+
+    OTA_FUNCTION_CLEANUP_END();
+
     return status;
 }
 
@@ -955,9 +1431,26 @@ OTA_Err_t _AwsIotOTA_InitFileTransfer_HTTP( OTA_AgentContext_t * pAgentCtx )
     /* OTA download file size from the HTTP server, this should match otaFileSize. */
     uint32_t httpFileSize = 0;
 
+    /* Index of the HTTP session. */
+    uint32_t index = 0;
+
     /* Store the OTA agent for later use and set state to idle. */
     _httpDownloader.pAgentCtx = pAgentCtx;
-    _httpDownloader.state = OTA_HTTP_IDLE;
+
+    if( _httpDownloader.sessionMutex == NULL )
+    {
+        _httpDownloader.sessionMutex = xSemaphoreCreateMutex();
+        configASSERT( _httpDownloader.sessionMutex != NULL );
+    }
+
+    _httpLockSessions();
+
+    for( index = 0; index < HTTP_MAX_NUM_CONNECTIONS; index++ )
+    {
+        _httpDownloader.sessions[ index ].state = OTA_HTTP_IDLE;
+    }
+
+    _httpUnlockSessions();
 
     if( fileContext == NULL )
     {
@@ -984,10 +1477,13 @@ OTA_Err_t _AwsIotOTA_InitFileTransfer_HTTP( OTA_AgentContext_t * pAgentCtx )
     }
 
     /* Allocate buffers for HTTP library. */
-    if( _httpAllocateBuffers() == false )
+    for( index = 0; index < HTTP_MAX_NUM_CONNECTIONS; index++ )
     {
-        cleanupRequired = true;
-        OTA_GOTO_CLEANUP();
+        if( _httpAllocateBuffers( &_httpDownloader.sessions[ index ] ) == false )
+        {
+            cleanupRequired = true;
+            OTA_GOTO_CLEANUP();
+        }
     }
 
     /* Connect to the HTTP server and initialize download information. */
@@ -1001,7 +1497,7 @@ OTA_Err_t _AwsIotOTA_InitFileTransfer_HTTP( OTA_AgentContext_t * pAgentCtx )
         OTA_GOTO_CLEANUP();
     }
 
-    httpsStatus = _httpConnect( pNetworkInterface, pNetworkCredentials );
+    httpsStatus = _httpConnect( &_httpDownloader.sessions[ 0 ], pNetworkInterface, pNetworkCredentials );
 
     if( httpsStatus != IOT_HTTPS_OK )
     {
@@ -1014,8 +1510,21 @@ OTA_Err_t _AwsIotOTA_InitFileTransfer_HTTP( OTA_AgentContext_t * pAgentCtx )
 
     IotLogInfo( "Successfully connected to %.*s", _httpDownloader.httpUrlInfo.addressLength, _httpDownloader.httpUrlInfo.pAddress );
 
+    /* The download can make progress on the first connection alone, so a failure to open one of the
+     * additional connections is retried when requesting the next block. */
+    for( index = 1; index < HTTP_MAX_NUM_CONNECTIONS; index++ )
+    {
+        httpsStatus = _httpConnect( &_httpDownloader.sessions[ index ], pNetworkInterface, pNetworkCredentials );
+
+        if( httpsStatus != IOT_HTTPS_OK )
+        {
+            IotLogWarn( "Failed to open HTTP connection %u. Error code: %d", ( unsigned int ) index, httpsStatus );
+            _httpDownloader.sessions[ index ].err = OTA_HTTP_ERR_NEED_RECONNECT;
+        }
+    }
+
     /* Check if the file size from HTTP server matches the file size from OTA job document. */
-    if( _httpGetFileSize( &httpFileSize ) != OTA_HTTP_ERR_NONE )
+    if( _httpGetFileSize( &_httpDownloader.sessions[ 0 ], &httpFileSize ) != OTA_HTTP_ERR_NONE )
     {
         IotLogError( "Cannot retrieve the file size from HTTP server." );
         status = kOTA_Err_HTTPInitFailed;
@@ -1041,7 +1550,10 @@ OTA_Err_t _AwsIotOTA_InitFileTransfer_HTTP( OTA_AgentContext_t * pAgentCtx )
 
     if( cleanupRequired )
     {
-        _httpFreeBuffers();
+        for( index = 0; index < HTTP_MAX_NUM_CONNECTIONS; index++ )
+        {
+            _httpFreeBuffers( &_httpDownloader.sessions[ index ] );
+        }
     }
 
     OTA_FUNCTION_CLEANUP_END();
@@ -1054,35 +1566,13 @@ OTA_Err_t _AwsIotOTA_RequestDataBlock_HTTP( OTA_AgentContext_t * pAgentCtx )
     IotLogDebug( "Invoking _AwsIotOTA_RequestDataBlock_HTTP" );
 
     /* Return status. */
-    OTA_Err_t status = kOTA_Err_None;
-    IotHttpsReturnCode_t httpsStatus = IOT_HTTPS_OK;
-
-    /* HTTP connection data. */
-    _httpConnection_t * pConnection = &_httpDownloader.httpConnection;
-
-    /* HTTP request data. */
-    _httpRequest_t * pRequest = &_httpDownloader.httpRequest;
-
-    /* HTTP response data. */
-    _httpResponse_t * pResponse = &_httpDownloader.httpResponse;
-
-    /* Values for the "Range" field in HTTP header. */
-    uint32_t rangeStart = 0;
-    uint32_t rangeEnd = 0;
-    int numWritten = 0;
+    OTA_Err_t status = kOTA_Err_HTTPRequestFailed;
 
     /* File context from OTA agent. */
     OTA_FileContext_t * fileContext = &( pAgentCtx->pxOTA_Files[ pAgentCtx->ulFileIndex ] );
 
-    /* Exit if we're still busy downloading or reconnect is required but failed. */
-    if( _requestDataBlockPreCheck() != OTA_HTTP_ERR_NONE )
-    {
-        status = kOTA_Err_HTTPRequestFailed;
-        OTA_GOTO_CLEANUP();
-    }
-
-    _httpDownloader.state = OTA_HTTP_SENDING_REQUEST;
-    _httpDownloader.err = OTA_HTTP_ERR_NONE;
+    /* Index of the HTTP session. */
+    uint32_t index = 0;
 
     if( fileContext == NULL )
     {
@@ -1091,70 +1581,19 @@ OTA_Err_t _AwsIotOTA_RequestDataBlock_HTTP( OTA_AgentContext_t * pAgentCtx )
         OTA_GOTO_CLEANUP();
     }
 
-    /* Set number of blocks to request to 1. */
-    pAgentCtx->ulNumOfBlocksToReceive = 1;
-
-    /* Calculate ranges. */
-    rangeStart = _httpDownloader.currBlock * OTA_FILE_BLOCK_SIZE;
-
-    if( fileContext->ulBlocksRemaining == 1 )
-    {
-        rangeEnd = fileContext->ulFileSize - 1;
-    }
-    else
-    {
-        rangeEnd = rangeStart + OTA_FILE_BLOCK_SIZE - 1;
-    }
-
-    _httpDownloader.currBlockSize = rangeEnd - rangeStart + 1;
-
-    /* Creating the "range" field in HTTP header. */
-    numWritten = snprintf( _httpDownloader.httpCallbackData.pRangeValueStr,
-                           HTTP_HEADER_RANGE_VALUE_MAX_LEN,
-                           "bytes=%u-%u",
-                           ( unsigned int ) rangeStart,
-                           ( unsigned int ) rangeEnd );
-
-    if( ( numWritten < 0 ) || ( numWritten >= HTTP_HEADER_RANGE_VALUE_MAX_LEN ) )
-    {
-        IotLogError( "Fail to write the \"Range\" value for HTTP header." );
-        status = kOTA_Err_HTTPRequestFailed;
-        OTA_GOTO_CLEANUP();
-    }
-
-    /* Re-initialize the request handle as it could be changed when handling last response. */
-    httpsStatus = IotHttpsClient_InitializeRequest( &pRequest->requestHandle, &pRequest->requestConfig );
-
-    if( httpsStatus != IOT_HTTPS_OK )
-    {
-        IotLogError( "Fail to initialize the HTTP request. Error code: %d.", httpsStatus );
-        status = kOTA_Err_HTTPRequestFailed;
-        OTA_GOTO_CLEANUP();
-    }
-
-    /* Send the request asynchronously. Receiving is handled in a callback. */
-    IotLogInfo( "Sending HTTP request to download block %d.", _httpDownloader.currBlock );
-    httpsStatus = IotHttpsClient_SendAsync( pConnection->connectionHandle,
-                                            pRequest->requestHandle,
-                                            &pResponse->responseHandle,
-                                            &pResponse->responseConfig );
-
-    if( httpsStatus != IOT_HTTPS_OK )
-    {
-        IotLogError( "Fail to send the HTTP request asynchronously. Error code: %d.", httpsStatus );
-        status = kOTA_Err_HTTPRequestFailed;
-        OTA_GOTO_CLEANUP();
-    }
-
-    OTA_FUNCTION_CLEANUP_BEGIN();
-
-    /* Reset the state to idle if there's any error occurred, i.e. the request is not sent. */
-    if( status != kOTA_Err_None )
+    /* Give every idle connection its own range of missing blocks. Ranges in flight on the other
+     * connections are skipped, so the connections always download disjoint parts of the file. A delta
+     * patch is applied in order, so it is downloaded over the first connection only. */
+    for( index = 0; index < HTTP_MAX_NUM_CONNECTIONS; index++ )
     {
-        _httpDownloader.state = OTA_HTTP_IDLE;
+        if( ( ( index == 0 ) || ( fileContext->ulImageSize == 0 ) ) &&
+            ( _httpRequestDataBlock( pAgentCtx, fileContext, &_httpDownloader.sessions[ index ] ) == kOTA_Err_None ) )
+        {
+            status = kOTA_Err_None;
+        }
     }
 
-    OTA_FUNCTION_CLEANUP_END();
+    OTA_FUNCTION_NO_CLEANUP();
 
     return status;
 }
@@ -1169,18 +1608,39 @@ OTA_Err_t _AwsIotOTA_DecodeFileBlock_HTTP( uint8_t * pMessageBuffer,
 {
     IotLogDebug( "Invoking _AwsIotOTA_DecodeFileBlock_HTTP" );
 
-    /* Unused parameters. */
-    ( void ) messageSize;
+    /* Index of the block, stored in front of the block data by _httpProcessResponseBody. */
+    uint32_t blockIndex = 0;
+
+    /* Index of the HTTP session. */
+    uint32_t index = 0;
+
+    /* HTTP session that requested the block. */
+    _httpSession_t * pSession = NULL;
+
+    memcpy( &blockIndex, pMessageBuffer, HTTP_BLOCK_INDEX_SIZE );
 
-    *pPayload = pMessageBuffer;
+    *pPayload = pMessageBuffer + HTTP_BLOCK_INDEX_SIZE;
     *pFileId = 0;
-    *pBlockId = _httpDownloader.currBlock;
-    *pBlockSize = _httpDownloader.currBlockSize;
-    *pPayloadSize = _httpDownloader.currBlockSize;
+    *pBlockId = ( int32_t ) blockIndex;
+    *pBlockSize = ( int32_t ) ( messageSize - HTTP_BLOCK_INDEX_SIZE );
+    *pPayloadSize = messageSize - HTTP_BLOCK_INDEX_SIZE;
 
-    /* Current block is processed, set the file block to next one and the state to idle. */
-    _httpDownloader.state = OTA_HTTP_IDLE;
-    _httpDownloader.currBlock += 1;
+    /* A request is done once its last block is processed, set the state of its session to idle. */
+    _httpLockSessions();
+
+    for( index = 0; index < HTTP_MAX_NUM_CONNECTIONS; index++ )
+    {
+        pSession = &_httpDownloader.sessions[ index ];
+
+        if( ( pSession->state != OTA_HTTP_IDLE ) &&
+            ( pSession->state != OTA_HTTP_STOPPED ) &&
+            ( blockIndex == pSession->currBlock + pSession->currNumBlocks - 1 ) )
+        {
+            pSession->state = OTA_HTTP_IDLE;
+        }
+    }
+
+    _httpUnlockSessions();
 
     return kOTA_Err_None;
 }
@@ -1196,26 +1656,56 @@ OTA_Err_t _AwsIotOTA_CleanupData_HTTP( OTA_AgentContext_t * pAgentCtx )
     /* Return status. */
     IotHttpsReturnCode_t httpsStatus = IOT_HTTPS_OK;
 
-    /* Disconnect from the S3 server. */
-    httpsStatus = IotHttpsClient_Disconnect( _httpDownloader.httpConnection.connectionHandle );
+    /* Index of the HTTP session. */
+    uint32_t index = 0;
+
+    /* HTTP session to clean up. */
+    _httpSession_t * pSession = NULL;
 
-    if( IOT_HTTPS_OK != httpsStatus )
+    for( index = 0; index < HTTP_MAX_NUM_CONNECTIONS; index++ )
     {
-        IotLogDebug( "Failed to disconnect from S3 server. Error code: %d.", httpsStatus );
-    }
+        pSession = &_httpDownloader.sessions[ index ];
 
-    _httpDownloader.httpConnection.connectionHandle = NULL;
+        /* Disconnect from the S3 server. */
+        httpsStatus = IotHttpsClient_Disconnect( pSession->httpConnection.connectionHandle );
 
-    /* Reset downloader state and progress tracker. */
-    _httpDownloader.state = OTA_HTTP_STOPPED;
-    _httpDownloader.err = OTA_HTTP_ERR_NONE;
-    _httpDownloader.currBlock = 0;
-    _httpDownloader.currBlockSize = 0;
+        if( IOT_HTTPS_OK != httpsStatus )
+        {
+            IotLogDebug( "Failed to disconnect from S3 server. Error code: %d.", httpsStatus );
+        }
 
-    if( _httpDownloader.pAgentCtx->eState == eOTA_AgentState_ShuttingDown )
+        pSession->httpConnection.connectionHandle = NULL;
+
+        /* Reset session state and progress tracker. */
+        _httpLockSessions();
+        pSession->state = OTA_HTTP_STOPPED;
+        pSession->err = OTA_HTTP_ERR_NONE;
+        pSession->currBlock = 0;
+        pSession->currNumBlocks = 0;
+        pSession->currBlocksRead = 0;
+        pSession->currRangeSize = 0;
+        _httpUnlockSessions();
+
+        if( _httpDownloader.pAgentCtx->eState == eOTA_AgentState_ShuttingDown )
+        {
+            _httpFreeBuffers( pSession );
+        }
+    }
+
+    /* Every session is stopped, so the HTTP callbacks do not use the mutex anymore. */
+    if( ( _httpDownloader.pAgentCtx->eState == eOTA_AgentState_ShuttingDown ) &&
+        ( _httpDownloader.sessionMutex != NULL ) )
     {
-        _httpFreeBuffers();
+        vSemaphoreDelete( _httpDownloader.sessionMutex );
+        _httpDownloader.sessionMutex = NULL;
     }
 
     return kOTA_Err_None;
 }
+
+/*-----------------------------------------------------------*/
+
+/* Provide access to private members for testing. */
+#ifdef FREERTOS_ENABLE_UNIT_TESTS
+    #include "aws_ota_http_test_access_define.h"
+#endif
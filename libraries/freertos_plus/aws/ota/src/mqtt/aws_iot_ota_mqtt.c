@@ -819,12 +819,14 @@ OTA_Err_t prvRequestFileBlock_Mqtt( OTA_AgentContext_t * pxAgentCtx )
 
     size_t xMsgSizeFromStream;
     uint32_t ulNumBlocks, ulBitmapLen;
+    uint32_t ulFirstBlock = 0;
     uint32_t ulMsgSizeToPublish = 0;
     uint32_t ulTopicLen = 0;
     IotMqttError_t eResult = IOT_MQTT_STATUS_PENDING;
     OTA_Err_t xErr = kOTA_Err_Uninitialized;
     char pcMsg[ OTA_REQUEST_MSG_MAX_SIZE ];
     char pcTopicBuffer[ OTA_MAX_TOPIC_LEN ];
+    uint8_t ucBitmap[ OTA_MAX_BLOCK_BITMAP_SIZE ];
 
     /*
      * Get the current file context.
@@ -837,7 +839,22 @@ OTA_Err_t prvRequestFileBlock_Mqtt( OTA_AgentContext_t * pxAgentCtx )
     if( C != NULL )
     {
         ulNumBlocks = ( C->ulFileSize + ( OTA_FILE_BLOCK_SIZE - 1U ) ) >> otaconfigLOG2_FILE_BLOCK_SIZE;
-        ulBitmapLen = ( ulNumBlocks + ( BITS_PER_BYTE - 1U ) ) >> LOG2_BITS_PER_BYTE;
+
+        /* The bitmap sent to the service starts at the first missing block so that files with more
+         * blocks than fit in a single request are requested one window at a time. */
+        if( prvBlockTrackerNextMissing( C->pxRxBlockTracker, 0U, &ulFirstBlock ) == 0U )
+        {
+            ulFirstBlock = 0U;
+        }
+
+        ulBitmapLen = ( ( ulNumBlocks - ulFirstBlock ) + ( BITS_PER_BYTE - 1U ) ) >> LOG2_BITS_PER_BYTE;
+
+        if( ulBitmapLen > OTA_MAX_BLOCK_BITMAP_SIZE )
+        {
+            ulBitmapLen = OTA_MAX_BLOCK_BITMAP_SIZE;
+        }
+
+        prvBlockTrackerGetBitmap( C->pxRxBlockTracker, ulFirstBlock, ucBitmap, ulBitmapLen );
 
         if( pdTRUE == OTA_CBOR_Encode_GetStreamRequestMessage(
                 ( uint8_t * ) pcMsg,
@@ -846,8 +863,8 @@ OTA_Err_t prvRequestFileBlock_Mqtt( OTA_AgentContext_t * pxAgentCtx )
                 OTA_CLIENT_TOKEN,
                 ( int32_t ) C->ulServerFileID,
                 ( int32_t ) ( OTA_FILE_BLOCK_SIZE & 0x7fffffffUL ), /* Mask to keep lint happy. It's still a constant. */
-                0,
-                C->pucRxBlockBitmap,
+                ( int32_t ) ulFirstBlock,
+                ucBitmap,
                 ulBitmapLen,
                 otaconfigMAX_NUM_BLOCKS_REQUEST ) )
         {
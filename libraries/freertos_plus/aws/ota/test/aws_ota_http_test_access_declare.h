@@ -0,0 +1,79 @@
+/*
+ * FreeRTOS OTA V1.2.1
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+/**
+ * @file aws_ota_http_test_access_declare.h
+ * @brief Declarations of functions that access private methods in aws_iot_ota_http.c.
+ *
+ * Needed for testing private functions.
+ */
+
+#ifndef _AWS_OTA_HTTP_TEST_ACCESS_DECLARE_H_
+#define _AWS_OTA_HTTP_TEST_ACCESS_DECLARE_H_
+
+#include "aws_iot_ota_types.h"
+#include "aws_iot_ota_agent.h"
+#include "aws_iot_ota_agent_internal.h"
+
+bool TEST_OTA_HTTP_SetRange( uint32_t firstBlock,
+                             uint32_t numBlocks,
+                             uint32_t fileSize,
+                             const char ** ppRangeValue,
+                             uint32_t * pRangeSize );
+
+uint32_t TEST_OTA_HTTP_GetBlockSize( uint32_t rangeSize,
+                                     uint32_t blockInRequest );
+
+void TEST_OTA_HTTP_FillEventBuffer( OTA_EventData_t * pMessage,
+                                    uint32_t blockIndex,
+                                    const uint8_t * pBlock,
+                                    uint32_t blockSize );
+
+uint32_t TEST_OTA_HTTP_GetNumSessions( void );
+
+TickType_t TEST_OTA_HTTP_GetResponseTimeout( void );
+
+void TEST_OTA_HTTP_ResetSessions( void );
+
+void TEST_OTA_HTTP_SendRequest( uint32_t sessionIndex,
+                                uint32_t firstBlock,
+                                uint32_t numBlocks,
+                                TickType_t requestTime );
+
+void TEST_OTA_HTTP_CloseConnection( uint32_t sessionIndex );
+
+bool TEST_OTA_HTTP_StartProcessingResponse( uint32_t sessionIndex );
+
+bool TEST_OTA_HTTP_ClaimSession( uint32_t sessionIndex,
+                                 TickType_t now,
+                                 bool * pNeedReconnect );
+
+bool TEST_OTA_HTTP_GetNextMissingBlocks( uint32_t sessionIndex,
+                                         OTA_FileContext_t * fileContext,
+                                         TickType_t now,
+                                         uint32_t * pFirstBlock,
+                                         uint32_t * pNumBlocks );
+
+#endif /* ifndef _AWS_OTA_HTTP_TEST_ACCESS_DECLARE_H_ */
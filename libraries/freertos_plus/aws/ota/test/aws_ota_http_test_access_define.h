@@ -0,0 +1,180 @@
+/*
+ * FreeRTOS OTA V1.2.1
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+/**
+ * @file aws_ota_http_test_access_define.h
+ * @brief Function wrappers that access private methods in aws_iot_ota_http.c.
+ *
+ * Needed for testing private functions.
+ */
+
+#ifndef _AWS_OTA_HTTP_TEST_ACCESS_DEFINE_H_
+#define _AWS_OTA_HTTP_TEST_ACCESS_DEFINE_H_
+
+/*-----------------------------------------------------------*/
+
+bool TEST_OTA_HTTP_SetRange( uint32_t firstBlock,
+                             uint32_t numBlocks,
+                             uint32_t fileSize,
+                             const char ** ppRangeValue,
+                             uint32_t * pRangeSize )
+{
+    _httpSession_t * pSession = &_httpDownloader.sessions[ 0 ];
+    bool result = false;
+
+    pSession->currBlock = firstBlock;
+    pSession->currNumBlocks = numBlocks;
+
+    result = _httpSetRange( pSession, fileSize );
+
+    *ppRangeValue = pSession->httpCallbackData.pRangeValueStr;
+    *pRangeSize = pSession->currRangeSize;
+
+    return result;
+}
+
+/*-----------------------------------------------------------*/
+
+uint32_t TEST_OTA_HTTP_GetBlockSize( uint32_t rangeSize,
+                                     uint32_t blockInRequest )
+{
+    _httpSession_t * pSession = &_httpDownloader.sessions[ 0 ];
+
+    pSession->currRangeSize = rangeSize;
+
+    return _httpGetBlockSize( pSession, blockInRequest );
+}
+
+/*-----------------------------------------------------------*/
+
+void TEST_OTA_HTTP_FillEventBuffer( OTA_EventData_t * pMessage,
+                                    uint32_t blockIndex,
+                                    const uint8_t * pBlock,
+                                    uint32_t blockSize )
+{
+    _httpFillEventBuffer( pMessage, blockIndex, pBlock, blockSize );
+}
+
+/*-----------------------------------------------------------*/
+
+uint32_t TEST_OTA_HTTP_GetNumSessions( void )
+{
+    return HTTP_MAX_NUM_CONNECTIONS;
+}
+
+/*-----------------------------------------------------------*/
+
+TickType_t TEST_OTA_HTTP_GetResponseTimeout( void )
+{
+    return pdMS_TO_TICKS( HTTP_RESPONSE_TIMEOUT_MS );
+}
+
+/*-----------------------------------------------------------*/
+
+void TEST_OTA_HTTP_ResetSessions( void )
+{
+    uint32_t index = 0;
+
+    if( _httpDownloader.sessionMutex == NULL )
+    {
+        _httpDownloader.sessionMutex = xSemaphoreCreateMutex();
+        configASSERT( _httpDownloader.sessionMutex != NULL );
+    }
+
+    for( index = 0; index < HTTP_MAX_NUM_CONNECTIONS; index++ )
+    {
+        _httpDownloader.sessions[ index ].state = OTA_HTTP_IDLE;
+        _httpDownloader.sessions[ index ].err = OTA_HTTP_ERR_NONE;
+        _httpDownloader.sessions[ index ].requestTime = 0;
+        _httpDownloader.sessions[ index ].currBlock = 0;
+        _httpDownloader.sessions[ index ].currNumBlocks = 0;
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+void TEST_OTA_HTTP_SendRequest( uint32_t sessionIndex,
+                                uint32_t firstBlock,
+                                uint32_t numBlocks,
+                                TickType_t requestTime )
+{
+    _httpSession_t * pSession = &_httpDownloader.sessions[ sessionIndex ];
+
+    /* The request is sent and the HTTP client added its header. */
+    pSession->currBlock = firstBlock;
+    pSession->currNumBlocks = numBlocks;
+    pSession->requestTime = requestTime;
+    pSession->state = OTA_HTTP_WAITING_RESPONSE;
+}
+
+/*-----------------------------------------------------------*/
+
+void TEST_OTA_HTTP_CloseConnection( uint32_t sessionIndex )
+{
+    _httpConnectionClosedCallback( &_httpDownloader.sessions[ sessionIndex ], NULL, IOT_HTTPS_OK );
+}
+
+/*-----------------------------------------------------------*/
+
+bool TEST_OTA_HTTP_StartProcessingResponse( uint32_t sessionIndex )
+{
+    return _httpStartProcessingResponse( &_httpDownloader.sessions[ sessionIndex ] );
+}
+
+/*-----------------------------------------------------------*/
+
+bool TEST_OTA_HTTP_ClaimSession( uint32_t sessionIndex,
+                                 TickType_t now,
+                                 bool * pNeedReconnect )
+{
+    _httpErr status = _httpClaimSession( &_httpDownloader.sessions[ sessionIndex ], now );
+
+    *pNeedReconnect = ( status == OTA_HTTP_ERR_NEED_RECONNECT );
+
+    return( status != OTA_HTTP_ERR_GENERIC );
+}
+
+/*-----------------------------------------------------------*/
+
+bool TEST_OTA_HTTP_GetNextMissingBlocks( uint32_t sessionIndex,
+                                         OTA_FileContext_t * fileContext,
+                                         TickType_t now,
+                                         uint32_t * pFirstBlock,
+                                         uint32_t * pNumBlocks )
+{
+    bool result = false;
+
+    _httpLockSessions();
+    result = _httpGetNextMissingBlocks( &_httpDownloader.sessions[ sessionIndex ],
+                                        fileContext,
+                                        now,
+                                        pFirstBlock,
+                                        pNumBlocks );
+    _httpUnlockSessions();
+
+    return result;
+}
+
+#endif /* _AWS_OTA_HTTP_TEST_ACCESS_DEFINE_H_ */
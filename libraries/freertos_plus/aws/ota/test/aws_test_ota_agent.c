@@ -68,6 +68,12 @@
 #define otatestCERT_FILE                  "rsasigner.crt"
 #define otatestATTRIBUTES                 3
 #define otatestFILE_ID                    0
+
+/* A multi-MB image split into small blocks, far more blocks than a flat bitmap of
+ * OTA_MAX_BLOCK_BITMAP_SIZE bytes can track. */
+#define otatestTRACKER_IMAGE_SIZE         ( 8UL * 1024UL * 1024UL )
+#define otatestTRACKER_BLOCK_SIZE         256UL
+#define otatestTRACKER_NUM_BLOCKS         ( otatestTRACKER_IMAGE_SIZE / otatestTRACKER_BLOCK_SIZE )
 static const uint8_t ucOtatestSIGNATURE[] =
 {
     0x38, 0x78, 0xf9, 0xb0, 0xd8, 0xf1, 0xa8, 0xc3, 0x4a, 0xdd, 0x63, 0x44, 0xc1, 0xbc, 0x9f, 0xb3,
@@ -235,6 +241,10 @@ TEST_GROUP_RUNNER( Full_OTA_AGENT )
     RUN_TEST_CASE( Full_OTA_AGENT, OTA_GetStatistics_BeforeInit );
     RUN_TEST_CASE( Full_OTA_AGENT, prvParseJobDocFromJSONandPrvOTA_Close );
     RUN_TEST_CASE( Full_OTA_AGENT, prvParseJSONbyModel_Errors );
+    RUN_TEST_CASE( Full_OTA_AGENT, prvBlockTracker_LargeImage );
+    RUN_TEST_CASE( Full_OTA_AGENT, prvBlockTracker_Bitmap );
+    RUN_TEST_CASE( Full_OTA_AGENT, prvCheckpoint_ResumeSameFile );
+    RUN_TEST_CASE( Full_OTA_AGENT, prvCheckpoint_RejectOtherFile );
 }
 
 TEST( Full_OTA_AGENT, OTA_SetImageState_AbortBeforeInit )
@@ -494,3 +504,206 @@ TEST( Full_OTA_AGENT, prvParseJSONbyModel_Errors )
     /* Shut down the OTA Agent. */
     ( void ) OTA_AgentShutdown( otatestSHUTDOWN_WAIT );
 }
+
+TEST( Full_OTA_AGENT, prvBlockTracker_LargeImage )
+{
+    OTA_BlockTracker_t * pxTracker = NULL;
+    uint32_t ulFirstBlock = 0;
+    uint32_t ulNumBlocks = 0;
+    uint32_t ulNumReceived = 0;
+    uint32_t ulBlock = 0;
+    uint32_t ulStride = otatestTRACKER_NUM_BLOCKS / ( OTA_MAX_BLOCK_RANGES + 1U );
+
+    pxTracker = prvBlockTrackerCreate( otatestTRACKER_NUM_BLOCKS );
+    TEST_ASSERT_NOT_NULL( pxTracker );
+
+    if( TEST_PROTECT() )
+    {
+        /* The whole image is a single missing run. */
+        TEST_ASSERT_EQUAL_UINT32( otatestTRACKER_NUM_BLOCKS, prvBlockTrackerNextMissing( pxTracker, 0, &ulFirstBlock ) );
+        TEST_ASSERT_EQUAL_UINT32( 0, ulFirstBlock );
+        TEST_ASSERT_TRUE( prvBlockTrackerIsMissing( pxTracker, otatestTRACKER_NUM_BLOCKS - 1U ) );
+        TEST_ASSERT_FALSE( prvBlockTrackerIsMissing( pxTracker, otatestTRACKER_NUM_BLOCKS ) );
+
+        /* Receive a block in the middle of each stride until all runs are in use. */
+        for( ulBlock = ulStride; ulBlock < ( OTA_MAX_BLOCK_RANGES * ulStride ); ulBlock += ulStride )
+        {
+            TEST_ASSERT_TRUE( prvBlockTrackerMarkReceived( pxTracker, ulBlock ) );
+            ulNumReceived++;
+        }
+
+        TEST_ASSERT_EQUAL_UINT32( OTA_MAX_BLOCK_RANGES, pxTracker->ulNumRanges );
+
+        /* No room to split another run, the block must stay missing. */
+        ulBlock = ( OTA_MAX_BLOCK_RANGES * ulStride ) + 1U;
+        TEST_ASSERT_FALSE( prvBlockTrackerMarkReceived( pxTracker, ulBlock ) );
+        TEST_ASSERT_TRUE( prvBlockTrackerIsMissing( pxTracker, ulBlock ) );
+
+        /* Duplicates are rejected and blocks at the edge of a run are still accepted. */
+        TEST_ASSERT_FALSE( prvBlockTrackerMarkReceived( pxTracker, ulStride ) );
+        TEST_ASSERT_TRUE( prvBlockTrackerMarkReceived( pxTracker, ulStride + 1U ) );
+        ulNumReceived++;
+
+        /* The next missing run starts after the received blocks. */
+        TEST_ASSERT_EQUAL_UINT32( ulStride - 2U, prvBlockTrackerNextMissing( pxTracker, ulStride, &ulFirstBlock ) );
+        TEST_ASSERT_EQUAL_UINT32( ulStride + 2U, ulFirstBlock );
+
+        /* Receive the rest the way the agent requests it, one missing run at a time. */
+        while( ( ulNumBlocks = prvBlockTrackerNextMissing( pxTracker, 0, &ulFirstBlock ) ) > 0U )
+        {
+            for( ulBlock = ulFirstBlock; ulBlock < ( ulFirstBlock + ulNumBlocks ); ulBlock++ )
+            {
+                TEST_ASSERT_TRUE( prvBlockTrackerMarkReceived( pxTracker, ulBlock ) );
+                ulNumReceived++;
+            }
+        }
+
+        TEST_ASSERT_EQUAL_UINT32( otatestTRACKER_NUM_BLOCKS, ulNumReceived );
+        TEST_ASSERT_EQUAL_UINT32( 0, pxTracker->ulNumRanges );
+    }
+
+    prvBlockTrackerDelete( pxTracker );
+}
+
+TEST( Full_OTA_AGENT, prvBlockTracker_Bitmap )
+{
+    OTA_BlockTracker_t * pxTracker = NULL;
+    uint8_t ucBitmap[ OTA_MAX_BLOCK_BITMAP_SIZE ];
+    uint32_t ulOffset = otatestTRACKER_NUM_BLOCKS / 2U;
+    uint32_t ulBlock = 0;
+
+    pxTracker = prvBlockTrackerCreate( otatestTRACKER_NUM_BLOCKS );
+    TEST_ASSERT_NOT_NULL( pxTracker );
+
+    if( TEST_PROTECT() )
+    {
+        /* Receive every other block of the first byte of a window in the middle of the image. */
+        for( ulBlock = ulOffset; ulBlock < ( ulOffset + 8U ); ulBlock += 2U )
+        {
+            TEST_ASSERT_TRUE( prvBlockTrackerMarkReceived( pxTracker, ulBlock ) );
+        }
+
+        prvBlockTrackerGetBitmap( pxTracker, ulOffset, ucBitmap, sizeof( ucBitmap ) );
+        TEST_ASSERT_EQUAL_HEX8( 0xaa, ucBitmap[ 0 ] );
+        TEST_ASSERT_EQUAL_HEX8( 0xff, ucBitmap[ 1 ] );
+        TEST_ASSERT_EQUAL_HEX8( 0xff, ucBitmap[ sizeof( ucBitmap ) - 1U ] );
+
+        /* Blocks past the end of the image are never requested. */
+        prvBlockTrackerGetBitmap( pxTracker, otatestTRACKER_NUM_BLOCKS - 3U, ucBitmap, sizeof( ucBitmap ) );
+        TEST_ASSERT_EQUAL_HEX8( 0x07, ucBitmap[ 0 ] );
+        TEST_ASSERT_EQUAL_HEX8( 0x00, ucBitmap[ 1 ] );
+    }
+
+    prvBlockTrackerDelete( pxTracker );
+}
+
+TEST( Full_OTA_AGENT, prvCheckpoint_ResumeSameFile )
+{
+    OTA_FileContext_t xFile = { 0 };
+    OTA_FileContext_t xResumedFile = { 0 };
+    OTA_Checkpoint_t xCheckpoint;
+    Sig256_t xSig = { 0 };
+    uint32_t ulNumBlocks = ( otatestTRACKER_IMAGE_SIZE + ( OTA_FILE_BLOCK_SIZE - 1U ) ) >> otaconfigLOG2_FILE_BLOCK_SIZE;
+    uint32_t ulFirstBlock = 0;
+    uint32_t ulResumedFirstBlock = 0;
+    uint32_t ulBlock = 0;
+
+    xSig.usSize = sizeof( ucOtatestSIGNATURE );
+    memcpy( xSig.ucData, ucOtatestSIGNATURE, sizeof( ucOtatestSIGNATURE ) );
+
+    xFile.pucJobName = ( uint8_t * ) "AFR_OTA-resume-test";
+    xFile.ulServerFileID = otatestFILE_ID;
+    xFile.ulFileSize = otatestTRACKER_IMAGE_SIZE;
+    xFile.pxSignature = &xSig;
+    xFile.pxRxBlockTracker = prvBlockTrackerCreate( ulNumBlocks );
+    TEST_ASSERT_NOT_NULL( xFile.pxRxBlockTracker );
+
+    xResumedFile = xFile;
+    xResumedFile.pxRxBlockTracker = prvBlockTrackerCreate( ulNumBlocks );
+
+    if( TEST_PROTECT() )
+    {
+        TEST_ASSERT_NOT_NULL( xResumedFile.pxRxBlockTracker );
+
+        /* Receive the first quarter of the file and a few blocks further on before the interruption. */
+        for( ulBlock = 0; ulBlock < ( ulNumBlocks / 4U ); ulBlock++ )
+        {
+            TEST_ASSERT_TRUE( prvBlockTrackerMarkReceived( xFile.pxRxBlockTracker, ulBlock ) );
+        }
+
+        TEST_ASSERT_TRUE( prvBlockTrackerMarkReceived( xFile.pxRxBlockTracker, ulNumBlocks / 2U ) );
+        TEST_ASSERT_TRUE( prvBlockTrackerMarkReceived( xFile.pxRxBlockTracker, ulNumBlocks - 1U ) );
+
+        TEST_ASSERT_TRUE( prvCheckpointCreate( &xCheckpoint, &xFile ) );
+
+        /* The same job is received again after a reset. */
+        TEST_ASSERT_TRUE( prvCheckpointMatches( &xCheckpoint, &xResumedFile ) );
+        prvCheckpointRestore( &xCheckpoint, &xResumedFile );
+
+        /* Only the missing blocks are left to request. */
+        TEST_ASSERT_EQUAL_UINT32( ulNumBlocks - ( ulNumBlocks / 4U ) - 2U, xResumedFile.ulBlocksRemaining );
+        TEST_ASSERT_FALSE( prvBlockTrackerIsMissing( xResumedFile.pxRxBlockTracker, 0 ) );
+        TEST_ASSERT_FALSE( prvBlockTrackerIsMissing( xResumedFile.pxRxBlockTracker, ulNumBlocks / 2U ) );
+        TEST_ASSERT_EQUAL_UINT32( prvBlockTrackerNextMissing( xFile.pxRxBlockTracker, 0, &ulFirstBlock ),
+                                  prvBlockTrackerNextMissing( xResumedFile.pxRxBlockTracker, 0, &ulResumedFirstBlock ) );
+        TEST_ASSERT_EQUAL_UINT32( ulNumBlocks / 4U, ulResumedFirstBlock );
+    }
+
+    prvBlockTrackerDelete( xFile.pxRxBlockTracker );
+    prvBlockTrackerDelete( xResumedFile.pxRxBlockTracker );
+}
+
+TEST( Full_OTA_AGENT, prvCheckpoint_RejectOtherFile )
+{
+    OTA_FileContext_t xFile = { 0 };
+    OTA_FileContext_t xOtherFile = { 0 };
+    OTA_Checkpoint_t xCheckpoint;
+    Sig256_t xSig = { 0 };
+    Sig256_t xOtherSig = { 0 };
+    uint32_t ulNumBlocks = ( otatestTRACKER_IMAGE_SIZE + ( OTA_FILE_BLOCK_SIZE - 1U ) ) >> otaconfigLOG2_FILE_BLOCK_SIZE;
+
+    xSig.usSize = sizeof( ucOtatestSIGNATURE );
+    memcpy( xSig.ucData, ucOtatestSIGNATURE, sizeof( ucOtatestSIGNATURE ) );
+
+    xFile.pucJobName = ( uint8_t * ) "AFR_OTA-resume-test";
+    xFile.ulServerFileID = otatestFILE_ID;
+    xFile.ulFileSize = otatestTRACKER_IMAGE_SIZE;
+    xFile.pxSignature = &xSig;
+    xFile.pxRxBlockTracker = prvBlockTrackerCreate( ulNumBlocks );
+    TEST_ASSERT_NOT_NULL( xFile.pxRxBlockTracker );
+
+    if( TEST_PROTECT() )
+    {
+        TEST_ASSERT_TRUE( prvBlockTrackerMarkReceived( xFile.pxRxBlockTracker, 0 ) );
+        TEST_ASSERT_TRUE( prvCheckpointCreate( &xCheckpoint, &xFile ) );
+        TEST_ASSERT_TRUE( prvCheckpointMatches( &xCheckpoint, &xFile ) );
+
+        /* Another job. */
+        xOtherFile = xFile;
+        xOtherFile.pucJobName = ( uint8_t * ) "AFR_OTA-other-job";
+        TEST_ASSERT_FALSE( prvCheckpointMatches( &xCheckpoint, &xOtherFile ) );
+
+        /* Same job, different file size. */
+        xOtherFile = xFile;
+        xOtherFile.ulFileSize = otatestTRACKER_IMAGE_SIZE / 2U;
+        TEST_ASSERT_FALSE( prvCheckpointMatches( &xCheckpoint, &xOtherFile ) );
+
+        /* Same job, different content. */
+        xOtherSig = xSig;
+        xOtherSig.ucData[ 0 ] ^= 0xffU;
+        xOtherFile = xFile;
+        xOtherFile.pxSignature = &xOtherSig;
+        TEST_ASSERT_FALSE( prvCheckpointMatches( &xCheckpoint, &xOtherFile ) );
+
+        /* Checkpoint damaged in storage. */
+        xCheckpoint.xRxBlockTracker.xRanges[ 0 ].ulStart ^= 1U;
+        TEST_ASSERT_FALSE( prvCheckpointMatches( &xCheckpoint, &xFile ) );
+
+        /* Job names too long to be stored are not checkpointed. */
+        xOtherFile = xFile;
+        xOtherFile.pucJobName = ( uint8_t * ) "AFR_OTA-0123456789012345678901234567890123456789012345678901234567890123456789";
+        TEST_ASSERT_FALSE( prvCheckpointCreate( &xCheckpoint, &xOtherFile ) );
+    }
+
+    prvBlockTrackerDelete( xFile.pxRxBlockTracker );
+}
@@ -573,7 +573,6 @@ TEST( Full_OTA_CBOR, CborOtaAgentIngestStreamResponse )
     OTA_FileContext_t xOTAFileContext = { 0 };
     Sig256_t xSig = { 0 };
     uint8_t * pucInFile = NULL;
-    size_t xBlockBitmapSize = 0;
     uint8_t ucSignature[] =
     {
         0x38, 0x78, 0xf9, 0xb0, 0xd8, 0xf1, 0xa8, 0xc3, 0x4a, 0xdd, 0x63, 0x44, 0xc1, 0xbc, 0x9f, 0xb3,
@@ -616,10 +615,8 @@ TEST( Full_OTA_CBOR, CborOtaAgentIngestStreamResponse )
         xOTAFileContext.ulBlocksRemaining++;
     }
 
-    xBlockBitmapSize = 1 + ( xOTAFileContext.ulFileSize / BITS_PER_BYTE );
-    xOTAFileContext.pucRxBlockBitmap = pvPortMalloc( xBlockBitmapSize );
-    TEST_ASSERT_NOT_NULL( xOTAFileContext.pucRxBlockBitmap );
-    memset( xOTAFileContext.pucRxBlockBitmap, 0xFF, xBlockBitmapSize );
+    xOTAFileContext.pxRxBlockTracker = prvBlockTrackerCreate( xOTAFileContext.ulBlocksRemaining );
+    TEST_ASSERT_NOT_NULL( xOTAFileContext.pxRxBlockTracker );
 
     xOTAFileContext.pucCertFilepath = "rsasigner.crt";
     xOTAFileContext.pxSignature = &xSig;
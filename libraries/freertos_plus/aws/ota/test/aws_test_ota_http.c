@@ -0,0 +1,361 @@
+/*
+ * FreeRTOS OTA V1.2.1
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+/* Standard includes. */
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+
+#include "unity_fixture.h"
+#include "unity.h"
+#include "aws_ota_http_test_access_declare.h"
+#include "aws_iot_ota_agent.h"
+#include "aws_iot_ota_agent_internal.h"
+#include "http/aws_iot_ota_http.h"
+
+/**
+ * @brief Configuration for this test group.
+ */
+#define otahttptestFILE_SIZE          ( 5UL * OTA_FILE_BLOCK_SIZE + 100UL )
+#define otahttptestRANGE_VALUE_LEN    ( 32 )
+#define otahttptestBLOCK_INDEX_SIZE   ( sizeof( uint32_t ) )
+#define otahttptestTRACKER_NUM_BLOCKS ( 64UL )
+
+/*-----------------------------------------------------------*/
+
+/* Event buffers filled by the tests, large enough for all blocks of a multi-block response. */
+static OTA_EventData_t xEventBuffers[ 3 ];
+
+/* Response body of a multi-block request. */
+static uint8_t ucResponseBody[ 3 * OTA_FILE_BLOCK_SIZE ];
+
+/* File whose missing blocks are requested by the sessions. */
+static OTA_FileContext_t xFileContext;
+
+/*-----------------------------------------------------------*/
+
+/* Write the Range header value expected for bytes [ulStart, ulEnd]. */
+static void prvExpectedRange( char * pcRange,
+                              uint32_t ulStart,
+                              uint32_t ulEnd )
+{
+    snprintf( pcRange, otahttptestRANGE_VALUE_LEN, "bytes=%u-%u", ( unsigned int ) ulStart, ( unsigned int ) ulEnd );
+}
+
+/*-----------------------------------------------------------*/
+
+TEST_GROUP( Full_OTA_HTTP );
+
+TEST_SETUP( Full_OTA_HTTP )
+{
+    uint32_t ulIndex = 0;
+
+    memset( xEventBuffers, 0, sizeof( xEventBuffers ) );
+
+    for( ulIndex = 0; ulIndex < sizeof( ucResponseBody ); ulIndex++ )
+    {
+        ucResponseBody[ ulIndex ] = ( uint8_t ) ( ulIndex * 7U );
+    }
+
+    TEST_OTA_HTTP_ResetSessions();
+
+    memset( &xFileContext, 0, sizeof( xFileContext ) );
+    xFileContext.pxRxBlockTracker = prvBlockTrackerCreate( otahttptestTRACKER_NUM_BLOCKS );
+    TEST_ASSERT_NOT_NULL( xFileContext.pxRxBlockTracker );
+}
+
+TEST_TEAR_DOWN( Full_OTA_HTTP )
+{
+    prvBlockTrackerDelete( xFileContext.pxRxBlockTracker );
+    xFileContext.pxRxBlockTracker = NULL;
+}
+
+TEST_GROUP_RUNNER( Full_OTA_HTTP )
+{
+    RUN_TEST_CASE( Full_OTA_HTTP, SetRange_SingleBlock );
+    RUN_TEST_CASE( Full_OTA_HTTP, SetRange_MultiBlock );
+    RUN_TEST_CASE( Full_OTA_HTTP, SetRange_MultiBlockShortLastBlock );
+    RUN_TEST_CASE( Full_OTA_HTTP, GetBlockSize_SplitsRange );
+    RUN_TEST_CASE( Full_OTA_HTTP, DecodeFileBlock_BlockIndexPrefix );
+    RUN_TEST_CASE( Full_OTA_HTTP, DecodeFileBlock_MultiBlockBody );
+    RUN_TEST_CASE( Full_OTA_HTTP, ClaimSession_IdleAndBusy );
+    RUN_TEST_CASE( Full_OTA_HTTP, ClaimSession_TimedOutRequest );
+    RUN_TEST_CASE( Full_OTA_HTTP, GetNextMissingBlocks_SkipsBlocksInFlight );
+    RUN_TEST_CASE( Full_OTA_HTTP, GetNextMissingBlocks_ReissuesTimedOutRequest );
+}
+
+/*-----------------------------------------------------------*/
+
+TEST( Full_OTA_HTTP, SetRange_SingleBlock )
+{
+    const char * pcRange = NULL;
+    uint32_t ulRangeSize = 0;
+    char cExpected[ otahttptestRANGE_VALUE_LEN ];
+
+    TEST_ASSERT_TRUE( TEST_OTA_HTTP_SetRange( 1, 1, otahttptestFILE_SIZE, &pcRange, &ulRangeSize ) );
+
+    prvExpectedRange( cExpected, OTA_FILE_BLOCK_SIZE, 2 * OTA_FILE_BLOCK_SIZE - 1 );
+    TEST_ASSERT_EQUAL_STRING( cExpected, pcRange );
+    TEST_ASSERT_EQUAL_UINT32( OTA_FILE_BLOCK_SIZE, ulRangeSize );
+}
+
+TEST( Full_OTA_HTTP, SetRange_MultiBlock )
+{
+    const char * pcRange = NULL;
+    uint32_t ulRangeSize = 0;
+    char cExpected[ otahttptestRANGE_VALUE_LEN ];
+
+    /* Blocks 2, 3 and 4 are requested with one Range header. */
+    TEST_ASSERT_TRUE( TEST_OTA_HTTP_SetRange( 2, 3, otahttptestFILE_SIZE, &pcRange, &ulRangeSize ) );
+
+    prvExpectedRange( cExpected, 2 * OTA_FILE_BLOCK_SIZE, 5 * OTA_FILE_BLOCK_SIZE - 1 );
+    TEST_ASSERT_EQUAL_STRING( cExpected, pcRange );
+    TEST_ASSERT_EQUAL_UINT32( 3 * OTA_FILE_BLOCK_SIZE, ulRangeSize );
+}
+
+TEST( Full_OTA_HTTP, SetRange_MultiBlockShortLastBlock )
+{
+    const char * pcRange = NULL;
+    uint32_t ulRangeSize = 0;
+    char cExpected[ otahttptestRANGE_VALUE_LEN ];
+
+    /* The range of a request that covers the last block ends at the last byte of the file. */
+    TEST_ASSERT_TRUE( TEST_OTA_HTTP_SetRange( 4, 3, otahttptestFILE_SIZE, &pcRange, &ulRangeSize ) );
+
+    prvExpectedRange( cExpected, 4 * OTA_FILE_BLOCK_SIZE, otahttptestFILE_SIZE - 1 );
+    TEST_ASSERT_EQUAL_STRING( cExpected, pcRange );
+    TEST_ASSERT_EQUAL_UINT32( OTA_FILE_BLOCK_SIZE + 100UL, ulRangeSize );
+}
+
+TEST( Full_OTA_HTTP, GetBlockSize_SplitsRange )
+{
+    uint32_t ulRangeSize = 2 * OTA_FILE_BLOCK_SIZE + 100UL;
+
+    TEST_ASSERT_EQUAL_UINT32( OTA_FILE_BLOCK_SIZE, TEST_OTA_HTTP_GetBlockSize( ulRangeSize, 0 ) );
+    TEST_ASSERT_EQUAL_UINT32( OTA_FILE_BLOCK_SIZE, TEST_OTA_HTTP_GetBlockSize( ulRangeSize, 1 ) );
+    TEST_ASSERT_EQUAL_UINT32( 100UL, TEST_OTA_HTTP_GetBlockSize( ulRangeSize, 2 ) );
+    TEST_ASSERT_EQUAL_UINT32( OTA_FILE_BLOCK_SIZE, TEST_OTA_HTTP_GetBlockSize( OTA_FILE_BLOCK_SIZE, 0 ) );
+}
+
+TEST( Full_OTA_HTTP, DecodeFileBlock_BlockIndexPrefix )
+{
+    OTA_EventData_t * pxMessage = &xEventBuffers[ 0 ];
+    int32_t lFileId = -1;
+    int32_t lBlockId = -1;
+    int32_t lBlockSize = -1;
+    uint8_t * pucPayload = NULL;
+    size_t xPayloadSize = 0;
+
+    TEST_OTA_HTTP_FillEventBuffer( pxMessage, 3, ucResponseBody, 100 );
+
+    TEST_ASSERT_EQUAL_UINT32( otahttptestBLOCK_INDEX_SIZE + 100, pxMessage->ulDataLength );
+    TEST_ASSERT_EQUAL( kOTA_Err_None,
+                       _AwsIotOTA_DecodeFileBlock_HTTP( pxMessage->ucData,
+                                                        pxMessage->ulDataLength,
+                                                        &lFileId,
+                                                        &lBlockId,
+                                                        &lBlockSize,
+                                                        &pucPayload,
+                                                        &xPayloadSize ) );
+
+    TEST_ASSERT_EQUAL_INT32( 0, lFileId );
+    TEST_ASSERT_EQUAL_INT32( 3, lBlockId );
+    TEST_ASSERT_EQUAL_INT32( 100, lBlockSize );
+    TEST_ASSERT_EQUAL_PTR( pxMessage->ucData + otahttptestBLOCK_INDEX_SIZE, pucPayload );
+    TEST_ASSERT_EQUAL( 100, xPayloadSize );
+    TEST_ASSERT_EQUAL_UINT8_ARRAY( ucResponseBody, pucPayload, 100 );
+}
+
+TEST( Full_OTA_HTTP, DecodeFileBlock_MultiBlockBody )
+{
+    uint32_t ulRangeSize = 2 * OTA_FILE_BLOCK_SIZE + 100UL;
+    uint32_t ulFirstBlock = 3;
+    uint32_t ulBlock = 0;
+    uint32_t ulOffset = 0;
+    uint32_t ulBlockSize = 0;
+    int32_t lFileId = -1;
+    int32_t lBlockId = -1;
+    int32_t lBlockSize = -1;
+    uint8_t * pucPayload = NULL;
+    size_t xPayloadSize = 0;
+
+    /* Split the body of a three block response into event buffers the way the read callback does. */
+    for( ulBlock = 0; ulBlock < 3; ulBlock++ )
+    {
+        ulBlockSize = TEST_OTA_HTTP_GetBlockSize( ulRangeSize, ulBlock );
+        TEST_OTA_HTTP_FillEventBuffer( &xEventBuffers[ ulBlock ],
+                                       ulFirstBlock + ulBlock,
+                                       ucResponseBody + ulOffset,
+                                       ulBlockSize );
+        ulOffset += ulBlockSize;
+    }
+
+    TEST_ASSERT_EQUAL_UINT32( ulRangeSize, ulOffset );
+
+    /* Each buffer decodes to its own block, so the agent can process them in any order. */
+    ulOffset = 0;
+
+    for( ulBlock = 0; ulBlock < 3; ulBlock++ )
+    {
+        TEST_ASSERT_EQUAL( kOTA_Err_None,
+                           _AwsIotOTA_DecodeFileBlock_HTTP( xEventBuffers[ ulBlock ].ucData,
+                                                            xEventBuffers[ ulBlock ].ulDataLength,
+                                                            &lFileId,
+                                                            &lBlockId,
+                                                            &lBlockSize,
+                                                            &pucPayload,
+                                                            &xPayloadSize ) );
+
+        ulBlockSize = TEST_OTA_HTTP_GetBlockSize( ulRangeSize, ulBlock );
+        TEST_ASSERT_EQUAL_INT32( ( int32_t ) ( ulFirstBlock + ulBlock ), lBlockId );
+        TEST_ASSERT_EQUAL_INT32( ( int32_t ) ulBlockSize, lBlockSize );
+        TEST_ASSERT_EQUAL( ulBlockSize, xPayloadSize );
+        TEST_ASSERT_EQUAL_UINT8_ARRAY( ucResponseBody + ulOffset, pucPayload, ulBlockSize );
+        ulOffset += ulBlockSize;
+    }
+}
+
+TEST( Full_OTA_HTTP, ClaimSession_IdleAndBusy )
+{
+    bool bNeedReconnect = true;
+
+    /* An idle session is taken over for a new request, after which it is busy. */
+    TEST_ASSERT_TRUE( TEST_OTA_HTTP_ClaimSession( 0, 0, &bNeedReconnect ) );
+    TEST_ASSERT_FALSE( bNeedReconnect );
+    TEST_ASSERT_FALSE( TEST_OTA_HTTP_ClaimSession( 0, 0, &bNeedReconnect ) );
+
+    /* A session whose connection was closed reconnects before its next request. */
+    TEST_OTA_HTTP_ResetSessions();
+    TEST_OTA_HTTP_CloseConnection( 0 );
+    TEST_ASSERT_TRUE( TEST_OTA_HTTP_ClaimSession( 0, 0, &bNeedReconnect ) );
+    TEST_ASSERT_TRUE( bNeedReconnect );
+
+    /* A session processing a response is busy, however long it takes. */
+    TEST_OTA_HTTP_ResetSessions();
+    TEST_OTA_HTTP_SendRequest( 0, 0, 4, 0 );
+    TEST_ASSERT_TRUE( TEST_OTA_HTTP_StartProcessingResponse( 0 ) );
+    TEST_ASSERT_FALSE( TEST_OTA_HTTP_ClaimSession( 0, 2 * TEST_OTA_HTTP_GetResponseTimeout(), &bNeedReconnect ) );
+}
+
+TEST( Full_OTA_HTTP, ClaimSession_TimedOutRequest )
+{
+    TickType_t xTimeout = TEST_OTA_HTTP_GetResponseTimeout();
+    bool bNeedReconnect = false;
+    uint32_t ulFirstBlock = 0;
+    uint32_t ulNumBlocks = 0;
+
+    TEST_OTA_HTTP_SendRequest( 0, 0, 4, 0 );
+
+    /* The session waits for the response until the response timeout. */
+    TEST_ASSERT_FALSE( TEST_OTA_HTTP_ClaimSession( 0, xTimeout - 1, &bNeedReconnect ) );
+
+    /* Then it is taken over by the OTA agent, which reconnects before sending a new request. */
+    TEST_ASSERT_TRUE( TEST_OTA_HTTP_ClaimSession( 0, xTimeout, &bNeedReconnect ) );
+    TEST_ASSERT_TRUE( bNeedReconnect );
+
+    /* A response that arrives after that is not processed anymore. */
+    TEST_ASSERT_FALSE( TEST_OTA_HTTP_StartProcessingResponse( 0 ) );
+
+    /* The session requests the missing blocks again, starting with the ones of the timed out request. */
+    TEST_ASSERT_TRUE( TEST_OTA_HTTP_GetNextMissingBlocks( 0, &xFileContext, xTimeout, &ulFirstBlock, &ulNumBlocks ) );
+    TEST_ASSERT_EQUAL_UINT32( 0, ulFirstBlock );
+}
+
+TEST( Full_OTA_HTTP, GetNextMissingBlocks_SkipsBlocksInFlight )
+{
+    uint32_t ulFirstBlock = 0;
+    uint32_t ulNumBlocks = 0;
+
+    if( TEST_OTA_HTTP_GetNumSessions() < 2 )
+    {
+        TEST_IGNORE_MESSAGE( "Define otaconfigHTTP_MAX_NUM_CONNECTIONS to at least 2 to run this test." );
+    }
+
+    /* Blocks 0 to 3 are requested on the first session. */
+    TEST_OTA_HTTP_SendRequest( 0, 0, 4, 0 );
+
+    TEST_ASSERT_TRUE( TEST_OTA_HTTP_GetNextMissingBlocks( 1, &xFileContext, 0, &ulFirstBlock, &ulNumBlocks ) );
+    TEST_ASSERT_EQUAL_UINT32( 4, ulFirstBlock );
+    TEST_ASSERT_TRUE( ulNumBlocks >= 1 );
+
+    /* Received blocks are skipped as well. */
+    TEST_ASSERT_TRUE( prvBlockTrackerMarkReceived( xFileContext.pxRxBlockTracker, 4 ) );
+    TEST_ASSERT_TRUE( prvBlockTrackerMarkReceived( xFileContext.pxRxBlockTracker, 5 ) );
+
+    TEST_ASSERT_TRUE( TEST_OTA_HTTP_GetNextMissingBlocks( 1, &xFileContext, 0, &ulFirstBlock, &ulNumBlocks ) );
+    TEST_ASSERT_EQUAL_UINT32( 6, ulFirstBlock );
+
+    /* A request in flight never covers the blocks of another request in flight. */
+    TEST_OTA_HTTP_SendRequest( 1, ulFirstBlock, ulNumBlocks, 0 );
+
+    if( TEST_OTA_HTTP_GetNumSessions() > 2 )
+    {
+        TEST_ASSERT_TRUE( TEST_OTA_HTTP_GetNextMissingBlocks( 2, &xFileContext, 0, &ulFirstBlock, &ulNumBlocks ) );
+        TEST_ASSERT_EQUAL_UINT32( 6 + ulNumBlocks, ulFirstBlock );
+    }
+
+    /* The blocks of its own request are requested again by a session. */
+    TEST_ASSERT_TRUE( TEST_OTA_HTTP_GetNextMissingBlocks( 0, &xFileContext, 0, &ulFirstBlock, &ulNumBlocks ) );
+    TEST_ASSERT_EQUAL_UINT32( 0, ulFirstBlock );
+}
+
+TEST( Full_OTA_HTTP, GetNextMissingBlocks_ReissuesTimedOutRequest )
+{
+    TickType_t xTimeout = TEST_OTA_HTTP_GetResponseTimeout();
+    uint32_t ulFirstBlock = 0;
+    uint32_t ulNumBlocks = 0;
+    bool bNeedReconnect = false;
+
+    if( TEST_OTA_HTTP_GetNumSessions() < 2 )
+    {
+        TEST_IGNORE_MESSAGE( "Define otaconfigHTTP_MAX_NUM_CONNECTIONS to at least 2 to run this test." );
+    }
+
+    TEST_OTA_HTTP_SendRequest( 0, 0, 4, 0 );
+
+    /* The blocks of a request are in flight until the response timeout. */
+    TEST_ASSERT_TRUE( TEST_OTA_HTTP_GetNextMissingBlocks( 1, &xFileContext, xTimeout - 1, &ulFirstBlock, &ulNumBlocks ) );
+    TEST_ASSERT_EQUAL_UINT32( 4, ulFirstBlock );
+
+    /* Then another session requests them again. */
+    TEST_ASSERT_TRUE( TEST_OTA_HTTP_GetNextMissingBlocks( 1, &xFileContext, xTimeout, &ulFirstBlock, &ulNumBlocks ) );
+    TEST_ASSERT_EQUAL_UINT32( 0, ulFirstBlock );
+
+    /* Unless the timed out session is taken over for a new request first. */
+    TEST_ASSERT_TRUE( TEST_OTA_HTTP_ClaimSession( 0, xTimeout, &bNeedReconnect ) );
+    TEST_ASSERT_TRUE( TEST_OTA_HTTP_GetNextMissingBlocks( 1, &xFileContext, xTimeout, &ulFirstBlock, &ulNumBlocks ) );
+    TEST_ASSERT_EQUAL_UINT32( 4, ulFirstBlock );
+
+    /* The blocks of a response being processed are in flight, however long it takes. */
+    TEST_OTA_HTTP_ResetSessions();
+    TEST_OTA_HTTP_SendRequest( 0, 0, 4, 0 );
+    TEST_ASSERT_TRUE( TEST_OTA_HTTP_StartProcessingResponse( 0 ) );
+    TEST_ASSERT_TRUE( TEST_OTA_HTTP_GetNextMissingBlocks( 1, &xFileContext, 2 * xTimeout, &ulFirstBlock, &ulNumBlocks ) );
+    TEST_ASSERT_EQUAL_UINT32( 4, ulFirstBlock );
+}
@@ -37,6 +37,7 @@
 #include "aws_ota_pal_test_access_declare.h"
 #include "aws_iot_ota_pal.h"
 #include "aws_iot_ota_agent.h"
+#include "aws_iot_ota_agent_internal.h"
 
 
 #if ( otatestpalREAD_CERTIFICATE_FROM_NVM_WITH_PKCS11 == 1 )
@@ -81,6 +82,14 @@ static uint8_t ucDummyData[] =
     0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3a, 0x3b, 0x3c, 0x3d, 0x3e, 0x3f
 };
 
+/* The delta tests rebuild ucDummyData from an active image made of its first 40 bytes
+ * off by one, 8 bytes that are skipped, and its next 40 bytes. */
+#define testotapalDELTA_DIFF_SIZE          40U
+#define testotapalDELTA_SKIP_SIZE          8U
+#define testotapalDELTA_ACTIVE_SIZE        ( ( 2U * testotapalDELTA_DIFF_SIZE ) + testotapalDELTA_SKIP_SIZE )
+#define testotapalDELTA_EXTRA_SIZE         ( sizeof( ucDummyData ) - ( 2U * testotapalDELTA_DIFF_SIZE ) )
+#define testotapalDELTA_PATCH_SIZE         ( OTA_DELTA_HEADER_SIZE + ( 2U * OTA_DELTA_CONTROL_SIZE ) + sizeof( ucDummyData ) )
+
 /* Global static OTA file context used in every test. This context is reset to all zeros
  * before every test. */
 static OTA_FileContext_t xOtaFile;
@@ -116,6 +125,74 @@ static OTA_FileContext_t xOtaFile;
     }
 #endif /* ifdef CC3220sf */
 
+#if ( otatestpalDELTA_SUPPORTED == 1 )
+
+/**
+ * @brief Encode a number of a delta patch, little-endian with the sign in the top bit.
+ */
+    static uint8_t * prvWriteDeltaNumber( uint8_t * pucOut,
+                                          uint32_t ulMagnitude,
+                                          bool bNegative )
+    {
+        memset( pucOut, 0, OTA_DELTA_NUMBER_SIZE );
+        pucOut[ 0 ] = ( uint8_t ) ulMagnitude;
+        pucOut[ 1 ] = ( uint8_t ) ( ulMagnitude >> 8 );
+        pucOut[ 2 ] = ( uint8_t ) ( ulMagnitude >> 16 );
+        pucOut[ 3 ] = ( uint8_t ) ( ulMagnitude >> 24 );
+        pucOut[ 7 ] = ( bNegative == true ) ? 0x80U : 0U;
+
+        return pucOut + OTA_DELTA_NUMBER_SIZE;
+    }
+
+/**
+ * @brief Write the active image the delta tests patch and build the patch that
+ * turns it into ucDummyData.
+ */
+    static void prvSetupDeltaUpdate( uint8_t * pucPatch )
+    {
+        OTA_Err_t xOtaStatus;
+        OTA_FileContext_t xActiveImage = { 0 };
+        uint8_t ucActive[ testotapalDELTA_ACTIVE_SIZE ] = { 0 };
+        uint8_t * pucOut = pucPatch;
+        uint32_t ulIndex;
+
+        for( ulIndex = 0; ulIndex < testotapalDELTA_DIFF_SIZE; ulIndex++ )
+        {
+            ucActive[ ulIndex ] = ucDummyData[ ulIndex ] - 1U;
+        }
+
+        memcpy( &ucActive[ testotapalDELTA_DIFF_SIZE + testotapalDELTA_SKIP_SIZE ],
+                &ucDummyData[ testotapalDELTA_DIFF_SIZE ],
+                testotapalDELTA_DIFF_SIZE );
+
+        xActiveImage.pucFilePath = ( uint8_t * ) otatestpalACTIVE_IMAGE_FILE;
+        xActiveImage.ulFileSize = sizeof( ucActive );
+        xOtaStatus = prvPAL_CreateFileForRx( &xActiveImage );
+        TEST_ASSERT_EQUAL( kOTA_Err_None, xOtaStatus );
+        TEST_ASSERT_EQUAL( sizeof( ucActive ), prvPAL_WriteBlock( &xActiveImage, 0, ucActive, sizeof( ucActive ) ) );
+        xOtaStatus = prvPAL_Abort( &xActiveImage );
+        TEST_ASSERT_EQUAL( kOTA_Err_None, xOtaStatus );
+
+        memcpy( pucOut, OTA_DELTA_MAGIC, OTA_DELTA_MAGIC_SIZE );
+        pucOut = prvWriteDeltaNumber( pucOut + OTA_DELTA_MAGIC_SIZE, sizeof( ucDummyData ), false );
+
+        /* Add one to the first bytes, then skip the bytes that aren't in the new image. */
+        pucOut = prvWriteDeltaNumber( pucOut, testotapalDELTA_DIFF_SIZE, false );
+        pucOut = prvWriteDeltaNumber( pucOut, 0U, false );
+        pucOut = prvWriteDeltaNumber( pucOut, testotapalDELTA_SKIP_SIZE, false );
+        memset( pucOut, 1, testotapalDELTA_DIFF_SIZE );
+        pucOut += testotapalDELTA_DIFF_SIZE;
+
+        /* Copy the next bytes unchanged, then add the rest of the new image. */
+        pucOut = prvWriteDeltaNumber( pucOut, testotapalDELTA_DIFF_SIZE, false );
+        pucOut = prvWriteDeltaNumber( pucOut, testotapalDELTA_EXTRA_SIZE, false );
+        pucOut = prvWriteDeltaNumber( pucOut, 0U, false );
+        memset( pucOut, 0, testotapalDELTA_DIFF_SIZE );
+        pucOut += testotapalDELTA_DIFF_SIZE;
+        memcpy( pucOut, &ucDummyData[ 2U * testotapalDELTA_DIFF_SIZE ], testotapalDELTA_EXTRA_SIZE );
+    }
+#endif /* if ( otatestpalDELTA_SUPPORTED == 1 ) */
+
 /**
  * @brief Test group definition.
  */
@@ -169,6 +246,14 @@ TEST_GROUP_RUNNER( Full_OTA_PAL )
     RUN_TEST_CASE( Full_OTA_PAL, prvPAL_WriteBlock_WriteSingleByte );
     RUN_TEST_CASE( Full_OTA_PAL, prvPAL_WriteBlock_WriteManyBlocks );
 
+    RUN_TEST_CASE( Full_OTA_PAL, prvPAL_ResumeFileForRx_KeepsWrittenBlocks );
+    RUN_TEST_CASE( Full_OTA_PAL, prvPAL_ResumeFileForRx_NonexistentFile );
+    RUN_TEST_CASE( Full_OTA_PAL, prvPAL_Checkpoint_SaveLoadErase );
+
+    RUN_TEST_CASE( Full_OTA_PAL, prvPAL_ReadActiveImage_OutOfRange );
+    RUN_TEST_CASE( Full_OTA_PAL, prvPAL_DeltaUpdate_ValidSignature );
+    RUN_TEST_CASE( Full_OTA_PAL, prvPAL_DeltaUpdate_WrongImageSize );
+
     /* This test resets the device so it is not valid for an MCU. */
     RUN_TEST_CASE( Full_OTA_PAL, prvPAL_ActivateNewImage );
 
@@ -617,6 +702,208 @@ TEST( Full_OTA_PAL, prvPAL_WriteBlock_WriteManyBlocks )
     }
 }
 
+/**
+ * @brief Write the first part of a file, abort, resume the file and write the rest.
+ * Verify the signature of the whole file still passes.
+ */
+TEST( Full_OTA_PAL, prvPAL_ResumeFileForRx_KeepsWrittenBlocks )
+{
+    #if ( otatestpalCHECKPOINT_SUPPORTED == 1 )
+        OTA_Err_t xOtaStatus;
+        int16_t sNumBytesWritten;
+        Sig256_t xSig = { 0 };
+        uint32_t ulHalfSize = sizeof( ucDummyData ) / 2U;
+
+        xOtaFile.pucFilePath = ( uint8_t * ) ( "test_resume_image.bin" );
+        xOtaFile.ulFileSize = sizeof( ucDummyData );
+        xOtaStatus = prvPAL_CreateFileForRx( &xOtaFile );
+        TEST_ASSERT_EQUAL( kOTA_Err_None, xOtaStatus );
+
+        if( TEST_PROTECT() )
+        {
+            sNumBytesWritten = prvPAL_WriteBlock( &xOtaFile, 0, ucDummyData, ulHalfSize );
+            TEST_ASSERT_EQUAL_INT( ulHalfSize, sNumBytesWritten );
+
+            /* The download is interrupted. */
+            xOtaStatus = prvPAL_Abort( &xOtaFile );
+            TEST_ASSERT_EQUAL_INT( kOTA_Err_None, xOtaStatus );
+
+            xOtaStatus = prvPAL_ResumeFileForRx( &xOtaFile );
+            TEST_ASSERT_EQUAL_INT( kOTA_Err_None, xOtaStatus );
+
+            sNumBytesWritten = prvPAL_WriteBlock( &xOtaFile, ulHalfSize, &ucDummyData[ ulHalfSize ], sizeof( ucDummyData ) - ulHalfSize );
+            TEST_ASSERT_EQUAL_INT( sizeof( ucDummyData ) - ulHalfSize, sNumBytesWritten );
+
+            xOtaFile.pxSignature = &xSig;
+            xOtaFile.pxSignature->usSize = ucValidSignatureLength;
+            memcpy( xOtaFile.pxSignature->ucData, ucValidSignature, ucValidSignatureLength );
+            xOtaFile.pucCertFilepath = ( uint8_t * ) otatestpalCERTIFICATE_FILE;
+
+            xOtaStatus = prvPAL_CloseFile( &xOtaFile );
+            TEST_ASSERT_EQUAL_INT( kOTA_Err_None, xOtaStatus );
+        }
+    #endif /* if ( otatestpalCHECKPOINT_SUPPORTED == 1 ) */
+}
+
+/**
+ * @brief Resume a file that doesn't exist. Verify the error.
+ */
+TEST( Full_OTA_PAL, prvPAL_ResumeFileForRx_NonexistentFile )
+{
+    #if ( otatestpalCHECKPOINT_SUPPORTED == 1 )
+        OTA_Err_t xOtaStatus;
+
+        xOtaFile.pucFilePath = ( uint8_t * ) ( "nonexistingfile.bin" );
+        xOtaStatus = prvPAL_ResumeFileForRx( &xOtaFile );
+        TEST_ASSERT_NOT_EQUAL( kOTA_Err_None, xOtaStatus );
+    #endif
+}
+
+/**
+ * @brief Save, overwrite, load and erase a checkpoint. Verify the data read back.
+ */
+TEST( Full_OTA_PAL, prvPAL_Checkpoint_SaveLoadErase )
+{
+    #if ( otatestpalCHECKPOINT_SUPPORTED == 1 )
+        OTA_Err_t xOtaStatus;
+        uint8_t ucCheckpoint[ sizeof( ucDummyData ) ] = { 0 };
+        uint32_t ulSizeRead = 0;
+
+        /* Start without a checkpoint. */
+        xOtaStatus = prvPAL_EraseCheckpoint();
+        TEST_ASSERT_EQUAL_INT( kOTA_Err_None, xOtaStatus );
+
+        xOtaStatus = prvPAL_LoadCheckpoint( ucCheckpoint, sizeof( ucCheckpoint ), &ulSizeRead );
+        TEST_ASSERT_NOT_EQUAL( kOTA_Err_None, xOtaStatus );
+
+        /* A checkpoint replaces the one saved before. */
+        xOtaStatus = prvPAL_SaveCheckpoint( &xOtaFile, ucDummyData, sizeof( ucDummyData ) );
+        TEST_ASSERT_EQUAL_INT( kOTA_Err_None, xOtaStatus );
+
+        xOtaStatus = prvPAL_SaveCheckpoint( &xOtaFile, &ucDummyData[ 1 ], sizeof( ucDummyData ) - 1U );
+        TEST_ASSERT_EQUAL_INT( kOTA_Err_None, xOtaStatus );
+
+        xOtaStatus = prvPAL_LoadCheckpoint( ucCheckpoint, sizeof( ucCheckpoint ), &ulSizeRead );
+        TEST_ASSERT_EQUAL_INT( kOTA_Err_None, xOtaStatus );
+        TEST_ASSERT_EQUAL_UINT32( sizeof( ucDummyData ) - 1U, ulSizeRead );
+        TEST_ASSERT_EQUAL_UINT8_ARRAY( &ucDummyData[ 1 ], ucCheckpoint, ulSizeRead );
+
+        /* Erasing removes it, and erasing again is not an error. */
+        xOtaStatus = prvPAL_EraseCheckpoint();
+        TEST_ASSERT_EQUAL_INT( kOTA_Err_None, xOtaStatus );
+
+        xOtaStatus = prvPAL_LoadCheckpoint( ucCheckpoint, sizeof( ucCheckpoint ), &ulSizeRead );
+        TEST_ASSERT_NOT_EQUAL( kOTA_Err_None, xOtaStatus );
+
+        xOtaStatus = prvPAL_EraseCheckpoint();
+        TEST_ASSERT_EQUAL_INT( kOTA_Err_None, xOtaStatus );
+    #endif /* if ( otatestpalCHECKPOINT_SUPPORTED == 1 ) */
+}
+
+/**
+ * @brief Read the end of the active image and past it. Verify the error when
+ * the range isn't all in the image.
+ */
+TEST( Full_OTA_PAL, prvPAL_ReadActiveImage_OutOfRange )
+{
+    #if ( otatestpalDELTA_SUPPORTED == 1 )
+        OTA_Err_t xOtaStatus;
+        uint8_t ucPatch[ testotapalDELTA_PATCH_SIZE ];
+        uint8_t ucData[ testotapalDELTA_DIFF_SIZE ];
+
+        prvSetupDeltaUpdate( ucPatch );
+
+        xOtaStatus = prvPAL_ReadActiveImage( testotapalDELTA_ACTIVE_SIZE - testotapalDELTA_DIFF_SIZE, ucData, testotapalDELTA_DIFF_SIZE );
+        TEST_ASSERT_EQUAL_INT( kOTA_Err_None, xOtaStatus );
+        TEST_ASSERT_EQUAL_UINT8_ARRAY( &ucDummyData[ testotapalDELTA_DIFF_SIZE ], ucData, testotapalDELTA_DIFF_SIZE );
+
+        xOtaStatus = prvPAL_ReadActiveImage( testotapalDELTA_ACTIVE_SIZE - 1U, ucData, 2U );
+        TEST_ASSERT_NOT_EQUAL( kOTA_Err_None, xOtaStatus );
+    #endif /* if ( otatestpalDELTA_SUPPORTED == 1 ) */
+}
+
+/**
+ * @brief Apply a delta patch to the active image in uneven pieces and close the
+ * rebuilt image. Verify the signature of the rebuilt image passes.
+ */
+TEST( Full_OTA_PAL, prvPAL_DeltaUpdate_ValidSignature )
+{
+    #if ( otatestpalDELTA_SUPPORTED == 1 )
+        OTA_Err_t xOtaStatus;
+        Sig256_t xSig = { 0 };
+        OTA_DeltaApplier_t * pxDelta = NULL;
+        uint8_t ucPatch[ testotapalDELTA_PATCH_SIZE ];
+        uint32_t ulOffset = 0, ulSize = 0;
+
+        prvSetupDeltaUpdate( ucPatch );
+
+        xOtaFile.pucFilePath = ( uint8_t * ) ( "test_delta_image.bin" );
+        xOtaFile.ulFileSize = sizeof( ucPatch );
+        xOtaFile.ulImageSize = sizeof( ucDummyData );
+        xOtaStatus = prvPAL_CreateFileForRx( &xOtaFile );
+        TEST_ASSERT_EQUAL( kOTA_Err_None, xOtaStatus );
+
+        pxDelta = prvDeltaCreate( sizeof( ucDummyData ), prvPAL_ReadActiveImage, prvPAL_WriteBlock );
+        TEST_ASSERT_NOT_NULL( pxDelta );
+
+        if( TEST_PROTECT() )
+        {
+            /* Split fields and records across pieces. */
+            for( ulOffset = 0; ulOffset < sizeof( ucPatch ); ulOffset += ulSize )
+            {
+                ulSize = ( ( sizeof( ucPatch ) - ulOffset ) < 7U ) ? ( sizeof( ucPatch ) - ulOffset ) : 7U;
+                xOtaStatus = prvDeltaApply( pxDelta, &xOtaFile, &ucPatch[ ulOffset ], ulSize );
+                TEST_ASSERT_EQUAL_INT( kOTA_Err_None, xOtaStatus );
+            }
+
+            xOtaStatus = prvDeltaFinish( pxDelta, &xOtaFile );
+            TEST_ASSERT_EQUAL_INT( kOTA_Err_None, xOtaStatus );
+
+            xOtaFile.pxSignature = &xSig;
+            xOtaFile.pxSignature->usSize = ucValidSignatureLength;
+            memcpy( xOtaFile.pxSignature->ucData, ucValidSignature, ucValidSignatureLength );
+            xOtaFile.pucCertFilepath = ( uint8_t * ) otatestpalCERTIFICATE_FILE;
+
+            xOtaStatus = prvPAL_CloseFile( &xOtaFile );
+            TEST_ASSERT_EQUAL_INT( kOTA_Err_None, xOtaStatus );
+        }
+
+        prvDeltaDelete( pxDelta );
+    #endif /* if ( otatestpalDELTA_SUPPORTED == 1 ) */
+}
+
+/**
+ * @brief Apply a delta patch that builds an image of a different size than the
+ * job said. Verify the error.
+ */
+TEST( Full_OTA_PAL, prvPAL_DeltaUpdate_WrongImageSize )
+{
+    #if ( otatestpalDELTA_SUPPORTED == 1 )
+        OTA_Err_t xOtaStatus;
+        OTA_DeltaApplier_t * pxDelta = NULL;
+        uint8_t ucPatch[ testotapalDELTA_PATCH_SIZE ];
+
+        prvSetupDeltaUpdate( ucPatch );
+
+        xOtaFile.pucFilePath = ( uint8_t * ) ( "test_delta_image.bin" );
+        xOtaFile.ulFileSize = sizeof( ucPatch );
+        xOtaFile.ulImageSize = sizeof( ucDummyData ) + 1U;
+        xOtaStatus = prvPAL_CreateFileForRx( &xOtaFile );
+        TEST_ASSERT_EQUAL( kOTA_Err_None, xOtaStatus );
+
+        pxDelta = prvDeltaCreate( xOtaFile.ulImageSize, prvPAL_ReadActiveImage, prvPAL_WriteBlock );
+        TEST_ASSERT_NOT_NULL( pxDelta );
+
+        if( TEST_PROTECT() )
+        {
+            xOtaStatus = prvDeltaApply( pxDelta, &xOtaFile, ucPatch, sizeof( ucPatch ) );
+            TEST_ASSERT_NOT_EQUAL( kOTA_Err_None, xOtaStatus );
+        }
+
+        prvDeltaDelete( pxDelta );
+    #endif /* if ( otatestpalDELTA_SUPPORTED == 1 ) */
+}
+
 /**
  * Call prvPAL_ActivateNewImage() and verify success. This function is expected to
  * reset the device, so this test is only supported on the Windows Simulator environment.
@@ -46,6 +46,32 @@
 
 /**@} */
 
+/**
+ * @brief Number of TLS sessions remembered for resumption.
+ *
+ * A connection to a server whose session is cached offers that session in its
+ * ClientHello, and the server may resume it with an abbreviated handshake that
+ * skips certificate verification and key exchange. Each entry holds one
+ * mbedtls_ssl_session. Zero disables the cache.
+ *
+ * Session IDs work with the default mbedTLS configuration; define
+ * MBEDTLS_SSL_SESSION_TICKETS to also resume servers that only issue tickets.
+ */
+#ifndef tlsSESSION_CACHE_SIZE
+    #define tlsSESSION_CACHE_SIZE    ( 0 )
+#endif
+
+/**
+ * @brief Counters of the TLS session cache, returned by @ref TLS_GetSessionCacheStats.
+ */
+typedef struct TLSSessionCacheStats
+{
+    uint32_t ulLookups; /**< Connections that looked for a cached session. */
+    uint32_t ulHits;    /**< Connections that offered a cached session. */
+    uint32_t ulResumed; /**< Connections whose offered session the server resumed. */
+    uint32_t ulStores;  /**< Sessions stored after a successful handshake. */
+} TLSSessionCacheStats_t;
+
 /**
  * @brief Defines callback type for receiving bytes from the network.
  *
@@ -146,6 +172,38 @@ BaseType_t TLS_Send( void * pvContext,
                      const unsigned char * pucMsg,
                      size_t xMsgLength );
 
+/**
+ * @brief One fragment of the data passed to @ref TLS_SendV.
+ *
+ * The layout matches SocketsIoVector_t, so Secure Sockets ports can pass
+ * their vectors through unchanged.
+ */
+typedef struct TLSSendVector
+{
+    const void * pvData; /**< Start of the fragment. */
+    size_t xLength;      /**< Length of the fragment in bytes. */
+} TLSSendVector_t;
+
+/**
+ * @brief Writes a sequence of fragments to the secure connection as one
+ * stream.
+ *
+ * Small fragments are packed together into the same TLS record; fragments of
+ * at least tlsSEND_COALESCE_BUFFER_SIZE bytes are encrypted straight from
+ * the caller's memory. This lets callers send a header and a payload without
+ * first copying them into one buffer.
+ *
+ * @param pvContext Opaque context handle for TLS library.
+ * @param pxVectors Fragments to send, in order.
+ * @param xVectorCount Number of fragments.
+ *
+ * @return Number of bytes sent, counted across all fragments. Error return
+ * codes have the high bit set.
+ */
+BaseType_t TLS_SendV( void * pvContext,
+                      const TLSSendVector_t * pxVectors,
+                      size_t xVectorCount );
+
 /**
  * @brief Frees resources consumed by the TLS context.
  *
@@ -153,4 +211,19 @@ BaseType_t TLS_Send( void * pvContext,
  */
 void TLS_Cleanup( void * pvContext );
 
+/**
+ * @brief Reads the counters of the TLS session cache.
+ *
+ * All counters are zero when tlsSESSION_CACHE_SIZE is zero.
+ *
+ * @param[out] pxStats Receives the counters.
+ */
+void TLS_GetSessionCacheStats( TLSSessionCacheStats_t * pxStats );
+
+/**
+ * @brief Forgets all cached TLS sessions, e.g. after the device credentials
+ * change. The next connection to each server performs a full handshake.
+ */
+void TLS_FlushSessionCache( void );
+
 #endif /* ifndef __AWS__TLS__H__ */
@@ -31,6 +31,7 @@
 #include "core_pkcs11_config.h"
 #include "core_pkcs11.h"
 #include "task.h"
+#include "semphr.h"
 #include "aws_clientcredential_keys.h"
 #include "iot_default_root_certificates.h"
 #include "core_pki_utils.h"
@@ -87,6 +88,66 @@ static const char * pNoLowLevelMbedTlsCodeStr = "<No-Low-Level-Code>";
     mbedtls_strerror_lowlevel( mbedTlsCode ) : pNoLowLevelMbedTlsCodeStr
 
 
+/**
+ * @brief Number of parsed trust stores for custom server certificates that are
+ * kept for reuse. The trust store of the default root certificates is always
+ * kept.
+ */
+#ifndef tlsTRUST_STORE_CACHE_SIZE
+    #define tlsTRUST_STORE_CACHE_SIZE    ( 4 )
+#endif
+
+/**
+ * @brief Size of the per-connection buffer in which TLS_SendV packs small
+ * fragments into one TLS record. Fragments at least this long are encrypted
+ * straight from the caller's memory. The buffer is allocated by the first
+ * TLS_SendV on a connection; zero sends every fragment separately.
+ */
+#ifndef tlsSEND_COALESCE_BUFFER_SIZE
+    #define tlsSEND_COALESCE_BUFFER_SIZE    ( 512 )
+#endif
+
+/**
+ * @brief Parsed server certificates, shared read-only by every TLS context
+ * that trusts the same certificates.
+ *
+ * @param[out] xMbedX509CA Server certificate chain for mbedTLS.
+ * @param[in] ucDigest SHA-256 digest of the PEM certificates, which identifies
+ * a custom trust store. Unused for the default trust store.
+ * @param[in] ulCertificateLength Length in bytes of the PEM certificates.
+ * @param[in] ulReferences Number of TLS contexts using the trust store.
+ * @param[in] xCached Whether the trust store is kept after its last reference
+ * is released.
+ */
+typedef struct TLSTrustStore
+{
+    mbedtls_x509_crt xMbedX509CA;
+    uint8_t ucDigest[ 32 ];
+    uint32_t ulCertificateLength;
+    uint32_t ulReferences;
+    BaseType_t xCached;
+} TLSTrustStore_t;
+
+#if ( tlsSESSION_CACHE_SIZE > 0 )
+
+/**
+ * @brief A TLS session kept for resumption by later connections.
+ *
+ * @param[in] ucKey Digest of the server name, ALPN protocols and trusted
+ * certificates of the connection that established the session.
+ * @param[in] xValid Whether the entry holds a session.
+ * @param[in] xLastUsed Tick count of the last store or lookup of the entry.
+ * @param[out] xSession The session for mbedTLS.
+ */
+    typedef struct TLSSessionCacheEntry
+    {
+        uint8_t ucKey[ 32 ];
+        BaseType_t xValid;
+        TickType_t xLastUsed;
+        mbedtls_ssl_session xSession;
+    } TLSSessionCacheEntry_t;
+#endif /* if ( tlsSESSION_CACHE_SIZE > 0 ) */
+
 /**
  * @brief Internal context structure.
  *
@@ -99,12 +160,17 @@ static const char * pNoLowLevelMbedTlsCodeStr = "<No-Low-Level-Code>";
  * @param[out] xTLSHandshakeState Indicates the state of the TLS handshake.
  * @param[out] xMbedSslCtx Connection context for mbedTLS.
  * @param[out] xMbedSslConfig Configuration context for mbedTLS.
- * @param[out] xMbedX509CA Server certificate context for mbedTLS.
+ * @param[out] pxTrustStore Shared trust store with the parsed server certificates.
  * @param[out] xMbedX509Cli Client certificate context for mbedTLS.
  * @param[out] mbedPkAltCtx RSA crypto implementation context for mbedTLS.
  * @param[out] pxP11FunctionList PKCS#11 function list structure.
  * @param[out] xP11Session PKCS#11 session context.
  * @param[out] xP11PrivateKey PKCS#11 private key context.
+ * @param[out] pucSendBuffer Buffer in which TLS_SendV packs small fragments.
+ * @param[out] ucSessionKey Identifies the cached session of the connection.
+ * @param[out] ucOfferedSessionId ID of the cached session offered to the server.
+ * @param[out] xOfferedSessionIdLength Length of ucOfferedSessionId; 0 if no
+ * cached session was offered.
  */
 typedef struct TLSContext
 {
@@ -122,11 +188,18 @@ typedef struct TLSContext
     /* mbedTLS. */
     mbedtls_ssl_context xMbedSslCtx;
     mbedtls_ssl_config xMbedSslConfig;
-    mbedtls_x509_crt xMbedX509CA;
+    TLSTrustStore_t * pxTrustStore;
     mbedtls_x509_crt xMbedX509Cli;
     mbedtls_pk_context xMbedPkCtx;
     mbedtls_pk_info_t xMbedPkInfo;
     mbedtls_ctr_drbg_context xMbedDrbgCtx;
+    unsigned char * pucSendBuffer;
+
+    #if ( tlsSESSION_CACHE_SIZE > 0 )
+        uint8_t ucSessionKey[ 32 ];
+        uint8_t ucOfferedSessionId[ 32 ];
+        size_t xOfferedSessionIdLength;
+    #endif
 
     /* PKCS#11. */
     CK_FUNCTION_LIST_PTR pxP11FunctionList;
@@ -143,10 +216,535 @@ typedef struct TLSContext
 
 /*-----------------------------------------------------------*/
 
+/**
+ * @brief Trust store of the default root certificates; parsed on first use.
+ */
+static TLSTrustStore_t * pxDefaultTrustStore = NULL;
+
+/**
+ * @brief Trust stores of custom server certificates that are kept for reuse.
+ */
+static TLSTrustStore_t * pxCachedTrustStores[ tlsTRUST_STORE_CACHE_SIZE ] = { NULL };
+
+/**
+ * @brief Protects the trust stores and their reference counts.
+ */
+static StaticSemaphore_t xTrustStoreMutexBuffer;
+
+/**
+ * @brief Handle of #xTrustStoreMutexBuffer; created on first use.
+ */
+static SemaphoreHandle_t xTrustStoreMutex = NULL;
+
+#if ( tlsSESSION_CACHE_SIZE > 0 )
+
+/**
+ * @brief Sessions kept for resumption.
+ */
+    static TLSSessionCacheEntry_t xSessionCache[ tlsSESSION_CACHE_SIZE ];
+
+/**
+ * @brief Counters of the session cache.
+ */
+    static TLSSessionCacheStats_t xSessionCacheStats = { 0 };
+
+/**
+ * @brief Protects the session cache and its counters.
+ */
+    static StaticSemaphore_t xSessionCacheMutexBuffer;
+
+/**
+ * @brief Handle of #xSessionCacheMutexBuffer; created on first use.
+ */
+    static SemaphoreHandle_t xSessionCacheMutex = NULL;
+#endif /* if ( tlsSESSION_CACHE_SIZE > 0 ) */
+
+/*-----------------------------------------------------------*/
+
 /*
  * Helper routines.
  */
 
+/**
+ * @brief Create a mutex on first use.
+ *
+ * @param[in,out] pxMutex Handle of the mutex; NULL until it is created.
+ * @param[in] pxMutexBuffer Storage for the mutex.
+ */
+static void prvCreateMutexOnce( SemaphoreHandle_t * pxMutex,
+                                StaticSemaphore_t * pxMutexBuffer )
+{
+    taskENTER_CRITICAL();
+
+    if( NULL == *pxMutex )
+    {
+        *pxMutex = xSemaphoreCreateMutexStatic( pxMutexBuffer );
+    }
+
+    taskEXIT_CRITICAL();
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Parse server certificates into a trust store.
+ *
+ * @param[in] pxTrustStore Trust store to fill.
+ * @param[in] pcCertificate PEM certificates to parse, or NULL for the default
+ * root certificates.
+ * @param[in] ulCertificateLength Length in bytes of pcCertificate.
+ *
+ * @return Zero on success, or an mbedTLS error code.
+ */
+static int prvParseTrustStore( TLSTrustStore_t * pxTrustStore,
+                               const char * pcCertificate,
+                               uint32_t ulCertificateLength )
+{
+    int xResult = 0;
+
+    mbedtls_x509_crt_init( &pxTrustStore->xMbedX509CA );
+
+    /* Decode the root certificate: either the default or the override. */
+    if( NULL != pcCertificate )
+    {
+        xResult = mbedtls_x509_crt_parse( &pxTrustStore->xMbedX509CA,
+                                          ( const unsigned char * ) pcCertificate,
+                                          ulCertificateLength );
+
+        if( 0 != xResult )
+        {
+            TLS_PRINT( ( "ERROR: Failed to parse custom server certificates %s : %s \r\n",
+                         mbedtlsHighLevelCodeOrDefault( xResult ),
+                         mbedtlsLowLevelCodeOrDefault( xResult ) ) );
+        }
+    }
+    else
+    {
+        xResult = mbedtls_x509_crt_parse( &pxTrustStore->xMbedX509CA,
+                                          ( const unsigned char * ) tlsVERISIGN_ROOT_CERTIFICATE_PEM,
+                                          tlsVERISIGN_ROOT_CERTIFICATE_LENGTH );
+
+        if( 0 == xResult )
+        {
+            xResult = mbedtls_x509_crt_parse( &pxTrustStore->xMbedX509CA,
+                                              ( const unsigned char * ) tlsATS1_ROOT_CERTIFICATE_PEM,
+                                              tlsATS1_ROOT_CERTIFICATE_LENGTH );
+
+            if( 0 == xResult )
+            {
+                xResult = mbedtls_x509_crt_parse( &pxTrustStore->xMbedX509CA,
+                                                  ( const unsigned char * ) tlsSTARFIELD_ROOT_CERTIFICATE_PEM,
+                                                  tlsSTARFIELD_ROOT_CERTIFICATE_LENGTH );
+            }
+        }
+
+        if( 0 != xResult )
+        {
+            /* Default root certificates should be in aws_default_root_certificate.h */
+            TLS_PRINT( ( "ERROR: Failed to parse default server certificates %s : %s \r\n",
+                         mbedtlsHighLevelCodeOrDefault( xResult ),
+                         mbedtlsLowLevelCodeOrDefault( xResult ) ) );
+        }
+    }
+
+    if( 0 != xResult )
+    {
+        mbedtls_x509_crt_free( &pxTrustStore->xMbedX509CA );
+    }
+
+    return xResult;
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Get a reference to the trust store of the given server certificates,
+ * parsing them only if no TLS context shares them already.
+ *
+ * @param[in] pcCertificate PEM certificates to trust, or NULL for the default
+ * root certificates.
+ * @param[in] ulCertificateLength Length in bytes of pcCertificate.
+ * @param[out] ppxTrustStore Set to the trust store on success.
+ *
+ * @return Zero on success, or an mbedTLS error code.
+ */
+static int prvTrustStoreAcquire( const char * pcCertificate,
+                                 uint32_t ulCertificateLength,
+                                 TLSTrustStore_t ** ppxTrustStore )
+{
+    int xResult = 0;
+    uint32_t ulIndex = 0;
+    uint8_t ucDigest[ 32 ] = { 0 };
+    TLSTrustStore_t * pxTrustStore = NULL;
+    TLSTrustStore_t ** ppxSlot = NULL;
+
+    /* Custom certificates are identified by their digest, rather than by their
+     * address, since the caller's buffer may be reused for other certificates. */
+    if( NULL != pcCertificate )
+    {
+        xResult = mbedtls_sha256_ret( ( const unsigned char * ) pcCertificate,
+                                      ulCertificateLength,
+                                      ucDigest,
+                                      0 );
+    }
+
+    prvCreateMutexOnce( &xTrustStoreMutex, &xTrustStoreMutexBuffer );
+
+    if( ( 0 == xResult ) &&
+        ( pdTRUE == xSemaphoreTake( xTrustStoreMutex, portMAX_DELAY ) ) )
+    {
+        if( NULL == pcCertificate )
+        {
+            ppxSlot = &pxDefaultTrustStore;
+            pxTrustStore = pxDefaultTrustStore;
+        }
+        else
+        {
+            /* Look for the same certificates, remembering a free slot or an
+             * unused trust store to replace in case they are not found. */
+            for( ulIndex = 0; ulIndex < tlsTRUST_STORE_CACHE_SIZE; ulIndex++ )
+            {
+                if( NULL == pxCachedTrustStores[ ulIndex ] )
+                {
+                    if( ( NULL == ppxSlot ) || ( NULL != *ppxSlot ) )
+                    {
+                        ppxSlot = &pxCachedTrustStores[ ulIndex ];
+                    }
+                }
+                else if( ( pxCachedTrustStores[ ulIndex ]->ulCertificateLength == ulCertificateLength ) &&
+                         ( 0 == memcmp( pxCachedTrustStores[ ulIndex ]->ucDigest, ucDigest, sizeof( ucDigest ) ) ) )
+                {
+                    pxTrustStore = pxCachedTrustStores[ ulIndex ];
+                    break;
+                }
+                else if( ( 0U == pxCachedTrustStores[ ulIndex ]->ulReferences ) && ( NULL == ppxSlot ) )
+                {
+                    ppxSlot = &pxCachedTrustStores[ ulIndex ];
+                }
+                else
+                {
+                    /* Trust store of other certificates in use. */
+                }
+            }
+        }
+
+        if( NULL == pxTrustStore )
+        {
+            pxTrustStore = ( TLSTrustStore_t * ) pvPortMalloc( sizeof( TLSTrustStore_t ) ); /*lint !e9087 !e9079 Allow casting void* to other types. */
+
+            if( NULL == pxTrustStore )
+            {
+                xResult = MBEDTLS_ERR_X509_ALLOC_FAILED;
+            }
+            else
+            {
+                memset( pxTrustStore, 0, sizeof( TLSTrustStore_t ) );
+                memcpy( pxTrustStore->ucDigest, ucDigest, sizeof( ucDigest ) );
+                pxTrustStore->ulCertificateLength = ulCertificateLength;
+
+                /* Other connections wait for the certificates to be parsed
+                 * rather than parsing their own copy. */
+                xResult = prvParseTrustStore( pxTrustStore, pcCertificate, ulCertificateLength );
+
+                if( 0 != xResult )
+                {
+                    vPortFree( pxTrustStore );
+                    pxTrustStore = NULL;
+                }
+                else if( NULL != ppxSlot )
+                {
+                    /* Replace an unused trust store, if the slot holds one. */
+                    if( NULL != *ppxSlot )
+                    {
+                        mbedtls_x509_crt_free( &( *ppxSlot )->xMbedX509CA );
+                        vPortFree( *ppxSlot );
+                    }
+
+                    pxTrustStore->xCached = pdTRUE;
+                    *ppxSlot = pxTrustStore;
+                }
+                else
+                {
+                    /* Every cached trust store is in use, so this one is freed
+                     * after its last reference is released. */
+                }
+            }
+        }
+
+        if( NULL != pxTrustStore )
+        {
+            pxTrustStore->ulReferences++;
+        }
+
+        ( void ) xSemaphoreGive( xTrustStoreMutex );
+    }
+
+    *ppxTrustStore = pxTrustStore;
+
+    return xResult;
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Release a reference to a trust store.
+ *
+ * @param[in] pxTrustStore Trust store returned by prvTrustStoreAcquire.
+ */
+static void prvTrustStoreRelease( TLSTrustStore_t * pxTrustStore )
+{
+    if( pdTRUE == xSemaphoreTake( xTrustStoreMutex, portMAX_DELAY ) )
+    {
+        configASSERT( pxTrustStore->ulReferences > 0U );
+        pxTrustStore->ulReferences--;
+
+        if( ( 0U == pxTrustStore->ulReferences ) && ( pdFALSE == pxTrustStore->xCached ) )
+        {
+            mbedtls_x509_crt_free( &pxTrustStore->xMbedX509CA );
+            vPortFree( pxTrustStore );
+        }
+
+        ( void ) xSemaphoreGive( xTrustStoreMutex );
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+#if ( tlsSESSION_CACHE_SIZE > 0 )
+
+/**
+ * @brief Compute the key of a connection's cached session from its server name,
+ * ALPN protocols and trusted certificates. A session is only resumed by a
+ * connection that would have verified the server in the same way.
+ *
+ * @param[in] pxCtx The TLS context, with its trust store acquired.
+ *
+ * @return Zero on success, or an mbedTLS error code.
+ */
+    static int prvSessionCacheKey( TLSContext_t * pxCtx )
+    {
+        int xResult = 0;
+        const char ** ppcAlpnProtocol = NULL;
+        const char * pcDestination = ( NULL != pxCtx->pcDestination ) ? pxCtx->pcDestination : "";
+        mbedtls_sha256_context xSha256;
+
+        mbedtls_sha256_init( &xSha256 );
+
+        xResult = mbedtls_sha256_starts_ret( &xSha256, 0 );
+
+        /* Hash every string with its terminator, so that "ab", "c" and "a", "bc"
+         * differ. */
+        if( 0 == xResult )
+        {
+            xResult = mbedtls_sha256_update_ret( &xSha256,
+                                                 ( const unsigned char * ) pcDestination,
+                                                 strlen( pcDestination ) + 1U );
+        }
+
+        if( NULL != pxCtx->ppcAlpnProtocols )
+        {
+            for( ppcAlpnProtocol = pxCtx->ppcAlpnProtocols;
+                 ( 0 == xResult ) && ( NULL != *ppcAlpnProtocol );
+                 ppcAlpnProtocol++ )
+            {
+                xResult = mbedtls_sha256_update_ret( &xSha256,
+                                                     ( const unsigned char * ) *ppcAlpnProtocol,
+                                                     strlen( *ppcAlpnProtocol ) + 1U );
+            }
+        }
+
+        if( 0 == xResult )
+        {
+            xResult = mbedtls_sha256_update_ret( &xSha256,
+                                                 pxCtx->pxTrustStore->ucDigest,
+                                                 sizeof( pxCtx->pxTrustStore->ucDigest ) );
+        }
+
+        if( 0 == xResult )
+        {
+            xResult = mbedtls_sha256_update_ret( &xSha256,
+                                                 ( const unsigned char * ) &pxCtx->pxTrustStore->ulCertificateLength,
+                                                 sizeof( pxCtx->pxTrustStore->ulCertificateLength ) );
+        }
+
+        if( 0 == xResult )
+        {
+            xResult = mbedtls_sha256_finish_ret( &xSha256, pxCtx->ucSessionKey );
+        }
+
+        mbedtls_sha256_free( &xSha256 );
+
+        return xResult;
+    }
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Find the cached session of a connection.
+ *
+ * The session cache mutex must be locked by the caller.
+ *
+ * @param[in] pxCtx The TLS context, with its session key computed.
+ *
+ * @return The cache entry, or NULL if no session is cached for the connection.
+ */
+    static TLSSessionCacheEntry_t * prvSessionCacheFind( const TLSContext_t * pxCtx )
+    {
+        uint32_t ulIndex = 0;
+        TLSSessionCacheEntry_t * pxEntry = NULL;
+
+        for( ulIndex = 0; ulIndex < tlsSESSION_CACHE_SIZE; ulIndex++ )
+        {
+            if( ( pdTRUE == xSessionCache[ ulIndex ].xValid ) &&
+                ( 0 == memcmp( xSessionCache[ ulIndex ].ucKey, pxCtx->ucSessionKey, sizeof( pxCtx->ucSessionKey ) ) ) )
+            {
+                pxEntry = &xSessionCache[ ulIndex ];
+                break;
+            }
+        }
+
+        return pxEntry;
+    }
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Offer the cached session of a connection, if any, to the server.
+ *
+ * @param[in] pxCtx The TLS context, set up but not yet negotiated.
+ */
+    static void prvSessionCacheLoad( TLSContext_t * pxCtx )
+    {
+        TLSSessionCacheEntry_t * pxEntry = NULL;
+
+        pxCtx->xOfferedSessionIdLength = 0;
+
+        prvCreateMutexOnce( &xSessionCacheMutex, &xSessionCacheMutexBuffer );
+
+        if( ( 0 == prvSessionCacheKey( pxCtx ) ) &&
+            ( pdTRUE == xSemaphoreTake( xSessionCacheMutex, portMAX_DELAY ) ) )
+        {
+            xSessionCacheStats.ulLookups++;
+
+            pxEntry = prvSessionCacheFind( pxCtx );
+
+            /* The SSL context takes a copy of the session. */
+            if( ( NULL != pxEntry ) &&
+                ( 0 == mbedtls_ssl_set_session( &pxCtx->xMbedSslCtx, &pxEntry->xSession ) ) )
+            {
+                xSessionCacheStats.ulHits++;
+                pxEntry->xLastUsed = xTaskGetTickCount();
+
+                /* The server resumes the session by echoing its ID. */
+                pxCtx->xOfferedSessionIdLength = pxEntry->xSession.id_len;
+                memcpy( pxCtx->ucOfferedSessionId, pxEntry->xSession.id, pxEntry->xSession.id_len );
+            }
+
+            ( void ) xSemaphoreGive( xSessionCacheMutex );
+        }
+    }
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Cache the session of a connection after a successful handshake,
+ * replacing its previous session or the least recently used one.
+ *
+ * @param[in] pxCtx The TLS context, negotiated.
+ */
+    static void prvSessionCacheStore( TLSContext_t * pxCtx )
+    {
+        uint32_t ulIndex = 0;
+        TLSSessionCacheEntry_t * pxEntry = NULL;
+        const mbedtls_ssl_session * pxSession = pxCtx->xMbedSslCtx.session;
+
+        if( pdTRUE == xSemaphoreTake( xSessionCacheMutex, portMAX_DELAY ) )
+        {
+            if( ( 0U != pxCtx->xOfferedSessionIdLength ) &&
+                ( NULL != pxSession ) &&
+                ( pxSession->id_len == pxCtx->xOfferedSessionIdLength ) &&
+                ( 0 == memcmp( pxSession->id, pxCtx->ucOfferedSessionId, pxSession->id_len ) ) )
+            {
+                xSessionCacheStats.ulResumed++;
+            }
+
+            pxEntry = prvSessionCacheFind( pxCtx );
+
+            for( ulIndex = 0; ( NULL == pxEntry ) && ( ulIndex < tlsSESSION_CACHE_SIZE ); ulIndex++ )
+            {
+                if( pdFALSE == xSessionCache[ ulIndex ].xValid )
+                {
+                    pxEntry = &xSessionCache[ ulIndex ];
+                }
+            }
+
+            if( NULL == pxEntry )
+            {
+                pxEntry = &xSessionCache[ 0 ];
+
+                for( ulIndex = 1; ulIndex < tlsSESSION_CACHE_SIZE; ulIndex++ )
+                {
+                    if( ( TickType_t ) ( xTaskGetTickCount() - xSessionCache[ ulIndex ].xLastUsed ) >
+                        ( TickType_t ) ( xTaskGetTickCount() - pxEntry->xLastUsed ) )
+                    {
+                        pxEntry = &xSessionCache[ ulIndex ];
+                    }
+                }
+            }
+
+            if( pdTRUE == pxEntry->xValid )
+            {
+                mbedtls_ssl_session_free( &pxEntry->xSession );
+            }
+
+            mbedtls_ssl_session_init( &pxEntry->xSession );
+
+            if( 0 == mbedtls_ssl_get_session( &pxCtx->xMbedSslCtx, &pxEntry->xSession ) )
+            {
+                memcpy( pxEntry->ucKey, pxCtx->ucSessionKey, sizeof( pxEntry->ucKey ) );
+                pxEntry->xLastUsed = xTaskGetTickCount();
+                pxEntry->xValid = pdTRUE;
+                xSessionCacheStats.ulStores++;
+            }
+            else
+            {
+                mbedtls_ssl_session_free( &pxEntry->xSession );
+                pxEntry->xValid = pdFALSE;
+            }
+
+            ( void ) xSemaphoreGive( xSessionCacheMutex );
+        }
+    }
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Drop the cached session of a connection whose handshake failed, so
+ * that the next connection performs a full handshake.
+ *
+ * @param[in] pxCtx The TLS context that offered a cached session.
+ */
+    static void prvSessionCacheRemove( TLSContext_t * pxCtx )
+    {
+        TLSSessionCacheEntry_t * pxEntry = NULL;
+
+        if( pdTRUE == xSemaphoreTake( xSessionCacheMutex, portMAX_DELAY ) )
+        {
+            pxEntry = prvSessionCacheFind( pxCtx );
+
+            if( NULL != pxEntry )
+            {
+                mbedtls_ssl_session_free( &pxEntry->xSession );
+                pxEntry->xValid = pdFALSE;
+            }
+
+            ( void ) xSemaphoreGive( xSessionCacheMutex );
+        }
+    }
+
+/*-----------------------------------------------------------*/
+#endif /* if ( tlsSESSION_CACHE_SIZE > 0 ) */
+
 /**
  * @brief TLS internal context rundown helper routine.
  *
@@ -162,6 +760,19 @@ static void prvFreeContext( TLSContext_t * pxCtx )
         mbedtls_ssl_config_free( &pxCtx->xMbedSslConfig );
         mbedtls_ctr_drbg_free( &pxCtx->xMbedDrbgCtx );
 
+        /* The SSL configuration no longer references the trust store. */
+        if( NULL != pxCtx->pxTrustStore )
+        {
+            prvTrustStoreRelease( pxCtx->pxTrustStore );
+            pxCtx->pxTrustStore = NULL;
+        }
+
+        if( NULL != pxCtx->pucSendBuffer )
+        {
+            vPortFree( pxCtx->pucSendBuffer );
+            pxCtx->pucSendBuffer = NULL;
+        }
+
         /* Cleanup PKCS11 only if the handshake was started. */
         if( ( TLS_HANDSHAKE_NOT_STARTED != pxCtx->xTLSHandshakeState ) &&
             ( NULL != pxCtx->pxP11FunctionList ) &&
@@ -701,6 +1312,142 @@ static int prvEntropyCallback( void * tlsContext,
     return ret;
 }
 
+/**
+ * @brief Writes the start of a buffer to the connection as one TLS record.
+ *
+ * @param[in] pxCtx The negotiated TLS context.
+ * @param[in] pucData Data to send.
+ * @param[in] xDataLength Length of the data in bytes.
+ *
+ * @return Number of bytes sent; 0 if the socket could not take any data
+ * without blocking; or a negative mbedTLS error code, after which the context
+ * is invalidated.
+ */
+static BaseType_t prvWriteRecord( TLSContext_t * pxCtx,
+                                  const unsigned char * pucData,
+                                  size_t xDataLength )
+{
+    BaseType_t xResult = 0;
+
+    do
+    {
+        xResult = mbedtls_ssl_write( &pxCtx->xMbedSslCtx, pucData, xDataLength );
+    } while( MBEDTLS_ERR_SSL_WANT_WRITE == xResult );
+
+    if( ( 0 == xResult ) || ( -pdFREERTOS_ERRNO_ENOSPC == xResult ) )
+    {
+        /* No data sent. The secure sockets API supports non-blocking send,
+         * so stop but don't flag an error. */
+        xResult = 0;
+    }
+    else if( 0 > xResult )
+    {
+        /* Hard error: invalidate the context. */
+        prvFreeContext( pxCtx );
+    }
+    else
+    {
+        /* Sent data. */
+    }
+
+    return xResult;
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Moves a position in a sequence of fragments forward, past any
+ * fragments that are fully sent.
+ *
+ * @param[in] pxVectors The fragments.
+ * @param[in] xVectorCount Number of fragments.
+ * @param[in,out] pxVector Index of the fragment holding the next byte to send;
+ * xVectorCount once every fragment is sent.
+ * @param[in,out] pxOffset Offset of the next byte to send in that fragment.
+ * @param[in] xLength Number of bytes to move forward.
+ */
+static void prvSendVectorAdvance( const TLSSendVector_t * pxVectors,
+                                  size_t xVectorCount,
+                                  size_t * pxVector,
+                                  size_t * pxOffset,
+                                  size_t xLength )
+{
+    size_t xStep = 0;
+
+    while( *pxVector < xVectorCount )
+    {
+        xStep = pxVectors[ *pxVector ].xLength - *pxOffset;
+
+        if( xLength < xStep )
+        {
+            *pxOffset += xLength;
+            break;
+        }
+
+        xLength -= xStep;
+        ( *pxVector )++;
+        *pxOffset = 0;
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Finds the data of the next TLS record to send from a sequence of
+ * fragments.
+ *
+ * A long fragment, or the last one, is sent from the caller's memory. Shorter
+ * fragments are copied into the send buffer of the context, together with the
+ * fragments that follow them, until the buffer is full.
+ *
+ * @param[in] pxCtx The TLS context.
+ * @param[in] pxVectors The fragments.
+ * @param[in] xVectorCount Number of fragments.
+ * @param[in] xVector Index of the fragment holding the next byte to send.
+ * @param[in] xOffset Offset of the next byte to send in that fragment.
+ * @param[out] ppucRecord Set to the start of the record data.
+ *
+ * @return Length of the record data in bytes.
+ */
+static size_t prvSendVectorGather( TLSContext_t * pxCtx,
+                                   const TLSSendVector_t * pxVectors,
+                                   size_t xVectorCount,
+                                   size_t xVector,
+                                   size_t xOffset,
+                                   const unsigned char ** ppucRecord )
+{
+    size_t xLength = pxVectors[ xVector ].xLength - xOffset;
+    size_t xCopy = 0;
+
+    *ppucRecord = ( const unsigned char * ) pxVectors[ xVector ].pvData + xOffset;
+
+    if( ( NULL != pxCtx->pucSendBuffer ) &&
+        ( xLength < ( size_t ) tlsSEND_COALESCE_BUFFER_SIZE ) &&
+        ( ( xVector + 1U ) < xVectorCount ) )
+    {
+        memcpy( pxCtx->pucSendBuffer, *ppucRecord, xLength );
+
+        for( xVector++; ( xVector < xVectorCount ) && ( xLength < ( size_t ) tlsSEND_COALESCE_BUFFER_SIZE ); xVector++ )
+        {
+            xCopy = ( size_t ) tlsSEND_COALESCE_BUFFER_SIZE - xLength;
+
+            if( pxVectors[ xVector ].xLength < xCopy )
+            {
+                xCopy = pxVectors[ xVector ].xLength;
+            }
+
+            memcpy( pxCtx->pucSendBuffer + xLength, pxVectors[ xVector ].pvData, xCopy );
+            xLength += xCopy;
+        }
+
+        *ppucRecord = pxCtx->pucSendBuffer;
+    }
+
+    return xLength;
+}
+
+/*-----------------------------------------------------------*/
+
 /*
  * Interface routines.
  */
@@ -803,50 +1550,12 @@ BaseType_t TLS_Connect( void * pvContext )
     /* Initialize mbedTLS structures. */
     mbedtls_ssl_init( &pxCtx->xMbedSslCtx );
     mbedtls_ssl_config_init( &pxCtx->xMbedSslConfig );
-    mbedtls_x509_crt_init( &pxCtx->xMbedX509CA );
 
-    /* Decode the root certificate: either the default or the override. */
-    if( NULL != pxCtx->pcServerCertificate )
-    {
-        xResult = mbedtls_x509_crt_parse( &pxCtx->xMbedX509CA,
-                                          ( const unsigned char * ) pxCtx->pcServerCertificate,
-                                          pxCtx->ulServerCertificateLength );
-
-        if( 0 != xResult )
-        {
-            TLS_PRINT( ( "ERROR: Failed to parse custom server certificates %s : %s \r\n",
-                         mbedtlsHighLevelCodeOrDefault( xResult ),
-                         mbedtlsLowLevelCodeOrDefault( xResult ) ) );
-        }
-    }
-    else
-    {
-        xResult = mbedtls_x509_crt_parse( &pxCtx->xMbedX509CA,
-                                          ( const unsigned char * ) tlsVERISIGN_ROOT_CERTIFICATE_PEM,
-                                          tlsVERISIGN_ROOT_CERTIFICATE_LENGTH );
-
-        if( 0 == xResult )
-        {
-            xResult = mbedtls_x509_crt_parse( &pxCtx->xMbedX509CA,
-                                              ( const unsigned char * ) tlsATS1_ROOT_CERTIFICATE_PEM,
-                                              tlsATS1_ROOT_CERTIFICATE_LENGTH );
-
-            if( 0 == xResult )
-            {
-                xResult = mbedtls_x509_crt_parse( &pxCtx->xMbedX509CA,
-                                                  ( const unsigned char * ) tlsSTARFIELD_ROOT_CERTIFICATE_PEM,
-                                                  tlsSTARFIELD_ROOT_CERTIFICATE_LENGTH );
-            }
-        }
-
-        if( 0 != xResult )
-        {
-            /* Default root certificates should be in aws_default_root_certificate.h */
-            TLS_PRINT( ( "ERROR: Failed to parse default server certificates %s : %s \r\n",
-                         mbedtlsHighLevelCodeOrDefault( xResult ),
-                         mbedtlsLowLevelCodeOrDefault( xResult ) ) );
-        }
-    }
+    /* Share the parsed root certificates with other connections that trust the
+     * same certificates: either the default or the override. */
+    xResult = prvTrustStoreAcquire( pxCtx->pcServerCertificate,
+                                    pxCtx->ulServerCertificateLength,
+                                    &pxCtx->pxTrustStore );
 
     /* Start with protocol defaults. */
     if( 0 == xResult )
@@ -878,7 +1587,7 @@ BaseType_t TLS_Connect( void * pvContext )
         mbedtls_ssl_conf_rng( &pxCtx->xMbedSslConfig, &prvGenerateRandomBytes, pxCtx ); /*lint !e546 Nothing wrong here. */
 
         /* Set issuer certificate. */
-        mbedtls_ssl_conf_ca_chain( &pxCtx->xMbedSslConfig, &pxCtx->xMbedX509CA, NULL );
+        mbedtls_ssl_conf_ca_chain( &pxCtx->xMbedSslConfig, &pxCtx->pxTrustStore->xMbedX509CA, NULL );
 
         /* Configure the SSL context to contain device credentials (eg device cert
          * and private key) obtained from the PKCS #11 layer.  The result of
@@ -914,6 +1623,15 @@ BaseType_t TLS_Connect( void * pvContext )
         xResult = mbedtls_ssl_setup( &pxCtx->xMbedSslCtx, &pxCtx->xMbedSslConfig );
     }
 
+    #if ( tlsSESSION_CACHE_SIZE > 0 )
+        if( 0 == xResult )
+        {
+            /* Resume an earlier session with the same server, if one is cached,
+             * instead of performing a full handshake. */
+            prvSessionCacheLoad( pxCtx );
+        }
+    #endif
+
     #ifdef MBEDTLS_SSL_MAX_FRAGMENT_LENGTH
         if( 0 == xResult )
         {
@@ -979,6 +1697,10 @@ BaseType_t TLS_Connect( void * pvContext )
     if( 0 == xResult )
     {
         pxCtx->xTLSHandshakeState = TLS_HANDSHAKE_SUCCESSFUL;
+
+        #if ( tlsSESSION_CACHE_SIZE > 0 )
+            prvSessionCacheStore( pxCtx );
+        #endif
     }
     else if( xResult > 0 )
     {
@@ -987,8 +1709,15 @@ BaseType_t TLS_Connect( void * pvContext )
         xResult = TLS_ERROR_HANDSHAKE_FAILED;
     }
 
-    /* Free up allocated memory. */
-    mbedtls_x509_crt_free( &pxCtx->xMbedX509CA );
+    #if ( tlsSESSION_CACHE_SIZE > 0 )
+        if( ( 0 != xResult ) && ( 0U != pxCtx->xOfferedSessionIdLength ) )
+        {
+            prvSessionCacheRemove( pxCtx );
+        }
+    #endif
+
+    /* Free up allocated memory. The trust store is kept until the context is
+     * freed, since the SSL configuration references it. */
     mbedtls_x509_crt_free( &pxCtx->xMbedX509Cli );
 
     return xResult;
@@ -1057,27 +1786,77 @@ BaseType_t TLS_Send( void * pvContext,
     {
         while( xWritten < xMsgLength )
         {
-            xResult = mbedtls_ssl_write( &pxCtx->xMbedSslCtx,
-                                         pucMsg + xWritten,
-                                         xMsgLength - xWritten );
+            xResult = prvWriteRecord( pxCtx,
+                                      pucMsg + xWritten,
+                                      xMsgLength - xWritten );
 
             if( 0 < xResult )
             {
                 /* Sent data, so update the tally and keep looping. */
                 xWritten += ( size_t ) xResult;
             }
-            else if( ( 0 == xResult ) || ( -pdFREERTOS_ERRNO_ENOSPC == xResult ) )
+            else
             {
-                /* No data sent. The secure sockets
-                 * API supports non-blocking send, so stop the loop but don't
-                 * flag an error. */
-                xResult = 0;
                 break;
             }
-            else if( MBEDTLS_ERR_SSL_WANT_WRITE != xResult )
+        }
+    }
+    else
+    {
+        xResult = MBEDTLS_ERR_SSL_INTERNAL_ERROR;
+    }
+
+    if( 0 <= xResult )
+    {
+        xResult = ( BaseType_t ) xWritten;
+    }
+
+    return xResult;
+}
+
+/*-----------------------------------------------------------*/
+
+BaseType_t TLS_SendV( void * pvContext,
+                      const TLSSendVector_t * pxVectors,
+                      size_t xVectorCount )
+{
+    BaseType_t xResult = 0;
+    TLSContext_t * pxCtx = ( TLSContext_t * ) pvContext; /*lint !e9087 !e9079 Allow casting void* to other types. */
+    size_t xWritten = 0;
+    size_t xVector = 0;
+    size_t xOffset = 0;
+    size_t xRecordLength = 0;
+    const unsigned char * pucRecord = NULL;
+
+    if( ( NULL != pxCtx ) &&
+        ( ( NULL != pxVectors ) || ( 0U == xVectorCount ) ) &&
+        ( TLS_HANDSHAKE_SUCCESSFUL == pxCtx->xTLSHandshakeState ) )
+    {
+        #if ( tlsSEND_COALESCE_BUFFER_SIZE > 0 )
+            if( NULL == pxCtx->pucSendBuffer )
+            {
+                /* Without the buffer every fragment is simply sent on its own. */
+                pxCtx->pucSendBuffer = ( unsigned char * ) pvPortMalloc( tlsSEND_COALESCE_BUFFER_SIZE ); /*lint !e9087 !e9079 Allow casting void* to other types. */
+            }
+        #endif
+
+        /* Skip empty leading fragments. */
+        prvSendVectorAdvance( pxVectors, xVectorCount, &xVector, &xOffset, 0 );
+
+        while( xVector < xVectorCount )
+        {
+            xRecordLength = prvSendVectorGather( pxCtx, pxVectors, xVectorCount, xVector, xOffset, &pucRecord );
+            xResult = prvWriteRecord( pxCtx, pucRecord, xRecordLength );
+
+            if( 0 < xResult )
+            {
+                /* mbedTLS took a prefix of the record; whatever was gathered
+                 * beyond it is gathered again for the next record. */
+                xWritten += ( size_t ) xResult;
+                prvSendVectorAdvance( pxVectors, xVectorCount, &xVector, &xOffset, ( size_t ) xResult );
+            }
+            else
             {
-                /* Hard error: invalidate the context and stop. */
-                prvFreeContext( pxCtx );
                 break;
             }
         }
@@ -1109,3 +1888,45 @@ void TLS_Cleanup( void * pvContext )
         vPortFree( pxCtx );
     }
 }
+/*-----------------------------------------------------------*/
+
+void TLS_GetSessionCacheStats( TLSSessionCacheStats_t * pxStats )
+{
+    memset( pxStats, 0, sizeof( TLSSessionCacheStats_t ) );
+
+    #if ( tlsSESSION_CACHE_SIZE > 0 )
+        prvCreateMutexOnce( &xSessionCacheMutex, &xSessionCacheMutexBuffer );
+
+        if( pdTRUE == xSemaphoreTake( xSessionCacheMutex, portMAX_DELAY ) )
+        {
+            *pxStats = xSessionCacheStats;
+
+            ( void ) xSemaphoreGive( xSessionCacheMutex );
+        }
+    #endif
+}
+
+/*-----------------------------------------------------------*/
+
+void TLS_FlushSessionCache( void )
+{
+    #if ( tlsSESSION_CACHE_SIZE > 0 )
+        uint32_t ulIndex = 0;
+
+        prvCreateMutexOnce( &xSessionCacheMutex, &xSessionCacheMutexBuffer );
+
+        if( pdTRUE == xSemaphoreTake( xSessionCacheMutex, portMAX_DELAY ) )
+        {
+            for( ulIndex = 0; ulIndex < tlsSESSION_CACHE_SIZE; ulIndex++ )
+            {
+                if( pdTRUE == xSessionCache[ ulIndex ].xValid )
+                {
+                    mbedtls_ssl_session_free( &xSessionCache[ ulIndex ].xSession );
+                    xSessionCache[ ulIndex ].xValid = pdFALSE;
+                }
+            }
+
+            ( void ) xSemaphoreGive( xSessionCacheMutex );
+        }
+    #endif
+}
@@ -26,6 +26,10 @@
 /* Standard includes. */
 #include <string.h>
 
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
 /* Test framework includes. */
 #include "unity_fixture.h"
 #include "aws_test_runner.h"
@@ -33,6 +37,9 @@
 /* Secure sockets includes */
 #include "iot_secure_sockets.h"
 
+/* TLS includes. */
+#include "iot_tls.h"
+
 /* Credential includes. */
 #include "aws_clientcredential.h"
 #include "aws_clientcredential_keys.h"
@@ -85,6 +92,10 @@ TEST_TEAR_DOWN( Full_TLS )
 TEST_GROUP_RUNNER( Full_TLS )
 {
     RUN_TEST_CASE( Full_TLS, AFQP_TLS_ConnectDefault );
+    RUN_TEST_CASE( Full_TLS, AFQP_TLS_ConnectSharedTrustStore );
+    #if ( tlsSESSION_CACHE_SIZE > 0 )
+        RUN_TEST_CASE( Full_TLS, AFQP_TLS_ConnectResumesSession );
+    #endif
     #if ( pkcs11configIMPORT_PRIVATE_KEYS_SUPPORTED == 1 )
         #if ( pkcs11testEC_KEY_SUPPORT == 1 )
             RUN_TEST_CASE( Full_TLS, AFQP_TLS_ConnectEC );
@@ -307,6 +318,121 @@ TEST( Full_TLS, AFQP_TLS_ConnectDefault )
 }
 /*-----------------------------------------------------------*/
 
+/* Connections open at the same time share the parsed default root certificates,
+ * and a connection that outlives another keeps using them. */
+TEST( Full_TLS, AFQP_TLS_ConnectSharedTrustStore )
+{
+    const char * pcAWSIoTAddress = clientcredentialMQTT_BROKER_ENDPOINT;
+    uint16_t usAWSIoTPort = clientcredentialMQTT_BROKER_PORT;
+    SocketsSockaddr_t xMQTTServerAddress = { 0 };
+    Socket_t xSockets[ 3 ];
+    BaseType_t xResult;
+    uint32_t ulIndex;
+
+    xMQTTServerAddress.ulAddress = SOCKETS_GetHostByName( pcAWSIoTAddress );
+    xMQTTServerAddress.usPort = SOCKETS_htons( usAWSIoTPort );
+    xMQTTServerAddress.ucSocketDomain = SOCKETS_AF_INET;
+
+    for( ulIndex = 0; ulIndex < 3; ulIndex++ )
+    {
+        xSockets[ ulIndex ] = prvSecureSocketCreate();
+    }
+
+    if( TEST_PROTECT() )
+    {
+        for( ulIndex = 0; ulIndex < 3; ulIndex++ )
+        {
+            xResult = SOCKETS_SetSockOpt( xSockets[ ulIndex ], 0, SOCKETS_SO_SERVER_NAME_INDICATION, pcAWSIoTAddress, 1u + strlen( pcAWSIoTAddress ) );
+            TEST_ASSERT_EQUAL_INT32_MESSAGE( SOCKETS_ERROR_NONE, xResult, "Socket set sock opt server name indication failed" );
+        }
+
+        /* Connect two sockets at once. */
+        xResult = SOCKETS_Connect( xSockets[ 0 ], &xMQTTServerAddress, sizeof( xMQTTServerAddress ) );
+        TEST_ASSERT_EQUAL_INT32_MESSAGE( SOCKETS_ERROR_NONE, xResult, "First socket connect failed" );
+
+        xResult = SOCKETS_Connect( xSockets[ 1 ], &xMQTTServerAddress, sizeof( xMQTTServerAddress ) );
+        TEST_ASSERT_EQUAL_INT32_MESSAGE( SOCKETS_ERROR_NONE, xResult, "Second socket connect failed" );
+
+        /* Close the first, then connect a third while the second is still open. */
+        xResult = SOCKETS_Shutdown( xSockets[ 0 ], SOCKETS_SHUT_RDWR );
+        TEST_ASSERT_EQUAL_INT32_MESSAGE( SOCKETS_ERROR_NONE, xResult, "First socket disconnect failed" );
+
+        xResult = SOCKETS_Connect( xSockets[ 2 ], &xMQTTServerAddress, sizeof( xMQTTServerAddress ) );
+        TEST_ASSERT_EQUAL_INT32_MESSAGE( SOCKETS_ERROR_NONE, xResult, "Third socket connect failed" );
+
+        for( ulIndex = 1; ulIndex < 3; ulIndex++ )
+        {
+            xResult = SOCKETS_Shutdown( xSockets[ ulIndex ], SOCKETS_SHUT_RDWR );
+            TEST_ASSERT_EQUAL_INT32_MESSAGE( SOCKETS_ERROR_NONE, xResult, "Socket disconnect failed" );
+        }
+    }
+
+    for( ulIndex = 0; ulIndex < 3; ulIndex++ )
+    {
+        prvSecureSocketClose( xSockets[ ulIndex ] );
+    }
+}
+/*-----------------------------------------------------------*/
+
+#if ( tlsSESSION_CACHE_SIZE > 0 )
+
+/* A reconnect to the same server offers the session of the previous connection.
+ * Whether the server resumes it is up to the server, so only the offer is
+ * checked and the handshake times are reported. */
+    TEST( Full_TLS, AFQP_TLS_ConnectResumesSession )
+    {
+        const char * pcAWSIoTAddress = clientcredentialMQTT_BROKER_ENDPOINT;
+        uint16_t usAWSIoTPort = clientcredentialMQTT_BROKER_PORT;
+        SocketsSockaddr_t xMQTTServerAddress = { 0 };
+        Socket_t xSocket;
+        BaseType_t xResult;
+        TLSSessionCacheStats_t xBefore, xAfter;
+        TickType_t xConnectTicks[ 2 ];
+        uint32_t ulIndex;
+
+        xMQTTServerAddress.ulAddress = SOCKETS_GetHostByName( pcAWSIoTAddress );
+        xMQTTServerAddress.usPort = SOCKETS_htons( usAWSIoTPort );
+        xMQTTServerAddress.ucSocketDomain = SOCKETS_AF_INET;
+
+        /* Start from a full handshake. */
+        TLS_FlushSessionCache();
+        TLS_GetSessionCacheStats( &xBefore );
+
+        for( ulIndex = 0; ulIndex < 2; ulIndex++ )
+        {
+            xSocket = prvSecureSocketCreate();
+
+            if( TEST_PROTECT() )
+            {
+                xResult = SOCKETS_SetSockOpt( xSocket, 0, SOCKETS_SO_SERVER_NAME_INDICATION, pcAWSIoTAddress, 1u + strlen( pcAWSIoTAddress ) );
+                TEST_ASSERT_EQUAL_INT32_MESSAGE( SOCKETS_ERROR_NONE, xResult, "Socket set sock opt server name indication failed" );
+
+                xConnectTicks[ ulIndex ] = xTaskGetTickCount();
+                xResult = SOCKETS_Connect( xSocket, &xMQTTServerAddress, sizeof( xMQTTServerAddress ) );
+                xConnectTicks[ ulIndex ] = xTaskGetTickCount() - xConnectTicks[ ulIndex ];
+                TEST_ASSERT_EQUAL_INT32_MESSAGE( SOCKETS_ERROR_NONE, xResult, "Socket connect failed" );
+
+                xResult = SOCKETS_Shutdown( xSocket, SOCKETS_SHUT_RDWR );
+                TEST_ASSERT_EQUAL_INT32_MESSAGE( SOCKETS_ERROR_NONE, xResult, "Socket disconnect failed" );
+            }
+
+            prvSecureSocketClose( xSocket );
+        }
+
+        TLS_GetSessionCacheStats( &xAfter );
+
+        /* Both handshakes stored a session, and only the second had one to offer. */
+        TEST_ASSERT_EQUAL_UINT32( xBefore.ulStores + 2U, xAfter.ulStores );
+        TEST_ASSERT_EQUAL_UINT32( xBefore.ulHits + 1U, xAfter.ulHits );
+
+        configPRINTF( ( "Full handshake %u ms, reconnect %u ms, resumed: %u\r\n",
+                        ( unsigned ) ( xConnectTicks[ 0 ] * portTICK_PERIOD_MS ),
+                        ( unsigned ) ( xConnectTicks[ 1 ] * portTICK_PERIOD_MS ),
+                        ( unsigned ) ( xAfter.ulResumed - xBefore.ulResumed ) ) );
+    }
+/*-----------------------------------------------------------*/
+#endif /* if ( tlsSESSION_CACHE_SIZE > 0 ) */
+
 TEST( Full_TLS, AFQP_TLS_ConnectEC )
 {
     ProvisioningParams_t xParams;
@@ -89,6 +89,14 @@ static void RunTestSuites( void )
 
     #if ( testrunnerFULL_TASKPOOL_ENABLED == 1 )
         RUN_TEST_GROUP( Common_Unit_Task_Pool );
+
+        #if ( testrunnerFULL_TASKPOOL_STRESS_ENABLED == 1 )
+            RUN_TEST_GROUP( Common_Unit_Task_Pool_Stress );
+        #endif
+
+        #if ( testrunnerFULL_TASKPOOL_BENCHMARK_ENABLED == 1 )
+            RUN_TEST_GROUP( Common_Benchmark_Task_Pool );
+        #endif
     #endif
 
     #if ( testrunnerFULL_WIFI_PROVISIONING_ENABLED == 1 )
@@ -116,6 +124,7 @@ static void RunTestSuites( void )
     #if ( testrunnerFULL_SHADOWv4_ENABLED == 1 )
         RUN_TEST_GROUP( Shadow_Unit_Parser );
         RUN_TEST_GROUP( Shadow_Unit_API );
+        RUN_TEST_GROUP( Shadow_Unit_Cache );
         RUN_TEST_GROUP( Shadow_System );
     #endif /* if ( testrunnerFULL_SHADOWv4_ENABLED == 1 ) */
 
@@ -126,6 +135,11 @@ static void RunTestSuites( void )
         RUN_TEST_GROUP( MQTT_Unit_API );
         RUN_TEST_GROUP( MQTT_Unit_Metrics );
         RUN_TEST_GROUP( MQTT_System );
+
+        #if ( testrunnerFULL_MQTTv4_BENCHMARK_ENABLED == 1 )
+            RUN_TEST_GROUP( MQTT_Benchmark_Subscription );
+            RUN_TEST_GROUP( MQTT_Benchmark_API );
+        #endif
     #endif /* if ( testrunnerFULL_MQTTv4_ENABLED == 1 ) */
 
     #if ( testrunnerFULL_MQTT_STRESS_TEST_ENABLED == 1 )
@@ -149,6 +163,10 @@ static void RunTestSuites( void )
         RUN_TEST_GROUP( Full_OTA_AGENT );
     #endif
 
+    #if ( testrunnerFULL_OTA_HTTP_ENABLED == 1 )
+        RUN_TEST_GROUP( Full_OTA_HTTP );
+    #endif
+
     #if ( testrunnerFULL_OTA_PAL_ENABLED == 1 )
         RUN_TEST_GROUP( Full_OTA_PAL );
     #endif
@@ -235,6 +253,10 @@ static void RunTestSuites( void )
         RUN_TEST_GROUP( Serializer_Unit_CBOR_Decoder );
         RUN_TEST_GROUP( Serializer_Unit_JSON );
         RUN_TEST_GROUP( Serializer_Unit_JSON_deserialize );
+
+        #if ( testrunnerFULL_SERIALIZER_BENCHMARK_ENABLED == 1 )
+            RUN_TEST_GROUP( Serializer_Benchmark_JSON_deserialize );
+        #endif
     #endif
 
     #if ( testrunnerFULL_HTTPS_CLIENT_ENABLED == 1 )
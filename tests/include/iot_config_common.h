@@ -116,6 +116,10 @@
     #define IotTaskPool_FreeJob                  vPortFree
     #define IotTaskPool_MallocTimerEvent         pvPortMalloc
     #define IotTaskPool_FreeTimerEvent           vPortFree
+    #define IotTaskPool_MallocTimerWheel         pvPortMalloc
+    #define IotTaskPool_FreeTimerWheel           vPortFree
+    #define IotTaskPool_MallocWorkQueues         pvPortMalloc
+    #define IotTaskPool_FreeWorkQueues           vPortFree
 
     #define IotMqtt_MallocConnection             pvPortMalloc
     #define IotMqtt_FreeConnection               vPortFree
@@ -151,6 +155,16 @@
 /* Require MQTT serializer overrides for the tests. */
 #define IOT_MQTT_ENABLE_SERIALIZER_OVERRIDES    ( 1 )
 
+/* Give the MQTT receive buffer pool buffers, so that the tests exercise it. */
+#define IOT_MQTT_RECEIVE_POOL_SMALL_COUNT       ( 4U )
+#define IOT_MQTT_RECEIVE_POOL_MEDIUM_COUNT      ( 2U )
+#define IOT_MQTT_RECEIVE_POOL_LARGE_COUNT       ( 1U )
+
+/* Reserve a task pool timing wheel and a set of worker deques, so that their
+ * tests also run with static memory. */
+#define IOT_TASKPOOL_TIMER_WHEELS               ( 1 )
+#define IOT_TASKPOOL_WORK_QUEUES                ( 1 )
+
 /* Platform and SDK name for AWS MQTT metrics. Only used when AWS_IOT_MQTT_ENABLE_METRICS is 1. */
 #define IOT_SDK_NAME                            "AmazonFreeRTOS"
 #ifdef configPLATFORM_NAME
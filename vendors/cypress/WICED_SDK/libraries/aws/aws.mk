@@ -146,6 +146,7 @@ $(NAME)_SOURCES :=  $(AFR_FREERTOS_PLUS_AWS_PATH)greengrass/src/aws_greengrass_d
                     $(AFR_C_SDK_AWS_PATH)shadow/src/aws_iot_shadow_operation.c                                      \
                     $(AFR_C_SDK_AWS_PATH)shadow/src/aws_iot_shadow_parser.c                                         \
                     $(AFR_C_SDK_AWS_PATH)shadow/src/aws_iot_shadow_subscription.c                                   \
+                    $(AFR_C_SDK_AWS_PATH)shadow/src/aws_iot_shadow_cache.c                                          \
                     $(AFR_FREERTOS_PLUS_STANDARD_PATH)tls/src/iot_tls.c                                                     \
                     $(AFR_FREERTOS_PLUS_STANDARD_PATH)utils/src/iot_system_init.c                                           \
                     $(AFR_ABSTRACTIONS_PATH)platform/freertos/iot_threads_freertos.c                                     \
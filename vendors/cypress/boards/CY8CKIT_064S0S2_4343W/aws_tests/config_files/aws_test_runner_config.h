@@ -60,6 +60,7 @@
 #define testrunnerFULL_MQTT_STRESS_TEST_ENABLED     0
 #define testrunnerFULL_MQTT_AGENT_ENABLED           0
 #define testrunnerFULL_MQTTv4_ENABLED               0
+#define testrunnerFULL_MQTTv4_BENCHMARK_ENABLED     0
 #define testrunnerFULL_OTA_AGENT_ENABLED            0
 #define testrunnerFULL_OTA_PAL_ENABLED              0
 #define testrunnerFULL_BLE_ENABLED                  0
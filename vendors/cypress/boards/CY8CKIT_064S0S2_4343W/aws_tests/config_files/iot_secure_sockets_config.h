@@ -68,4 +68,9 @@
  */
 #define AWS_IOT_SECURE_SOCKETS_METRICS_ENABLED    ( 1 )
 
+/**
+ * @brief The secure sockets port implements SOCKETS_SendV().
+ */
+#define socketsconfigSEND_VECTOR_SUPPORTED    ( 1 )
+
 #endif /* _IOT_SECURE_SOCKETS_CONFIG_H_ */
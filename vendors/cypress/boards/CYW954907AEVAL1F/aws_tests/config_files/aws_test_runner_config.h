@@ -53,6 +53,8 @@
 
 /* Supported tests. 0 = Disabled, 1 = Enabled */
 #define testrunnerFULL_TASKPOOL_ENABLED               0
+#define testrunnerFULL_TASKPOOL_STRESS_ENABLED        0
+#define testrunnerFULL_TASKPOOL_BENCHMARK_ENABLED     0
 #define testrunnerFULL_CBOR_ENABLED                   0
 #define testrunnerFULL_CRYPTO_ENABLED                 0
 #define testrunnerFULL_FREERTOS_TCP_ENABLED           0
@@ -68,6 +70,7 @@
 #define testrunnerFULL_CORE_HTTP_AWS_IOT_ENABLED      0
 #define testrunnerFULL_MQTT_STRESS_TEST_ENABLED       0
 #define testrunnerFULL_MQTTv4_ENABLED                 0
+#define testrunnerFULL_MQTTv4_BENCHMARK_ENABLED       0
 #define testrunnerFULL_WIFI_ENABLED                   0
 #define testrunnerFULL_PKCS11_ENABLED                 0
 #define testrunnerFULL_POSIX_ENABLED                  0
@@ -76,6 +79,7 @@
 #define testrunnerFULL_TCP_ENABLED                    1
 #define testrunnerFULL_TLS_ENABLED                    0
 #define testrunnerFULL_SERIALIZER_ENABLED             0
+#define testrunnerFULL_SERIALIZER_BENCHMARK_ENABLED   0
 #define testrunnerUTIL_PLATFORM_CLOCK_ENABLED         0
 #define testrunnerUTIL_PLATFORM_THREADS_ENABLED       0
 #define testrunnerFULL_HTTPS_CLIENT_ENABLED           0
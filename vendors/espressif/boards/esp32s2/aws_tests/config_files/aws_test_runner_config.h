@@ -48,6 +48,7 @@
 
 /* Enable tests by setting defines to 1 */
 #define testrunnerFULL_OTA_AGENT_ENABLED            0
+#define testrunnerFULL_OTA_HTTP_ENABLED             0
 #define testrunnerFULL_OTA_PAL_ENABLED              0
 #define testrunnerFULL_MQTT_ALPN_ENABLED            0
 #define testrunnerFULL_CORE_MQTT_ENABLED            0
@@ -66,6 +67,7 @@
 #define testrunnerFULL_SHADOW_ENABLED               0
 #define testrunnerFULL_SHADOWv4_ENABLED             0
 #define testrunnerFULL_MQTTv4_ENABLED               0
+#define testrunnerFULL_MQTTv4_BENCHMARK_ENABLED     0
 #define testrunnerFULL_WIFI_ENABLED                 0
 #define testrunnerFULL_MEMORYLEAK_ENABLED           0
 #define testrunnerFULL_TLS_ENABLED                  0
@@ -74,6 +76,7 @@
 #define testrunnerFULL_LINEAR_CONTAINERS_ENABLED    0
 #define testrunnerUTIL_PLATFORM_THREADS_ENABLED     0
 #define testrunnerFULL_SERIALIZER_ENABLED           0
+#define testrunnerFULL_SERIALIZER_BENCHMARK_ENABLED 0
 #define testrunnerFULL_HTTPS_CLIENT_ENABLED         0
 #define testrunnerFULL_COMMON_IO_ENABLED            0
 #define testrunnerFULL_CLI_ENABLED                  0
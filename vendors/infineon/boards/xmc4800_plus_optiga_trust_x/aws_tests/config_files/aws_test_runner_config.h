@@ -55,6 +55,7 @@
 #define testrunnerFULL_SHADOWv4_ENABLED             0
 #define testrunnerFULL_SHADOW_ENABLED               0
 #define testrunnerFULL_MQTTv4_ENABLED               0
+#define testrunnerFULL_MQTTv4_BENCHMARK_ENABLED     0
 #define testrunnerFULL_MQTT_STRESS_TEST_ENABLED     0
 #define testrunnerFULL_MQTT_AGENT_ENABLED           0
 #define testrunnerFULL_MQTT_ALPN_ENABLED            0
@@ -68,7 +69,10 @@
 #define testrunnerFULL_MEMORYLEAK_ENABLED           0
 #define testrunnerFULL_TLS_ENABLED                  testrunnerUNSUPPORTED
 #define testrunnerFULL_TASKPOOL_ENABLED             0
+#define testrunnerFULL_TASKPOOL_STRESS_ENABLED      0
+#define testrunnerFULL_TASKPOOL_BENCHMARK_ENABLED   0
 #define testrunnerFULL_SERIALIZER_ENABLED           0
+#define testrunnerFULL_SERIALIZER_BENCHMARK_ENABLED 0
 #define testrunnerFULL_POSIX_ENABLED                0
 #define testrunnerFULL_HTTPS_CLIENT_ENABLED         0
 
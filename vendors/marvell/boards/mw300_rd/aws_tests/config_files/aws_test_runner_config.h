@@ -62,6 +62,7 @@
 #define testrunnerFULL_GGD_HELPER_ENABLED           0
 #define testrunnerFULL_SHADOW_ENABLED               0
 #define testrunnerFULL_MQTTv4_ENABLED               0
+#define testrunnerFULL_MQTTv4_BENCHMARK_ENABLED     0
 #define testrunnerFULL_WIFI_ENABLED                 0
 #define testrunnerFULL_MEMORYLEAK_ENABLED           0
 #define testrunnerFULL_TLS_ENABLED                  0
@@ -69,4 +69,9 @@
  */
 #define socketsconfigDEFAULT_MAX_NUM_SECURE_SOCKETS     6
 
+/**
+ * @brief The secure sockets port implements SOCKETS_SendV().
+ */
+#define socketsconfigSEND_VECTOR_SUPPORTED    ( 1 )
+
 #endif /* _IOT_SECURE_SOCKETS_CONFIG_H_ */
@@ -65,6 +65,7 @@
 #define testrunnerFULL_CORE_HTTP_ENABLED            0
 #define testrunnerFULL_CORE_HTTP_AWS_IOT_ENABLED    0
 #define testrunnerFULL_MQTTv4_ENABLED               0
+#define testrunnerFULL_MQTTv4_BENCHMARK_ENABLED     0
 #define testrunnerFULL_MQTT_STRESS_TEST_ENABLED     0
 #define testrunnerFULL_SHADOWv4_ENABLED             0
 #define testrunnerFULL_MQTTv4_ENABLED               0
@@ -74,6 +75,7 @@
 #define testrunnerFULL_TCP_ENABLED                  1
 #define testrunnerFULL_TLS_ENABLED                  0
 #define testrunnerFULL_OTA_AGENT_ENABLED            0
+#define testrunnerFULL_OTA_HTTP_ENABLED             0
 #define testrunnerFULL_OTA_PAL_ENABLED              0
 #define testrunnerFULL_HTTPS_CLIENT_ENABLED         0
 #define testrunnerFULL_DEVICE_SHADOW_ENABLED        0
@@ -49,6 +49,7 @@
 #define testrunnerFULL_OTA_PAL_ENABLED                 0
 #define testrunnerFULL_SHADOWv4_ENABLED                0
 #define testrunnerFULL_MQTTv4_ENABLED                  0
+#define testrunnerFULL_MQTTv4_BENCHMARK_ENABLED        0
 #define testrunnerFULL_MEMORYLEAK_ENABLED              0
 #define testrunnerFULL_BLE_END_TO_END_TEST_ENABLED     0
 #define testrunnerFULL_BLE_STRESS_TEST_ENABLED         0
@@ -57,6 +58,7 @@
 #define testrunnerFULL_POSIX_ENABLED                   0
 #define testrunnerFULL_BLE_ENABLED                     0
 #define testrunnerFULL_SERIALIZER_ENABLED              0
+#define testrunnerFULL_SERIALIZER_BENCHMARK_ENABLED    0
 #define testrunnerFULL_LINEAR_CONTAINERS_ENABLED       0
 #define testrunnerFULL_COMMON_IO_ENABLED               0
 #define testrunnerFULL_DEVICE_SHADOW_ENABLED           0
@@ -50,6 +50,7 @@
 #define testrunnerFULL_GGD_HELPER_ENABLED           0
 #define testrunnerFULL_SHADOW_ENABLED               0
 #define testrunnerFULL_MQTTv4_ENABLED               0
+#define testrunnerFULL_MQTTv4_BENCHMARK_ENABLED     0
 #define testrunnerFULL_MQTT_STRESS_TEST_ENABLED     0
 #define testrunnerFULL_MQTT_AGENT_ENABLED           0
 #define testrunnerFULL_MQTT_ALPN_ENABLED            0
@@ -123,6 +123,14 @@
  */
 #define otaconfigMAX_NUM_OTA_DATA_BUFFERS    4U
 
+/**
+ * @brief The number of HTTP connections used to download a file in parallel.
+ *
+ * More than one connection is used so that the tests of the OTA HTTP data path cover requests
+ * that are in flight on several connections at once.
+ */
+#define otaconfigHTTP_MAX_NUM_CONNECTIONS    2U
+
 /**
  * @brief Allow update to same or lower version.
  *
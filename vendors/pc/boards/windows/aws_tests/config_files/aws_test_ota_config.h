@@ -70,6 +70,21 @@
  */
 #define otatestpalREAD_CERTIFICATE_FROM_NVM_WITH_PKCS11    0
 
+/**
+ * @brief 1 if prvPAL_ResumeFileForRx() and the checkpoint functions are implemented in aws_ota_pal.c.
+ */
+#define otatestpalCHECKPOINT_SUPPORTED                     1
+
+/**
+ * @brief 1 if prvPAL_ReadActiveImage() is implemented in aws_ota_pal.c.
+ */
+#define otatestpalDELTA_SUPPORTED                          1
+
+/**
+ * @brief The file prvPAL_ReadActiveImage() reads the active image from. The delta tests write it.
+ */
+#define otatestpalACTIVE_IMAGE_FILE                        "PlatformActiveImage.bin"
+
  /**
  * @brief Include of signature testing data applicable to this device.
  */
@@ -50,6 +50,8 @@
 
 /* Supported tests. 0 = Disabled, 1 = Enabled */
 #define testrunnerFULL_TASKPOOL_ENABLED               0
+#define testrunnerFULL_TASKPOOL_STRESS_ENABLED        0
+#define testrunnerFULL_TASKPOOL_BENCHMARK_ENABLED     0
 #define testrunnerFULL_CRYPTO_ENABLED                 0
 #define testrunnerFULL_FREERTOS_TCP_ENABLED           0
 #define testrunnerFULL_DEFENDER_ENABLED               0
@@ -63,6 +65,7 @@
 #define testrunnerFULL_CORE_HTTP_AWS_IOT_ENABLED      0
 #define testrunnerFULL_MQTT_STRESS_TEST_ENABLED       0
 #define testrunnerFULL_MQTTv4_ENABLED                 0
+#define testrunnerFULL_MQTTv4_BENCHMARK_ENABLED       0
 #define testrunnerFULL_PKCS11_ENABLED                 0
 #define testrunnerFULL_PKCS11_MODEL_ENABLED           0
 #define testrunnerFULL_POSIX_ENABLED                  0
@@ -73,8 +76,10 @@
 #define testrunnerFULL_MEMORYLEAK_ENABLED             0
 #define testrunnerFULL_OTA_CBOR_ENABLED               0
 #define testrunnerFULL_OTA_AGENT_ENABLED              0
+#define testrunnerFULL_OTA_HTTP_ENABLED               0
 #define testrunnerFULL_OTA_PAL_ENABLED                0
 #define testrunnerFULL_SERIALIZER_ENABLED             0
+#define testrunnerFULL_SERIALIZER_BENCHMARK_ENABLED   0
 #define testrunnerUTIL_PLATFORM_CLOCK_ENABLED         0
 #define testrunnerUTIL_PLATFORM_THREADS_ENABLED       0
 #define testrunnerFULL_HTTPS_CLIENT_ENABLED           0
@@ -27,6 +27,7 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <errno.h>
 #include "FreeRTOS.h"
 #include "iot_crypto.h"
 #include "aws_iot_ota_pal.h"
@@ -264,11 +265,19 @@ static OTA_Err_t prvPAL_CheckFileSignature( OTA_FileContext_t * const C )
     uint32_t ulSignerCertSize;
     uint8_t * pucBuf, * pucSignerCert;
     void * pvSigVerifyContext;
+    BaseType_t xFileHashed = pdFALSE;
 
     if( prvContextValidate( C ) == pdTRUE )
     {
+        if( C->pvSigVerifyContext != NULL )
+        {
+            /* The OTA agent has already hashed the file as it was received, no need to read it back. */
+            pvSigVerifyContext = C->pvSigVerifyContext;
+            C->pvSigVerifyContext = NULL;
+            xFileHashed = pdTRUE;
+        }
         /* Verify an ECDSA-SHA256 signature. */
-        if( pdFALSE == CRYPTO_SignatureVerificationStart( &pvSigVerifyContext, cryptoASYMMETRIC_ALGORITHM_ECDSA, cryptoHASH_ALGORITHM_SHA256 ) )
+        else if( pdFALSE == CRYPTO_SignatureVerificationStart( &pvSigVerifyContext, cryptoASYMMETRIC_ALGORITHM_ECDSA, cryptoHASH_ALGORITHM_SHA256 ) )
         {
             eResult = kOTA_Err_SignatureCheckFailed;
         }
@@ -284,17 +293,22 @@ static OTA_Err_t prvPAL_CheckFileSignature( OTA_FileContext_t * const C )
 
                 if( pucBuf != NULL )
                 {
-                    /* Rewind the received file to the beginning. */
-                    if( fseek( C->pxFile, 0L, SEEK_SET ) == 0 ) /*lint !e586
-                                                                  * C standard library call is being used for portability. */
+                    /* Rewind the received file to the beginning, unless it is already hashed. */
+                    if( ( xFileHashed == pdTRUE ) || ( fseek( C->pxFile, 0L, SEEK_SET ) == 0 ) ) /*lint !e586
+                                                                                                  * C standard library call is being used for portability. */
                     {
-                        do
+                        while( xFileHashed == pdFALSE )
                         {
                             ulBytesRead = fread( pucBuf, 1, OTA_PAL_WIN_BUF_SIZE, C->pxFile ); /*lint !e586
                                                                                                * C standard library call is being used for portability. */
                             /* Include the file chunk in the signature validation. Zero size is OK. */
                             CRYPTO_SignatureVerificationUpdate( pvSigVerifyContext, pucBuf, ulBytesRead );
-                        } while( ulBytesRead > 0UL );
+
+                            if( ulBytesRead == 0UL )
+                            {
+                                xFileHashed = pdTRUE;
+                            }
+                        }
 
                         if( pdFALSE == CRYPTO_SignatureVerificationFinal( pvSigVerifyContext,
                                                                           ( char * ) pucSignerCert,
@@ -582,6 +596,215 @@ OTA_PAL_ImageState_t prvPAL_GetPlatformImageState( void )
 
 /*-----------------------------------------------------------*/
 
+/* Reopen a partially received file without truncating it. */
+
+OTA_Err_t prvPAL_ResumeFileForRx( OTA_FileContext_t * const C )
+{
+    DEFINE_OTA_METHOD_NAME( "prvPAL_ResumeFileForRx" );
+
+    OTA_Err_t eResult = kOTA_Err_RxFileCreateFailed;
+
+    if( ( C != NULL ) && ( C->pucFilePath != NULL ) )
+    {
+        C->pxFile = fopen( ( const char * ) C->pucFilePath, "r+b" ); /*lint !e586
+                                                                      * C standard library call is being used for portability. */
+
+        if( C->pxFile != NULL )
+        {
+            eResult = kOTA_Err_None;
+            OTA_LOG_L1( "[%s] Receive file reopened.\r\n", OTA_METHOD_NAME );
+        }
+        else
+        {
+            eResult = ( kOTA_Err_RxFileCreateFailed | ( errno & kOTA_PAL_ErrMask ) ); /*lint !e40 !e737 !e9027 !e9029
+                                                                                       * Errno is being used in accordance with host API documentation.
+                                                                                       * Bitmasking is being used to preserve host API error with library status code. */
+            OTA_LOG_L1( "[%s] ERROR - Unable to reopen receive file.\r\n", OTA_METHOD_NAME );
+        }
+    }
+    else
+    {
+        OTA_LOG_L1( "[%s] ERROR - Invalid context provided.\r\n", OTA_METHOD_NAME );
+    }
+
+    return eResult; /*lint !e480 !e481 Exiting function without calling fclose.
+                     * Context file handle state is managed by this API. */
+}
+
+/*
+ * Save the download checkpoint. On Windows, it is stored in PlatformOTACheckpoint.dat
+ * after the blocks written to the receive file are flushed.
+ */
+
+OTA_Err_t prvPAL_SaveCheckpoint( OTA_FileContext_t * const C,
+                                 const uint8_t * pucData,
+                                 uint32_t ulSize )
+{
+    DEFINE_OTA_METHOD_NAME( "prvPAL_SaveCheckpoint" );
+
+    OTA_Err_t eResult = kOTA_Err_None;
+    FILE * pstCheckpoint;
+
+    if( ( prvContextValidate( C ) == pdTRUE ) && ( 0 != fflush( C->pxFile ) ) ) /*lint !e586 Allow call in this context. */
+    {
+        OTA_LOG_L1( "[%s] ERROR - Unable to flush receive file.\r\n", OTA_METHOD_NAME );
+        eResult = ( kOTA_Err_CheckpointFailed | ( errno & kOTA_PAL_ErrMask ) ); /*lint !e40 !e737 !e9027 !e9029
+                                                                                 * Errno is being used in accordance with host API documentation.
+                                                                                 * Bitmasking is being used to preserve host API error with library status code. */
+    }
+
+    if( eResult == kOTA_Err_None )
+    {
+        pstCheckpoint = fopen( "PlatformOTACheckpoint.dat", "wb" ); /*lint !e586
+                                                                     * C standard library call is being used for portability. */
+
+        if( pstCheckpoint != NULL )
+        {
+            if( ulSize != fwrite( pucData, 1, ulSize, pstCheckpoint ) ) /*lint !e586 !e9029
+                                                                         * C standard library call is being used for portability. */
+            {
+                OTA_LOG_L1( "[%s] ERROR - Unable to write to checkpoint file.\r\n", OTA_METHOD_NAME );
+                eResult = ( kOTA_Err_CheckpointFailed | ( errno & kOTA_PAL_ErrMask ) ); /*lint !e40 !e737 !e9027 !e9029
+                                                                                         * Errno is being used in accordance with host API documentation.
+                                                                                         * Bitmasking is being used to preserve host API error with library status code. */
+            }
+
+            if( 0 != fclose( pstCheckpoint ) ) /*lint !e586 Allow call in this context. */
+            {
+                OTA_LOG_L1( "[%s] ERROR - Unable to close checkpoint file.\r\n", OTA_METHOD_NAME );
+                eResult = ( kOTA_Err_CheckpointFailed | ( errno & kOTA_PAL_ErrMask ) ); /*lint !e40 !e737 !e9027 !e9029
+                                                                                         * Errno is being used in accordance with host API documentation.
+                                                                                         * Bitmasking is being used to preserve host API error with library status code. */
+            }
+        }
+        else
+        {
+            OTA_LOG_L1( "[%s] ERROR - Unable to open checkpoint file.\r\n", OTA_METHOD_NAME );
+            eResult = ( kOTA_Err_CheckpointFailed | ( errno & kOTA_PAL_ErrMask ) ); /*lint !e40 !e737 !e9027 !e9029
+                                                                                     * Errno is being used in accordance with host API documentation.
+                                                                                     * Bitmasking is being used to preserve host API error with library status code. */
+        }
+    }
+
+    return eResult; /*lint !e480 !e481 Allow calls to fopen and fclose in this context. */
+}
+
+/* Read the download checkpoint back from PlatformOTACheckpoint.dat. */
+
+OTA_Err_t prvPAL_LoadCheckpoint( uint8_t * pucData,
+                                 uint32_t ulSize,
+                                 uint32_t * pulSizeRead )
+{
+    DEFINE_OTA_METHOD_NAME( "prvPAL_LoadCheckpoint" );
+
+    OTA_Err_t eResult = kOTA_Err_None;
+    FILE * pstCheckpoint;
+
+    *pulSizeRead = 0U;
+
+    pstCheckpoint = fopen( "PlatformOTACheckpoint.dat", "rb" ); /*lint !e586
+                                                                 * C standard library call is being used for portability. */
+
+    if( pstCheckpoint != NULL )
+    {
+        *pulSizeRead = ( uint32_t ) fread( pucData, 1, ulSize, pstCheckpoint ); /*lint !e586
+                                                                                 * C standard library call is being used for portability. */
+
+        if( 0 != ferror( pstCheckpoint ) ) /*lint !e586 Allow call in this context. */
+        {
+            OTA_LOG_L1( "[%s] ERROR - Unable to read checkpoint file.\r\n", OTA_METHOD_NAME );
+            eResult = ( kOTA_Err_CheckpointFailed | ( errno & kOTA_PAL_ErrMask ) ); /*lint !e40 !e737 !e9027 !e9029
+                                                                                     * Errno is being used in accordance with host API documentation.
+                                                                                     * Bitmasking is being used to preserve host API error with library status code. */
+        }
+
+        ( void ) fclose( pstCheckpoint ); /*lint !e586 Allow call in this context. */
+    }
+    else
+    {
+        /* No checkpoint saved. */
+        eResult = kOTA_Err_CheckpointFailed;
+    }
+
+    return eResult; /*lint !e480 !e481 Allow calls to fopen and fclose in this context. */
+}
+
+/* Remove PlatformOTACheckpoint.dat. */
+
+OTA_Err_t prvPAL_EraseCheckpoint( void )
+{
+    DEFINE_OTA_METHOD_NAME( "prvPAL_EraseCheckpoint" );
+
+    OTA_Err_t eResult = kOTA_Err_None;
+
+    if( ( 0 != remove( "PlatformOTACheckpoint.dat" ) ) && ( errno != ENOENT ) ) /*lint !e586 !e40
+                                                                                  * C standard library call is being used for portability. */
+    {
+        OTA_LOG_L1( "[%s] ERROR - Unable to remove checkpoint file.\r\n", OTA_METHOD_NAME );
+        eResult = ( kOTA_Err_CheckpointFailed | ( errno & kOTA_PAL_ErrMask ) ); /*lint !e40 !e737 !e9027 !e9029
+                                                                                 * Errno is being used in accordance with host API documentation.
+                                                                                 * Bitmasking is being used to preserve host API error with library status code. */
+    }
+
+    return eResult;
+}
+
+/*-----------------------------------------------------------*/
+
+/*
+ * Read part of the active image, which delta updates are applied to.
+ * On Windows, the active image is stored in PlatformActiveImage.bin.
+ */
+
+OTA_Err_t prvPAL_ReadActiveImage( uint32_t ulOffset,
+                                  uint8_t * pucData,
+                                  uint32_t ulSize )
+{
+    DEFINE_OTA_METHOD_NAME( "prvPAL_ReadActiveImage" );
+
+    OTA_Err_t eResult = kOTA_Err_None;
+    FILE * pstActiveImage;
+
+    pstActiveImage = fopen( "PlatformActiveImage.bin", "rb" ); /*lint !e586
+                                                                * C standard library call is being used for portability. */
+
+    if( pstActiveImage != NULL )
+    {
+        if( 0 != fseek( pstActiveImage, ( long ) ulOffset, SEEK_SET ) ) /*lint !e586
+                                                                         * C standard library call is being used for portability. */
+        {
+            OTA_LOG_L1( "[%s] ERROR - fseek failed\r\n", OTA_METHOD_NAME );
+            eResult = ( kOTA_Err_DeltaUpdateFailed | ( errno & kOTA_PAL_ErrMask ) ); /*lint !e40 !e737 !e9027 !e9029
+                                                                                      * Errno is being used in accordance with host API documentation.
+                                                                                      * Bitmasking is being used to preserve host API error with library status code. */
+        }
+        else if( ulSize != fread( pucData, 1, ulSize, pstActiveImage ) ) /*lint !e586 !e9029
+                                                                          * C standard library call is being used for portability. */
+        {
+            /* Also the case when the range is past the end of the image. */
+            OTA_LOG_L1( "[%s] ERROR - Unable to read %u bytes at offset %u of the active image.\r\n", OTA_METHOD_NAME, ulSize, ulOffset );
+            eResult = kOTA_Err_DeltaUpdateFailed;
+        }
+        else
+        {
+            /* All requested bytes were read. */
+        }
+
+        ( void ) fclose( pstActiveImage ); /*lint !e586 Allow call in this context. */
+    }
+    else
+    {
+        OTA_LOG_L1( "[%s] ERROR - Unable to open the active image.\r\n", OTA_METHOD_NAME );
+        eResult = ( kOTA_Err_DeltaUpdateFailed | ( errno & kOTA_PAL_ErrMask ) ); /*lint !e40 !e737 !e9027 !e9029
+                                                                                  * Errno is being used in accordance with host API documentation.
+                                                                                  * Bitmasking is being used to preserve host API error with library status code. */
+    }
+
+    return eResult; /*lint !e480 !e481 Allow calls to fopen and fclose in this context. */
+}
+
+/*-----------------------------------------------------------*/
+
 /* Provide access to private members for testing. */
 #ifdef FREERTOS_ENABLE_UNIT_TESTS
 #include "aws_ota_pal_test_access_define.h"
@@ -45,6 +45,7 @@
 /* Unsupported tests */
 #define testrunnerFULL_CBOR_ENABLED         testrunnerUNSUPPORTED
 #define testrunnerFULL_OTA_AGENT_ENABLED    testrunnerUNSUPPORTED
+#define testrunnerFULL_OTA_HTTP_ENABLED     testrunnerUNSUPPORTED
 #define testrunnerFULL_OTA_PAL_ENABLED      testrunnerUNSUPPORTED
 #define testrunnerFULL_WIFI_ENABLED         testrunnerUNSUPPORTED
 
@@ -64,6 +65,7 @@
 #define testrunnerFULL_GGD_HELPER_ENABLED           0
 #define testrunnerFULL_SHADOW_ENABLED               0
 #define testrunnerFULL_MQTTv4_ENABLED               0
+#define testrunnerFULL_MQTTv4_BENCHMARK_ENABLED     0
 #define testrunnerFULL_MEMORYLEAK_ENABLED           0
 #define testrunnerFULL_TLS_ENABLED                  0
 #define testrunnerFULL_HTTPS_CLIENT_ENABLED         0
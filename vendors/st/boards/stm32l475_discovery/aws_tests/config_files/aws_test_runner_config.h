@@ -51,6 +51,8 @@
 
 /* Supported tests. 0 = Disabled, 1 = Enabled */
 #define testrunnerFULL_TASKPOOL_ENABLED             0
+#define testrunnerFULL_TASKPOOL_STRESS_ENABLED      0
+#define testrunnerFULL_TASKPOOL_BENCHMARK_ENABLED   0
 #define testrunnerFULL_MQTT_AGENT_ENABLED           0
 #define testrunnerFULL_TCP_ENABLED                  1
 #define testrunnerFULL_GGD_ENABLED                  0
@@ -60,6 +62,7 @@
 #define testrunnerFULL_CORE_HTTP_ENABLED            0
 #define testrunnerFULL_CORE_HTTP_AWS_IOT_ENABLED    0
 #define testrunnerFULL_MQTTv4_ENABLED               0
+#define testrunnerFULL_MQTTv4_BENCHMARK_ENABLED     0
 #define testrunnerFULL_PKCS11_ENABLED               0
 #define testrunnerFULL_CRYPTO_ENABLED               0
 #define testrunnerFULL_WIFI_ENABLED                 0
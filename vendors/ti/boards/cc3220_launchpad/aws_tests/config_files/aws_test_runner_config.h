@@ -50,9 +50,12 @@
 
 /* Supported tests. 0 = Disabled, 1 = Enabled */
 #define testrunnerFULL_TASKPOOL_ENABLED             0
+#define testrunnerFULL_TASKPOOL_STRESS_ENABLED      0
+#define testrunnerFULL_TASKPOOL_BENCHMARK_ENABLED   0
 #define testrunnerFULL_MQTT_STRESS_TEST_ENABLED     0
 #define testrunnerFULL_MQTT_AGENT_ENABLED           0
 #define testrunnerFULL_MQTTv4_ENABLED               0
+#define testrunnerFULL_MQTTv4_BENCHMARK_ENABLED     0
 #define testrunnerFULL_TCP_ENABLED                  1
 #define testrunnerFULL_GGD_ENABLED                  0
 #define testrunnerFULL_GGD_HELPER_ENABLED           0
@@ -62,6 +65,7 @@
 #define testrunnerFULL_MEMORYLEAK_ENABLED           0
 #define testrunnerFULL_TLS_ENABLED                  0
 #define testrunnerFULL_OTA_AGENT_ENABLED            0
+#define testrunnerFULL_OTA_HTTP_ENABLED             0
 #define testrunnerFULL_OTA_PAL_ENABLED              0
 #define testrunnerFULL_POSIX_ENABLED                0
 #define testrunnerFULL_HTTPS_CLIENT_ENABLED         0